@@ -0,0 +1,7 @@
+CONFIG += libtsduck
+include(../tsduck.pri)
+TEMPLATE = app
+TARGET = tsbench
+
+HEADERS += $$system(find $$SRCROOT/tsbench -name \\*.h)
+SOURCES += $$system(find $$SRCROOT/tsbench -name \\*.cpp)
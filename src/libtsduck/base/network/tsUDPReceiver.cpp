@@ -49,6 +49,7 @@ ts::UDPReceiver::UDPReceiver(ts::Report& report, bool with_short_options, bool d
     _use_first_source(false),
     _recv_bufsize(0),
     _recv_timeout(-1),
+    _recv_timestamps(false),
     _use_source(),
     _first_source(),
     _sources()
@@ -114,6 +115,13 @@ void ts::UDPReceiver::defineArgs(ts::Args& args) const
               u"This timeout applies to each receive operation, individually. "
               u"By default, receive operations wait for data, possibly forever.");
 
+    args.option(u"receive-timestamps");
+    args.help(u"receive-timestamps",
+              u"Request the system to time stamp each UDP packet when it is received by the network stack. "
+              u"These time stamps are more accurate than the time when the application reads the packets. "
+              u"When used in an input plugin, they are attached to the TS packets as input time stamps. "
+              u"This is supported on Linux and most UNIX systems, not on Windows.");
+
     args.option(u"source", _with_short_options ? 's' : 0, Args::STRING);
     args.help(u"source", u"address[:port]",
               u"Filter UDP packets based on the specified source address. This option is "
@@ -153,6 +161,7 @@ bool ts::UDPReceiver::loadArgs(DuckContext& duck, Args& args)
     _use_first_source = args.present(u"first-source");
     _recv_bufsize = args.intValue<size_t>(u"buffer-size", 0);
     _recv_timeout = args.intValue<MilliSecond>(u"receive-timeout", _recv_timeout); // preserve previous value
+    _recv_timestamps = args.present(u"receive-timestamps");
 
     // Check the presence of the '@' indicating a source address.
     const size_t sep = destination.find(u'@');
@@ -305,6 +314,7 @@ bool ts::UDPReceiver::open(ts::Report& report)
         reusePort(_reuse_port, report) &&
         (_recv_bufsize <= 0 || setReceiveBufferSize(_recv_bufsize, report)) &&
         (_recv_timeout < 0 || setReceiveTimeout(_recv_timeout, report)) &&
+        (!_recv_timestamps || setReceiveTimestamps(true, report)) &&
         bind(local_addr, report);
 
     // Optional SSM source address.
@@ -353,76 +363,133 @@ bool ts::UDPReceiver::receive(void* data,
         if (!UDPSocket::receive(data, max_size, ret_size, sender, destination, abort, report)) {
             return false;
         }
+        if (acceptMessage(sender, destination, report)) {
+            return true;
+        }
+    }
+}
 
-        // Debug (level 2) message for each message.
-        if (report.maxSeverity() >= 2) {
-            // Prior report level checking to avoid evaluating parameters when not necessary.
-            report.log(2, u"received UDP packet, source: %s, destination: %s", {sender, destination});
+
+//----------------------------------------------------------------------------
+// Receive several datagrams, filtered on destination and source.
+//----------------------------------------------------------------------------
+
+bool ts::UDPReceiver::receiveBatch(void* data,
+                                   size_t max_size,
+                                   size_t max_count,
+                                   size_t& ret_count,
+                                   size_t* ret_sizes,
+                                   ts::SocketAddress* senders,
+                                   ts::SocketAddress* destinations,
+                                   ts::MicroSecond* timestamps,
+                                   const ts::AbortInterface* abort,
+                                   ts::Report& report)
+{
+    uint8_t* const base = reinterpret_cast<uint8_t*>(data);
+
+    // Loop on reception until at least one message matches the filtering criteria.
+    do {
+        if (!UDPSocket::receiveBatch(data, max_size, max_count, ret_count, ret_sizes, senders, destinations, timestamps, abort, report)) {
+            return false;
         }
 
-        // Check the destination address to exclude packets from other streams.
-        // When several multicast streams use the same destination port and several
-        // applications on the same system listen to these distinct streams,
-        // the multicast MAC address management is such that any socket which
-        // is bound to the common port will receive the traffic for all streams.
-        // This is why we need to check the destination address and exclude
-        // packets which are not from the intended stream.
-        //
-        // We accept a packet in any of:
-        // 1) Actual packet destination is unknown. Probably, the system cannot
-        //    report the destination address.
-        // 2) We listen to a multicast address and the actual destination is the same.
-        // 3) If we listen to unicast traffic and the actual destination is unicast.
-        //    In that case, unicast is by definition sent to us.
-
-        if (destination.hasAddress() && ((_dest_addr.hasAddress() && destination != _dest_addr) || (!_dest_addr.hasAddress() && destination.isMulticast()))) {
-            // This is a spurious packet.
-            if (report.maxSeverity() >= Severity::Debug) {
-                // Prior report level checking to avoid evaluating parameters when not necessary.
-                report.debug(u"rejecting packet, destination: %s, expecting: %s", {destination, _dest_addr});
+        // Compact the accepted messages at the beginning of the buffer.
+        size_t count = 0;
+        for (size_t i = 0; i < ret_count; ++i) {
+            if (acceptMessage(senders[i], destinations[i], report)) {
+                if (count < i) {
+                    ::memmove(base + count * max_size, base + i * max_size, ret_sizes[i]);
+                    ret_sizes[count] = ret_sizes[i];
+                    senders[count] = senders[i];
+                    destinations[count] = destinations[i];
+                    if (timestamps != nullptr) {
+                        timestamps[count] = timestamps[i];
+                    }
+                }
+                count++;
             }
-            continue;
         }
+        ret_count = count;
+    } while (ret_count == 0);
 
-        // Keep track of the first sender address.
-        if (!_first_source.hasAddress()) {
-            // First packet, keep address of the sender.
-            _first_source = sender;
-            _sources.insert(sender);
-
-            // With option --first-source, use this one to filter packets.
-            if (_use_first_source) {
-                assert(!_use_source.hasAddress());
-                _use_source = sender;
-                report.verbose(u"now filtering on source address %s", {sender});
-            }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Check if a received message matches the filtering criteria.
+//----------------------------------------------------------------------------
+
+bool ts::UDPReceiver::acceptMessage(const SocketAddress& sender, const SocketAddress& destination, Report& report)
+{
+    // Debug (level 2) message for each message.
+    if (report.maxSeverity() >= 2) {
+        // Prior report level checking to avoid evaluating parameters when not necessary.
+        report.log(2, u"received UDP packet, source: %s, destination: %s", {sender, destination});
+    }
+
+    // Check the destination address to exclude packets from other streams.
+    // When several multicast streams use the same destination port and several
+    // applications on the same system listen to these distinct streams,
+    // the multicast MAC address management is such that any socket which
+    // is bound to the common port will receive the traffic for all streams.
+    // This is why we need to check the destination address and exclude
+    // packets which are not from the intended stream.
+    //
+    // We accept a packet in any of:
+    // 1) Actual packet destination is unknown. Probably, the system cannot
+    //    report the destination address.
+    // 2) We listen to a multicast address and the actual destination is the same.
+    // 3) If we listen to unicast traffic and the actual destination is unicast.
+    //    In that case, unicast is by definition sent to us.
+
+    if (destination.hasAddress() && ((_dest_addr.hasAddress() && destination != _dest_addr) || (!_dest_addr.hasAddress() && destination.isMulticast()))) {
+        // This is a spurious packet.
+        if (report.maxSeverity() >= Severity::Debug) {
+            // Prior report level checking to avoid evaluating parameters when not necessary.
+            report.debug(u"rejecting packet, destination: %s, expecting: %s", {destination, _dest_addr});
         }
+        return false;
+    }
 
-        // Keep track of senders (sources) to detect or filter multiple sources.
-        if (_sources.count(sender) == 0) {
-            // Detected an additional source, warn the user that distinct streams are potentially mixed.
-            // If no source filtering is applied, this is a warning since this may affect the resulting stream.
-            // With source filtering, this is just an informational verbose-level message.
-            const int level = _use_source.hasAddress() ? Severity::Verbose : Severity::Warning;
-            if (_sources.size() == 1) {
-                report.log(level, u"detected multiple sources for the same destination %s with potentially distinct streams", {destination});
-                report.log(level, u"detected source: %s", {_first_source});
-            }
-            report.log(level, u"detected source: %s", {sender});
-            _sources.insert(sender);
+    // Keep track of the first sender address.
+    if (!_first_source.hasAddress()) {
+        // First packet, keep address of the sender.
+        _first_source = sender;
+        _sources.insert(sender);
+
+        // With option --first-source, use this one to filter packets.
+        if (_use_first_source) {
+            assert(!_use_source.hasAddress());
+            _use_source = sender;
+            report.verbose(u"now filtering on source address %s", {sender});
         }
+    }
 
-        // Filter packets based on source address if requested.
-        if (!sender.match(_use_source)) {
-            // Not the expected source, this is a spurious packet.
-            if (report.maxSeverity() >= Severity::Debug) {
-                // Prior report level checking to avoid evaluating parameters when not necessary.
-                report.debug(u"rejecting packet, source: %s, expecting: %s", {sender, _use_source});
-            }
-            continue;
+    // Keep track of senders (sources) to detect or filter multiple sources.
+    if (_sources.count(sender) == 0) {
+        // Detected an additional source, warn the user that distinct streams are potentially mixed.
+        // If no source filtering is applied, this is a warning since this may affect the resulting stream.
+        // With source filtering, this is just an informational verbose-level message.
+        const int level = _use_source.hasAddress() ? Severity::Verbose : Severity::Warning;
+        if (_sources.size() == 1) {
+            report.log(level, u"detected multiple sources for the same destination %s with potentially distinct streams", {destination});
+            report.log(level, u"detected source: %s", {_first_source});
         }
+        report.log(level, u"detected source: %s", {sender});
+        _sources.insert(sender);
+    }
 
-        // Now found a packet matching all criteria.
-        return true;
+    // Filter packets based on source address if requested.
+    if (!sender.match(_use_source)) {
+        // Not the expected source, this is a spurious packet.
+        if (report.maxSeverity() >= Severity::Debug) {
+            // Prior report level checking to avoid evaluating parameters when not necessary.
+            report.debug(u"rejecting packet, source: %s, expecting: %s", {sender, _use_source});
+        }
+        return false;
     }
+
+    // Now found a packet matching all criteria.
+    return true;
 }
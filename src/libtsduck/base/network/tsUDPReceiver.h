@@ -90,6 +90,16 @@ namespace ts {
                              SocketAddress& destination,
                              const AbortInterface* abort = nullptr,
                              Report& report = CERR) override;
+        virtual bool receiveBatch(void* data,
+                                  size_t max_size,
+                                  size_t max_count,
+                                  size_t& ret_count,
+                                  size_t* ret_sizes,
+                                  SocketAddress* senders,
+                                  SocketAddress* destinations,
+                                  MicroSecond* timestamps = nullptr,
+                                  const AbortInterface* abort = nullptr,
+                                  Report& report = CERR) override;
 
     private:
         bool                    _with_short_options;
@@ -103,8 +113,12 @@ namespace ts {
         bool                    _use_first_source;   // Use socket address of first received packet to filter subsequent packets.
         size_t                  _recv_bufsize;       // Socket receive buffer size.
         MilliSecond             _recv_timeout;       // Receive timeout.
+        bool                    _recv_timestamps;    // Request kernel time stamps on received packets.
         SocketAddress           _use_source;         // Filter on this socket address of sender (can be a simple filter of an SSM source).
         SocketAddress           _first_source;       // Socket address of first received packet.
         std::set<SocketAddress> _sources;            // Set of all detected packet sources.
+
+        // Check if a received message matches the filtering criteria.
+        bool acceptMessage(const SocketAddress& sender, const SocketAddress& destination, Report& report);
     };
 }
@@ -33,8 +33,25 @@
 
 #include "tsUDPSocket.h"
 #include "tsNullReport.h"
+#include "tsTime.h"
+#if defined(TS_LINUX)
+#include <netinet/udp.h>
+#include <linux/net_tstamp.h>
+#endif
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::UDPSocket::MAX_BATCH_MESSAGES;
+#endif
+
+// Limits of UDP segmentation offload (Linux): number of segments and total size.
+#if defined(TS_LINUX) && defined(UDP_SEGMENT)
+namespace {
+    constexpr size_t MAX_GSO_SEGMENTS = 64;
+    constexpr size_t MAX_GSO_SIZE = 65000;
+}
+#endif
+
 // Furiously idiotic Windows feature, see comment in receiveOne()
 #if defined(TS_WINDOWS)
 volatile ::LPFN_WSARECVMSG ts::UDPSocket::_wsaRevcMsg = 0;
@@ -50,7 +67,9 @@ ts::UDPSocket::UDPSocket(bool auto_open, Report& report) :
     _local_address(),
     _default_destination(),
     _mcast(),
-    _ssmcast()
+    _ssmcast(),
+    _no_gso(false),
+    _txtime_clock(-1)
 {
     if (auto_open) {
         // Returned value ignored on purpose, the socket is marked as closed in the object on error.
@@ -238,6 +257,80 @@ bool ts::UDPSocket::setBroadcast(bool on, Report& report)
 }
 
 
+//----------------------------------------------------------------------------
+// Enable or disable the reception of kernel time stamps.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::setReceiveTimestamps(bool on, Report& report)
+{
+#if defined(SO_TIMESTAMPNS) || (defined(SO_TIMESTAMP) && !defined(TS_WINDOWS))
+    int enable = int(on);
+    report.debug(u"setting socket receive time stamps to %s", {on});
+#if defined(SO_TIMESTAMPNS)
+    const int option = SO_TIMESTAMPNS;
+#else
+    const int option = SO_TIMESTAMP;
+#endif
+    if (::setsockopt(getSocket(), SOL_SOCKET, option, TS_SOCKOPT_T(&enable), sizeof(enable)) != 0) {
+        report.error(u"socket option receive time stamps: " + SocketErrorCodeMessage());
+        return false;
+    }
+    return true;
+#else
+    if (on) {
+        report.error(u"kernel time stamps on received messages are not supported on this system");
+    }
+    return !on;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Enable or disable transmission times on sent messages.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::setTransmitTime(bool on, bool tai, Report& report)
+{
+#if defined(TS_LINUX) && defined(SO_TXTIME)
+    if (!on) {
+        // Transmission times are simply no longer passed to the kernel.
+        _txtime_clock = -1;
+        return true;
+    }
+    ::sock_txtime txtime;
+    TS_ZERO(txtime);
+    txtime.clockid = tai ? CLOCK_TAI : CLOCK_MONOTONIC;
+    txtime.flags = 0;
+    report.debug(u"setting socket transmission time, clock: %s", {tai ? u"TAI" : u"monotonic"});
+    if (::setsockopt(getSocket(), SOL_SOCKET, SO_TXTIME, TS_SOCKOPT_T(&txtime), sizeof(txtime)) != 0) {
+        report.error(u"socket option transmission time: " + SocketErrorCodeMessage());
+        return false;
+    }
+    _txtime_clock = int(txtime.clockid);
+    return true;
+#else
+    if (on) {
+        report.error(u"transmission times on sent messages are not supported on this system");
+    }
+    return !on;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Get the current time in the clock of transmission times.
+//----------------------------------------------------------------------------
+
+ts::NanoSecond ts::UDPSocket::getTransmitClock() const
+{
+#if defined(TS_LINUX) && defined(SO_TXTIME)
+    return _txtime_clock < 0 ? 0 : Time::UnixClockNanoSeconds(clockid_t(_txtime_clock));
+#else
+    return 0;
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Enable or disable the broadcast option, based on an IP address.
 //----------------------------------------------------------------------------
@@ -403,6 +496,211 @@ bool ts::UDPSocket::send(const void* data, size_t size, const SocketAddress& des
 }
 
 
+//----------------------------------------------------------------------------
+// Send several contiguous messages to a destination address and port.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::sendBatch(const void* data, size_t size, size_t msg_size, Report& report)
+{
+    return sendBatch(data, size, msg_size, _default_destination, report);
+}
+
+bool ts::UDPSocket::sendBatch(const void* data, size_t size, size_t msg_size, const SocketAddress& dest, Report& report)
+{
+    // Trivial case, one single message.
+    if (msg_size == 0 || size <= msg_size) {
+        return send(data, size, dest, report);
+    }
+
+    ::sockaddr addr;
+    dest.copy(addr);
+
+    const uint8_t* msg = reinterpret_cast<const uint8_t*>(data);
+    while (size > 0) {
+        size_t sent_size = 0;
+        const SocketErrorCode err = sendMany(msg, size, msg_size, addr, sent_size, report);
+        if (err == SYS_SUCCESS) {
+            assert(sent_size <= size);
+            msg += sent_size;
+            size -= sent_size;
+        }
+#if !defined(TS_WINDOWS)
+        else if (err == EINTR) {
+            // Got a signal, retry.
+            report.debug(u"signal, not user interrupt");
+        }
+#endif
+        else {
+            report.error(u"error sending UDP message: " + SocketErrorCodeMessage(err));
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Send several contiguous messages with transmission times.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::sendBatchAt(const void* data, size_t size, size_t msg_size, const NanoSecond* times, Report& report)
+{
+#if defined(TS_LINUX) && defined(SO_TXTIME)
+    if (_txtime_clock < 0) {
+        report.error(u"transmission times are not enabled on the socket");
+        return false;
+    }
+
+    ::sockaddr addr;
+    _default_destination.copy(addr);
+
+    ::mmsghdr msgs[MAX_BATCH_MESSAGES];
+    ::iovec vecs[MAX_BATCH_MESSAGES];
+    union {
+        uint8_t buf[CMSG_SPACE(sizeof(uint64_t))];
+        ::cmsghdr align;
+    } ancil[MAX_BATCH_MESSAGES];
+
+    const uint8_t* msg = reinterpret_cast<const uint8_t*>(data);
+    while (size > 0) {
+        // Send up to MAX_BATCH_MESSAGES messages in one system call, each one with its transmission time.
+        const size_t count = msg_size == 0 ? 1 : std::min(MAX_BATCH_MESSAGES, (size + msg_size - 1) / msg_size);
+        ::memset(msgs, 0, count * sizeof(msgs[0]));
+        ::memset(ancil, 0, count * sizeof(ancil[0]));
+        for (size_t i = 0; i < count; ++i) {
+            vecs[i].iov_base = const_cast<uint8_t*>(msg + i * msg_size);
+            vecs[i].iov_len = msg_size == 0 ? size : std::min(msg_size, size - i * msg_size);
+            msgs[i].msg_hdr.msg_name = &addr;
+            msgs[i].msg_hdr.msg_namelen = sizeof(addr);
+            msgs[i].msg_hdr.msg_iov = &vecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_control = ancil[i].buf;
+            msgs[i].msg_hdr.msg_controllen = sizeof(ancil[i].buf);
+            ::cmsghdr* cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_TXTIME;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+            const uint64_t txtime = uint64_t(std::max<NanoSecond>(times[i], 0));
+            ::memcpy(CMSG_DATA(cmsg), &txtime, sizeof(txtime));
+        }
+        const int sent = ::sendmmsg(getSocket(), msgs, unsigned(count), 0);
+        if (sent < 0) {
+            const SocketErrorCode err = LastSocketErrorCode();
+            if (err == EINTR) {
+                // Got a signal, retry.
+                report.debug(u"signal, not user interrupt");
+                continue;
+            }
+            report.error(u"error sending UDP message: " + SocketErrorCodeMessage(err));
+            return false;
+        }
+        const size_t sent_size = msg_size == 0 ? size : std::min(size, size_t(sent) * msg_size);
+        msg += sent_size;
+        size -= sent_size;
+        times += sent;
+    }
+    return true;
+#else
+    report.error(u"transmission times on sent messages are not supported on this system");
+    return false;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Send a group of messages using one system call, when possible.
+//----------------------------------------------------------------------------
+
+ts::SocketErrorCode ts::UDPSocket::sendMany(const uint8_t* data, size_t size, size_t msg_size, ::sockaddr& addr, size_t& sent_size, Report& report)
+{
+    sent_size = 0;
+
+#if defined(TS_LINUX)
+
+#if defined(UDP_SEGMENT)
+    // With UDP segmentation offload (GSO), one single large buffer is passed to the
+    // kernel which splits it into datagrams of msg_size bytes. This is the fastest way.
+    const size_t gso_count = std::min(MAX_GSO_SEGMENTS, MAX_GSO_SIZE / msg_size);
+    if (!_no_gso && gso_count >= 2) {
+        const size_t gso_size = std::min(size, gso_count * msg_size);
+
+        ::iovec vec;
+        TS_ZERO(vec);
+        vec.iov_base = const_cast<uint8_t*>(data);
+        vec.iov_len = gso_size;
+
+        // Ancillary data containing the segment size.
+        union {
+            uint8_t buf[CMSG_SPACE(sizeof(uint16_t))];
+            ::cmsghdr align;
+        } ancil;
+        TS_ZERO(ancil);
+
+        ::msghdr hdr;
+        TS_ZERO(hdr);
+        hdr.msg_name = &addr;
+        hdr.msg_namelen = sizeof(addr);
+        hdr.msg_iov = &vec;
+        hdr.msg_iovlen = 1;
+        hdr.msg_control = ancil.buf;
+        hdr.msg_controllen = sizeof(ancil.buf);
+
+        ::cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        const uint16_t segment = uint16_t(msg_size);
+        ::memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+
+        if (::sendmsg(getSocket(), &hdr, 0) >= 0) {
+            sent_size = gso_size;
+            return SYS_SUCCESS;
+        }
+        const SocketErrorCode err = LastSocketErrorCode();
+        if (err != EIO && err != EINVAL && err != ENOPROTOOPT && err != EOPNOTSUPP) {
+            return err;
+        }
+        // UDP segmentation offload not supported by the system or the network interface.
+        // Use sendmmsg() from now on.
+        report.debug(u"UDP segmentation offload not supported (%s), using sendmmsg", {SocketErrorCodeMessage(err)});
+        _no_gso = true;
+    }
+#endif // UDP_SEGMENT
+
+    // Send up to MAX_BATCH_MESSAGES distinct messages in one system call.
+    const size_t count = std::min(MAX_BATCH_MESSAGES, (size + msg_size - 1) / msg_size);
+    ::mmsghdr msgs[MAX_BATCH_MESSAGES];
+    ::iovec vecs[MAX_BATCH_MESSAGES];
+    ::memset(msgs, 0, count * sizeof(msgs[0]));
+
+    for (size_t i = 0; i < count; ++i) {
+        vecs[i].iov_base = const_cast<uint8_t*>(data + i * msg_size);
+        vecs[i].iov_len = std::min(msg_size, size - i * msg_size);
+        msgs[i].msg_hdr.msg_name = &addr;
+        msgs[i].msg_hdr.msg_namelen = sizeof(addr);
+        msgs[i].msg_hdr.msg_iov = &vecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    const int sent = ::sendmmsg(getSocket(), msgs, unsigned(count), 0);
+    if (sent < 0) {
+        return LastSocketErrorCode();
+    }
+    sent_size = std::min(size, size_t(sent) * msg_size);
+
+#else
+    // Other systems, send messages one by one.
+    const size_t len = std::min(size, msg_size);
+    if (::sendto(getSocket(), TS_SENDBUF_T(data), TS_SOCKET_SSIZE_T(len), 0, &addr, sizeof(addr)) < 0) {
+        return LastSocketErrorCode();
+    }
+    sent_size = len;
+#endif
+
+    return SYS_SUCCESS;
+}
+
+
 //----------------------------------------------------------------------------
 // Receive a message.
 // If abort interface is non-zero, invoke it when I/O is interrupted
@@ -422,7 +720,8 @@ bool ts::UDPSocket::receive(void* data,
     for (;;) {
 
         // Wait for a message.
-        const SocketErrorCode err = receiveOne(data, max_size, ret_size, sender, destination, report);
+        MicroSecond timestamp = -1;
+        const SocketErrorCode err = receiveOne(data, max_size, ret_size, sender, destination, timestamp, report);
 
         if (abort != nullptr && abort->aborting()) {
             // Aborting, no error message.
@@ -453,16 +752,154 @@ bool ts::UDPSocket::receive(void* data,
 }
 
 
+//----------------------------------------------------------------------------
+// Receive several messages.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::receiveBatch(void* data,
+                                 size_t max_size,
+                                 size_t max_count,
+                                 size_t& ret_count,
+                                 size_t* ret_sizes,
+                                 SocketAddress* senders,
+                                 SocketAddress* destinations,
+                                 MicroSecond* timestamps,
+                                 const AbortInterface* abort,
+                                 Report& report)
+{
+    ret_count = 0;
+    if (max_count == 0) {
+        return true;
+    }
+
+    // Loop on unsollicited interrupts
+    for (;;) {
+
+        // Wait for messages.
+        const SocketErrorCode err = receiveMany(data, max_size, max_count, ret_count, ret_sizes, senders, destinations, timestamps, report);
+
+        if (abort != nullptr && abort->aborting()) {
+            // Aborting, no error message.
+            return false;
+        }
+        else if (err == SYS_SUCCESS) {
+            // Sometimes, we get "successful" empty message coming from nowhere. Remove them.
+            uint8_t* const base = reinterpret_cast<uint8_t*>(data);
+            size_t count = 0;
+            for (size_t i = 0; i < ret_count; ++i) {
+                if (ret_sizes[i] > 0 || senders[i].hasAddress()) {
+                    if (count < i) {
+                        ::memmove(base + count * max_size, base + i * max_size, ret_sizes[i]);
+                        ret_sizes[count] = ret_sizes[i];
+                        senders[count] = senders[i];
+                        destinations[count] = destinations[i];
+                        if (timestamps != nullptr) {
+                            timestamps[count] = timestamps[i];
+                        }
+                    }
+                    count++;
+                }
+            }
+            ret_count = count;
+            if (ret_count > 0) {
+                return true;
+            }
+        }
+        else if (abort != nullptr && abort->aborting()) {
+            // User-interrupt, end of processing but no error message
+            return false;
+        }
+#if !defined(TS_WINDOWS)
+        else if (err == EINTR) {
+            // Got a signal, not a user interrupt, will ignore it
+            report.debug(u"signal, not user interrupt");
+        }
+#endif
+        else {
+            // Abort on non-interrupt errors.
+            report.error(u"error receiving from UDP socket: %s", {SocketErrorCodeMessage(err)});
+            return false;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Perform one batch receive operation.
+//----------------------------------------------------------------------------
+
+ts::SocketErrorCode ts::UDPSocket::receiveMany(void* data, size_t max_size, size_t max_count, size_t& ret_count, size_t* ret_sizes, SocketAddress* senders, SocketAddress* destinations, MicroSecond* timestamps, Report& report)
+{
+    ret_count = 0;
+
+#if defined(TS_LINUX)
+
+    // Receive up to MAX_BATCH_MESSAGES messages in one system call.
+    // With MSG_WAITFORONE, recvmmsg() waits for the first message only.
+    max_count = std::min(max_count, MAX_BATCH_MESSAGES);
+
+    ::mmsghdr msgs[MAX_BATCH_MESSAGES];
+    ::iovec vecs[MAX_BATCH_MESSAGES];
+    ::sockaddr sender_socks[MAX_BATCH_MESSAGES];
+    uint8_t ancil_data[MAX_BATCH_MESSAGES][128];
+
+    ::memset(msgs, 0, max_count * sizeof(msgs[0]));
+    ::memset(sender_socks, 0, max_count * sizeof(sender_socks[0]));
+
+    for (size_t i = 0; i < max_count; ++i) {
+        vecs[i].iov_base = reinterpret_cast<uint8_t*>(data) + i * max_size;
+        vecs[i].iov_len = max_size;
+        msgs[i].msg_hdr.msg_name = &sender_socks[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(sender_socks[i]);
+        msgs[i].msg_hdr.msg_iov = &vecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = ancil_data[i];
+        msgs[i].msg_hdr.msg_controllen = sizeof(ancil_data[i]);
+    }
+
+    const int count = ::recvmmsg(getSocket(), msgs, unsigned(max_count), MSG_WAITFORONE, nullptr);
+    if (count < 0) {
+        return LastSocketErrorCode();
+    }
+
+    for (size_t i = 0; i < size_t(count); ++i) {
+        ret_sizes[i] = size_t(msgs[i].msg_len);
+        senders[i] = SocketAddress(sender_socks[i]);
+        MicroSecond timestamp = -1;
+        getAncillaryData(&msgs[i].msg_hdr, destinations[i], timestamp);
+        if (timestamps != nullptr) {
+            timestamps[i] = timestamp;
+        }
+    }
+    ret_count = size_t(count);
+    return SYS_SUCCESS;
+
+#else
+    // Other systems, receive one single message.
+    MicroSecond timestamp = -1;
+    const SocketErrorCode err = receiveOne(data, max_size, ret_sizes[0], senders[0], destinations[0], timestamp, report);
+    if (timestamps != nullptr) {
+        timestamps[0] = timestamp;
+    }
+    if (err == SYS_SUCCESS) {
+        ret_count = 1;
+    }
+    return err;
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Perform one receive operation. Hide the system mud.
 //----------------------------------------------------------------------------
 
-ts::SocketErrorCode ts::UDPSocket::receiveOne(void* data, size_t max_size, size_t& ret_size, SocketAddress& sender, SocketAddress& destination, Report& report)
+ts::SocketErrorCode ts::UDPSocket::receiveOne(void* data, size_t max_size, size_t& ret_size, SocketAddress& sender, SocketAddress& destination, MicroSecond& timestamp, Report& report)
 {
     // Clear returned values
     ret_size = 0;
     sender.clear();
     destination.clear();
+    timestamp = -1;
 
     // Reserve a socket address to receive the sender address.
     ::sockaddr sender_sock;
@@ -563,12 +1000,7 @@ ts::SocketErrorCode ts::UDPSocket::receiveOne(void* data, size_t max_size, size_
     }
 
     // Browse returned ancillary data.
-    for (::cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
-        if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_PKTINFO && cmsg->cmsg_len >= sizeof(::in_pktinfo)) {
-            const ::in_pktinfo* info = reinterpret_cast<const ::in_pktinfo*>(CMSG_DATA(cmsg));
-            destination = SocketAddress(info->ipi_addr, _local_address.port());
-        }
-    }
+    getAncillaryData(&hdr, destination, timestamp);
 
 #endif // Windows vs. UNIX
 
@@ -578,3 +1010,37 @@ ts::SocketErrorCode ts::UDPSocket::receiveOne(void* data, size_t max_size, size_
 
     return SYS_SUCCESS;
 }
+
+
+//----------------------------------------------------------------------------
+// Analyze the ancillary data of a received message (UNIX only).
+//----------------------------------------------------------------------------
+
+#if !defined(TS_WINDOWS)
+void ts::UDPSocket::getAncillaryData(::msghdr* hdr, SocketAddress& destination, MicroSecond& timestamp) const
+{
+    destination.clear();
+    timestamp = -1;
+
+    for (::cmsghdr* cmsg = CMSG_FIRSTHDR(hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+        if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_PKTINFO && cmsg->cmsg_len >= sizeof(::in_pktinfo)) {
+            const ::in_pktinfo* info = reinterpret_cast<const ::in_pktinfo*>(CMSG_DATA(cmsg));
+            destination = SocketAddress(info->ipi_addr, _local_address.port());
+        }
+#if defined(SCM_TIMESTAMPNS)
+        else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS && cmsg->cmsg_len >= CMSG_LEN(sizeof(::timespec))) {
+            ::timespec ts;
+            ::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            timestamp = MicroSecond(ts.tv_sec) * MicroSecPerSec + MicroSecond(ts.tv_nsec) / 1000;
+        }
+#endif
+#if defined(SCM_TIMESTAMP)
+        else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMP && cmsg->cmsg_len >= CMSG_LEN(sizeof(::timeval))) {
+            ::timeval tv;
+            ::memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+            timestamp = MicroSecond(tv.tv_sec) * MicroSecPerSec + MicroSecond(tv.tv_usec);
+        }
+#endif
+    }
+}
+#endif
@@ -197,6 +197,43 @@ namespace ts {
         //!
         bool setBroadcast(bool on, Report& report = CERR);
 
+        //!
+        //! Enable or disable the reception of kernel time stamps on received messages.
+        //!
+        //! When enabled, the system time stamps each received message as soon as it is received
+        //! by the network stack. The time stamps are returned by receiveBatch(). This is supported
+        //! on Linux (nanosecond resolution, SO_TIMESTAMPNS) and most UNIX systems (microsecond
+        //! resolution, SO_TIMESTAMP). This is not supported on Windows.
+        //!
+        //! @param [in] on If true, kernel time stamps are activated on the socket. Otherwise, they are disabled.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        bool setReceiveTimestamps(bool on, Report& report = CERR);
+
+        //!
+        //! Enable or disable transmission times on sent messages.
+        //!
+        //! When enabled, each message which is sent using sendBatchAt() carries a transmission
+        //! time. The message is held by the kernel until this time and is then transmitted. This
+        //! requires a queuing discipline which supports transmission times on the output interface,
+        //! typically "fq" or "etf". This is supported on Linux only (SO_TXTIME socket option).
+        //!
+        //! @param [in] on If true, transmission times are activated on the socket. Otherwise, they are disabled.
+        //! @param [in] tai If true, transmission times are expressed in the TAI clock, as required by the "etf"
+        //! queuing discipline. Otherwise, they are expressed in the monotonic clock, as required by "fq".
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        bool setTransmitTime(bool on, bool tai, Report& report = CERR);
+
+        //!
+        //! Get the current time in the clock of transmission times.
+        //! @return The current time in nanoseconds, in the clock which was specified in setTransmitTime().
+        //! Zero if transmission times are not enabled on the socket.
+        //!
+        NanoSecond getTransmitClock() const;
+
         //!
         //! Enable or disable the broadcast option, based on an IP address.
         //!
@@ -312,6 +349,94 @@ namespace ts {
                              const AbortInterface* abort = nullptr,
                              Report& report = CERR);
 
+        //!
+        //! Maximum number of messages which are sent or received in one system call.
+        //! Larger batches are split in several system calls.
+        //!
+        static constexpr size_t MAX_BATCH_MESSAGES = 64;
+
+        //!
+        //! Send several messages to a destination address and port.
+        //!
+        //! The messages are contiguous in memory and all messages have the same size,
+        //! except the last one which can be shorter. On Linux, the messages are sent
+        //! using one system call per group of messages, either using UDP segmentation
+        //! offload (GSO) when the system supports it, or using sendmmsg(). On other
+        //! systems, the messages are sent one by one.
+        //!
+        //! @param [in] data Address of the first message to send.
+        //! @param [in] size Total size in bytes of all messages to send.
+        //! @param [in] msg_size Size in bytes of each message.
+        //! @param [in] destination Socket address of the destination.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        virtual bool sendBatch(const void* data, size_t size, size_t msg_size, const SocketAddress& destination, Report& report = CERR);
+
+        //!
+        //! Send several messages to the default destination address and port.
+        //! @param [in] data Address of the first message to send.
+        //! @param [in] size Total size in bytes of all messages to send.
+        //! @param [in] msg_size Size in bytes of each message. The last message can be shorter.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //! @see sendBatch(const void*, size_t, size_t, const SocketAddress&, Report&)
+        //!
+        virtual bool sendBatch(const void* data, size_t size, size_t msg_size, Report& report = CERR);
+
+        //!
+        //! Send several messages to the default destination address and port, with transmission times.
+        //!
+        //! The transmission times must have been enabled on the socket using setTransmitTime().
+        //! The messages are sent using sendmmsg(), one system call per group of messages.
+        //!
+        //! @param [in] data Address of the first message to send.
+        //! @param [in] size Total size in bytes of all messages to send.
+        //! @param [in] msg_size Size in bytes of each message. The last message can be shorter.
+        //! @param [in] times Array of transmission times, one per message, in nanoseconds,
+        //! in the clock which was specified in setTransmitTime().
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //! @see setTransmitTime()
+        //!
+        bool sendBatchAt(const void* data, size_t size, size_t msg_size, const NanoSecond* times, Report& report = CERR);
+
+        //!
+        //! Receive several messages.
+        //!
+        //! The method waits for at least one message and returns all messages which are
+        //! immediately available, up to @a max_count. On Linux, all messages are received
+        //! using one single system call (recvmmsg()). On other systems, one single message
+        //! is returned.
+        //!
+        //! @param [out] data Address of the buffer for the received messages. The buffer
+        //! must contain at least @a max_count * @a max_size bytes. The message of index @e i
+        //! is received at address @a data + @e i * @a max_size.
+        //! @param [in] max_size Maximum size in bytes of each message.
+        //! @param [in] max_count Maximum number of messages to receive.
+        //! @param [out] ret_count Number of received messages.
+        //! @param [out] ret_sizes Array of @a max_count elements, receiving the size in bytes of each message.
+        //! @param [out] senders Array of @a max_count elements, receiving the socket address of the sender of each message.
+        //! @param [out] destinations Array of @a max_count elements, receiving the socket address of the destination of each message.
+        //! @param [out] timestamps If not null, array of @a max_count elements, receiving the kernel reception time stamp
+        //! of each message in micro-seconds since 1970-01-01 UTC. A negative value means that the time stamp is not
+        //! available. Kernel time stamps must be enabled first using setReceiveTimestamps().
+        //! @param [in] abort If non-zero, invoked when I/O is interrupted
+        //! (in case of user-interrupt, return, otherwise retry).
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        virtual bool receiveBatch(void* data,
+                                  size_t max_size,
+                                  size_t max_count,
+                                  size_t& ret_count,
+                                  size_t* ret_sizes,
+                                  SocketAddress* senders,
+                                  SocketAddress* destinations,
+                                  MicroSecond* timestamps = nullptr,
+                                  const AbortInterface* abort = nullptr,
+                                  Report& report = CERR);
+
         // Implementation of Socket interface.
         virtual bool open(Report& report = CERR) override;
         virtual bool close(Report& report = CERR) override;
@@ -371,11 +496,24 @@ namespace ts {
         SocketAddress _default_destination;
         MReqSet       _mcast;    // Current set of multicast memberships
         SSMReqSet     _ssmcast;  // Current set of source-specific multicast memberships
+        bool          _no_gso;   // UDP segmentation offload failed, don't use it again
+        int           _txtime_clock; // Clock of transmission times (SO_TXTIME), negative if disabled
 
         // Perform one receive operation. Hide the system mud.
-        SocketErrorCode receiveOne(void* data, size_t max_size, size_t& ret_size, SocketAddress& sender, SocketAddress& destination, Report& report);
+        SocketErrorCode receiveOne(void* data, size_t max_size, size_t& ret_size, SocketAddress& sender, SocketAddress& destination, MicroSecond& timestamp, Report& report);
+
+        // Perform one batch receive operation, return at least one message.
+        SocketErrorCode receiveMany(void* data, size_t max_size, size_t max_count, size_t& ret_count, size_t* ret_sizes, SocketAddress* senders, SocketAddress* destinations, MicroSecond* timestamps, Report& report);
+
+        // Send a group of messages using one system call, when possible.
+        SocketErrorCode sendMany(const uint8_t* data, size_t size, size_t msg_size, ::sockaddr& addr, size_t& sent_size, Report& report);
 
         // Furiously idiotic Windows feature, see comment in receiveOne()
+#if !defined(TS_WINDOWS)
+        // Analyze the ancillary data of a received message: destination address and time stamp.
+        void getAncillaryData(::msghdr* hdr, SocketAddress& destination, MicroSecond& timestamp) const;
+#endif
+
 #if defined(TS_WINDOWS)
         static volatile ::LPFN_WSARECVMSG _wsaRevcMsg;
 #endif
@@ -32,6 +32,26 @@
 //----------------------------------------------------------------------------
 
 #include "tsMemory.h"
+#include "tsSysInfo.h"
+
+// SIMD kernels for start code scanning. SSE2 is always available on x86_64
+// and Neon on Arm64. The AVX2 kernel is compiled for its specific instruction
+// set and used only after checking at run time that the CPU supports it.
+#if defined(TS_X86_64) && defined(TS_GCC)
+    #define TS_STARTCODE_SSE2 1
+    #define TS_STARTCODE_AVX2 1
+    #define TS_STARTCODE_AVX2_TARGET __attribute__((target("avx2")))
+    #include <immintrin.h>
+#elif defined(TS_X86_64) && defined(TS_MSC)
+    #define TS_STARTCODE_SSE2 1
+    #define TS_STARTCODE_AVX2 1
+    #define TS_STARTCODE_AVX2_TARGET
+    #include <intrin.h>
+#elif defined(TS_ARM64) && defined(TS_GCC)
+    #define TS_STARTCODE_NEON 1
+    #include <arm_neon.h>
+#endif
+
 TSDUCK_SOURCE;
 
 
@@ -71,6 +91,152 @@ const void* ts::LocatePattern(const void* area, size_t area_size, const void* pa
 }
 
 
+//----------------------------------------------------------------------------
+// Locate all video start code prefixes in a memory area.
+//
+// The SIMD kernels compare 16 or 32 consecutive positions at a time: three
+// unaligned loads at offsets 0, 1 and 2 provide the three bytes of the
+// sequence for each position. The resulting bit mask is then scanned for the
+// matching positions. The kernels return the first position they did not
+// check, the end of the area is processed by the scalar code.
+//----------------------------------------------------------------------------
+
+namespace {
+
+#if defined(TS_STARTCODE_SSE2) || defined(TS_STARTCODE_NEON)
+
+    // Index of the lowest bit set in a non-zero value.
+    inline size_t LowestBit(uint64_t x)
+    {
+#if defined(TS_MSC)
+        unsigned long index = 0;
+        _BitScanForward64(&index, x);
+        return size_t(index);
+#else
+        return size_t(__builtin_ctzll(x));
+#endif
+    }
+
+#endif
+
+    // Portable version. Skip positions using the value of the third byte: when
+    // it is greater than 1, no sequence can start at any of the three positions.
+    void StartCodesScalar(std::vector<size_t>& offsets, const uint8_t* data, size_t index, size_t size, bool with_zeroes)
+    {
+        const uint8_t min_third = with_zeroes ? 0 : 1;
+        while (index + 2 < size) {
+            const uint8_t third = data[index + 2];
+            if (third > 1) {
+                index += 3;
+            }
+            else if (data[index + 1] != 0) {
+                index += 2;
+            }
+            else {
+                if (data[index] == 0 && third >= min_third) {
+                    offsets.push_back(index);
+                }
+                index++;
+            }
+        }
+    }
+
+#if defined(TS_STARTCODE_SSE2)
+
+    size_t StartCodesSSE2(std::vector<size_t>& offsets, const uint8_t* data, size_t size, bool with_zeroes)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi8(1);
+        size_t index = 0;
+        for (; index + 18 <= size; index += 16) {
+            const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+            const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index + 1));
+            const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index + 2));
+            // Third byte is 01, or 00 or 01 when min(b2,1) == b2.
+            const __m128i third = with_zeroes ? _mm_cmpeq_epi8(_mm_min_epu8(b2, one), b2) : _mm_cmpeq_epi8(b2, one);
+            uint32_t bits = uint32_t(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(_mm_or_si128(b0, b1), zero), third)));
+            while (bits != 0) {
+                offsets.push_back(index + LowestBit(bits));
+                bits &= bits - 1;
+            }
+        }
+        return index;
+    }
+
+#endif
+
+#if defined(TS_STARTCODE_AVX2)
+
+    TS_STARTCODE_AVX2_TARGET size_t StartCodesAVX2(std::vector<size_t>& offsets, const uint8_t* data, size_t size, bool with_zeroes)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i one = _mm256_set1_epi8(1);
+        size_t index = 0;
+        for (; index + 34 <= size; index += 32) {
+            const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + index));
+            const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + index + 1));
+            const __m256i b2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + index + 2));
+            const __m256i third = with_zeroes ? _mm256_cmpeq_epi8(_mm256_min_epu8(b2, one), b2) : _mm256_cmpeq_epi8(b2, one);
+            uint32_t bits = uint32_t(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(_mm256_or_si256(b0, b1), zero), third)));
+            while (bits != 0) {
+                offsets.push_back(index + LowestBit(bits));
+                bits &= bits - 1;
+            }
+        }
+        return index;
+    }
+
+#endif
+
+#if defined(TS_STARTCODE_NEON)
+
+    size_t StartCodesNeon(std::vector<size_t>& offsets, const uint8_t* data, size_t size, bool with_zeroes)
+    {
+        const uint8x16_t one = vdupq_n_u8(1);
+        size_t index = 0;
+        for (; index + 18 <= size; index += 16) {
+            const uint8x16_t b0 = vld1q_u8(data + index);
+            const uint8x16_t b1 = vld1q_u8(data + index + 1);
+            const uint8x16_t b2 = vld1q_u8(data + index + 2);
+            const uint8x16_t third = with_zeroes ? vcleq_u8(b2, one) : vceqq_u8(b2, one);
+            const uint8x16_t match = vandq_u8(vceqzq_u8(vorrq_u8(b0, b1)), third);
+            // There is no "movemask" on Neon: narrow the mask to 4 bits per byte, keep one bit per byte.
+            uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(match), 4)), 0) & TS_UCONST64(0x8888888888888888);
+            while (bits != 0) {
+                offsets.push_back(index + LowestBit(bits) / 4);
+                bits &= bits - 1;
+            }
+        }
+        return index;
+    }
+
+#endif
+}
+
+void ts::LocateStartCodes(std::vector<size_t>& offsets, const void* area, size_t area_size, bool with_zeroes)
+{
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(area);
+    size_t index = 0;
+    offsets.clear();
+
+#if defined(TS_STARTCODE_AVX2)
+    static const bool avx2 = SysInfo::Instance()->avx2Instructions();
+    if (avx2) {
+        index = StartCodesAVX2(offsets, data, area_size, with_zeroes);
+    }
+    else {
+        index = StartCodesSSE2(offsets, data, area_size, with_zeroes);
+    }
+#elif defined(TS_STARTCODE_SSE2)
+    index = StartCodesSSE2(offsets, data, area_size, with_zeroes);
+#elif defined(TS_STARTCODE_NEON)
+    index = StartCodesNeon(offsets, data, area_size, with_zeroes);
+#endif
+
+    StartCodesScalar(offsets, data, index, area_size, with_zeroes);
+}
+
+
 //----------------------------------------------------------------------------
 // Check if a memory area contains all identical byte values.
 //----------------------------------------------------------------------------
@@ -78,6 +78,20 @@ namespace ts {
     //!
     TSDUCKDLL const void* LocatePattern(const void* area, size_t area_size, const void* pattern, size_t pattern_size);
 
+    //!
+    //! Locate all video start code prefixes in a memory area, in one single pass.
+    //! A start code prefix is the 3-byte sequence 00 00 01 (MPEG-1/2 video, AVC).
+    //! Optionally, the 3-byte sequences 00 00 00 are also located. In AVC, they
+    //! mark the end of a NAL unit when it is followed by trailing zero bytes.
+    //! The memory area is scanned using SIMD instructions when available.
+    //! @param [out] offsets Returned offsets, in increasing order, of the first byte of
+    //! all located 3-byte sequences. The previous content of the vector is erased.
+    //! @param [in] area Address of a memory area to check.
+    //! @param [in] area_size Size in bytes of the memory area.
+    //! @param [in] with_zeroes If true, also locate all 00 00 00 sequences.
+    //!
+    TSDUCKDLL void LocateStartCodes(std::vector<size_t>& offsets, const void* area, size_t area_size, bool with_zeroes = false);
+
     //!
     //! Check if a memory area contains all identical byte values.
     //! @param [in] area Address of a memory area to check.
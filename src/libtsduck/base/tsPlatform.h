@@ -881,6 +881,8 @@ TS_MSC_NOWARNING(5204)
 #include <list>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <bitset>
 #include <algorithm>
 #include <iterator>
@@ -893,6 +895,7 @@ TS_MSC_NOWARNING(5204)
 #include <iostream>
 #include <exception>
 #include <typeinfo>
+#include <atomic>
 
 #include <cassert>
 #include <cstdlib>
@@ -35,6 +35,14 @@
 #include <sys/param.h>
 #include <sys/sysctl.h>
 #endif
+#if defined(TS_X86_64) && defined(TS_GCC)
+#include <cpuid.h>
+#elif defined(TS_X86_64) && defined(TS_MSC)
+#include <intrin.h>
+#elif defined(TS_ARM64) && defined(TS_LINUX)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
 TSDUCK_SOURCE;
 
 // Define singleton instance
@@ -75,6 +83,9 @@ ts::SysInfo::SysInfo() :
 #else
     _isIntel64(false),
 #endif
+    _crcInstructions(false),
+    _aesInstructions(false),
+    _avx2Instructions(false),
     _systemVersion(),
     _systemName(),
     _hostName(),
@@ -202,6 +213,53 @@ ts::SysInfo::SysInfo() :
         _hostName.assignFromUTF8(name);
     }
 
+#endif
+
+    //
+    // Get CPU features.
+    //
+#if defined(TS_X86_64) && defined(TS_GCC)
+
+    // CPUID leaf 1, ECX: bit 1 = PCLMULQDQ, bit 9 = SSSE3, bit 25 = AES, bit 27 = OSXSAVE.
+    // AVX2 (leaf 7, EBX bit 5) is usable only if the OS saves the XMM and YMM registers (XCR0 bits 1 and 2).
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (::__get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0) {
+        _crcInstructions = (ecx & (1 << 1)) != 0 && (ecx & (1 << 9)) != 0;
+        _aesInstructions = (ecx & (1 << 25)) != 0;
+        if ((ecx & (1 << 27)) != 0) {
+            unsigned int xcr0 = 0, xcr0_high = 0;
+            __asm__("xgetbv" : "=a" (xcr0), "=d" (xcr0_high) : "c" (0));
+            if ((xcr0 & 0x06) == 0x06 && ::__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0) {
+                _avx2Instructions = (ebx & (1 << 5)) != 0;
+            }
+        }
+    }
+
+#elif defined(TS_X86_64) && defined(TS_MSC)
+
+    // CPUID leaf 1, ECX: bit 1 = PCLMULQDQ, bit 9 = SSSE3, bit 25 = AES, bit 27 = OSXSAVE.
+    // AVX2 (leaf 7, EBX bit 5) is usable only if the OS saves the XMM and YMM registers (XCR0 bits 1 and 2).
+    int regs[4] = {0, 0, 0, 0};
+    ::__cpuid(regs, 1);
+    _crcInstructions = (regs[2] & (1 << 1)) != 0 && (regs[2] & (1 << 9)) != 0;
+    _aesInstructions = (regs[2] & (1 << 25)) != 0;
+    if ((regs[2] & (1 << 27)) != 0 && (::_xgetbv(0) & 0x06) == 0x06) {
+        ::__cpuidex(regs, 7, 0);
+        _avx2Instructions = (regs[1] & (1 << 5)) != 0;
+    }
+
+#elif defined(TS_ARM64) && defined(TS_LINUX)
+
+    const unsigned long hwcap = ::getauxval(AT_HWCAP);
+    _crcInstructions = (hwcap & HWCAP_PMULL) != 0;
+    _aesInstructions = (hwcap & HWCAP_AES) != 0;
+
+#elif defined(TS_ARM64) && defined(TS_MAC)
+
+    // All Apple Arm64 CPU's have the cryptographic extension.
+    _crcInstructions = true;
+    _aesInstructions = true;
+
 #endif
 
     //
@@ -93,6 +93,24 @@ namespace ts {
         //!
         bool isIntel64() const { return _isIntel64; }
         //!
+        //! Check if the CPU supports carry-less multiplication instructions for CRC computation.
+        //! These are the PCLMULQDQ instructions on Intel CPU and the PMULL instructions on Arm64 CPU.
+        //! @return True if the CPU supports CRC acceleration instructions.
+        //!
+        bool crcInstructions() const { return _crcInstructions; }
+        //!
+        //! Check if the CPU supports AES instructions.
+        //! These are the AES-NI instructions on Intel CPU and the AES instructions
+        //! of the cryptographic extension on Arm64 CPU.
+        //! @return True if the CPU supports AES acceleration instructions.
+        //!
+        bool aesInstructions() const { return _aesInstructions; }
+        //!
+        //! Check if the CPU supports AVX2 instructions and the operating system saves the AVX registers.
+        //! @return True if AVX2 instructions can be used.
+        //!
+        bool avx2Instructions() const { return _avx2Instructions; }
+        //!
         //! Get the operating system version.
         //! @return The operating system version.
         //!
@@ -123,6 +141,9 @@ namespace ts {
         bool    _isWindows;
         bool    _isIntel32;
         bool    _isIntel64;
+        bool    _crcInstructions;
+        bool    _aesInstructions;
+        bool    _avx2Instructions;
         UString _systemVersion;
         UString _systemName;
         UString _hostName;
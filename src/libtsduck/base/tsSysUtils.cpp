@@ -689,7 +689,7 @@ ts::ErrorCode ts::TruncateFile(const UString& path, uint64_t size)
 ts::ErrorCode ts::RenameFile(const UString& old_path, const UString& new_path)
 {
 #if defined(TS_WINDOWS)
-    return ::MoveFileW(old_path.wc_str(), new_path.wc_str()) == 0 ? ::GetLastError() : ERROR_SUCCESS;
+    return ::MoveFileExW(old_path.wc_str(), new_path.wc_str(), MOVEFILE_REPLACE_EXISTING) == 0 ? ::GetLastError() : ERROR_SUCCESS;
 #else
     return ::rename(old_path.toUTF8().c_str(), new_path.toUTF8().c_str()) < 0 ? errno : 0;
 #endif
@@ -384,6 +384,9 @@ namespace ts {
     //! This method is not guaranteed to work when the new and old names
     //! are on distinct volumes or file systems.
     //!
+    //! If @a new_path is an existing file, it is replaced. On the same file
+    //! system, this is an atomic operation for the users of @a new_path.
+    //!
     //! @param [in] old_path The file path of an existing file or directory.
     //! @param [in] new_path The new name for the file or directory.
     //! @return A system-specific error code (SYS_SUCCESS on success).
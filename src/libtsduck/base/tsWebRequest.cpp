@@ -52,6 +52,7 @@ ts::WebRequest::WebRequest(Report& report) :
     _report(report),
     _userAgent(u"tsduck"),
     _autoRedirect(true),
+    _keepAlive(false),
     _originalURL(),
     _finalURL(),
     _connectionTimeout(0),
@@ -191,6 +191,20 @@ namespace ts {
             _autoRedirect = on;
         }
 
+        //!
+        //! Enable or disable the reuse of the network connection between successive requests.
+        //! When enabled, the underlying session is kept open after each download operation
+        //! and the next download with the same WebRequest instance reuses the established
+        //! connection when the server allows it (HTTP keep-alive). This avoids a new TCP
+        //! (and possibly TLS) handshake per request when downloading many small files
+        //! from the same server. This option is disabled by default.
+        //! @param [in] on If true, keep the connection open between requests.
+        //!
+        void setKeepAlive(bool on)
+        {
+            _keepAlive = on;
+        }
+
         //!
         //! Set various arguments from command line.
         //! @param [in] args Command line arguments.
@@ -301,6 +315,7 @@ namespace ts {
         Report&       _report;
         UString       _userAgent;
         bool          _autoRedirect;
+        bool          _keepAlive;
         UString       _originalURL;
         UString       _finalURL;
         MilliSecond   _connectionTimeout;
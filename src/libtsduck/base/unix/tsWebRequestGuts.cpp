@@ -121,8 +121,11 @@ public:
     ~SystemGuts();
 
     // Initialize, clear, start CURL Easy transfer.
+    // In keep-alive mode, clear() keeps the CURL Easy handle and its connection
+    // cache for the next transfer. Use close() to unconditionally release it.
     bool init();
     void clear();
+    void close();
     bool start();
 
     // Build an error message from libcurl.
@@ -156,7 +159,7 @@ ts::WebRequest::SystemGuts::SystemGuts(WebRequest& request) :
 
 ts::WebRequest::SystemGuts::~SystemGuts()
 {
-    clear();
+    close();
 }
 
 void ts::WebRequest::allocateGuts()
@@ -179,8 +182,14 @@ bool ts::WebRequest::SystemGuts::init()
     // Make sure we start from a clean state.
     clear();
 
+    // In keep-alive mode, clear() did not release the previous CURL Easy handle.
+    // Resetting its options preserves the live connections and the DNS cache.
+    if (_curl != nullptr) {
+        ::curl_easy_reset(_curl);
+    }
+
     // Initialize CURL Easy
-    if ((_curl = ::curl_easy_init()) == nullptr) {
+    if (_curl == nullptr && (_curl = ::curl_easy_init()) == nullptr) {
         _request._report.error(u"libcurl 'curl easy' initialization error");
         return false;
     }
@@ -289,7 +298,7 @@ bool ts::WebRequest::SystemGuts::init()
     // Now process setopt error.
     if (status != ::CURLE_OK) {
         _request._report.error(message(u"libcurl setopt error", status));
-        clear();
+        close();
         return false;
     }
 
@@ -309,16 +318,35 @@ void ts::WebRequest::SystemGuts::clear()
         _headers = nullptr;
     }
 
-    // Make sure the CURL Easy is clean.
+    // Make sure the CURL Easy is clean, unless kept for the next transfer.
     if (_curl != nullptr) {
-        ::curl_easy_cleanup(_curl);
-        _curl = nullptr;
+        if (!_request._keepAlive) {
+            ::curl_easy_cleanup(_curl);
+            _curl = nullptr;
+        }
+        else if (_request._useCookies && !_request._cookiesFileName.empty()) {
+            // Cookies are normally written in the cookie jar on cleanup.
+            // Since the handle is kept, flush them now for other requests.
+            TS_PUSH_WARNING()
+            TS_LLVM_NOWARNING(disabled-macro-expansion)
+            ::curl_easy_setopt(_curl, CURLOPT_COOKIELIST, "FLUSH");
+            TS_POP_WARNING()
+        }
     }
 
     // Erase nul-terminated error message.
     _error[0] = 0;
 }
 
+void ts::WebRequest::SystemGuts::close()
+{
+    clear();
+    if (_curl != nullptr) {
+        ::curl_easy_cleanup(_curl);
+        _curl = nullptr;
+    }
+}
+
 
 //----------------------------------------------------------------------------
 // Perform transfer.
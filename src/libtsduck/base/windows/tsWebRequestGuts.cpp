@@ -65,8 +65,11 @@ public:
     ~SystemGuts();
 
     // Initialize, clear, start Web transfer.
+    // In keep-alive mode, clear() keeps the main Internet handle and its
+    // connections for the next transfer. Use close() to release it.
     bool init();
     void clear();
+    void close();
     bool start();
 
     // Report an error message.
@@ -98,7 +101,7 @@ ts::WebRequest::SystemGuts::SystemGuts(WebRequest& request) :
 
 ts::WebRequest::SystemGuts::~SystemGuts()
 {
-    clear();
+    close();
 }
 
 void ts::WebRequest::allocateGuts()
@@ -156,60 +159,64 @@ bool ts::WebRequest::SystemGuts::init()
     // Make sure we start from a clean state.
     clear();
 
-    // Prepare proxy name.
-    const bool useProxy = !_request.proxyHost().empty();
-    ::DWORD access = INTERNET_OPEN_TYPE_PRECONFIG;
-    const ::WCHAR* proxy = 0;
-    UString proxyName(_request.proxyHost());
-
-    if (useProxy) {
-        access = INTERNET_OPEN_TYPE_PROXY;
-        if (_request.proxyPort() != 0) {
-            proxyName += UString::Format(u":%d", {_request.proxyPort()});
-        }
-        proxy = proxyName.wc_str();
-    }
-
-    // Open the main Internet handle.
-    _inet = ::InternetOpenW(_request._userAgent.wc_str(), access, proxy, 0, 0);
+    // In keep-alive mode, reuse the main Internet handle of the previous transfer.
+    // Wininet keeps the established connections for this handle.
     if (_inet == 0) {
-        error(u"error accessing Internet handle");
-        return false;
-    }
+        // Prepare proxy name.
+        const bool useProxy = !_request.proxyHost().empty();
+        ::DWORD access = INTERNET_OPEN_TYPE_PRECONFIG;
+        const ::WCHAR* proxy = 0;
+        UString proxyName(_request.proxyHost());
+
+        if (useProxy) {
+            access = INTERNET_OPEN_TYPE_PROXY;
+            if (_request.proxyPort() != 0) {
+                proxyName += UString::Format(u":%d", {_request.proxyPort()});
+            }
+            proxy = proxyName.wc_str();
+        }
 
-    // Specify the proxy authentication, if provided.
-    if (useProxy) {
-        UString user(_request.proxyUser());
-        UString pass(_request.proxyPassword());
-        if (!user.empty() && !::InternetSetOptionW(_inet, INTERNET_OPTION_PROXY_USERNAME, &user[0], ::DWORD(user.size()))) {
-            error(u"error setting proxy username");
-            clear();
+        // Open the main Internet handle.
+        _inet = ::InternetOpenW(_request._userAgent.wc_str(), access, proxy, 0, 0);
+        if (_inet == 0) {
+            error(u"error accessing Internet handle");
             return false;
         }
-        if (!pass.empty() && !::InternetSetOptionW(_inet, INTERNET_OPTION_PROXY_PASSWORD, &pass[0], ::DWORD(pass.size()))) {
-            error(u"error setting proxy password");
-            clear();
-            return false;
+
+        // Specify the proxy authentication, if provided.
+        if (useProxy) {
+            UString user(_request.proxyUser());
+            UString pass(_request.proxyPassword());
+            if (!user.empty() && !::InternetSetOptionW(_inet, INTERNET_OPTION_PROXY_USERNAME, &user[0], ::DWORD(user.size()))) {
+                error(u"error setting proxy username");
+                close();
+                return false;
+            }
+            if (!pass.empty() && !::InternetSetOptionW(_inet, INTERNET_OPTION_PROXY_PASSWORD, &pass[0], ::DWORD(pass.size()))) {
+                error(u"error setting proxy password");
+                close();
+                return false;
+            }
         }
-    }
 
-    // Specify the various timeouts.
-    if (_request._connectionTimeout > 0) {
-        ::DWORD timeout = ::DWORD(_request._connectionTimeout);
-        if (!::InternetSetOptionW(_inet, INTERNET_OPTION_CONNECT_TIMEOUT, &timeout, ::DWORD(sizeof(timeout)))) {
-            error(u"error setting connection timeout");
-            clear();
-            return false;
+        // Specify the various timeouts.
+        if (_request._connectionTimeout > 0) {
+            ::DWORD timeout = ::DWORD(_request._connectionTimeout);
+            if (!::InternetSetOptionW(_inet, INTERNET_OPTION_CONNECT_TIMEOUT, &timeout, ::DWORD(sizeof(timeout)))) {
+                error(u"error setting connection timeout");
+                close();
+                return false;
+            }
         }
-    }
-    if (_request._receiveTimeout > 0) {
-        ::DWORD timeout = ::DWORD(_request._receiveTimeout);
-        if (!::InternetSetOptionW(_inet, INTERNET_OPTION_RECEIVE_TIMEOUT, &timeout, ::DWORD(sizeof(timeout))) ||
-            !::InternetSetOptionW(_inet, INTERNET_OPTION_DATA_RECEIVE_TIMEOUT, &timeout, ::DWORD(sizeof(timeout))))
-        {
-            error(u"error setting receive timeout");
-            clear();
-            return false;
+        if (_request._receiveTimeout > 0) {
+            ::DWORD timeout = ::DWORD(_request._receiveTimeout);
+            if (!::InternetSetOptionW(_inet, INTERNET_OPTION_RECEIVE_TIMEOUT, &timeout, ::DWORD(sizeof(timeout))) ||
+                !::InternetSetOptionW(_inet, INTERNET_OPTION_DATA_RECEIVE_TIMEOUT, &timeout, ::DWORD(sizeof(timeout))))
+            {
+                error(u"error setting receive timeout");
+                close();
+                return false;
+            }
         }
     }
 
@@ -291,7 +298,21 @@ bool ts::WebRequest::SystemGuts::init()
 
 void ts::WebRequest::SystemGuts::clear()
 {
-    // Close Internet handles.
+    // Close URL handle.
+    if (_url != 0 && !::InternetCloseHandle(_url)) {
+        error(u"error closing URL handle");
+    }
+    _url = 0;
+    _redirectCount = 0;
+
+    // Close main Internet handle, unless kept for the next transfer.
+    if (!_request._keepAlive) {
+        close();
+    }
+}
+
+void ts::WebRequest::SystemGuts::close()
+{
     if (_url != 0 && !::InternetCloseHandle(_url)) {
         error(u"error closing URL handle");
     }
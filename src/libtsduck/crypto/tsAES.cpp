@@ -14,6 +14,30 @@
 //----------------------------------------------------------------------------
 
 #include "tsAES.h"
+#include "tsSysInfo.h"
+
+// Hardware AES kernels, when supported by the compiler. The kernels are
+// compiled for the specific instruction set, regardless of the compilation
+// options of the rest of the code. They are used only after checking at
+// run time that the CPU supports the instructions.
+#if defined(TS_X86_64) && defined(TS_GCC)
+    #define TS_AES_HW_INTEL 1
+    #define TS_AES_HW_TARGET __attribute__((target("aes,sse2")))
+    #include <immintrin.h>
+#elif defined(TS_X86_64) && defined(TS_MSC)
+    #define TS_AES_HW_INTEL 1
+    #define TS_AES_HW_TARGET
+    #include <intrin.h>
+#elif defined(TS_ARM64) && defined(TS_GCC_ONLY)
+    #define TS_AES_HW_ARM 1
+    #define TS_AES_HW_TARGET __attribute__((target("+crypto")))
+    #include <arm_neon.h>
+#elif defined(TS_ARM64) && defined(__ARM_FEATURE_CRYPTO)
+    #define TS_AES_HW_ARM 1
+    #define TS_AES_HW_TARGET
+    #include <arm_neon.h>
+#endif
+
 TSDUCK_SOURCE;
 
 #define BYTE(x,n) (((x) >> (8 * (n))) & 255)
@@ -1164,6 +1188,214 @@ bool ts::AES::setKeyImpl(const void* key_, size_t key_length, size_t rounds)
     *rk++ = *rrk++;
     *rk   = *rrk;
 
+    // The hardware instructions use the same round keys as byte arrays.
+    // The decryption keys are those of the "equivalent inverse cipher".
+    if (_accel) {
+        for (i = 0; i < 4 * (_Nr + 1); i++) {
+            PutUInt32(_eKb + 4 * i, _eK[i]);
+            PutUInt32(_dKb + 4 * i, _dK[i]);
+        }
+    }
+
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Hardware-accelerated encryption and decryption.
+// The blocks are processed by groups of 8 and 4 to use the pipeline of the
+// AES instructions, a single AES round having a latency of several cycles.
+//----------------------------------------------------------------------------
+
+#if defined(TS_AES_HW_INTEL)
+
+namespace {
+
+    template <size_t N>
+    TS_AES_HW_TARGET inline void EncryptHW(const __m128i* k, int nr, const uint8_t* in, uint8_t* out)
+    {
+        __m128i b[N];
+        for (size_t i = 0; i < N; ++i) {
+            b[i] = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * i)), k[0]);
+        }
+        for (int r = 1; r < nr; ++r) {
+            for (size_t i = 0; i < N; ++i) {
+                b[i] = _mm_aesenc_si128(b[i], k[r]);
+            }
+        }
+        for (size_t i = 0; i < N; ++i) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16 * i), _mm_aesenclast_si128(b[i], k[nr]));
+        }
+    }
+
+    template <size_t N>
+    TS_AES_HW_TARGET inline void DecryptHW(const __m128i* k, int nr, const uint8_t* in, uint8_t* out)
+    {
+        __m128i b[N];
+        for (size_t i = 0; i < N; ++i) {
+            b[i] = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * i)), k[0]);
+        }
+        for (int r = 1; r < nr; ++r) {
+            for (size_t i = 0; i < N; ++i) {
+                b[i] = _mm_aesdec_si128(b[i], k[r]);
+            }
+        }
+        for (size_t i = 0; i < N; ++i) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16 * i), _mm_aesdeclast_si128(b[i], k[nr]));
+        }
+    }
+
+    TS_AES_HW_TARGET void EncryptBlocksHW(const uint8_t* keys, int nr, const uint8_t* in, uint8_t* out, size_t count)
+    {
+        __m128i k[ts::AES::MAX_ROUNDS + 1];
+        for (size_t r = 0; r <= ts::AES::MAX_ROUNDS; ++r) {
+            k[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + 16 * r));
+        }
+        for (; count >= 8; count -= 8, in += 8 * 16, out += 8 * 16) {
+            EncryptHW<8>(k, nr, in, out);
+        }
+        for (; count >= 4; count -= 4, in += 4 * 16, out += 4 * 16) {
+            EncryptHW<4>(k, nr, in, out);
+        }
+        for (; count > 0; count--, in += 16, out += 16) {
+            EncryptHW<1>(k, nr, in, out);
+        }
+    }
+
+    TS_AES_HW_TARGET void DecryptBlocksHW(const uint8_t* keys, int nr, const uint8_t* in, uint8_t* out, size_t count)
+    {
+        __m128i k[ts::AES::MAX_ROUNDS + 1];
+        for (size_t r = 0; r <= ts::AES::MAX_ROUNDS; ++r) {
+            k[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + 16 * r));
+        }
+        for (; count >= 8; count -= 8, in += 8 * 16, out += 8 * 16) {
+            DecryptHW<8>(k, nr, in, out);
+        }
+        for (; count >= 4; count -= 4, in += 4 * 16, out += 4 * 16) {
+            DecryptHW<4>(k, nr, in, out);
+        }
+        for (; count > 0; count--, in += 16, out += 16) {
+            DecryptHW<1>(k, nr, in, out);
+        }
+    }
+}
+
+#elif defined(TS_AES_HW_ARM)
+
+namespace {
+
+    // On Arm64, AESE and AESD start with the AddRoundKey step and
+    // MixColumns is a separate instruction.
+
+    template <size_t N>
+    TS_AES_HW_TARGET inline void EncryptHW(const uint8x16_t* k, int nr, const uint8_t* in, uint8_t* out)
+    {
+        uint8x16_t b[N];
+        for (size_t i = 0; i < N; ++i) {
+            b[i] = vld1q_u8(in + 16 * i);
+        }
+        for (int r = 0; r < nr - 1; ++r) {
+            for (size_t i = 0; i < N; ++i) {
+                b[i] = vaesmcq_u8(vaeseq_u8(b[i], k[r]));
+            }
+        }
+        for (size_t i = 0; i < N; ++i) {
+            vst1q_u8(out + 16 * i, veorq_u8(vaeseq_u8(b[i], k[nr - 1]), k[nr]));
+        }
+    }
+
+    template <size_t N>
+    TS_AES_HW_TARGET inline void DecryptHW(const uint8x16_t* k, int nr, const uint8_t* in, uint8_t* out)
+    {
+        uint8x16_t b[N];
+        for (size_t i = 0; i < N; ++i) {
+            b[i] = vld1q_u8(in + 16 * i);
+        }
+        for (int r = 0; r < nr - 1; ++r) {
+            for (size_t i = 0; i < N; ++i) {
+                b[i] = vaesimcq_u8(vaesdq_u8(b[i], k[r]));
+            }
+        }
+        for (size_t i = 0; i < N; ++i) {
+            vst1q_u8(out + 16 * i, veorq_u8(vaesdq_u8(b[i], k[nr - 1]), k[nr]));
+        }
+    }
+
+    TS_AES_HW_TARGET void EncryptBlocksHW(const uint8_t* keys, int nr, const uint8_t* in, uint8_t* out, size_t count)
+    {
+        uint8x16_t k[ts::AES::MAX_ROUNDS + 1];
+        for (size_t r = 0; r <= ts::AES::MAX_ROUNDS; ++r) {
+            k[r] = vld1q_u8(keys + 16 * r);
+        }
+        for (; count >= 8; count -= 8, in += 8 * 16, out += 8 * 16) {
+            EncryptHW<8>(k, nr, in, out);
+        }
+        for (; count >= 4; count -= 4, in += 4 * 16, out += 4 * 16) {
+            EncryptHW<4>(k, nr, in, out);
+        }
+        for (; count > 0; count--, in += 16, out += 16) {
+            EncryptHW<1>(k, nr, in, out);
+        }
+    }
+
+    TS_AES_HW_TARGET void DecryptBlocksHW(const uint8_t* keys, int nr, const uint8_t* in, uint8_t* out, size_t count)
+    {
+        uint8x16_t k[ts::AES::MAX_ROUNDS + 1];
+        for (size_t r = 0; r <= ts::AES::MAX_ROUNDS; ++r) {
+            k[r] = vld1q_u8(keys + 16 * r);
+        }
+        for (; count >= 8; count -= 8, in += 8 * 16, out += 8 * 16) {
+            DecryptHW<8>(k, nr, in, out);
+        }
+        for (; count >= 4; count -= 4, in += 4 * 16, out += 4 * 16) {
+            DecryptHW<4>(k, nr, in, out);
+        }
+        for (; count > 0; count--, in += 16, out += 16) {
+            DecryptHW<1>(k, nr, in, out);
+        }
+    }
+}
+
+#else
+
+namespace {
+    // Never called, hardware acceleration is never enabled.
+    void EncryptBlocksHW(const uint8_t*, int, const uint8_t*, uint8_t*, size_t) {}
+    void DecryptBlocksHW(const uint8_t*, int, const uint8_t*, uint8_t*, size_t) {}
+}
+
+#endif
+
+bool ts::AES::IsAccelerated()
+{
+#if defined(TS_AES_HW_INTEL) || defined(TS_AES_HW_ARM)
+    static const bool accel = SysInfo::Instance()->aesInstructions();
+    return accel;
+#else
+    return false;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Encryption and decryption of several independent blocks.
+//----------------------------------------------------------------------------
+
+bool ts::AES::encryptBlocksImpl(const void* plain, void* cipher, size_t count)
+{
+    if (!_accel) {
+        return BlockCipher::encryptBlocksImpl(plain, cipher, count);
+    }
+    EncryptBlocksHW(_eKb, _Nr, reinterpret_cast<const uint8_t*>(plain), reinterpret_cast<uint8_t*>(cipher), count);
+    return true;
+}
+
+bool ts::AES::decryptBlocksImpl(const void* cipher, void* plain, size_t count)
+{
+    if (!_accel) {
+        return BlockCipher::decryptBlocksImpl(cipher, plain, count);
+    }
+    DecryptBlocksHW(_dKb, _Nr, reinterpret_cast<const uint8_t*>(cipher), reinterpret_cast<uint8_t*>(plain), count);
     return true;
 }
 
@@ -1181,6 +1413,14 @@ bool ts::AES::encryptImpl(const void* plain, size_t plain_length, void* cipher,
     const uint8_t* pt = reinterpret_cast<const uint8_t*> (plain);
     uint8_t* ct = reinterpret_cast<uint8_t*> (cipher);
 
+    if (_accel) {
+        EncryptBlocksHW(_eKb, _Nr, pt, ct, 1);
+        if (cipher_length != nullptr) {
+            *cipher_length = BLOCK_SIZE;
+        }
+        return true;
+    }
+
     uint32_t s0, s1, s2, s3, t0, t1, t2, t3, *rk;
     int Nr, r;
 
@@ -1306,6 +1546,14 @@ bool ts::AES::decryptImpl(const void* cipher, size_t cipher_length, void* plain,
     const uint8_t* ct = reinterpret_cast<const uint8_t*> (cipher);
     uint8_t* pt = reinterpret_cast<uint8_t*> (plain);
 
+    if (_accel) {
+        DecryptBlocksHW(_dKb, _Nr, ct, pt, 1);
+        if (plain_length != nullptr) {
+            *plain_length = BLOCK_SIZE;
+        }
+        return true;
+    }
+
     uint32_t s0, s1, s2, s3, t0, t1, t2, t3, *rk;
     int Nr, r;
 
@@ -1424,9 +1672,12 @@ bool ts::AES::decryptImpl(const void* cipher, size_t cipher_length, void* plain,
 //----------------------------------------------------------------------------
 
 ts::AES::AES() :
+    _accel(IsAccelerated()),
     _Nr(0),
     _eK(),
-    _dK()
+    _dK(),
+    _eKb(),
+    _dKb()
 {
 }
 
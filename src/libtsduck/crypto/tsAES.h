@@ -62,15 +62,28 @@ namespace ts {
         virtual size_t maxRounds() const override;
         virtual size_t defaultRounds() const override;
 
+        //!
+        //! Check if AES is accelerated by hardware instructions on this system.
+        //! These are the AES-NI instructions on Intel CPU and the cryptographic
+        //! extension on Arm64 CPU.
+        //! @return True if the AES computation uses hardware instructions.
+        //!
+        static bool IsAccelerated();
+
     protected:
         // Implementation of BlockCipher interface:
         virtual bool setKeyImpl(const void* key, size_t key_length, size_t rounds) override;
         virtual bool encryptImpl(const void* plain, size_t plain_length, void* cipher, size_t cipher_maxsize, size_t* cipher_length) override;
         virtual bool decryptImpl(const void* cipher, size_t cipher_length, void* plain, size_t plain_maxsize, size_t* plain_length) override;
+        virtual bool encryptBlocksImpl(const void* plain, void* cipher, size_t count) override;
+        virtual bool decryptBlocksImpl(const void* cipher, void* plain, size_t count) override;
 
     private:
-        int      _Nr;     //!< Number of rounds
-        uint32_t _eK[60]; //!< Scheduled encryption keys
-        uint32_t _dK[60]; //!< Scheduled decryption keys
+        bool     _accel;     //!< Use hardware acceleration
+        int      _Nr;        //!< Number of rounds
+        uint32_t _eK[60];    //!< Scheduled encryption keys
+        uint32_t _dK[60];    //!< Scheduled decryption keys
+        uint8_t  _eKb[240];  //!< Scheduled encryption keys as bytes, for hardware acceleration
+        uint8_t  _dKb[240];  //!< Scheduled decryption keys as bytes, for hardware acceleration
     };
 }
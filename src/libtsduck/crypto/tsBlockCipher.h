@@ -189,6 +189,28 @@ namespace ts {
         //!
         bool decryptInPlace(void* data, size_t data_length, size_t* max_actual_length = nullptr);
 
+        //!
+        //! Encrypt several independent blocks of data (ECB mode).
+        //! Some algorithms, such as hardware-accelerated AES, process several blocks in
+        //! parallel. This is used by chaining modes where the blocks are independent,
+        //! such as CTR or CBC decryption.
+        //! @param [in] plain Address of plain text, @a count blocks of blockSize() bytes.
+        //! @param [out] cipher Address of buffer for cipher text, @a count blocks. Can be the same as @a plain.
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error.
+        //!
+        bool encryptBlocks(const void* plain, void* cipher, size_t count);
+
+        //!
+        //! Decrypt several independent blocks of data (ECB mode).
+        //! @param [in] cipher Address of cipher text, @a count blocks of blockSize() bytes.
+        //! @param [out] plain Address of buffer for plain text, @a count blocks. Can be the same as @a cipher.
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error.
+        //! @see encryptBlocks()
+        //!
+        bool decryptBlocks(const void* cipher, void* plain, size_t count);
+
         //!
         //! Get the number of times the current key was used for encryption.
         //! @return The number of times the current key was used for encryption.
@@ -314,6 +336,42 @@ namespace ts {
         //!
         virtual bool decryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length);
 
+        //!
+        //! Encrypt several independent blocks of data (implementation of algorithm-specific part).
+        //! The default implementation is to call encryptImpl() on each block.
+        //! A subclass may provide a more efficient implementation.
+        //! @param [in] plain Address of plain text, @a count blocks of blockSize() bytes.
+        //! @param [out] cipher Address of buffer for cipher text, @a count blocks. Can be the same as @a plain.
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error.
+        //!
+        virtual bool encryptBlocksImpl(const void* plain, void* cipher, size_t count);
+
+        //!
+        //! Decrypt several independent blocks of data (implementation of algorithm-specific part).
+        //! The default implementation is to call decryptImpl() on each block.
+        //! A subclass may provide a more efficient implementation.
+        //! @param [in] cipher Address of cipher text, @a count blocks of blockSize() bytes.
+        //! @param [out] plain Address of buffer for plain text, @a count blocks. Can be the same as @a cipher.
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error.
+        //!
+        virtual bool decryptBlocksImpl(const void* cipher, void* plain, size_t count);
+
+        //!
+        //! Check if encryption is allowed with the current key and increment the encryption counter.
+        //! Used by subclasses which encrypt several messages in one operation, once per message.
+        //! @return True if encryption is allowed.
+        //!
+        bool allowEncrypt();
+
+        //!
+        //! Check if decryption is allowed with the current key and increment the decryption counter.
+        //! Used by subclasses which decrypt several messages in one operation, once per message.
+        //! @return True if decryption is allowed.
+        //!
+        bool allowDecrypt();
+
     private:
         bool      _key_set;                // Current key successfully set.
         int       _cipher_id;              // Cipher identity (from application).
@@ -323,9 +381,5 @@ namespace ts {
         size_t    _key_decrypt_max;        // Maximum number of times a key should be used for decryption.
         ByteBlock _current_key;            // Current unscheduled key.
         BlockCipherAlertInterface* _alert; // Alert handler.
-
-        // Check if encryption or decryption is allowed. Increment counters.
-        bool allowEncrypt();
-        bool allowDecrypt();
     };
 }
@@ -88,7 +88,7 @@ bool ts::CBC<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, void
 {
     if (this->algo == nullptr ||
         this->iv.size() != this->block_size ||
-        this->work.size() < this->block_size ||
+        this->work.size() < this->PARALLEL_BLOCKS * this->block_size ||
         cipher_length % this->block_size != 0 ||
         plain_maxsize < cipher_length)
     {
@@ -102,21 +102,23 @@ bool ts::CBC<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, void
     const uint8_t* ct = reinterpret_cast<const uint8_t*> (cipher);
     uint8_t* pt = reinterpret_cast<uint8_t*> (plain);
 
+    // Unlike encryption, all blocks can be deciphered independently.
     while (cipher_length > 0) {
-        // work = decrypt (cipher-text)
-        if (!this->algo->decrypt(ct, this->block_size, this->work.data(), this->block_size)) {
+        // work = decrypt (several blocks of cipher-text)
+        const size_t size = std::min(cipher_length, this->PARALLEL_BLOCKS * this->block_size);
+        if (!this->algo->decryptBlocks(ct, this->work.data(), size / this->block_size)) {
             return false;
         }
         // plain-text = previous-cipher XOR work
-        for (size_t i = 0; i < this->block_size; ++i) {
-            pt[i] = previous[i] ^ this->work[i];
+        for (size_t i = 0; i < size; ++i) {
+            pt[i] = (i < this->block_size ? previous[i] : ct[i - this->block_size]) ^ this->work[i];
         }
-        // previous-cipher = cipher-text
-        previous = ct;
-        // advance one block
-        ct += this->block_size;
-        pt += this->block_size;
-        cipher_length -= this->block_size;
+        // previous-cipher = last cipher-text
+        previous = ct + size - this->block_size;
+        // advance several blocks
+        ct += size;
+        pt += size;
+        cipher_length -= size;
     }
 
     return true;
@@ -87,11 +87,10 @@ namespace ts {
     private:
         size_t _counter_bits; // size in bits of the counter part.
 
-        // We need two work blocks.
-        // The first one contains the "input block" or counter.
-        // The second one contains the "output block", the encrypted counter.
-        // This private method increments the counter block.
-        bool incrementCounter();
+        // The work buffer contains PARALLEL_BLOCKS "input blocks" or counters,
+        // followed by PARALLEL_BLOCKS "output blocks", the encrypted counters.
+        // This private method increments a counter block.
+        void incrementCounter(uint8_t* counter);
     };
 }
 
@@ -100,6 +100,12 @@ namespace ts {
         ByteBlock    iv;          //!< Current initialization vector.
         ByteBlock    work;        //!< Temporary working buffer.
 
+        //!
+        //! Number of blocks which are processed together by the chaining modes where
+        //! the blocks are independent, using BlockCipher::encryptBlocks() or decryptBlocks().
+        //!
+        static constexpr size_t PARALLEL_BLOCKS = 8;
+
         //!
         //! Constructor for subclasses.
         //! @param [in,out] cipher An instance of block cipher.
@@ -10,6 +10,11 @@
 //----------------------------------------------------------------------------
 
 #include "tsDVBCSA2.h"
+#include "tsMemory.h"
+#if defined(TS_X86_64) && (defined(__SSE2__) || defined(TS_MSC))
+    #define TS_DVBCSA2_SSE2 1
+    #include <emmintrin.h>
+#endif
 TSDUCK_SOURCE;
 
 // Operations on 64-bit areas.
@@ -566,6 +571,100 @@ void ts::DVBCSA2::BlockCipher::encipher (const uint8_t *bd, uint8_t *ib)
 }
 
 
+//----------------------------------------------------------------------------
+// Block cipher on several independent blocks.
+// Same algorithm as above. The blocks are processed in groups and the rounds
+// of all blocks in a group are interleaved to avoid the dependency chain
+// between successive rounds of one block.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Number of interleaved blocks.
+    constexpr size_t BLOCK_GROUP = 8;
+}
+
+void ts::DVBCSA2::BlockCipher::decipher(uint8_t (*blocks)[8], size_t count)
+{
+    int R[9][BLOCK_GROUP];
+
+    for (size_t first = 0; first < count; first += BLOCK_GROUP) {
+        const size_t n = std::min(BLOCK_GROUP, count - first);
+        uint8_t (*blk)[8] = blocks + first;
+
+        for (size_t b = 0; b < n; ++b) {
+            for (size_t k = 0; k < 8; ++k) {
+                R[k+1][b] = blk[b][k];
+            }
+        }
+
+        // loop over kk[56]..kk[1]
+        for (int i = 56; i > 0; i--) {
+            const int kk = _kk[i];
+            for (size_t b = 0; b < n; ++b) {
+                const int sbox_out = block_sbox[kk ^ R[7][b]];
+                const int perm_out = block_perm[sbox_out];
+                const int r8 = R[8][b] ^ sbox_out;
+                const int next_R8 = R[7][b];
+                R[7][b] = R[6][b] ^ perm_out;
+                R[6][b] = R[5][b];
+                R[5][b] = R[4][b] ^ r8;
+                R[4][b] = R[3][b] ^ r8;
+                R[3][b] = R[2][b] ^ r8;
+                R[2][b] = R[1][b];
+                R[1][b] = r8;
+                R[8][b] = next_R8;
+            }
+        }
+
+        for (size_t b = 0; b < n; ++b) {
+            for (size_t k = 0; k < 8; ++k) {
+                blk[b][k] = uint8_t(R[k+1][b]);
+            }
+        }
+    }
+}
+
+void ts::DVBCSA2::BlockCipher::encipher(uint8_t (*blocks)[8], size_t count)
+{
+    int R[9][BLOCK_GROUP];
+
+    for (size_t first = 0; first < count; first += BLOCK_GROUP) {
+        const size_t n = std::min(BLOCK_GROUP, count - first);
+        uint8_t (*blk)[8] = blocks + first;
+
+        for (size_t b = 0; b < n; ++b) {
+            for (size_t k = 0; k < 8; ++k) {
+                R[k+1][b] = blk[b][k];
+            }
+        }
+
+        // loop over kk[1]..kk[56]
+        for (int i = 1; i <= 56; i++) {
+            const int kk = _kk[i];
+            for (size_t b = 0; b < n; ++b) {
+                const int sbox_out = block_sbox[kk ^ R[8][b]];
+                const int perm_out = block_perm[sbox_out];
+                const int r1 = R[1][b];
+                R[1][b] = R[2][b];
+                R[2][b] = R[3][b] ^ r1;
+                R[3][b] = R[4][b] ^ r1;
+                R[4][b] = R[5][b] ^ r1;
+                R[5][b] = R[6][b];
+                R[6][b] = R[7][b] ^ perm_out;
+                R[7][b] = R[8][b];
+                R[8][b] = r1 ^ sbox_out;
+            }
+        }
+
+        for (size_t b = 0; b < n; ++b) {
+            for (size_t k = 0; k < 8; ++k) {
+                blk[b][k] = uint8_t(R[k+1][b]);
+            }
+        }
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Set the control word for subsequent encrypt/decrypt operations
 //----------------------------------------------------------------------------
@@ -719,6 +818,658 @@ bool ts::DVBCSA2::decryptInPlaceImpl(void* addr, size_t size, size_t* max_actual
 }
 
 
+//----------------------------------------------------------------------------
+// Bit-sliced stream cipher.
+//
+// The state of the stream cipher is the same as above but each bit of the
+// state is a word W, containing the corresponding bit in the state of up
+// to 8*sizeof(W) independent stream ciphers, one per data area. All stream
+// ciphers use the same key and are initialized with distinct first blocks.
+// The S-boxes are replaced by boolean expressions which are derived from
+// their truth tables. Shifting a register is a simple move of words.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Properties of a word type W: number of 64-bit chunks, access to chunks.
+    template <typename W> struct BitSlicedWord;
+
+    template <> struct BitSlicedWord<uint64_t>
+    {
+        static constexpr size_t CHUNKS = 1;
+        static uint64_t Zero() { return 0; }
+        static uint64_t Ones() { return ~uint64_t(0); }
+        static uint64_t Make(const uint64_t* chunks) { return chunks[0]; }
+        static void Split(uint64_t* chunks, uint64_t w) { chunks[0] = w; }
+    };
+
+#if defined(TS_DVBCSA2_SSE2)
+
+    // 128-bit word in an SSE2 register.
+    struct Word128
+    {
+        __m128i v;
+    };
+
+    inline Word128 operator&(const Word128& a, const Word128& b) { return Word128{_mm_and_si128(a.v, b.v)}; }
+    inline Word128 operator|(const Word128& a, const Word128& b) { return Word128{_mm_or_si128(a.v, b.v)}; }
+    inline Word128 operator^(const Word128& a, const Word128& b) { return Word128{_mm_xor_si128(a.v, b.v)}; }
+    inline Word128 operator~(const Word128& a) { return Word128{_mm_xor_si128(a.v, _mm_set1_epi32(-1))}; }
+
+    template <> struct BitSlicedWord<Word128>
+    {
+        static constexpr size_t CHUNKS = 2;
+        static Word128 Zero() { return Word128{_mm_setzero_si128()}; }
+        static Word128 Ones() { return Word128{_mm_set1_epi32(-1)}; }
+        static Word128 Make(const uint64_t* chunks) { return Word128{_mm_set_epi64x(int64_t(chunks[1]), int64_t(chunks[0]))}; }
+        static void Split(uint64_t* chunks, const Word128& w) { _mm_storeu_si128(reinterpret_cast<__m128i*>(chunks), w.v); }
+    };
+
+#else
+
+    // Portable 128-bit word.
+    struct Word128
+    {
+        uint64_t lo;
+        uint64_t hi;
+    };
+
+    inline Word128 operator&(const Word128& a, const Word128& b) { return Word128{a.lo & b.lo, a.hi & b.hi}; }
+    inline Word128 operator|(const Word128& a, const Word128& b) { return Word128{a.lo | b.lo, a.hi | b.hi}; }
+    inline Word128 operator^(const Word128& a, const Word128& b) { return Word128{a.lo ^ b.lo, a.hi ^ b.hi}; }
+    inline Word128 operator~(const Word128& a) { return Word128{~a.lo, ~a.hi}; }
+
+    template <> struct BitSlicedWord<Word128>
+    {
+        static constexpr size_t CHUNKS = 2;
+        static Word128 Zero() { return Word128{0, 0}; }
+        static Word128 Ones() { return Word128{~uint64_t(0), ~uint64_t(0)}; }
+        static Word128 Make(const uint64_t* chunks) { return Word128{chunks[0], chunks[1]}; }
+        static void Split(uint64_t* chunks, const Word128& w) { chunks[0] = w.lo; chunks[1] = w.hi; }
+    };
+
+#endif
+
+    // Transpose a 64x64 bit matrix: bit c of row r is moved to bit 63-r of row 63-c.
+    void Transpose64(uint64_t* a)
+    {
+        uint64_t m = TS_UCONST64(0x00000000FFFFFFFF);
+        for (size_t j = 32; j != 0; j >>= 1, m ^= (m << j)) {
+            for (size_t k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+                const uint64_t t = (a[k] ^ (a[k | j] >> j)) & m;
+                a[k] ^= t;
+                a[k | j] ^= t << j;
+            }
+        }
+    }
+
+    // Transform 8-byte blocks, one per data area, into 64 words, one per bit.
+    // Word 8*i+7-b contains the bit b of the byte i of all blocks.
+    // A null block address is a block of zeroes.
+    template <typename W>
+    void BlocksToWords(W* words, const uint8_t* const* blocks, size_t count)
+    {
+        uint64_t m[BitSlicedWord<W>::CHUNKS][64];
+        for (size_t c = 0; c < BitSlicedWord<W>::CHUNKS; ++c) {
+            for (size_t l = 0; l < 64; ++l) {
+                const size_t index = 64 * c + l;
+                m[c][63 - l] = index < count && blocks[index] != nullptr ? ts::GetUInt64BE(blocks[index]) : 0;
+            }
+            Transpose64(m[c]);
+        }
+        for (size_t i = 0; i < 64; ++i) {
+            uint64_t chunks[BitSlicedWord<W>::CHUNKS];
+            for (size_t c = 0; c < BitSlicedWord<W>::CHUNKS; ++c) {
+                chunks[c] = m[c][i];
+            }
+            words[i] = BitSlicedWord<W>::Make(chunks);
+        }
+    }
+
+    // Reverse operation of BlocksToWords().
+    template <typename W>
+    void WordsToBlocks(uint8_t (*blocks)[8], const W* words, size_t count)
+    {
+        uint64_t m[BitSlicedWord<W>::CHUNKS][64];
+        for (size_t i = 0; i < 64; ++i) {
+            uint64_t chunks[BitSlicedWord<W>::CHUNKS];
+            BitSlicedWord<W>::Split(chunks, words[i]);
+            for (size_t c = 0; c < BitSlicedWord<W>::CHUNKS; ++c) {
+                m[c][i] = chunks[c];
+            }
+        }
+        for (size_t c = 0; c < BitSlicedWord<W>::CHUNKS; ++c) {
+            Transpose64(m[c]);
+            for (size_t l = 0; l < 64 && 64 * c + l < count; ++l) {
+                ts::PutUInt64BE(blocks[64 * c + l], m[c][63 - l]);
+            }
+        }
+    }
+
+    // Bit-sliced S-boxes of the stream cipher: (o1,o0) = sbox[(i4,i3,i2,i1,i0)].
+
+    template <typename W>
+    inline void BitSlicedSBox1(W& o1, W& o0, const W& i4, const W& i3, const W& i2, const W& i1, const W& i0)
+    {
+        const W t1 = ~i4;
+        const W t2 = i0 ^ t1;
+        const W t3 = ~i0 | i4;
+        const W t4 = t2 ^ (i1 & t3);
+        const W t5 = ~t2;
+        const W t6 = i0 | t1;
+        const W t7 = t5 ^ (i1 & t6);
+        const W t8 = t4 ^ (i3 & t7);
+        const W t9 = t5 ^ (i1 & t1);
+        const W t10 = i3 | t9;
+        const W t11 = t8 ^ (i2 & t10);
+        const W t12 = i0 & i4;
+        const W t13 = i1 ^ t12;
+        const W t14 = i1 | t2;
+        const W t15 = t13 ^ (i3 & t14);
+        const W t16 = ~t6;
+        const W t17 = i0 ^ (i3 & t16);
+        const W t18 = t15 ^ (i2 & t17);
+        o1 = t11;
+        o0 = t18;
+    }
+
+    template <typename W>
+    inline void BitSlicedSBox2(W& o1, W& o0, const W& i4, const W& i3, const W& i2, const W& i1, const W& i0)
+    {
+        const W t1 = ~i3;
+        const W t2 = i4 & i3;
+        const W t3 = t1 ^ (i2 & t2);
+        const W t4 = ~t2;
+        const W t5 = ~i4;
+        const W t6 = t4 ^ (i2 & t5);
+        const W t7 = t3 ^ (i1 & t6);
+        const W t8 = i2 ^ t4;
+        const W t9 = i1 | t8;
+        const W t10 = t7 ^ (i0 & t9);
+        const W t11 = i1 ^ t6;
+        const W t12 = i4 | t1;
+        const W t13 = i2 & t12;
+        const W t14 = i4 | i3;
+        const W t15 = t13 ^ (i1 & t14);
+        const W t16 = t11 ^ (i0 & t15);
+        o1 = t10;
+        o0 = t16;
+    }
+
+    template <typename W>
+    inline void BitSlicedSBox3(W& o1, W& o0, const W& i4, const W& i3, const W& i2, const W& i1, const W& i0)
+    {
+        const W t1 = ~i4;
+        const W t2 = i3 ^ t1;
+        const W t3 = ~i3 | i4;
+        const W t4 = t2 ^ (i0 & t3);
+        const W t5 = i0 | t2;
+        const W t6 = t4 ^ (i1 & t5);
+        const W t7 = i3 | i4;
+        const W t8 = t7 ^ (i0 & t1);
+        const W t9 = i1 | t8;
+        const W t10 = t6 ^ (i2 & t9);
+        const W t11 = ~t2;
+        const W t12 = ~i0;
+        const W t13 = t11 ^ (i1 & t12);
+        const W t14 = t13 ^ (i2 & i0);
+        o1 = t10;
+        o0 = t14;
+    }
+
+    template <typename W>
+    inline void BitSlicedSBox4(W& o1, W& o0, const W& i4, const W& i3, const W& i2, const W& i1, const W& i0)
+    {
+        const W t1 = ~i3;
+        const W t2 = ~i1;
+        const W t3 = ~i3 | t2;
+        const W t4 = t1 ^ (i2 & t3);
+        const W t5 = i2 | t2;
+        const W t6 = t4 ^ (i0 & t5);
+        const W t7 = i3 ^ t2;
+        const W t8 = i3 & t2;
+        const W t9 = t7 ^ (i2 & t8);
+        const W t10 = ~t8;
+        const W t11 = t10 ^ (i2 & i1);
+        const W t12 = t9 ^ (i0 & t11);
+        const W t13 = t6 ^ (i4 & t12);
+        const W t14 = t2 ^ (i2 & t1);
+        const W t15 = i3 | i1;
+        const W t16 = t14 ^ (i0 & t15);
+        const W t17 = ~t12;
+        const W t18 = t16 ^ (i4 & t17);
+        o1 = t13;
+        o0 = t18;
+    }
+
+    template <typename W>
+    inline void BitSlicedSBox5(W& o1, W& o0, const W& i4, const W& i3, const W& i2, const W& i1, const W& i0)
+    {
+        const W t1 = ~i3;
+        const W t2 = i1 ^ t1;
+        const W t3 = i1 & t1;
+        const W t4 = t2 ^ (i2 & t3);
+        const W t5 = ~i1 & t1;
+        const W t6 = t5 ^ (i2 & t2);
+        const W t7 = t4 ^ (i0 & t6);
+        const W t8 = i2 | t3;
+        const W t9 = ~t2;
+        const W t10 = t1 ^ (i2 & t9);
+        const W t11 = t8 ^ (i0 & t10);
+        const W t12 = t7 ^ (i4 & t11);
+        const W t13 = i1 & i3;
+        const W t14 = i2 ^ t13;
+        const W t15 = i2 | t9;
+        const W t16 = t14 ^ (i0 & t15);
+        const W t17 = ~i1 & i3;
+        const W t18 = ~i1;
+        const W t19 = t17 ^ (i2 & t18);
+        const W t20 = i0 | t19;
+        const W t21 = t16 ^ (i4 & t20);
+        o1 = t12;
+        o0 = t21;
+    }
+
+    template <typename W>
+    inline void BitSlicedSBox6(W& o1, W& o0, const W& i4, const W& i3, const W& i2, const W& i1, const W& i0)
+    {
+        const W t1 = ~i3;
+        const W t2 = ~i0 | t1;
+        const W t3 = i4 & t2;
+        const W t4 = i0 | i3;
+        const W t5 = t3 ^ (i2 & t4);
+        const W t6 = t2 ^ (i4 & i0);
+        const W t7 = t5 ^ (i1 & t6);
+        const W t8 = i0 ^ (i2 & t1);
+        const W t9 = i0 & t1;
+        const W t10 = i3 ^ (i4 & t9);
+        const W t11 = i0 ^ t1;
+        const W t12 = ~i4 & t11;
+        const W t13 = t10 ^ (i2 & t12);
+        const W t14 = t8 ^ (i1 & t13);
+        o1 = t7;
+        o0 = t14;
+    }
+
+    template <typename W>
+    inline void BitSlicedSBox7(W& o1, W& o0, const W& i4, const W& i3, const W& i2, const W& i1, const W& i0)
+    {
+        const W t1 = i0 ^ i2;
+        const W t2 = i3 ^ t1;
+        const W t3 = t2 ^ (i4 & t1);
+        const W t4 = ~i0;
+        const W t5 = i3 | t4;
+        const W t6 = i0 | i2;
+        const W t7 = t6 ^ (i3 & t1);
+        const W t8 = t5 ^ (i4 & t7);
+        const W t9 = t3 ^ (i1 & t8);
+        const W t10 = ~i2;
+        const W t11 = t1 ^ (i3 & t10);
+        const W t12 = i4 ^ t11;
+        const W t13 = i3 & t4;
+        const W t14 = t6 ^ (i4 & t13);
+        const W t15 = t12 ^ (i1 & t14);
+        o1 = t9;
+        o0 = t15;
+    }
+
+    // Bit-sliced stream cipher.
+    template <typename W>
+    class BitSlicedStream
+    {
+    public:
+        // Constructor: load the same key in all stream ciphers.
+        BitSlicedStream(const uint8_t* key);
+
+        // Initialize the stream ciphers with the first block of each data area (see BlocksToWords()).
+        void init(const W* in);
+
+        // Generate the next 8 bytes of each stream (see BlocksToWords()).
+        void generate(W* out);
+
+    private:
+        W A[11][4];  // [register][bit], A[1] to A[10], A[0] unused
+        W B[11][4];
+        W X[4];
+        W Y[4];
+        W Z[4];
+        W D[4];
+        W E[4];
+        W F[4];
+        W p;
+        W q;
+        W r;
+
+        // One iteration, 2 bits of output. In init mode, inA and inB are the input nibbles.
+        template <bool INIT>
+        void step(const W* inA, const W* inB, W& out1, W& out0);
+    };
+
+    template <typename W>
+    BitSlicedStream<W>::BitSlicedStream(const uint8_t* key) :
+        A(),
+        B(),
+        X(),
+        Y(),
+        Z(),
+        D(),
+        E(),
+        F(),
+        p(BitSlicedWord<W>::Zero()),
+        q(BitSlicedWord<W>::Zero()),
+        r(BitSlicedWord<W>::Zero())
+    {
+        // Load first 32 bits of key into A[1]..A[8], last 32 bits of key into B[1]..B[8].
+        for (size_t k = 0; k < 4; ++k) {
+            for (size_t bit = 0; bit < 4; ++bit) {
+                A[2*k+1][bit] = ((key[k] >> (4 + bit)) & 1) != 0 ? BitSlicedWord<W>::Ones() : BitSlicedWord<W>::Zero();
+                A[2*k+2][bit] = ((key[k] >> bit) & 1) != 0 ? BitSlicedWord<W>::Ones() : BitSlicedWord<W>::Zero();
+                B[2*k+1][bit] = ((key[k+4] >> (4 + bit)) & 1) != 0 ? BitSlicedWord<W>::Ones() : BitSlicedWord<W>::Zero();
+                B[2*k+2][bit] = ((key[k+4] >> bit) & 1) != 0 ? BitSlicedWord<W>::Ones() : BitSlicedWord<W>::Zero();
+            }
+        }
+        // All other registers are zero.
+        for (size_t bit = 0; bit < 4; ++bit) {
+            A[0][bit] = A[9][bit] = A[10][bit] = BitSlicedWord<W>::Zero();
+            B[0][bit] = B[9][bit] = B[10][bit] = BitSlicedWord<W>::Zero();
+            X[bit] = Y[bit] = Z[bit] = D[bit] = E[bit] = F[bit] = BitSlicedWord<W>::Zero();
+        }
+    }
+
+    template <typename W>
+    void BitSlicedStream<W>::init(const W* in)
+    {
+        W unused1, unused0;
+        for (size_t i = 0; i < 8; ++i) {
+            // Bits of the most and least significant nibbles of input byte i.
+            const W in1[4] = {in[8*i+3], in[8*i+2], in[8*i+1], in[8*i]};
+            const W in2[4] = {in[8*i+7], in[8*i+6], in[8*i+5], in[8*i+4]};
+            step<true>(in1, in2, unused1, unused0);
+            step<true>(in2, in1, unused1, unused0);
+            step<true>(in1, in2, unused1, unused0);
+            step<true>(in2, in1, unused1, unused0);
+        }
+    }
+
+    template <typename W>
+    void BitSlicedStream<W>::generate(W* out)
+    {
+        // 2 output bits per iteration, most significant first.
+        for (size_t i = 0; i < 64; i += 2) {
+            step<false>(nullptr, nullptr, out[i], out[i+1]);
+        }
+    }
+
+    template <typename W>
+    template <bool INIT>
+    void BitSlicedStream<W>::step(const W* inA, const W* inB, W& out1, W& out0)
+    {
+        // From A[1]..A[10], 35 bits are selected as inputs to 7 s-boxes.
+        W s1[2], s2[2], s3[2], s4[2], s5[2], s6[2], s7[2];
+        BitSlicedSBox1(s1[1], s1[0], A[4][0], A[1][2], A[6][1], A[7][3], A[9][0]);
+        BitSlicedSBox2(s2[1], s2[0], A[2][1], A[3][2], A[6][3], A[7][0], A[9][1]);
+        BitSlicedSBox3(s3[1], s3[0], A[1][3], A[2][0], A[5][1], A[5][3], A[6][2]);
+        BitSlicedSBox4(s4[1], s4[0], A[3][3], A[1][1], A[2][3], A[4][2], A[8][0]);
+        BitSlicedSBox5(s5[1], s5[0], A[5][2], A[4][3], A[6][0], A[8][1], A[9][2]);
+        BitSlicedSBox6(s6[1], s6[0], A[3][1], A[4][1], A[5][0], A[7][2], A[9][3]);
+        BitSlicedSBox7(s7[1], s7[0], A[2][2], A[3][0], A[7][1], A[8][2], A[8][3]);
+
+        // 4x4 xor to produce extra nibble for T3.
+        const W extra_B[4] = {
+            B[9][2] ^ B[6][3] ^ B[3][1] ^ B[8][0],
+            B[5][3] ^ B[8][2] ^ B[4][0] ^ B[5][1],
+            B[6][0] ^ B[8][1] ^ B[3][3] ^ B[4][2],
+            B[3][0] ^ B[6][1] ^ B[7][2] ^ B[9][3]
+        };
+
+        W next_A1[4];
+        W next_B1[4];
+        W next_D[4];
+        W next_F[4];
+        W carry = r;
+        for (size_t bit = 0; bit < 4; ++bit) {
+            // T1 and T2, the input is used during initialisation only.
+            next_A1[bit] = A[10][bit] ^ X[bit];
+            next_B1[bit] = B[7][bit] ^ B[10][bit] ^ Y[bit];
+            if (INIT) {
+                next_A1[bit] = next_A1[bit] ^ D[bit] ^ inA[bit];
+                next_B1[bit] = next_B1[bit] ^ inB[bit];
+            }
+            // T3
+            next_D[bit] = E[bit] ^ Z[bit] ^ extra_B[bit];
+            // T4: if q, F = Z + E + r with r as carry, otherwise F = E.
+            const W sum = Z[bit] ^ E[bit] ^ carry;
+            carry = (Z[bit] & E[bit]) | (carry & (Z[bit] ^ E[bit]));
+            next_F[bit] = E[bit] ^ ((E[bit] ^ sum) & q);
+        }
+        r = r ^ ((r ^ carry) & q);
+
+        // If p=1, rotate next_B1 left.
+        const W rotated_B1[4] = {next_B1[3], next_B1[0], next_B1[1], next_B1[2]};
+        for (size_t bit = 0; bit < 4; ++bit) {
+            next_B1[bit] = next_B1[bit] ^ ((next_B1[bit] ^ rotated_B1[bit]) & p);
+        }
+
+        for (size_t bit = 0; bit < 4; ++bit) {
+            for (size_t k = 10; k > 1; --k) {
+                A[k][bit] = A[k-1][bit];
+                B[k][bit] = B[k-1][bit];
+            }
+            A[1][bit] = next_A1[bit];
+            B[1][bit] = next_B1[bit];
+            D[bit] = next_D[bit];
+            E[bit] = F[bit];
+            F[bit] = next_F[bit];
+        }
+
+        X[0] = s1[1]; X[1] = s2[1]; X[2] = s3[0]; X[3] = s4[0];
+        Y[0] = s3[1]; Y[1] = s4[1]; Y[2] = s5[0]; Y[3] = s6[0];
+        Z[0] = s5[1]; Z[1] = s6[1]; Z[2] = s1[0]; Z[3] = s2[0];
+        p = s7[1];
+        q = s7[0];
+
+        // 2 output bits are a function of the 4 bits of D, xor 2 by 2.
+        out1 = D[3] ^ D[2];
+        out0 = D[1] ^ D[0];
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Encrypt a batch of data areas.
+//----------------------------------------------------------------------------
+
+bool ts::DVBCSA2::encryptInPlaceBatch(void* const data[], const size_t sizes[], size_t count)
+{
+    // Filter invalid parameters, before modifying anything.
+    if (!_init || (count > 0 && (data == nullptr || sizes == nullptr))) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if ((data[i] == nullptr && sizes[i] > 0) || sizes[i] / 8 > MAX_NBLOCKS) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (!allowEncrypt()) {
+            return false;
+        }
+    }
+
+    // Process slices of up to MAX_BATCH_SIZE data areas.
+    uint8_t* const* areas = reinterpret_cast<uint8_t* const*>(data);
+    for (size_t first = 0; first < count; first += MAX_BATCH_SIZE) {
+        const size_t n = std::min(MAX_BATCH_SIZE, count - first);
+        if (n <= 64) {
+            encryptBatch<uint64_t>(areas + first, sizes + first, n);
+        }
+        else {
+            encryptBatch<Word128>(areas + first, sizes + first, n);
+        }
+    }
+    return true;
+}
+
+template <typename W>
+void ts::DVBCSA2::encryptBatch(uint8_t* const data[], const size_t sizes[], size_t count)
+{
+    assert(count <= 8 * sizeof(W));
+
+    size_t max_blocks = 0;
+    size_t max_steps = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t nblocks = sizes[i] < 8 ? 0 : sizes[i] / 8;
+        max_blocks = std::max(max_blocks, nblocks);
+        max_steps = std::max(max_steps, nblocks == 0 ? 0 : nblocks - 1 + (sizes[i] % 8 != 0));
+    }
+
+    // Perform block cipher in reverse CBC mode, one block of each data area at a time.
+    // After last block is initialization vector (zero in DVB-CSA). The intermediate
+    // blocks are stored in place.
+    uint8_t blocks[8 * sizeof(W)][8];
+    size_t index[8 * sizeof(W)];
+    for (size_t k = 0; k < max_blocks; ++k) {
+        size_t n = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const size_t nblocks = sizes[i] < 8 ? 0 : sizes[i] / 8;
+            if (k < nblocks) {
+                uint8_t* const blk = data[i] + 8 * (nblocks - 1 - k);
+                if (k == 0) {
+                    memcpy_8(blocks[n], blk);
+                }
+                else {
+                    xor_8(blocks[n], blk, blk + 8);
+                }
+                index[n++] = i;
+            }
+        }
+        _block.encipher(blocks, n);
+        for (size_t b = 0; b < n; ++b) {
+            const size_t i = index[b];
+            memcpy_8(data[i] + 8 * (sizes[i] / 8 - 1 - k), blocks[b]);
+        }
+    }
+
+    // The first block is scrambled using the block cipher only.
+    // Its scrambled value is used to initialize the stream cipher.
+    const uint8_t* first_blocks[8 * sizeof(W)] = {};
+    for (size_t i = 0; i < count; ++i) {
+        first_blocks[i] = sizes[i] < 8 ? nullptr : data[i];
+    }
+    W words[64];
+    BlocksToWords(words, first_blocks, count);
+    BitSlicedStream<W> stream(_key);
+    stream.init(words);
+
+    // Now perform stream cipher on subsequent blocks and residue.
+    for (size_t k = 1; k <= max_steps; ++k) {
+        stream.generate(words);
+        WordsToBlocks(blocks, words, count);
+        for (size_t i = 0; i < count; ++i) {
+            const size_t nblocks = sizes[i] / 8;
+            if (sizes[i] >= 8 && k < nblocks) {
+                xor_8(data[i] + 8 * k, data[i] + 8 * k, blocks[i]);
+            }
+            else if (sizes[i] >= 8 && k == nblocks) {
+                for (size_t j = 0; j < sizes[i] % 8; ++j) {
+                    data[i][8 * nblocks + j] ^= blocks[i][j];
+                }
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Decrypt a batch of data areas.
+//----------------------------------------------------------------------------
+
+bool ts::DVBCSA2::decryptInPlaceBatch(void* const data[], const size_t sizes[], size_t count)
+{
+    // Filter invalid parameters, before modifying anything.
+    if (!_init || (count > 0 && (data == nullptr || sizes == nullptr))) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if ((data[i] == nullptr && sizes[i] > 0) || sizes[i] / 8 > MAX_NBLOCKS) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (!allowDecrypt()) {
+            return false;
+        }
+    }
+
+    // Process slices of up to MAX_BATCH_SIZE data areas.
+    uint8_t* const* areas = reinterpret_cast<uint8_t* const*>(data);
+    for (size_t first = 0; first < count; first += MAX_BATCH_SIZE) {
+        const size_t n = std::min(MAX_BATCH_SIZE, count - first);
+        if (n <= 64) {
+            decryptBatch<uint64_t>(areas + first, sizes + first, n);
+        }
+        else {
+            decryptBatch<Word128>(areas + first, sizes + first, n);
+        }
+    }
+    return true;
+}
+
+template <typename W>
+void ts::DVBCSA2::decryptBatch(uint8_t* const data[], const size_t sizes[], size_t count)
+{
+    assert(count <= 8 * sizeof(W));
+
+    size_t max_steps = 0;
+    const uint8_t* first_blocks[8 * sizeof(W)] = {};
+    for (size_t i = 0; i < count; ++i) {
+        const size_t nblocks = sizes[i] < 8 ? 0 : sizes[i] / 8;
+        max_steps = std::max(max_steps, nblocks == 0 ? 0 : nblocks - 1 + (sizes[i] % 8 != 0));
+        first_blocks[i] = nblocks == 0 ? nullptr : data[i];
+    }
+
+    // Initialize stream ciphers with first 8 bytes of each scrambled data area.
+    W words[64];
+    BlocksToWords(words, first_blocks, count);
+    BitSlicedStream<W> stream(_key);
+    stream.init(words);
+
+    // Apply the stream cipher on subsequent blocks and residue.
+    // The intermediate blocks of the block cipher are stored in place.
+    uint8_t blocks[8 * sizeof(W)][8];
+    for (size_t k = 1; k <= max_steps; ++k) {
+        stream.generate(words);
+        WordsToBlocks(blocks, words, count);
+        for (size_t i = 0; i < count; ++i) {
+            const size_t nblocks = sizes[i] / 8;
+            if (sizes[i] >= 8 && k < nblocks) {
+                xor_8(data[i] + 8 * k, data[i] + 8 * k, blocks[i]);
+            }
+            else if (sizes[i] >= 8 && k == nblocks) {
+                for (size_t j = 0; j < sizes[i] % 8; ++j) {
+                    data[i][8 * nblocks + j] ^= blocks[i][j];
+                }
+            }
+        }
+    }
+
+    // Decipher all blocks of each data area, then chain them.
+    // Last block: sb[nblocks+1] = IV = 0.
+    uint8_t ib[MAX_NBLOCKS][8];
+    for (size_t i = 0; i < count; ++i) {
+        const size_t nblocks = sizes[i] < 8 ? 0 : sizes[i] / 8;
+        if (nblocks > 0) {
+            ::memcpy(ib, data[i], 8 * nblocks);
+            _block.decipher(ib, nblocks);
+            for (size_t k = 0; k + 1 < nblocks; ++k) {
+                xor_8(data[i] + 8 * k, ib[k], data[i] + 8 * (k + 1));
+            }
+            memcpy_8(data[i] + 8 * (nblocks - 1), ib[nblocks - 1]);
+        }
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Wrappers for encrypt and decrypt.
 //----------------------------------------------------------------------------
@@ -88,6 +88,34 @@ namespace ts {
         //!
         static bool IsReducedCW(const uint8_t *cw);
 
+        //!
+        //! Maximum number of data areas which are processed in parallel in batch operations.
+        //! Larger batches are processed in several passes.
+        //!
+        static const size_t MAX_BATCH_SIZE = 128;
+
+        //!
+        //! Encrypt a batch of data areas in place (typically the payloads of TS packets) with the current key.
+        //! This is equivalent to calling encryptInPlace() on each area but much faster. The data areas
+        //! are processed in parallel using a bit-sliced implementation of the stream cipher.
+        //! @param [in,out] data Array of @a count addresses of data areas.
+        //! @param [in] sizes Array of @a count data sizes in bytes. Areas smaller than 8 bytes are left clear.
+        //! @param [in] count Number of data areas.
+        //! @return True on success, false on error. On error, no data area is modified.
+        //!
+        bool encryptInPlaceBatch(void* const data[], const size_t sizes[], size_t count);
+
+        //!
+        //! Decrypt a batch of data areas in place (typically the payloads of TS packets) with the current key.
+        //! This is equivalent to calling decryptInPlace() on each area but much faster. The data areas
+        //! are processed in parallel using a bit-sliced implementation of the stream cipher.
+        //! @param [in,out] data Array of @a count addresses of data areas.
+        //! @param [in] sizes Array of @a count data sizes in bytes. Areas smaller than 8 bytes are left unmodified.
+        //! @param [in] count Number of data areas.
+        //! @return True on success, false on error. On error, no data area is modified.
+        //!
+        bool decryptInPlaceBatch(void* const data[], const size_t sizes[], size_t count);
+
         // Implementation of CipherChaining interface. Cannot set IV with DVB CSA.
         virtual bool setIV(const void*, size_t) override;
         virtual size_t minIVSize() const override;
@@ -123,6 +151,9 @@ namespace ts {
             void init(const uint8_t *cw);
             void encipher(const uint8_t *bd, uint8_t *ib);
             void decipher(const uint8_t *ib, uint8_t *bd);
+            // Process several independent blocks in place, interleaved.
+            void encipher(uint8_t (*blocks)[8], size_t count);
+            void decipher(uint8_t (*blocks)[8], size_t count);
         };
 
         // Stream cipher data
@@ -151,5 +182,9 @@ namespace ts {
         uint8_t      _key[KEY_SIZE];
         BlockCipher  _block;
         StreamCipher _stream;
+
+        // Batch processing, one bit of a word W per data area, at most 8*sizeof(W) areas.
+        template <typename W> void encryptBatch(uint8_t* const data[], const size_t sizes[], size_t count);
+        template <typename W> void decryptBatch(uint8_t* const data[], const size_t sizes[], size_t count);
     };
 }
@@ -45,7 +45,7 @@ TS_MSC_NOWARNING(4505) // warning C4505: 'ts::DVS042<ts::AES>::encrypt': unrefer
 
 template<class CIPHER>
 ts::DVS042<CIPHER>::DVS042() :
-    CipherChainingTemplate<CIPHER>(1, 1, 1),
+    CipherChainingTemplate<CIPHER>(1, 1, CipherChaining::PARALLEL_BLOCKS),
     shortIV(this->block_size)
 {
 }
@@ -174,7 +174,7 @@ bool ts::DVS042<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, v
     if (this->algo == nullptr ||
         this->iv.size() != this->block_size ||
         this->shortIV.size() != this->block_size ||
-        this->work.size() < this->block_size ||
+        this->work.size() < this->PARALLEL_BLOCKS * this->block_size ||
         plain_maxsize < cipher_length)
     {
         return false;
@@ -192,21 +192,24 @@ bool ts::DVS042<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, v
     const uint8_t* ct = reinterpret_cast<const uint8_t*>(cipher);
     uint8_t* pt = reinterpret_cast<uint8_t*>(plain);
 
+    // All blocks are deciphered independently, several at a time.
     while (cipher_length >= this->block_size) {
-        // work = decrypt (cipher-text)
-        if (!this->algo->decrypt(ct, this->block_size, this->work.data(), this->block_size)) {
+        // work = decrypt (several blocks of cipher-text)
+        const size_t count = std::min(cipher_length / this->block_size, this->PARALLEL_BLOCKS);
+        const size_t size = count * this->block_size;
+        if (!this->algo->decryptBlocks(ct, this->work.data(), count)) {
             return false;
         }
         // plain-text = previous-cipher XOR work
-        for (size_t i = 0; i < this->block_size; ++i) {
-            pt[i] = previous[i] ^ this->work[i];
+        for (size_t i = 0; i < size; ++i) {
+            pt[i] = (i < this->block_size ? previous[i] : ct[i - this->block_size]) ^ this->work[i];
         }
-        // previous-cipher = cipher-text
-        previous = ct;
-        // advance one block
-        ct += this->block_size;
-        pt += this->block_size;
-        cipher_length -= this->block_size;
+        // previous-cipher = last cipher-text
+        previous = ct + size - this->block_size;
+        // advance several blocks
+        ct += size;
+        pt += size;
+        cipher_length -= size;
     }
 
     // Process final block if incomplete
@@ -113,6 +113,18 @@ namespace ts {
             //!
             bool receive(MessagePtr& msg, const AbortInterface* abort, Logger& logger);
 
+            //!
+            //! Receive all TLV messages which are already available, without waiting.
+            //! This method is designed for event loops, when the socket is known to be readable.
+            //! It performs exactly one receive operation on the socket and returns all complete
+            //! messages. A trailing incomplete message is kept until the next call. Invalid
+            //! messages are processed as in receive().
+            //! @param [out] msgs Returned list of complete valid messages, possibly empty.
+            //! @param [in,out] logger Where to report errors and messages.
+            //! @return True on success, false on error or disconnection.
+            //!
+            bool receiveAvailable(std::list<MessagePtr>& msgs, Logger& logger);
+
             //!
             //! Get invalid incoming messages processing.
             //! @return True if, when an invalid message is received, the corresponding
@@ -155,6 +167,14 @@ namespace ts {
             size_t          _invalid_msg_count;
             MUTEX           _send_mutex;
             MUTEX           _receive_mutex;
+            ByteBlock       _partial;  // Incomplete message data in receiveAvailable().
+
+            // Size of the receive buffer in receiveAvailable().
+            static constexpr size_t RECEIVE_CHUNK = 16384;
+
+            // Analyze a complete message. Set valid to false on invalid message.
+            // Return false if the connection must be broken.
+            bool analyzeMessage(const uint8_t* data, size_t size, MessagePtr& msg, bool& valid, Logger& logger);
         };
     }
 }
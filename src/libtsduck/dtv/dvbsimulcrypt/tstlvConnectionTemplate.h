@@ -46,7 +46,8 @@ ts::tlv::Connection<MUTEX>::Connection(const Protocol* protocol, bool auto_error
     _max_invalid_msg(max_invalid_msg),
     _invalid_msg_count(0),
     _send_mutex(),
-    _receive_mutex()
+    _receive_mutex(),
+    _partial()
 {
 }
 
@@ -65,6 +66,7 @@ void ts::tlv::Connection<MUTEX>::handleConnected(Report& report)
 {
     SuperClass::handleConnected(report);
     _invalid_msg_count = 0;
+    _partial.clear();
 }
 
 TS_POP_WARNING()
@@ -134,34 +136,99 @@ bool ts::tlv::Connection<MUTEX>::receive(MessagePtr& msg, const AbortInterface*
             }
         }
 
-        // Analyze the message
-        MessageFactory mf(bb.data(), bb.size(), _protocol);
-        if (mf.errorStatus() == tlv::OK) {
-            _invalid_msg_count = 0;
-            mf.factory(msg);
-            if (!msg.isNull()) {
-                logger.log(*msg, u"received message from " + peerName());
-            }
+        // Analyze the message, loop on invalid messages.
+        bool valid = false;
+        if (!analyzeMessage(bb.data(), bb.size(), msg, valid, logger)) {
+            return false;
+        }
+        else if (valid) {
             return true;
         }
+    }
+}
 
-        // Received an invalid message
-        _invalid_msg_count++;
 
-        // Send back an error message if necessary
-        if (_auto_error_response) {
-            MessagePtr resp;
-            mf.buildErrorResponse(resp);
-            if (!send(*resp, logger.report())) {
-                return false;
-            }
+//----------------------------------------------------------------------------
+// Receive all TLV messages which are already available, without waiting.
+//----------------------------------------------------------------------------
+
+template <class MUTEX>
+bool ts::tlv::Connection<MUTEX>::receiveAvailable(std::list<MessagePtr>& msgs, Logger& logger)
+{
+    const bool has_version(_protocol->hasVersion());
+    const size_t header_size(has_version ? 5 : 4);
+    const size_t length_offset(has_version ? 3 : 2);
+
+    msgs.clear();
+    Guard lock(_receive_mutex);
+
+    // Exactly one receive operation, after the incomplete message from previous calls.
+    const size_t previous = _partial.size();
+    size_t got = 0;
+    _partial.resize(previous + RECEIVE_CHUNK);
+    const bool ok = SuperClass::receive(_partial.data() + previous, RECEIVE_CHUNK, got, nullptr, logger.report());
+    _partial.resize(previous + got);
+    if (!ok) {
+        return false;
+    }
+
+    // Extract all complete messages.
+    size_t start = 0;
+    while (_partial.size() - start >= header_size) {
+        const size_t size = header_size + GetUInt16(_partial.data() + start + length_offset);
+        if (_partial.size() - start < size) {
+            break;
         }
+        MessagePtr msg;
+        bool valid = false;
+        if (!analyzeMessage(_partial.data() + start, size, msg, valid, logger)) {
+            return false;
+        }
+        if (valid && !msg.isNull()) {
+            msgs.push_back(msg);
+        }
+        start += size;
+    }
+    _partial.erase(0, start);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Analyze a complete message.
+//----------------------------------------------------------------------------
 
-        // If invalid message max has been reached, break the connection
-        if (_max_invalid_msg > 0 && _invalid_msg_count >= _max_invalid_msg) {
-            logger.report().error(u"too many invalid messages from %s, disconnecting", {peerName()});
-            disconnect(logger.report());
+template <class MUTEX>
+bool ts::tlv::Connection<MUTEX>::analyzeMessage(const uint8_t* data, size_t size, MessagePtr& msg, bool& valid, Logger& logger)
+{
+    MessageFactory mf(data, size, _protocol);
+    valid = mf.errorStatus() == tlv::OK;
+    if (valid) {
+        _invalid_msg_count = 0;
+        mf.factory(msg);
+        if (!msg.isNull()) {
+            logger.log(*msg, u"received message from " + peerName());
+        }
+        return true;
+    }
+
+    // Received an invalid message
+    _invalid_msg_count++;
+
+    // Send back an error message if necessary
+    if (_auto_error_response) {
+        MessagePtr resp;
+        mf.buildErrorResponse(resp);
+        if (!send(*resp, logger.report())) {
             return false;
         }
     }
+
+    // If invalid message max has been reached, break the connection
+    if (_max_invalid_msg > 0 && _invalid_msg_count >= _max_invalid_msg) {
+        logger.report().error(u"too many invalid messages from %s, disconnecting", {peerName()});
+        disconnect(logger.report());
+        return false;
+    }
+    return true;
 }
@@ -0,0 +1,260 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsNamesIndex.h"
+#include "tsSysUtils.h"
+TSDUCK_SOURCE;
+
+const char ts::NamesIndex::MAGIC[8] = {'T', 'S', 'N', 'A', 'M', 'E', 'S', 0};
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr uint32_t ts::NamesIndex::VERSION;
+constexpr uint32_t ts::NamesIndex::ENDIAN_MARK;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::NamesIndex::NamesIndex() :
+    _base(nullptr),
+    _size(0),
+    _sections(nullptr),
+    _entries(nullptr),
+    _strings(nullptr),
+    _header(nullptr)
+{
+}
+
+ts::NamesIndex::~NamesIndex()
+{
+    close();
+}
+
+
+//----------------------------------------------------------------------------
+// Map an index file in memory.
+//----------------------------------------------------------------------------
+
+bool ts::NamesIndex::open(const UString& fileName, uint64_t sourceSize, Report& report)
+{
+    close();
+
+    // Map the complete file, read-only.
+#if defined(TS_WINDOWS)
+
+    ::HANDLE file = ::CreateFileW(fileName.wc_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    ::LARGE_INTEGER size;
+    if (file == INVALID_HANDLE_VALUE || !::GetFileSizeEx(file, &size)) {
+        report.debug(u"error opening %s: %s", {fileName, ErrorCodeMessage()});
+        if (file != INVALID_HANDLE_VALUE) {
+            ::CloseHandle(file);
+        }
+        return false;
+    }
+    _size = size_t(size.QuadPart);
+    ::HANDLE mapping = _size < sizeof(Header) ? nullptr : ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* addr = mapping == nullptr ? nullptr : ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (mapping != nullptr) {
+        // The view remains valid after closing the mapping handle.
+        ::CloseHandle(mapping);
+    }
+    ::CloseHandle(file);
+    if (addr == nullptr) {
+        report.debug(u"error mapping %s", {fileName});
+        _size = 0;
+        return false;
+    }
+
+#else
+
+    const int fd = ::open(fileName.toUTF8().c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) < 0) {
+        report.debug(u"error opening %s: %s", {fileName, ErrorCodeMessage()});
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+    _size = size_t(st.st_size);
+    void* addr = _size < sizeof(Header) ? MAP_FAILED : ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping remains valid after closing the file descriptor.
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        report.debug(u"error mapping %s", {fileName});
+        _size = 0;
+        return false;
+    }
+
+#endif
+
+    _base = reinterpret_cast<const uint8_t*>(addr);
+    _header = reinterpret_cast<const Header*>(_base);
+
+    // Validate the header and the global layout.
+    const uint64_t sections_size = uint64_t(_header->section_count) * sizeof(Section);
+    const uint64_t entries_size = uint64_t(_header->entry_count) * sizeof(Entry);
+    if (::memcmp(_header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        _header->version != VERSION ||
+        _header->endian_mark != ENDIAN_MARK ||
+        sizeof(Header) + sections_size + entries_size + _header->strings_size != _size)
+    {
+        report.debug(u"%s is not a valid names index file", {fileName});
+        close();
+        return false;
+    }
+    if (_header->source_size != sourceSize) {
+        report.debug(u"%s was built from a different names file, ignored", {fileName});
+        close();
+        return false;
+    }
+
+    _sections = reinterpret_cast<const Section*>(_base + sizeof(Header));
+    _entries = reinterpret_cast<const Entry*>(_base + sizeof(Header) + sections_size);
+    _strings = reinterpret_cast<const char*>(_base + sizeof(Header) + sections_size + entries_size);
+
+    // Validate sections (they are few). Entries are individually checked when used.
+    for (uint32_t i = 0; i < _header->section_count; ++i) {
+        const Section& sec(_sections[i]);
+        if (uint64_t(sec.name_offset) + sec.name_size > _header->strings_size ||
+            uint64_t(sec.first_entry) + sec.entry_count > _header->entry_count)
+        {
+            report.debug(u"%s: invalid section #%d", {fileName, i});
+            close();
+            return false;
+        }
+    }
+
+    report.debug(u"using names index %s, %d sections, %d entries", {fileName, _header->section_count, _header->entry_count});
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Unmap the index file.
+//----------------------------------------------------------------------------
+
+void ts::NamesIndex::close()
+{
+    if (_base != nullptr) {
+#if defined(TS_WINDOWS)
+        ::UnmapViewOfFile(_base);
+#else
+        ::munmap(const_cast<uint8_t*>(_base), _size);
+#endif
+    }
+    _base = nullptr;
+    _size = 0;
+    _header = nullptr;
+    _sections = nullptr;
+    _entries = nullptr;
+    _strings = nullptr;
+}
+
+
+//----------------------------------------------------------------------------
+// Find a section by name (binary search on the UTF-8 lower-case names).
+//----------------------------------------------------------------------------
+
+const ts::NamesIndex::Section* ts::NamesIndex::findSection(const UString& name) const
+{
+    if (_base == nullptr) {
+        return nullptr;
+    }
+
+    const std::string key(name.toUTF8());
+    size_t low = 0;
+    size_t high = _header->section_count;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const Section* sec = _sections + mid;
+        const int cmp = ::memcmp(_strings + sec->name_offset, key.data(), std::min<size_t>(sec->name_size, key.size()));
+        if (cmp == 0 && sec->name_size == key.size()) {
+            return sec;
+        }
+        else if (cmp < 0 || (cmp == 0 && sec->name_size < key.size())) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return nullptr;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the entry with the largest first value not greater than 'value'.
+//----------------------------------------------------------------------------
+
+const ts::NamesIndex::Entry* ts::NamesIndex::lowerEntry(const Section* section, uint64_t value) const
+{
+    if (_base == nullptr || section == nullptr || section->entry_count == 0) {
+        return nullptr;
+    }
+
+    // Find the first entry with a first value greater than 'value'.
+    const Entry* const begin = _entries + section->first_entry;
+    const Entry* const end = begin + section->entry_count;
+    const Entry* const it = std::upper_bound(begin, end, value, [](uint64_t val, const Entry& e) { return val < e.first; });
+
+    // The previous one, if any, is the only candidate.
+    return it == begin ? nullptr : it - 1;
+}
+
+
+//----------------------------------------------------------------------------
+// Get a name from a value in a section.
+//----------------------------------------------------------------------------
+
+ts::UString ts::NamesIndex::getName(const Section* section, uint64_t value) const
+{
+    const Entry* e = lowerEntry(section, value);
+    if (e != nullptr && value <= e->last && uint64_t(e->name_offset) + e->name_size <= _header->strings_size) {
+        return UString::FromUTF8(_strings + e->name_offset, e->name_size);
+    }
+    else {
+        return UString();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check if a range is free in a section.
+//----------------------------------------------------------------------------
+
+bool ts::NamesIndex::freeRange(const Section* section, uint64_t first, uint64_t last) const
+{
+    // The only candidates for an overlap are the entry before 'last' and, since entries
+    // are sorted and not overlapping, this entry is the last one which starts before 'last'.
+    const Entry* e = lowerEntry(section, last);
+    return e == nullptr || e->last < first;
+}
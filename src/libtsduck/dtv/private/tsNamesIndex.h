@@ -0,0 +1,178 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Memory-mapped binary index of a names file.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsUString.h"
+#include "tsReport.h"
+
+namespace ts {
+    //!
+    //! Memory-mapped binary index of a names file (tsduck*.names).
+    //! This class is internal to the TSDuck library and cannot be called by applications.
+    //!
+    //! The binary index is built from the text file by Names::CompileIndex().
+    //! It is mapped read-only in memory and shared between all processes which
+    //! use the same file. The layout is:
+    //! - Header.
+    //! - Array of Section, sorted by lower-case UTF-8 name.
+    //! - Array of Entry, grouped by section, sorted by first value in each section.
+    //! - String pool, UTF-8 names, without trailing nul.
+    //!
+    //! All integers are stored in native byte order. An index which was built on
+    //! a platform with a different byte order is rejected.
+    //!
+    class NamesIndex
+    {
+        TS_NOCOPY(NamesIndex);
+    public:
+        //!
+        //! Value of the first 8 bytes of an index file.
+        //!
+        static const char MAGIC[8];
+
+        //!
+        //! Current version of the binary layout.
+        //!
+        static constexpr uint32_t VERSION = 1;
+
+        //!
+        //! Byte order marker, as written by the compiling platform.
+        //!
+        static constexpr uint32_t ENDIAN_MARK = 0x01020304;
+
+        //!
+        //! File header.
+        //!
+        struct Header
+        {
+            char     magic[8];       //!< MAGIC value.
+            uint32_t version;        //!< VERSION value.
+            uint32_t endian_mark;    //!< ENDIAN_MARK value.
+            uint64_t source_size;    //!< Size in bytes of the text file which was compiled.
+            uint32_t section_count;  //!< Number of Section structures.
+            uint32_t entry_count;    //!< Number of Entry structures.
+            uint32_t strings_size;   //!< Size in bytes of the string pool.
+            uint32_t reserved;       //!< Unused, zero.
+        };
+
+        //!
+        //! Description of a section.
+        //!
+        struct Section
+        {
+            uint32_t name_offset;    //!< Offset of the lower-case section name in string pool.
+            uint32_t name_size;      //!< Size in bytes of the section name.
+            uint32_t bits;           //!< Number of significant bits in values of the section.
+            uint32_t first_entry;    //!< Index of first Entry of the section.
+            uint32_t entry_count;    //!< Number of entries in the section.
+            uint32_t reserved;       //!< Unused, zero.
+        };
+
+        //!
+        //! Description of a range of values with the same name.
+        //!
+        struct Entry
+        {
+            uint64_t first;          //!< First value in the range.
+            uint64_t last;           //!< Last value in the range.
+            uint32_t name_offset;    //!< Offset of the name in string pool.
+            uint32_t name_size;      //!< Size in bytes of the name.
+        };
+
+        //!
+        //! Constructor.
+        //!
+        NamesIndex();
+
+        //!
+        //! Destructor.
+        //!
+        ~NamesIndex();
+
+        //!
+        //! Map an index file in memory.
+        //! @param [in] fileName Name of the index file.
+        //! @param [in] sourceSize Size in bytes of the text file. The index is rejected if it was built from a file with another size.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error or invalid index file.
+        //!
+        bool open(const UString& fileName, uint64_t sourceSize, Report& report);
+
+        //!
+        //! Unmap the index file.
+        //!
+        void close();
+
+        //!
+        //! Check if an index file is mapped.
+        //! @return True if an index file is mapped.
+        //!
+        bool isOpen() const { return _base != nullptr; }
+
+        //!
+        //! Find a section by name.
+        //! @param [in] name Lower-case section name.
+        //! @return Address of the section description or null if not found.
+        //!
+        const Section* findSection(const UString& name) const;
+
+        //!
+        //! Get a name from a value in a section.
+        //! @param [in] section Section description, as returned by findSection().
+        //! @param [in] value Value to get the name for.
+        //! @return The corresponding name, empty if not found.
+        //!
+        UString getName(const Section* section, uint64_t value) const;
+
+        //!
+        //! Check if a range is free in a section, ie no value is defined in the range.
+        //! @param [in] section Section description, as returned by findSection().
+        //! @param [in] first First value in the range.
+        //! @param [in] last Last value in the range.
+        //! @return True if no value of the range has a name.
+        //!
+        bool freeRange(const Section* section, uint64_t first, uint64_t last) const;
+
+    private:
+        const uint8_t* _base;      // Base address of the mapped file.
+        size_t         _size;      // Size of the mapped file.
+        const Section* _sections;  // Array of sections.
+        const Entry*   _entries;   // Array of entries.
+        const char*    _strings;   // String pool.
+        const Header*  _header;    // File header.
+
+        // Get the entry with the largest first value not greater than 'value', null if there is none.
+        const Entry* lowerEntry(const Section* section, uint64_t value) const;
+    };
+}
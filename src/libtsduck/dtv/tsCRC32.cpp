@@ -32,6 +32,31 @@
 //----------------------------------------------------------------------------
 
 #include "tsCRC32.h"
+#include "tsSysInfo.h"
+#include "tsMemory.h"
+
+// Carry-less multiplication kernels, when supported by the compiler.
+// The kernels are compiled for the specific instruction set, regardless
+// of the compilation options of the rest of the code. They are used only
+// after checking at run time that the CPU supports the instructions.
+#if defined(TS_X86_64) && defined(TS_GCC)
+    #define TS_CRC32_CLMUL_INTEL 1
+    #define TS_CRC32_CLMUL_TARGET __attribute__((target("pclmul,ssse3")))
+    #include <immintrin.h>
+#elif defined(TS_X86_64) && defined(TS_MSC)
+    #define TS_CRC32_CLMUL_INTEL 1
+    #define TS_CRC32_CLMUL_TARGET
+    #include <intrin.h>
+#elif defined(TS_ARM64) && defined(TS_GCC_ONLY)
+    #define TS_CRC32_CLMUL_ARM 1
+    #define TS_CRC32_CLMUL_TARGET __attribute__((target("+crypto")))
+    #include <arm_neon.h>
+#elif defined(TS_ARM64) && defined(__ARM_FEATURE_CRYPTO)
+    #define TS_CRC32_CLMUL_ARM 1
+    #define TS_CRC32_CLMUL_TARGET
+    #include <arm_neon.h>
+#endif
+
 TSDUCK_SOURCE;
 
 
@@ -109,13 +134,289 @@ namespace {
     };
 }
 
-// Continue the computation of a data area, following a previous CRC32
 
-void ts::CRC32::add (const void* data, size_t size)
+//----------------------------------------------------------------------------
+// Tables which are computed once, from the reference table.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Minimum size of data for the carry-less multiplication kernel.
+    // Smaller areas are computed using slicing-by-8.
+    constexpr size_t CLMUL_MIN_SIZE = 64;
+
+    class CRC32Tables
+    {
+    public:
+        CRC32Tables();
+
+        // Slicing-by-8 tables: slice[k][b] is the CRC32 of byte b, followed by k zero bytes.
+        uint32_t slice[8][256];
+
+        // Folding constants: fold[n] is x^(64*n) mod P, for n = 2 to 9.
+        // Folding a 128-bit block over d bits uses fold[d/64+1] and fold[d/64].
+        uint64_t fold[10];
+
+        // Get the unique instance.
+        static const CRC32Tables& Instance()
+        {
+            static const CRC32Tables tables;
+            return tables;
+        }
+
+    private:
+        // Compute x^n mod P.
+        static uint32_t XPowerModP(size_t n);
+    };
+
+    CRC32Tables::CRC32Tables()
+    {
+        for (size_t b = 0; b < 256; ++b) {
+            slice[0][b] = fcstab_32[b];
+        }
+        for (size_t k = 1; k < 8; ++k) {
+            for (size_t b = 0; b < 256; ++b) {
+                const uint32_t prev = slice[k-1][b];
+                slice[k][b] = (prev << 8) ^ fcstab_32[prev >> 24];
+            }
+        }
+        for (size_t n = 0; n < 10; ++n) {
+            fold[n] = XPowerModP(64 * n);
+        }
+    }
+
+    uint32_t CRC32Tables::XPowerModP(size_t n)
+    {
+        uint32_t r = 1;
+        while (n-- > 0) {
+            r = (r << 1) ^ ((r & 0x80000000) != 0 ? 0x04C11DB7 : 0);
+        }
+        return r;
+    }
+
+    // Reference implementation, one byte at a time.
+    inline uint32_t AddBytewise(uint32_t fcs, const uint8_t* cp, size_t size)
+    {
+        while (size-- > 0) {
+            fcs = (fcs << 8) ^ fcstab_32[((fcs >> 24) ^ (*cp++)) & 0xFF];
+        }
+        return fcs;
+    }
+
+    // Slicing-by-8 implementation.
+    uint32_t AddSliceBy8(uint32_t fcs, const uint8_t* cp, size_t size)
+    {
+        const CRC32Tables& t(CRC32Tables::Instance());
+        while (size >= 8) {
+            const uint32_t a = fcs ^ ts::GetUInt32BE(cp);
+            fcs = t.slice[7][a >> 24] ^ t.slice[6][(a >> 16) & 0xFF] ^ t.slice[5][(a >> 8) & 0xFF] ^ t.slice[4][a & 0xFF] ^
+                  t.slice[3][cp[4]] ^ t.slice[2][cp[5]] ^ t.slice[1][cp[6]] ^ t.slice[0][cp[7]];
+            cp += 8;
+            size -= 8;
+        }
+        return AddBytewise(fcs, cp, size);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Carry-less multiplication implementation.
+//
+// The data are processed as 128-bit blocks, interpreted as polynomials with
+// the most significant bit of the first byte as highest degree coefficient.
+// The initial CRC value is xor'ed in the first four bytes. A block B at a
+// distance of d bits before the end is "folded" into a 96-bit polynomial which
+// is congruent modulo P: B.x^d = B_hi.x^(d+64) + B_lo.x^d, with precomputed
+// x^(d+64) mod P and x^d mod P. Four blocks are folded in parallel to hide the
+// latency of the multiplication. The last 128-bit block and the remaining bytes
+// are then processed using slicing-by-8 with a zero initial value.
+//----------------------------------------------------------------------------
+
+#if defined(TS_CRC32_CLMUL_INTEL)
+
+namespace {
+
+    // Load 16 bytes and reverse them: the first byte becomes the most significant.
+    TS_CRC32_CLMUL_TARGET inline __m128i Load128(const uint8_t* cp, __m128i swap)
+    {
+        return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cp)), swap);
+    }
+
+    // Fold a 128-bit block using constants (x^(d+64) mod P, x^d mod P) in (high, low) parts of k.
+    TS_CRC32_CLMUL_TARGET inline __m128i Fold128(__m128i x, __m128i k)
+    {
+        return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x11), _mm_clmulepi64_si128(x, k, 0x00));
+    }
+
+    TS_CRC32_CLMUL_TARGET uint32_t AddCarryLess(uint32_t fcs, const uint8_t* cp, size_t size)
+    {
+        const CRC32Tables& t(CRC32Tables::Instance());
+        const __m128i swap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        const __m128i k128 = _mm_set_epi64x(int64_t(t.fold[3]), int64_t(t.fold[2]));
+        const __m128i k256 = _mm_set_epi64x(int64_t(t.fold[5]), int64_t(t.fold[4]));
+        const __m128i k384 = _mm_set_epi64x(int64_t(t.fold[7]), int64_t(t.fold[6]));
+        const __m128i k512 = _mm_set_epi64x(int64_t(t.fold[9]), int64_t(t.fold[8]));
+
+        // Load the first four blocks, with initial CRC value.
+        __m128i x0 = _mm_xor_si128(Load128(cp, swap), _mm_set_epi32(int32_t(fcs), 0, 0, 0));
+        __m128i x1 = Load128(cp + 16, swap);
+        __m128i x2 = Load128(cp + 32, swap);
+        __m128i x3 = Load128(cp + 48, swap);
+        cp += 64;
+        size -= 64;
+
+        // Fold four blocks in parallel.
+        while (size >= 64) {
+            x0 = _mm_xor_si128(Fold128(x0, k512), Load128(cp, swap));
+            x1 = _mm_xor_si128(Fold128(x1, k512), Load128(cp + 16, swap));
+            x2 = _mm_xor_si128(Fold128(x2, k512), Load128(cp + 32, swap));
+            x3 = _mm_xor_si128(Fold128(x3, k512), Load128(cp + 48, swap));
+            cp += 64;
+            size -= 64;
+        }
+
+        // Fold the four blocks into one, then the remaining blocks.
+        __m128i x = _mm_xor_si128(_mm_xor_si128(Fold128(x0, k384), Fold128(x1, k256)), _mm_xor_si128(Fold128(x2, k128), x3));
+        while (size >= 16) {
+            x = _mm_xor_si128(Fold128(x, k128), Load128(cp, swap));
+            cp += 16;
+            size -= 16;
+        }
+
+        // Compute the CRC of the last block and remaining bytes.
+        uint8_t last[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(last), _mm_shuffle_epi8(x, swap));
+        return AddSliceBy8(AddSliceBy8(0, last, sizeof(last)), cp, size);
+    }
+}
+
+#elif defined(TS_CRC32_CLMUL_ARM)
+
+namespace {
+
+    // Load 16 bytes and reverse them: the first byte becomes the most significant.
+    TS_CRC32_CLMUL_TARGET inline uint64x2_t Load128(const uint8_t* cp)
+    {
+        const uint8x16_t x = vrev64q_u8(vld1q_u8(cp));
+        return vreinterpretq_u64_u8(vextq_u8(x, x, 8));
+    }
+
+    // Fold a 128-bit block using constants (x^(d+64) mod P, x^d mod P) in (high, low) parts of k.
+    TS_CRC32_CLMUL_TARGET inline uint64x2_t Fold128(uint64x2_t x, uint64x2_t k)
+    {
+        const poly128_t hi = vmull_p64(poly64_t(vgetq_lane_u64(x, 1)), poly64_t(vgetq_lane_u64(k, 1)));
+        const poly128_t lo = vmull_p64(poly64_t(vgetq_lane_u64(x, 0)), poly64_t(vgetq_lane_u64(k, 0)));
+        return veorq_u64(vreinterpretq_u64_p128(hi), vreinterpretq_u64_p128(lo));
+    }
+
+    TS_CRC32_CLMUL_TARGET inline uint64x2_t Constants(uint64_t hi, uint64_t lo)
+    {
+        return vcombine_u64(vcreate_u64(lo), vcreate_u64(hi));
+    }
+
+    TS_CRC32_CLMUL_TARGET uint32_t AddCarryLess(uint32_t fcs, const uint8_t* cp, size_t size)
+    {
+        const CRC32Tables& t(CRC32Tables::Instance());
+        const uint64x2_t k128 = Constants(t.fold[3], t.fold[2]);
+        const uint64x2_t k256 = Constants(t.fold[5], t.fold[4]);
+        const uint64x2_t k384 = Constants(t.fold[7], t.fold[6]);
+        const uint64x2_t k512 = Constants(t.fold[9], t.fold[8]);
+
+        // Load the first four blocks, with initial CRC value.
+        uint64x2_t x0 = veorq_u64(Load128(cp), Constants(uint64_t(fcs) << 32, 0));
+        uint64x2_t x1 = Load128(cp + 16);
+        uint64x2_t x2 = Load128(cp + 32);
+        uint64x2_t x3 = Load128(cp + 48);
+        cp += 64;
+        size -= 64;
+
+        // Fold four blocks in parallel.
+        while (size >= 64) {
+            x0 = veorq_u64(Fold128(x0, k512), Load128(cp));
+            x1 = veorq_u64(Fold128(x1, k512), Load128(cp + 16));
+            x2 = veorq_u64(Fold128(x2, k512), Load128(cp + 32));
+            x3 = veorq_u64(Fold128(x3, k512), Load128(cp + 48));
+            cp += 64;
+            size -= 64;
+        }
+
+        // Fold the four blocks into one, then the remaining blocks.
+        uint64x2_t x = veorq_u64(veorq_u64(Fold128(x0, k384), Fold128(x1, k256)), veorq_u64(Fold128(x2, k128), x3));
+        while (size >= 16) {
+            x = veorq_u64(Fold128(x, k128), Load128(cp));
+            cp += 16;
+            size -= 16;
+        }
+
+        // Compute the CRC of the last block and remaining bytes.
+        uint8_t last[16];
+        const uint8x16_t rx = vrev64q_u8(vreinterpretq_u8_u64(x));
+        vst1q_u8(last, vextq_u8(rx, rx, 8));
+        return AddSliceBy8(AddSliceBy8(0, last, sizeof(last)), cp, size);
+    }
+}
+
+#endif
+
+
+//----------------------------------------------------------------------------
+// Check if an implementation of the CRC32 computation is supported.
+//----------------------------------------------------------------------------
+
+bool ts::CRC32::IsSupported(Engine engine)
+{
+    switch (engine) {
+        case DEFAULT:
+        case BYTEWISE:
+        case SLICE_BY_8:
+            return true;
+        case CARRY_LESS:
+#if defined(TS_CRC32_CLMUL_INTEL) || defined(TS_CRC32_CLMUL_ARM)
+            return SysInfo::Instance()->crcInstructions();
+#else
+            return false;
+#endif
+        default:
+            return false;
+    }
+}
+
+ts::CRC32::Engine ts::CRC32::DefaultEngine()
+{
+    // Selected once, the first time a CRC32 is computed.
+    static const Engine engine = IsSupported(CARRY_LESS) ? CARRY_LESS : SLICE_BY_8;
+    return engine;
+}
+
+
+//----------------------------------------------------------------------------
+// Continue the computation of a data area, following a previous CRC32.
+//----------------------------------------------------------------------------
+
+void ts::CRC32::add(const void* data, size_t size)
+{
+    add(data, size, DefaultEngine());
+}
+
+void ts::CRC32::add(const void* data, size_t size, Engine engine)
 {
-    const uint8_t* cp = static_cast <const uint8_t*> (data);
+    const uint8_t* cp = static_cast<const uint8_t*>(data);
 
-    while (size-- > 0) {
-        _fcs = (_fcs << 8) ^ fcstab_32 [((_fcs >> 24) ^ (*cp++)) & 0xFF];
+    switch (engine == DEFAULT ? DefaultEngine() : engine) {
+        case BYTEWISE:
+            _fcs = AddBytewise(_fcs, cp, size);
+            break;
+#if defined(TS_CRC32_CLMUL_INTEL) || defined(TS_CRC32_CLMUL_ARM)
+        case CARRY_LESS:
+            if (size >= CLMUL_MIN_SIZE) {
+                _fcs = AddCarryLess(_fcs, cp, size);
+                break;
+            }
+            TS_FALLTHROUGH
+#endif
+        case SLICE_BY_8:
+        default:
+            _fcs = AddSliceBy8(_fcs, cp, size);
+            break;
     }
 }
@@ -63,11 +63,46 @@ namespace ts {
 
         //!
         //! Continue the computation of a data area, following a previous CRC32.
+        //! The fastest implementation which is supported by the CPU is used.
         //! @param [in] data Address of area to analyze.
         //! @param [in] size Size in bytes of area to analyze.
         //!
         void add(const void* data, size_t size);
 
+        //!
+        //! Implementations of the CRC32 computation.
+        //! All implementations produce the same result.
+        //!
+        enum Engine {
+            DEFAULT,      //!< Fastest implementation which is supported by the CPU.
+            BYTEWISE,     //!< Reference implementation, one byte at a time using a 256-entry table.
+            SLICE_BY_8,   //!< Portable implementation, eight bytes at a time using eight tables.
+            CARRY_LESS    //!< Folding using carry-less multiplication (PCLMULQDQ on Intel, PMULL on Arm64).
+        };
+
+        //!
+        //! Continue the computation of a data area using a specific implementation.
+        //! Mostly useful for test and benchmark purposes.
+        //! @param [in] data Address of area to analyze.
+        //! @param [in] size Size in bytes of area to analyze.
+        //! @param [in] engine Implementation to use. Must be supported on this CPU.
+        //! @see IsSupported()
+        //!
+        void add(const void* data, size_t size, Engine engine);
+
+        //!
+        //! Check if an implementation of the CRC32 computation is supported on this system.
+        //! @param [in] engine Implementation to check.
+        //! @return True if @a engine is supported by this CPU and this build of TSDuck.
+        //!
+        static bool IsSupported(Engine engine);
+
+        //!
+        //! Get the implementation of the CRC32 computation which is used by default.
+        //! @return The engine which is used by add() on this system (never DEFAULT).
+        //!
+        static Engine DefaultEngine();
+
         //!
         //! Get the value of the CRC32 as computed so far.
         //! @return The value of the CRC32 as computed so far.
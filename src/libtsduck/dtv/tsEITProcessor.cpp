@@ -29,8 +29,8 @@
 
 #include "tsEITProcessor.h"
 #include "tsSection.h"
+#include "tsPSIEditors.h"
 #include "tsTime.h"
-#include "tsMJD.h"
 #include "tsFatal.h"
 TSDUCK_SOURCE;
 
@@ -318,14 +318,15 @@ void ts::EITProcessor::handleSection(SectionDemux& demux, const Section& section
     const bool is_eit = tid >= TID_EIT_PF_ACT && tid <= TID_EIT_S_OTH_MAX;
 
     // The minimal payload size for EIT's is 6 bytes. Eliminate invalid EIT's.
-    if (is_eit && pl_size < 6) {
+    const EITView eit(section);
+    if (is_eit && !eit.isValid()) {
         return;
     }
 
     // Get EIT's characteristics.
     const uint16_t srv_id = section.tableIdExtension();
-    const uint16_t ts_id  = pl_size < 2 ? 0 : GetUInt16(section.payload());
-    const uint16_t net_id = pl_size < 4 ? 0 : GetUInt16(section.payload() + 2);
+    const uint16_t ts_id  = is_eit ? eit.transportStreamId() : (pl_size < 2 ? 0 : GetUInt16(section.payload()));
+    const uint16_t net_id = is_eit ? eit.originalNetworkId() : (pl_size < 4 ? 0 : GetUInt16(section.payload() + 2));
 
     // Look for EIT's in services to keep or remove.
     if (is_eit) {
@@ -357,54 +358,28 @@ void ts::EITProcessor::handleSection(SectionDemux& demux, const Section& section
 
     // Update the section if this is an EIT.
     if (is_eit) {
-        // Recompute CRC at end only.
-        bool modified = false;
+        // The CRC is recomputed once, when the editor is destroyed.
+        EITEditor editor(*sp);
 
         // Rename EIT's.
         for (auto it = _renamed.begin(); it != _renamed.end(); ++it) {
             if (Match(it->first, srv_id, ts_id, net_id)) {
                 // Rename the specified fields.
                 if (it->second.hasId()) {
-                    modified = true;
-                    sp->setTableIdExtension(it->second.getId(), false);
+                    editor.setServiceId(it->second.getId());
                 }
                 if (it->second.hasTSId()) {
-                    modified = true;
-                    sp->setUInt16(0, it->second.getTSId(), false);
+                    editor.setTransportStreamId(it->second.getTSId());
                 }
                 if (it->second.hasONId()) {
-                    modified = true;
-                    sp->setUInt16(2, it->second.getONId(), false);
+                    editor.setOriginalNetworkId(it->second.getONId());
                 }
             }
         }
 
         // Update all events start times.
-        if (_start_time_offset != 0) {
-            uint8_t* data = const_cast<uint8_t*>(sp->payload() + 6);
-            const uint8_t* const end = sp->payload() + sp->payloadSize();
-            while (data + 12 <= end) {
-                // Update event start time.
-                Time time;
-                if (!DecodeMJD(data + 2, MJD_SIZE, time)) {
-                    _duck.report().warning(u"error decoding event start time from EIT");
-                }
-                else {
-                    time += _start_time_offset;
-                    if (!EncodeMJD(time, data + 2, _date_only ? MJD_MIN_SIZE : MJD_SIZE)) {
-                        _duck.report().warning(u"error encoding event start time into EIT");
-                    }
-                    else {
-                        modified = true;
-                    }
-                }
-                data += 12 + (GetUInt16(data + 10) & 0x0FFF);
-            }
-        }
-
-        // Update CRC if the section was modified.
-        if (modified) {
-            sp->recomputeCRC();
+        if (!editor.addStartTimeOffset(_start_time_offset, _date_only)) {
+            _duck.report().warning(u"error updating event start time in EIT");
         }
     }
 
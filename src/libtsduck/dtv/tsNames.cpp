@@ -33,6 +33,8 @@
 #include "tsFatal.h"
 #include "tsCerrReport.h"
 #include "tsTablesFactory.h"
+#include "tsNamesIndex.h"
+#include "tsMemory.h"
 TSDUCK_SOURCE;
 
 
@@ -325,14 +327,17 @@ ts::Names::Names(const UString& fileName, bool mergeExtensions) :
     _log(CERR),
     _configFile(SearchConfigurationFile(fileName)),
     _configErrors(0),
-    _sections()
+    _sections(),
+    _indexFile(),
+    _index(nullptr)
 {
     // Locate the configuration file.
     if (_configFile.empty()) {
         // Cannot load configuration, names will not be available.
         _log.error(u"configuration file '%s' not found", {fileName});
     }
-    else {
+    else if (!loadIndex(fileName)) {
+        // No usable binary index, parse the text file.
         loadFile(_configFile);
     }
 
@@ -354,6 +359,142 @@ ts::Names::Names(const UString& fileName, bool mergeExtensions) :
 }
 
 
+//----------------------------------------------------------------------------
+// Constructor used to compile a names file into a binary index.
+//----------------------------------------------------------------------------
+
+ts::Names::Names(const UString& fileName, Report& report) :
+    _log(report),
+    _configFile(fileName),
+    _configErrors(0),
+    _sections(),
+    _indexFile(),
+    _index(nullptr)
+{
+    loadFile(_configFile);
+}
+
+
+//----------------------------------------------------------------------------
+// Try to map the binary index of the configuration file.
+//----------------------------------------------------------------------------
+
+bool ts::Names::loadIndex(const UString& fileName)
+{
+    // The index is preferably next to the text file, otherwise in the search path.
+    UString path(_configFile + TS_NAMES_INDEX_SUFFIX);
+    if (!FileExists(path)) {
+        path = SearchConfigurationFile(fileName + TS_NAMES_INDEX_SUFFIX);
+        if (path.empty()) {
+            return false;
+        }
+    }
+
+    // The text file is the reference, ignore an index which is older.
+    if (GetFileModificationTimeUTC(path) < GetFileModificationTimeUTC(_configFile)) {
+        _log.debug(u"%s is older than %s, ignored", {path, _configFile});
+        return false;
+    }
+
+    _index = new NamesIndex;
+    CheckNonNull(_index);
+    if (!_index->open(path, uint64_t(GetFileSize(_configFile)), _log)) {
+        delete _index;
+        _index = nullptr;
+        return false;
+    }
+    _indexFile = path;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Compile a names file into a binary index.
+//----------------------------------------------------------------------------
+
+bool ts::Names::CompileIndex(const UString& textFile, const UString& indexFile, Report& report)
+{
+    if (!FileExists(textFile)) {
+        report.error(u"file %s not found", {textFile});
+        return false;
+    }
+    const Names names(textFile, report);
+    return names._configErrors == 0 && names.saveIndex(indexFile);
+}
+
+
+//----------------------------------------------------------------------------
+// Save the loaded sections in a binary index file.
+//----------------------------------------------------------------------------
+
+bool ts::Names::saveIndex(const UString& fileName) const
+{
+    // The sections are sorted on their UTF-8 names, the order of the binary search in the index.
+    std::map<std::string, const ConfigSection*> sections;
+    for (const auto& it : _sections) {
+        sections[it.first.toUTF8()] = it.second;
+    }
+
+    std::vector<NamesIndex::Section> sectionTable;
+    std::vector<NamesIndex::Entry> entryTable;
+    std::string strings;
+
+    sectionTable.reserve(sections.size());
+    for (const auto& it : sections) {
+        NamesIndex::Section sec;
+        TS_ZERO(sec);
+        sec.name_offset = uint32_t(strings.size());
+        sec.name_size = uint32_t(it.first.size());
+        sec.bits = uint32_t(it.second->bits);
+        sec.first_entry = uint32_t(entryTable.size());
+        sec.entry_count = uint32_t(it.second->entries.size());
+        sectionTable.push_back(sec);
+        strings.append(it.first);
+
+        // The entries map is already sorted by first value.
+        for (const auto& ent : it.second->entries) {
+            const std::string name(ent.second->name.toUTF8());
+            NamesIndex::Entry entry;
+            TS_ZERO(entry);
+            entry.first = ent.first;
+            entry.last = ent.second->last;
+            entry.name_offset = uint32_t(strings.size());
+            entry.name_size = uint32_t(name.size());
+            entryTable.push_back(entry);
+            strings.append(name);
+        }
+    }
+
+    NamesIndex::Header header;
+    TS_ZERO(header);
+    ::memcpy(header.magic, NamesIndex::MAGIC, sizeof(header.magic));  // Flawfinder: ignore: memcpy()
+    header.version = NamesIndex::VERSION;
+    header.endian_mark = NamesIndex::ENDIAN_MARK;
+    header.source_size = uint64_t(GetFileSize(_configFile));
+    header.section_count = uint32_t(sectionTable.size());
+    header.entry_count = uint32_t(entryTable.size());
+    header.strings_size = uint32_t(strings.size());
+
+    // Write the index file.
+    std::ofstream strm(fileName.toUTF8().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!strm) {
+        _log.error(u"error creating file %s", {fileName});
+        return false;
+    }
+    strm.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    strm.write(reinterpret_cast<const char*>(sectionTable.data()), std::streamsize(sectionTable.size() * sizeof(NamesIndex::Section)));
+    strm.write(reinterpret_cast<const char*>(entryTable.data()), std::streamsize(entryTable.size() * sizeof(NamesIndex::Entry)));
+    strm.write(strings.data(), std::streamsize(strings.size()));
+    strm.close();
+    if (!strm) {
+        _log.error(u"error writing file %s", {fileName});
+        return false;
+    }
+    _log.verbose(u"%s: %d sections, %d entries, %'d bytes", {fileName, sectionTable.size(), entryTable.size(), GetFileSize(fileName)});
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Load a configuration file and merge its content into this instance.
 //----------------------------------------------------------------------------
@@ -368,6 +509,7 @@ void ts::Names::loadFile(const UString& fileName)
     }
 
     ConfigSection* section = nullptr;
+    UString sectionName;
     UString line;
 
     // Read configuration file line by line.
@@ -384,6 +526,7 @@ void ts::Names::loadFile(const UString& fileName)
             line.erase(0, 1);
             line.pop_back();
             line.convertToLower();
+            sectionName = line;
 
             // Get or create associated section.
             ConfigSectionMap::iterator it = _sections.find(line);
@@ -397,7 +540,7 @@ void ts::Names::loadFile(const UString& fileName)
                 _sections.insert(std::make_pair(line, section));
             }
         }
-        else if (!decodeDefinition(line, section)) {
+        else if (!decodeDefinition(line, sectionName, section)) {
             // Invalid line.
             _log.error(u"%s: invalid line %d: %s", {fileName, lineNumber, line});
             if (++_configErrors >= 20) {
@@ -415,7 +558,7 @@ void ts::Names::loadFile(const UString& fileName)
 // Decode a line as "first[-last] = name". Return true on success.
 //----------------------------------------------------------------------------
 
-bool ts::Names::decodeDefinition(const UString& line, ConfigSection* section)
+bool ts::Names::decodeDefinition(const UString& line, const UString& sectionName, ConfigSection* section)
 {
     // Check the presence of the '=' and in a valid section.
     const size_t equal = line.find(UChar('='));
@@ -449,9 +592,9 @@ bool ts::Names::decodeDefinition(const UString& line, ConfigSection* section)
         valid = range.substr(0, dash).toInteger(first) && range.substr(dash + 1).toInteger(last) && last >= first;
     }
 
-    // Add the definition.
+    // Add the definition. When a binary index is used, this is an extension file and it shall not overlap the index.
     if (valid) {
-        if (section->freeRange(first, last)) {
+        if (section->freeRange(first, last) && (_index == nullptr || _index->freeRange(_index->findSection(sectionName), first, last))) {
             section->addEntry(first, last, value);
         }
         else {
@@ -474,6 +617,10 @@ ts::Names::~Names()
         delete it->second;
     }
     _sections.clear();
+
+    // Unmap the binary index.
+    delete _index;
+    _index = nullptr;
 }
 
 
@@ -654,15 +801,47 @@ ts::UString ts::Names::Formatted(Value value, const UString& name, names::Flags
 }
 
 
+//----------------------------------------------------------------------------
+// Get the name of a value and the size in bits of values in a section.
+//----------------------------------------------------------------------------
+
+ts::UString ts::Names::getName(const UString& sectionName, Value value, size_t& bits) const
+{
+    UString name;
+    bits = 0;
+
+    // Search the sections which were loaded from text files.
+    const ConfigSectionMap::const_iterator it = _sections.find(sectionName);
+    if (it != _sections.end()) {
+        bits = it->second->bits;
+        name = it->second->getName(value);
+    }
+
+    // Then search the binary index. An extension section without "Bits" line
+    // uses the size of the base section, even when the name is in the extension.
+    if ((name.empty() || bits == 0) && _index != nullptr) {
+        const NamesIndex::Section* section = _index->findSection(sectionName);
+        if (section != nullptr) {
+            if (bits == 0) {
+                bits = section->bits;
+            }
+            if (name.empty()) {
+                name = _index->getName(section, value);
+            }
+        }
+    }
+    return name;
+}
+
+
 //----------------------------------------------------------------------------
 // Check if a name exists in a specified section.
 //----------------------------------------------------------------------------
 
 bool ts::Names::nameExists(const UString& sectionName, Value value) const
 {
-    // Get the section, normalize the section name.
-    ConfigSectionMap::const_iterator it = _sections.find(sectionName.toTrimmed().toLower());
-    return it != _sections.end() && !it->second->getName(value).empty();
+    size_t bits = 0;
+    return !getName(sectionName.toTrimmed().toLower(), value, bits).empty();
 }
 
 
@@ -672,17 +851,10 @@ bool ts::Names::nameExists(const UString& sectionName, Value value) const
 
 ts::UString ts::Names::nameFromSection(const UString& sectionName, Value value, names::Flags flags, size_t bits, Value alternateValue) const
 {
-    // Get the section, normalize the section name.
-    ConfigSectionMap::const_iterator it = _sections.find(sectionName.toTrimmed().toLower());
-    const ConfigSection* section = it == _sections.end() ? nullptr : it->second;
-
-    if (section == nullptr) {
-        // Non-existent section, no name.
-        return Formatted(value, UString(), flags, bits, alternateValue);
-    }
-    else {
-        return Formatted(value, section->getName(value), flags, bits != 0 ? bits : section->bits, alternateValue);
-    }
+    // A non-existent section has no name and no specified size.
+    size_t sectionBits = 0;
+    const UString name(getName(sectionName.toTrimmed().toLower(), value, sectionBits));
+    return Formatted(value, name, flags, bits != 0 ? bits : sectionBits, alternateValue);
 }
 
 
@@ -692,23 +864,15 @@ ts::UString ts::Names::nameFromSection(const UString& sectionName, Value value,
 
 ts::UString ts::Names::nameFromSectionWithFallback(const UString& sectionName, Value value1, Value value2, names::Flags flags, size_t bits, Value alternateValue) const
 {
-    // Get the section, normalize the section name.
-    ConfigSectionMap::const_iterator it = _sections.find(sectionName.toTrimmed().toLower());
-    const ConfigSection* section = it == _sections.end() ? nullptr : it->second;
-
-    if (section == nullptr) {
-        // Non-existent section, no name.
-        return Formatted(value1, UString(), flags, bits, alternateValue);
+    const UString section(sectionName.toTrimmed().toLower());
+    size_t sectionBits = 0;
+    const UString name(getName(section, value1, sectionBits));
+    if (!name.empty()) {
+        // value1 has a name
+        return Formatted(value1, name, flags, bits != 0 ? bits : sectionBits, alternateValue);
     }
     else {
-        const UString name(section->getName(value1));
-        if (!name.empty()) {
-            // value1 has a name
-            return Formatted(value1, name, flags, bits != 0 ? bits : section->bits, alternateValue);
-        }
-        else {
-            // value1 has no name, use value2.
-            return Formatted(value2, section->getName(value2), flags, bits != 0 ? bits : section->bits, alternateValue);
-        }
+        // value1 has no name, use value2.
+        return Formatted(value2, getName(section, value2, sectionBits), flags, bits != 0 ? bits : sectionBits, alternateValue);
     }
 }
@@ -40,7 +40,16 @@
 #include "tsReport.h"
 #include "tsSingletonManager.h"
 
+//!
+//! Suffix of the binary index file of a names file.
+//! The index of @c tsduck.names is @c tsduck.names.bin.
+//!
+#define TS_NAMES_INDEX_SUFFIX u".bin"
+
 namespace ts {
+
+    class NamesIndex;
+
     //!
     //! Namespace for functions returning MPEG/DVB names.
     //!
@@ -350,6 +359,12 @@ namespace ts {
     //! A repository of names for MPEG/DVB entities.
     //! All names are loaded from configuration files @em tsduck*.names.
     //!
+    //! The text files are the reference. When a precompiled binary index of the
+    //! main file is found (same name with suffix TS_NAMES_INDEX_SUFFIX, see CompileIndex()),
+    //! it is mapped in memory instead of parsing the text file. The index is used only
+    //! when it is not older than the text file and was compiled from a file of the same
+    //! size. The names files from extensions are always loaded from their text files.
+    //!
     class TSDUCKDLL Names
     {
         TS_NOBUILD_NOCOPY(Names);
@@ -389,6 +404,24 @@ namespace ts {
             return _configErrors;
         }
 
+        //!
+        //! Get the complete path of the binary index file which is used.
+        //! @return The complete path of the binary index file. Empty if the names were loaded from the text file.
+        //!
+        UString indexFile() const
+        {
+            return _indexFile;
+        }
+
+        //!
+        //! Compile a names file into a binary index.
+        //! @param [in] textFile Name of the text names file.
+        //! @param [in] indexFile Name of the binary index file to create.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        static bool CompileIndex(const UString& textFile, const UString& indexFile, Report& report);
+
         //!
         //! Check if a name exists in a specified section.
         //! @param [in] sectionName Name of section to search. Not case-sensitive.
@@ -470,8 +503,16 @@ namespace ts {
         // Map of configuration sections, indexed by name.
         typedef std::map<UString, ConfigSection*> ConfigSectionMap;
 
+        // Constructor used to compile a names file into a binary index.
+        Names(const UString& fileName, Report& report);
+
         // Decode a line as "first[-last] = name". Return true on success, false on error.
-        bool decodeDefinition(const UString& line, ConfigSection* section);
+        // The section name is used to check overlaps with the binary index, if any.
+        bool decodeDefinition(const UString& line, const UString& sectionName, ConfigSection* section);
+
+        // Get the name of a value and the size in bits of values in a normalized section name.
+        // Both the text sections and the binary index are searched. Return an empty name if not found.
+        UString getName(const UString& sectionName, Value value, size_t& bits) const;
 
         // Compute a number of hexa digits.
         static int HexaDigits(size_t bits);
@@ -482,11 +523,19 @@ namespace ts {
         // Load a configuration file and merge its content into this instance.
         void loadFile(const UString& fileName);
 
+        // Try to map the binary index of the configuration file. Return true on success.
+        bool loadIndex(const UString& fileName);
+
+        // Save the loaded sections in a binary index file.
+        bool saveIndex(const UString& fileName) const;
+
         // Names private fields.
         Report&          _log;           // Error logger.
         const UString    _configFile;    // Configuration file path.
         size_t           _configErrors;  // Number of errors in configuration file.
         ConfigSectionMap _sections;      // Configuration sections.
+        UString          _indexFile;     // Binary index file path, empty if not used.
+        NamesIndex*      _index;         // Mapped binary index, null if not used.
     };
 
     //!
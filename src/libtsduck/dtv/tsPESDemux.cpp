@@ -38,20 +38,6 @@
 TSDUCK_SOURCE;
 
 
-//----------------------------------------------------------------------------
-// Delimiters
-//----------------------------------------------------------------------------
-
-namespace {
-
-    // Start code prefix for ISO 11172-2 (MPEG-1 video) and ISO 13818-2 (MPEG-2 video)
-    const uint8_t StartCodePrefix[] = {0x00, 0x00, 0x01};
-
-    // End of AVC NALunit delimiter
-    const uint8_t Zero3[] = {0x00, 0x00, 0x00};
-}
-
-
 //----------------------------------------------------------------------------
 // Constructor
 //----------------------------------------------------------------------------
@@ -61,7 +47,8 @@ ts::PESDemux::PESDemux(DuckContext& duck, PESHandlerInterface* pes_handler, cons
     _pes_handler(pes_handler),
     _pids(),
     _stream_types(),
-    _section_demux(_duck, this)
+    _section_demux(_duck, this),
+    _start_codes()
 {
     // Analyze the PAT, to get the PMT's, to get the stream types.
     _section_demux.addPID(PID_PAT);
@@ -398,14 +385,23 @@ void ts::PESDemux::processPESPacket(PID pid, PIDContext& pc)
         const uint8_t* const pdata = pp.payload();
         const size_t psize = pp.payloadSize();
 
+        // Start codes are located in one pass over the payload. A handler may feed packets in
+        // the same demux, so the vector of offsets is detached from the object during the analysis.
+        std::vector<size_t> starts;
+        starts.swap(_start_codes);
+
         // Process MPEG-1 (ISO 11172-2) and MPEG-2 (ISO 13818-2) video start codes
         if (pp.isMPEG2Video()) {
             // Locate all start codes and invoke handler.
             // The beginning of the payload is already a start code prefix.
+            LocateStartCodes(starts, pdata, psize);
+            size_t index = 0;
             for (size_t offset = 0; offset < psize; ) {
                 // Look for next start code
-                const void* pnext = LocatePattern(pdata + offset + 1, psize - offset - 1, StartCodePrefix, sizeof(StartCodePrefix));
-                size_t next = pnext == nullptr ? psize : reinterpret_cast<const uint8_t*>(pnext) - pdata;
+                while (index < starts.size() && starts[index] <= offset) {
+                    index++;
+                }
+                const size_t next = index < starts.size() ? starts[index] : psize;
                 // Invoke handler
                 if (_pes_handler != nullptr) {
                     _pes_handler->handleVideoStartCode(*this, pp, pdata[offset + 3], offset, next - offset);
@@ -422,35 +418,24 @@ void ts::PESDemux::processPESPacket(PID pid, PIDContext& pc)
 
         // Process AVC (ISO 14496-10, ITU H.264) access units (aka "NALunits")
         else if (pp.isAVC()) {
+            // Locate all 00 00 01 and 00 00 00 sequences.
+            LocateStartCodes(starts, pdata, psize, true);
+            size_t index = 0;
             for (size_t offset = 0; offset < psize; ) {
                 // Locate next access unit: starts with 00 00 01 (this start code is not part of the NALunit)
-                const uint8_t* p1 = reinterpret_cast<const uint8_t*>(
-                            LocatePattern(pdata + offset, psize - offset, StartCodePrefix, sizeof(StartCodePrefix)));
-                if (p1 == nullptr) {
+                while (index < starts.size() && (starts[index] < offset || pdata[starts[index] + 2] != 0x01)) {
+                    index++;
+                }
+                if (index >= starts.size()) {
                     break;
                 }
-                offset = p1 - pdata + sizeof(StartCodePrefix);
+                offset = starts[index] + 3;
 
                 // Locate end of access unit: ends with 00 00 00, 00 00 01 or end of data.
-                const uint8_t* p2 = reinterpret_cast<const uint8_t*>(
-                            LocatePattern(pdata + offset, psize - offset, StartCodePrefix, sizeof(StartCodePrefix)));
-                const uint8_t* p3 = reinterpret_cast<const uint8_t*>(
-                            LocatePattern(pdata + offset, psize - offset, Zero3, sizeof(Zero3)));
-                size_t nalunit_size = 0;
-                if (p2 == nullptr && p3 == nullptr) {
-                    // No 00 00 01, no 00 00 00, the NALunit extends up to the end of data.
-                    nalunit_size = psize - offset;
-                }
-                else if (p2 == nullptr || (p3 != nullptr && p3 < p2)) {
-                    // NALunit ends at 00 00 00.
-                    assert(p3 != nullptr);
-                    nalunit_size = p3 - pdata - offset;
-                }
-                else {
-                    // NALunit ends at 00 00 01.
-                    assert(p2 != nullptr);
-                    nalunit_size = p2 - pdata - offset;
+                while (index < starts.size() && starts[index] < offset) {
+                    index++;
                 }
+                const size_t nalunit_size = (index < starts.size() ? starts[index] : psize) - offset;
 
                 // Compute NALunit type.
                 const uint8_t nalunit_type = nalunit_size == 0 ? 0 : (pdata[offset] & 0x1F);
@@ -524,6 +509,9 @@ void ts::PESDemux::processPESPacket(PID pid, PIDContext& pc)
                 _pes_handler->handleNewAudioAttributes(*this, pp, pc.audio);
             }
         }
+
+        // Keep the allocated vector for the next PES packet.
+        _start_codes.swap(starts);
     }
     catch (...) {
         afterCallingHandler(false);
@@ -41,6 +41,7 @@
 #include "tsAVCAttributes.h"
 #include "tsAC3Attributes.h"
 #include "tsSectionDemux.h"
+#include "tsPIDIndexedMap.h"
 
 namespace ts {
     //!
@@ -161,7 +162,7 @@ namespace ts {
 
         // Map of PID contexts, indexed by PID.
         // One context is created per demuxed PES PID.
-        typedef std::map<PID,PIDContext> PIDContextMap;
+        typedef PIDIndexedMap<PIDContext> PIDContextMap;
 
         // Map of stream types (from PMT), indexed by PID.
         // All known PID's are referenced here, not only demuxed PES PID's.
@@ -181,5 +182,6 @@ namespace ts {
         PIDContextMap        _pids;
         StreamTypeMap        _stream_types;
         SectionDemux         _section_demux;
+        std::vector<size_t>  _start_codes;  // Offsets of start codes in current PES packet, reused to avoid reallocation.
     };
 }
@@ -0,0 +1,219 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Map of contexts, indexed by PID, with constant-time access.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsMPEG.h"
+
+namespace ts {
+    //!
+    //! Map of contexts, indexed by PID, with constant-time access.
+    //! @ingroup mpeg
+    //!
+    //! This class is a replacement for @c std::map<PID,T> in demuxes and analyzers which
+    //! look up a PID context for each TS packet. The interface is a subset of the one of
+    //! @c std::map and iterators return elements in increasing order of PID values,
+    //! as @c std::map does.
+    //!
+    //! Implementation: a dense array of 8192 indices, one per PID, points into a pool
+    //! of elements. Erased elements are recycled in the pool for subsequent insertions.
+    //! The addresses of elements remain stable as long as they are not erased. A sorted
+    //! vector of active PID values is used for iterations.
+    //!
+    //! Iterators remain valid when other elements are inserted or erased. After an insertion,
+    //! an iterator always moves to the next PID in increasing order, including the new one
+    //! if it is after the current position.
+    //!
+    //! @tparam T The type of the context per PID. It must be default-constructible and
+    //! assignable. An erased element is reset to a default-constructed value.
+    //!
+    template <typename T>
+    class PIDIndexedMap
+    {
+    public:
+        //!
+        //! Type of the key in the map.
+        //!
+        typedef PID key_type;
+
+        //!
+        //! Type of the mapped value in the map.
+        //!
+        typedef T mapped_type;
+
+        //!
+        //! Type of the elements in the map.
+        //! Unlike @c std::map, the key is not const but it shall not be modified by the application.
+        //!
+        typedef std::pair<PID, T> value_type;
+
+    private:
+        // Template for const and non-const iterators.
+        template <bool CONST>
+        class Iterator
+        {
+        private:
+            typedef typename std::conditional<CONST, const PIDIndexedMap, PIDIndexedMap>::type MapType;
+            MapType* _map;
+            PID      _pid;  // PID_MAX at end
+            friend class PIDIndexedMap;
+            Iterator(MapType* map, PID pid) : _map(map), _pid(pid) {}
+        public:
+            //! @cond nodoxygen
+            typedef std::forward_iterator_tag iterator_category;
+            typedef typename PIDIndexedMap::value_type value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef typename std::conditional<CONST, const value_type*, value_type*>::type pointer;
+            typedef typename std::conditional<CONST, const value_type&, value_type&>::type reference;
+
+            Iterator() : _map(nullptr), _pid(PID_MAX) {}
+            template <bool C = CONST, typename std::enable_if<C, int>::type = 0>
+            Iterator(const Iterator<false>& other) : _map(other._map), _pid(other._pid) {}
+
+            reference operator*() const { return _map->_pool[_map->_index[_pid]]; }
+            pointer operator->() const { return &_map->_pool[_map->_index[_pid]]; }
+            Iterator& operator++() { _pid = _map->nextPID(_pid); return *this; }
+            Iterator operator++(int) { Iterator it(*this); _pid = _map->nextPID(_pid); return it; }
+            bool operator==(const Iterator& other) const { return _pid == other._pid; }
+            bool operator!=(const Iterator& other) const { return _pid != other._pid; }
+            template <bool C> friend class Iterator;
+            //! @endcond
+        };
+
+    public:
+        //!
+        //! Iterator over the map.
+        //!
+        typedef Iterator<false> iterator;
+
+        //!
+        //! Constant iterator over the map.
+        //!
+        typedef Iterator<true> const_iterator;
+
+        //!
+        //! Constructor, the map is initially empty.
+        //!
+        PIDIndexedMap();
+
+        //!
+        //! Get the number of elements in the map.
+        //! @return The number of elements in the map.
+        //!
+        size_t size() const { return _pids.size(); }
+
+        //!
+        //! Check if the map is empty.
+        //! @return True if the map is empty.
+        //!
+        bool empty() const { return _pids.empty(); }
+
+        //!
+        //! Count the number of elements with a given PID.
+        //! @param [in] pid The PID to search.
+        //! @return 1 if the element exists, 0 otherwise.
+        //!
+        size_t count(PID pid) const { return pid < PID_MAX && _index[pid] != NO_INDEX ? 1 : 0; }
+
+        //!
+        //! Access an element, create it if it does not exist.
+        //! @param [in] pid The PID to search. Must be lower than PID_MAX.
+        //! @return A reference to the element for @a pid.
+        //!
+        T& operator[](PID pid);
+
+        //!
+        //! Find an element.
+        //! @param [in] pid The PID to search.
+        //! @return An iterator to the element or end() if not found.
+        //!
+        iterator find(PID pid) { return iterator(this, count(pid) > 0 ? pid : PID_MAX); }
+
+        //!
+        //! Find an element.
+        //! @param [in] pid The PID to search.
+        //! @return A constant iterator to the element or end() if not found.
+        //!
+        const_iterator find(PID pid) const { return const_iterator(this, count(pid) > 0 ? pid : PID_MAX); }
+
+        //!
+        //! Erase an element.
+        //! @param [in] pid The PID to erase.
+        //! @return The number of erased elements (0 or 1).
+        //!
+        size_t erase(PID pid);
+
+        //!
+        //! Erase all elements.
+        //!
+        void clear();
+
+        //!
+        //! Get an iterator to the first element, in increasing order of PID.
+        //! @return An iterator to the first element.
+        //!
+        iterator begin() { return iterator(this, _pids.empty() ? PID_MAX : _pids.front()); }
+
+        //!
+        //! Get a constant iterator to the first element, in increasing order of PID.
+        //! @return A constant iterator to the first element.
+        //!
+        const_iterator begin() const { return const_iterator(this, _pids.empty() ? PID_MAX : _pids.front()); }
+
+        //!
+        //! Get an iterator after the last element.
+        //! @return An iterator after the last element.
+        //!
+        iterator end() { return iterator(this, PID_MAX); }
+
+        //!
+        //! Get a constant iterator after the last element.
+        //! @return A constant iterator after the last element.
+        //!
+        const_iterator end() const { return const_iterator(this, PID_MAX); }
+
+    private:
+        // Index value for PID's without element.
+        static constexpr uint16_t NO_INDEX = 0xFFFF;
+
+        std::array<uint16_t, PID_MAX> _index;  // Index in _pool of each PID, NO_INDEX if none.
+        std::deque<value_type>        _pool;   // Pool of elements, addresses are stable.
+        std::vector<uint16_t>         _free;   // Indexes of erased elements in _pool.
+        std::vector<PID>              _pids;   // Sorted list of active PID's.
+
+        // Get the next active PID after a given one, PID_MAX if there is none.
+        PID nextPID(PID pid) const;
+    };
+}
+
+#include "tsPIDIndexedMapTemplate.h"
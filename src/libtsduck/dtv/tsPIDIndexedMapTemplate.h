@@ -0,0 +1,127 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+template <typename T> constexpr uint16_t ts::PIDIndexedMap<T>::NO_INDEX;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructor.
+//----------------------------------------------------------------------------
+
+template <typename T>
+ts::PIDIndexedMap<T>::PIDIndexedMap() :
+    _index(),
+    _pool(),
+    _free(),
+    _pids()
+{
+    _index.fill(NO_INDEX);
+}
+
+
+//----------------------------------------------------------------------------
+// Access an element, create it if it does not exist.
+//----------------------------------------------------------------------------
+
+template <typename T>
+T& ts::PIDIndexedMap<T>::operator[](PID pid)
+{
+    assert(pid < PID_MAX);
+    uint16_t index = _index[pid];
+
+    if (index == NO_INDEX) {
+        // Allocate a new element, reuse a previously erased one if possible.
+        if (_free.empty()) {
+            index = uint16_t(_pool.size());
+            _pool.emplace_back(pid, T());
+        }
+        else {
+            index = _free.back();
+            _free.pop_back();
+            _pool[index].first = pid;
+        }
+        _index[pid] = index;
+        _pids.insert(std::upper_bound(_pids.begin(), _pids.end(), pid), pid);
+    }
+    return _pool[index].second;
+}
+
+
+//----------------------------------------------------------------------------
+// Erase an element.
+//----------------------------------------------------------------------------
+
+template <typename T>
+size_t ts::PIDIndexedMap<T>::erase(PID pid)
+{
+    if (count(pid) == 0) {
+        return 0;
+    }
+
+    // Reset the element content and recycle it.
+    const uint16_t index = _index[pid];
+    _pool[index].first = PID_NULL;
+    _pool[index].second = T();
+    _free.push_back(index);
+    _index[pid] = NO_INDEX;
+
+    const auto it = std::lower_bound(_pids.begin(), _pids.end(), pid);
+    assert(it != _pids.end() && *it == pid);
+    _pids.erase(it);
+    return 1;
+}
+
+
+//----------------------------------------------------------------------------
+// Erase all elements.
+//----------------------------------------------------------------------------
+
+template <typename T>
+void ts::PIDIndexedMap<T>::clear()
+{
+    _index.fill(NO_INDEX);
+    _pool.clear();
+    _free.clear();
+    _pids.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Get the next active PID after a given one.
+//----------------------------------------------------------------------------
+
+template <typename T>
+ts::PID ts::PIDIndexedMap<T>::nextPID(PID pid) const
+{
+    const auto it = std::upper_bound(_pids.begin(), _pids.end(), pid);
+    return it == _pids.end() ? PID(PID_MAX) : *it;
+}
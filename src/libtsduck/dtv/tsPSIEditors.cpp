@@ -0,0 +1,348 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsPSIEditors.h"
+#include "tsMJD.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Base class of editors.
+//----------------------------------------------------------------------------
+
+ts::PSIEditor::PSIEditor(Section& section, bool valid) :
+    _section(section),
+    _valid(valid),
+    _modified(false)
+{
+}
+
+ts::PSIEditor::~PSIEditor()
+{
+    commit();
+}
+
+void ts::PSIEditor::commit()
+{
+    if (_modified) {
+        _section.recomputeCRC();
+        _modified = false;
+    }
+}
+
+void ts::PSIEditor::setTableIdExtension(uint16_t tid_ext)
+{
+    if (_valid) {
+        _section.setTableIdExtension(tid_ext, false);
+        _modified = true;
+    }
+}
+
+void ts::PSIEditor::setBits16(size_t offset, uint16_t mask, uint16_t value)
+{
+    if (_valid && offset + 2 <= _section.payloadSize()) {
+        _section.setUInt16(offset, uint16_t((GetUInt16(_section.payload() + offset) & ~mask) | (value & mask)), false);
+        _modified = true;
+    }
+}
+
+void ts::PSIEditor::setBits8(size_t offset, uint8_t mask, uint8_t value)
+{
+    if (_valid && offset < _section.payloadSize()) {
+        _section.setUInt8(offset, uint8_t((_section.payload()[offset] & ~mask) | (value & mask)), false);
+        _modified = true;
+    }
+}
+
+bool ts::PSIEditor::erase(size_t offset, size_t size, size_t length_offset, size_t outer_length_offset)
+{
+    if (!_valid || offset + size > _section.payloadSize()) {
+        return false;
+    }
+    // Update the loop lengths first, their offsets may move after erasing.
+    const uint8_t* const payload = _section.payload();
+    if (length_offset != NPOS) {
+        setBits16(length_offset, 0x0FFF, uint16_t((GetUInt16(payload + length_offset) & 0x0FFF) - size));
+    }
+    if (outer_length_offset != NPOS) {
+        setBits16(outer_length_offset, 0x0FFF, uint16_t((GetUInt16(payload + outer_length_offset) & 0x0FFF) - size));
+    }
+    _modified = true;
+    return _section.erase(offset, size, false);
+}
+
+size_t ts::PSIEditor::removeLoopDescriptors(size_t length_offset, DID tag, size_t outer_length_offset)
+{
+    size_t count = 0;
+    if (_valid && length_offset + 2 <= _section.payloadSize()) {
+        size_t offset = length_offset + 2;
+        size_t end = offset + std::min<size_t>(GetUInt16(_section.payload() + length_offset) & 0x0FFF, _section.payloadSize() - offset);
+        while (offset + 2 <= end) {
+            const uint8_t* const desc = _section.payload() + offset;
+            const size_t size = std::min<size_t>(2 + desc[1], end - offset);
+            if (desc[0] == tag && erase(offset, size, length_offset, outer_length_offset)) {
+                end -= size;
+                count++;
+            }
+            else {
+                offset += size;
+            }
+        }
+    }
+    return count;
+}
+
+
+size_t ts::PSIEditor::removeEntriesDescriptors(size_t offset, size_t size, size_t header_size, size_t length_offset, DID tag, size_t outer_length_offset)
+{
+    size_t count = 0;
+    size_t end = offset + size;
+    while (_valid && offset + header_size <= end) {
+        // The entries which follow are moved when descriptors are removed.
+        const size_t previous_size = _section.payloadSize();
+        count += removeLoopDescriptors(offset + length_offset, tag, outer_length_offset);
+        end -= previous_size - _section.payloadSize();
+        offset += header_size + (GetUInt16(_section.payload() + offset + length_offset) & 0x0FFF);
+    }
+    return count;
+}
+
+
+//----------------------------------------------------------------------------
+// PAT editor.
+//----------------------------------------------------------------------------
+
+bool ts::PATEditor::removeService(uint16_t service_id)
+{
+    for (const auto& srv : view().services()) {
+        if (srv.serviceId() == service_id) {
+            return erase(offsetOf(srv.data()), srv.size());
+        }
+    }
+    return false;
+}
+
+bool ts::PATEditor::setPMTPID(uint16_t service_id, PID pid)
+{
+    for (const auto& srv : view().services()) {
+        if (srv.serviceId() == service_id) {
+            setBits16(offsetOf(srv.data()) + 2, 0x1FFF, pid);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ts::PATEditor::setServiceId(uint16_t old_id, uint16_t new_id)
+{
+    for (const auto& srv : view().services()) {
+        if (srv.serviceId() == old_id) {
+            setBits16(offsetOf(srv.data()), 0xFFFF, new_id);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// PMT editor.
+//----------------------------------------------------------------------------
+
+void ts::PMTEditor::setServiceId(uint16_t service_id)
+{
+    setTableIdExtension(service_id);
+}
+
+void ts::PMTEditor::setPCRPID(PID pid)
+{
+    setBits16(0, 0x1FFF, pid);
+}
+
+bool ts::PMTEditor::removeStream(PID pid)
+{
+    for (const auto& stream : view().streams()) {
+        if (stream.pid() == pid) {
+            return erase(offsetOf(stream.data()), stream.size());
+        }
+    }
+    return false;
+}
+
+bool ts::PMTEditor::setStreamPID(PID old_pid, PID new_pid)
+{
+    for (const auto& stream : view().streams()) {
+        if (stream.pid() == old_pid) {
+            setBits16(offsetOf(stream.data()) + 1, 0x1FFF, new_pid);
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t ts::PMTEditor::removeDescriptors(DID tag)
+{
+    // Program-level descriptors first, then in the stream loop which follows.
+    size_t count = removeLoopDescriptors(2, tag);
+    const PSIViewRange<PMTView::Stream> streams(view().streams());
+    if (isValid()) {
+        count += removeEntriesDescriptors(offsetOf(streams.data()), streams.size(), 5, 3, tag);
+    }
+    return count;
+}
+
+
+//----------------------------------------------------------------------------
+// SDT editor.
+//----------------------------------------------------------------------------
+
+void ts::SDTEditor::setOriginalNetworkId(uint16_t id)
+{
+    setBits16(0, 0xFFFF, id);
+}
+
+bool ts::SDTEditor::removeService(uint16_t service_id)
+{
+    for (const auto& srv : view().services()) {
+        if (srv.serviceId() == service_id) {
+            return erase(offsetOf(srv.data()), srv.size());
+        }
+    }
+    return false;
+}
+
+bool ts::SDTEditor::setServiceId(uint16_t old_id, uint16_t new_id)
+{
+    for (const auto& srv : view().services()) {
+        if (srv.serviceId() == old_id) {
+            setBits16(offsetOf(srv.data()), 0xFFFF, new_id);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ts::SDTEditor::setRunningStatus(uint16_t service_id, uint8_t running_status)
+{
+    for (const auto& srv : view().services()) {
+        if (srv.serviceId() == service_id) {
+            setBits8(offsetOf(srv.data()) + 3, 0xE0, uint8_t(running_status << 5));
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ts::SDTEditor::setCAControlled(uint16_t service_id, bool ca_controlled)
+{
+    for (const auto& srv : view().services()) {
+        if (srv.serviceId() == service_id) {
+            setBits8(offsetOf(srv.data()) + 3, 0x10, ca_controlled ? 0x10 : 0x00);
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t ts::SDTEditor::removeDescriptors(DID tag)
+{
+    const PSIViewRange<SDTView::Service> services(view().services());
+    return isValid() ? removeEntriesDescriptors(offsetOf(services.data()), services.size(), 5, 3, tag) : 0;
+}
+
+
+//----------------------------------------------------------------------------
+// NIT editor.
+//----------------------------------------------------------------------------
+
+size_t ts::NITEditor::tsLoopOffset() const
+{
+    return 2 + (GetUInt16(_section.payload()) & 0x0FFF);
+}
+
+bool ts::NITEditor::removeTransportStream(uint16_t ts_id, uint16_t onid)
+{
+    for (const auto& stream : view().transportStreams()) {
+        if (stream.transportStreamId() == ts_id && stream.originalNetworkId() == onid) {
+            return erase(offsetOf(stream.data()), stream.size(), tsLoopOffset());
+        }
+    }
+    return false;
+}
+
+size_t ts::NITEditor::removeDescriptors(DID tag)
+{
+    // Network-level descriptors first, then in the transport stream loop which follows.
+    size_t count = removeLoopDescriptors(0, tag);
+    const PSIViewRange<NITView::TransportStream> streams(view().transportStreams());
+    if (isValid() && !streams.empty()) {
+        count += removeEntriesDescriptors(offsetOf(streams.data()), streams.size(), 6, 4, tag, tsLoopOffset());
+    }
+    return count;
+}
+
+
+//----------------------------------------------------------------------------
+// EIT editor.
+//----------------------------------------------------------------------------
+
+void ts::EITEditor::setServiceId(uint16_t service_id)
+{
+    setTableIdExtension(service_id);
+}
+
+void ts::EITEditor::setTransportStreamId(uint16_t ts_id)
+{
+    setBits16(0, 0xFFFF, ts_id);
+}
+
+void ts::EITEditor::setOriginalNetworkId(uint16_t onid)
+{
+    setBits16(2, 0xFFFF, onid);
+}
+
+bool ts::EITEditor::addStartTimeOffset(MilliSecond offset, bool date_only)
+{
+    bool success = true;
+    if (offset != 0) {
+        for (const auto& event : view().events()) {
+            Time time;
+            uint8_t mjd[MJD_SIZE];
+            if (event.getStartTime(time) && EncodeMJD(time + offset, mjd, date_only ? MJD_MIN_SIZE : MJD_SIZE)) {
+                // The size of the section is unchanged, the view remains valid.
+                _section.setBytes(offsetOf(event.data()) + 2, mjd, date_only ? MJD_MIN_SIZE : MJD_SIZE, false);
+                setModified();
+            }
+            else {
+                success = false;
+            }
+        }
+    }
+    return success;
+}
@@ -0,0 +1,411 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  In-place editors of PSI/SI sections.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPSIViews.h"
+
+namespace ts {
+
+    //!
+    //! Base class of in-place editors of PSI/SI sections.
+    //! @ingroup mpeg
+    //!
+    //! An editor modifies the binary content of a section in place, without deserialization
+    //! and without memory allocation. Only modifications which do not enlarge the section are
+    //! possible. To add elements, use the corresponding table class (PAT, PMT, etc.)
+    //!
+    //! The CRC32 of the section is recomputed only once, when commit() is called or when
+    //! the editor is destroyed. If the section is part of a BinaryTable, use the methods of
+    //! BinaryTable to modify the table id extension of all sections, not the editors.
+    //!
+    class TSDUCKDLL PSIEditor
+    {
+        TS_NOBUILD_NOCOPY(PSIEditor);
+    public:
+        //!
+        //! Destructor.
+        //! Recompute the CRC32 of the section if it was modified and not yet committed.
+        //!
+        virtual ~PSIEditor();
+
+        //!
+        //! Check if the edited section is valid.
+        //! @return True if the section has the expected table id and structure.
+        //! All modifications are ignored on invalid sections.
+        //!
+        bool isValid() const { return _valid; }
+
+        //!
+        //! Check if the section was modified since the last commit.
+        //! @return True if the section was modified.
+        //!
+        bool isModified() const { return _modified; }
+
+        //!
+        //! Commit the modifications, recompute the CRC32 of the section.
+        //!
+        void commit();
+
+    protected:
+        Section& _section;  //!< The edited section.
+
+        //!
+        //! Constructor for subclasses.
+        //! @param [in,out] section The section to edit.
+        //! @param [in] valid True if the subclass has validated the section.
+        //!
+        PSIEditor(Section& section, bool valid);
+
+        //!
+        //! Get the offset of an address in the payload of the section.
+        //! @param [in] addr An address inside the payload.
+        //! @return The corresponding offset in the payload.
+        //!
+        size_t offsetOf(const uint8_t* addr) const { return size_t(addr - _section.payload()); }
+
+        //!
+        //! Modify a 16-bit field in the payload, preserving the bits outside a mask.
+        //! @param [in] offset Byte offset in the payload.
+        //! @param [in] mask Mask of the bits to modify.
+        //! @param [in] value New value of the field.
+        //!
+        void setBits16(size_t offset, uint16_t mask, uint16_t value);
+
+        //!
+        //! Modify an 8-bit field in the payload, preserving the bits outside a mask.
+        //! @param [in] offset Byte offset in the payload.
+        //! @param [in] mask Mask of the bits to modify.
+        //! @param [in] value New value of the field.
+        //!
+        void setBits8(size_t offset, uint8_t mask, uint8_t value);
+
+        //!
+        //! Remove a range of bytes in the payload and update the lengths of the enclosing loops.
+        //! @param [in] offset Byte offset in the payload.
+        //! @param [in] size Number of bytes to remove.
+        //! @param [in] length_offset Offset in the payload of the 12-bit length of the enclosing loop, NPOS if none.
+        //! @param [in] outer_length_offset Offset in the payload of the 12-bit length of the outer loop, NPOS if none.
+        //! @return True on success, false on error.
+        //!
+        bool erase(size_t offset, size_t size, size_t length_offset = NPOS, size_t outer_length_offset = NPOS);
+
+        //!
+        //! Remove all descriptors with a given tag in a descriptor loop.
+        //! @param [in] length_offset Offset in the payload of the 12-bit length of the descriptor loop.
+        //! The descriptor loop immediately follows the length.
+        //! @param [in] tag Tag of the descriptors to remove.
+        //! @param [in] outer_length_offset Offset in the payload of the 12-bit length of the outer loop, NPOS if none.
+        //! @return The number of removed descriptors.
+        //!
+        size_t removeLoopDescriptors(size_t length_offset, DID tag, size_t outer_length_offset = NPOS);
+
+        //!
+        //! Remove all descriptors with a given tag in all entries of a loop.
+        //! @param [in] offset Offset in the payload of the first entry.
+        //! @param [in] size Size in bytes of the loop of entries.
+        //! @param [in] header_size Size of the fixed part of each entry. The descriptor loop follows it.
+        //! @param [in] length_offset Offset in each entry of the 12-bit length of its descriptor loop.
+        //! @param [in] tag Tag of the descriptors to remove.
+        //! @param [in] outer_length_offset Offset in the payload of the 12-bit length of the loop of entries, NPOS if none.
+        //! @return The number of removed descriptors.
+        //!
+        size_t removeEntriesDescriptors(size_t offset, size_t size, size_t header_size, size_t length_offset, DID tag, size_t outer_length_offset = NPOS);
+
+        //!
+        //! Modify the table id extension of the section.
+        //! @param [in] tid_ext The new table id extension.
+        //!
+        void setTableIdExtension(uint16_t tid_ext);
+
+        //!
+        //! Mark the section as modified, after a direct modification.
+        //!
+        void setModified() { _modified = true; }
+
+    private:
+        bool _valid;
+        bool _modified;
+    };
+
+    //!
+    //! In-place editor of a Program Association Table (PAT) section.
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL PATEditor : public PSIEditor
+    {
+        TS_NOBUILD_NOCOPY(PATEditor);
+    public:
+        //!
+        //! Constructor.
+        //! @param [in,out] section The section to edit.
+        //!
+        explicit PATEditor(Section& section) : PSIEditor(section, PATView(section).isValid()) {}
+
+        //!
+        //! Get a read-only view on the current state of the section.
+        //! @return A view on the section.
+        //!
+        PATView view() const { return PATView(_section); }
+
+        //!
+        //! Remove a service.
+        //! @param [in] service_id The service to remove. Zero means the NIT PID.
+        //! @return True if the service was found and removed.
+        //!
+        bool removeService(uint16_t service_id);
+
+        //!
+        //! Modify the PMT PID of a service.
+        //! @param [in] service_id The service to modify. Zero means the NIT PID.
+        //! @param [in] pid The new PMT PID.
+        //! @return True if the service was found.
+        //!
+        bool setPMTPID(uint16_t service_id, PID pid);
+
+        //!
+        //! Rename a service.
+        //! @param [in] old_id The service to rename.
+        //! @param [in] new_id The new service id.
+        //! @return True if the service was found.
+        //!
+        bool setServiceId(uint16_t old_id, uint16_t new_id);
+    };
+
+    //!
+    //! In-place editor of a Program Map Table (PMT) section.
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL PMTEditor : public PSIEditor
+    {
+        TS_NOBUILD_NOCOPY(PMTEditor);
+    public:
+        //!
+        //! Constructor.
+        //! @param [in,out] section The section to edit.
+        //!
+        explicit PMTEditor(Section& section) : PSIEditor(section, PMTView(section).isValid()) {}
+
+        //!
+        //! Get a read-only view on the current state of the section.
+        //! @return A view on the section.
+        //!
+        PMTView view() const { return PMTView(_section); }
+
+        //!
+        //! Modify the service id.
+        //! @param [in] service_id The new service id.
+        //!
+        void setServiceId(uint16_t service_id);
+
+        //!
+        //! Modify the PCR PID.
+        //! @param [in] pid The new PCR PID.
+        //!
+        void setPCRPID(PID pid);
+
+        //!
+        //! Remove an elementary stream.
+        //! @param [in] pid The PID of the elementary stream to remove.
+        //! @return True if the elementary stream was found and removed.
+        //!
+        bool removeStream(PID pid);
+
+        //!
+        //! Modify the PID of an elementary stream.
+        //! @param [in] old_pid The PID of the elementary stream to modify.
+        //! @param [in] new_pid The new PID of the elementary stream.
+        //! @return True if the elementary stream was found.
+        //!
+        bool setStreamPID(PID old_pid, PID new_pid);
+
+        //!
+        //! Remove all descriptors with a given tag, at program level and in all elementary streams.
+        //! @param [in] tag Tag of the descriptors to remove.
+        //! @return The number of removed descriptors.
+        //!
+        size_t removeDescriptors(DID tag);
+    };
+
+    //!
+    //! In-place editor of a Service Description Table (SDT) section.
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL SDTEditor : public PSIEditor
+    {
+        TS_NOBUILD_NOCOPY(SDTEditor);
+    public:
+        //!
+        //! Constructor.
+        //! @param [in,out] section The section to edit.
+        //!
+        explicit SDTEditor(Section& section) : PSIEditor(section, SDTView(section).isValid()) {}
+
+        //!
+        //! Get a read-only view on the current state of the section.
+        //! @return A view on the section.
+        //!
+        SDTView view() const { return SDTView(_section); }
+
+        //!
+        //! Modify the original network id.
+        //! @param [in] id The new original network id.
+        //!
+        void setOriginalNetworkId(uint16_t id);
+
+        //!
+        //! Remove a service.
+        //! @param [in] service_id The service to remove.
+        //! @return True if the service was found and removed.
+        //!
+        bool removeService(uint16_t service_id);
+
+        //!
+        //! Rename a service.
+        //! @param [in] old_id The service to rename.
+        //! @param [in] new_id The new service id.
+        //! @return True if the service was found.
+        //!
+        bool setServiceId(uint16_t old_id, uint16_t new_id);
+
+        //!
+        //! Modify the running status of a service.
+        //! @param [in] service_id The service to modify.
+        //! @param [in] running_status The new running status.
+        //! @return True if the service was found.
+        //!
+        bool setRunningStatus(uint16_t service_id, uint8_t running_status);
+
+        //!
+        //! Modify the free_CA_mode of a service.
+        //! @param [in] service_id The service to modify.
+        //! @param [in] ca_controlled The new free_CA_mode flag.
+        //! @return True if the service was found.
+        //!
+        bool setCAControlled(uint16_t service_id, bool ca_controlled);
+
+        //!
+        //! Remove all descriptors with a given tag in all services.
+        //! @param [in] tag Tag of the descriptors to remove.
+        //! @return The number of removed descriptors.
+        //!
+        size_t removeDescriptors(DID tag);
+    };
+
+    //!
+    //! In-place editor of a Network Information Table (NIT) or Bouquet Association Table (BAT) section.
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL NITEditor : public PSIEditor
+    {
+        TS_NOBUILD_NOCOPY(NITEditor);
+    public:
+        //!
+        //! Constructor.
+        //! @param [in,out] section The section to edit.
+        //!
+        explicit NITEditor(Section& section) : PSIEditor(section, NITView(section).isValid()) {}
+
+        //!
+        //! Get a read-only view on the current state of the section.
+        //! @return A view on the section.
+        //!
+        NITView view() const { return NITView(_section); }
+
+        //!
+        //! Remove a transport stream.
+        //! @param [in] ts_id The transport stream id.
+        //! @param [in] onid The original network id.
+        //! @return True if the transport stream was found and removed.
+        //!
+        bool removeTransportStream(uint16_t ts_id, uint16_t onid);
+
+        //!
+        //! Remove all descriptors with a given tag, at network level and in all transport streams.
+        //! @param [in] tag Tag of the descriptors to remove.
+        //! @return The number of removed descriptors.
+        //!
+        size_t removeDescriptors(DID tag);
+
+    private:
+        // Offset of transport_stream_loop_length in payload.
+        size_t tsLoopOffset() const;
+    };
+
+    //!
+    //! In-place editor of an Event Information Table (EIT) section.
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL EITEditor : public PSIEditor
+    {
+        TS_NOBUILD_NOCOPY(EITEditor);
+    public:
+        //!
+        //! Constructor.
+        //! @param [in,out] section The section to edit.
+        //!
+        explicit EITEditor(Section& section) : PSIEditor(section, EITView(section).isValid()) {}
+
+        //!
+        //! Get a read-only view on the current state of the section.
+        //! @return A view on the section.
+        //!
+        EITView view() const { return EITView(_section); }
+
+        //!
+        //! Modify the service id.
+        //! @param [in] service_id The new service id.
+        //!
+        void setServiceId(uint16_t service_id);
+
+        //!
+        //! Modify the transport stream id.
+        //! @param [in] ts_id The new transport stream id.
+        //!
+        void setTransportStreamId(uint16_t ts_id);
+
+        //!
+        //! Modify the original network id.
+        //! @param [in] onid The new original network id.
+        //!
+        void setOriginalNetworkId(uint16_t onid);
+
+        //!
+        //! Add an offset to the start time of all events.
+        //! @param [in] offset Offset to add, in milliseconds, can be negative.
+        //! @param [in] date_only If true, modify the date part only, not the hour.
+        //! @return True on success, false if the start time of some event is invalid.
+        //!
+        bool addStartTimeOffset(MilliSecond offset, bool date_only = false);
+    };
+}
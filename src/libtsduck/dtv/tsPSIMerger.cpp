@@ -29,6 +29,7 @@
 
 #include "tsPSIMerger.h"
 #include "tsCADescriptor.h"
+#include "tsPSIEditors.h"
 TSDUCK_SOURCE;
 
 
@@ -411,12 +412,15 @@ void ts::PSIMerger::handleSection(SectionDemux& demux, const Section& section)
             // Not an EIT-Actual from the merge stream, pass section without modification.
             _eits.push_back(sp);
         }
-        else if (sp->payloadSize() >= 2 && _main_tsid.set()) {
+        else if (_main_tsid.set()) {
             // This is an EIT-Actual from merged stream and we know the main TS id.
             // Patch the EIT with new TS id before enqueueing.
-            // The TSid is in the first two bytes of the EIT payload.
-            sp->setUInt16(0, _main_tsid.value(), true);
-            _eits.push_back(sp);
+            EITEditor editor(*sp);
+            if (editor.isValid()) {
+                editor.setTransportStreamId(_main_tsid.value());
+                editor.commit();
+                _eits.push_back(sp);
+            }
         }
     }
 }
@@ -0,0 +1,215 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsPSIViews.h"
+#include "tsMJD.h"
+#include "tsBCD.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Entries in a loop.
+//----------------------------------------------------------------------------
+
+ts::PSIViewEntry::PSIViewEntry(const uint8_t* data, const uint8_t* end, size_t header_size, size_t length_offset, uint16_t length_mask) :
+    _data(end),
+    _size(0)
+{
+    // A truncated entry is the end of the loop.
+    if (data != nullptr && data < end && header_size <= size_t(end - data)) {
+        const size_t size = length_offset == NPOS ? header_size : header_size + (GetUInt16(data + length_offset) & length_mask);
+        if (size <= size_t(end - data)) {
+            _data = data;
+            _size = size;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Descriptor loops.
+//----------------------------------------------------------------------------
+
+ts::DescriptorListView::const_iterator ts::DescriptorListView::search(DID tag, const_iterator start) const
+{
+    const const_iterator last(end());
+    while (start != last && start->tag() != tag) {
+        ++start;
+    }
+    return start;
+}
+
+bool ts::DescriptorListView::containsExtension(DID ext_tag) const
+{
+    for (const auto& desc : *this) {
+        if (desc.tag() == DID_DVB_EXTENSION && desc.extensionTag() == ext_tag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Base class of section views.
+//----------------------------------------------------------------------------
+
+ts::PSIView::PSIView(const Section& section, TID tid_min, TID tid_max, size_t min_size, TID other_tid) :
+    _payload(nullptr),
+    _size(0),
+    _tid_ext(0)
+{
+    const TID tid = section.tableId();
+    if (section.isValid() && section.isLongSection() && ((tid >= tid_min && tid <= tid_max) || tid == other_tid) && section.payloadSize() >= min_size) {
+        _payload = section.payload();
+        _size = section.payloadSize();
+        _tid_ext = section.tableIdExtension();
+    }
+}
+
+size_t ts::PSIView::loopSize(size_t offset) const
+{
+    return offset + 2 > _size ? 0 : std::min<size_t>(GetUInt16(_payload + offset) & 0x0FFF, _size - offset - 2);
+}
+
+ts::DescriptorListView ts::PSIView::descriptorLoop(size_t offset) const
+{
+    return offset + 2 > _size ? DescriptorListView() : DescriptorListView(_payload + offset + 2, loopSize(offset));
+}
+
+
+//----------------------------------------------------------------------------
+// PAT view.
+//----------------------------------------------------------------------------
+
+ts::PID ts::PATView::pmtPID(uint16_t service_id) const
+{
+    for (const auto& srv : services()) {
+        if (srv.serviceId() == service_id) {
+            return srv.pmtPID();
+        }
+    }
+    return PID_NULL;
+}
+
+
+//----------------------------------------------------------------------------
+// PMT view.
+//----------------------------------------------------------------------------
+
+ts::PSIViewRange<ts::PMTView::Stream> ts::PMTView::streams() const
+{
+    if (!isValid()) {
+        return PSIViewRange<Stream>();
+    }
+    else {
+        const size_t start = 4 + loopSize(2);
+        return PSIViewRange<Stream>(_payload + start, _size - start);
+    }
+}
+
+bool ts::PMTView::Stream::isVideo() const
+{
+    return IsVideoST(streamType()) || descriptors().contains(DID_HEVC_VIDEO);
+}
+
+bool ts::PMTView::Stream::isAudio() const
+{
+    // AC-3 or HE-AAC components may have "PES private data" stream type
+    // but are identified by specific descriptors.
+    if (IsAudioST(streamType())) {
+        return true;
+    }
+    for (const auto& desc : descriptors()) {
+        switch (desc.tag()) {
+            case DID_DTS:
+            case DID_AC3:
+            case DID_ENHANCED_AC3:
+            case DID_AAC:
+                return true;
+            case DID_DVB_EXTENSION:
+                switch (desc.extensionTag()) {
+                    case EDID_AC4:
+                    case EDID_DTS_NEURAL:
+                    case EDID_DTS_HD_AUDIO:
+                        return true;
+                    default:
+                        break;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// SDT view.
+//----------------------------------------------------------------------------
+
+uint8_t ts::SDTView::Service::serviceType() const
+{
+    const DescriptorListView descs(descriptors());
+    const auto it = descs.search(DID_SERVICE);
+    return it == descs.end() || it->payloadSize() < 1 ? 0 : it->payload()[0];
+}
+
+
+//----------------------------------------------------------------------------
+// NIT view.
+//----------------------------------------------------------------------------
+
+ts::PSIViewRange<ts::NITView::TransportStream> ts::NITView::transportStreams() const
+{
+    // Offset of the transport_stream_loop_length.
+    const size_t offset = 2 + loopSize(0);
+    if (!isValid() || offset + 2 > _size) {
+        return PSIViewRange<TransportStream>();
+    }
+    else {
+        return PSIViewRange<TransportStream>(_payload + offset + 2, loopSize(offset));
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// EIT view.
+//----------------------------------------------------------------------------
+
+bool ts::EITView::Event::getStartTime(Time& time) const
+{
+    return DecodeMJD(_data + 2, MJD_SIZE, time);
+}
+
+ts::Second ts::EITView::Event::duration() const
+{
+    return Second(DecodeBCD(_data[7])) * 3600 + Second(DecodeBCD(_data[8])) * 60 + Second(DecodeBCD(_data[9]));
+}
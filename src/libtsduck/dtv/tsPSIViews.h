@@ -0,0 +1,726 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Lightweight read-only views on the content of PSI/SI sections.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsSection.h"
+#include "tsTime.h"
+
+namespace ts {
+
+    //!
+    //! Base class of a view on one variable-size entry in a PSI/SI section.
+    //! @ingroup mpeg
+    //!
+    //! A view does not copy anything, it points directly into the binary content
+    //! of the section. The section must remain valid and unmodified while the view
+    //! is used. An entry which is truncated by the end of its loop is considered
+    //! as the end of the loop.
+    //!
+    class TSDUCKDLL PSIViewEntry
+    {
+    public:
+        //!
+        //! Get the address of the entry.
+        //! @return The address of the entry in the section.
+        //!
+        const uint8_t* data() const { return _data; }
+
+        //!
+        //! Get the size of the entry.
+        //! @return The size in bytes of the entry.
+        //!
+        size_t size() const { return _size; }
+
+        //!
+        //! Get the address of the next entry.
+        //! @return The address of the next entry, following this one.
+        //!
+        const uint8_t* next() const { return _data + _size; }
+
+    protected:
+        const uint8_t* _data;  //!< Address of the entry.
+        size_t         _size;  //!< Size of the entry.
+
+        //!
+        //! Constructor for subclasses.
+        //! @param [in] data Address of the entry.
+        //! @param [in] end Address of the end of the loop.
+        //! @param [in] header_size Size of the fixed part of the entry.
+        //! @param [in] length_offset Offset in the entry of the 16-bit field containing the length
+        //! of the variable part. If NPOS, the entry has a fixed size.
+        //! @param [in] length_mask Mask of the length in the 16-bit field.
+        //!
+        PSIViewEntry(const uint8_t* data, const uint8_t* end, size_t header_size, size_t length_offset = NPOS, uint16_t length_mask = 0x0FFF);
+    };
+
+    //!
+    //! Forward iterator over variable-size entries in a PSI/SI section.
+    //! @ingroup mpeg
+    //! @tparam ENTRY A subclass of PSIViewEntry with a constructor ENTRY(const uint8_t* data, const uint8_t* end).
+    //!
+    template <class ENTRY>
+    class PSIViewIterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;  //!< Iterator category.
+        typedef ENTRY value_type;                             //!< Type of entry.
+        typedef std::ptrdiff_t difference_type;               //!< Difference between iterators.
+        typedef const ENTRY* pointer;                         //!< Pointer to entry.
+        typedef const ENTRY& reference;                       //!< Reference to entry.
+
+        //!
+        //! Constructor.
+        //! @param [in] data Address of the current entry.
+        //! @param [in] end Address of the end of the loop.
+        //!
+        PSIViewIterator(const uint8_t* data, const uint8_t* end) : _entry(data, end), _end(end) {}
+
+        //!
+        //! Access the current entry.
+        //! @return A constant reference to the current entry.
+        //!
+        const ENTRY& operator*() const { return _entry; }
+
+        //!
+        //! Access the current entry.
+        //! @return A constant pointer to the current entry.
+        //!
+        const ENTRY* operator->() const { return &_entry; }
+
+        //!
+        //! Move to the next entry (prefix increment).
+        //! @return A reference to this iterator.
+        //!
+        PSIViewIterator& operator++() { _entry = ENTRY(_entry.next(), _end); return *this; }
+
+        //!
+        //! Move to the next entry (postfix increment).
+        //! @return A copy of the iterator before the increment.
+        //!
+        PSIViewIterator operator++(int) { PSIViewIterator it(*this); ++*this; return it; }
+
+        //!
+        //! Equality operator.
+        //! @param [in] other Another iterator to compare.
+        //! @return True if both iterators point to the same entry.
+        //!
+        bool operator==(const PSIViewIterator& other) const { return _entry.data() == other._entry.data(); }
+
+        //!
+        //! Unequality operator.
+        //! @param [in] other Another iterator to compare.
+        //! @return True if the iterators point to different entries.
+        //!
+        bool operator!=(const PSIViewIterator& other) const { return _entry.data() != other._entry.data(); }
+
+    private:
+        ENTRY          _entry;
+        const uint8_t* _end;
+    };
+
+    //!
+    //! A loop of variable-size entries in a PSI/SI section, usable in range-based for loops.
+    //! @ingroup mpeg
+    //! @tparam ENTRY A subclass of PSIViewEntry with a constructor ENTRY(const uint8_t* data, const uint8_t* end).
+    //!
+    template <class ENTRY>
+    class PSIViewRange
+    {
+    public:
+        typedef PSIViewIterator<ENTRY> const_iterator;  //!< Iterator over the entries.
+
+        //!
+        //! Constructor.
+        //! @param [in] data Address of the loop.
+        //! @param [in] size Size in bytes of the loop.
+        //!
+        PSIViewRange(const uint8_t* data = nullptr, size_t size = 0) : _data(data), _end(data + size) {}
+
+        //!
+        //! Get an iterator to the first entry.
+        //! @return An iterator to the first entry.
+        //!
+        const_iterator begin() const { return const_iterator(_data, _end); }
+
+        //!
+        //! Get an iterator after the last entry.
+        //! @return An iterator after the last entry.
+        //!
+        const_iterator end() const { return const_iterator(_end, _end); }
+
+        //!
+        //! Check if the loop is empty.
+        //! @return True if the loop contains no entry.
+        //!
+        bool empty() const { return begin() == end(); }
+
+        //!
+        //! Count the entries in the loop.
+        //! @return The number of entries in the loop.
+        //!
+        size_t count() const { return size_t(std::distance(begin(), end())); }
+
+        //!
+        //! Get the address of the loop.
+        //! @return The address of the loop.
+        //!
+        const uint8_t* data() const { return _data; }
+
+        //!
+        //! Get the size of the loop.
+        //! @return The size in bytes of the loop.
+        //!
+        size_t size() const { return size_t(_end - _data); }
+
+    private:
+        const uint8_t* _data;
+        const uint8_t* _end;
+    };
+
+    //!
+    //! Read-only view on a descriptor in a PSI/SI section.
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL DescriptorView : public PSIViewEntry
+    {
+    public:
+        //!
+        //! Constructor.
+        //! @param [in] data Address of the descriptor.
+        //! @param [in] end Address of the end of the descriptor loop.
+        //!
+        DescriptorView(const uint8_t* data, const uint8_t* end) : PSIViewEntry(data, end, 2, 0, 0x00FF) {}
+
+        //!
+        //! Get the descriptor tag.
+        //! @return The descriptor tag.
+        //!
+        DID tag() const { return _data[0]; }
+
+        //!
+        //! Get the extended descriptor tag of a DVB extension_descriptor.
+        //! @return The extended descriptor tag or 0xFF if this is not a DVB extension_descriptor.
+        //!
+        DID extensionTag() const { return _data[0] == DID_DVB_EXTENSION && _size > 2 ? _data[2] : 0xFF; }
+
+        //!
+        //! Get the address of the descriptor payload.
+        //! @return The address of the descriptor payload.
+        //!
+        const uint8_t* payload() const { return _data + 2; }
+
+        //!
+        //! Get the size of the descriptor payload.
+        //! @return The size in bytes of the descriptor payload.
+        //!
+        size_t payloadSize() const { return _size - 2; }
+    };
+
+    //!
+    //! Read-only view on a descriptor loop in a PSI/SI section.
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL DescriptorListView : public PSIViewRange<DescriptorView>
+    {
+    public:
+        //!
+        //! Constructor.
+        //! @param [in] data Address of the descriptor loop.
+        //! @param [in] size Size in bytes of the descriptor loop.
+        //!
+        DescriptorListView(const uint8_t* data = nullptr, size_t size = 0) : PSIViewRange<DescriptorView>(data, size) {}
+
+        //!
+        //! Search a descriptor with the specified tag.
+        //! @param [in] tag Tag of the descriptor to search.
+        //! @return An iterator to the first descriptor with @a tag or end() if not found.
+        //!
+        const_iterator search(DID tag) const { return search(tag, begin()); }
+
+        //!
+        //! Search a descriptor with the specified tag.
+        //! @param [in] tag Tag of the descriptor to search.
+        //! @param [in] start Iterator to the first descriptor to check.
+        //! @return An iterator to the first descriptor with @a tag, starting at @a start, or end() if not found.
+        //!
+        const_iterator search(DID tag, const_iterator start) const;
+
+        //!
+        //! Check if a descriptor with the specified tag is present.
+        //! @param [in] tag Tag of the descriptor to search.
+        //! @return True if a descriptor with @a tag is present.
+        //!
+        bool contains(DID tag) const { return search(tag) != end(); }
+
+        //!
+        //! Check if a DVB extension_descriptor with the specified extended tag is present.
+        //! @param [in] ext_tag Extended tag of the descriptor to search.
+        //! @return True if a DVB extension_descriptor with @a ext_tag is present.
+        //!
+        bool containsExtension(DID ext_tag) const;
+    };
+
+    //!
+    //! Base class of read-only views on PSI/SI sections.
+    //! @ingroup mpeg
+    //!
+    //! A view does not copy anything and does not allocate memory. It points directly
+    //! into the binary content of the section. The section must remain valid and
+    //! unmodified while the view is used.
+    //!
+    class TSDUCKDLL PSIView
+    {
+    public:
+        //!
+        //! Check if the view is valid.
+        //! @return True if the section has the expected table id and structure.
+        //!
+        bool isValid() const { return _payload != nullptr; }
+
+        //!
+        //! Get the table id extension of the section.
+        //! @return The table id extension.
+        //!
+        uint16_t tableIdExtension() const { return _tid_ext; }
+
+    protected:
+        const uint8_t* _payload;  //!< Address of section payload, null if invalid.
+        size_t         _size;     //!< Size of section payload.
+        uint16_t       _tid_ext;  //!< Table id extension.
+
+        //!
+        //! Constructor for subclasses.
+        //! @param [in] section The section to view.
+        //! @param [in] tid_min Minimum table id.
+        //! @param [in] tid_max Maximum table id.
+        //! @param [in] min_size Minimum payload size.
+        //! @param [in] other_tid Another accepted table id, outside the range.
+        //!
+        PSIView(const Section& section, TID tid_min, TID tid_max, size_t min_size, TID other_tid = TID_NULL);
+
+        //!
+        //! Get a descriptor loop with a 12-bit length field.
+        //! @param [in] offset Offset of the length field in the payload.
+        //! @return A view on the descriptor loop, empty if it does not fit in the payload.
+        //!
+        DescriptorListView descriptorLoop(size_t offset) const;
+
+        //!
+        //! Get the 12-bit length field of a loop, bounded by the end of the payload.
+        //! @param [in] offset Offset of the length field in the payload.
+        //! @return The size in bytes of the loop.
+        //!
+        size_t loopSize(size_t offset) const;
+    };
+
+    //!
+    //! Read-only view on a Program Association Table (PAT) section.
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL PATView : public PSIView
+    {
+    public:
+        //!
+        //! View on one service entry in the PAT.
+        //! The service id zero designates the NIT PID.
+        //!
+        class TSDUCKDLL Service : public PSIViewEntry
+        {
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] data Address of the entry.
+            //! @param [in] end Address of the end of the loop.
+            //!
+            Service(const uint8_t* data, const uint8_t* end) : PSIViewEntry(data, end, 4) {}
+            //!
+            //! Get the service id.
+            //! @return The service id (program number).
+            //!
+            uint16_t serviceId() const { return GetUInt16(_data); }
+            //!
+            //! Get the PMT PID.
+            //! @return The PMT PID of the service (or NIT PID for service id zero).
+            //!
+            PID pmtPID() const { return GetUInt16(_data + 2) & 0x1FFF; }
+        };
+
+        //!
+        //! Constructor.
+        //! @param [in] section The section to view.
+        //!
+        explicit PATView(const Section& section) : PSIView(section, TID_PAT, TID_PAT, 0) {}
+
+        //!
+        //! Get the transport stream id.
+        //! @return The transport stream id.
+        //!
+        uint16_t transportStreamId() const { return _tid_ext; }
+
+        //!
+        //! Get the list of services, including the NIT entry.
+        //! @return A view on the service loop.
+        //!
+        PSIViewRange<Service> services() const { return PSIViewRange<Service>(_payload, _size); }
+
+        //!
+        //! Get the PMT PID of a service.
+        //! @param [in] service_id The service id.
+        //! @return The PMT PID of the service or PID_NULL if not found.
+        //!
+        PID pmtPID(uint16_t service_id) const;
+
+        //!
+        //! Get the NIT PID.
+        //! @return The NIT PID or PID_NULL if not present.
+        //!
+        PID nitPID() const { return pmtPID(0); }
+    };
+
+    //!
+    //! Read-only view on a Program Map Table (PMT) section.
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL PMTView : public PSIView
+    {
+    public:
+        //!
+        //! View on one elementary stream entry in the PMT.
+        //!
+        class TSDUCKDLL Stream : public PSIViewEntry
+        {
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] data Address of the entry.
+            //! @param [in] end Address of the end of the loop.
+            //!
+            Stream(const uint8_t* data, const uint8_t* end) : PSIViewEntry(data, end, 5, 3) {}
+            //!
+            //! Get the stream type.
+            //! @return The stream type.
+            //!
+            uint8_t streamType() const { return _data[0]; }
+            //!
+            //! Get the elementary stream PID.
+            //! @return The elementary stream PID.
+            //!
+            PID pid() const { return GetUInt16(_data + 1) & 0x1FFF; }
+            //!
+            //! Get the descriptor loop of the elementary stream.
+            //! @return A view on the descriptor loop.
+            //!
+            DescriptorListView descriptors() const { return DescriptorListView(_data + 5, _size - 5); }
+            //!
+            //! Check if the elementary stream carries video.
+            //! Same semantics as PMT::Stream::isVideo().
+            //! @return True if the elementary stream carries video.
+            //!
+            bool isVideo() const;
+            //!
+            //! Check if the elementary stream carries audio.
+            //! Same semantics as PMT::Stream::isAudio().
+            //! @return True if the elementary stream carries audio.
+            //!
+            bool isAudio() const;
+        };
+
+        //!
+        //! Constructor.
+        //! @param [in] section The section to view.
+        //!
+        explicit PMTView(const Section& section) : PSIView(section, TID_PMT, TID_PMT, 4) {}
+
+        //!
+        //! Get the service id.
+        //! @return The service id (program number).
+        //!
+        uint16_t serviceId() const { return _tid_ext; }
+
+        //!
+        //! Get the PCR PID.
+        //! @return The PCR PID.
+        //!
+        PID pcrPID() const { return isValid() ? GetUInt16(_payload) & 0x1FFF : PID_NULL; }
+
+        //!
+        //! Get the program-level descriptor loop.
+        //! @return A view on the program-level descriptor loop.
+        //!
+        DescriptorListView descriptors() const { return descriptorLoop(2); }
+
+        //!
+        //! Get the list of elementary streams.
+        //! @return A view on the elementary stream loop.
+        //!
+        PSIViewRange<Stream> streams() const;
+    };
+
+    //!
+    //! Read-only view on a Service Description Table (SDT) section.
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL SDTView : public PSIView
+    {
+    public:
+        //!
+        //! View on one service entry in the SDT.
+        //!
+        class TSDUCKDLL Service : public PSIViewEntry
+        {
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] data Address of the entry.
+            //! @param [in] end Address of the end of the loop.
+            //!
+            Service(const uint8_t* data, const uint8_t* end) : PSIViewEntry(data, end, 5, 3) {}
+            //!
+            //! Get the service id.
+            //! @return The service id.
+            //!
+            uint16_t serviceId() const { return GetUInt16(_data); }
+            //!
+            //! Check if EIT schedule are present for the service.
+            //! @return The EIT_schedule_flag.
+            //!
+            bool eitSchedule() const { return (_data[2] & 0x02) != 0; }
+            //!
+            //! Check if EIT present/following are present for the service.
+            //! @return The EIT_present_following_flag.
+            //!
+            bool eitPresentFollowing() const { return (_data[2] & 0x01) != 0; }
+            //!
+            //! Get the running status of the service.
+            //! @return The running status.
+            //!
+            uint8_t runningStatus() const { return _data[3] >> 5; }
+            //!
+            //! Check if the service is controlled by a CA system.
+            //! @return The free_CA_mode flag.
+            //!
+            bool CAControlled() const { return (_data[3] & 0x10) != 0; }
+            //!
+            //! Get the descriptor loop of the service.
+            //! @return A view on the descriptor loop.
+            //!
+            DescriptorListView descriptors() const { return DescriptorListView(_data + 5, _size - 5); }
+            //!
+            //! Get the service type from the service_descriptor.
+            //! @return The service type or zero if there is no service_descriptor.
+            //!
+            uint8_t serviceType() const;
+        };
+
+        //!
+        //! Constructor.
+        //! @param [in] section The section to view.
+        //!
+        explicit SDTView(const Section& section) : PSIView(section, TID_SDT_ACT, TID_SDT_OTH, 3) {}
+
+        //!
+        //! Get the transport stream id.
+        //! @return The transport stream id.
+        //!
+        uint16_t transportStreamId() const { return _tid_ext; }
+
+        //!
+        //! Get the original network id.
+        //! @return The original network id.
+        //!
+        uint16_t originalNetworkId() const { return isValid() ? GetUInt16(_payload) : 0; }
+
+        //!
+        //! Get the list of services.
+        //! @return A view on the service loop.
+        //!
+        PSIViewRange<Service> services() const { return isValid() ? PSIViewRange<Service>(_payload + 3, _size - 3) : PSIViewRange<Service>(); }
+    };
+
+    //!
+    //! Read-only view on a Network Information Table (NIT) or Bouquet Association Table (BAT) section.
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL NITView : public PSIView
+    {
+    public:
+        //!
+        //! View on one transport stream entry in the NIT or BAT.
+        //!
+        class TSDUCKDLL TransportStream : public PSIViewEntry
+        {
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] data Address of the entry.
+            //! @param [in] end Address of the end of the loop.
+            //!
+            TransportStream(const uint8_t* data, const uint8_t* end) : PSIViewEntry(data, end, 6, 4) {}
+            //!
+            //! Get the transport stream id.
+            //! @return The transport stream id.
+            //!
+            uint16_t transportStreamId() const { return GetUInt16(_data); }
+            //!
+            //! Get the original network id.
+            //! @return The original network id.
+            //!
+            uint16_t originalNetworkId() const { return GetUInt16(_data + 2); }
+            //!
+            //! Get the descriptor loop of the transport stream.
+            //! @return A view on the descriptor loop.
+            //!
+            DescriptorListView descriptors() const { return DescriptorListView(_data + 6, _size - 6); }
+        };
+
+        //!
+        //! Constructor.
+        //! @param [in] section The section to view, a NIT Actual, NIT Other or BAT.
+        //!
+        explicit NITView(const Section& section) : PSIView(section, TID_NIT_ACT, TID_NIT_OTH, 4, TID_BAT) {}
+
+        //!
+        //! Get the network id (or bouquet id for a BAT).
+        //! @return The network id.
+        //!
+        uint16_t networkId() const { return _tid_ext; }
+
+        //!
+        //! Get the network-level (or bouquet-level) descriptor loop.
+        //! @return A view on the descriptor loop.
+        //!
+        DescriptorListView descriptors() const { return descriptorLoop(0); }
+
+        //!
+        //! Get the list of transport streams.
+        //! @return A view on the transport stream loop.
+        //!
+        PSIViewRange<TransportStream> transportStreams() const;
+    };
+
+    //!
+    //! Read-only view on an Event Information Table (EIT) section.
+    //! @ingroup mpeg
+    //!
+    class TSDUCKDLL EITView : public PSIView
+    {
+    public:
+        //!
+        //! View on one event entry in the EIT.
+        //!
+        class TSDUCKDLL Event : public PSIViewEntry
+        {
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] data Address of the entry.
+            //! @param [in] end Address of the end of the loop.
+            //!
+            Event(const uint8_t* data, const uint8_t* end) : PSIViewEntry(data, end, 12, 10) {}
+            //!
+            //! Get the event id.
+            //! @return The event id.
+            //!
+            uint16_t eventId() const { return GetUInt16(_data); }
+            //!
+            //! Get the event start time.
+            //! @param [out] time The event start time (UTC in DVB).
+            //! @return True on success, false if the start time is invalid.
+            //!
+            bool getStartTime(Time& time) const;
+            //!
+            //! Get the event duration.
+            //! @return The event duration in seconds.
+            //!
+            Second duration() const;
+            //!
+            //! Get the running status of the event.
+            //! @return The running status.
+            //!
+            uint8_t runningStatus() const { return _data[10] >> 5; }
+            //!
+            //! Check if the event is controlled by a CA system.
+            //! @return The free_CA_mode flag.
+            //!
+            bool CAControlled() const { return (_data[10] & 0x10) != 0; }
+            //!
+            //! Get the descriptor loop of the event.
+            //! @return A view on the descriptor loop.
+            //!
+            DescriptorListView descriptors() const { return DescriptorListView(_data + 12, _size - 12); }
+        };
+
+        //!
+        //! Constructor.
+        //! @param [in] section The section to view, any EIT Actual or Other.
+        //!
+        explicit EITView(const Section& section) : PSIView(section, TID_EIT_MIN, TID_EIT_MAX, 6) {}
+
+        //!
+        //! Get the service id.
+        //! @return The service id.
+        //!
+        uint16_t serviceId() const { return _tid_ext; }
+
+        //!
+        //! Get the transport stream id.
+        //! @return The transport stream id.
+        //!
+        uint16_t transportStreamId() const { return isValid() ? GetUInt16(_payload) : 0; }
+
+        //!
+        //! Get the original network id.
+        //! @return The original network id.
+        //!
+        uint16_t originalNetworkId() const { return isValid() ? GetUInt16(_payload + 2) : 0; }
+
+        //!
+        //! Get the segment last section number.
+        //! @return The segment_last_section_number.
+        //!
+        uint8_t segmentLastSectionNumber() const { return isValid() ? _payload[4] : 0; }
+
+        //!
+        //! Get the last table id.
+        //! @return The last_table_id.
+        //!
+        TID lastTableId() const { return isValid() ? _payload[5] : TID(TID_NULL); }
+
+        //!
+        //! Get the list of events.
+        //! @return A view on the event loop.
+        //!
+        PSIViewRange<Event> events() const { return isValid() ? PSIViewRange<Event>(_payload + 6, _size - 6) : PSIViewRange<Event>(); }
+    };
+}
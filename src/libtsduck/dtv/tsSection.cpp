@@ -176,6 +176,27 @@ ts::Section::Section(TID tid,
 }
 
 
+//----------------------------------------------------------------------------
+// Reload from full binary content.
+//----------------------------------------------------------------------------
+
+void ts::Section::reload(const void* content, size_t content_size, PID source_pid, CRC32::Validation crc_op)
+{
+    const uint8_t* const data = reinterpret_cast<const uint8_t*>(content);
+
+    // Reuse the previous data buffer when we are its only user and
+    // the new content does not come from this buffer.
+    if (!_data.isNull() && _data.count() == 1 && (data + content_size <= _data->data() || data >= _data->data() + _data->capacity())) {
+        ByteBlockPtr bbp(_data);
+        bbp->copy(content, content_size);
+        initialize(bbp, source_pid, crc_op);
+    }
+    else {
+        initialize(new ByteBlock(content, content_size), source_pid, crc_op);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Reload short section
 //----------------------------------------------------------------------------
@@ -470,6 +491,39 @@ void ts::Section::setUInt16(size_t offset, uint16_t value, bool recompute_crc)
 }
 
 
+void ts::Section::setBytes(size_t offset, const void* data, size_t size, bool recompute_crc)
+{
+    if (_is_valid && offset + size <= payloadSize()) {
+        ::memcpy(_data->data() + headerSize() + offset, data, size);
+        if (recompute_crc) {
+            recomputeCRC();
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Remove a range of bytes in the payload of the section.
+//----------------------------------------------------------------------------
+
+bool ts::Section::erase(size_t offset, size_t size, bool recompute_crc)
+{
+    if (!_is_valid || offset + size > payloadSize()) {
+        return false;
+    }
+    if (size > 0) {
+        _data->erase(headerSize() + offset, size);
+        // Update the 12-bit section_length field.
+        uint8_t* const data = _data->data();
+        PutUInt16(data + 1, uint16_t((GetUInt16(data + 1) & 0xF000) | ((_data->size() - 3) & 0x0FFF)));
+        if (recompute_crc) {
+            recomputeCRC();
+        }
+    }
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Write section on standard streams.
 //----------------------------------------------------------------------------
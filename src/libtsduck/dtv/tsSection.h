@@ -153,6 +153,8 @@ namespace ts {
         //!
         //! Reload from full binary content.
         //! The content is copied into the section if valid.
+        //! When the previous content of the section is not shared with another
+        //! section, its memory is reused and no allocation takes place.
         //! @param [in] content Address of the binary section data.
         //! @param [in] content_size Size in bytes of the section.
         //! @param [in] source_pid PID from which the section was read.
@@ -161,10 +163,7 @@ namespace ts {
         void reload(const void* content,
                     size_t content_size,
                     PID source_pid = PID_NULL,
-                    CRC32::Validation crc_op = CRC32::IGNORE)
-        {
-            initialize(new ByteBlock(content, content_size), source_pid, crc_op);
-        }
+                    CRC32::Validation crc_op = CRC32::IGNORE);
 
         //!
         //! Reload from full binary content.
@@ -521,6 +520,28 @@ namespace ts {
         //!
         void setUInt16(size_t offset, uint16_t value, bool recompute_crc = true);
 
+        //!
+        //! Replace a range of bytes in the payload of the section.
+        //! The size of the section is unchanged.
+        //! @param [in] offset Byte offset in the payload.
+        //! @param [in] data Address of the new bytes.
+        //! @param [in] size Number of bytes to replace.
+        //! @param [in] recompute_crc If true, immediately recompute the CRC32 of the section.
+        //!
+        void setBytes(size_t offset, const void* data, size_t size, bool recompute_crc = true);
+
+        //!
+        //! Remove a range of bytes in the payload of the section.
+        //! The section_length field is updated accordingly. The section is modified in place,
+        //! without memory allocation. Other Section objects which share the same binary content
+        //! (see CopyShare) are modified as well.
+        //! @param [in] offset Byte offset in the payload.
+        //! @param [in] size Number of bytes to remove.
+        //! @param [in] recompute_crc If true, immediately recompute the CRC32 of the section.
+        //! @return True on success, false if the section is invalid or the range is outside the payload.
+        //!
+        bool erase(size_t offset, size_t size, bool recompute_crc = true);
+
         //!
         //! Set the source PID.
         //! @param [in] pid The source PID.
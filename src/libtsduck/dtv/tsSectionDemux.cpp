@@ -207,11 +207,45 @@ ts::SectionDemux::SectionDemux(DuckContext& duck, TableHandlerInterface* table_h
     _pids(),
     _status(),
     _get_current(true),
-    _get_next(false)
+    _get_next(false),
+    _recycle_sections(false),
+    _section_pool()
 {
 }
 
 
+//----------------------------------------------------------------------------
+// Get a new section, from the recycling pool when possible.
+//----------------------------------------------------------------------------
+
+ts::SectionPtr ts::SectionDemux::newSection(const uint8_t* data, size_t size, PID pid, CRC32::Validation crc_op)
+{
+    if (!_recycle_sections || _section_pool.empty()) {
+        return SectionPtr(new Section(data, size, pid, crc_op));
+    }
+    else {
+        SectionPtr sect(_section_pool.back());
+        _section_pool.pop_back();
+        sect->reload(data, size, pid, crc_op);
+        return sect;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Release a section pointer.
+//----------------------------------------------------------------------------
+
+void ts::SectionDemux::releaseSection(SectionPtr& sect)
+{
+    // Recycle the section only when the caller holds the last reference.
+    if (_recycle_sections && !sect.isNull() && sect.count() == 1) {
+        _section_pool.push_back(sect);
+    }
+    sect.clear();
+}
+
+
 //----------------------------------------------------------------------------
 // Reset the analysis context (partially built sections and tables).
 //----------------------------------------------------------------------------
@@ -343,7 +377,13 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
         pc.sync = true;
     }
 
-    // Copy TS packet payload in PID context
+    // Copy TS packet payload in PID context. When recycling sections, reserve the
+    // maximum size at once: an incomplete section plus one TS payload. Afterwards,
+    // the buffer is never reallocated since completed sections are only removed
+    // from its start. Otherwise, keep the default memory footprint per PID.
+    if (_recycle_sections && pc.ts.capacity() < MAX_PRIVATE_SECTION_SIZE + PKT_SIZE) {
+        pc.ts.reserve(MAX_PRIVATE_SECTION_SIZE + PKT_SIZE);
+    }
     pc.ts.append(payload, payload_size);
 
     // Locate TS buffer by address and size.
@@ -477,6 +517,11 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
                     tc->sect_expected == 0 ||    // new TID on this PID
                     tc->version != version)      // new version
                 {
+                    if (_recycle_sections) {
+                        for (auto& sect : tc->sects) {
+                            releaseSection(sect);
+                        }
+                    }
                     tc->init(version, last_section_number);
                 }
 
@@ -493,13 +538,34 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
             SectionPtr sect_ptr;
 
             if (section_ok && (_section_handler != nullptr || (tc != nullptr && tc->sects[section_number].isNull()))) {
-                sect_ptr = new Section(ts_start, section_length, pid, CRC32::CHECK);
-                sect_ptr->setFirstTSPacketIndex(pusi_pkt_index);
-                sect_ptr->setLastTSPacketIndex(_packet_count);
-                if (!sect_ptr->isValid()) {
-                    _status.wrong_crc++;  // only possible error (hum?)
+                if (!_recycle_sections || !long_header) {
+                    sect_ptr = newSection(ts_start, section_length, pid, CRC32::CHECK);
+                }
+                else if (CRC32(ts_start, section_length - SECTION_CRC32_SIZE) != GetUInt32(ts_start + section_length - SECTION_CRC32_SIZE)) {
+                    // Corrupted section, detected before any allocation.
+                    _status.wrong_crc++;
                     section_ok = false;
                 }
+                else if (tc != nullptr &&
+                         !tc->sects[section_number].isNull() &&
+                         tc->sects[section_number]->size() == section_length &&
+                         GetUInt32(tc->sects[section_number]->content() + section_length - SECTION_CRC32_SIZE) == GetUInt32(ts_start + section_length - SECTION_CRC32_SIZE))
+                {
+                    // Same version and same CRC32 as the collected section: unchanged, reuse it.
+                    sect_ptr = tc->sects[section_number];
+                }
+                else {
+                    // New or modified section, the CRC32 is already checked.
+                    sect_ptr = newSection(ts_start, section_length, pid, CRC32::IGNORE);
+                }
+                if (section_ok) {
+                    sect_ptr->setFirstTSPacketIndex(pusi_pkt_index);
+                    sect_ptr->setLastTSPacketIndex(_packet_count);
+                    if (!sect_ptr->isValid()) {
+                        _status.wrong_crc++;  // only possible error (hum?)
+                        section_ok = false;
+                    }
+                }
             }
 
             // Mark that we are in the context of a table or section handler.
@@ -530,6 +596,9 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
             if (afterCallingHandler(true)) {
                 return;  // the PID of this packet or the complete demux was reset.
             }
+
+            // Recycle the section if it was not kept in a table or by the application.
+            releaseSection(sect_ptr);
         }
 
         // Move to next section in the buffer
@@ -38,6 +38,7 @@
 #include "tsSectionHandlerInterface.h"
 #include "tsDuckContext.h"
 #include "tsETID.h"
+#include "tsPIDIndexedMap.h"
 
 namespace ts {
     //!
@@ -136,6 +137,40 @@ namespace ts {
             _get_next = next;
         }
 
+        //!
+        //! Enable or disable the recycling of sections.
+        //!
+        //! In this mode, the demux avoids heap allocations in steady state. A repeated
+        //! section from the current version of a table is checked (version and CRC32)
+        //! against the section which was previously collected and, when unchanged, this
+        //! same Section object is passed again to the section handler. Other Section
+        //! objects are taken from a recycling pool, reusing the memory of previous
+        //! sections which are no longer referenced by the demux or the application.
+        //!
+        //! As a consequence, the Section object which is passed to the section handler
+        //! may have been previously passed for the same section. Its first and last TS
+        //! packet indexes are updated to match the last occurence of the section.
+        //! Sections which must be preserved by the application shall be kept through
+        //! SectionPtr or copied, not referenced by address.
+        //!
+        //! @param [in] on True to recycle sections, false to allocate a new Section for
+        //! each demuxed section (the default).
+        //!
+        void setRecycleSections(bool on)
+        {
+            _recycle_sections = on;
+        }
+
+        //!
+        //! Check if the recycling of sections is enabled.
+        //! @return True if sections are recycled.
+        //! @see setRecycleSections()
+        //!
+        bool recycleSections() const
+        {
+            return _recycle_sections;
+        }
+
         //!
         //! Demux status information.
         //! It contains error counters.
@@ -254,13 +289,21 @@ namespace ts {
         // If fill_eit is true, add missing sections in EIT.
         void fixAndFlush(bool pack, bool fill_eit);
 
+        // Get a new section, from the recycling pool when possible.
+        SectionPtr newSection(const uint8_t* data, size_t size, PID pid, CRC32::Validation crc_op);
+
+        // Release a section pointer. The section is recycled when nobody else references it.
+        void releaseSection(SectionPtr& sect);
+
         // Private members:
         TableHandlerInterface*   _table_handler;
         SectionHandlerInterface* _section_handler;
-        std::map<PID,PIDContext> _pids;
+        PIDIndexedMap<PIDContext> _pids;
         Status                   _status;
         bool                     _get_current;
         bool                     _get_next;
+        bool                     _recycle_sections;
+        SectionPtrVector         _section_pool;
     };
 }
 
@@ -0,0 +1,596 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsSegmentedTimeShiftBuffer.h"
+#include "tsNullReport.h"
+#include "tsSysUtils.h"
+#include "tsGuardCondition.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::SegmentedTimeShiftBuffer::BLOCK_PACKETS;
+constexpr size_t ts::SegmentedTimeShiftBuffer::MIN_SEGMENT_COUNT;
+constexpr size_t ts::SegmentedTimeShiftBuffer::DEFAULT_SEGMENT_COUNT;
+constexpr size_t ts::SegmentedTimeShiftBuffer::DEFAULT_READ_AHEAD_BLOCKS;
+constexpr size_t ts::SegmentedTimeShiftBuffer::DEFAULT_WRITE_BEHIND_BLOCKS;
+#endif
+
+
+//----------------------------------------------------------------------------
+// The I/O thread, simply runs ioLoop() in the buffer.
+//----------------------------------------------------------------------------
+
+class ts::SegmentedTimeShiftBuffer::IOThread : public Thread
+{
+    TS_NOBUILD_NOCOPY(IOThread);
+public:
+    IOThread(SegmentedTimeShiftBuffer& buffer) : Thread(), _buffer(buffer) {}
+    virtual ~IOThread() override { waitForTermination(); }
+private:
+    SegmentedTimeShiftBuffer& _buffer;
+    virtual void main() override { _buffer.ioLoop(); }
+};
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors
+//----------------------------------------------------------------------------
+
+ts::SegmentedTimeShiftBuffer::Block::Block() :
+    state(FILLING),
+    packets(BLOCK_PACKETS)
+{
+}
+
+ts::SegmentedTimeShiftBuffer::SegmentedTimeShiftBuffer() :
+    _is_open(false),
+    _min_packets(BLOCK_PACKETS),
+    _segment_count(DEFAULT_SEGMENT_COUNT),
+    _read_ahead(DEFAULT_READ_AHEAD_BLOCKS),
+    _write_behind(DEFAULT_WRITE_BEHIND_BLOCKS),
+    _directory(),
+    _segment_blocks(0),
+    _total_blocks(0),
+    _files(),
+    _report(nullptr),
+    _write_index(0),
+    _read_index(0),
+    _wblock(),
+    _rblock(),
+    _last_time(INVALID_PCR),
+    _lost_packets(0),
+    _mutex(),
+    _work(),
+    _done(),
+    _write_block(0),
+    _first_block(0),
+    _read_block(0),
+    _dirty_count(0),
+    _io_error(false),
+    _terminate(false),
+    _blocks(),
+    _free(),
+    _block_time(),
+    _thread(nullptr)
+{
+}
+
+ts::SegmentedTimeShiftBuffer::~SegmentedTimeShiftBuffer()
+{
+    close(NULLREP);
+}
+
+
+//----------------------------------------------------------------------------
+// Set various characteristics, must be called before open.
+//----------------------------------------------------------------------------
+
+bool ts::SegmentedTimeShiftBuffer::setTotalPackets(PacketCounter count)
+{
+    if (_is_open) {
+        return false;
+    }
+    else {
+        _min_packets = std::max<PacketCounter>(count, BLOCK_PACKETS);
+        return true;
+    }
+}
+
+bool ts::SegmentedTimeShiftBuffer::setSegmentCount(size_t count)
+{
+    if (_is_open) {
+        return false;
+    }
+    else {
+        _segment_count = std::max(count, MIN_SEGMENT_COUNT);
+        return true;
+    }
+}
+
+bool ts::SegmentedTimeShiftBuffer::setCacheBlocks(size_t read_ahead, size_t write_behind)
+{
+    if (_is_open) {
+        return false;
+    }
+    else {
+        _read_ahead = read_ahead;
+        _write_behind = std::max<size_t>(write_behind, 1);
+        return true;
+    }
+}
+
+bool ts::SegmentedTimeShiftBuffer::setBackupDirectory(const UString& directory)
+{
+    if (_is_open) {
+        return false;
+    }
+    else {
+        _directory = directory;
+        return true;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get the capacity of the buffer in packets.
+//----------------------------------------------------------------------------
+
+ts::PacketCounter ts::SegmentedTimeShiftBuffer::size() const
+{
+    // The oldest block is overwritten as soon as a new block is started.
+    return _total_blocks == 0 ? 0 : PacketCounter(_total_blocks - 1) * BLOCK_PACKETS;
+}
+
+
+//----------------------------------------------------------------------------
+// Open the buffer.
+//----------------------------------------------------------------------------
+
+bool ts::SegmentedTimeShiftBuffer::open(Report& report)
+{
+    if (_is_open) {
+        report.error(u"time-shift buffer already open");
+        return false;
+    }
+    if (!_directory.empty() && !IsDirectory(_directory)) {
+        report.error(u"directory %s does not exist", {_directory});
+        return false;
+    }
+
+    // Compute the structure of the ring. There must be enough blocks to never
+    // overwrite a block in the read-ahead or write-behind areas.
+    const size_t min_blocks = std::max<size_t>(size_t((_min_packets + BLOCK_PACKETS - 1) / BLOCK_PACKETS) + 1, _read_ahead + _write_behind + 3);
+    _segment_blocks = (min_blocks + _segment_count - 1) / _segment_count;
+    _total_blocks = _segment_blocks * _segment_count;
+
+    // Create all segment files. The flag temporary means that they will be deleted on close.
+    _files.resize(_segment_count);
+    bool success = true;
+    for (size_t i = 0; success && i < _files.size(); ++i) {
+        // Get the name of a temporary file. If a directory is specified, we will use the base name only.
+        UString filename(TempFile(UString::Format(u"-%d.ts", {i})));
+        if (!_directory.empty()) {
+            filename = _directory + PathSeparator + BaseName(filename);
+        }
+        success = _files[i].open(filename, TSFile::READ | TSFile::WRITE | TSFile::TEMPORARY, report) &&
+                  _files[i].preallocate(PacketCounter(_segment_blocks) * BLOCK_PACKETS, report);
+    }
+    if (!success) {
+        for (size_t i = 0; i < _files.size(); ++i) {
+            if (_files[i].isOpen()) {
+                _files[i].close(report);
+            }
+        }
+        _files.clear();
+        _total_blocks = 0;
+        return false;
+    }
+    report.debug(u"time-shift buffer: %d segments of %'d packets", {_segment_count, PacketCounter(_segment_blocks) * BLOCK_PACKETS});
+
+    // Reset the state of the buffer.
+    _report = &report;
+    _write_index = _read_index = 0;
+    _wblock.clear();
+    _rblock.clear();
+    _last_time = INVALID_PCR;
+    _lost_packets = 0;
+    _write_block = _first_block = _read_block = 0;
+    _dirty_count = 0;
+    _io_error = false;
+    _terminate = false;
+    _blocks.clear();
+    _block_time.assign(_total_blocks, INVALID_PCR);
+
+    // Start the I/O thread.
+    _thread = new IOThread(*this);
+    if (!_thread->start()) {
+        report.error(u"cannot start time-shift I/O thread");
+        delete _thread;
+        _thread = nullptr;
+        close(report);
+        return false;
+    }
+
+    _is_open = true;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Close the buffer.
+//----------------------------------------------------------------------------
+
+bool ts::SegmentedTimeShiftBuffer::close(Report& report)
+{
+    if (!_is_open && _files.empty()) {
+        return false;
+    }
+
+    // Terminate the I/O thread. Pending blocks are useless, the files are deleted.
+    if (_thread != nullptr) {
+        _mutex.acquire();
+        _terminate = true;
+        _work.signal();
+        _mutex.release();
+        delete _thread;  // wait for termination
+        _thread = nullptr;
+    }
+
+    bool success = true;
+    for (size_t i = 0; i < _files.size(); ++i) {
+        success = _files[i].close(report) && success;
+    }
+    _files.clear();
+    _blocks.clear();
+    _free.clear();
+    _block_time.clear();
+    _wblock.clear();
+    _rblock.clear();
+    _total_blocks = 0;
+    _is_open = false;
+    return success;
+}
+
+
+//----------------------------------------------------------------------------
+// Get a block from the free list or allocate a new one (mutex held).
+//----------------------------------------------------------------------------
+
+ts::SegmentedTimeShiftBuffer::BlockPtr ts::SegmentedTimeShiftBuffer::newBlock(BlockState state)
+{
+    BlockPtr block;
+    if (_free.empty()) {
+        block = new Block;
+    }
+    else {
+        block = _free.front();
+        _free.pop_front();
+    }
+    block->state = state;
+    return block;
+}
+
+
+//----------------------------------------------------------------------------
+// Release blocks which are no longer useful (mutex held).
+//----------------------------------------------------------------------------
+
+void ts::SegmentedTimeShiftBuffer::releaseBlocks()
+{
+    // Only clean blocks can be released. They are kept only in the read-ahead area.
+    // The current read block is never released since the application reads it without lock.
+    // The last write block is kept until the next block is started: when it is complete, it
+    // is clean after being written but the I/O thread only reloads blocks before it.
+    for (auto it = _blocks.begin(); it != _blocks.end(); ) {
+        if (it->second->state == CLEAN && it->first != _write_block && (it->first < _read_block || it->first > _read_block + _read_ahead)) {
+            _free.push_back(it->second);
+            it = _blocks.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Set the read position (mutex held).
+//----------------------------------------------------------------------------
+
+void ts::SegmentedTimeShiftBuffer::setReadIndex(PacketCounter index)
+{
+    _read_index = index;
+    _read_block = index / BLOCK_PACKETS;
+    _rblock.clear();
+    releaseBlocks();
+    _work.signal();
+}
+
+
+//----------------------------------------------------------------------------
+// Write a packet at the end of the buffer.
+//----------------------------------------------------------------------------
+
+bool ts::SegmentedTimeShiftBuffer::write(const TSPacket& pkt, uint64_t timestamp, Report& report)
+{
+    if (!_is_open) {
+        report.error(u"time-shift buffer not open");
+        return false;
+    }
+
+    const size_t index_in_block = size_t(_write_index % BLOCK_PACKETS);
+
+    // Start a new block when necessary.
+    if (index_in_block == 0) {
+        GuardCondition lock(_mutex, _done);
+
+        // Wait until the write-behind area is not full. This is where the
+        // application is slowed down when the disk is slower than the stream.
+        while (_dirty_count >= _write_behind && !_io_error) {
+            lock.waitCondition();
+        }
+        if (_io_error) {
+            report.error(u"time-shift buffer I/O error");
+            return false;
+        }
+
+        // The new block overwrites the oldest one in the ring.
+        _write_block = _write_index / BLOCK_PACKETS;
+        if (_write_block >= _total_blocks) {
+            _first_block = _write_block - _total_blocks + 1;
+            const PacketCounter first_index = _first_block * BLOCK_PACKETS;
+            if (_read_index < first_index) {
+                _lost_packets += first_index - _read_index;
+                setReadIndex(first_index);
+            }
+        }
+        _wblock = newBlock(FILLING);
+        _blocks[_write_block] = _wblock;
+        _block_time[size_t(_write_block % _total_blocks)] = timestamp;
+    }
+
+    _wblock->packets[index_in_block] = pkt;
+    _write_index++;
+    _last_time = timestamp;
+
+    // When the block is complete, pass it to the I/O thread.
+    if (index_in_block + 1 == BLOCK_PACKETS) {
+        Guard lock(_mutex);
+        _wblock->state = DIRTY;
+        _wblock.clear();
+        _dirty_count++;
+        _work.signal();
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Read the packet at the playout position.
+//----------------------------------------------------------------------------
+
+bool ts::SegmentedTimeShiftBuffer::read(TSPacket& pkt, Report& report)
+{
+    if (!_is_open) {
+        report.error(u"time-shift buffer not open");
+        return false;
+    }
+    if (_read_index >= _write_index || (_rblock.isNull() && !locateReadBlock(report))) {
+        return false;
+    }
+
+    pkt = _rblock->packets[size_t(_read_index % BLOCK_PACKETS)];
+
+    // At end of block, the I/O thread may release it and read ahead.
+    if (++_read_index % BLOCK_PACKETS == 0) {
+        Guard lock(_mutex);
+        setReadIndex(_read_index);
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Locate the current read block, waiting for the I/O thread if necessary.
+//----------------------------------------------------------------------------
+
+bool ts::SegmentedTimeShiftBuffer::locateReadBlock(Report& report)
+{
+    GuardCondition lock(_mutex, _done);
+    for (;;) {
+        if (_io_error) {
+            report.error(u"time-shift buffer I/O error");
+            return false;
+        }
+        const auto it = _blocks.find(_read_block);
+        if (it != _blocks.end() && it->second->state != LOADING) {
+            _rblock = it->second;
+            return true;
+        }
+        // The block is on disk only, wait for the I/O thread to load it.
+        _work.signal();
+        lock.waitCondition();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get the time stamp of the oldest packet in the buffer.
+//----------------------------------------------------------------------------
+
+uint64_t ts::SegmentedTimeShiftBuffer::firstTimeStamp() const
+{
+    return _write_index == 0 ? INVALID_PCR : _block_time[size_t(_first_block % _total_blocks)];
+}
+
+
+//----------------------------------------------------------------------------
+// Move the playout position to a given time stamp.
+//----------------------------------------------------------------------------
+
+bool ts::SegmentedTimeShiftBuffer::seekTimeStamp(uint64_t timestamp, Report& report)
+{
+    if (!_is_open || _write_index == 0) {
+        report.error(u"time-shift buffer is empty");
+        return false;
+    }
+
+    // Time stamp of the first packet in a block. The blocks of the ring are never accessed by the I/O thread.
+    const auto block_time = [this](PacketCounter block) { return _block_time[size_t(block % _total_blocks)]; };
+
+    if (timestamp == INVALID_PCR || block_time(_first_block) == INVALID_PCR || _last_time == INVALID_PCR) {
+        report.error(u"no time index in time-shift buffer");
+        return false;
+    }
+
+    PacketCounter index = 0;
+    if (timestamp <= block_time(_first_block)) {
+        index = _first_block * BLOCK_PACKETS;
+    }
+    else if (timestamp >= _last_time) {
+        index = _write_index - 1;
+    }
+    else {
+        // Binary search of the last block starting before the time stamp.
+        PacketCounter low = _first_block;
+        PacketCounter high = _write_block;
+        while (low < high) {
+            const PacketCounter mid = (low + high + 1) / 2;
+            if (block_time(mid) <= timestamp) {
+                low = mid;
+            }
+            else {
+                high = mid - 1;
+            }
+        }
+        // Interpolate the position inside the block.
+        const uint64_t start = block_time(low);
+        const uint64_t end = low < _write_block ? block_time(low + 1) : _last_time;
+        const PacketCounter count = low < _write_block ? BLOCK_PACKETS : _write_index - low * BLOCK_PACKETS - 1;
+        index = low * BLOCK_PACKETS;
+        if (end > start) {
+            index += std::min(count, (timestamp - start) * count / (end - start));
+        }
+    }
+
+    Guard lock(_mutex);
+    setReadIndex(std::min(index, _write_index - 1));
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Body of the I/O thread.
+//----------------------------------------------------------------------------
+
+void ts::SegmentedTimeShiftBuffer::ioLoop()
+{
+    _mutex.acquire();
+    while (!_terminate && !_io_error) {
+
+        // Look for the first missing block in the read-ahead area. Complete blocks
+        // which are not in memory are on disk since only clean blocks are released.
+        PacketCounter load = _write_block;
+        for (PacketCounter b = std::max(_read_block, _first_block); b < _write_block && b <= _read_block + _read_ahead; ++b) {
+            if (_blocks.find(b) == _blocks.end()) {
+                load = b;
+                break;
+            }
+        }
+
+        // Look for the oldest block to write.
+        BlockMap::iterator dirty(_blocks.begin());
+        while (dirty != _blocks.end() && dirty->second->state != DIRTY) {
+            ++dirty;
+        }
+
+        // Loading the current read block has priority since the application waits for it.
+        // Then write the blocks before reading ahead.
+        if (load < _write_block && (load == _read_block || dirty == _blocks.end())) {
+            const BlockPtr block(newBlock(LOADING));
+            _blocks[load] = block;
+            _mutex.release();
+            const bool success = ioBlock(load, *block, false);
+            _mutex.acquire();
+            _io_error = !success;
+            if (load < _first_block) {
+                // Overwritten while it was read, useless.
+                _blocks.erase(load);
+                _free.push_back(block);
+            }
+            else {
+                block->state = CLEAN;
+            }
+            releaseBlocks();
+            _done.signal();
+        }
+        else if (dirty != _blocks.end()) {
+            // A dirty block is never released or modified by the application.
+            const PacketCounter index = dirty->first;
+            const BlockPtr block(dirty->second);
+            _mutex.release();
+            const bool success = ioBlock(index, *block, true);
+            _mutex.acquire();
+            _io_error = !success;
+            block->state = CLEAN;
+            _dirty_count--;
+            releaseBlocks();
+            _done.signal();
+        }
+        else {
+            // Nothing to do, wait for the application.
+            _work.wait(_mutex, Infinite);
+        }
+    }
+    _mutex.release();
+}
+
+
+//----------------------------------------------------------------------------
+// Read or write a block on disk (called by the I/O thread without mutex).
+//----------------------------------------------------------------------------
+
+bool ts::SegmentedTimeShiftBuffer::ioBlock(PacketCounter index, Block& block, bool write)
+{
+    const size_t slot = size_t(index % _total_blocks);
+    TSFile& file(_files[slot / _segment_blocks]);
+    if (!file.seek(PacketCounter(slot % _segment_blocks) * BLOCK_PACKETS, *_report)) {
+        return false;
+    }
+    else if (write) {
+        return file.write(block.packets.data(), BLOCK_PACKETS, *_report);
+    }
+    else if (file.read(block.packets.data(), BLOCK_PACKETS, *_report) != BLOCK_PACKETS) {
+        _report->error(u"truncated time-shift segment file");
+        return false;
+    }
+    else {
+        return true;
+    }
+}
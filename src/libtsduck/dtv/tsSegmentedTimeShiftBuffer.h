@@ -0,0 +1,301 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  A segmented ring of files on disk for long time shift.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsUString.h"
+#include "tsTSFile.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsGuard.h"
+#include "tsCondition.h"
+#include "tsSafePtr.h"
+#include "tsNullMutex.h"
+#include "tsReport.h"
+
+namespace ts {
+    //!
+    //! A segmented ring of files on disk for long time shift.
+    //! @ingroup mpeg
+    //!
+    //! The buffer is made of several files of identical size, the segments, which are
+    //! preallocated when the buffer is opened and then overwritten in a circular way.
+    //! All disk I/O are performed by an internal thread, by blocks of BLOCK_PACKETS
+    //! packets. The packets are written behind the application and read ahead of it.
+    //! The application thread never performs I/O, it waits only when the disk is
+    //! slower than the stream. The memory usage is bounded by the read-ahead and
+    //! write-behind sizes, independently of the total size of the buffer.
+    //!
+    //! Each packet is written with a time stamp in PCR units, typically its input
+    //! time stamp. The time stamp of the first packet of each block is kept in an
+    //! index. The application can start the playout at any time in the buffer.
+    //!
+    //! The buffer is used by one single application thread, which writes and reads
+    //! the packets. It is not designed to be called from several application threads.
+    //!
+    class TSDUCKDLL SegmentedTimeShiftBuffer
+    {
+        TS_NOCOPY(SegmentedTimeShiftBuffer);
+    public:
+        //!
+        //! Number of TS packets in a block, the unit of disk I/O.
+        //!
+        static constexpr size_t BLOCK_PACKETS = 4096;
+
+        //!
+        //! Minimum number of segment files.
+        //!
+        static constexpr size_t MIN_SEGMENT_COUNT = 2;
+
+        //!
+        //! Default number of segment files.
+        //!
+        static constexpr size_t DEFAULT_SEGMENT_COUNT = 16;
+
+        //!
+        //! Default number of blocks which are read ahead of the playout position.
+        //!
+        static constexpr size_t DEFAULT_READ_AHEAD_BLOCKS = 4;
+
+        //!
+        //! Default maximum number of blocks which are waiting to be written on disk.
+        //!
+        static constexpr size_t DEFAULT_WRITE_BEHIND_BLOCKS = 8;
+
+        //!
+        //! Constructor.
+        //!
+        SegmentedTimeShiftBuffer();
+
+        //!
+        //! Destructor.
+        //!
+        ~SegmentedTimeShiftBuffer();
+
+        //!
+        //! Set the minimum capacity of the buffer in packets.
+        //! The actual capacity is rounded up to an integral number of blocks per segment.
+        //! Must be called before open().
+        //! @param [in] count Minimum number of packets in the buffer.
+        //! @return True on success, false if already open.
+        //!
+        bool setTotalPackets(PacketCounter count);
+
+        //!
+        //! Set the number of segment files.
+        //! Must be called before open().
+        //! @param [in] count Number of segment files.
+        //! @return True on success, false if already open.
+        //!
+        bool setSegmentCount(size_t count);
+
+        //!
+        //! Set the number of blocks in memory.
+        //! Must be called before open().
+        //! @param [in] read_ahead Number of blocks which are read ahead of the playout position.
+        //! @param [in] write_behind Maximum number of blocks which are waiting to be written on disk.
+        //! @return True on success, false if already open.
+        //!
+        bool setCacheBlocks(size_t read_ahead, size_t write_behind);
+
+        //!
+        //! Set the directory for the segment files.
+        //! Must be called before open().
+        //! By default, the files are created in the system-dependent temporary directory.
+        //! The files are automatically deleted when the buffer is closed.
+        //! @param [in] directory Directory name.
+        //! @return True on success, false if already open.
+        //!
+        bool setBackupDirectory(const UString& directory);
+
+        //!
+        //! Open the buffer, create the segment files and start the I/O thread.
+        //! @param [in,out] report Where to report errors. Must remain valid until close().
+        //! @return True on success, false on error.
+        //!
+        bool open(Report& report);
+
+        //!
+        //! Close the buffer.
+        //! The I/O thread is terminated and the segment files are deleted.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool close(Report& report);
+
+        //!
+        //! Check if the buffer is open.
+        //! @return True if the buffer is open.
+        //!
+        bool isOpen() const { return _is_open; }
+
+        //!
+        //! Get the capacity of the buffer in packets.
+        //! @return The maximum number of packets in the buffer.
+        //!
+        PacketCounter size() const;
+
+        //!
+        //! Get the number of packets between the playout position and the last written packet.
+        //! @return The number of packets which remain to be read.
+        //!
+        PacketCounter count() const { return _write_index - _read_index; }
+
+        //!
+        //! Check if there is no packet to read.
+        //! @return True when there is no packet to read.
+        //!
+        bool empty() const { return _read_index >= _write_index; }
+
+        //!
+        //! Get the number of packets which were lost because they were overwritten before being read.
+        //! @return The number of lost packets.
+        //!
+        PacketCounter lostPackets() const { return _lost_packets; }
+
+        //!
+        //! Write a packet at the end of the buffer.
+        //! When the buffer is full, the oldest block is overwritten. If the playout
+        //! position was in this block, it moves to the next one and packets are lost.
+        //! @param [in] pkt The packet to write.
+        //! @param [in] timestamp Time stamp of the packet in PCR units, INVALID_PCR if unknown.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool write(const TSPacket& pkt, uint64_t timestamp, Report& report);
+
+        //!
+        //! Read the packet at the playout position and move to the next one.
+        //! @param [out] pkt The returned packet.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error or if there is no packet to read.
+        //!
+        bool read(TSPacket& pkt, Report& report);
+
+        //!
+        //! Get the time stamp of the oldest packet in the buffer.
+        //! @return The time stamp of the oldest packet in PCR units or INVALID_PCR if unknown.
+        //!
+        uint64_t firstTimeStamp() const;
+
+        //!
+        //! Get the time stamp of the last written packet.
+        //! @return The time stamp of the last written packet in PCR units or INVALID_PCR if unknown.
+        //!
+        uint64_t lastTimeStamp() const { return _last_time; }
+
+        //!
+        //! Move the playout position to a given time stamp.
+        //! The position is computed from the time index, by interpolation inside a block.
+        //! @param [in] timestamp Time stamp in PCR units. When it is outside the buffer, the
+        //! playout position is set to the oldest or last packet.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false if the time index is unknown.
+        //!
+        bool seekTimeStamp(uint64_t timestamp, Report& report);
+
+    private:
+        class IOThread;
+
+        // State of a block in memory.
+        enum BlockState {
+            FILLING,   // Current write block, owned by the application thread.
+            DIRTY,     // Complete block, to be written on disk.
+            CLEAN,     // Block which is identical on disk.
+            LOADING,   // Block being read from disk.
+        };
+
+        // A block of packets in memory.
+        struct Block
+        {
+            Block();
+            BlockState     state;    // Current state.
+            TSPacketVector packets;  // BLOCK_PACKETS packets.
+        };
+        typedef SafePtr<Block, NullMutex> BlockPtr;
+        typedef std::map<PacketCounter, BlockPtr> BlockMap;
+
+        // Configuration, set before open().
+        bool          _is_open;         // Buffer is open.
+        PacketCounter _min_packets;     // Requested minimum capacity.
+        size_t        _segment_count;   // Number of segment files.
+        size_t        _read_ahead;      // Read-ahead in blocks.
+        size_t        _write_behind;    // Max write-behind in blocks.
+        UString       _directory;       // Where to create the segment files.
+        size_t        _segment_blocks;  // Number of blocks per segment file.
+        size_t        _total_blocks;    // Number of blocks in the ring.
+        std::vector<TSFile> _files;     // Segment files, accessed by the I/O thread only.
+        Report*       _report;          // Where to report errors from the I/O thread.
+
+        // Application side, accessed without lock.
+        PacketCounter _write_index;     // Index of next packet to write (since open).
+        PacketCounter _read_index;      // Index of next packet to read (since open).
+        BlockPtr      _wblock;          // Current write block (FILLING state).
+        BlockPtr      _rblock;          // Current read block, null if not yet located.
+        uint64_t      _last_time;       // Time stamp of last written packet.
+        PacketCounter _lost_packets;    // Number of overwritten packets which were never read.
+
+        // Shared with the I/O thread, protected by _mutex.
+        mutable Mutex _mutex;           // Protect the shared state.
+        Condition     _work;            // Signaled by the application when the I/O thread has work.
+        Condition     _done;            // Signaled by the I/O thread when a block is written or read.
+        PacketCounter _write_block;     // Index of current write block.
+        PacketCounter _first_block;     // Index of oldest valid block in the ring.
+        PacketCounter _read_block;      // Index of current read block.
+        size_t        _dirty_count;     // Number of DIRTY blocks.
+        bool          _io_error;        // An I/O error occurred in the I/O thread.
+        bool          _terminate;       // Request termination of the I/O thread.
+        BlockMap      _blocks;          // Blocks in memory, indexed by block number.
+        std::list<BlockPtr> _free;      // Unused blocks, to avoid reallocation.
+        std::vector<uint64_t> _block_time; // Time stamp of first packet of each block in the ring.
+        IOThread*     _thread;          // The I/O thread.
+
+        // Get a block from the free list or allocate a new one (mutex held).
+        BlockPtr newBlock(BlockState state);
+
+        // Release blocks which are no longer useful (mutex held).
+        void releaseBlocks();
+
+        // Set the read position (mutex held).
+        void setReadIndex(PacketCounter index);
+
+        // Locate the current read block, waiting for the I/O thread if necessary.
+        bool locateReadBlock(Report& report);
+
+        // Body of the I/O thread.
+        void ioLoop();
+
+        // Read or write a block on disk (called by the I/O thread without mutex).
+        bool ioBlock(PacketCounter index, Block& block, bool write);
+    };
+}
@@ -41,7 +41,7 @@ TSDUCK_SOURCE;
 ts::T2MIDemux::PLPContext::PLPContext() :
     first_packet(true),
     ts(),
-    ts_next(0)
+    ts_size(0)
 {
 }
 
@@ -284,18 +284,24 @@ void ts::T2MIDemux::demuxTS(PID pid, PIDContext& pc, const T2MIPacket& pkt)
 
     if (syncd == 0xFFFF) {
         // No user packet in data field
-        plpp->ts.append(data, dfl);
+        addTS(*plpp, pkt, data, dfl);
     }
     else {
         // Synchronization distance in bytes, bounded by data field size.
         syncd = std::min(syncd / 8, dfl);
 
-        // Process end of previous packet.
-        if (!plpp->first_packet && syncd > 0) {
-            if (plpp->ts.size() % PKT_SIZE == 0) {
-                plpp->ts.append(SYNC_BYTE);
+        // Process end of previous packet. The end of packet must exactly complete the
+        // partial packet. Otherwise, some T2-MI packets were lost on this PLP and the
+        // partial packet is dropped, resynchronizing on the next user packet.
+        const size_t prefix = plpp->ts_size == 0 ? 1 : 0;
+        if (!plpp->first_packet && syncd > 0 && prefix + plpp->ts_size + syncd - npd == PKT_SIZE) {
+            if (prefix > 0) {
+                addTS(*plpp, pkt, &SYNC_BYTE, 1);
             }
-            plpp->ts.append(data, syncd - npd);
+            addTS(*plpp, pkt, data, syncd - npd);
+        }
+        else {
+            plpp->ts_size = 0;
         }
         plpp->first_packet = false;
         data += syncd;
@@ -303,44 +309,42 @@ void ts::T2MIDemux::demuxTS(PID pid, PIDContext& pc, const T2MIPacket& pkt)
 
         // Process subsequent complete packets.
         while (dfl >= PKT_SIZE - 1) {
-            plpp->ts.append(SYNC_BYTE);
-            plpp->ts.append(data, PKT_SIZE - 1);
+            addTS(*plpp, pkt, &SYNC_BYTE, 1);
+            addTS(*plpp, pkt, data, PKT_SIZE - 1);
             data += PKT_SIZE - 1;
             dfl -= PKT_SIZE - 1;
         }
 
         // Process optional trailing truncated packet.
         if (dfl > 0) {
-            plpp->ts.append(SYNC_BYTE);
-            plpp->ts.append(data, dfl);
+            addTS(*plpp, pkt, &SYNC_BYTE, 1);
+            addTS(*plpp, pkt, data, dfl);
         }
     }
+}
+
 
-    // Now process each complete TS packet.
-    while (plpp->ts_next + PKT_SIZE <= plpp->ts.size()) {
+//----------------------------------------------------------------------------
+// Accumulate TS data in a PLP context and notify complete TS packets.
+//----------------------------------------------------------------------------
 
-        // Build the TS packet.
-        TSPacket tsPkt;
-        ::memcpy(tsPkt.b, &plpp->ts[plpp->ts_next], PKT_SIZE);
-        plpp->ts_next += PKT_SIZE;
+void ts::T2MIDemux::addTS(PLPContext& plpc, const T2MIPacket& pkt, const uint8_t* data, size_t size)
+{
+    while (size > 0) {
+        const size_t chunk = std::min(size, PKT_SIZE - plpc.ts_size);
+        ::memcpy(plpc.ts.b + plpc.ts_size, data, chunk);
+        plpc.ts_size += chunk;
+        data += chunk;
+        size -= chunk;
 
         // Notify the application. Note that we are already in a protected section.
-        if (_handler != nullptr) {
-            _handler->handleTSPacket(*this, pkt, tsPkt);
+        if (plpc.ts_size == PKT_SIZE) {
+            plpc.ts_size = 0;
+            if (_handler != nullptr) {
+                _handler->handleTSPacket(*this, pkt, plpc.ts);
+            }
         }
     }
-
-    // Compress or cleanup the TS buffer.
-    if (plpp->ts_next >= plpp->ts.size()) {
-        // No more packet to output, cleanup.
-        plpp->ts.clear();
-        plpp->ts_next = 0;
-    }
-    else if (plpp->ts_next >= 100 * PKT_SIZE) {
-        // TS buffer has many unused packets, compress it.
-        plpp->ts.erase(0, plpp->ts_next);
-        plpp->ts_next = 0;
-    }
 }
 
 
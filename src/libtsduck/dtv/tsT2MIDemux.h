@@ -35,6 +35,7 @@
 #pragma once
 #include "tsAbstractDemux.h"
 #include "tsSectionDemux.h"
+#include "tsPIDIndexedMap.h"
 #include "tsPMT.h"
 #include "tsT2MIHandlerInterface.h"
 
@@ -94,11 +95,13 @@ namespace ts {
 
     private:
         // Analysis context for one PLP inside one T2-MI stream.
+        // TS packets are rebuilt in place and notified as soon as they are complete,
+        // there is never more than one partial TS packet per PLP.
         struct PLPContext
         {
-            bool      first_packet;  // First T2-MI packet not yet processed
-            ByteBlock ts;            // Buffer to accumulate extracted TS packets.
-            size_t    ts_next;       // Next packet to output.
+            bool     first_packet;  // First T2-MI packet not yet processed
+            TSPacket ts;            // Partial TS packet being rebuilt.
+            size_t   ts_size;       // Number of bytes in the partial TS packet.
 
             // Default constructor
             PLPContext();
@@ -125,7 +128,7 @@ namespace ts {
 
         // Map of safe pointers to PIDContext, indexed by PID.
         typedef SafePtr<PIDContext, NullMutex> PIDContextPtr;
-        typedef std::map<PID, PIDContextPtr> PIDContextMap;
+        typedef PIDIndexedMap<PIDContextPtr> PIDContextMap;
 
         // Inherited methods from TableHandlerInterface.
         virtual void handleTable(SectionDemux&, const BinaryTable&) override;
@@ -136,6 +139,9 @@ namespace ts {
         // Demux all encapsulated TS packets from a T2-MI packet.
         void demuxTS(PID pid, PIDContext& pc, const T2MIPacket& pkt);
 
+        // Accumulate TS data in a PLP context and notify complete TS packets.
+        void addTS(PLPContext& plpc, const T2MIPacket& pkt, const uint8_t* data, size_t size);
+
         // Process a PMT.
         void processPMT(const PMT& pmt);
 
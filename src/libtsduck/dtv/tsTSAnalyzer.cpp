@@ -99,6 +99,8 @@ ts::TSAnalyzer::TSAnalyzer(DuckContext& duck, BitRate bitrate_hint) :
     _pes_demux(_duck, this),
     _t2mi_demux(_duck, this)
 {
+    // Sections are only analyzed by the handlers, never kept. Avoid reallocating them.
+    _demux.setRecycleSections(true);
     resetSectionDemux();
 }
 
@@ -38,6 +38,7 @@
 #include "tsSectionDemux.h"
 #include "tsPESDemux.h"
 #include "tsT2MIDemux.h"
+#include "tsPIDIndexedMap.h"
 #include "tsPAT.h"
 #include "tsCAT.h"
 #include "tsPMT.h"
@@ -388,14 +389,14 @@ namespace ts {
         //!
         //! Map of PIDContext, indexed by PID.
         //!
-        typedef std::map <PID, PIDContextPtr> PIDContextMap;
+        typedef PIDIndexedMap<PIDContextPtr> PIDContextMap;
 
         //!
         //! Check if a PID context exists.
         //! @param [in] pid PID to search.
         //! @return True if the PID exists, false otherwise.
         //!
-        bool pidExists(PID pid) const {return _pids.find(pid) != _pids.end();}
+        bool pidExists(PID pid) const {return _pids.count(pid) > 0;}
 
         //!
         //! Get a PID context.
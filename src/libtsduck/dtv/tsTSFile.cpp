@@ -30,8 +30,125 @@
 #include "tsTSFile.h"
 #include "tsNullReport.h"
 #include "tsSysUtils.h"
+#include "tsSysInfo.h"
+#include "tsIntegerUtils.h"
+#include "tsThread.h"
+#include "tsTSPacketQueue.h"
+#if defined(TS_UNIX)
+#include <poll.h>
+#endif
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::TSFile::DEFAULT_READ_AHEAD_SIZE;
+constexpr size_t ts::TSFile::MIN_READ_AHEAD_SIZE;
+constexpr size_t ts::TSFile::DIRECT_IO_ALIGNMENT;
+#endif
+
+// Size of the aligned buffer for unaligned direct writes.
+namespace {
+    constexpr size_t DIRECT_BUFFER_SIZE = 16 * ts::TSFile::DIRECT_IO_ALIGNMENT;
+}
+
+
+//----------------------------------------------------------------------------
+// Read-ahead thread for non-mappable input files (UNIX only).
+//----------------------------------------------------------------------------
+
+#if !defined(TS_WINDOWS)
+
+class ts::TSFile::ReadAheadThread : public Thread
+{
+    TS_NOBUILD_NOCOPY(ReadAheadThread);
+public:
+    // Constructor & destructor.
+    ReadAheadThread(int fd, size_t size);
+    virtual ~ReadAheadThread() override;
+
+    // Packet queue between the read-ahead thread and the application.
+    TSPacketQueue queue;
+
+    // Error code which terminated the read-ahead thread.
+    volatile ErrorCode error_code;
+
+private:
+    int _fd;
+
+    // Polling interval while waiting for data, to check for stop requests.
+    static constexpr int POLL_MS = 100;
+
+    // Implementation of Thread.
+    virtual void main() override;
+};
+
+ts::TSFile::ReadAheadThread::ReadAheadThread(int fd, size_t size) :
+    Thread(),
+    queue(std::max<size_t>(size / PKT_SIZE, 1)),
+    error_code(SYS_SUCCESS),
+    _fd(fd)
+{
+}
+
+ts::TSFile::ReadAheadThread::~ReadAheadThread()
+{
+    queue.stop();
+    waitForTermination();
+}
+
+void ts::TSFile::ReadAheadThread::main()
+{
+    TSPacket partial;    // Incomplete packet at the end of the previous read.
+    size_t pending = 0;  // Number of bytes in partial.
+    TSPacket* buffer = nullptr;
+    size_t count = 0;
+    bool terminate = false;
+
+    while (!terminate && queue.lockWriteBuffer(buffer, count)) {
+
+        // Start with the incomplete packet from previous read.
+        uint8_t* const data = buffer->b;
+        const size_t max_size = count * PKT_SIZE;
+        ::memcpy(data, partial.b, pending);  // Flawfinder: ignore: memcpy()
+        size_t size = pending;
+
+        // Read until we get at least one complete packet.
+        while (!terminate && size < PKT_SIZE) {
+            ::pollfd pfd;
+            pfd.fd = _fd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            const int ready = ::poll(&pfd, 1, POLL_MS);
+            if (ready == 0 || (ready < 0 && LastErrorCode() == EINTR)) {
+                // Nothing to read yet, check if the application wants to stop.
+                terminate = queue.stopped();
+                continue;
+            }
+            const ssize_t insize = ::read(_fd, data + size, max_size - size);
+            if (insize > 0) {
+                size += size_t(insize);
+            }
+            else if (insize == 0) {
+                // End of file.
+                terminate = true;
+            }
+            else if (LastErrorCode() != EINTR && LastErrorCode() != EAGAIN) {
+                error_code = LastErrorCode();
+                terminate = true;
+            }
+        }
+
+        // Keep the trailing incomplete packet for next time.
+        pending = size % PKT_SIZE;
+        ::memcpy(partial.b, data + size - pending, pending);  // Flawfinder: ignore: memcpy()
+        queue.releaseWriteBuffer(size / PKT_SIZE);
+    }
+
+    // Report end of input to the application.
+    queue.setEOF();
+}
+
+#endif
+
 
 //----------------------------------------------------------------------------
 // Default constructor.
@@ -50,10 +167,23 @@ ts::TSFile::TSFile() :
     _at_eof(false),
     _aborted(false),
     _rewindable(false),
+    _read_ahead(false),
+    _read_ahead_size(DEFAULT_READ_AHEAD_SIZE),
 #if defined(TS_WINDOWS)
     _handle(INVALID_HANDLE_VALUE)
 #else
-    _fd(-1)
+    _fd(-1),
+    _direct(false),
+    _direct_buffer(),
+    _direct_tail(0),
+    _tail_on_disk(0),
+    _mapped(false),
+    _map_base(nullptr),
+    _map_offset(0),
+    _map_size(0),
+    _map_pos(0),
+    _file_size(0),
+    _reader(nullptr)
 #endif
 {
 }
@@ -76,10 +206,23 @@ ts::TSFile::TSFile(const TSFile& other) :
     _at_eof(false),
     _aborted(false),
     _rewindable(false),
+    _read_ahead(other._read_ahead),
+    _read_ahead_size(other._read_ahead_size),
 #if defined(TS_WINDOWS)
     _handle(INVALID_HANDLE_VALUE)
 #else
-    _fd(-1)
+    _fd(-1),
+    _direct(false),
+    _direct_buffer(),
+    _direct_tail(0),
+    _tail_on_disk(0),
+    _mapped(false),
+    _map_base(nullptr),
+    _map_offset(0),
+    _map_size(0),
+    _map_pos(0),
+    _file_size(0),
+    _reader(nullptr)
 #endif
 {
 }
@@ -102,10 +245,23 @@ ts::TSFile::TSFile(TSFile&& other) noexcept :
     _at_eof(other._at_eof),
     _aborted(other._aborted),
     _rewindable(other._rewindable),
+    _read_ahead(other._read_ahead),
+    _read_ahead_size(other._read_ahead_size),
 #if defined(TS_WINDOWS)
     _handle(other._handle)
 #else
-    _fd(other._fd)
+    _fd(other._fd),
+    _direct(other._direct),
+    _direct_buffer(std::move(other._direct_buffer)),
+    _direct_tail(other._direct_tail),
+    _tail_on_disk(other._tail_on_disk),
+    _mapped(other._mapped),
+    _map_base(other._map_base),
+    _map_offset(other._map_offset),
+    _map_size(other._map_size),
+    _map_pos(other._map_pos),
+    _file_size(other._file_size),
+    _reader(other._reader)
 #endif
 {
     // Mark other object as closed, just in case.
@@ -114,6 +270,10 @@ ts::TSFile::TSFile(TSFile&& other) noexcept :
     other._handle = INVALID_HANDLE_VALUE;
 #else
     other._fd = -1;
+    other._mapped = false;
+    other._map_base = nullptr;
+    other._map_size = 0;
+    other._reader = nullptr;
 #endif
 }
 
@@ -327,6 +487,11 @@ bool ts::TSFile::openInternal(Report& report)
     if (write_access && keep_file) {
         uflags |= O_EXCL;
     }
+#if defined(O_DIRECT)
+    if (write_access && (_flags & DIRECT) != 0) {
+        uflags |= O_DIRECT;
+    }
+#endif
 
     if (_filename.empty()) {
         // File name is empty means standard input or output. No need to open.
@@ -334,7 +499,16 @@ bool ts::TSFile::openInternal(Report& report)
     }
     else {
         // Open a named file.
-        if ((_fd = ::open(_filename.toUTF8().c_str(), uflags, mode)) < 0) {
+        _fd = ::open(_filename.toUTF8().c_str(), uflags, mode);
+#if defined(O_DIRECT)
+        // Some file systems do not support direct I/O, revert to normal I/O.
+        if (_fd < 0 && (uflags & O_DIRECT) != 0 && LastErrorCode() == EINVAL) {
+            report.debug(u"direct I/O not supported on %s", {getDisplayFileName()});
+            uflags &= ~O_DIRECT;
+            _fd = ::open(_filename.toUTF8().c_str(), uflags, mode);
+        }
+#endif
+        if (_fd < 0) {
             const ErrorCode err = LastErrorCode();
             report.log(_severity, u"cannot open file %s: %s", {getDisplayFileName(), ErrorCodeMessage(err)});
             return false;
@@ -383,6 +557,23 @@ bool ts::TSFile::openInternal(Report& report)
         return false;
     }
 
+    // Direct I/O can be used only on named files (not on standard output).
+#if defined(O_DIRECT)
+    _direct = !_filename.empty() && (uflags & O_DIRECT) != 0;
+#else
+    _direct = false;
+#endif
+    _direct_tail = _tail_on_disk = 0;
+    if (_direct) {
+        _direct_buffer.resize(DIRECT_BUFFER_SIZE + DIRECT_IO_ALIGNMENT);
+    }
+
+    // Setup the read-ahead mode on read-only files.
+    _mapped = false;
+    if (_read_ahead && read_only) {
+        startReadAhead(report);
+    }
+
 #endif
 
     _total_read = _total_write = 0;
@@ -404,7 +595,13 @@ bool ts::TSFile::seekInternal(uint64_t index, Report& report)
     ::LARGE_INTEGER offset(*(::LARGE_INTEGER*)(&where));
     if (::SetFilePointerEx(_handle, offset, NULL, FILE_BEGIN) == 0) {
 #else
-    if (::lseek(_fd, off_t(_start_offset + index), SEEK_SET) == off_t(-1)) {
+    if (_mapped) {
+        // Memory-mapped file, the window is remapped on next read if necessary.
+        _map_pos = _start_offset + index;
+        _at_eof = false;
+        return true;
+    }
+    else if (::lseek(_fd, off_t(_start_offset + index), SEEK_SET) == off_t(-1)) {
 #endif
         const ErrorCode err = LastErrorCode();
         report.log(_severity, u"error seeking file %s: %s", {getDisplayFileName(), ErrorCodeMessage(err)});
@@ -448,6 +645,13 @@ bool ts::TSFile::close(Report& report)
         return false;
     }
 
+#if !defined(TS_WINDOWS)
+    // Stop read-ahead before closing the file descriptor.
+    stopReadAhead();
+    _direct_buffer.clear();
+    _direct_tail = _tail_on_disk = 0;
+#endif
+
     if (!_filename.empty()) {
 #if defined(TS_WINDOWS)
         ::CloseHandle(_handle);
@@ -508,7 +712,29 @@ size_t ts::TSFile::read(TSPacket* buffer, size_t max_packets, Report& report)
         }
 #else
         // UNIX implementation
-        ssize_t insize = ::read(_fd, data + got_size, req_size - got_size);
+        ssize_t insize = 0;
+        if (_mapped) {
+            // Copy from the memory-mapped window.
+            insize = readMapped(reinterpret_cast<uint8_t*>(data + got_size), req_size - got_size, error_code);
+        }
+        else if (_reader != nullptr) {
+            // Get packets from the read-ahead thread.
+            assert(got_size % PKT_SIZE == 0);
+            size_t count = 0;
+            BitRate bitrate = 0;
+            if (_reader->queue.waitPackets(buffer + got_size / PKT_SIZE, max_packets - got_size / PKT_SIZE, count, bitrate)) {
+                insize = ssize_t(count * PKT_SIZE);
+            }
+            else if ((error_code = _reader->error_code) != SYS_SUCCESS) {
+                insize = -1;
+            }
+        }
+        else {
+            insize = ::read(_fd, data + got_size, req_size - got_size);
+            if (insize < 0) {
+                error_code = LastErrorCode();
+            }
+        }
         if (insize > 0) {
             // Normal case: some data were read
             got_size += insize;
@@ -517,7 +743,7 @@ size_t ts::TSFile::read(TSPacket* buffer, size_t max_packets, Report& report)
         else if (insize == 0) {
             _at_eof = true;
         }
-        else if ((error_code = LastErrorCode()) != EINTR) {
+        else if (error_code != EINTR) {
             // Actual error (not an interrupt)
             got_error = true;
         }
@@ -548,6 +774,61 @@ size_t ts::TSFile::read(TSPacket* buffer, size_t max_packets, Report& report)
 }
 
 
+//----------------------------------------------------------------------------
+// Preallocate disk space for the file.
+//----------------------------------------------------------------------------
+
+bool ts::TSFile::preallocate(PacketCounter packet_count, Report& report)
+{
+    if (!_is_open || (_flags & WRITE) == 0) {
+        report.log(_severity, u"file %s is not open for write", {getDisplayFileName()});
+        return false;
+    }
+
+    const uint64_t size = _start_offset + packet_count * PKT_SIZE;
+    ErrorCode err = SYS_SUCCESS;
+
+#if defined(TS_WINDOWS)
+    // Extend the file and restore the current position.
+    ::LARGE_INTEGER zero, current, end;
+    zero.QuadPart = 0;
+    end.QuadPart = ::LONGLONG(size);
+    if (::SetFilePointerEx(_handle, zero, &current, FILE_CURRENT) == 0 ||
+        ::SetFilePointerEx(_handle, end, NULL, FILE_BEGIN) == 0 ||
+        ::SetEndOfFile(_handle) == 0 ||
+        ::SetFilePointerEx(_handle, current, NULL, FILE_BEGIN) == 0)
+    {
+        err = LastErrorCode();
+    }
+#else
+#if defined(TS_LINUX)
+    // Actually allocate the disk space. Some file systems do not support it, revert to ftruncate().
+    err = ::posix_fallocate(_fd, 0, off_t(size));
+    if (err == EOPNOTSUPP || err == EINVAL) {
+        err = SYS_SUCCESS;
+    }
+    else if (err == SYS_SUCCESS) {
+        return true;
+    }
+#endif
+    // Only extend the file, never truncate it.
+    struct stat st;
+    if (err == SYS_SUCCESS && ::fstat(_fd, &st) < 0) {
+        err = LastErrorCode();
+    }
+    else if (err == SYS_SUCCESS && uint64_t(st.st_size) < size && ::ftruncate(_fd, off_t(size)) < 0) {
+        err = LastErrorCode();
+    }
+#endif
+
+    if (err != SYS_SUCCESS) {
+        report.log(_severity, u"error allocating %'d bytes in file %s: %s", {size, getDisplayFileName(), ErrorCodeMessage(err)});
+        return false;
+    }
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Write method
 //----------------------------------------------------------------------------
@@ -583,7 +864,7 @@ bool ts::TSFile::write(const TSPacket* buffer, size_t packet_count, Report& repo
             // Normal case, some data were written
             outsize = std::min(outsize, remain);
             data += outsize;
-            remain -= std::max(remain, outsize);
+            remain -= std::min(remain, outsize);
         }
         else if ((error_code = LastErrorCode()) == ERROR_BROKEN_PIPE || error_code == ERROR_NO_DATA) {
             // Broken pipe: error state but don't report error.
@@ -603,24 +884,16 @@ bool ts::TSFile::write(const TSPacket* buffer, size_t packet_count, Report& repo
 
     // UNIX implementation
     size_t remain = packet_count * PKT_SIZE;
-    ssize_t outsize = 0;
 
-    while (remain > 0 && !got_error) {
-        outsize = ::write(_fd, data, remain);
-        if (outsize > 0) {
-            // Normal case, some data were written
-            assert(size_t(outsize) <= remain);
-            data += outsize;
-            remain -= std::max(remain, size_t (outsize));
-        }
-        else if ((error_code = LastErrorCode()) != EINTR) {
-            // Actual error (not an interrupt)
-            report.debug(u"write error on %s, fd=%d, error_code=%d", {getDisplayFileName(), _fd, error_code});
-            got_error = true;
-            if (error_code == EPIPE) {
-                // Broken pipe: keep the error state but don't report error.
-                error_code = SYS_SUCCESS;
-            }
+    // With direct I/O, write complete aligned blocks first. Whatever remains, if direct I/O
+    // was refused in the meantime, is written using normal I/O.
+    if ((_direct && !writeDirect(data, remain, error_code)) || !writeFully(data, remain, error_code)) {
+        // Actual error (not an interrupt)
+        report.debug(u"write error on %s, fd=%d, error_code=%d", {getDisplayFileName(), _fd, error_code});
+        got_error = true;
+        if (error_code == EPIPE) {
+            // Broken pipe: keep the error state but don't report error.
+            error_code = SYS_SUCCESS;
         }
     }
 
@@ -650,8 +923,261 @@ void ts::TSFile::abort()
         ::CloseHandle(_handle);
         _handle = INVALID_HANDLE_VALUE;
 #else // UNIX
-        ::close(_fd);
-        _fd = -1;
+        if (_reader != nullptr) {
+            // Do not close the file under the feet of the read-ahead thread.
+            // Just wake it up, the file will be closed in close().
+            _reader->queue.stop();
+        }
+        else {
+            ::close(_fd);
+            _fd = -1;
+        }
 #endif
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Start the read-ahead mode on a file which is open in read-only mode.
+//----------------------------------------------------------------------------
+
+#if !defined(TS_WINDOWS)
+
+void ts::TSFile::startReadAhead(Report& report)
+{
+    struct stat st;
+    if (::fstat(_fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        // Regular file, use a memory-mapped window, rounded to the page size.
+        const size_t page_size = std::max<size_t>(SysInfo::Instance()->memoryPageSize(), 1);
+        _read_ahead_size = RoundUp(_read_ahead_size, page_size);
+        _mapped = true;
+        _map_base = nullptr;
+        _map_offset = _map_size = 0;
+        _map_pos = _start_offset;
+        _file_size = uint64_t(st.st_size);
+        report.debug(u"reading %s using memory-mapped windows of %'d bytes", {getDisplayFileName(), _read_ahead_size});
+    }
+    else {
+        // Other types of files, use a read-ahead thread.
+        _reader = new ReadAheadThread(_fd, _read_ahead_size);
+        if (_reader->start()) {
+            report.debug(u"reading %s using a read-ahead buffer of %'d bytes", {getDisplayFileName(), _read_ahead_size});
+        }
+        else {
+            report.debug(u"cannot start read-ahead thread on %s, using direct reads", {getDisplayFileName()});
+            delete _reader;
+            _reader = nullptr;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Stop the read-ahead mode.
+//----------------------------------------------------------------------------
+
+void ts::TSFile::stopReadAhead()
+{
+    if (_reader != nullptr) {
+        delete _reader;
+        _reader = nullptr;
+    }
+    unmapWindow();
+    _mapped = false;
+}
+
+
+//----------------------------------------------------------------------------
+// Revert to normal cached I/O after direct I/O.
+//----------------------------------------------------------------------------
+
+void ts::TSFile::disableDirectIO()
+{
+    setDirectFlag(false);
+    _direct = false;
+}
+
+void ts::TSFile::setDirectFlag(bool on)
+{
+#if defined(O_DIRECT)
+    const int flags = ::fcntl(_fd, F_GETFL);
+    if (flags != -1) {
+        ::fcntl(_fd, F_SETFL, on ? (flags | O_DIRECT) : (flags & ~O_DIRECT));
+    }
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Write all data on the file descriptor, retry on interrupt.
+// On return, data and size are updated to the unwritten part.
+//----------------------------------------------------------------------------
+
+bool ts::TSFile::writeFully(const char*& data, size_t& size, ErrorCode& error_code)
+{
+    while (size > 0) {
+        const ssize_t outsize = ::write(_fd, data, size);
+        if (outsize > 0) {
+            // Normal case, some data were written
+            assert(size_t(outsize) <= size);
+            data += outsize;
+            size -= std::min(size, size_t(outsize));
+        }
+        else if ((error_code = LastErrorCode()) == EINVAL && _direct) {
+            // Direct I/O refused, typically on unaligned file offset. Retry with normal I/O.
+            disableDirectIO();
+        }
+        else if (error_code != EINTR) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Direct I/O write: complete blocks are written with direct I/O, the trailing
+// incomplete block is kept in the aligned buffer and written through the cache.
+// Return when all data are written or when direct I/O is no longer possible.
+//----------------------------------------------------------------------------
+
+uint8_t* ts::TSFile::directBuffer()
+{
+    uint8_t* const base = _direct_buffer.data();
+    return base + (DIRECT_IO_ALIGNMENT - reinterpret_cast<uintptr_t>(base) % DIRECT_IO_ALIGNMENT) % DIRECT_IO_ALIGNMENT;
+}
+
+bool ts::TSFile::rewindTail(ErrorCode& error_code)
+{
+    // Move back before the incomplete block which was written through the cache.
+    if (_tail_on_disk > 0) {
+        if (::lseek(_fd, -off_t(_tail_on_disk), SEEK_CUR) == off_t(-1)) {
+            error_code = LastErrorCode();
+            return false;
+        }
+        _tail_on_disk = 0;
+    }
+    return true;
+}
+
+bool ts::TSFile::writeDirect(const char*& data, size_t& remain, ErrorCode& error_code)
+{
+    uint8_t* const buffer = directBuffer();
+
+    while (remain > 0 && _direct) {
+        if (_direct_tail == 0 && remain >= DIRECT_IO_ALIGNMENT && reinterpret_cast<uintptr_t>(data) % DIRECT_IO_ALIGNMENT == 0) {
+            // No pending incomplete block and aligned data: write complete blocks from the caller's buffer.
+            size_t size = remain - remain % DIRECT_IO_ALIGNMENT;
+            remain -= size;
+            const bool ok = writeFully(data, size, error_code);
+            remain += size;
+            if (!ok) {
+                return false;
+            }
+        }
+        else {
+            // Append data after the pending incomplete block in the aligned buffer.
+            const size_t count = std::min(remain, DIRECT_BUFFER_SIZE - _direct_tail);
+            ::memcpy(buffer + _direct_tail, data, count);  // Flawfinder: ignore: memcpy()
+            data += count;
+            remain -= count;
+            _direct_tail += count;
+
+            // Write all complete blocks, starting with the block which was previously written through the cache.
+            const size_t head = _direct_tail - _direct_tail % DIRECT_IO_ALIGNMENT;
+            if (head > 0) {
+                const char* addr = reinterpret_cast<const char*>(buffer);
+                size_t size = head;
+                if (!rewindTail(error_code) || !writeFully(addr, size, error_code)) {
+                    return false;
+                }
+                _direct_tail -= head;
+                ::memmove(buffer, buffer + head, _direct_tail);
+            }
+        }
+    }
+
+    // Write the incomplete block, if not yet done, through the cache so that all data are in the file.
+    if (_direct_tail > _tail_on_disk) {
+        const char* addr = reinterpret_cast<const char*>(buffer);
+        size_t size = _direct_tail;
+        if (!rewindTail(error_code)) {
+            return false;
+        }
+        setDirectFlag(false);
+        const bool ok = writeFully(addr, size, error_code);
+        if (_direct) {
+            setDirectFlag(true);
+        }
+        if (!ok) {
+            return false;
+        }
+        _tail_on_disk = _direct_tail;
+    }
+
+    // When direct I/O was refused, the pending block is in the file and no longer needed.
+    if (!_direct) {
+        _direct_tail = _tail_on_disk = 0;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Unmap the current memory-mapped window.
+//----------------------------------------------------------------------------
+
+void ts::TSFile::unmapWindow()
+{
+    if (_map_base != nullptr) {
+        ::munmap(_map_base, _map_size);
+        _map_base = nullptr;
+        _map_offset = _map_size = 0;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Read from a memory-mapped file.
+// Return the number of bytes, zero at end of file, -1 on error.
+//----------------------------------------------------------------------------
+
+ssize_t ts::TSFile::readMapped(uint8_t* data, size_t size, ErrorCode& error_code)
+{
+    // At end of known file size, check if the file has grown since.
+    if (_map_pos >= _file_size) {
+        struct stat st;
+        if (::fstat(_fd, &st) < 0 || uint64_t(st.st_size) <= _map_pos) {
+            return 0;
+        }
+        _file_size = uint64_t(st.st_size);
+    }
+
+    // Slide the memory-mapped window when the current position is outside.
+    if (_map_base == nullptr || _map_pos < _map_offset || _map_pos >= _map_offset + _map_size || _map_offset + _map_size < std::min(_file_size, _map_offset + _read_ahead_size)) {
+        unmapWindow();
+        const size_t page_size = std::max<size_t>(SysInfo::Instance()->memoryPageSize(), 1);
+        const uint64_t offset = _map_pos - _map_pos % page_size;
+        const size_t map_size = size_t(std::min<uint64_t>(_read_ahead_size, _file_size - offset));
+        void* const addr = ::mmap(nullptr, map_size, PROT_READ, MAP_SHARED, _fd, off_t(offset));
+        if (addr == MAP_FAILED) {
+            error_code = LastErrorCode();
+            return -1;
+        }
+        _map_base = reinterpret_cast<uint8_t*>(addr);
+        _map_offset = offset;
+        _map_size = map_size;
+        // Just hints, ignore errors: sequential access, start reading the window now.
+        ::madvise(addr, map_size, MADV_SEQUENTIAL);
+        ::madvise(addr, map_size, MADV_WILLNEED);
+    }
+
+    // Copy data from the window.
+    const size_t offset = size_t(_map_pos - _map_offset);
+    const size_t insize = std::min(size, _map_size - offset);
+    ::memcpy(data, _map_base + offset, insize);  // Flawfinder: ignore: memcpy()
+    _map_pos += insize;
+    return ssize_t(insize);
+}
+
+#endif
@@ -35,6 +35,7 @@
 #pragma once
 #include "tsTSPacket.h"
 #include "tsReport.h"
+#include "tsByteBlock.h"
 
 namespace ts {
     //!
@@ -107,6 +108,7 @@ namespace ts {
             KEEP      = 0x0008,   //!< Keep previous file with same name. Fail if it already exists.
             SHARED    = 0x0010,   //!< Write open with shared read for other processes. Windows only. Always shared on Unix.
             TEMPORARY = 0x0020,   //!< Temporary file, deleted on close, not always visible in the file system.
+            DIRECT    = 0x0040,   //!< Direct I/O on write, bypass the system cache when possible. Linux only. See write().
         };
 
         //!
@@ -138,6 +140,37 @@ namespace ts {
         //!
         void setErrorSeverityLevel(int level) { _severity = level; }
 
+        //!
+        //! Default size in bytes of the read window in read-ahead mode.
+        //!
+        static constexpr size_t DEFAULT_READ_AHEAD_SIZE = 32 * 1024 * 1024;
+
+        //!
+        //! Minimum size in bytes of the read window in read-ahead mode.
+        //!
+        static constexpr size_t MIN_READ_AHEAD_SIZE = 1024 * 1024;
+
+        //!
+        //! Enable or disable the read-ahead mode for input files.
+        //!
+        //! In read-ahead mode, a regular file is read through a memory-mapped window which
+        //! slides over the file and is advised for sequential access. Other files (pipes,
+        //! standard input, etc.) are read by an internal thread into a read-ahead buffer.
+        //! In both cases, most reads are satisfied without system call.
+        //!
+        //! This mode is used only on UNIX systems and with files which are opened in read-only
+        //! mode. It is ignored otherwise. A memory-mapped file must not be truncated while
+        //! it is being read.
+        //!
+        //! @param [in] on True to enable the read-ahead mode. It must be set before opening the file.
+        //! @param [in] size Size in bytes of the memory-mapped window or read-ahead buffer.
+        //!
+        void setReadAhead(bool on, size_t size = DEFAULT_READ_AHEAD_SIZE)
+        {
+            _read_ahead = on;
+            _read_ahead_size = std::max(size, MIN_READ_AHEAD_SIZE);
+        }
+
         //!
         //! Get the file name.
         //! @return The file name.
@@ -170,8 +203,19 @@ namespace ts {
         //!
         size_t read(TSPacket* buffer, size_t max_packets, Report& report);
 
+        //!
+        //! Alignment in bytes of buffer addresses and sizes for direct I/O.
+        //! @see DIRECT
+        //!
+        static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
         //!
         //! Write TS packets to the file.
+        //! When the file was opened with the DIRECT flag, complete blocks of DIRECT_IO_ALIGNMENT
+        //! bytes are written with direct I/O, directly from @a buffer when its address is aligned,
+        //! through an internal aligned buffer otherwise. A trailing incomplete block is written
+        //! through the system cache, so that all data are in the file when write() returns,
+        //! and is written again with direct I/O when it is completed by the next write.
         //! @param [in] buffer Address of first packet to write.
         //! @param [in] packet_count Number of packets to write.
         //! @param [in,out] report Where to report errors.
@@ -205,6 +249,19 @@ namespace ts {
         //!
         bool seek(PacketCounter packet_index, Report& report);
 
+        //!
+        //! Preallocate disk space for the file.
+        //! The file must be open for write. On Linux, the disk space is actually allocated
+        //! so that subsequent writes in this area cannot fail for lack of space. On other
+        //! systems, the file is only extended to the specified size. The current position
+        //! in the file is unchanged.
+        //! @param [in] packet_count Minimum number of packets in the file
+        //! (after the specified @a start_offset from open()).
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool preallocate(PacketCounter packet_count, Report& report);
+
         //!
         //! Get the number of read packets.
         //! @return The number of read packets.
@@ -232,15 +289,41 @@ namespace ts {
         volatile bool _at_eof;        //!< End of file has been reached
         volatile bool _aborted;       //!< Operation has been aborted, no operation available
         bool          _rewindable;    //!< Opened in rewindable mode
+        bool          _read_ahead;    //!< Use read-ahead mode when possible
+        size_t        _read_ahead_size; //!< Size of read-ahead window
 #if defined(TS_WINDOWS)
         ::HANDLE      _handle;        //!< File handle
 #else
         int           _fd;            //!< File descriptor
+        bool          _direct;        //!< Direct I/O is currently active on write
+        ByteBlock     _direct_buffer; //!< Buffer for unaligned direct writes (contains an aligned area)
+        size_t        _direct_tail;   //!< Size of the incomplete block at start of the aligned area
+        size_t        _tail_on_disk;  //!< Size of the incomplete block which was written through the cache
+        bool          _mapped;        //!< The file is read through a memory-mapped window
+        uint8_t*      _map_base;      //!< Address of the memory-mapped window, null if not mapped
+        uint64_t      _map_offset;    //!< Offset in file of the memory-mapped window
+        size_t        _map_size;      //!< Size in bytes of the memory-mapped window
+        uint64_t      _map_pos;       //!< Current read offset in the memory-mapped file
+        uint64_t      _file_size;     //!< Last known size of the memory-mapped file
+        class ReadAheadThread;
+        ReadAheadThread* _reader;     //!< Read-ahead thread for non-mappable input files
 #endif
 
         // Internal methods
         bool openInternal(Report& report);
         bool seekInternal(uint64_t index, Report& report);
+#if !defined(TS_WINDOWS)
+        void startReadAhead(Report& report);
+        void stopReadAhead();
+        ssize_t readMapped(uint8_t* data, size_t size, ErrorCode& error_code);
+        void unmapWindow();
+        void disableDirectIO();
+        void setDirectFlag(bool on);
+        uint8_t* directBuffer();
+        bool rewindTail(ErrorCode& error_code);
+        bool writeFully(const char*& data, size_t& size, ErrorCode& error_code);
+        bool writeDirect(const char*& data, size_t& remain, ErrorCode& error_code);
+#endif
 
         // Inaccessible operations.
         TSFile& operator=(TSFile&) = delete;
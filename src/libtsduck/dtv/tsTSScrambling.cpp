@@ -539,6 +539,20 @@ bool ts::TSScrambling::encrypt(TSPacket& pkt)
 }
 
 
+//----------------------------------------------------------------------------
+// Switch to the CW for a given scrambling control value in decryption.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::setDecryptParity(uint8_t scv)
+{
+    const uint8_t previous_scv = _decrypt_scv;
+    _decrypt_scv = scv;
+
+    // In case of fixed control word, use next key when the scrambling control changes.
+    return !hasFixedCW() || previous_scv == _decrypt_scv || setNextFixedCW(_decrypt_scv);
+}
+
+
 //----------------------------------------------------------------------------
 // Decrypt a TS packet with the CW corresponding to the parity in the packet.
 //----------------------------------------------------------------------------
@@ -552,11 +566,7 @@ bool ts::TSScrambling::decrypt(TSPacket& pkt)
     }
 
     // Update current parity.
-    const uint8_t previous_scv = _decrypt_scv;
-    _decrypt_scv = scv;
-
-    // In case of fixed control word, use next key when the scrambling control changes.
-    if (hasFixedCW() && previous_scv != _decrypt_scv && !setNextFixedCW(_decrypt_scv)) {
+    if (!setDecryptParity(scv)) {
         return false;
     }
 
@@ -582,3 +592,117 @@ bool ts::TSScrambling::decrypt(TSPacket& pkt)
     }
     return ok;
 }
+
+
+//----------------------------------------------------------------------------
+// Encrypt several TS packets with the current parity and corresponding CW.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::encrypt(TSPacket* const pkt[], size_t count)
+{
+    // Only DVB-CSA2 has a batch implementation, encrypt one by one otherwise.
+    if (!isDVBCSA2()) {
+        for (size_t i = 0; i < count; ++i) {
+            if (!encrypt(*pkt[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Filter out encrypted packets.
+    for (size_t i = 0; i < count; ++i) {
+        if (pkt[i]->isScrambled()) {
+            _report.error(u"try to scramble an already scrambled packet");
+            return false;
+        }
+    }
+
+    // If no current parity is set, start with even by default.
+    if (_encrypt_scv == SC_CLEAR && !setEncryptParity(SC_EVEN_KEY)) {
+        return false;
+    }
+    assert(_encrypt_scv == SC_EVEN_KEY || _encrypt_scv == SC_ODD_KEY);
+    DVBCSA2& algo(_dvbcsa[_encrypt_scv & 1]);
+
+    // Encrypt packets with payload by slices of DVBCSA2::MAX_BATCH_SIZE.
+    void* data[DVBCSA2::MAX_BATCH_SIZE];
+    size_t sizes[DVBCSA2::MAX_BATCH_SIZE];
+    TSPacket* done[DVBCSA2::MAX_BATCH_SIZE];
+    size_t n = 0;
+    for (size_t i = 0; i < count; ++i) {
+        // Silently pass packets without payload.
+        if (pkt[i]->hasPayload()) {
+            data[n] = pkt[i]->getPayload();
+            sizes[n] = pkt[i]->getPayloadSize();
+            done[n++] = pkt[i];
+        }
+        if (n > 0 && (n == DVBCSA2::MAX_BATCH_SIZE || i + 1 == count)) {
+            if (!algo.encryptInPlaceBatch(data, sizes, n)) {
+                _report.error(u"packet encryption error using %s", {algo.name()});
+                return false;
+            }
+            for (size_t k = 0; k < n; ++k) {
+                done[k]->setScrambling(_encrypt_scv);
+            }
+            n = 0;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Decrypt several TS packets with the CW corresponding to their parity.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::decrypt(TSPacket* const pkt[], size_t count)
+{
+    // Only DVB-CSA2 has a batch implementation, decrypt one by one otherwise.
+    if (!isDVBCSA2()) {
+        for (size_t i = 0; i < count; ++i) {
+            if (!decrypt(*pkt[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Decrypt sequences of packets with the same parity by slices of DVBCSA2::MAX_BATCH_SIZE.
+    // The order of parity changes is preserved because of the fixed CW's.
+    void* data[DVBCSA2::MAX_BATCH_SIZE];
+    size_t sizes[DVBCSA2::MAX_BATCH_SIZE];
+    TSPacket* done[DVBCSA2::MAX_BATCH_SIZE];
+    size_t n = 0;
+    uint8_t run_scv = SC_CLEAR;
+    for (size_t i = 0; i <= count; ++i) {
+
+        // Clear or invalid packets are silently accepted.
+        const uint8_t scv = i < count ? pkt[i]->getScrambling() : uint8_t(SC_CLEAR);
+        const bool scrambled = scv == SC_EVEN_KEY || scv == SC_ODD_KEY;
+
+        // Decrypt the current sequence when full, on parity change or at end.
+        if (n > 0 && (n == DVBCSA2::MAX_BATCH_SIZE || i == count || (scrambled && scv != run_scv))) {
+            if (!setDecryptParity(run_scv)) {
+                return false;
+            }
+            DVBCSA2& algo(_dvbcsa[run_scv & 1]);
+            if (!algo.decryptInPlaceBatch(data, sizes, n)) {
+                _report.error(u"packet decryption error using %s", {algo.name()});
+                return false;
+            }
+            for (size_t k = 0; k < n; ++k) {
+                done[k]->setScrambling(SC_CLEAR);
+            }
+            n = 0;
+        }
+
+        if (scrambled) {
+            run_scv = scv;
+            data[n] = pkt[i]->getPayload();
+            sizes[n] = pkt[i]->getPayloadSize();
+            done[n++] = pkt[i];
+        }
+    }
+    return true;
+}
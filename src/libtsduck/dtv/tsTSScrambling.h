@@ -192,6 +192,28 @@ namespace ts {
         //!
         bool decrypt(TSPacket& pkt);
 
+        //!
+        //! Encrypt several TS packets with the current parity and corresponding CW.
+        //! When the scrambling algorithm is DVB-CSA2, all packets are encrypted in
+        //! parallel, which is much faster than encrypting them one by one.
+        //! @param [in,out] pkt Array of addresses of the packets to encrypt.
+        //! @param [in] count Number of packets.
+        //! @return True on success, false on error. An already encrypted packet is an error.
+        //! On error, some packets may have been encrypted, others not.
+        //!
+        bool encrypt(TSPacket* const pkt[], size_t count);
+
+        //!
+        //! Decrypt several TS packets with the CW corresponding to the parity in each packet.
+        //! When the scrambling algorithm is DVB-CSA2, consecutive packets with the same parity
+        //! are decrypted in parallel.
+        //! @param [in,out] pkt Array of addresses of the packets to decrypt.
+        //! @param [in] count Number of packets.
+        //! @return True on success, false on error. Clear packets are not an error.
+        //! On error, some packets may have been decrypted, others not.
+        //!
+        bool decrypt(TSPacket* const pkt[], size_t count);
+
     private:
         // List of control words
         typedef std::list<ByteBlock> CWList;
@@ -215,6 +237,12 @@ namespace ts {
         // Set the next fixed control word as scrambling key.
         bool setNextFixedCW(int parity);
 
+        // Switch to the CW for a given scrambling control value in decryption.
+        bool setDecryptParity(uint8_t scv);
+
+        // Check if the current scrambling algorithm is DVB-CSA2.
+        bool isDVBCSA2() const { return _scrambler[0] == &_dvbcsa[0]; }
+
         // Implementation of BlockCipherAlertInterface.
         virtual bool handleBlockCipherAlert(BlockCipher& cipher, AlertReason reason) override;
 
@@ -42,12 +42,18 @@ const ts::Enumeration ts::hls::TagNames({
     {u"EXT-X-DATERANGE",              ts::hls::DATERANGE},
     {u"EXT-X-GAP",                    ts::hls::GAP},
     {u"EXT-X-BITRATE",                ts::hls::BITRATE},
+    {u"EXT-X-PART",                   ts::hls::PART},
+    {u"EXT-X-PRELOAD-HINT",           ts::hls::PRELOAD_HINT},
+    {u"EXT-X-SKIP",                   ts::hls::SKIP},
+    {u"EXT-X-RENDITION-REPORT",       ts::hls::RENDITION_REPORT},
     {u"EXT-X-TARGETDURATION",         ts::hls::TARGETDURATION},
     {u"EXT-X-MEDIA-SEQUENCE",         ts::hls::MEDIA_SEQUENCE},
     {u"EXT-X-DISCONTINUITY-SEQUENCE", ts::hls::DISCONTINUITY_SEQUENCE},
     {u"EXT-X-ENDLIST",                ts::hls::ENDLIST},
     {u"EXT-X-PLAYLIST-TYPE",          ts::hls::PLAYLIST_TYPE},
     {u"EXT-X-I-FRAMES-ONLY",          ts::hls::I_FRAMES_ONLY},
+    {u"EXT-X-PART-INF",               ts::hls::PART_INF},
+    {u"EXT-X-SERVER-CONTROL",         ts::hls::SERVER_CONTROL},
     {u"EXT-X-MEDIA",                  ts::hls::MEDIA},
     {u"EXT-X-STREAM-INF",             ts::hls::STREAM_INF},
     {u"EXT-X-I-FRAME-STREAM-INF",     ts::hls::I_FRAME_STREAM_INF},
@@ -76,12 +82,18 @@ namespace {
         {ts::hls::DATERANGE,              ts::hls::TAG_MEDIA},
         {ts::hls::GAP,                    ts::hls::TAG_MEDIA},
         {ts::hls::BITRATE,                ts::hls::TAG_MEDIA},
+        {ts::hls::PART,                   ts::hls::TAG_MEDIA},
+        {ts::hls::PRELOAD_HINT,           ts::hls::TAG_MEDIA},
+        {ts::hls::SKIP,                   ts::hls::TAG_MEDIA},
+        {ts::hls::RENDITION_REPORT,       ts::hls::TAG_MEDIA},
         {ts::hls::TARGETDURATION,         ts::hls::TAG_MEDIA},
         {ts::hls::MEDIA_SEQUENCE,         ts::hls::TAG_MEDIA},
         {ts::hls::DISCONTINUITY_SEQUENCE, ts::hls::TAG_MEDIA},
         {ts::hls::ENDLIST,                ts::hls::TAG_MEDIA},
         {ts::hls::PLAYLIST_TYPE,          ts::hls::TAG_MEDIA},
         {ts::hls::I_FRAMES_ONLY,          ts::hls::TAG_MEDIA},
+        {ts::hls::PART_INF,               ts::hls::TAG_MEDIA},
+        {ts::hls::SERVER_CONTROL,         ts::hls::TAG_MEDIA},
         {ts::hls::MEDIA,                  ts::hls::TAG_MASTER},
         {ts::hls::STREAM_INF,             ts::hls::TAG_MASTER},
         {ts::hls::I_FRAME_STREAM_INF,     ts::hls::TAG_MASTER},
@@ -73,6 +73,10 @@ namespace ts {
             DATERANGE,               //!< \#EXT-X-DATERANGE:attribute-list
             GAP,                     //!< \#EXT-X-GAP
             BITRATE,                 //!< \#EXT-X-BITRATE:rate
+            PART,                    //!< \#EXT-X-PART:attribute-list - partial segment (low-latency HLS).
+            PRELOAD_HINT,            //!< \#EXT-X-PRELOAD-HINT:attribute-list - next partial segment (low-latency HLS).
+            SKIP,                    //!< \#EXT-X-SKIP:attribute-list - skipped segments in playlist delta update (low-latency HLS).
+            RENDITION_REPORT,        //!< \#EXT-X-RENDITION-REPORT:attribute-list - state of other renditions (low-latency HLS).
             //
             // 4.3.3 Media Playlist Tags, global parameters of a Media Playlist.
             //
@@ -82,6 +86,8 @@ namespace ts {
             ENDLIST,                 //!< \#EXT-X-ENDLIST
             PLAYLIST_TYPE,           //!< \#EXT-X-PLAYLIST-TYPE:type (EVENT or VOD).
             I_FRAMES_ONLY,           //!< \#EXT-X-I-FRAMES-ONLY
+            PART_INF,                //!< \#EXT-X-PART-INF:attribute-list - partial segment information (low-latency HLS).
+            SERVER_CONTROL,          //!< \#EXT-X-SERVER-CONTROL:attribute-list - server capabilities (low-latency HLS).
             //
             // 4.3.4 Master Playlist Tags
             //
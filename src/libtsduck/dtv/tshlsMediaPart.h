@@ -0,0 +1,65 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Description of a partial segment in a low-latency HLS playlist.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tshls.h"
+#include "tsMPEG.h"
+
+namespace ts {
+    namespace hls {
+        //!
+        //! Description of a partial segment in a low-latency HLS playlist.
+        //! @ingroup hls
+        //!
+        class TSDUCKDLL MediaPart
+        {
+        public:
+            //!
+            //! Constructor.
+            //!
+            MediaPart();
+
+            // Public fields.
+            UString     uri;          //!< Relative URI of partial segment.
+            MilliSecond duration;     //!< Partial segment duration in milliseconds.
+            bool        independent;  //!< Partial segment starts with an independent frame.
+            bool        gap;          //!< Partial segment is not available.
+        };
+
+        //!
+        //! List of partial segments.
+        //!
+        typedef std::vector<MediaPart> MediaPartVector;
+    }
+}
@@ -40,6 +40,7 @@ ts::hls::MediaSegment::MediaSegment() :
     title(),
     duration(0),
     bitrate(0),
-    gap(false)
+    gap(false),
+    parts()
 {
 }
@@ -33,7 +33,7 @@
 //----------------------------------------------------------------------------
 
 #pragma once
-#include "tshls.h"
+#include "tshlsMediaPart.h"
 #include "tsMPEG.h"
 
 namespace ts {
@@ -51,11 +51,12 @@ namespace ts {
             MediaSegment();
 
             // Public fields.
-            UString     uri;       //!< Relative URI of segment.
-            UString     title;     //!< Optional segment title.
-            MilliSecond duration;  //!< Segment duration in milliseconds.
-            BitRate     bitrate;   //!< Indicative bitrate.
-            bool        gap;       //!< Media is a "gap", should not be loaded by clients.
+            UString         uri;       //!< Relative URI of segment.
+            UString         title;     //!< Optional segment title.
+            MilliSecond     duration;  //!< Segment duration in milliseconds.
+            BitRate         bitrate;   //!< Indicative bitrate.
+            bool            gap;       //!< Media is a "gap", should not be loaded by clients.
+            MediaPartVector parts;     //!< Partial segments of this segment (low-latency HLS).
         };
     }
 }
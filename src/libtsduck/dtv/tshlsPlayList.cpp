@@ -53,6 +53,9 @@ ts::hls::PlayList::PlayList() :
     _utcDownload(),
     _utcTermination(),
     _segments(),
+    _partTarget(0),
+    _partials(),
+    _preloadHint(),
     _playlists(),
     _loadedContent(),
     _autoSaveDir()
@@ -80,6 +83,9 @@ void ts::hls::PlayList::clear()
     _utcDownload = Time::Epoch;
     _utcTermination = Time::Epoch;
     _segments.clear();
+    _partTarget = 0;
+    _partials.clear();
+    _preloadHint.clear();
     _playlists.clear();
     _loadedContent.clear();
     // Preserve _autoSaveDir
@@ -133,6 +139,16 @@ bool ts::hls::PlayList::setTargetDuration(ts::Second duration, Report& report)
     return setMember(MEDIA_PLAYLIST, &PlayList::_targetDuration, duration, report);
 }
 
+bool ts::hls::PlayList::setPartTargetDuration(ts::MilliSecond duration, Report& report)
+{
+    return setMember(MEDIA_PLAYLIST, &PlayList::_partTarget, duration, report);
+}
+
+bool ts::hls::PlayList::setPreloadHint(const ts::UString& uri, Report& report)
+{
+    return setMember(MEDIA_PLAYLIST, &PlayList::_preloadHint, uri.empty() ? uri : relativeURI(uri), report);
+}
+
 bool ts::hls::PlayList::setMediaSequence(size_t seq, Report& report)
 {
     return setMember(MEDIA_PLAYLIST, &PlayList::_mediaSequence, seq, report);
@@ -230,10 +246,17 @@ bool ts::hls::PlayList::addSegment(const ts::hls::MediaSegment& seg, ts::Report&
         // Add the segment.
         _segments.push_back(seg);
         // Build a relative URI.
-        if (!_isURL && !_original.empty()) {
-            // The playlist's URI is a file name, update the segment's URI.
-            _segments.back().uri = RelativeFilePath(seg.uri, _fileBase, FileSystemCaseSensitivity, true);
+        _segments.back().uri = relativeURI(seg.uri);
+        // Attach the partial segments which were produced for this segment.
+        if (seg.parts.empty()) {
+            _segments.back().parts.swap(_partials);
         }
+        else {
+            for (auto it = _segments.back().parts.begin(); it != _segments.back().parts.end(); ++it) {
+                it->uri = relativeURI(it->uri);
+            }
+        }
+        _partials.clear();
         return true;
     }
     else {
@@ -242,6 +265,34 @@ bool ts::hls::PlayList::addSegment(const ts::hls::MediaSegment& seg, ts::Report&
 }
 
 
+bool ts::hls::PlayList::addPartialSegment(const ts::hls::MediaPart& part, ts::Report& report)
+{
+    if (part.uri.empty()) {
+        report.error(u"empty partial segment URI");
+        return false;
+    }
+    else if (setType(MEDIA_PLAYLIST, report)) {
+        _partials.push_back(part);
+        _partials.back().uri = relativeURI(part.uri);
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Build a relative URI from the playlist's path, when the playlist is a file.
+//----------------------------------------------------------------------------
+
+ts::UString ts::hls::PlayList::relativeURI(const ts::UString& uri) const
+{
+    // If the playlist's URI is a file name, build a relative URI.
+    return _isURL || _original.empty() ? uri : RelativeFilePath(uri, _fileBase, FileSystemCaseSensitivity, true);
+}
+
+
 bool ts::hls::PlayList::addPlayList(const ts::hls::MediaPlayList& pl, ts::Report& report)
 {
     if (pl.uri.empty()) {
@@ -708,6 +759,12 @@ bool ts::hls::PlayList::parse(bool strict, Report& report)
                 case INDEPENDENT_SEGMENTS:
                 case START:
                 case DEFINE:
+                case PART:
+                case PRELOAD_HINT:
+                case SKIP:
+                case RENDITION_REPORT:
+                case PART_INF:
+                case SERVER_CONTROL:
                     // Currently ignored tags.
                     break;
                 default:
@@ -1004,8 +1061,28 @@ ts::UString ts::hls::PlayList::textContent(ts::Report &report) const
                 text.append(UString::Format(u"#%s:%s\n", {TagNames.name(PLAYLIST_TYPE), _playlistType}));
             }
 
+            // Low-latency HLS global tags. The recommended hold back is three part target durations.
+            if (_partTarget > 0) {
+                const MilliSecond holdBack = 3 * _partTarget;
+                text.append(UString::Format(u"#%s:PART-HOLD-BACK=%d.%03d\n", {TagNames.name(SERVER_CONTROL), holdBack / MilliSecPerSec, holdBack % MilliSecPerSec}));
+                text.append(UString::Format(u"#%s:PART-TARGET=%d.%03d\n", {TagNames.name(PART_INF), _partTarget / MilliSecPerSec, _partTarget % MilliSecPerSec}));
+            }
+
+            // Partial segments are listed only for segments which are less than three target durations
+            // from the end of the playlist. Compute the duration from the start of each segment to the end.
+            MilliSecond remaining = 0;
+            if (_partTarget > 0) {
+                for (auto it = _segments.begin(); it != _segments.end(); ++it) {
+                    remaining += it->duration;
+                }
+            }
+
             // Loop on all media segments.
             for (auto it = _segments.begin(); it != _segments.end(); ++it) {
+                if (_partTarget > 0 && remaining <= 3 * _targetDuration * MilliSecPerSec) {
+                    AppendParts(text, it->parts);
+                }
+                remaining -= it->duration;
                 if (!it->uri.empty()) {
                     text.append(UString::Format(u"#%s:%d.%03d,%s\n", {TagNames.name(EXTINF), it->duration / MilliSecPerSec, it->duration % MilliSecPerSec, it->title}));
                     if (it->bitrate > 1024) {
@@ -1018,6 +1095,14 @@ ts::UString ts::hls::PlayList::textContent(ts::Report &report) const
                 }
             }
 
+            // Partial segments of the next segment and hint for the next partial segment.
+            if (_partTarget > 0 && !_endList) {
+                AppendParts(text, _partials);
+                if (!_preloadHint.empty()) {
+                    text.append(UString::Format(u"#%s:TYPE=PART,URI=\"%s\"\n", {TagNames.name(PRELOAD_HINT), _preloadHint}));
+                }
+            }
+
             // Mark end of list when necessary.
             if (_endList) {
                 text.append(UString::Format(u"#%s\n", {TagNames.name(ENDLIST)}));
@@ -1033,3 +1118,24 @@ ts::UString ts::hls::PlayList::textContent(ts::Report &report) const
 
     return text;
 }
+
+
+//----------------------------------------------------------------------------
+// Append the description of partial segments to a playlist text.
+//----------------------------------------------------------------------------
+
+void ts::hls::PlayList::AppendParts(UString& text, const MediaPartVector& parts)
+{
+    for (auto it = parts.begin(); it != parts.end(); ++it) {
+        if (!it->uri.empty()) {
+            text.append(UString::Format(u"#%s:DURATION=%d.%03d,URI=\"%s\"", {TagNames.name(PART), it->duration / MilliSecPerSec, it->duration % MilliSecPerSec, it->uri}));
+            if (it->independent) {
+                text.append(u",INDEPENDENT=YES");
+            }
+            if (it->gap) {
+                text.append(u",GAP=YES");
+            }
+            text.append(u'\n');
+        }
+    }
+}
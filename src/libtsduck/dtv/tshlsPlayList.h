@@ -214,6 +214,22 @@ namespace ts {
             //!
             bool setMediaSequence(size_t seq, Report& report = CERR);
 
+            //!
+            //! Get the partial segment target duration (low-latency HLS, in media playlist).
+            //! @return The partial segment target duration in milliseconds, zero if there is no partial segment.
+            //!
+            MilliSecond partTargetDuration() const { return _partTarget; }
+
+            //!
+            //! Set the partial segment target duration in a media playlist.
+            //! When non zero, the playlist is a low-latency HLS one and contains
+            //! \#EXT-X-PART-INF and \#EXT-X-SERVER-CONTROL tags.
+            //! @param [in] duration The partial segment target duration in milliseconds.
+            //! @param [in,out] report Where to report errors.
+            //! @return True on success, false on error.
+            //!
+            bool setPartTargetDuration(MilliSecond duration, Report& report = CERR);
+
             //!
             //! Get the end of list indicator (in media playlist).
             //! @return The end of list indicator. If true, there is no need to reload
@@ -290,6 +306,32 @@ namespace ts {
             //!
             bool addSegment(const MediaSegment& seg, Report& report = CERR);
 
+            //!
+            //! Add a partial segment to the media segment which is currently being produced (low-latency HLS).
+            //! The partial segments are listed after the last complete segment. When the
+            //! enclosing segment is complete, addSegment() attaches them to the new segment.
+            //! @param [in] part The new partial segment to append. If the playlist's URI is a file
+            //! name, the URI of the part is transformed into a relative URI from the playlist's path.
+            //! @param [in,out] report Where to report errors.
+            //! @return True on success, false on error.
+            //!
+            bool addPartialSegment(const MediaPart& part, Report& report = CERR);
+
+            //!
+            //! Get the number of partial segments in the media segment which is currently being produced.
+            //! @return The number of partial segments.
+            //!
+            size_t partialSegmentCount() const { return _partials.size(); }
+
+            //!
+            //! Set the URI of the next partial segment, in a \#EXT-X-PRELOAD-HINT tag (low-latency HLS).
+            //! @param [in] uri URI of the next partial segment. If the playlist's URI is a file name,
+            //! it is transformed into a relative URI from the playlist's path. If empty, there is no hint.
+            //! @param [in,out] report Where to report errors.
+            //! @return True on success, false on error.
+            //!
+            bool setPreloadHint(const UString& uri, Report& report = CERR);
+
             //!
             //! Get the download UTC time of the playlist.
             //! @return The download UTC time of the playlist.
@@ -390,6 +432,9 @@ namespace ts {
             Time               _utcDownload;     // UTC time of download.
             Time               _utcTermination;  // UTC time of termination (download + all segment durations).
             MediaSegmentQueue  _segments;        // List of media segments (media playlist).
+            MilliSecond        _partTarget;      // Partial segment target duration (low-latency media playlist).
+            MediaPartVector    _partials;        // Partial segments of the next segment, not yet complete (low-latency media playlist).
+            UString            _preloadHint;     // URI of next partial segment (low-latency media playlist).
             MediaPlayListQueue _playlists;       // List of media playlists (master playlist).
             UStringList        _loadedContent;   // Loaded text content (can be different from current content).
             UString            _autoSaveDir;     // If not empty, automatically save loaded playlist to this directory.
@@ -412,6 +457,12 @@ namespace ts {
             // Perform automatic save of the loaded playlist.
             bool autoSave(Report& report);
 
+            // Build a relative URI from the playlist's path, when the playlist is a file.
+            UString relativeURI(const UString& uri) const;
+
+            // Append the description of partial segments to a playlist text.
+            static void AppendParts(UString& text, const MediaPartVector& parts);
+
             // Set a member with a given playlist type.
             template <typename T>
             bool setMember(PlayListType requiredType, T PlayList::* member, const T& value, Report& report)
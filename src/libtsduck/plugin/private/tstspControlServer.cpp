@@ -35,6 +35,12 @@
 #include "tsTelnetConnection.h"
 #include "tsGuard.h"
 #include "tsSysUtils.h"
+#include "tsjsonObject.h"
+#include "tsjsonArray.h"
+#include "tsjsonNumber.h"
+#include "tsjsonString.h"
+#include "tsjsonTrue.h"
+#include "tsjsonFalse.h"
 TSDUCK_SOURCE;
 
 
@@ -58,7 +64,8 @@ ts::tsp::ControlServer::ControlServer(TSProcessorArgs& options, Report& log, Mut
               {TSPControlCommand::CMD_LIST,    &ControlServer::executeList},
               {TSPControlCommand::CMD_SUSPEND, &ControlServer::executeSuspend},
               {TSPControlCommand::CMD_RESUME,  &ControlServer::executeResume},
-              {TSPControlCommand::CMD_RESTART, &ControlServer::executeRestart}}
+              {TSPControlCommand::CMD_RESTART, &ControlServer::executeRestart},
+              {TSPControlCommand::CMD_STATS,   &ControlServer::executeStats}}
 {
     // Locate output plugin, count packet processor plugins.
     if (_input != nullptr) {
@@ -356,3 +363,111 @@ void ts::tsp::ControlServer::executeRestart(const Args* args, Report& response)
         plugin->restart(params, response);
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Get a plugin executor by index, in the same order as the list command.
+//----------------------------------------------------------------------------
+
+ts::tsp::PluginExecutor* ts::tsp::ControlServer::pluginByIndex(size_t index, UChar& type) const
+{
+    if (index == 0) {
+        type = u'I';
+        return _input;
+    }
+    else if (index <= _plugins.size()) {
+        type = u'P';
+        return _plugins[index-1];
+    }
+    else if (index == _plugins.size() + 1) {
+        type = u'O';
+        return _output;
+    }
+    else {
+        return nullptr;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Stats command.
+//----------------------------------------------------------------------------
+
+void ts::tsp::ControlServer::executeStats(const Args* args, Report& response)
+{
+    // Range of plugins to display.
+    size_t first = 0;
+    size_t last = _plugins.size() + 1;
+    if (args->present(u"")) {
+        first = last = args->intValue<size_t>(u"");
+        if (first > _plugins.size() + 1) {
+            response.error(u"invalid plugin index %d, specify 0 to %d", {first, _plugins.size() + 1});
+            return;
+        }
+    }
+
+    const bool json = args->present(u"json");
+    const bool reset = args->present(u"reset");
+    const bool verbose = response.verbose();
+    json::Array* list = json ? new json::Array : nullptr;
+    json::ValuePtr list_ptr(list);
+
+    for (size_t index = first; index <= last; ++index) {
+        UChar type = u' ';
+        PluginExecutor* const plugin = pluginByIndex(index, type);
+        PluginExecutor::Telemetry tm;
+        plugin->getTelemetry(tm);
+        if (reset) {
+            plugin->resetTelemetry();
+        }
+
+        // Sum of histogram samples, for percentages.
+        uint64_t samples = 0;
+        for (size_t i = 0; i < PluginExecutor::OCCUPANCY_BUCKETS; ++i) {
+            samples += tm.occupancy[i];
+        }
+
+        if (json) {
+            json::Object* obj = new json::Object;
+            json::Array* occ = new json::Array;
+            for (size_t i = 0; i < PluginExecutor::OCCUPANCY_BUCKETS; ++i) {
+                occ->set(json::ValuePtr(new json::Number(int64_t(tm.occupancy[i]))));
+            }
+            obj->add(u"index", json::ValuePtr(new json::Number(int64_t(index))));
+            obj->add(u"type", json::ValuePtr(new json::String(type == u'I' ? u"input" : (type == u'O' ? u"output" : u"processor"))));
+            obj->add(u"name", json::ValuePtr(new json::String(plugin->pluginName())));
+            obj->add(u"suspended", plugin->getSuspended() ? json::ValuePtr(new json::True) : json::ValuePtr(new json::False));
+            obj->add(u"elapsed_ns", json::ValuePtr(new json::Number(tm.elapsed)));
+            obj->add(u"plugin_ns", json::ValuePtr(new json::Number(tm.plugin_time)));
+            obj->add(u"wait_ns", json::ValuePtr(new json::Number(tm.wait_time)));
+            obj->add(u"max_call_ns", json::ValuePtr(new json::Number(tm.max_call_time)));
+            obj->add(u"calls", json::ValuePtr(new json::Number(int64_t(tm.calls))));
+            obj->add(u"waits", json::ValuePtr(new json::Number(int64_t(tm.waits))));
+            obj->add(u"plugin_packets", json::ValuePtr(new json::Number(int64_t(tm.plugin_packets))));
+            obj->add(u"total_packets", json::ValuePtr(new json::Number(int64_t(tm.total_packets))));
+            obj->add(u"occupancy", json::ValuePtr(occ));
+            list->set(json::ValuePtr(obj));
+        }
+        else {
+            const int busy = tm.elapsed <= 0 ? 0 : int((1000 * tm.plugin_time) / tm.elapsed);
+            const int wait = tm.elapsed <= 0 ? 0 : int((1000 * tm.wait_time) / tm.elapsed);
+            response.info(u"%2d: %c-%-12s busy: %3d.%d%%, waiting: %3d.%d%%, packets: %'d, calls: %'d, %'d ns/packet, max call: %'d us", {
+                          index, type, plugin->pluginName(),
+                          busy / 10, busy % 10, wait / 10, wait % 10,
+                          tm.plugin_packets, tm.calls,
+                          tm.plugin_packets == 0 ? 0 : tm.plugin_time / NanoSecond(tm.plugin_packets),
+                          tm.max_call_time / NanoSecPerMicroSec});
+            if (verbose && samples > 0) {
+                UString line;
+                for (size_t i = 0; i < PluginExecutor::OCCUPANCY_BUCKETS; ++i) {
+                    line += UString::Format(u" %3d%%", {(100 * tm.occupancy[i] + samples / 2) / samples});
+                }
+                response.info(u"    %s area occupancy (10%% steps):%s", {type == u'I' ? u"free" : u"packet", line});
+            }
+        }
+    }
+
+    if (json) {
+        response.info(list->printed(2, response));
+    }
+}
@@ -98,19 +98,23 @@ bool ts::tsp::InputExecutor::initAllBuffers(PacketBuffer* buffer, PacketMetadata
         verbose(u"initial input bitrate is %'d b/s", {init_bitrate});
     }
 
-    // Indicate that the loaded packets are now available to the next packet processor.
-    PluginExecutor* next = ringNext<PluginExecutor>();
-    next->initBuffer(buffer, metadata, 0, pkt_read, pkt_read == 0, pkt_read == 0, init_bitrate);
-
-    // The rest of the buffer belongs to this input processor for reading additional packets.
-    initBuffer(buffer, metadata, pkt_read % buffer->count(), buffer->count() - pkt_read, pkt_read == 0, pkt_read == 0, init_bitrate);
-
     // All other processors have an implicit empty buffer (_pkt_first and _pkt_cnt are zero).
     // Propagate initial input bitrate to all processors
+    PluginExecutor* next = this;
     while ((next = next->ringNext<PluginExecutor>()) != this) {
         next->initBuffer(buffer, metadata, 0, 0, pkt_read == 0, pkt_read == 0, init_bitrate);
     }
 
+    // Indicate that the loaded packets are now available to the next packet processor.
+    // When the input is followed by parallel branches, the packets are available to all branches.
+    const std::vector<PluginExecutor*>& next_list(nextExecutors());
+    for (auto it = next_list.begin(); it != next_list.end(); ++it) {
+        (*it)->initBuffer(buffer, metadata, 0, pkt_read, pkt_read == 0, pkt_read == 0, init_bitrate);
+    }
+
+    // The rest of the buffer belongs to this input processor for reading additional packets.
+    initBuffer(buffer, metadata, pkt_read % buffer->count(), buffer->count() - pkt_read, pkt_read == 0, pkt_read == 0, init_bitrate);
+
     return true;
 }
 
@@ -212,7 +216,9 @@ size_t ts::tsp::InputExecutor::receiveAndValidate(size_t index, size_t max_packe
     if (_use_watchdog) {
         _watchdog.restart();
     }
+    const Monotonic start(true);
     size_t count = _input->receive(pkt, data, max_packets);
+    addPluginCall(start);
     if (_use_watchdog) {
         _watchdog.suspend();
     }
@@ -50,14 +50,33 @@ ts::tsp::PluginExecutor::PluginExecutor(const TSProcessorArgs& options,
     _buffer(nullptr),
     _metadata(nullptr),
     _suspended(false),
+    _in_branch(false),
+    _next_executors(),
+    _prev_executors(),
+    _join(),
+    _join_index(0),
+    _work_mutex(),
     _to_do(),
+    _sleeping(false),
+    _spin_count(MIN_SPIN_COUNT),
     _pkt_first(0),
     _pkt_cnt(0),
     _input_end(false),
     _bitrate(0),
     _restart(false),
-    _restart_data()
+    _restart_data(),
+    _tm_origin(true),
+    _tm_start(0),
+    _tm_plugin_time(0),
+    _tm_wait_time(0),
+    _tm_max_call_time(0),
+    _tm_calls(0),
+    _tm_waits(0),
+    _tm_plugin_packets(0),
+    _tm_total_packets(0),
+    _tm_occupancy()
 {
+    resetTelemetry();
 }
 
 ts::tsp::PluginExecutor::~PluginExecutor()
@@ -78,6 +97,14 @@ void ts::tsp::PluginExecutor::initBuffer(PacketBuffer* buffer,
                                          bool          aborted,
                                          BitRate       bitrate)
 {
+    // Without parallel branches, the neighbours are in the ring.
+    if (_next_executors.empty()) {
+        _next_executors.push_back(ringNext<PluginExecutor>());
+    }
+    if (_prev_executors.empty()) {
+        _prev_executors.push_back(ringPrevious<PluginExecutor>());
+    }
+
     _buffer = buffer;
     _metadata = metadata;
     _pkt_first = pkt_first;
@@ -100,22 +127,22 @@ bool ts::tsp::PluginExecutor::passPackets(size_t count, BitRate bitrate, bool in
 
     log(10, u"passPackets(count = %'d, bitrate = %'d, input_end = %s, aborted = %s)", {count, bitrate, input_end, aborted});
 
-    // We access data under the protection of the global mutex.
-    Guard lock(_global_mutex);
+    // No global mutex here. We are the only consumer of our area and the only producer
+    // of the next processor's area. All shared counters are atomic.
 
     // Update our buffer
     _pkt_first = (_pkt_first + count) % _buffer->count();
     _pkt_cnt -= count;
 
-    // Update next processor's buffer.
-    PluginExecutor* next = ringNext<PluginExecutor>();
-    next->_pkt_cnt += count;
-    next->_input_end = next->_input_end || input_end;
-    next->_bitrate = bitrate;
-
-    // Wake the next processor when there is some data
-    if (count > 0 || input_end) {
-        next->_to_do.signal();
+    // Update next processors' buffers.
+    if (_join.isNull()) {
+        for (auto it = _next_executors.begin(); it != _next_executors.end(); ++it) {
+            passTo(*it, count, bitrate, input_end);
+        }
+    }
+    else {
+        // Last executor in a parallel branch.
+        _join->pass(_join_index, count, bitrate, input_end);
     }
 
     // Force to abort our processor when the next one is aborting.
@@ -123,13 +150,15 @@ bool ts::tsp::PluginExecutor::passPackets(size_t count, BitRate bitrate, bool in
     // Don't do that if current is output and next is input because
     // there is no propagation of packets from output back to input.
     if (plugin()->type() != OUTPUT_PLUGIN) {
-        aborted = aborted || next->_tsp_aborting;
+        aborted = aborted || nextAborting();
     }
 
-    // Wake the previous processor when we abort
+    // Wake the previous processors when we abort
     if (aborted) {
         _tsp_aborting = true; // volatile bool in TSP superclass
-        ringPrevious<PluginExecutor>()->_to_do.signal();
+        for (auto it = _prev_executors.begin(); it != _prev_executors.end(); ++it) {
+            (*it)->wakeUp(true);
+        }
     }
 
     // Return false when the current processor shall stop.
@@ -143,9 +172,142 @@ bool ts::tsp::PluginExecutor::passPackets(size_t count, BitRate bitrate, bool in
 
 void ts::tsp::PluginExecutor::setAbort()
 {
-    Guard lock(_global_mutex);
     _tsp_aborting = true;
-    ringPrevious<PluginExecutor>()->_to_do.signal();
+    if (_prev_executors.empty()) {
+        // Topology not yet initialized.
+        ringPrevious<PluginExecutor>()->wakeUp(true);
+    }
+    for (auto it = _prev_executors.begin(); it != _prev_executors.end(); ++it) {
+        (*it)->wakeUp(true);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Pass packets to one next executor.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::passTo(PluginExecutor* next, size_t count, BitRate bitrate, bool input_end)
+{
+    // The end of input must be published after the last packets so that the next
+    // processor never sees the end flag before the last packets are counted in its area.
+    next->_bitrate = bitrate;
+    next->_pkt_cnt += count;
+    if (input_end) {
+        next->_input_end = true;
+    }
+
+    // Wake the next processor when there is some data
+    if (count > 0 || input_end) {
+        next->wakeUp(false);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check if any of the next executors is aborting.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::PluginExecutor::nextAborting() const
+{
+    for (auto it = _next_executors.begin(); it != _next_executors.end(); ++it) {
+        if ((*it)->_tsp_aborting) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Build parallel branches.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::forkBranches(const std::vector<PluginExecutor*>& heads)
+{
+    _next_executors = heads;
+    for (auto it = heads.begin(); it != heads.end(); ++it) {
+        (*it)->_prev_executors.assign(1, this);
+    }
+}
+
+void ts::tsp::PluginExecutor::JoinBranches(const std::vector<PluginExecutor*>& tails, PluginExecutor* target)
+{
+    const BranchJoinPtr join(new BranchJoin(tails.size(), target));
+    target->_prev_executors = tails;
+    for (size_t i = 0; i < tails.size(); ++i) {
+        tails[i]->_join = join;
+        tails[i]->_join_index = i;
+        tails[i]->_next_executors.assign(1, target);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Join point of parallel branches.
+//----------------------------------------------------------------------------
+
+ts::tsp::PluginExecutor::BranchJoin::BranchJoin(size_t branch_count, PluginExecutor* join_target) :
+    target(join_target),
+    _mutex(),
+    _passed(branch_count, 0),
+    _ended(branch_count, false),
+    _released(0)
+{
+}
+
+void ts::tsp::PluginExecutor::BranchJoin::pass(size_t index, size_t count, BitRate bitrate, bool input_end)
+{
+    // The mutex is shared by the last executors of the branches only.
+    // It is required to release packets and end of input in the right order.
+    Guard lock(_mutex);
+
+    _passed[index] += count;
+    _ended[index] = _ended[index] || input_end;
+
+    // Packets which were passed by all branches are released to the target.
+    const PacketCounter passed = *std::min_element(_passed.begin(), _passed.end());
+    const size_t released = size_t(passed - _released);
+    _released = passed;
+
+    // The end of input is reached when all branches reached it.
+    const bool all_ended = std::find(_ended.begin(), _ended.end(), false) == _ended.end();
+
+    if (released > 0 || all_ended) {
+        target->_bitrate = bitrate;
+        target->_pkt_cnt += released;
+        if (all_ended) {
+            target->_input_end = true;
+        }
+        target->wakeUp(false);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check if there is something to do for this executor.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::PluginExecutor::hasWork() const
+{
+    return _pkt_cnt > 0 || _input_end || nextAborting();
+}
+
+
+//----------------------------------------------------------------------------
+// Wake up this executor if it is parked in waitWork().
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::wakeUp(bool force)
+{
+    // The _sleeping flag is set by the executor thread under _work_mutex before
+    // checking hasWork() a last time. Since the producer has already updated the
+    // atomic counters, either the executor sees the new state or we see _sleeping.
+    // Abort conditions are not atomic, always signal in that case.
+    if (force || _sleeping) {
+        GuardCondition lock(_work_mutex, _to_do);
+        lock.signal();
+    }
 }
 
 
@@ -167,36 +329,118 @@ void ts::tsp::PluginExecutor::waitWork(size_t& pkt_first, size_t& pkt_cnt, BitRa
 {
     log(10, u"waitWork(...)");
 
-    // We access data under the protection of the global mutex.
-    GuardCondition lock(_global_mutex, _to_do);
-
-    PluginExecutor* next = ringNext<PluginExecutor>();
     timeout = false;
 
-    while (_pkt_cnt == 0 && !_input_end && !timeout && !next->_tsp_aborting) {
-        // If packet area for this processor is empty, wait for some packet.
-        // The mutex is implicitely released, we wait for the condition
-        // '_to_do' and, once we get it, implicitely relock the mutex.
-        // We loop on this until packets are actually available.
-        // If there is a timeout in the packet reception, call the plugin handler.
-        timeout = !lock.waitCondition(_tsp_timeout) && !plugin()->handlePacketTimeout();
+    if (!hasWork()) {
+        const Monotonic start(true);
+
+        // First, poll for a while, yielding the CPU between attempts. In a busy chain,
+        // the previous processor usually passes packets before we reach the end of the
+        // polling period, avoiding the cost of sleeping and being waken up. The polling
+        // period adapts itself: it grows when polling succeeds and shrinks when it fails.
+        size_t spin = 0;
+        while (spin < _spin_count && !hasWork()) {
+            Thread::Yield();
+            spin++;
+        }
+        if (spin < _spin_count) {
+            _spin_count = std::min(2 * _spin_count, MAX_SPIN_COUNT);
+        }
+        else {
+            _spin_count = std::max(_spin_count / 2, MIN_SPIN_COUNT);
+
+            // Nothing came, park the thread on the _to_do condition.
+            GuardCondition lock(_work_mutex, _to_do);
+            while (!timeout && !hasWork()) {
+                // Publish that we are sleeping, then check a last time before sleeping.
+                // The mutex is implicitely released, we wait for the condition
+                // '_to_do' and, once we get it, implicitely relock the mutex.
+                // If there is a timeout in the packet reception, call the plugin handler.
+                _sleeping = true;
+                if (!hasWork()) {
+                    timeout = !lock.waitCondition(_tsp_timeout) && !plugin()->handlePacketTimeout();
+                }
+                _sleeping = false;
+            }
+        }
+
+        _tm_wait_time += Monotonic(true) - start;
+        _tm_waits++;
     }
 
+    // The end of input is always published by the previous processor after the last packets.
+    // So, read it first: when set, the packet count is final.
+    const bool end = _input_end;
+    const size_t cnt = _pkt_cnt;
+
     pkt_first = _pkt_first;
-    pkt_cnt = timeout ? 0 : std::min(_pkt_cnt, _buffer->count() - _pkt_first);
+    pkt_cnt = timeout ? 0 : std::min(cnt, _buffer->count() - _pkt_first);
     bitrate = _bitrate;
-    input_end = _input_end && pkt_cnt == _pkt_cnt;
+    input_end = end && pkt_cnt == cnt;
+
+    // Sample the occupancy of our packet area (free space for the input executor).
+    if (cnt > 0) {
+        _tm_occupancy[std::min(cnt * OCCUPANCY_BUCKETS / _buffer->count(), OCCUPANCY_BUCKETS - 1)]++;
+    }
 
     // Force to abort our processor when the next one is aborting.
     // Don't do that if current is output and next is input because
     // there is no propagation of packets from output back to input.
-    aborted = plugin()->type() != OUTPUT_PLUGIN && next->_tsp_aborting;
+    aborted = plugin()->type() != OUTPUT_PLUGIN && nextAborting();
 
     log(10, u"waitWork(pkt_first = %'d, pkt_cnt = %'d, bitrate = %'d, input_end = %s, aborted = %s, timeout = %s)",
         {pkt_first, pkt_cnt, bitrate, input_end, aborted, timeout});
 }
 
 
+//----------------------------------------------------------------------------
+// Performance counters.
+//----------------------------------------------------------------------------
+
+ts::tsp::PluginExecutor::Telemetry::Telemetry() :
+    elapsed(0),
+    plugin_time(0),
+    wait_time(0),
+    max_call_time(0),
+    calls(0),
+    waits(0),
+    plugin_packets(0),
+    total_packets(0),
+    occupancy()
+{
+}
+
+void ts::tsp::PluginExecutor::getTelemetry(Telemetry& tm) const
+{
+    tm.elapsed = (Monotonic(true) - _tm_origin) - _tm_start;
+    tm.plugin_time = _tm_plugin_time;
+    tm.wait_time = _tm_wait_time;
+    tm.max_call_time = _tm_max_call_time;
+    tm.calls = _tm_calls;
+    tm.waits = _tm_waits;
+    tm.plugin_packets = pluginPackets() - _tm_plugin_packets;
+    tm.total_packets = totalPacketsInThread() - _tm_total_packets;
+    for (size_t i = 0; i < OCCUPANCY_BUCKETS; ++i) {
+        tm.occupancy[i] = _tm_occupancy[i];
+    }
+}
+
+void ts::tsp::PluginExecutor::resetTelemetry()
+{
+    _tm_start = Monotonic(true) - _tm_origin;
+    _tm_plugin_time = 0;
+    _tm_wait_time = 0;
+    _tm_max_call_time = 0;
+    _tm_calls = 0;
+    _tm_waits = 0;
+    _tm_plugin_packets = pluginPackets();
+    _tm_total_packets = totalPacketsInThread();
+    for (size_t i = 0; i < OCCUPANCY_BUCKETS; ++i) {
+        _tm_occupancy[i] = 0;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Description of a restart operation (constructor).
 //----------------------------------------------------------------------------
@@ -231,7 +475,7 @@ void ts::tsp::PluginExecutor::restart(const RestartDataPtr& rd)
     // Acquire the global mutex to modify global data.
     // To avoid deadlocks, always acquire the global mutex first, then a RestartData mutex.
     {
-        GuardCondition lock1(_global_mutex, _to_do);
+        Guard lock1(_global_mutex);
 
         // If there was a previous pending restart operation, cancel it.
         if (!_restart_data.isNull()) {
@@ -245,11 +489,11 @@ void ts::tsp::PluginExecutor::restart(const RestartDataPtr& rd)
         // Declare this new restart operation.
         _restart_data = rd;
         _restart = true;
-
-        // Signal the plugin thread that there is something to do.
-        lock1.signal();
     }
 
+    // Signal the plugin thread that there is something to do.
+    wakeUp(true);
+
     // Now wait for the restart operation to complete.
     GuardCondition lock3(rd->mutex, rd->condition);
     while (!rd->completed) {
@@ -264,6 +508,11 @@ void ts::tsp::PluginExecutor::restart(const RestartDataPtr& rd)
 
 bool ts::tsp::PluginExecutor::processPendingRestart()
 {
+    // Fast path, without mutex, in the most common case.
+    if (!_restart) {
+        return true;
+    }
+
     // Run under the protection of the global mutex.
     // To avoid deadlocks, always acquire the global mutex first, then a RestartData mutex.
     Guard lock1(_global_mutex);
@@ -40,7 +40,9 @@
 #include "tsRingNode.h"
 #include "tsCondition.h"
 #include "tsMutex.h"
+#include "tsNullMutex.h"
 #include "tsThread.h"
+#include "tsMonotonic.h"
 
 namespace ts {
     namespace tsp {
@@ -58,7 +60,8 @@ namespace ts {
             //! @param [in] type Plugin type.
             //! @param [in] pl_options Command line options for this plugin.
             //! @param [in] attributes Creation attributes for the thread executing this plugin.
-            //! @param [in,out] global_mutex Global mutex to synchronize access to the packet buffer.
+            //! @param [in,out] global_mutex Global mutex to synchronize access to shared tsp data.
+            //! The packet buffer itself is passed between executors without using this mutex.
             //! @param [in,out] report Where to report logs.
             //!
             PluginExecutor(const TSProcessorArgs& options,
@@ -143,6 +146,78 @@ namespace ts {
             //!
             void restart(Report& report);
 
+            //!
+            //! Fork the output of this executor to several parallel branches.
+            //! All packets which are passed by this executor are simultaneously passed to the
+            //! first executor of each branch. Must be executed in synchronous environment,
+            //! before starting all executor threads.
+            //! @param [in] heads First executor of each branch.
+            //!
+            void forkBranches(const std::vector<PluginExecutor*>& heads);
+
+            //!
+            //! Join several parallel branches into one executor.
+            //! Packets are passed to @a target once they are passed by the last executor of all
+            //! branches. Must be executed in synchronous environment, before starting all executor threads.
+            //! @param [in] tails Last executor of each branch.
+            //! @param [in] target Executor which receives the packets after all branches.
+            //!
+            static void JoinBranches(const std::vector<PluginExecutor*>& tails, PluginExecutor* target);
+
+            //!
+            //! Declare that this executor is part of a branch of parallel executors.
+            //! In a branch, the packets are shared with the other branches and are read-only.
+            //! The plugin works on private copies, its modifications are not propagated.
+            //! @param [in] on True if this executor is in a branch.
+            //!
+            void setInBranch(bool on) { _in_branch = on; }
+
+            //!
+            //! Check if this executor is part of a branch of parallel executors.
+            //! @return True if this executor is in a branch.
+            //!
+            bool inBranch() const { return _in_branch; }
+
+            //!
+            //! Number of buckets in the histogram of packet area occupancy.
+            //! Each bucket covers an equal share of the global packet buffer.
+            //!
+            static constexpr size_t OCCUPANCY_BUCKETS = 10;
+
+            //!
+            //! Snapshot of the performance counters of an executor.
+            //! All durations and counters are accumulated since the start of the executor or the last reset.
+            //!
+            class Telemetry
+            {
+            public:
+                Telemetry();                    //!< Constructor.
+                NanoSecond    elapsed;          //!< Time since the start of the executor or the last reset.
+                NanoSecond    plugin_time;      //!< Time spent in the plugin: receive(), processPacketBatch() or send().
+                NanoSecond    wait_time;        //!< Time spent waiting for packets (or free buffer for the input) in waitWork().
+                NanoSecond    max_call_time;    //!< Maximum duration of one call to the plugin.
+                uint64_t      calls;            //!< Number of calls to the plugin.
+                uint64_t      waits;            //!< Number of times the executor had to wait for work.
+                PacketCounter plugin_packets;   //!< Number of packets processed by the plugin.
+                PacketCounter total_packets;    //!< Number of packets processed by the executor, including packets which bypassed the plugin.
+                uint64_t      occupancy[OCCUPANCY_BUCKETS]; //!< Histogram of the size of the packet area, each time work is found.
+            };
+
+            //!
+            //! Get a snapshot of the performance counters of the executor.
+            //! Can be called from any thread. The counters are individually consistent
+            //! but not necessarily consistent with each other.
+            //! @param [out] tm Returned performance counters.
+            //!
+            void getTelemetry(Telemetry& tm) const;
+
+            //!
+            //! Reset the performance counters of the executor.
+            //! Can be called from any thread. The packet counters of the plugin are not modified,
+            //! the telemetry reports the number of packets since the reset.
+            //!
+            void resetTelemetry();
+
         protected:
             PacketBuffer*         _buffer;    //!< Description of shared packet buffer.
             PacketMetadataBuffer* _metadata;  //!< Description of shared packet metadata buffer.
@@ -190,6 +265,16 @@ namespace ts {
             //!
             void waitWork(size_t& pkt_first, size_t& pkt_cnt, BitRate& bitrate, bool& input_end, bool& aborted, bool &timeout);
 
+            //!
+            //! Minimum number of polling iterations in waitWork() before parking the thread.
+            //!
+            static constexpr size_t MIN_SPIN_COUNT = 16;
+
+            //!
+            //! Maximum number of polling iterations in waitWork() before parking the thread.
+            //!
+            static constexpr size_t MAX_SPIN_COUNT = 4096;
+
             //!
             //! Process a pending restart operation if there is one.
             //! @return True in case of success (no pending restart or successfully restarted)
@@ -197,20 +282,87 @@ namespace ts {
             //!
             bool processPendingRestart();
 
+            //!
+            //! Account for one call to the plugin in the performance counters.
+            //! @param [in] start Time of the beginning of the call.
+            //!
+            void addPluginCall(const Monotonic& start)
+            {
+                const NanoSecond duration = Monotonic(true) - start;
+                _tm_plugin_time += duration;
+                _tm_calls++;
+                if (duration > _tm_max_call_time) {
+                    _tm_max_call_time = duration;
+                }
+            }
+
+            //!
+            //! Get the executors which receive the packets which are passed by this executor.
+            //! Without parallel branches, this is the next executor in the ring.
+            //! @return A constant reference to the list of next executors.
+            //!
+            const std::vector<PluginExecutor*>& nextExecutors() const { return _next_executors; }
+
         private:
             // A structure which is used to handle a restart of the plugin.
             class RestartData;
             typedef SafePtr<RestartData,Mutex> RestartDataPtr;
 
+            // A structure which is used to join parallel branches.
+            class BranchJoin;
+            typedef SafePtr<BranchJoin,NullMutex> BranchJoinPtr;
+
+            // Topology of the processing chain. Initialized before starting the threads, read-only after.
+            bool                         _in_branch;       // This executor is part of a parallel branch.
+            std::vector<PluginExecutor*> _next_executors;  // Executors receiving the passed packets (or watched for abort if _join is set).
+            std::vector<PluginExecutor*> _prev_executors;  // Executors to notify when this one aborts.
+            BranchJoinPtr                _join;            // When this executor is the last of a parallel branch.
+            size_t                       _join_index;      // Index of this branch in _join.
+
+            // The packet area of each executor is shared by exactly two threads: this executor
+            // (the consumer) and the previous one in the ring (the producer). The counters are
+            // updated using atomic operations, without the global mutex. The _work_mutex and
+            // _to_do condition are used only when the consumer thread has nothing to do and
+            // parks after polling for a while. Implementation details: see the file
+            // src/docs/developing-plugins.dox
+            Mutex                _work_mutex;    // Protect _to_do only.
+            Condition            _to_do;         // Notify processor to do something.
+            std::atomic<bool>    _sleeping;      // The executor thread is parked on _to_do.
+            size_t               _spin_count;    // Current number of polling iterations before parking (executor thread only).
+            size_t               _pkt_first;     // Starting index of packets area (executor thread only).
+            std::atomic<size_t>  _pkt_cnt;       // Size of packets area.
+            std::atomic<bool>    _input_end;     // No more packet after current ones.
+            std::atomic<BitRate> _bitrate;       // Input bitrate (set by previous plugin).
+
             // The following private data must be accessed exclusively under the protection of the global mutex.
-            // Implementation details: see the file src/docs/developing-plugins.dox
-            Condition      _to_do;         // Notify processor to do something.
-            size_t         _pkt_first;     // Starting index of packets area
-            size_t         _pkt_cnt;       // Size of packets area
-            bool           _input_end;     // No more packet after current ones
-            BitRate        _bitrate;       // Input bitrate (set by previous plugin)
-            bool           _restart;       // Restart the plugni asap using _restart_data
-            RestartDataPtr _restart_data;  // How to restart the plugin
+            std::atomic<bool>    _restart;       // Restart the plugin asap using _restart_data (can be polled without mutex).
+            RestartDataPtr       _restart_data;  // How to restart the plugin.
+
+            // Performance counters. Updated by the executor thread, read and reset by any thread.
+            // Durations are atomic 64-bit integers, without mutex, to keep the overhead negligible.
+            const Monotonic         _tm_origin;           // Reference time for _tm_start.
+            std::atomic<NanoSecond> _tm_start;            // Start of measurement, relative to _tm_origin.
+            std::atomic<NanoSecond> _tm_plugin_time;
+            std::atomic<NanoSecond> _tm_wait_time;
+            std::atomic<NanoSecond> _tm_max_call_time;
+            std::atomic<uint64_t>   _tm_calls;
+            std::atomic<uint64_t>   _tm_waits;
+            std::atomic<PacketCounter> _tm_plugin_packets;  // Plugin packets at start of measurement.
+            std::atomic<PacketCounter> _tm_total_packets;   // Total packets at start of measurement.
+            std::atomic<uint64_t>   _tm_occupancy[OCCUPANCY_BUCKETS];
+
+            // Check if there is something to do for this executor.
+            bool hasWork() const;
+
+            // Check if any of the next executors is aborting.
+            bool nextAborting() const;
+
+            // Pass packets to one next executor (no branch join).
+            void passTo(PluginExecutor* next, size_t count, BitRate bitrate, bool input_end);
+
+            // Wake up this executor if it is parked in waitWork().
+            // When force is true, always signal, regardless of the _sleeping flag.
+            void wakeUp(bool force);
 
             // Description of a restart operation.
             class RestartData
@@ -230,6 +382,26 @@ namespace ts {
 
             // Restart this plugin.
             void restart(const RestartDataPtr&);
+
+            // Description of the join point of parallel branches.
+            // The packets are passed to the target executor when all branches have passed them.
+            class BranchJoin
+            {
+                TS_NOBUILD_NOCOPY(BranchJoin);
+            public:
+                // Constructor.
+                BranchJoin(size_t branch_count, PluginExecutor* join_target);
+
+                // Pass packets from one branch.
+                void pass(size_t index, size_t count, BitRate bitrate, bool input_end);
+
+                PluginExecutor* const      target;    // Executor receiving the packets after the join.
+            private:
+                Mutex                      _mutex;    // Protect the following fields, shared by the branch tails.
+                std::vector<PacketCounter> _passed;   // Total passed packets per branch.
+                std::vector<bool>          _ended;    // End of input per branch.
+                PacketCounter              _released; // Total packets passed to target.
+            };
         };
     }
 }
@@ -64,6 +64,18 @@ void ts::tsp::ProcessorExecutor::main()
     bool input_end = false;
     bool aborted = false;
 
+    // Status and flags of each packet in a batch. A batch never exceeds the buffer size.
+    std::vector<ProcessorPlugin::Status> status(_buffer->count());
+    std::vector<uint8_t> flags(_buffer->count());
+
+    // In a parallel branch, the packets and their metadata are shared with other branches.
+    // The plugin works on a private copy of the packets and metadata, the shared ones are read-only.
+    const bool in_branch = inBranch();
+    std::vector<TSPacket> branch_packets(in_branch ? _buffer->count() : 0);
+    std::vector<TSPacketMetadata> branch_metadata(in_branch ? _buffer->count() : 0);
+    bool branch_warning = false;
+    bool branch_modify_warning = false;
+
     do {
         // Wait for packets to process
         size_t pkt_first = 0;
@@ -104,89 +116,106 @@ void ts::tsp::ProcessorExecutor::main()
             break;
         }
 
-        // Now process the packets.
+        // Now process the packets by batches.
         size_t pkt_done = 0;
         size_t pkt_flush = 0;
 
         while (pkt_done < pkt_cnt && !aborted) {
 
-            TSPacket* const pkt = _buffer->base() + pkt_first + pkt_done;
-            TSPacketMetadata* const pkt_data = _metadata->base() + pkt_first + pkt_done;
-
-            pkt_done++;
-            pkt_flush++;
+            // Do not wait to process pkt_cnt packets before notifying the next processor.
+            // Perform periodic flush to avoid waiting too long before two output operations.
+            size_t batch_cnt = pkt_cnt - pkt_done;
+            if (_options.max_flush_pkt > 0) {
+                batch_cnt = std::min(batch_cnt, _options.max_flush_pkt - pkt_flush);
+            }
 
-            if (pkt->b[0] == 0) {
-                // The packet has already been dropped by a previous packet processor.
-                addNonPluginPackets(1);
+            TSPacket* const shared_pkt = _buffer->base() + pkt_first + pkt_done;
+            TSPacket* pkt = shared_pkt;
+            TSPacketMetadata* pkt_data = _metadata->base() + pkt_first + pkt_done;
+            if (in_branch) {
+                std::copy(shared_pkt, shared_pkt + batch_cnt, branch_packets.begin());
+                std::copy(pkt_data, pkt_data + batch_cnt, branch_metadata.begin());
+                pkt = branch_packets.data();
+                pkt_data = branch_metadata.data();
             }
-            else {
-                // Apply the processing routine to the packet
-                const bool was_null = pkt->getPID() == PID_NULL;
-                pkt_data->setFlush(false);
-                pkt_data->setBitrateChanged(false);
-                ProcessorPlugin::Status status = ProcessorPlugin::TSP_OK;
-                if (!_suspended && (only_labels.none() || pkt_data->hasAnyLabel(only_labels))) {
-                    // Either no --only-label option or the packet has a specified label => process it.
-                    status = _processor->processPacket(*pkt, *pkt_data);
-                    addPluginPackets(1);
+
+            // Apply the processing routine to the batch.
+            batch_cnt = processBatch(pkt, pkt_data, status.data(), flags.data(), batch_cnt, only_labels);
+
+            // Use the returned status of each packet.
+            bool flush = false;
+            for (size_t i = 0; i < batch_cnt; ++i) {
+
+                if ((flags[i] & PKT_DROPPED) != 0) {
+                    // The packet has already been dropped by a previous packet processor.
+                    continue;
                 }
-                else {
-                    // The plugin is suspended or some --only-label was specified but the packet does
-                    // not have any required label. Pass the packet without submitting it to the plugin.
-                    addNonPluginPackets(1);
+
+                // In a parallel branch, the packets cannot be dropped or nullified.
+                if (in_branch && (status[i] == ProcessorPlugin::TSP_NULL || status[i] == ProcessorPlugin::TSP_DROP)) {
+                    if (!branch_warning) {
+                        warning(u"packets are read-only in a parallel branch, cannot drop or nullify packets");
+                        branch_warning = true;
+                    }
+                    status[i] = ProcessorPlugin::TSP_OK;
+                }
+                else if (in_branch && !branch_modify_warning && pkt[i] != shared_pkt[i]) {
+                    warning(u"packets are read-only in a parallel branch, packet modifications are ignored");
+                    branch_modify_warning = true;
                 }
 
-                // Use the returned status
-                switch (status) {
+                switch (status[i]) {
                     case ProcessorPlugin::TSP_OK:
                         // Normal case, pass packet
                         passed_packets++;
                         break;
                     case ProcessorPlugin::TSP_NULL:
                         // Replace the packet with a complete null packet
-                        *pkt = NullPacket;
+                        pkt[i] = NullPacket;
                         break;
                     case ProcessorPlugin::TSP_DROP:
                         // Drop this packet.
-                        pkt->b[0] = 0;
+                        pkt[i].b[0] = 0;
                         dropped_packets++;
                         break;
                     case ProcessorPlugin::TSP_END:
-                        // Signal end of input to successors and abort
-                        // to predecessors
+                        // Signal end of input to successors and abort to predecessors.
+                        // This packet and all subsequent ones are not passed.
                         input_end = aborted = true;
-                        pkt_done--;
-                        pkt_flush--;
-                        pkt_cnt = pkt_done;
+                        batch_cnt = i;
+                        pkt_cnt = pkt_done + batch_cnt;
                         break;
                     default:
                         // Invalid status, report error and accept packet.
-                        error(u"invalid packet processing status %d", {status});
+                        error(u"invalid packet processing status %d", {status[i]});
                         break;
                 }
+                if (aborted) {
+                    break;
+                }
 
                 // Detect if the packet was nullified by the plugin, either by returning TSP_NULL or by overwriting the packet.
-                if (!was_null && pkt->getPID() == PID_NULL) {
-                    pkt_data->setNullified(true);
+                if (!in_branch && (flags[i] & PKT_WAS_NULL) == 0 && pkt[i].getPID() == PID_NULL) {
+                    pkt_data[i].setNullified(true);
                     nullified_packets++;
                 }
 
                 // If the packet processor has signaled a new bitrate, get it.
-                if (pkt_data->getBitrateChanged()) {
+                if (pkt_data[i].getBitrateChanged()) {
                     const BitRate new_bitrate = _processor->getBitrate();
                     if (new_bitrate != 0) {
                         bitrate_never_modified = false;
                         output_bitrate = new_bitrate;
                     }
                 }
+
+                flush = flush || pkt_data[i].getFlush();
             }
 
-            // Do not wait to process pkt_cnt packets before notifying
-            // the next processor. Perform periodic flush to avoid waiting
-            // too long before two output operations.
+            pkt_done += batch_cnt;
+            pkt_flush += batch_cnt;
 
-            if (pkt_data->getFlush() || pkt_done == pkt_cnt || (_options.max_flush_pkt > 0 && pkt_flush % _options.max_flush_pkt == 0)) {
+            if (flush || pkt_done == pkt_cnt || (_options.max_flush_pkt > 0 && pkt_flush >= _options.max_flush_pkt)) {
                 aborted = !passPackets(pkt_flush, output_bitrate, pkt_done == pkt_cnt && input_end, aborted);
                 pkt_flush = 0;
             }
@@ -200,3 +229,67 @@ void ts::tsp::ProcessorExecutor::main()
     debug(u"packet processing thread %s after %'d packets, %'d passed, %'d dropped, %'d nullified",
           {input_end ? u"terminated" : u"aborted", pluginPackets(), passed_packets, dropped_packets, nullified_packets});
 }
+
+
+//----------------------------------------------------------------------------
+// Submit a batch of packets to the plugin.
+//----------------------------------------------------------------------------
+
+size_t ts::tsp::ProcessorExecutor::processBatch(TSPacket* pkt,
+                                                TSPacketMetadata* pkt_data,
+                                                ProcessorPlugin::Status* status,
+                                                uint8_t* flags,
+                                                size_t count,
+                                                const TSPacketMetadata::LabelSet& only_labels)
+{
+    // The suspension state is checked once per batch.
+    const bool suspended = _suspended;
+    const bool all_labels = only_labels.none();
+
+    size_t i = 0;
+    while (i < count) {
+
+        // Find the end of the next run of packets to submit to the plugin.
+        size_t end = i;
+        while (end < count && pkt[end].b[0] != 0 && !suspended && (all_labels || pkt_data[end].hasAnyLabel(only_labels))) {
+            flags[end] = pkt[end].getPID() == PID_NULL ? PKT_WAS_NULL : 0;
+            pkt_data[end].setFlush(false);
+            pkt_data[end].setBitrateChanged(false);
+            end++;
+        }
+
+        // Submit the run of packets to the plugin.
+        if (end > i) {
+            const PacketCounter before = pluginPackets();
+            const Monotonic start(true);
+            const size_t done = _processor->processPacketBatch(pkt + i, pkt_data + i, end - i, status + i);
+            addPluginCall(start);
+            // The default implementation of processPacketBatch() already accounts for its packets.
+            addPluginPackets(done - size_t(pluginPackets() - before));
+            if (done < end - i) {
+                // Processing ended on TSP_END.
+                return i + done;
+            }
+            i = end;
+        }
+
+        // Skip packets which are not submitted to the plugin.
+        if (i < count && pkt[i].b[0] == 0) {
+            // The packet has already been dropped by a previous packet processor.
+            flags[i] = PKT_DROPPED;
+            addNonPluginPackets(1);
+            i++;
+        }
+        else if (i < count) {
+            // The plugin is suspended or some --only-label was specified but the packet does
+            // not have any required label. Pass the packet without submitting it to the plugin.
+            flags[i] = pkt[i].getPID() == PID_NULL ? PKT_WAS_NULL : 0;
+            pkt_data[i].setFlush(false);
+            pkt_data[i].setBitrateChanged(false);
+            status[i] = ProcessorPlugin::TSP_OK;
+            addNonPluginPackets(1);
+            i++;
+        }
+    }
+    return count;
+}
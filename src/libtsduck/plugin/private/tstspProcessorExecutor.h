@@ -70,8 +70,24 @@ namespace ts {
         private:
             ProcessorPlugin* _processor;
 
+            // Flags describing each packet in a batch, before submitting them to the plugin.
+            enum : uint8_t {
+                PKT_DROPPED  = 0x01,  // Packet previously dropped, ignored.
+                PKT_WAS_NULL = 0x02,  // Packet was a null packet before processing.
+            };
+
             // Inherited from Thread
             virtual void main() override;
+
+            // Submit a batch of packets to the plugin. Packets which are previously dropped, excluded by
+            // --only-label or while the plugin is suspended are not submitted. Fill the status and flags
+            // of each packet. Return the number of processed packets, less than count on TSP_END.
+            size_t processBatch(TSPacket* pkt,
+                                TSPacketMetadata* pkt_data,
+                                ProcessorPlugin::Status* status,
+                                uint8_t* flags,
+                                size_t count,
+                                const TSPacketMetadata::LabelSet& only_labels);
         };
     }
 }
@@ -50,7 +50,11 @@ ts::tsswitch::Core::Core(const InputSwitcherArgs& opt, Report& log) :
     _curCycle(0),
     _terminate(false),
     _actions(),
-    _events()
+    _events(),
+    _endedInputs(0),
+    _merger(_opt.hitlessDelay, _opt.bufferedPackets),
+    _hitlessPackets(_opt.hitless ? _opt.maxOutputPackets : 0),
+    _hitlessMetadata(_opt.hitless ? _opt.maxOutputPackets : 0)
 {
     // Load all input plugins, analyze their options.
     for (size_t i = 0; i < _inputs.size(); ++i) {
@@ -59,6 +63,7 @@ ts::tsswitch::Core::Core(const InputSwitcherArgs& opt, Report& log) :
         // Set the asynchronous logger as report method for all executors.
         _inputs[i]->setReport(&_log);
         _inputs[i]->setMaxSeverity(_log.maxSeverity());
+        _merger.addInput(_inputs[i]);
     }
 
     // Set the asynchronous logger as report method for output as well.
@@ -440,10 +445,17 @@ bool ts::tsswitch::Core::getOutputArea(size_t& pluginIndex, TSPacket*& first, TS
     // Loop on _gotInput condition until the current input plugin has something to output.
     GuardCondition lock(_mutex, _gotInput);
     for (;;) {
+        MilliSecond timeout = Infinite;
         if (_terminate) {
             first = nullptr;
             count = 0;
         }
+        else if (_opt.hitless) {
+            // In hitless mode, the packets from all inputs are merged in a separate buffer.
+            count = _merger.merge(_hitlessPackets.data(), _hitlessMetadata.data(), _hitlessPackets.size(), _curPlugin, Time::CurrentUTC(), timeout);
+            first = _hitlessPackets.data();
+            data = _hitlessMetadata.data();
+        }
         else {
             _inputs[_curPlugin]->getOutputArea(first, data, count);
         }
@@ -455,7 +467,7 @@ bool ts::tsswitch::Core::getOutputArea(size_t& pluginIndex, TSPacket*& first, TS
             return !_terminate;
         }
         // Otherwise, sleep on _gotInput condition.
-        lock.waitCondition();
+        lock.waitCondition(timeout);
     }
 }
 
@@ -471,7 +483,16 @@ bool ts::tsswitch::Core::outputSent(size_t pluginIndex, size_t count)
     // Inform the input plugin that the packets can be reused for input.
     // We notify the original input plugin from which the packets came.
     // The "current" input plugin may have changed in the meantime.
-    _inputs[pluginIndex]->freeOutput(count);
+    // In hitless mode, the packets were copied in the merge buffer and already removed
+    // from the inputs. Simply notify all inputs that their packets are now sent.
+    if (!_opt.hitless) {
+        _inputs[pluginIndex]->freeOutput(count);
+    }
+    else {
+        for (size_t i = 0; i < _inputs.size(); ++i) {
+            _inputs[i]->freeOutput(0);
+        }
+    }
 
     // Return false when the application terminates.
     return !_terminate;
@@ -485,6 +506,7 @@ bool ts::tsswitch::Core::outputSent(size_t pluginIndex, size_t count)
 bool ts::tsswitch::Core::inputStarted(size_t pluginIndex, bool success)
 {
     Guard lock(_mutex);
+    _merger.setRunning(pluginIndex, success);
 
     // Execute all commands if waiting on this event.
     execute(Action(WAIT_STARTED, pluginIndex, success));
@@ -536,7 +558,7 @@ bool ts::tsswitch::Core::inputReceived(size_t pluginIndex)
         assert(_curPlugin == _opt.primaryInput);
     }
 
-    if (pluginIndex == _curPlugin) {
+    if (pluginIndex == _curPlugin || _opt.hitless) {
         // Wake up output plugin if it is sleeping, waiting for packets to output.
         lock.signal();
     }
@@ -556,7 +578,7 @@ bool ts::tsswitch::Core::inputStopped(size_t pluginIndex, bool success)
 
     // Locked sequence.
     {
-        Guard lock(_mutex);
+        GuardCondition lock(_mutex, _gotInput);
         _log.debug(u"input %d completed, success: %s", {pluginIndex, success});
 
         // Count end of cycle when the last plugin terminates.
@@ -565,7 +587,16 @@ bool ts::tsswitch::Core::inputStopped(size_t pluginIndex, bool success)
         }
 
         // Check if the complete processing is terminated.
-        stopRequest = _opt.terminate || (_opt.cycleCount > 0 && _curCycle >= _opt.cycleCount);
+        if (_opt.hitless) {
+            // In hitless mode, all input plugins run in parallel and are never restarted.
+            // The output plugin must no longer wait for packets from this input.
+            _merger.setRunning(pluginIndex, false);
+            stopRequest = _opt.terminate || ++_endedInputs >= _inputs.size();
+            lock.signal();
+        }
+        else {
+            stopRequest = _opt.terminate || (_opt.cycleCount > 0 && _curCycle >= _opt.cycleCount);
+        }
 
         if (stopRequest) {
             // Need to stop now. Remove any further action, except waiting for termination.
@@ -617,4 +648,12 @@ void ts::tsswitch::Core::waitForTermination()
     for (size_t i = 0; i < _inputs.size(); ++i) {
         _inputs[i]->waitForTermination();
     }
+
+    // Report the contribution of each input plugin in hitless mode.
+    if (_opt.hitless) {
+        for (size_t i = 0; i < _inputs.size(); ++i) {
+            _log.verbose(u"input %d (%s): %'d output packets, %'d packets recovered from this input",
+                         {i, _inputs[i]->pluginName(), _merger.outputPackets(i), _merger.recoveredPackets(i)});
+        }
+    }
 }
@@ -36,6 +36,7 @@
 #include "tsInputSwitcherArgs.h"
 #include "tstsswitchInputExecutor.h"
 #include "tstsswitchOutputExecutor.h"
+#include "tsHitlessMerger.h"
 #include "tsMutex.h"
 #include "tsCondition.h"
 #include "tsWatchDog.h"
@@ -195,6 +196,10 @@ namespace ts {
             volatile bool       _terminate;       // Terminate complete processing.
             ActionQueue         _actions;         // Sequential queue list of actions to execute.
             ActionSet           _events;          // Pending events, waiting to be cleared.
+            size_t              _endedInputs;     // Number of input plugins which completed their session (hitless mode).
+            HitlessMerger       _merger;          // Merge all input plugins (hitless mode).
+            TSPacketVector      _hitlessPackets;  // Merged output packets (hitless mode).
+            TSPacketMetadataVector _hitlessMetadata;  // Merged output packets metadata (hitless mode).
 
             // Names of actions for debug messages.
             static const Enumeration _actionNames;
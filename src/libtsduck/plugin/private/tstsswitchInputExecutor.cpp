@@ -55,7 +55,12 @@ ts::tsswitch::InputExecutor::InputExecutor(size_t index, Core& core, const Input
     _stopRequest(false),
     _terminated(false),
     _outFirst(0),
-    _outCount(0)
+    _outCount(0),
+    _fingerprints(opt.hitless ? _buffer.size() : 0),
+    _arrivals(opt.hitless ? _buffer.size() : 0),
+    _outPosition(0),
+    _fingerprintIndex(),
+    _fingerprinter(opt.bufferedPackets, opt.hitlessRTP)
 {
     // Make sure that the input plugins display their index.
     setLogName(UString::Format(u"%s[%d]", {pluginName(), _pluginIndex}));
@@ -177,6 +182,68 @@ void ts::tsswitch::InputExecutor::freeOutput(size_t count)
 }
 
 
+//----------------------------------------------------------------------------
+// Hitless mode: access to received packets by fingerprint.
+// Indirectly called from the output plugin when it needs some packets.
+//----------------------------------------------------------------------------
+
+bool ts::tsswitch::InputExecutor::getFingerprint(size_t index, uint64_t& fingerprint, Time& arrival)
+{
+    Guard lock(_mutex);
+    if (index >= _outCount || _fingerprints.empty()) {
+        return false;
+    }
+    else {
+        const size_t n = (_outFirst + index) % _buffer.size();
+        fingerprint = _fingerprints[n];
+        arrival = _arrivals[n];
+        return true;
+    }
+}
+
+size_t ts::tsswitch::InputExecutor::findFingerprint(uint64_t fingerprint)
+{
+    Guard lock(_mutex);
+    const auto range(_fingerprintIndex.equal_range(fingerprint));
+    size_t index = NPOS;
+    for (auto it = range.first; it != range.second; ++it) {
+        index = std::min(index, size_t(it->second - _outPosition));
+    }
+    return index;
+}
+
+bool ts::tsswitch::InputExecutor::extractPacket(uint64_t fingerprint, TSPacket* packet, TSPacketMetadata* data)
+{
+    // The packet may have been dropped by the input thread since getFingerprint().
+    GuardCondition lock(_mutex, _todo);
+    if (_outCount == 0 || _fingerprints.empty() || _fingerprints[_outFirst] != fingerprint) {
+        return false;
+    }
+    else {
+        if (packet != nullptr) {
+            // The output is in use until the merged packets are sent, see freeOutput().
+            *packet = _buffer[_outFirst];
+            _outputInUse = true;
+        }
+        if (data != nullptr) {
+            *data = _metadata[_outFirst];
+        }
+        const auto range(_fingerprintIndex.equal_range(fingerprint));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == _outPosition) {
+                _fingerprintIndex.erase(it);
+                break;
+            }
+        }
+        _outPosition++;
+        _outFirst = (_outFirst + 1) % _buffer.size();
+        _outCount--;
+        lock.signal();
+        return true;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Invoked in the context of the plugin thread.
 //----------------------------------------------------------------------------
@@ -195,6 +262,9 @@ void ts::tsswitch::InputExecutor::main()
             // Reset input buffer.
             _outFirst = 0;
             _outCount = 0;
+            _outPosition = 0;
+            _fingerprintIndex.clear();
+            _fingerprinter.reset();
             // Wait for start or terminate.
             while (!_startRequest && !_terminated) {
                 lock.waitCondition();
@@ -233,8 +303,8 @@ void ts::tsswitch::InputExecutor::main()
                 // Wait for free buffer or stop.
                 GuardCondition lock(_mutex, _todo);
                 while (_outCount >= _buffer.size() && !_stopRequest && !_terminated) {
-                    if (_isCurrent || !_opt.fastSwitch) {
-                        // This is the current input, we must not lose packet.
+                    if (_isCurrent || !_opt.fastSwitch || _opt.hitless) {
+                        // This is the current input or all inputs are merged, we must not lose packet.
                         // Wait for the output thread to free some packets.
                         lock.waitCondition();
                     }
@@ -274,9 +344,21 @@ void ts::tsswitch::InputExecutor::main()
             }
             addPluginPackets(inCount);
 
+            // In hitless mode, compute the fingerprints of all received packets.
+            if (!_fingerprints.empty()) {
+                const Time now(Time::CurrentUTC());
+                for (size_t n = inFirst; n < inFirst + inCount; ++n) {
+                    _fingerprints[n] = _fingerprinter.fingerprint(_buffer[n], _metadata[n]);
+                    _arrivals[n] = now;
+                }
+            }
+
             // Signal the presence of received packets.
             {
                 Guard lock(_mutex);
+                for (size_t n = 0; n < inCount && !_fingerprints.empty(); ++n) {
+                    _fingerprintIndex.insert(std::make_pair(_fingerprints[inFirst + n], _outPosition + _outCount + n));
+                }
                 _outCount += inCount;
             }
             _core.inputReceived(_pluginIndex);
@@ -294,6 +376,8 @@ void ts::tsswitch::InputExecutor::main()
             // And reset the output part of the buffer.
             _outFirst = 0;
             _outCount = 0;
+            _outPosition = 0;
+            _fingerprintIndex.clear();
         }
 
         // End of input session.
@@ -35,6 +35,7 @@
 #pragma once
 #include "tsInputSwitcherArgs.h"
 #include "tsPluginThread.h"
+#include "tsHitlessMerger.h"
 #include "tsMutex.h"
 #include "tsCondition.h"
 
@@ -51,7 +52,7 @@ namespace ts {
         //! Execution context of a tsswitch input plugin.
         //! @ingroup plugin
         //!
-        class InputExecutor : public PluginThread
+        class InputExecutor : public PluginThread, public HitlessMerger::InputInterface
         {
             TS_NOBUILD_NOCOPY(InputExecutor);
         public:
@@ -121,6 +122,12 @@ namespace ts {
             //!
             void freeOutput(size_t count);
 
+            // Implementation of HitlessMerger::InputInterface (hitless mode only).
+            // When a packet is extracted, the output is in use until the next call to freeOutput().
+            virtual bool getFingerprint(size_t index, uint64_t& fingerprint, Time& arrival) override;
+            virtual size_t findFingerprint(uint64_t fingerprint) override;
+            virtual bool extractPacket(uint64_t fingerprint, TSPacket* packet, TSPacketMetadata* data) override;
+
             // Implementation of TSP. We do not use "joint termination" in tsswitch.
             virtual void useJointTermination(bool) override;
             virtual void jointTerminate() override;
@@ -143,6 +150,11 @@ namespace ts {
             bool           _terminated;       // Terminate thread.
             size_t         _outFirst;         // Index of first packet to output in _buffer.
             size_t         _outCount;         // Number of packets to output, not always contiguous, may wrap up.
+            std::vector<uint64_t> _fingerprints; // Packet fingerprints, hitless mode only.
+            std::vector<Time> _arrivals;      // Packet reception times, hitless mode only.
+            PacketCounter  _outPosition;      // Position in the input stream of the first packet to output, hitless mode only.
+            std::unordered_multimap<uint64_t, PacketCounter> _fingerprintIndex; // Fingerprints of the packets to output and their position.
+            HitlessMerger::Fingerprinter _fingerprinter; // Compute fingerprints (used in input thread only).
 
             // Implementation of Thread.
             virtual void main() override;
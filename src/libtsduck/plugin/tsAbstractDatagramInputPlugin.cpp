@@ -36,7 +36,7 @@ TSDUCK_SOURCE;
 // Input constructor
 //----------------------------------------------------------------------------
 
-ts::AbstractDatagramInputPlugin::AbstractDatagramInputPlugin(TSP* tsp_, size_t buffer_size, const UString& description, const UString& syntax) :
+ts::AbstractDatagramInputPlugin::AbstractDatagramInputPlugin(TSP* tsp_, size_t buffer_size, const UString& description, const UString& syntax, size_t max_datagrams) :
     InputPlugin(tsp_, description, syntax),
     _eval_time(0),
     _display_time(0),
@@ -49,7 +49,14 @@ ts::AbstractDatagramInputPlugin::AbstractDatagramInputPlugin(TSP* tsp_, size_t b
     _packets_1(0),
     _inbuf_count(0),
     _inbuf_next(0),
-    _inbuf(buffer_size)
+    _dgram_size(buffer_size),
+    _dgram_count(0),
+    _dgram_next(0),
+    _dgram_sizes(std::max<size_t>(1, max_datagrams)),
+    _dgram_times(std::max<size_t>(1, max_datagrams)),
+    _inbuf_time(-1),
+    _inbuf_rtp_seq(-1),
+    _inbuf(buffer_size * std::max<size_t>(1, max_datagrams))
 {
     option(u"display-interval", 'd', POSITIVE);
     help(u"display-interval",
@@ -97,6 +104,9 @@ bool ts::AbstractDatagramInputPlugin::start()
 {
     // Initialize working data.
     _inbuf_count = _inbuf_next = 0;
+    _dgram_count = _dgram_next = 0;
+    _inbuf_time = -1;
+    _inbuf_rtp_seq = -1;
     _start = _start_0 = _start_1 = _next_display = Time::Epoch;
     _packets = _packets_0 = _packets_1 = 0;
     return true;
@@ -122,40 +132,106 @@ ts::BitRate ts::AbstractDatagramInputPlugin::getBitrate()
 }
 
 
+//----------------------------------------------------------------------------
+// Default implementation of multiple datagrams reception: one by one.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDatagramInputPlugin::receiveDatagrams(void* buffer, size_t buffer_size, size_t max_count, size_t& ret_count, size_t* ret_sizes, MicroSecond* timestamps)
+{
+    ret_count = 0;
+    if (max_count > 0 && receiveDatagram(buffer, buffer_size, ret_sizes[0])) {
+        timestamps[0] = -1;
+        ret_count = 1;
+    }
+    return ret_count > 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Locate TS packets in the next received datagram.
+//----------------------------------------------------------------------------
+
+size_t ts::AbstractDatagramInputPlugin::locateDatagram()
+{
+    assert(_dgram_next < _dgram_count);
+    const size_t offset = _dgram_next * _dgram_size;
+    const size_t insize = _dgram_sizes[_dgram_next];
+    _inbuf_time = _dgram_times[_dgram_next++];
+
+    // Look for TS packets in the UDP message.
+    if (TSPacket::Locate(_inbuf.data() + offset, insize, _inbuf_next, _inbuf_count)) {
+        // A leading RTP header (version 2, at least 12 bytes) carries a sequence number.
+        const uint8_t* const dgram = _inbuf.data() + offset;
+        _inbuf_rtp_seq = _inbuf_next >= 12 && (dgram[0] & 0xC0) == 0x80 ? int32_t(GetUInt16(dgram + 2)) : -1;
+        _inbuf_next += offset;
+        return _inbuf_count;
+    }
+    else {
+        tsp->debug(u"no TS packet in message, %s bytes", {insize});
+        _inbuf_count = 0;
+        return 0;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Input method
 //----------------------------------------------------------------------------
 
 size_t ts::AbstractDatagramInputPlugin::receive(TSPacket* buffer, TSPacketMetadata* pkt_data, size_t max_packets)
 {
-    // Check if we receive new packets or process remain of previous buffer.
-    bool new_packets = false;
+    // Number of new TS packets which are located in datagrams during this call.
+    size_t new_packets = 0;
 
-    // If there is no remaining packet in the input buffer, wait for a datagram message.
+    // If there is no remaining packet in the input buffer, wait for datagram messages.
     // Loop until we get some TS packets.
     while (_inbuf_count == 0) {
 
-        // Wait for a datagram message
-        size_t insize = 0;
-        if (!receiveDatagram(_inbuf.data(), _inbuf.size(), insize)) {
-            return 0;
+        // When all previously received datagrams are processed, wait for new ones.
+        if (_dgram_next >= _dgram_count) {
+            _dgram_next = _dgram_count = 0;
+            if (!receiveDatagrams(_inbuf.data(), _dgram_size, _dgram_sizes.size(), _dgram_count, _dgram_sizes.data(), _dgram_times.data())) {
+                return 0;
+            }
         }
 
-        // Look for TS packets in the UDP message.
-        new_packets = TSPacket::Locate(_inbuf.data(), insize, _inbuf_next, _inbuf_count);
-
-        if (new_packets) {
-            break; // found packets.
+        // Look for TS packets in the next datagram.
+        while (_inbuf_count == 0 && _dgram_next < _dgram_count) {
+            new_packets += locateDatagram();
         }
+    }
 
-        // No TS packet found in UDP message, wait for another one.
-        tsp->debug(u"no TS packet in message, %s bytes", {insize});
+    // Return packets from the input buffer. Continue with the next datagrams
+    // which were already received, as long as there is space in the caller's buffer.
+    size_t pkt_cnt = 0;
+    while (_inbuf_count > 0 && pkt_cnt < max_packets) {
+        const size_t count = std::min(_inbuf_count, max_packets - pkt_cnt);
+        TSPacket::Copy(buffer + pkt_cnt, _inbuf.data() + _inbuf_next, count);
+        if (_inbuf_time >= 0) {
+            // All packets from a datagram have the same input time stamp.
+            for (size_t i = 0; i < count; ++i) {
+                pkt_data[pkt_cnt + i].setInputTimeStampMicroSec(_inbuf_time);
+            }
+        }
+        if (_inbuf_rtp_seq >= 0) {
+            // All packets from a datagram have the same RTP sequence number.
+            for (size_t i = 0; i < count; ++i) {
+                pkt_data[pkt_cnt + i].setRTPSequence(uint16_t(_inbuf_rtp_seq));
+            }
+        }
+        pkt_cnt += count;
+        _inbuf_count -= count;
+        _inbuf_next += count * PKT_SIZE;
+        while (_inbuf_count == 0 && _dgram_next < _dgram_count && pkt_cnt < max_packets) {
+            new_packets += locateDatagram();
+        }
     }
 
     // If new packets were received, we may need to re-evaluate the real-time input bitrate.
-    if (new_packets && _eval_time > 0) {
-
-        const Time now(Time::CurrentUTC());
+    if (new_packets > 0 && _eval_time > 0) {
+        // Use the reception time stamp of the last datagram when available.
+        // This avoids the scheduling jitter of the input thread.
+        const Time now(_inbuf_time >= 0 ? Time::UnixEpoch + _inbuf_time / 1000 : Time::CurrentUTC());
 
         // Detect start time
         if (_packets == 0) {
@@ -166,9 +242,9 @@ size_t ts::AbstractDatagramInputPlugin::receive(TSPacket* buffer, TSPacketMetada
         }
 
         // Count packets
-        _packets += _inbuf_count;
-        _packets_0 += _inbuf_count;
-        _packets_1 += _inbuf_count;
+        _packets += new_packets;
+        _packets_0 += new_packets;
+        _packets_1 += new_packets;
 
         // Detect new evaluation period
         if (now >= _start_1 + _eval_time) {
@@ -192,11 +268,5 @@ size_t ts::AbstractDatagramInputPlugin::receive(TSPacket* buffer, TSPacketMetada
         }
     }
 
-    // Return packets from the input buffer
-    size_t pkt_cnt = std::min(_inbuf_count, max_packets);
-    TSPacket::Copy(buffer, _inbuf.data() + _inbuf_next, pkt_cnt);
-    _inbuf_count -= pkt_cnt;
-    _inbuf_next += pkt_cnt * PKT_SIZE;
-
     return pkt_cnt;
 }
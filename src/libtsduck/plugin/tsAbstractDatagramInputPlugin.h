@@ -52,11 +52,13 @@ namespace ts {
         //! Constructor.
         //! @param [in] tsp Associated callback to @c tsp executable.
         //! @param [in] buffer_size Size in bytes of input buffer.
+        //! Must be large enough to contain the largest datagram.
         //! @param [in] description A short one-line description, eg. "Wonderful File Copier".
         //! @param [in] syntax A short one-line syntax summary, eg. "[options] filename ...".
-        //! Must be large enough to contain the largest datagram.
+        //! @param [in] max_datagrams Maximum number of datagrams which can be received at a time
+        //! using receiveDatagrams(). The input buffer is allocated for that number of datagrams.
         //!
-        AbstractDatagramInputPlugin(TSP* tsp, size_t buffer_size, const UString& description = UString(), const UString& syntax = UString());
+        AbstractDatagramInputPlugin(TSP* tsp, size_t buffer_size, const UString& description = UString(), const UString& syntax = UString(), size_t max_datagrams = 1);
 
         // Implementation of plugin API.
         virtual bool getOptions() override;
@@ -76,6 +78,24 @@ namespace ts {
         //!
         virtual bool receiveDatagram(void* buffer, size_t buffer_size, size_t& ret_size) = 0;
 
+        //!
+        //! Receive several datagram messages.
+        //! Wait for at least one message and return all messages which are immediately available.
+        //! The default implementation receives one single message using receiveDatagram().
+        //! Subclasses may override it to receive several messages in one system call.
+        //! @param [out] buffer Address of the buffer for the received messages.
+        //! The message of index @e i is received at address @a buffer + @e i * @a buffer_size.
+        //! @param [in] buffer_size Size in bytes of the reception buffer of each message.
+        //! @param [in] max_count Maximum number of messages to receive.
+        //! @param [out] ret_count Number of received messages.
+        //! @param [out] ret_sizes Array of @a max_count elements, receiving the size in bytes of each message.
+        //! @param [out] timestamps Array of @a max_count elements, receiving the reception time stamp of each
+        //! message in micro-seconds since 1970-01-01 UTC, or a negative value when not available. When present,
+        //! these time stamps are used as input time stamps of the TS packets and to evaluate the input bitrate.
+        //! @return True on success, false on error.
+        //!
+        virtual bool receiveDatagrams(void* buffer, size_t buffer_size, size_t max_count, size_t& ret_count, size_t* ret_sizes, MicroSecond* timestamps);
+
     private:
         MilliSecond   _eval_time;          // Bitrate evaluation interval in milli-seconds
         MilliSecond   _display_time;       // Bitrate display interval in milli-seconds
@@ -88,6 +108,16 @@ namespace ts {
         PacketCounter _packets_1;          // Number of received packets since _start_1
         size_t        _inbuf_count;        // Remaining TS packets in inbuf
         size_t        _inbuf_next;         // Index in inbuf of next TS packet to return
-        ByteBlock     _inbuf;              // Input buffer
+        size_t        _dgram_size;         // Size of the buffer of each datagram in inbuf
+        size_t        _dgram_count;        // Number of received datagrams in inbuf
+        size_t        _dgram_next;         // Index of next datagram to process in inbuf
+        std::vector<size_t> _dgram_sizes;  // Size of each received datagram
+        std::vector<MicroSecond> _dgram_times; // Reception time stamp of each received datagram
+        MicroSecond   _inbuf_time;         // Reception time stamp of the current datagram, negative if none
+        int32_t       _inbuf_rtp_seq;      // RTP sequence number of the current datagram, negative if none
+        ByteBlock     _inbuf;              // Input buffer, containing several datagrams
+
+        // Locate TS packets in the next received datagram, return the number of packets.
+        size_t locateDatagram();
     };
 }
@@ -49,6 +49,7 @@ ts::AbstractDescrambler::AbstractDescrambler(TSP* tsp_, const UString& descripti
     _swap_cw(false),
     _scrambling(*tsp),
     _pids(),
+    _batch(),
     _service(duck, this),
     _stack_usage(stack_usage),
     _demux(duck, nullptr, this),
@@ -594,3 +595,38 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
     // Descramble the packet payload.
     return pecm->scrambling.decrypt(pkt) ? TSP_OK : TSP_END;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+size_t ts::AbstractDescrambler::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    if (_pids.any()) {
+        // Fixed PID's using fixed control words, no service or ECM to manage.
+        // All packets to descramble are decrypted together (in parallel with DVB-CSA2).
+        _batch.clear();
+        for (size_t i = 0; i < count; ++i) {
+            if (_pids.test(pkt[i].getPID())) {
+                _batch.push_back(pkt + i);
+            }
+            status[i] = TSP_OK;
+        }
+        if (!_batch.empty() && !_scrambling.decrypt(_batch.data(), _batch.size())) {
+            // Some packets may be still scrambled, stop before the first one.
+            const size_t index = _batch.front() - pkt;
+            status[index] = TSP_END;
+            return index + 1;
+        }
+    }
+    else {
+        for (size_t i = 0; i < count; ++i) {
+            status[i] = processPacket(pkt[i], pkt_data[i]);
+            if (status[i] == TSP_END) {
+                return i + 1;
+            }
+        }
+    }
+    return count;
+}
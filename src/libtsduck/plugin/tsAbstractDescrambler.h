@@ -62,6 +62,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual size_t processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*) override;
 
     protected:
         //!
@@ -267,6 +268,7 @@ namespace ts {
         bool               _swap_cw;           // Swap even/odd CW from ECM.
         TSScrambling       _scrambling;        // Default descrambling (used with fixed control words).
         PIDSet             _pids;              // Explicit PID's to descramble.
+        std::vector<TSPacket*> _batch;         // Packets to descramble in a batch of packets.
         ServiceDiscovery   _service;           // Service to descramble (by name, id or none).
         size_t             _stack_usage;       // Stack usage for ECM deciphering.
         SectionDemux       _demux;             // Section demux to extract ECM's.
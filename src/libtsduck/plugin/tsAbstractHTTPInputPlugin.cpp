@@ -66,18 +66,19 @@ bool ts::AbstractHTTPInputPlugin::start()
 
 bool ts::AbstractHTTPInputPlugin::handleWebStart(const WebRequest& request, size_t size)
 {
-    // Get complete MIME type.
-    const UString mime(request.mimeType());
+    return startTransfer(request.finalURL(), request.mimeType(), size);
+}
 
+bool ts::AbstractHTTPInputPlugin::startTransfer(const UString& url, const UString& mime, size_t size)
+{
     // Print a message.
-    tsp->verbose(u"downloading from %s", {request.finalURL()});
+    tsp->verbose(u"downloading from %s", {url});
     tsp->verbose(u"MIME type: %s, expected size: %s", {mime.empty() ? u"unknown" : mime, size == 0 ? u"unknown" : UString::Format(u"%d bytes", {size})});
     if (!mime.empty() && !mime.similar(u"video/mp2t")) {
         tsp->warning(u"MIME type is %d, maybe not a valid transport stream", {mime});
     }
 
     // Create the auto-save file when necessary.
-    const UString url(request.finalURL());
     if (!_autoSaveDir.empty() && !url.empty()) {
         const UString name(_autoSaveDir + PathSeparator + BaseName(url));
         tsp->verbose(u"saving input TS to %s", {name});
@@ -96,6 +97,11 @@ bool ts::AbstractHTTPInputPlugin::handleWebStart(const WebRequest& request, size
 //----------------------------------------------------------------------------
 
 bool ts::AbstractHTTPInputPlugin::handleWebStop(const WebRequest& request)
+{
+    return stopTransfer();
+}
+
+bool ts::AbstractHTTPInputPlugin::stopTransfer()
 {
     // Close auto save file if one was open.
     if (_outSave.isOpen()) {
@@ -127,6 +133,11 @@ bool ts::AbstractHTTPInputPlugin::pushPackets(const TSPacket* buffer, size_t cou
 //----------------------------------------------------------------------------
 
 bool ts::AbstractHTTPInputPlugin::handleWebData(const WebRequest& request, const void* addr, size_t size)
+{
+    return transferData(addr, size);
+}
+
+bool ts::AbstractHTTPInputPlugin::transferData(const void* addr, size_t size)
 {
     const uint8_t* data = reinterpret_cast<const uint8_t*>(addr);
 
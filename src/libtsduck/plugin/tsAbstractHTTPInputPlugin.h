@@ -73,6 +73,33 @@ namespace ts {
         virtual bool handleWebData(const WebRequest& request, const void* data, size_t size) override;
         virtual bool handleWebStop(const WebRequest& request) override;
 
+        //!
+        //! Start the transfer of a new content.
+        //! This is what handleWebStart() does. Subclasses which download contents
+        //! by other means (in memory for instance) use this method directly.
+        //! @param [in] url Final URL of the content.
+        //! @param [in] mime MIME type of the content.
+        //! @param [in] size Expected content size in bytes, zero if unknown.
+        //! @return True on success, false on error or requested termination.
+        //!
+        bool startTransfer(const UString& url, const UString& mime, size_t size);
+
+        //!
+        //! Push a chunk of data from the current content.
+        //! This is what handleWebData() does.
+        //! @param [in] data Address of data chunk.
+        //! @param [in] size Size of data chunk in bytes.
+        //! @return True on success, false on error or requested termination.
+        //!
+        bool transferData(const void* data, size_t size);
+
+        //!
+        //! Terminate the transfer of the current content.
+        //! This is what handleWebStop() does.
+        //! @return True on success, false on error.
+        //!
+        bool stopTransfer();
+
     private:
         TSPacket     _partial;       // Buffer for incomplete packets.
         size_t       _partial_size;  // Number of bytes in partial.
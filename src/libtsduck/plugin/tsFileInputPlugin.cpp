@@ -42,6 +42,8 @@ ts::FileInputPlugin::FileInputPlugin(TSP* tsp_) :
     _first_terminate(false),
     _interleave_chunk(0),
     _interleave_remain(0),
+    _read_ahead(false),
+    _read_ahead_size(0),
     _current_filename(0),
     _current_file(0),
     _repeat_count(1),
@@ -94,6 +96,16 @@ ts::FileInputPlugin::FileInputPlugin(TSP* tsp_) :
          u"Start reading each file at the specified TS packet (default: 0). "
          u"This option is allowed only if all input files are regular files.");
 
+    option(u"read-ahead", 0, INTEGER, 0, 1, TSFile::MIN_READ_AHEAD_SIZE, UNLIMITED_VALUE, true);
+    help(u"read-ahead",
+         u"Read the input files in read-ahead mode. "
+         u"Regular files are read through memory-mapped windows which slide over the files. "
+         u"Other files (pipes, standard input) are read by an internal thread into a read-ahead buffer. "
+         u"This reduces the number of system calls when processing large files. "
+         u"The optional value is the size in bytes of the window or buffer (default: " +
+         UString::Decimal(TSFile::DEFAULT_READ_AHEAD_SIZE) + u" bytes). "
+         u"This option is available on UNIX systems only and is ignored on other systems.");
+
     option(u"repeat", 'r', POSITIVE);
     help(u"repeat",
          u"Repeat the playout of each file the specified number of times (default: only once). "
@@ -115,6 +127,8 @@ bool ts::FileInputPlugin::getOptions()
     _interleave_chunk = intValue<size_t>(u"interleave", 1);
     _first_terminate = present(u"first-terminate");
     _base_label = intValue<size_t>(u"label-base", TSPacketMetadata::LABEL_MAX + 1);
+    _read_ahead = present(u"read-ahead");
+    _read_ahead_size = intValue<size_t>(u"read-ahead", TSFile::DEFAULT_READ_AHEAD_SIZE);
 
     // If there is no file, then this is the standard input, an empty file name.
     if (_filenames.empty()) {
@@ -155,6 +169,7 @@ bool ts::FileInputPlugin::openFile(size_t name_index, size_t file_index)
     }
 
     // Actually open the file.
+    _files[file_index].setReadAhead(_read_ahead, _read_ahead_size);
     return _files[file_index].openRead(name, _repeat_count, _start_offset, *tsp);
 }
 
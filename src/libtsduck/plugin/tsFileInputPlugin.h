@@ -64,6 +64,8 @@ namespace ts {
         bool          _first_terminate;    // With _interleave, terminate when the first file terminates.
         size_t        _interleave_chunk;   // Number of packets per chunk when _interleave.
         size_t        _interleave_remain;  // Remaining packets to read in current chunk of current file.
+        bool          _read_ahead;         // Use memory-mapped or read-ahead input.
+        size_t        _read_ahead_size;    // Size of read-ahead window.
         size_t        _current_filename;   // Current file index in _filenames.
         size_t        _current_file;       // Current file index in _files. Depends on _interleave.
         size_t        _repeat_count;
@@ -28,8 +28,17 @@
 //----------------------------------------------------------------------------
 
 #include "tsFileOutputPlugin.h"
+#include "tsGuard.h"
+#include "tsGuardCondition.h"
+#include "tsSysUtils.h"
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::FileOutputPlugin::DEFAULT_WRITE_BUFFERS;
+constexpr size_t ts::FileOutputPlugin::WRITE_BUFFER_PACKETS;
+constexpr ts::MilliSecond ts::FileOutputPlugin::MAX_BUFFER_DELAY;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Constructor
@@ -39,7 +48,25 @@ ts::FileOutputPlugin::FileOutputPlugin(TSP* tsp_) :
     OutputPlugin(tsp_, u"Write packets to a file", u"[options] [file-name]"),
     _name(),
     _flags(TSFile::NONE),
-    _file()
+    _max_size(0),
+    _max_duration(0),
+    _max_files(0),
+    _wb_count(0),
+    _file(),
+    _file_size(0),
+    _next_rotation(),
+    _created_files(),
+    _writer(this),
+    _mutex(),
+    _wb_filled(),
+    _wb_emptied(),
+    _wb_memory(),
+    _wb_buffers(),
+    _wb_full(),
+    _wb_free(),
+    _wb_current(NPOS),
+    _wb_terminate(false),
+    _wb_error(false)
 {
     option(u"", 0, STRING, 0, 1);
     help(u"", u"Name of the created output file. Use standard output by default.");
@@ -47,13 +74,62 @@ ts::FileOutputPlugin::FileOutputPlugin(TSP* tsp_) :
     option(u"append", 'a');
     help(u"append", u"If the file already exists, append to the end of the file. By default, existing files are overwritten.");
 
+    option(u"direct", 0);
+    help(u"direct",
+         u"Use direct I/O, bypassing the system cache, when the file system supports it (Linux only). "
+         u"Direct I/O is efficient with --write-behind, when large aligned buffers are written.");
+
     option(u"keep", 'k');
     help(u"keep", u"Keep existing file (abort if the specified file already exists). By default, existing files are overwritten.");
+
+    option(u"max-duration", 0, POSITIVE);
+    help(u"max-duration",
+         u"Specify a maximum duration in seconds during which an output file is written. "
+         u"After the specified duration, the current output file is closed and a new one is created. "
+         u"The created files have names like name-YYYYMMDD-hhmmss.ts, "
+         u"using the local time when the file is created.");
+
+    option(u"max-files", 0, POSITIVE);
+    help(u"max-files",
+         u"With --max-size or --max-duration, specify a maximum number of files. "
+         u"When the number of created files exceeds this value, the oldest files are deleted. "
+         u"By default, all created files are kept.");
+
+    option(u"max-size", 0, POSITIVE);
+    help(u"max-size",
+         u"Specify a maximum size in bytes for the output files. "
+         u"When a new write would exceed this size, the current output file is closed and a new one is created. "
+         u"The created files have names like name-YYYYMMDD-hhmmss.ts, "
+         u"using the local time when the file is created.");
+
+    option(u"write-behind", 0, INTEGER, 0, 1, 2, UNLIMITED_VALUE, true);
+    help(u"write-behind",
+         u"Write packets asynchronously from an internal thread. "
+         u"The packets are first copied into a pool of buffers of " + UString::Decimal(WRITE_BUFFER_PACKETS) + u" packets each. "
+         u"The optional value is the number of buffers (default: " + UString::Decimal(DEFAULT_WRITE_BUFFERS) + u"). "
+         u"The output is blocked only when all buffers are waiting to be written. "
+         u"Use this option to prevent a slow storage from stalling the packet processing.");
+}
+
+
+//----------------------------------------------------------------------------
+// Destructor
+//----------------------------------------------------------------------------
+
+ts::FileOutputPlugin::~FileOutputPlugin()
+{
+    // Make sure the writer thread is terminated.
+    {
+        GuardCondition lock(_mutex, _wb_filled);
+        _wb_terminate = true;
+        lock.signal();
+    }
+    _writer.waitForTermination();
 }
 
 
 //----------------------------------------------------------------------------
-// Output plugin methods
+// Output command line options method
 //----------------------------------------------------------------------------
 
 bool ts::FileOutputPlugin::getOptions()
@@ -66,20 +142,271 @@ bool ts::FileOutputPlugin::getOptions()
     if (present(u"keep")) {
         _flags |= TSFile::KEEP;
     }
+    if (present(u"direct")) {
+        _flags |= TSFile::DIRECT;
+    }
+    _max_size = intValue<uint64_t>(u"max-size", 0);
+    _max_duration = intValue<Second>(u"max-duration", 0);
+    _max_files = intValue<size_t>(u"max-files", 0);
+    _wb_count = present(u"write-behind") ? intValue<size_t>(u"write-behind", DEFAULT_WRITE_BUFFERS) : 0;
+
+    if ((_max_size > 0 || _max_duration > 0) && _name.empty()) {
+        tsp->error(u"--max-size and --max-duration cannot be used on standard output");
+        return false;
+    }
     return true;
 }
 
+
+//----------------------------------------------------------------------------
+// Output start method
+//----------------------------------------------------------------------------
+
 bool ts::FileOutputPlugin::start()
 {
-    return _file.open(_name, _flags, *tsp);
+    _created_files.clear();
+    if (!openFile()) {
+        return false;
+    }
+
+    if (_wb_count > 0) {
+        // Allocate all write-behind buffers in one memory area, aligned for direct I/O.
+        const size_t buffer_size = WRITE_BUFFER_PACKETS * PKT_SIZE;
+        _wb_memory.resize(_wb_count * buffer_size + TSFile::DIRECT_IO_ALIGNMENT);
+        uint8_t* base = _wb_memory.data();
+        base += (TSFile::DIRECT_IO_ALIGNMENT - reinterpret_cast<uintptr_t>(base) % TSFile::DIRECT_IO_ALIGNMENT) % TSFile::DIRECT_IO_ALIGNMENT;
+
+        _wb_buffers.resize(_wb_count);
+        _wb_full.clear();
+        _wb_free.clear();
+        for (size_t i = 0; i < _wb_count; ++i) {
+            _wb_buffers[i].data = reinterpret_cast<TSPacket*>(base + i * buffer_size);
+            _wb_buffers[i].count = 0;
+            _wb_free.push_back(_wb_count - 1 - i);
+        }
+        _wb_current = NPOS;
+        _wb_terminate = false;
+        _wb_error = false;
+
+        // Start the writer thread.
+        _writer.setAttributes(ThreadAttributes().setStackSize(stackUsage()));
+        if (!_writer.start()) {
+            tsp->error(u"cannot start file writer thread");
+            closeFile();
+            return false;
+        }
+    }
+    return true;
 }
 
+
+//----------------------------------------------------------------------------
+// Output stop method
+//----------------------------------------------------------------------------
+
 bool ts::FileOutputPlugin::stop()
 {
-    return _file.close(*tsp);
+    if (_wb_count > 0) {
+        // Write the last partial buffer and wait for the writer thread to write all buffers.
+        queueCurrentBuffer();
+        {
+            GuardCondition lock(_mutex, _wb_filled);
+            _wb_terminate = true;
+            lock.signal();
+        }
+        _writer.waitForTermination();
+    }
+    return closeFile() && !_wb_error;
 }
 
+
+//----------------------------------------------------------------------------
+// Output method
+//----------------------------------------------------------------------------
+
 bool ts::FileOutputPlugin::send(const TSPacket* buffer, const TSPacketMetadata* pkt_data, size_t packet_count)
 {
+    // Synchronous write.
+    if (_wb_count == 0) {
+        return writePackets(buffer, packet_count);
+    }
+
+    // Write-behind, copy packets into buffers.
+    const Time now(Time::CurrentUTC());
+    while (packet_count > 0 && !_wb_error) {
+
+        // Get a free buffer if there is none.
+        if (_wb_current == NPOS) {
+            GuardCondition lock(_mutex, _wb_emptied);
+            while (_wb_free.empty() && !_wb_error) {
+                lock.waitCondition();
+            }
+            if (_wb_error) {
+                break;
+            }
+            _wb_current = _wb_free.back();
+            _wb_free.pop_back();
+            _wb_buffers[_wb_current].count = 0;
+            _wb_buffers[_wb_current].start = now;
+        }
+
+        // Fill the current buffer.
+        WriteBuffer& wb(_wb_buffers[_wb_current]);
+        const size_t count = std::min(packet_count, WRITE_BUFFER_PACKETS - wb.count);
+        TSPacket::Copy(wb.data + wb.count, buffer, count);
+        wb.count += count;
+        buffer += count;
+        packet_count -= count;
+
+        // Queue the buffer when full.
+        if (wb.count >= WRITE_BUFFER_PACKETS) {
+            queueCurrentBuffer();
+        }
+    }
+
+    // Do not keep data too long in memory at low bitrates.
+    if (_wb_current != NPOS && now - _wb_buffers[_wb_current].start >= MAX_BUFFER_DELAY) {
+        queueCurrentBuffer();
+    }
+
+    return !_wb_error;
+}
+
+
+//----------------------------------------------------------------------------
+// Queue the current write-behind buffer for writing.
+//----------------------------------------------------------------------------
+
+void ts::FileOutputPlugin::queueCurrentBuffer()
+{
+    if (_wb_current != NPOS) {
+        GuardCondition lock(_mutex, _wb_filled);
+        _wb_full.push_back(_wb_current);
+        _wb_current = NPOS;
+        lock.signal();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Writer thread.
+//----------------------------------------------------------------------------
+
+ts::FileOutputPlugin::Writer::Writer(FileOutputPlugin* plugin) :
+    _plugin(plugin)
+{
+}
+
+ts::FileOutputPlugin::Writer::~Writer()
+{
+    waitForTermination();
+}
+
+void ts::FileOutputPlugin::Writer::main()
+{
+    _plugin->tsp->debug(u"file writer thread started");
+
+    for (;;) {
+        // Wait for a buffer to write.
+        size_t index = NPOS;
+        {
+            GuardCondition lock(_plugin->_mutex, _plugin->_wb_filled);
+            while (_plugin->_wb_full.empty() && !_plugin->_wb_terminate) {
+                lock.waitCondition();
+            }
+            if (_plugin->_wb_full.empty()) {
+                break; // terminated and nothing more to write
+            }
+            index = _plugin->_wb_full.front();
+            _plugin->_wb_full.pop_front();
+        }
+
+        // Write the buffer, outside the mutex. After an error, the buffers are just released.
+        WriteBuffer& wb(_plugin->_wb_buffers[index]);
+        if (!_plugin->_wb_error && !_plugin->writePackets(wb.data, wb.count)) {
+            _plugin->_wb_error = true;
+        }
+
+        // Release the buffer.
+        {
+            GuardCondition lock(_plugin->_mutex, _plugin->_wb_emptied);
+            wb.count = 0;
+            _plugin->_wb_free.push_back(index);
+            lock.signal();
+        }
+    }
+
+    _plugin->tsp->debug(u"file writer thread completed");
+}
+
+
+//----------------------------------------------------------------------------
+// Open the output file, with rotation.
+//----------------------------------------------------------------------------
+
+bool ts::FileOutputPlugin::openFile()
+{
+    UString name(_name);
+
+    if (_max_size > 0 || _max_duration > 0) {
+        // Build a file name with the local creation time.
+        const Time::Fields now(Time::CurrentLocalTime());
+        const UString base(UString::Format(u"%s-%04d%02d%02d-%02d%02d%02d", {PathPrefix(_name), now.year, now.month, now.day, now.hour, now.minute, now.second}));
+        const UString suffix(PathSuffix(_name));
+        name = base + suffix;
+
+        // Several files may be created within the same second.
+        for (int index = 1; std::find(_created_files.begin(), _created_files.end(), name) != _created_files.end(); ++index) {
+            name = UString::Format(u"%s-%d%s", {base, index, suffix});
+        }
+
+        // Delete the oldest files.
+        _created_files.push_back(name);
+        while (_max_files > 0 && _created_files.size() > _max_files) {
+            tsp->verbose(u"deleting %s", {_created_files.front()});
+            const ErrorCode err = DeleteFile(_created_files.front());
+            if (err != SYS_SUCCESS) {
+                tsp->error(u"error deleting %s: %s", {_created_files.front(), ErrorCodeMessage(err)});
+            }
+            _created_files.pop_front();
+        }
+        tsp->verbose(u"creating %s", {name});
+    }
+
+    _file_size = 0;
+    if (_max_duration > 0) {
+        _next_rotation = Time::CurrentUTC() + _max_duration * MilliSecPerSec;
+    }
+    return _file.open(name, _flags, *tsp);
+}
+
+
+//----------------------------------------------------------------------------
+// Close the output file.
+//----------------------------------------------------------------------------
+
+bool ts::FileOutputPlugin::closeFile()
+{
+    return !_file.isOpen() || _file.close(*tsp);
+}
+
+
+//----------------------------------------------------------------------------
+// Write packets to the output file, with rotation.
+//----------------------------------------------------------------------------
+
+bool ts::FileOutputPlugin::writePackets(const TSPacket* buffer, size_t packet_count)
+{
+    const uint64_t size = uint64_t(packet_count) * PKT_SIZE;
+
+    // Rotate the file when it exceeds its maximum size or duration.
+    if (_file_size > 0 &&
+        ((_max_size > 0 && _file_size + size > _max_size) || (_max_duration > 0 && Time::CurrentUTC() >= _next_rotation)) &&
+        (!closeFile() || !openFile()))
+    {
+        return false;
+    }
+
+    _file_size += size;
     return _file.write(buffer, packet_count, *tsp);
 }
@@ -35,12 +35,20 @@
 #pragma once
 #include "tsPlugin.h"
 #include "tsTSFile.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsTime.h"
 
 namespace ts {
     //!
     //! File output plugin for tsp.
     //! @ingroup plugin
     //!
+    //! Packets can be written asynchronously by an internal I/O thread (write-behind),
+    //! so that a slow storage does not stall the tsp output thread. The output file
+    //! can be periodically rotated based on its size or duration.
+    //!
     class TSDUCKDLL FileOutputPlugin: public OutputPlugin
     {
         TS_NOBUILD_NOCOPY(FileOutputPlugin);
@@ -51,6 +59,28 @@ namespace ts {
         //!
         FileOutputPlugin(TSP* tsp);
 
+        //!
+        //! Destructor.
+        //!
+        virtual ~FileOutputPlugin() override;
+
+        //!
+        //! Default number of write-behind buffers.
+        //!
+        static constexpr size_t DEFAULT_WRITE_BUFFERS = 16;
+
+        //!
+        //! Number of TS packets in each write-behind buffer.
+        //! The size of a buffer is a multiple of TSFile::DIRECT_IO_ALIGNMENT.
+        //!
+        static constexpr size_t WRITE_BUFFER_PACKETS = 4096;
+
+        //!
+        //! Maximum time in milliseconds a partially filled write-behind buffer is kept
+        //! before being written. This limits the amount of data in memory at low bitrates.
+        //!
+        static constexpr MilliSecond MAX_BUFFER_DELAY = 1000;
+
         // Implementation of plugin API
         virtual bool getOptions() override;
         virtual bool start() override;
@@ -58,8 +88,63 @@ namespace ts {
         virtual bool send(const TSPacket*, const TSPacketMetadata*, size_t) override;
 
     private:
+        // Internal thread which writes the write-behind buffers.
+        class Writer : public Thread
+        {
+            TS_NOBUILD_NOCOPY(Writer);
+        public:
+            // Constructor & destructor.
+            Writer(FileOutputPlugin* plugin);
+            virtual ~Writer();
+            virtual void main() override;
+        private:
+            FileOutputPlugin* _plugin;
+        };
+
+        // Description of a write-behind buffer.
+        struct WriteBuffer
+        {
+            TSPacket* data;   // Aligned address of the buffer.
+            size_t    count;  // Number of packets in the buffer.
+            Time      start;  // Time of first packet in the buffer.
+
+            // Constructor.
+            WriteBuffer() : data(nullptr), count(0), start() {}
+        };
+
+        // Command line options.
         UString           _name;
         TSFile::OpenFlags _flags;
+        uint64_t          _max_size;      // Rotate file when its size exceeds this value, zero if none.
+        Second            _max_duration;  // Rotate file after this duration, zero if none.
+        size_t            _max_files;     // Maximum number of rotated files to keep, zero if unlimited.
+        size_t            _wb_count;      // Number of write-behind buffers, zero for synchronous writes.
+
+        // File state.
         TSFile            _file;
+        uint64_t          _file_size;     // Current file size in bytes.
+        Time              _next_rotation; // Time of next file rotation with _max_duration.
+        UStringList       _created_files; // Rotated files, oldest first.
+
+        // Write-behind state.
+        Writer                   _writer;
+        Mutex                    _mutex;        // Protect the following fields.
+        Condition                _wb_filled;    // Signaled when a buffer is ready to write or on termination.
+        Condition                _wb_emptied;   // Signaled when a buffer becomes free.
+        ByteBlock                _wb_memory;    // Memory area of all buffers.
+        std::vector<WriteBuffer> _wb_buffers;   // All buffers.
+        std::deque<size_t>       _wb_full;      // Indexes of buffers to write, in order.
+        std::vector<size_t>      _wb_free;      // Indexes of free buffers.
+        size_t                   _wb_current;   // Index of buffer being filled, NPOS if none, tsp thread only.
+        bool                     _wb_terminate; // Request termination of writer thread.
+        volatile bool            _wb_error;     // Write error in writer thread.
+
+        // Open, close, write the output file, with rotation.
+        bool openFile();
+        bool closeFile();
+        bool writePackets(const TSPacket* buffer, size_t packet_count);
+
+        // Queue the current write-behind buffer for writing.
+        void queueCurrentBuffer();
     };
 }
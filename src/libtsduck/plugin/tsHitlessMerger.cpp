@@ -0,0 +1,336 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsHitlessMerger.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::HitlessMerger::MAX_LOOKAHEAD;
+#endif
+
+namespace {
+    // Smoothing factor of the relative latency of inputs.
+    constexpr ts::MilliSecond LATENCY_SMOOTHING = 16;
+
+    // FNV-1a 64-bit hash, used to compute packet fingerprints.
+    constexpr uint64_t FNV_OFFSET = TS_UCONST64(0xCBF29CE484222325);
+    constexpr uint64_t FNV_PRIME = TS_UCONST64(0x00000100000001B3);
+
+    uint64_t Hash(const uint8_t* data, size_t size, uint64_t hash = FNV_OFFSET)
+    {
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ data[i]) * FNV_PRIME;
+        }
+        return hash;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+ts::HitlessMerger::InputInterface::~InputInterface()
+{
+}
+
+ts::HitlessMerger::Input::Input(InputInterface* in) :
+    input(in),
+    running(false),
+    pending(false),
+    head(0),
+    arrival(),
+    latency16(0),
+    samples(0),
+    outputPackets(0),
+    recoveredPackets(0)
+{
+}
+
+ts::HitlessMerger::HitlessMerger(MilliSecond delay, size_t maxHistory) :
+    _delay(delay),
+    _maxHistory(maxHistory),
+    _inputs(),
+    _history(),
+    _historySet()
+{
+}
+
+size_t ts::HitlessMerger::addInput(InputInterface* input)
+{
+    _inputs.push_back(Input(input));
+    return _inputs.size() - 1;
+}
+
+void ts::HitlessMerger::setRunning(size_t index, bool running)
+{
+    _inputs.at(index).running = running;
+}
+
+
+//----------------------------------------------------------------------------
+// Compute the fingerprints of packets.
+//----------------------------------------------------------------------------
+
+ts::HitlessMerger::Fingerprinter::Fingerprinter(size_t window, bool useRTP) :
+    _window(std::max<size_t>(window, 1)),
+    _useRTP(useRTP),
+    _position(0),
+    _lastContent(0),
+    _lastPrint(0),
+    _anchor(0),
+    _sameCount(0),
+    _nullCount(0),
+    _rtpSequence(-1),
+    _rtpIndex(0),
+    _seen()
+{
+}
+
+void ts::HitlessMerger::Fingerprinter::reset()
+{
+    _position = 0;
+    _lastContent = _lastPrint = _anchor = 0;
+    _sameCount = _nullCount = 0;
+    _rtpSequence = -1;
+    _rtpIndex = 0;
+    _seen.clear();
+}
+
+uint64_t ts::HitlessMerger::Fingerprinter::fingerprint(const TSPacket& pkt, const TSPacketMetadata& data)
+{
+    const uint64_t content = Hash(pkt.b, PKT_SIZE);
+    const PacketCounter position = _position++;
+    uint8_t id[8 + 4 + 4];
+
+    // With RTP, all packets are identified by their position in the RTP stream.
+    if (_useRTP && data.hasRTPSequence()) {
+        const int32_t sequence = int32_t(data.getRTPSequence());
+        _rtpIndex = sequence == _rtpSequence ? _rtpIndex + 1 : 0;
+        _rtpSequence = sequence;
+        PutUInt64(id, content);
+        PutUInt32(id + 8, uint32_t(sequence));
+        PutUInt32(id + 12, _rtpIndex);
+        return Hash(id, sizeof(id));
+    }
+
+    // Null packets are all identical. Identify them by their position after the last non-null packet.
+    if (pkt.getPID() == PID_NULL) {
+        PutUInt64(id, _lastPrint);
+        PutUInt32(id + 8, _sameCount);
+        PutUInt32(id + 12, _nullCount++);
+        return Hash(id, sizeof(id), content);
+    }
+
+    // Other packets are usually unique. Their content, including the continuity counter and the PCR,
+    // is their identity. This is independent from losses in the stream. Packets which are repeated
+    // in the same window, such as stuffing, are identified by their position after the last distinct
+    // packet. Forget packets which are out of the window from time to time.
+    if (content == _lastContent) {
+        _sameCount++;
+    }
+    else {
+        _anchor = _lastPrint;
+        _lastContent = content;
+        _sameCount = 0;
+    }
+    _nullCount = 0;
+
+    const auto it = _seen.find(content);
+    if (it == _seen.end() || position - it->second > _window) {
+        _lastPrint = content;
+    }
+    else {
+        PutUInt64(id, _anchor);
+        PutUInt32(id + 8, _sameCount);
+        PutUInt32(id + 12, 0xFFFFFFFF);
+        _lastPrint = Hash(id, sizeof(id), content);
+    }
+    _seen[content] = position;
+
+    if (position % _window == 0) {
+        for (auto seen = _seen.begin(); seen != _seen.end(); ) {
+            seen = position - seen->second > _window ? _seen.erase(seen) : std::next(seen);
+        }
+    }
+    return _lastPrint;
+}
+
+
+//----------------------------------------------------------------------------
+// Merge the packets from all inputs.
+//----------------------------------------------------------------------------
+
+size_t ts::HitlessMerger::merge(TSPacket* packets, TSPacketMetadata* metadata, size_t maxPackets, size_t preferred, const Time& now, MilliSecond& timeout)
+{
+    const size_t inCount = _inputs.size();
+    size_t outCount = 0;
+
+    while (outCount < maxPackets) {
+
+        // Get the next packet of each running input. Drop packets which were already output from
+        // another input, as well as late packets, when the packet after them was already output.
+        size_t runningCount = 0;
+        size_t pendingCount = 0;
+        Time oldest(Time::Apocalypse);
+        for (auto it = _inputs.begin(); it != _inputs.end(); ++it) {
+            it->pending = false;
+            if (it->running) {
+                runningCount++;
+                uint64_t next = 0;
+                Time nextArrival;
+                while (!it->pending && it->input->getFingerprint(0, it->head, it->arrival)) {
+                    if (!alreadyOutput(it->head) && !(it->input->getFingerprint(1, next, nextArrival) && alreadyOutput(next))) {
+                        it->pending = true;
+                        pendingCount++;
+                        oldest = std::min(oldest, it->arrival);
+                    }
+                    else {
+                        it->input->extractPacket(it->head, nullptr, nullptr);
+                    }
+                }
+            }
+        }
+        if (pendingCount == 0) {
+            break;
+        }
+
+        // Unless all running inputs have delivered something, wait for the others, up to the maximum latency.
+        if (pendingCount < runningCount) {
+            const MilliSecond age = now - oldest;
+            if (age < _delay) {
+                if (outCount == 0) {
+                    timeout = _delay - age;
+                }
+                break;
+            }
+        }
+
+        // Select the input to output from. Skip an input when its next packet is preceded by other
+        // packets in another input: they were lost and must be output first. When several inputs
+        // have distinct packets which are missing elsewhere, use their distance to the next common
+        // packet or, when there is none, the earliest received one. On equal reception times,
+        // prefer the preferred input.
+        size_t sel = NPOS;
+        size_t fallback = NPOS;
+        for (size_t k = 0; k < inCount; ++k) {
+            const size_t i = (preferred + k) % inCount;
+            const Input& in(_inputs[i]);
+            if (in.pending) {
+                bool preceded = false;
+                for (size_t j = 0; !preceded && j < inCount; ++j) {
+                    const Input& other(_inputs[j]);
+                    preceded = j != i && other.pending && other.head != in.head && other.input->findFingerprint(in.head) != NPOS;
+                }
+                if (fallback == NPOS) {
+                    fallback = i;
+                }
+                if (!preceded && (sel == NPOS || comesBefore(in, _inputs[sel]))) {
+                    sel = i;
+                }
+            }
+        }
+        if (sel == NPOS) {
+            // Inconsistent order between inputs, use the first one.
+            sel = fallback;
+        }
+        Input& in(_inputs[sel]);
+
+        // The packet is recovered when at least one other input has lost it.
+        // When other inputs delivered the same packet, learn their relative latency.
+        bool recovered = false;
+        bool shared = false;
+        Time first(in.arrival);
+        for (size_t j = 0; j < inCount; ++j) {
+            const Input& other(_inputs[j]);
+            if (j != sel && other.pending) {
+                if (other.head == in.head) {
+                    shared = true;
+                    first = std::min(first, other.arrival);
+                }
+                else if (other.input->findFingerprint(in.head) == NPOS) {
+                    recovered = true;
+                }
+            }
+        }
+        for (auto it = _inputs.begin(); shared && it != _inputs.end(); ++it) {
+            if (it->pending && it->head == in.head) {
+                // Cumulative average on first samples, then exponential moving average.
+                it->samples = std::min(it->samples + 1, LATENCY_SMOOTHING);
+                it->latency16 += (16 * (it->arrival - first) - it->latency16) / it->samples;
+            }
+        }
+
+        // Move the packet to output. May fail if the input dropped it in the meantime.
+        if (in.input->extractPacket(in.head, &packets[outCount], &metadata[outCount])) {
+            outCount++;
+            in.outputPackets++;
+            if (recovered) {
+                in.recoveredPackets++;
+            }
+            _history.push_back(std::make_pair(in.head, now));
+            _historySet.insert(in.head);
+        }
+    }
+
+    // Forget old output packets. Duplicates cannot come later than the maximum latency and
+    // identical packets (e.g. repeated tables with the same continuity counter) may come later.
+    while (!_history.empty() && (_history.size() > _maxHistory || _history.front().second + 2 * _delay < now)) {
+        _historySet.erase(_historySet.find(_history.front().first));
+        _history.pop_front();
+    }
+    return outCount;
+}
+
+
+//----------------------------------------------------------------------------
+// Check if the next packet of an input comes before the next packet of another
+// input, when both packets are missing in the other input.
+//----------------------------------------------------------------------------
+
+bool ts::HitlessMerger::comesBefore(const Input& in1, const Input& in2) const
+{
+    // Find the first packet after the head of in1 which is also in in2. The input
+    // with more packets before this common packet has the earliest next packet.
+    // This is meaningless when both inputs have the same next packet.
+    uint64_t fingerprint = 0;
+    Time arrival;
+    for (size_t index1 = 1; in1.head != in2.head && index1 <= MAX_LOOKAHEAD && in1.input->getFingerprint(index1, fingerprint, arrival); ++index1) {
+        const size_t index2 = in2.input->findFingerprint(fingerprint);
+        if (index2 != NPOS) {
+            if (index2 != index1) {
+                return index1 > index2;
+            }
+            break;
+        }
+    }
+
+    // Same packet, no common packet or same distance, use the earliest received one, after latency compensation.
+    return Compensated(in1) < Compensated(in2);
+}
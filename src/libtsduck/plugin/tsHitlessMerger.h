@@ -0,0 +1,235 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Merge of redundant transport streams in hitless mode.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSPacket.h"
+#include "tsTSPacketMetadata.h"
+#include "tsTime.h"
+
+namespace ts {
+    //!
+    //! Merge of redundant transport streams in hitless mode, in the style of SMPTE 2022-7.
+    //! @ingroup plugin
+    //!
+    //! Each input delivers the same transport stream, with distinct losses. Each packet is
+    //! identified by a fingerprint. The merger takes each packet from the first input which
+    //! delivered it, drops duplicate and late packets and waits for the slowest inputs up to
+    //! a maximum delay. This class is not thread-safe, the packets of the inputs are accessed
+    //! through an abstract interface which shall implement its own synchronization.
+    //!
+    class TSDUCKDLL HitlessMerger
+    {
+        TS_NOCOPY(HitlessMerger);
+    public:
+        //!
+        //! Abstract interface to the packets which are received by an input.
+        //!
+        class TSDUCKDLL InputInterface
+        {
+        public:
+            //!
+            //! Get the fingerprint of a received packet.
+            //! @param [in] index Index of the packet, relative to the next packet to output.
+            //! @param [out] fingerprint Fingerprint of the packet.
+            //! @param [out] arrival Reception time of the packet.
+            //! @return True on success, false if there is no such packet.
+            //!
+            virtual bool getFingerprint(size_t index, uint64_t& fingerprint, Time& arrival) = 0;
+
+            //!
+            //! Search a fingerprint in the received packets.
+            //! This method is frequently called and should not perform a linear search.
+            //! @param [in] fingerprint Fingerprint to search.
+            //! @return Index of the first packet with this fingerprint, relative to the
+            //! next packet to output, or NPOS if not found.
+            //!
+            virtual size_t findFingerprint(uint64_t fingerprint) = 0;
+
+            //!
+            //! Remove the next packet to output.
+            //! @param [in] fingerprint Expected fingerprint of the next packet to output.
+            //! @param [out] packet If not null, receive a copy of the packet.
+            //! @param [out] data If not null, receive a copy of the packet metadata.
+            //! @return True if the packet was removed, false if the next packet has another fingerprint.
+            //!
+            virtual bool extractPacket(uint64_t fingerprint, TSPacket* packet, TSPacketMetadata* data) = 0;
+
+            //!
+            //! Virtual destructor.
+            //!
+            virtual ~InputInterface();
+        };
+
+        //!
+        //! Compute the fingerprints of the successive packets of a stream.
+        //! Two identical streams produce the same fingerprints and identical packets in a stream
+        //! produce distinct fingerprints.
+        //!
+        //! When the packets carry an RTP sequence number, the fingerprint is a hash of the packet
+        //! content, the RTP sequence number and the index of the packet in the datagram. All inputs
+        //! must then carry the same RTP sequence numbers, as in SMPTE 2022-7.
+        //!
+        //! Otherwise, the fingerprint of a packet is a hash of its content, including the continuity
+        //! counter and the PCR. Null packets, and packets which were already seen in the last
+        //! @a window packets, are additionally identified by their position after the previous
+        //! distinct packets. Consequently, when the packet before them is lost in one input, they
+        //! may be merged twice.
+        //!
+        class TSDUCKDLL Fingerprinter
+        {
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] window Number of packets during which an identical packet is identified by its position.
+            //! This shall be at least the size of the history of the merger.
+            //! @param [in] useRTP When true, use the RTP sequence numbers when they are present.
+            //!
+            Fingerprinter(size_t window, bool useRTP = true);
+
+            //!
+            //! Reset the state, at the beginning of a new stream.
+            //!
+            void reset();
+
+            //!
+            //! Compute the fingerprint of the next packet in the stream.
+            //! @param [in] pkt The packet.
+            //! @param [in] data The packet metadata.
+            //! @return The fingerprint of @a pkt.
+            //!
+            uint64_t fingerprint(const TSPacket& pkt, const TSPacketMetadata& data);
+
+        private:
+            size_t        _window;         // Number of packets to remember.
+            bool          _useRTP;         // Use RTP sequence numbers.
+            PacketCounter _position;       // Position of next packet in the stream.
+            uint64_t      _lastContent;    // Content hash of last non-null packet.
+            uint64_t      _lastPrint;      // Fingerprint of last non-null packet.
+            uint64_t      _anchor;         // Fingerprint of last non-null packet before the run of identical _lastContent.
+            uint32_t      _sameCount;      // Number of packets with content _lastContent since _anchor, minus one.
+            uint32_t      _nullCount;      // Number of null packets since last non-null packet.
+            int32_t       _rtpSequence;    // RTP sequence of previous packet, negative if none.
+            uint32_t      _rtpIndex;       // Index of previous packet in its datagram.
+            std::unordered_map<uint64_t, PacketCounter> _seen;  // Content hash => last position.
+        };
+
+        //!
+        //! Maximum number of packets to look ahead in inputs to order packets which were lost in other inputs.
+        //!
+        static constexpr size_t MAX_LOOKAHEAD = 256;
+
+        //!
+        //! Constructor.
+        //! @param [in] delay Maximum time to wait for the inputs which did not deliver a packet.
+        //! @param [in] maxHistory Maximum number of output fingerprints to remember.
+        //! This shall not be larger than the window of the fingerprinters of the inputs.
+        //!
+        HitlessMerger(MilliSecond delay, size_t maxHistory);
+
+        //!
+        //! Add an input.
+        //! @param [in] input Interface to the packets of the new input. Initially not running.
+        //! The object must remain valid as long as the merger is used.
+        //! @return The index of the new input.
+        //!
+        size_t addInput(InputInterface* input);
+
+        //!
+        //! Declare that an input is running or not. The merger does not wait for inputs which are not running.
+        //! @param [in] index Index of the input.
+        //! @param [in] running True when the input is running.
+        //!
+        void setRunning(size_t index, bool running);
+
+        //!
+        //! Merge the packets from all inputs.
+        //! @param [out] packets Address of the buffer for merged packets.
+        //! @param [out] metadata Address of the buffer for the metadata of the merged packets.
+        //! @param [in] maxPackets Maximum number of packets in @a packets and @a metadata.
+        //! @param [in] preferred Index of the preferred input, when packets arrived at the same time.
+        //! @param [in] now Current time, used to compute the waiting time of the received packets.
+        //! @param [out] timeout When no packet is merged because some inputs are late, time to wait
+        //! for more packets. Unmodified otherwise.
+        //! @return Number of merged packets.
+        //!
+        size_t merge(TSPacket* packets, TSPacketMetadata* metadata, size_t maxPackets, size_t preferred, const Time& now, MilliSecond& timeout);
+
+        //!
+        //! Get the number of merged packets which came from an input.
+        //! @param [in] index Index of the input.
+        //! @return Number of merged packets from that input.
+        //!
+        PacketCounter outputPackets(size_t index) const { return _inputs.at(index).outputPackets; }
+
+        //!
+        //! Get the number of merged packets which came from an input and were lost in other inputs.
+        //! @param [in] index Index of the input.
+        //! @return Number of recovered packets from that input.
+        //!
+        PacketCounter recoveredPackets(size_t index) const { return _inputs.at(index).recoveredPackets; }
+
+    private:
+        // State of an input.
+        class Input
+        {
+        public:
+            Input(InputInterface* in = nullptr);
+            InputInterface* input;             // Access to received packets.
+            bool            running;           // Input is currently running.
+            bool            pending;           // There is a next packet to merge (during merge() only).
+            uint64_t        head;              // Fingerprint of next packet to merge, when pending.
+            Time            arrival;           // Reception time of next packet to merge, when pending.
+            MilliSecond     latency16;         // Smoothed latency relative to the fastest input, in 1/16 milliseconds.
+            MilliSecond     samples;           // Number of latency samples, up to LATENCY_SMOOTHING.
+            PacketCounter   outputPackets;     // Number of merged packets from this input.
+            PacketCounter   recoveredPackets;  // Number of merged packets which were missing in other inputs.
+        };
+
+        const MilliSecond               _delay;       // Maximum waiting time for late inputs.
+        const size_t                    _maxHistory;  // Maximum number of output fingerprints to remember.
+        std::vector<Input>              _inputs;      // All inputs.
+        std::deque<std::pair<uint64_t,Time>> _history;    // Fingerprints and output times of last output packets.
+        std::unordered_multiset<uint64_t> _historySet;    // Same fingerprints, for fast search.
+
+        // Check if a fingerprint was recently output.
+        bool alreadyOutput(uint64_t fingerprint) const { return _historySet.find(fingerprint) != _historySet.end(); }
+
+        // Check if the next packet of an input comes before the next packet of another input,
+        // when both packets are missing in the other input.
+        bool comesBefore(const Input& in1, const Input& in2) const;
+
+        // Reception time of the next packet of an input, compensated by the latency of the input.
+        static Time Compensated(const Input& in) { return in.arrival - in.latency16 / 16; }
+    };
+}
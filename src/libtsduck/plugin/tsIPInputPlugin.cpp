@@ -32,14 +32,20 @@
 #include "tsSysUtils.h"
 TSDUCK_SOURCE;
 
+// Maximum number of datagrams to receive in one system call.
+namespace {
+    constexpr size_t IP_MAX_DATAGRAMS = 32;
+}
 
 //----------------------------------------------------------------------------
 // Input constructor
 //----------------------------------------------------------------------------
 
 ts::IPInputPlugin::IPInputPlugin(TSP* tsp_) :
-    AbstractDatagramInputPlugin(tsp_, IP_MAX_PACKET_SIZE, u"Receive TS packets from UDP/IP, multicast or unicast", u"[options] [address:]port"),
-    _sock(*tsp_)
+    AbstractDatagramInputPlugin(tsp_, IP_MAX_PACKET_SIZE, u"Receive TS packets from UDP/IP, multicast or unicast", u"[options] [address:]port", IP_MAX_DATAGRAMS),
+    _sock(*tsp_),
+    _senders(IP_MAX_DATAGRAMS),
+    _destinations(IP_MAX_DATAGRAMS)
 {
     // Add UDP receiver common options.
     _sock.defineArgs(*this);
@@ -113,3 +119,8 @@ bool ts::IPInputPlugin::receiveDatagram(void* buffer, size_t buffer_size, size_t
     SocketAddress destination;
     return _sock.receive(buffer, buffer_size, ret_size, sender, destination, tsp, *tsp);
 }
+
+bool ts::IPInputPlugin::receiveDatagrams(void* buffer, size_t buffer_size, size_t max_count, size_t& ret_count, size_t* ret_sizes, MicroSecond* timestamps)
+{
+    return _sock.receiveBatch(buffer, buffer_size, std::min(max_count, _senders.size()), ret_count, ret_sizes, _senders.data(), _destinations.data(), timestamps, tsp, *tsp);
+}
@@ -61,8 +61,11 @@ namespace ts {
     protected:
         // Implementation of AbstractDatagramInputPlugin.
         virtual bool receiveDatagram(void* buffer, size_t buffer_size, size_t& ret_size) override;
+        virtual bool receiveDatagrams(void* buffer, size_t buffer_size, size_t max_count, size_t& ret_count, size_t* ret_sizes, MicroSecond* timestamps) override;
 
     private:
-        UDPReceiver _sock; // Incoming socket with associated command line options.
+        UDPReceiver _sock;                         // Incoming socket with associated command line options.
+        std::vector<SocketAddress> _senders;       // Senders of last received datagrams.
+        std::vector<SocketAddress> _destinations;  // Destinations of last received datagrams.
     };
 }
@@ -29,6 +29,7 @@
 
 #include "tsIPOutputPlugin.h"
 #include "tsSystemRandomGenerator.h"
+#include "tsNullReport.h"
 TSDUCK_SOURCE;
 
 // Grouping TS packets in UDP packets
@@ -36,6 +37,13 @@ TSDUCK_SOURCE;
 #define DEF_PACKET_BURST    7  // 1316 B, fits (with headers) in Ethernet MTU
 #define MAX_PACKET_BURST  128  // ~ 48 kB
 
+// Pacing of datagrams.
+
+#define DEF_PACING_DELAY    5  // milliseconds, default delay between submission and transmission with SO_TXTIME
+#define PACING_SPIN_TIME    (NanoSecPerMilliSec)        // actively wait the last millisecond before transmission
+#define PACING_MAX_LATE     (50 * NanoSecPerMilliSec)   // resynchronize when later than this
+#define PACING_MAX_JUMP     (NanoSecPerSec)             // resynchronize when time stamps jump more than this
+
 
 //----------------------------------------------------------------------------
 // Output constructor
@@ -58,16 +66,31 @@ ts::IPOutputPlugin::IPOutputPlugin(TSP* tsp_) :
     _rtp_fixed_ssrc(false),
     _rtp_user_ssrc(0),
     _rtp_ssrc(0),
+    _pacing(false),
+    _pacing_tai(false),
+    _busy_wait(false),
+    _pacing_delay(DEF_PACING_DELAY),
     _pcr_user_pid(PID_NULL),
     _pcr_pid(PID_NULL),
     _last_pcr(INVALID_PCR),
     _last_rtp_pcr(INVALID_PCR),
     _last_rtp_pcr_pkt(0),
+    _last_rtp_input_time(INVALID_PCR),
     _rtp_pcr_offset(0),
     _pkt_count(0),
+    _use_txtime(false),
+    _pace_sync(false),
+    _pace_origin(),
+    _pace_origin_txtime(0),
+    _pace_offset(0),
+    _pace_pcr(0),
+    _pace_last(0),
+    _pace_times(),
     _sock(false, *tsp_),
     _out_count(0),
-    _out_buffer()
+    _out_buffer(),
+    _out_metadata(),
+    _rtp_buffer()
 {
     option(u"", 0, STRING, 1, 1);
     help(u"",
@@ -76,6 +99,11 @@ ts::IPOutputPlugin::IPOutputPlugin(TSP* tsp_) :
          u"multicast. It can be also a host name that translates to an IP address. "
          u"The 'port' specifies the destination UDP port.");
 
+    option(u"busy-wait");
+    help(u"busy-wait",
+         u"With --pacing, always use a busy-wait timer in the output thread, "
+         u"even when the system supports transmission times on sockets.");
+
     option(u"enforce-burst", 'e');
     help(u"enforce-burst",
          u"Enforce that the number of TS packets per UDP packet is exactly what is specified "
@@ -92,6 +120,30 @@ ts::IPOutputPlugin::IPOutputPlugin(TSP* tsp_) :
          u"Specify the local UDP source port for outgoing packets. "
          u"By default, a random source port is used.");
 
+    option(u"pacing");
+    help(u"pacing",
+         u"Pace the transmission of UDP datagrams at the rate of the transport stream. "
+         u"The transmission time of each datagram is derived from the PCR's of the PCR PID "
+         u"(see --pcr-pid) or, between PCR's, from the bitrate. On Linux, the datagrams are "
+         u"submitted in advance to the kernel with their transmission time (SO_TXTIME socket option). "
+         u"They are transmitted at the right time by the queuing discipline of the output interface "
+         u"which must support transmission times, typically \"fq\" or \"etf\". When this is not "
+         u"supported, the output thread waits for the transmission time of each datagram using "
+         u"a busy-wait timer. Do not use this option with plugins which regulate the output "
+         u"such as regulate or pcrbitrate.");
+
+    option(u"pacing-delay", 0, POSITIVE);
+    help(u"pacing-delay", u"milliseconds",
+         u"With --pacing, when transmission times are supported by the system, specify the delay "
+         u"between the submission of a datagram to the kernel and its transmission time. This delay "
+         u"must be larger than the scheduling latency of the system and the \"delta\" parameter of "
+         u"an \"etf\" queuing discipline. The default is " TS_STRINGIFY(DEF_PACING_DELAY) u" milliseconds.");
+
+    option(u"pacing-tai");
+    help(u"pacing-tai",
+         u"With --pacing, express the transmission times in the TAI clock, as required by the "
+         u"\"etf\" queuing discipline. By default, the monotonic clock is used, as required by \"fq\".");
+
     option(u"packet-burst", 'p', INTEGER, 0, 1, 1, MAX_PACKET_BURST);
     help(u"packet-burst",
          u"Specifies the maximum number of TS packets per UDP packet. "
@@ -121,7 +173,8 @@ ts::IPOutputPlugin::IPOutputPlugin(TSP* tsp_) :
 
     option(u"pcr-pid", 0, PIDVAL);
     help(u"pcr-pid",
-        u"With --rtp, specify the PID containing the PCR's which are used as reference for RTP timestamps. "
+        u"With --rtp or --pacing, specify the PID containing the PCR's which are used as reference for "
+        u"RTP timestamps or transmission times. "
         u"By default, use the first PID containing PCR's.");
 
     option(u"start-sequence-number", 0, UINT16);
@@ -167,6 +220,10 @@ bool ts::IPOutputPlugin::getOptions()
     _rtp_fixed_ssrc = present(u"ssrc-identifier");
     _rtp_user_ssrc = intValue<uint32_t>(u"ssrc-identifier");
     _pcr_user_pid = intValue<PID>(u"pcr-pid", PID_NULL);
+    _pacing = present(u"pacing");
+    _pacing_tai = present(u"pacing-tai");
+    _busy_wait = present(u"busy-wait");
+    _pacing_delay = intValue<MilliSecond>(u"pacing-delay", DEF_PACING_DELAY);
     return true;
 }
 
@@ -197,6 +254,7 @@ bool ts::IPOutputPlugin::start()
     // The output buffer is empty.
     if (_enforce_burst) {
         _out_buffer.resize(_pkt_burst);
+        _out_metadata.resize(_pkt_burst);
         _out_count = 0;
     }
 
@@ -220,13 +278,27 @@ bool ts::IPOutputPlugin::start()
         }
     }
 
+    // Configure pacing. Use transmission times when supported, a busy-wait timer otherwise.
+    _use_txtime = false;
+    if (_pacing) {
+        _use_txtime = !_busy_wait && _sock.setTransmitTime(true, _pacing_tai, NULLREP);
+        tsp->verbose(u"pacing output using %s", {_use_txtime ? u"socket transmission times" : u"busy-wait timer"});
+        _pace_origin.getSystemTime();
+        _pace_origin_txtime = _sock.getTransmitClock();
+    }
+
     // Other states.
     _pcr_pid = _pcr_user_pid;
     _last_pcr = INVALID_PCR;
     _last_rtp_pcr = 0;  // Always start timestamps at zero
     _last_rtp_pcr_pkt = 0;
+    _last_rtp_input_time = INVALID_PCR;
     _rtp_pcr_offset = 0;
     _pkt_count = 0;
+    _pace_sync = false;
+    _pace_offset = 0;
+    _pace_pcr = 0;
+    _pace_last = 0;
 
     return true;
 }
@@ -262,26 +334,30 @@ bool ts::IPOutputPlugin::send(const TSPacket* pkt, const TSPacketMetadata* pkt_d
         // Copy as many packets as possible in output buffer.
         const size_t count = std::min(packet_count, _pkt_burst - _out_count);
         TSPacket::Copy(&_out_buffer[_out_count], pkt, count);
+        std::copy(pkt_data, pkt_data + count, _out_metadata.begin() + _out_count);
         pkt += count;
+        pkt_data += count;
         packet_count -= count;
         _out_count += count;
 
         // Send the output buffer when full.
         if (_out_count == _pkt_burst) {
-            if (!sendDatagram(_out_buffer.data(), _out_count)) {
+            if (!sendDatagrams(_out_buffer.data(), _out_metadata.data(), _out_count)) {
                 return false;
             }
             _out_count = 0;
         }
     }
 
-    // Send subsequent packets from the global buffer.
-    while (packet_count > min_burst) {
-        size_t count = std::min(packet_count, _pkt_burst);
-        if (!sendDatagram(pkt, count)) {
+    // Send subsequent packets from the global buffer, all datagrams at once.
+    // With --enforce-burst, only send complete datagrams.
+    if (packet_count > min_burst) {
+        const size_t count = _enforce_burst ? packet_count - packet_count % _pkt_burst : packet_count;
+        if (!sendDatagrams(pkt, pkt_data, count)) {
             return false;
         }
         pkt += count;
+        pkt_data += count;
         packet_count -= count;
     }
 
@@ -291,6 +367,7 @@ bool ts::IPOutputPlugin::send(const TSPacket* pkt, const TSPacketMetadata* pkt_d
         assert(_out_count == 0);
         assert(packet_count < _pkt_burst);
         TSPacket::Copy(_out_buffer.data(), pkt, packet_count);
+        std::copy(pkt_data, pkt_data + packet_count, _out_metadata.begin());
         _out_count = packet_count;
     }
     return true;
@@ -298,110 +375,240 @@ bool ts::IPOutputPlugin::send(const TSPacket* pkt, const TSPacketMetadata* pkt_d
 
 
 //----------------------------------------------------------------------------
-// Send contiguous packets in one single datagram.
+// Send contiguous packets in datagrams of _pkt_burst packets (the last one can
+// be shorter). All datagrams are sent in one batch, when the system supports it.
 //----------------------------------------------------------------------------
 
-bool ts::IPOutputPlugin::sendDatagram(const TSPacket* pkt, size_t packet_count)
+bool ts::IPOutputPlugin::sendDatagrams(const TSPacket* pkt, const TSPacketMetadata* pkt_data, size_t packet_count)
 {
-    bool status = true;
-
+    // With RTP, all datagrams are built contiguously in one buffer.
+    // Without RTP, TS packets are directly sent as datagrams.
+    const size_t header_size = _use_rtp ? RTP_HEADER_SIZE : 0;
+    const size_t dgram_size = header_size + _pkt_burst * PKT_SIZE;
+    const size_t dgram_count = (packet_count + _pkt_burst - 1) / _pkt_burst;
+    const size_t size = dgram_count * header_size + packet_count * PKT_SIZE;
     if (_use_rtp) {
-        // RTP datagram are relatively trivial to build, except the time stamp.
-        // We cannot use the wall clock time because the plugin is likely to burst its output.
-        // So, we try to synchronize RTP timestamps with PCR's from one PID.
-        // But this is not trivial since the PCR may not be accurate or may loop back.
-        // As long as the first PCR is not seen, increment timestamps from zero, using TS bitrate as reference.
-        // At the first PCR, compute the difference between the current RTP timestamp and this PCR.
-        // Then keep this difference and resynchronize at each PCR.
-        // But never jump back in RTP timestamps, only increase "more slowly" when adjusting.
-
-        // Build an RTP datagram. Use a simple RTP header without options nor extensions.
-        ByteBlock buffer(RTP_HEADER_SIZE + packet_count * PKT_SIZE);
-
-        // Build the RTP header, except the timestamp.
-        buffer[0] = 0x80;             // Version = 2, P = 0, X = 0, CC = 0
-        buffer[1] = _rtp_pt & 0x7F;   // M = 0, payload type
-        PutUInt16(&buffer[2], _rtp_sequence++);
-        PutUInt32(&buffer[8], _rtp_ssrc);
-
-        // Get current bitrate to compute timestamps.
-        const BitRate bitrate = tsp->bitrate();
-
-        // Look for a PCR in one of the packets to send.
-        // If found, we adjust this PCR for the first packet in the datagram.
-        uint64_t pcr = INVALID_PCR;
-        for (size_t i = 0; i < packet_count; i++) {
-            const bool hasPCR = pkt[i].hasPCR();
-            const PID pid = pkt[i].getPID();
-
-            // Detect PCR PID if not yet known.
-            if (hasPCR && _pcr_pid == PID_NULL) {
-                _pcr_pid = pid;
+        _rtp_buffer.resize(size);
+    }
+    const uint8_t* const buffer = _use_rtp ? _rtp_buffer.data() : pkt->b;
+
+    if (_use_rtp || _pacing) {
+        // Compute the time stamp of each datagram.
+        _pace_times.resize(dgram_count);
+        uint8_t* data = _rtp_buffer.data();
+        for (size_t i = 0; i < dgram_count; ++i) {
+            const size_t count = std::min(packet_count, _pkt_burst);
+            const uint64_t time = datagramTime(pkt, pkt_data, count);
+            if (_use_rtp) {
+                buildRTPHeader(data, time);
+                // Copy the TS packets after the RTP header.
+                ::memcpy(data + RTP_HEADER_SIZE, pkt, count * PKT_SIZE);
+                data += RTP_HEADER_SIZE + count * PKT_SIZE;
+            }
+            if (_pacing) {
+                _pace_times[i] = transmitTime(time);
             }
+            pkt += count;
+            pkt_data += count;
+            packet_count -= count;
+            // Count packets datagram per datagram.
+            _pkt_count += count;
+        }
+    }
+    else {
+        _pkt_count += packet_count;
+    }
 
-            // Detect PCR presence.
-            if (hasPCR && pid == _pcr_pid) {
-                pcr = pkt[i].getPCR();
-                // If the bitrate is known and the packet containing the PCR is not the first one,
-                // compute the theoretical timestamp of the first packet in the datagram.
-                if (i > 0 && bitrate > 0) {
-                    pcr -= (i * 8 * PKT_SIZE * uint64_t(SYSTEM_CLOCK_FREQ)) / bitrate;
-                }
-                break;
+    if (!_pacing) {
+        return _sock.sendBatch(buffer, size, dgram_size, *tsp);
+    }
+    else if (_use_txtime) {
+        // Do not queue datagrams too much in advance in the kernel. Submit groups of datagrams
+        // when the first one is due within the pacing delay, up to one pacing delay later.
+        const NanoSecond lead = _pacing_delay * NanoSecPerMilliSec;
+        for (size_t first = 0; first < dgram_count; ) {
+            size_t last = first + 1;
+            while (last < dgram_count && last - first < UDPSocket::MAX_BATCH_MESSAGES && _pace_times[last] <= _pace_times[first] + lead) {
+                last++;
+            }
+            waitUntil(_pace_times[first] - lead, 0);
+            for (size_t i = first; i < last; ++i) {
+                _pace_times[i] += _pace_origin_txtime;
+            }
+            const size_t offset = first * dgram_size;
+            if (!_sock.sendBatchAt(buffer + offset, std::min(size - offset, (last - first) * dgram_size), dgram_size, &_pace_times[first], *tsp)) {
+                return false;
             }
+            first = last;
         }
+        return true;
+    }
+    else {
+        // Wait for the transmission time of each datagram.
+        for (size_t i = 0; i < dgram_count; ++i) {
+            waitUntil(_pace_times[i], PACING_SPIN_TIME);
+            const size_t offset = i * dgram_size;
+            if (!_sock.send(buffer + offset, std::min(dgram_size, size - offset), *tsp)) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
 
-        // Extrapolate the RTP timestamp from the previous one, using current bitrate.
-        // This value may be replaced if a valid PCR is present in this datagram.
-        uint64_t rtp_pcr = _last_rtp_pcr;
-        if (bitrate > 0) {
-            rtp_pcr += ((_pkt_count - _last_rtp_pcr_pkt) * 8 * PKT_SIZE * uint64_t(SYSTEM_CLOCK_FREQ)) / bitrate;
+//----------------------------------------------------------------------------
+// Compute the transmission time of a datagram from its time stamp.
+//----------------------------------------------------------------------------
+
+ts::NanoSecond ts::IPOutputPlugin::transmitTime(uint64_t time)
+{
+    const NanoSecond now = Monotonic(true) - _pace_origin;
+    const NanoSecond lead = _use_txtime ? _pacing_delay * NanoSecPerMilliSec : 0;
+
+    // Time stamps are never decreasing, they are synchronized with the PCR's.
+    NanoSecond due = 0;
+    if (_pace_sync && time >= _pace_pcr) {
+        due = _pace_offset + NanoSecond(((time - _pace_pcr) * NanoSecPerMicroSec) / (SYSTEM_CLOCK_FREQ / MicroSecPerSec));
+    }
+
+    // Resynchronize on the first datagram, when the output is too late (the input is slower
+    // than the PCR's or was interrupted) or when the time stamps jump in the future.
+    if (!_pace_sync || due + PACING_MAX_LATE < now || due > _pace_last + PACING_MAX_JUMP) {
+        if (_pace_sync) {
+            const NanoSecond delta = due < now ? now - due : due - _pace_last;
+            tsp->verbose(u"pacing resynchronized, datagram was %'d microseconds %s", {delta / NanoSecPerMicroSec, due < now ? u"late" : u"early"});
         }
+        _pace_sync = true;
+        _pace_pcr = time;
+        _pace_offset = due = now + lead;
+    }
+    _pace_last = due;
 
-        // If the current datagram contains a PCR, recompute the RTP timestamp more precisely.
-        if (pcr != INVALID_PCR) {
-            if (_last_pcr == INVALID_PCR || pcr < _last_pcr) {
-                // This is the first PCR in the stream or the PCR has jumped back in the past.
-                // For this time only, we keep the extrapolated PCR.
-                // Compute the difference between PCR and RTP timestamps.
-                _rtp_pcr_offset = pcr - rtp_pcr;
-                tsp->verbose(u"RTP timestamps resynchronized with PCR PID 0x%X (%d)", {_pcr_pid, _pcr_pid});
-                tsp->debug(u"new PCR-RTP offset: %d", {_rtp_pcr_offset});
-            }
-            else {
-                // PCR are normally increasing, drop extrapolated value, resynchronize with PCR.
-                uint64_t adjusted_rtp_pcr = pcr - _rtp_pcr_offset;
-                if (adjusted_rtp_pcr <= _last_rtp_pcr) {
-                    // The adjustment would make the RTP timestamp go backward. We do not want that.
-                    // We increase the RTP timestamp "more slowly", by 25% of the extrapolated value.
-                    tsp->debug(u"RTP adjustment from PCR would step backward by %d", {((_last_rtp_pcr - adjusted_rtp_pcr) * RTP_RATE_MP2T) / SYSTEM_CLOCK_FREQ});
-                    adjusted_rtp_pcr = _last_rtp_pcr + (rtp_pcr - _last_rtp_pcr) / 4;
-                }
-                rtp_pcr = adjusted_rtp_pcr;
-            }
+    // Slightly late datagrams are sent as soon as possible.
+    return std::max(due, now + lead / 2);
+}
 
-            // Keep last PCR value.
-            _last_pcr = pcr;
+
+//----------------------------------------------------------------------------
+// Wait until a transmission time.
+//----------------------------------------------------------------------------
+
+void ts::IPOutputPlugin::waitUntil(NanoSecond due, NanoSecond spin)
+{
+    // Sleep until shortly before the due time, then actively wait.
+    for (;;) {
+        const NanoSecond remain = due - (Monotonic(true) - _pace_origin);
+        if (remain <= 0) {
+            break;
+        }
+        else if (remain > spin) {
+            Monotonic wake(_pace_origin);
+            wake += due - spin;
+            wake.wait();
         }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Build the RTP header of a datagram containing the specified packets.
+//----------------------------------------------------------------------------
 
-        // Insert the RTP timestamp in RTP clock units.
-        PutUInt32(&buffer[4], uint32_t((rtp_pcr * RTP_RATE_MP2T) / SYSTEM_CLOCK_FREQ));
+void ts::IPOutputPlugin::buildRTPHeader(uint8_t* header, uint64_t time)
+{
+    // Use a simple RTP header without options nor extensions.
+    header[0] = 0x80;             // Version = 2, P = 0, X = 0, CC = 0
+    header[1] = _rtp_pt & 0x7F;   // M = 0, payload type
+    PutUInt16(&header[2], _rtp_sequence++);
+    PutUInt32(&header[4], uint32_t((time * RTP_RATE_MP2T) / SYSTEM_CLOCK_FREQ));
+    PutUInt32(&header[8], _rtp_ssrc);
+}
 
-        // Remember position and value of last datagram.
-        _last_rtp_pcr = rtp_pcr;
-        _last_rtp_pcr_pkt = _pkt_count;
 
-        // Copy the TS packets after the RTP header and send the packets.
-        ::memcpy(buffer.data() + RTP_HEADER_SIZE, pkt, packet_count * PKT_SIZE);
-        status = _sock.send(buffer.data(), buffer.size(), *tsp);
+//----------------------------------------------------------------------------
+// Compute the time stamp of a datagram containing the specified packets.
+//----------------------------------------------------------------------------
+
+uint64_t ts::IPOutputPlugin::datagramTime(const TSPacket* pkt, const TSPacketMetadata* pkt_data, size_t packet_count)
+{
+    // The time stamp is used in RTP headers and as transmission time with --pacing.
+    // We cannot use the wall clock time because the plugin is likely to burst its output.
+    // So, we try to synchronize timestamps with PCR's from one PID.
+    // But this is not trivial since the PCR may not be accurate or may loop back.
+    // As long as the first PCR is not seen, increment timestamps from zero, using TS bitrate as reference.
+    // At the first PCR, compute the difference between the current timestamp and this PCR.
+    // Then keep this difference and resynchronize at each PCR.
+    // But never jump back in timestamps, only increase "more slowly" when adjusting.
+
+    // Get current bitrate to compute timestamps.
+    const BitRate bitrate = tsp->bitrate();
+
+    // Look for a PCR in one of the packets to send.
+    // If found, we adjust this PCR for the first packet in the datagram.
+    uint64_t pcr = INVALID_PCR;
+    for (size_t i = 0; i < packet_count; i++) {
+        const bool hasPCR = pkt[i].hasPCR();
+        const PID pid = pkt[i].getPID();
+
+        // Detect PCR PID if not yet known.
+        if (hasPCR && _pcr_pid == PID_NULL) {
+            _pcr_pid = pid;
+        }
+
+        // Detect PCR presence.
+        if (hasPCR && pid == _pcr_pid) {
+            pcr = pkt[i].getPCR();
+            // If the bitrate is known and the packet containing the PCR is not the first one,
+            // compute the theoretical timestamp of the first packet in the datagram.
+            if (i > 0 && bitrate > 0) {
+                pcr -= (i * 8 * PKT_SIZE * uint64_t(SYSTEM_CLOCK_FREQ)) / bitrate;
+            }
+            break;
+        }
     }
-    else {
-        // No RTP, send TS packets directly as datagram.
-        status = _sock.send(pkt, packet_count * PKT_SIZE, *tsp);
+
+    // Extrapolate the timestamp from the previous one, using the input time stamps of
+    // the packets when available or the current bitrate otherwise.
+    // This value may be replaced if a valid PCR is present in this datagram.
+    const uint64_t input_time = pkt_data[0].getInputTimeStamp();
+    uint64_t rtp_pcr = _last_rtp_pcr;
+    if (input_time != INVALID_PCR && _last_rtp_input_time != INVALID_PCR && input_time >= _last_rtp_input_time) {
+        rtp_pcr += input_time - _last_rtp_input_time;
     }
+    else if (bitrate > 0) {
+        rtp_pcr += ((_pkt_count - _last_rtp_pcr_pkt) * 8 * PKT_SIZE * uint64_t(SYSTEM_CLOCK_FREQ)) / bitrate;
+    }
+
+    // If the current datagram contains a PCR, recompute the RTP timestamp more precisely.
+    if (pcr != INVALID_PCR) {
+        if (_last_pcr == INVALID_PCR || pcr < _last_pcr) {
+            // This is the first PCR in the stream or the PCR has jumped back in the past.
+            // For this time only, we keep the extrapolated PCR.
+            // Compute the difference between PCR and RTP timestamps.
+            _rtp_pcr_offset = pcr - rtp_pcr;
+            tsp->verbose(u"datagram timestamps resynchronized with PCR PID 0x%X (%d)", {_pcr_pid, _pcr_pid});
+            tsp->debug(u"new PCR-RTP offset: %d", {_rtp_pcr_offset});
+        }
+        else {
+            // PCR are normally increasing, drop extrapolated value, resynchronize with PCR.
+            uint64_t adjusted_rtp_pcr = pcr - _rtp_pcr_offset;
+            if (adjusted_rtp_pcr <= _last_rtp_pcr) {
+                // The adjustment would make the RTP timestamp go backward. We do not want that.
+                // We increase the RTP timestamp "more slowly", by 25% of the extrapolated value.
+                tsp->debug(u"RTP adjustment from PCR would step backward by %d", {((_last_rtp_pcr - adjusted_rtp_pcr) * RTP_RATE_MP2T) / SYSTEM_CLOCK_FREQ});
+                adjusted_rtp_pcr = _last_rtp_pcr + (rtp_pcr - _last_rtp_pcr) / 4;
+            }
+            rtp_pcr = adjusted_rtp_pcr;
+        }
 
-    // Count packets datagram per datagram.
-    _pkt_count += packet_count;
+        // Keep last PCR value.
+        _last_pcr = pcr;
+    }
 
-    return status;
+    // Remember position and value of last datagram.
+    _last_rtp_pcr = rtp_pcr;
+    _last_rtp_pcr_pkt = _pkt_count;
+    _last_rtp_input_time = input_time;
+    return rtp_pcr;
 }
@@ -35,6 +35,7 @@
 #pragma once
 #include "tsPlugin.h"
 #include "tsUDPSocket.h"
+#include "tsMonotonic.h"
 
 namespace ts {
     //!
@@ -74,18 +75,45 @@ namespace ts {
         bool           _rtp_fixed_ssrc;     // RTP SSRC id has a fixed value
         uint32_t       _rtp_user_ssrc;      // RTP user-specified SSRC id
         uint32_t       _rtp_ssrc;           // RTP current SSRC id (constant during a session)
+        bool           _pacing;             // Pace the output of datagrams.
+        bool           _pacing_tai;         // Use the TAI clock for SO_TXTIME.
+        bool           _busy_wait;          // Always use busy-wait pacing, not SO_TXTIME.
+        MilliSecond    _pacing_delay;       // Delay between submission and transmission with SO_TXTIME.
         PID            _pcr_user_pid;       // User-specified PCR PID.
         PID            _pcr_pid;            // Current PCR PID.
         uint64_t       _last_pcr;           // Last PCR value in PCR PID
         uint64_t       _last_rtp_pcr;       // Last RTP timestamp in PCR units (in last datagram)
         PacketCounter  _last_rtp_pcr_pkt;   // Packet index of last datagram
+        uint64_t       _last_rtp_input_time; // Input time stamp of first packet in last datagram
         uint64_t       _rtp_pcr_offset;     // Value to substract from PCR to get RTP timestamp
         PacketCounter  _pkt_count;          // Total packet counter for output packets
+        bool           _use_txtime;         // Pacing uses SO_TXTIME (otherwise busy-wait).
+        bool           _pace_sync;          // Pacing time origin is set.
+        Monotonic      _pace_origin;        // Origin of pacing transmission times.
+        NanoSecond     _pace_origin_txtime; // Value of the SO_TXTIME clock at _pace_origin.
+        NanoSecond     _pace_offset;        // Transmission time of _pace_pcr, in nanoseconds after _pace_origin.
+        uint64_t       _pace_pcr;           // Datagram time stamp (PCR units) at _pace_offset.
+        NanoSecond     _pace_last;          // Transmission time of last datagram, in nanoseconds after _pace_origin.
+        std::vector<NanoSecond> _pace_times; // Transmission times of datagrams to send.
         UDPSocket      _sock;               // Outgoing socket
         size_t         _out_count;          // Number of packets in _out_buffer
         TSPacketVector _out_buffer;         // Buffered packets for output with --enforce-burst
+        TSPacketMetadataVector _out_metadata; // Metadata of buffered packets
+        ByteBlock      _rtp_buffer;         // Contiguous RTP datagrams to send
 
-        // Send contiguous packets in one single datagram.
-        bool sendDatagram(const TSPacket* pkt, size_t packet_count);
+        // Send contiguous packets in datagrams of _pkt_burst packets, the last one can be shorter.
+        bool sendDatagrams(const TSPacket* pkt, const TSPacketMetadata* pkt_data, size_t packet_count);
+
+        // Compute the time stamp of a datagram containing the specified packets, in PCR units.
+        uint64_t datagramTime(const TSPacket* pkt, const TSPacketMetadata* pkt_data, size_t packet_count);
+
+        // Build the RTP header of a datagram with the specified time stamp.
+        void buildRTPHeader(uint8_t* header, uint64_t time);
+
+        // Compute the transmission time of a datagram from its time stamp, in nanoseconds after _pace_origin.
+        NanoSecond transmitTime(uint64_t time);
+
+        // Wait until a transmission time, in nanoseconds after _pace_origin.
+        void waitUntil(NanoSecond due, NanoSecond spin);
     };
 }
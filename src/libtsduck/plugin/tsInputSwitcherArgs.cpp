@@ -39,6 +39,8 @@ constexpr size_t ts::InputSwitcherArgs::MIN_OUTPUT_PACKETS;
 constexpr size_t ts::InputSwitcherArgs::DEFAULT_BUFFERED_PACKETS;
 constexpr size_t ts::InputSwitcherArgs::MIN_BUFFERED_PACKETS;
 constexpr ts::MilliSecond ts::InputSwitcherArgs::DEFAULT_RECEIVE_TIMEOUT;
+constexpr size_t ts::InputSwitcherArgs::DEFAULT_HITLESS_BUFFERED_PACKETS;
+constexpr ts::MilliSecond ts::InputSwitcherArgs::DEFAULT_HITLESS_DELAY;
 #endif
 
 
@@ -50,6 +52,8 @@ ts::InputSwitcherArgs::InputSwitcherArgs() :
     appName(),
     fastSwitch(false),
     delayedSwitch(false),
+    hitless(false),
+    hitlessRTP(true),
     terminate(false),
     monitor(false),
     reusePort(false),
@@ -63,6 +67,7 @@ ts::InputSwitcherArgs::InputSwitcherArgs() :
     remoteServer(),
     allowedRemote(),
     receiveTimeout(0),
+    hitlessDelay(DEFAULT_HITLESS_DELAY),
     inputs(),
     output()
 {
@@ -72,6 +77,8 @@ ts::InputSwitcherArgs::InputSwitcherArgs(const InputSwitcherArgs& other) :
     appName(other.appName),
     fastSwitch(other.fastSwitch),
     delayedSwitch(other.delayedSwitch),
+    hitless(other.hitless),
+    hitlessRTP(other.hitlessRTP),
     terminate(other.terminate),
     monitor(other.monitor),
     reusePort(other.reusePort),
@@ -85,6 +92,7 @@ ts::InputSwitcherArgs::InputSwitcherArgs(const InputSwitcherArgs& other) :
     remoteServer(other.remoteServer),
     allowedRemote(other.allowedRemote),
     receiveTimeout(other.receiveTimeout),
+    hitlessDelay(std::max<MilliSecond>(other.hitlessDelay, 0)),
     inputs(other.inputs),
     output(other.output)
 {
@@ -98,6 +106,11 @@ ts::InputSwitcherArgs::InputSwitcherArgs(const InputSwitcherArgs& other) :
     if (receiveTimeout <= 0 && primaryInput != NPOS) {
         receiveTimeout = DEFAULT_RECEIVE_TIMEOUT;
     }
+    if (hitless) {
+        // Hitless mode needs all input plugins to run in parallel.
+        fastSwitch = true;
+        delayedSwitch = false;
+    }
 }
 
 
@@ -115,7 +128,10 @@ void ts::InputSwitcherArgs::defineArgs(Args& args) const
     args.option(u"buffer-packets", 'b', Args::POSITIVE);
     args.help(u"buffer-packets",
               u"Specify the size in TS packets of each input plugin buffer. "
-              u"The default is " + UString::Decimal(DEFAULT_BUFFERED_PACKETS) + u" packets.");
+              u"The default is " + UString::Decimal(DEFAULT_BUFFERED_PACKETS) + u" packets, " +
+              UString::Decimal(DEFAULT_HITLESS_BUFFERED_PACKETS) + u" packets with --hitless. "
+              u"With --hitless, the buffer shall be large enough to contain --hitless-delay "
+              u"milliseconds of input.");
 
     args.option(u"cycle", 'c', Args::POSITIVE);
     args.help(u"cycle",
@@ -145,6 +161,33 @@ void ts::InputSwitcherArgs::defineArgs(Args& args) const
               u"Specify the index of the first input plugin to start. "
               u"By default, the first plugin (index 0) is used.");
 
+    args.option(u"hitless");
+    args.help(u"hitless",
+              u"Perform hitless (seamless protection) redundancy, in the style of SMPTE 2022-7. "
+              u"All input plugins are started at once and are expected to receive the same "
+              u"transport stream through distinct paths. The packets are aligned on content, "
+              u"using a fingerprint of each packet, and each packet is output from the first "
+              u"input plugin which delivered it. Packets which are lost on one input are "
+              u"recovered from the others without any switching delay, at the cost of a bounded "
+              u"added latency (see --hitless-delay). This option implies --fast-switch. "
+              u"When available, RTP sequence numbers are used to align the inputs. In that case, "
+              u"all inputs shall carry the same RTP sequence numbers (see --hitless-no-rtp). "
+              u"Input plugins are never restarted: the processing ends when all input plugins "
+              u"have terminated or, with --terminate, when the first one terminates.");
+
+    args.option(u"hitless-delay", 0, Args::UNSIGNED);
+    args.help(u"hitless-delay", u"milliseconds",
+              u"With --hitless, specify the maximum latency which is added to wait for a packet "
+              u"on all inputs before outputting it. This value shall be larger than the maximum "
+              u"transmission skew between the redundant paths. "
+              u"The default is " + UString::Decimal(DEFAULT_HITLESS_DELAY) + u" ms.");
+
+    args.option(u"hitless-no-rtp");
+    args.help(u"hitless-no-rtp",
+              u"With --hitless, do not use the RTP sequence numbers to align the inputs, "
+              u"use the packet content only. Use this option when the inputs are RTP "
+              u"streams from distinct sources, with unrelated sequence numbers.");
+
     args.option(u"infinite", 'i');
     args.help(u"infinite", u"Infinitely repeat the cycle through all input plugins in sequence.");
 
@@ -213,10 +256,13 @@ bool ts::InputSwitcherArgs::loadArgs(DuckContext& duck, Args& args)
     appName = args.appName();
     fastSwitch = args.present(u"fast-switch");
     delayedSwitch = args.present(u"delayed-switch");
+    hitless = args.present(u"hitless");
+    hitlessDelay = args.intValue<MilliSecond>(u"hitless-delay", DEFAULT_HITLESS_DELAY);
+    hitlessRTP = !args.present(u"hitless-no-rtp");
     terminate = args.present(u"terminate");
     cycleCount = args.intValue<size_t>(u"cycle", args.present(u"infinite") ? 0 : 1);
     monitor = args.present(u"monitor");
-    bufferedPackets = args.intValue<size_t>(u"buffer-packets", DEFAULT_BUFFERED_PACKETS);
+    bufferedPackets = args.intValue<size_t>(u"buffer-packets", hitless ? DEFAULT_HITLESS_BUFFERED_PACKETS : DEFAULT_BUFFERED_PACKETS);
     maxInputPackets = std::min(args.intValue<size_t>(u"max-input-packets", DEFAULT_MAX_INPUT_PACKETS), bufferedPackets / 2);
     maxOutputPackets = args.intValue<size_t>(u"max-output-packets", DEFAULT_MAX_OUTPUT_PACKETS);
     const UString remoteName(args.value(u"remote"));
@@ -233,6 +279,13 @@ bool ts::InputSwitcherArgs::loadArgs(DuckContext& duck, Args& args)
     if (fastSwitch && delayedSwitch) {
         args.error(u"options --delayed-switch and --fast-switch are mutually exclusive");
     }
+    if (hitless && delayedSwitch) {
+        args.error(u"options --delayed-switch and --hitless are mutually exclusive");
+    }
+    if (hitless) {
+        // All input plugins are running in parallel in hitless mode.
+        fastSwitch = true;
+    }
 
     // Resolve remote control name.
     if (!remoteName.empty() && remoteServer.resolve(remoteName, args) && !remoteServer.hasPort()) {
@@ -48,6 +48,8 @@ namespace ts {
         UString             appName;           //!< Application name, for help messages.
         bool                fastSwitch;        //!< Fast switch between input plugins.
         bool                delayedSwitch;     //!< Delayed switch between input plugins.
+        bool                hitless;           //!< Hitless redundancy, merge all input plugins (implies fastSwitch).
+        bool                hitlessRTP;        //!< In hitless mode, align the inputs on RTP sequence numbers when present.
         bool                terminate;         //!< Terminate when one input plugin completes.
         bool                monitor;           //!< Run a resource monitoring thread.
         bool                reusePort;         //!< Reuse-port socket option.
@@ -61,6 +63,7 @@ namespace ts {
         SocketAddress       remoteServer;      //!< UDP server addres for remote control.
         IPAddressSet        allowedRemote;     //!< Set of allowed remotes.
         MilliSecond         receiveTimeout;    //!< Receive timeout before switch (0=none).
+        MilliSecond         hitlessDelay;      //!< Maximum added latency in hitless mode.
         PluginOptionsVector inputs;            //!< Input plugins descriptions.
         PluginOptions       output;            //!< Output plugin description.
 
@@ -71,6 +74,8 @@ namespace ts {
         static constexpr size_t      DEFAULT_BUFFERED_PACKETS = 512;   //!< Default input size buffer in packets.
         static constexpr size_t      MIN_BUFFERED_PACKETS = 16;        //!< Minimum input size buffer in packets.
         static constexpr MilliSecond DEFAULT_RECEIVE_TIMEOUT = 2000;   //!< Default received timeout with --primary-input.
+        static constexpr size_t      DEFAULT_HITLESS_BUFFERED_PACKETS = 8192; //!< Default input size buffer in packets with --hitless.
+        static constexpr MilliSecond DEFAULT_HITLESS_DELAY = 100;      //!< Default maximum added latency with --hitless.
 
         //!
         //! Constructor.
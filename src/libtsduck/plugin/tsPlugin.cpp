@@ -73,6 +73,24 @@ ts::ProcessorPlugin::ProcessorPlugin(TSP* tsp_, const UString& description, cons
          u"Other packets are transparently passed to the next plugin, without going through this one. "
          u"Several --only-label options may be specified. "
          u"This is a generic option which is defined in all packet processing plugins.");
+
+    // The options --parallel and --in-branch are defined in all packet processing plugins.
+    option(u"parallel");
+    help(u"parallel",
+         u"Start a new branch of plugins which runs in parallel with the branch containing the previous plugin. "
+         u"All parallel branches receive the same packets at the same time, each branch in its own threads. "
+         u"The plugin after the parallel branches receives the packets when all branches have processed them. "
+         u"In a parallel branch, packets are read-only: the plugins can neither modify, drop nor nullify them. "
+         u"Each plugin in a branch works on a private copy of the packets and its modifications are ignored. "
+         u"This is typically useful to run several monitoring plugins on distinct CPU cores. "
+         u"This is a generic option which is defined in all packet processing plugins.");
+
+    option(u"in-branch");
+    help(u"in-branch",
+         u"When the previous plugin is in a parallel branch (see option --parallel), continue this branch "
+         u"with this plugin. By default, the plugin after a set of parallel branches receives the packets "
+         u"after all branches. "
+         u"This is a generic option which is defined in all packet processing plugins.");
 }
 
 
@@ -110,6 +128,21 @@ ts::TSPacketMetadata::LabelSet ts::ProcessorPlugin::getOnlyLabelOption() const
 }
 
 
+//----------------------------------------------------------------------------
+// Get the content of the --parallel and --in-branch options (packet processing plugins).
+//----------------------------------------------------------------------------
+
+bool ts::ProcessorPlugin::getParallelOption() const
+{
+    return present(u"parallel");
+}
+
+bool ts::ProcessorPlugin::getInBranchOption() const
+{
+    return present(u"in-branch");
+}
+
+
 //----------------------------------------------------------------------------
 // Default implementations of virtual methods.
 //----------------------------------------------------------------------------
@@ -178,3 +211,16 @@ ts::PluginType ts::ProcessorPlugin::type() const
 {
     return PROCESSOR_PLUGIN;
 }
+
+size_t ts::ProcessorPlugin::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    for (size_t i = 0; i < count; ++i) {
+        status[i] = processPacket(pkt[i], pkt_data[i]);
+        // Account for this packet before processing the next one, as in single-packet mode.
+        tsp->addPluginPackets(1);
+        if (status[i] == TSP_END) {
+            return i + 1;
+        }
+    }
+    return count;
+}
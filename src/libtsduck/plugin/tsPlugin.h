@@ -106,7 +106,7 @@ namespace ts {
         //! @c int data named @c tspInterfaceVersion which contains the current
         //! interface version at the time the library is built.
         //!
-        static const int API_VERSION = 13;
+        static const int API_VERSION = 14;
 
         //!
         //! Get the current input bitrate in bits/seconds.
@@ -217,6 +217,9 @@ namespace ts {
     private:
         PacketCounter _total_packets;   // Total processed packets in the plugin thread.
         PacketCounter _plugin_packets;  // Total processed packets in the plugin object.
+
+        // The default implementation of ProcessorPlugin::processPacketBatch() accounts for each packet.
+        friend class ProcessorPlugin;
     };
 
 
@@ -526,6 +529,34 @@ namespace ts {
         //!
         virtual Status processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data) = 0;
 
+        //!
+        //! Packet batch processing interface.
+        //!
+        //! The main application invokes processPacketBatch() to let the shared
+        //! library process a contiguous array of TS packets. All packets in the
+        //! array shall be processed by the plugin: they are neither previously
+        //! dropped nor excluded by --only-label options.
+        //!
+        //! The default implementation invokes processPacket() on each packet.
+        //! Plugins which need to process packets at high speed may override this
+        //! method to avoid the per-packet virtual call and hoist state out of the loop.
+        //!
+        //! Inside processPacketBatch(), @c tsp->pluginPackets() returns the number of
+        //! packets which were submitted to the plugin before the first packet in the batch.
+        //! The index of packet @a i in the batch is <code>tsp->pluginPackets() + i</code>.
+        //! In the default implementation, the counter is updated after each call to
+        //! processPacket(), preserving the semantics of single-packet processing.
+        //!
+        //! @param [in,out] pkt Address of the first TS packet to process.
+        //! @param [in,out] pkt_data Address of the first TS packet metadata.
+        //! @param [in] count Number of packets to process.
+        //! @param [out] status Address of an array of @a count processing status.
+        //! @return The number of processed packets. It is always @a count, except when
+        //! a packet is returned with status TSP_END. In that case, the processing
+        //! stops after this packet and the returned value includes the last packet.
+        //!
+        virtual size_t processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status);
+
         //!
         //! Get the content of the --only-label options.
         //! The value of the option is fetched each time this method is called.
@@ -533,6 +564,18 @@ namespace ts {
         //!
         TSPacketMetadata::LabelSet getOnlyLabelOption() const;
 
+        //!
+        //! Get the content of the --parallel option.
+        //! @return True if the plugin starts a new parallel branch.
+        //!
+        bool getParallelOption() const;
+
+        //!
+        //! Get the content of the --in-branch option.
+        //! @return True if the plugin continues the parallel branch of the previous plugin.
+        //!
+        bool getInBranchOption() const;
+
         // Implementation of inherited interface.
         virtual PluginType type() const override;
 
@@ -0,0 +1,562 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsSharedPacketRing.h"
+#include "tsSysUtils.h"
+#include "tsIntegerUtils.h"
+#include "tsNullReport.h"
+#if defined(TS_UNIX)
+#include <fcntl.h>
+#endif
+#if defined(TS_LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::SharedPacketRing::DEFAULT_PACKET_COUNT;
+constexpr size_t ts::SharedPacketRing::MIN_PACKET_COUNT;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Layout of the shared memory segment.
+//----------------------------------------------------------------------------
+
+// The segment starts with a header, followed by the packet area, followed by
+// the metadata area. The indexes of the producer and the consumer are in
+// distinct cache lines. All fields are accessed by both processes through
+// lock-free atomics only. The xxx_seq fields are futex words: they are
+// incremented to wake up a peer which registered itself in xxx_waiting.
+
+struct ts::SharedPacketRing::Header
+{
+    std::atomic<uint32_t> magic;           // Set last by the producer, when the segment is ready.
+    uint32_t              version;         // Layout version.
+    uint64_t              packet_count;    // Number of packets in the ring.
+    std::atomic<int32_t>  writer_pid;      // Process id of the producer.
+    std::atomic<int32_t>  reader_pid;      // Process id of the consumer, zero if none is attached.
+    std::atomic<uint32_t> bitrate;         // Bitrate of the stream, as set by the producer.
+
+    alignas(64) std::atomic<uint64_t> write_index;  // Total number of written packets.
+    std::atomic<uint32_t> writer_closed;   // Producer has terminated the stream.
+    std::atomic<uint32_t> data_seq;        // Futex word, incremented when data are available.
+    std::atomic<uint32_t> reader_waiting;  // Consumer waits on data_seq.
+
+    alignas(64) std::atomic<uint64_t> read_index;   // Total number of read packets.
+    std::atomic<uint32_t> reader_closed;   // Consumer has detached from the ring.
+    std::atomic<uint32_t> space_seq;       // Futex word, incremented when space is available.
+    std::atomic<uint32_t> writer_waiting;  // Producer waits on space_seq.
+};
+
+// Metadata which are transported with each packet.
+struct ts::SharedPacketRing::SlotMetadata
+{
+    uint64_t input_time;    // Input time stamp, INVALID_PCR if none.
+    uint32_t labels;        // Bit mask of labels.
+    int32_t  rtp_sequence;  // RTP sequence number, negative if none.
+};
+
+namespace {
+    constexpr uint32_t RING_MAGIC = 0x54535348;     // "TSSH"
+    constexpr uint32_t RING_VERSION = 1;
+    constexpr size_t   AREA_ALIGN = 64;             // Alignment of areas in the segment.
+    constexpr ts::MilliSecond OPEN_POLL = 20;       // Polling interval while waiting for the segment.
+    constexpr ts::MilliSecond WAIT_TIMEOUT = 100;   // Max wait time before checking the peer process.
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "std::atomic<uint32_t> cannot be used as futex word");
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "lock-free atomics are required in shared memory");
+
+    // Wait until a futex word is changed, with a bounded timeout.
+    // Without futex, simply poll the segment after a short sleep.
+    void FutexWait(std::atomic<uint32_t>& word, uint32_t value)
+    {
+    #if defined(TS_LINUX)
+        ::timespec timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_nsec = long(WAIT_TIMEOUT * ts::NanoSecPerMilliSec);
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, value, &timeout, nullptr, 0);
+    #else
+        ts::SleepThread(1);
+    #endif
+    }
+
+    // Wake up all processes which wait on a futex word.
+    void FutexWake(std::atomic<uint32_t>& word)
+    {
+    #if defined(TS_LINUX)
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    #endif
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Offsets of the areas and total size of a segment.
+//----------------------------------------------------------------------------
+
+size_t ts::SharedPacketRing::HeaderSize()
+{
+    return RoundUp(sizeof(Header), AREA_ALIGN);
+}
+
+size_t ts::SharedPacketRing::MetadataOffset(size_t count)
+{
+    return HeaderSize() + RoundUp(count * PKT_SIZE, AREA_ALIGN);
+}
+
+size_t ts::SharedPacketRing::SegmentSize(size_t count)
+{
+    return MetadataOffset(count) + count * sizeof(SlotMetadata);
+}
+
+
+//----------------------------------------------------------------------------
+// Serialize packet metadata in the segment and back.
+//----------------------------------------------------------------------------
+
+void ts::SharedPacketRing::EncodeMetadata(SlotMetadata* slots, const TSPacketMetadata* mdata, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (mdata == nullptr) {
+            slots[i].input_time = INVALID_PCR;
+            slots[i].labels = 0;
+            slots[i].rtp_sequence = -1;
+        }
+        else {
+            slots[i].input_time = mdata[i].getInputTimeStamp();
+            slots[i].labels = uint32_t(mdata[i].getLabels().to_ulong());
+            slots[i].rtp_sequence = mdata[i].hasRTPSequence() ? int32_t(mdata[i].getRTPSequence()) : -1;
+        }
+    }
+}
+
+void ts::SharedPacketRing::DecodeMetadata(TSPacketMetadata* mdata, const SlotMetadata* slots, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        mdata[i].reset();
+        mdata[i].setLabels(TSPacketMetadata::LabelSet(slots[i].labels));
+        mdata[i].setInputTimeStamp(slots[i].input_time);
+        if (slots[i].rtp_sequence >= 0) {
+            mdata[i].setRTPSequence(uint16_t(slots[i].rtp_sequence));
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::SharedPacketRing::SharedPacketRing() :
+    _aborted(false),
+    _producer(false),
+    _name(),
+    _count(0),
+    _size(0),
+    _header(nullptr),
+    _packets(nullptr),
+    _mdata(nullptr)
+{
+}
+
+ts::SharedPacketRing::~SharedPacketRing()
+{
+    close(NULLREP);
+}
+
+
+//----------------------------------------------------------------------------
+// Check if the peer process is still alive.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::isAlive(int pid)
+{
+#if defined(TS_UNIX)
+    return pid <= 0 || ::kill(pid_t(pid), 0) == 0 || errno == EPERM;
+#else
+    return true;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Map a segment in memory from an open file descriptor.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::map(int fd, size_t count, Report& report)
+{
+#if defined(TS_WINDOWS)
+    report.error(u"shared memory packet rings are not supported on Windows");
+    return false;
+#else
+    const size_t size = SegmentSize(count);
+    void* const addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        report.error(u"error mapping shared memory %s: %s", {_name, ErrorCodeMessage()});
+        return false;
+    }
+    _count = count;
+    _size = size;
+    _header = reinterpret_cast<Header*>(addr);
+    _packets = reinterpret_cast<TSPacket*>(reinterpret_cast<uint8_t*>(addr) + HeaderSize());
+    _mdata = reinterpret_cast<SlotMetadata*>(reinterpret_cast<uint8_t*>(addr) + MetadataOffset(count));
+    return true;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Create a shared ring as producer.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::create(const UString& name, size_t packet_count, Report& report)
+{
+    if (isOpen()) {
+        report.error(u"shared ring %s already open", {_name});
+        return false;
+    }
+
+#if defined(TS_WINDOWS)
+    report.error(u"shared memory packet rings are not supported on Windows");
+    return false;
+#else
+    _name = name.toUTF8();
+    if (_name.empty() || _name[0] != '/') {
+        _name.insert(0, 1, '/');
+    }
+    _aborted = false;
+    _producer = true;
+    packet_count = std::max(packet_count, MIN_PACKET_COUNT);
+
+    // Remove a previous segment from a terminated producer, then create a new one.
+    ::shm_unlink(_name.c_str());
+    const int fd = ::shm_open(_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+    if (fd < 0) {
+        report.error(u"error creating shared memory %s: %s", {_name, ErrorCodeMessage()});
+        return false;
+    }
+    if (::ftruncate(fd, off_t(SegmentSize(packet_count))) < 0) {
+        report.error(u"error sizing shared memory %s: %s", {_name, ErrorCodeMessage()});
+        ::close(fd);
+        ::shm_unlink(_name.c_str());
+        return false;
+    }
+    const bool ok = map(fd, packet_count, report);
+    ::close(fd);
+    if (!ok) {
+        ::shm_unlink(_name.c_str());
+        return false;
+    }
+
+    // The new segment is filled with zeroes. Initialize the header and publish the magic number last.
+    new (_header) Header;
+    _header->version = RING_VERSION;
+    _header->packet_count = _count;
+    _header->writer_pid.store(int32_t(::getpid()));
+    _header->magic.store(RING_MAGIC);
+    report.debug(u"created shared ring %s, %d packets, %'d bytes", {_name, _count, _size});
+    return true;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Attach to a shared ring as consumer.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::open(const UString& name, MilliSecond timeout, Report& report)
+{
+    if (isOpen()) {
+        report.error(u"shared ring %s already open", {_name});
+        return false;
+    }
+
+#if defined(TS_WINDOWS)
+    report.error(u"shared memory packet rings are not supported on Windows");
+    return false;
+#else
+    _name = name.toUTF8();
+    if (_name.empty() || _name[0] != '/') {
+        _name.insert(0, 1, '/');
+    }
+    _aborted = false;
+    _producer = false;
+
+    // Wait for the producer to create and initialize the segment.
+    for (MilliSecond waited = 0; !isOpen(); waited += OPEN_POLL) {
+        if (_aborted) {
+            return false;
+        }
+        if (waited >= timeout) {
+            report.error(u"timeout waiting for shared memory %s", {_name});
+            return false;
+        }
+        const int fd = ::shm_open(_name.c_str(), O_RDWR, 0);
+        if (fd < 0 && errno != ENOENT) {
+            report.error(u"error opening shared memory %s: %s", {_name, ErrorCodeMessage()});
+            return false;
+        }
+        if (fd >= 0) {
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && size_t(st.st_size) >= HeaderSize()) {
+                // Map the header alone to get the segment size.
+                void* const addr = ::mmap(nullptr, HeaderSize(), PROT_READ, MAP_SHARED, fd, 0);
+                if (addr != MAP_FAILED) {
+                    const Header* const head = reinterpret_cast<const Header*>(addr);
+                    const bool ready = head->magic.load() == RING_MAGIC;
+                    const size_t count = size_t(head->packet_count);
+                    const uint32_t version = head->version;
+                    ::munmap(addr, HeaderSize());
+                    if (ready && (version != RING_VERSION || count < MIN_PACKET_COUNT || size_t(st.st_size) < SegmentSize(count))) {
+                        report.error(u"shared memory %s is not a compatible packet ring", {_name});
+                        ::close(fd);
+                        return false;
+                    }
+                    if (ready && !map(fd, count, report)) {
+                        ::close(fd);
+                        return false;
+                    }
+                }
+            }
+            ::close(fd);
+        }
+        if (!isOpen()) {
+            SleepThread(OPEN_POLL);
+        }
+    }
+
+    // Register as the consumer of the ring.
+    const int32_t pid = int32_t(::getpid());
+    int32_t previous = 0;
+    if (!_header->reader_pid.compare_exchange_strong(previous, pid)) {
+        if (_header->reader_closed.load() == 0 && isAlive(previous)) {
+            report.error(u"shared ring %s already has a consumer, process %d", {_name, previous});
+            ::munmap(_header, _size);
+            _header = nullptr;
+            return false;
+        }
+        _header->reader_pid.store(pid);
+    }
+    _header->reader_closed.store(0);
+    report.debug(u"attached to shared ring %s, %d packets", {_name, _count});
+    return true;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Close the shared ring.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::close(Report& report)
+{
+    if (!isOpen()) {
+        return true;
+    }
+
+#if !defined(TS_WINDOWS)
+    if (_producer) {
+        // Mark the end of stream. The consumer keeps its mapping until it has read all packets.
+        _header->writer_closed.store(1);
+        _header->data_seq.fetch_add(1);
+        FutexWake(_header->data_seq);
+        ::shm_unlink(_name.c_str());
+    }
+    else {
+        // Detach from the ring, unblock the producer if it waits for space.
+        _header->reader_closed.store(1);
+        _header->reader_pid.store(0);
+        _header->space_seq.fetch_add(1);
+        FutexWake(_header->space_seq);
+    }
+    if (::munmap(_header, _size) < 0) {
+        report.error(u"error unmapping shared memory %s: %s", {_name, ErrorCodeMessage()});
+    }
+#endif
+
+    _header = nullptr;
+    _packets = nullptr;
+    _mdata = nullptr;
+    _count = _size = 0;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Abort any pending or future wait.
+//----------------------------------------------------------------------------
+
+void ts::SharedPacketRing::abort()
+{
+    _aborted = true;
+    if (isOpen()) {
+        FutexWake(_producer ? _header->space_seq : _header->data_seq);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Bitrate of the transported stream.
+//----------------------------------------------------------------------------
+
+void ts::SharedPacketRing::setBitrate(BitRate bitrate)
+{
+    if (isOpen() && _producer) {
+        _header->bitrate.store(bitrate, std::memory_order_relaxed);
+    }
+}
+
+ts::BitRate ts::SharedPacketRing::getBitrate() const
+{
+    return isOpen() ? BitRate(_header->bitrate.load(std::memory_order_relaxed)) : 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Write packets in the ring (producer only).
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::write(const TSPacket* buffer, const TSPacketMetadata* mdata, size_t count, const AbortInterface* abort, Report& report)
+{
+    if (!isOpen() || !_producer) {
+        report.error(u"shared ring not open for writing");
+        return false;
+    }
+
+    while (count > 0) {
+        // Only this process modifies write_index.
+        const uint64_t windex = _header->write_index.load(std::memory_order_relaxed);
+        const uint64_t rindex = _header->read_index.load(std::memory_order_acquire);
+        const size_t space = _count - size_t(windex - rindex);
+
+        if (space == 0) {
+            // The ring is full, wait for the consumer. The wait is timed, the abort
+            // conditions are checked at least once per timeout.
+            if (_aborted || (abort != nullptr && abort->aborting())) {
+                return false;
+            }
+            if (_header->reader_closed.load() != 0) {
+                report.error(u"consumer of shared ring %s has terminated", {_name});
+                return false;
+            }
+            const uint32_t seq = _header->space_seq.load();
+            _header->writer_waiting.store(1);
+            if (_header->read_index.load() == rindex) {
+                FutexWait(_header->space_seq, seq);
+                if (_header->read_index.load() == rindex && !isAlive(_header->reader_pid.load())) {
+                    report.error(u"consumer of shared ring %s has died", {_name});
+                    return false;
+                }
+            }
+            continue;
+        }
+
+        // Copy packets and metadata in one or two contiguous chunks.
+        const size_t n = std::min(space, count);
+        const size_t start = size_t(windex % _count);
+        const size_t first = std::min(n, _count - start);
+        TSPacket::Copy(_packets + start, buffer, first);
+        TSPacket::Copy(_packets, buffer + first, n - first);
+        EncodeMetadata(_mdata + start, mdata, first);
+        EncodeMetadata(_mdata, mdata == nullptr ? nullptr : mdata + first, n - first);
+
+        // Publish the packets and wake up the consumer if it waits for them.
+        _header->write_index.store(windex + n);
+        if (_header->reader_waiting.exchange(0) != 0) {
+            _header->data_seq.fetch_add(1);
+            FutexWake(_header->data_seq);
+        }
+
+        buffer += n;
+        if (mdata != nullptr) {
+            mdata += n;
+        }
+        count -= n;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Read packets from the ring (consumer only).
+//----------------------------------------------------------------------------
+
+size_t ts::SharedPacketRing::read(TSPacket* buffer, TSPacketMetadata* mdata, size_t max_count, Report& report)
+{
+    if (!isOpen() || _producer) {
+        report.error(u"shared ring not open for reading");
+        return 0;
+    }
+
+    for (;;) {
+        // Read writer_closed before write_index: all packets are published before the end of stream.
+        const bool closed = _header->writer_closed.load() != 0;
+        const uint64_t windex = _header->write_index.load(std::memory_order_acquire);
+        const uint64_t rindex = _header->read_index.load(std::memory_order_relaxed);
+        const size_t avail = size_t(windex - rindex);
+
+        if (avail == 0) {
+            // The ring is empty, wait for the producer.
+            if (closed || _aborted) {
+                return 0;
+            }
+            const uint32_t seq = _header->data_seq.load();
+            _header->reader_waiting.store(1);
+            if (_header->write_index.load() == windex && _header->writer_closed.load() == 0) {
+                FutexWait(_header->data_seq, seq);
+                if (_header->write_index.load() == windex && _header->writer_closed.load() == 0 && !isAlive(_header->writer_pid.load())) {
+                    report.error(u"producer of shared ring %s has died", {_name});
+                    return 0;
+                }
+            }
+            continue;
+        }
+
+        // Copy packets and metadata in one or two contiguous chunks.
+        const size_t n = std::min(avail, max_count);
+        const size_t start = size_t(rindex % _count);
+        const size_t first = std::min(n, _count - start);
+        TSPacket::Copy(buffer, _packets + start, first);
+        TSPacket::Copy(buffer + first, _packets, n - first);
+        if (mdata != nullptr) {
+            DecodeMetadata(mdata, _mdata + start, first);
+            DecodeMetadata(mdata + first, _mdata, n - first);
+        }
+
+        // Release the slots and wake up the producer if it waits for space.
+        _header->read_index.store(rindex + n);
+        if (_header->writer_waiting.exchange(0) != 0) {
+            _header->space_seq.fetch_add(1);
+            FutexWake(_header->space_seq);
+        }
+        return n;
+    }
+}
@@ -0,0 +1,197 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Ring of TS packets in shared memory, between two processes.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSPacket.h"
+#include "tsTSPacketMetadata.h"
+#include "tsReport.h"
+#include "tsAbortInterface.h"
+#include "tsUString.h"
+
+namespace ts {
+    //!
+    //! Ring of TS packets in shared memory, between two processes.
+    //! @ingroup plugin
+    //!
+    //! A shared packet ring is a single-producer, single-consumer circular buffer of
+    //! TS packets in a named shared memory segment. The producer process creates the
+    //! segment and writes packets. The consumer process attaches to the segment and
+    //! reads packets. Each packet carries its labels, input time stamp and RTP sequence
+    //! number from its TSPacketMetadata.
+    //!
+    //! Packets are copied once into the shared memory by the producer and once out of
+    //! it by the consumer. There is no system call as long as the ring is neither empty
+    //! nor full. On Linux, a blocked process waits on a futex in the shared segment. On
+    //! other UNIX systems, a blocked process polls the segment.
+    //!
+    //! The name of the segment is a simple name without slash, used as a POSIX shared
+    //! memory object name. This class is not implemented on Windows, where all
+    //! operations fail.
+    //!
+    class TSDUCKDLL SharedPacketRing
+    {
+        TS_NOCOPY(SharedPacketRing);
+    public:
+        //!
+        //! Default number of packets in the ring.
+        //!
+        static constexpr size_t DEFAULT_PACKET_COUNT = 8192;
+
+        //!
+        //! Minimum number of packets in the ring.
+        //!
+        static constexpr size_t MIN_PACKET_COUNT = 16;
+
+        //!
+        //! Constructor.
+        //!
+        SharedPacketRing();
+
+        //!
+        //! Destructor.
+        //!
+        ~SharedPacketRing();
+
+        //!
+        //! Create a shared ring as producer.
+        //! Any previous segment with the same name is removed first.
+        //! @param [in] name Name of the shared memory segment.
+        //! @param [in] packet_count Number of packets in the ring.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool create(const UString& name, size_t packet_count, Report& report);
+
+        //!
+        //! Attach to a shared ring as consumer.
+        //! If the segment does not exist yet, wait for the producer to create it.
+        //! @param [in] name Name of the shared memory segment.
+        //! @param [in] timeout Maximum time to wait for the segment to be created.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error, timeout or abort().
+        //!
+        bool open(const UString& name, MilliSecond timeout, Report& report);
+
+        //!
+        //! Close the shared ring.
+        //! The producer marks the end of stream. The segment name is removed
+        //! by the producer and the memory is freed when both sides are closed.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool close(Report& report);
+
+        //!
+        //! Check if the shared ring is open.
+        //! @return True if the shared ring is open.
+        //!
+        bool isOpen() const { return _header != nullptr; }
+
+        //!
+        //! Get the number of packets in the ring.
+        //! @return The number of packets in the ring or zero if not open.
+        //!
+        size_t packetCount() const { return _count; }
+
+        //!
+        //! Write packets in the ring (producer only).
+        //! Wait for free space in the ring when necessary.
+        //! @param [in] buffer Address of packets to write.
+        //! @param [in] mdata Address of the corresponding packet metadata. Can be null.
+        //! @param [in] count Number of packets to write.
+        //! @param [in] abort An interface to check if the application is interrupted
+        //! while waiting for free space in the ring. Can be null.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error, abort(), application interruption or consumer termination.
+        //!
+        bool write(const TSPacket* buffer, const TSPacketMetadata* mdata, size_t count, const AbortInterface* abort, Report& report);
+
+        //!
+        //! Read packets from the ring (consumer only).
+        //! Wait for at least one packet when the ring is empty.
+        //! @param [out] buffer Address of the packet buffer.
+        //! @param [out] mdata Address of the corresponding packet metadata. Can be null.
+        //! @param [in] max_count Maximum number of packets to read.
+        //! @param [in,out] report Where to report errors.
+        //! @return The number of read packets. Zero on end of stream, error or abort().
+        //!
+        size_t read(TSPacket* buffer, TSPacketMetadata* mdata, size_t max_count, Report& report);
+
+        //!
+        //! Set the bitrate of the transported stream (producer only).
+        //! @param [in] bitrate Bitrate in bits/second, zero if unknown.
+        //!
+        void setBitrate(BitRate bitrate);
+
+        //!
+        //! Get the bitrate of the transported stream, as set by the producer.
+        //! @return Bitrate in bits/second, zero if unknown.
+        //!
+        BitRate getBitrate() const;
+
+        //!
+        //! Abort any pending or future wait in write(), read() or open().
+        //! Can be called from another thread.
+        //!
+        void abort();
+
+    private:
+        struct Header;
+        struct SlotMetadata;
+
+        volatile bool _aborted;    // Set by abort().
+        bool          _producer;   // This is the producer side.
+        std::string   _name;       // Segment name, as used by the system.
+        size_t        _count;      // Number of packets in the ring.
+        size_t        _size;       // Total size of the segment.
+        Header*       _header;     // Segment header, also base address of the mapping.
+        TSPacket*     _packets;    // Packet area in the segment.
+        SlotMetadata* _mdata;      // Metadata area in the segment.
+
+        // Map a segment in memory from an open file descriptor and compute the areas.
+        bool map(int fd, size_t count, Report& report);
+
+        // Check if the peer process is still alive.
+        static bool isAlive(int pid);
+
+        // Offsets of the areas and total size of a segment.
+        static size_t HeaderSize();
+        static size_t MetadataOffset(size_t count);
+        static size_t SegmentSize(size_t count);
+
+        // Serialize packet metadata in the segment and back.
+        static void EncodeMetadata(SlotMetadata* slots, const TSPacketMetadata* mdata, size_t count);
+        static void DecodeMetadata(TSPacketMetadata* mdata, const SlotMetadata* slots, size_t count);
+    };
+}
@@ -38,6 +38,7 @@ const ts::Enumeration ts::TSPControlCommand::ControlCommandEnum({
     {u"suspend", ts::TSPControlCommand::ControlCommand::CMD_SUSPEND},
     {u"resume",  ts::TSPControlCommand::ControlCommand::CMD_RESUME},
     {u"restart", ts::TSPControlCommand::ControlCommand::CMD_RESTART},
+    {u"stats",   ts::TSPControlCommand::ControlCommand::CMD_STATS},
 });
 
 
@@ -87,6 +88,21 @@ ts::TSPControlCommand::TSPControlCommand() :
     arg->help(u"same",
               u"Restart the plugin with the same options and parameters. "
               u"By default, when no plugin options are specified, restart with no option at all.");
+
+    arg = newCommand(CMD_STATS, u"Display performance counters of plugins", u"[options] [plugin-index]");
+    arg->setIntro(u"Display the performance counters of all plugins or one plugin: time spent in the plugin, "
+                  u"time spent waiting for packets, maximum duration of one call to the plugin and histogram "
+                  u"of the occupancy of the packet area of the plugin. A plugin which is busy most of the time "
+                  u"while the others are waiting is the bottleneck of the processing chain. "
+                  u"For the input plugin, the packet area is the free space in the buffer.");
+    arg->option(u"", 0, Args::UNSIGNED, 0, 1);
+    arg->help(u"", u"Index of the plugin to display. By default, display all plugins.");
+    arg->option(u"json", 'j');
+    arg->help(u"json", u"Display the performance counters in JSON format.");
+    arg->option(u"reset", 'r');
+    arg->help(u"reset",
+              u"Reset the performance counters after displaying them. "
+              u"The next command displays the counters since this reset.");
 }
 
 
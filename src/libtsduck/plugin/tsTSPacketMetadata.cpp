@@ -40,6 +40,8 @@ const ts::TSPacketMetadata::LabelSet ts::TSPacketMetadata::AllLabels(~NoLabel);
 
 ts::TSPacketMetadata::TSPacketMetadata() :
     _labels(),
+    _input_time(INVALID_PCR),
+    _rtp_sequence(-1),
     _flush(false),
     _bitrate_changed(false),
     _input_stuffing(false),
@@ -55,6 +57,8 @@ ts::TSPacketMetadata::TSPacketMetadata() :
 void ts::TSPacketMetadata::reset()
 {
     _labels.reset();
+    _input_time = INVALID_PCR;
+    _rtp_sequence = -1;
     _flush = false;
     _bitrate_changed = false;
     _input_stuffing = false;
@@ -138,6 +138,69 @@ namespace ts {
         //!
         bool getBitrateChanged() const { return _bitrate_changed; }
 
+        //!
+        //! Set the input time stamp of the packet.
+        //! The input time stamp is set by the input plugin, typically from the reception time
+        //! of the packet by the system. It is expressed in PCR units (27 MHz) since the UNIX
+        //! epoch (1970-01-01 UTC). Only differences between input time stamps are meaningful.
+        //! @param [in] time_stamp Input time stamp in PCR units.
+        //!
+        void setInputTimeStamp(uint64_t time_stamp) { _input_time = time_stamp; }
+
+        //!
+        //! Set the input time stamp of the packet from a time value in micro-seconds.
+        //! @param [in] time_stamp Input time stamp in micro-seconds since 1970-01-01 UTC.
+        //! Negative values are ignored and clear the input time stamp.
+        //!
+        void setInputTimeStampMicroSec(MicroSecond time_stamp)
+        {
+            _input_time = time_stamp < 0 ? INVALID_PCR : uint64_t(time_stamp) * (SYSTEM_CLOCK_FREQ / MicroSecPerSec);
+        }
+
+        //!
+        //! Clear the input time stamp of the packet.
+        //!
+        void clearInputTimeStamp() { _input_time = INVALID_PCR; }
+
+        //!
+        //! Check if the packet has an input time stamp.
+        //! @return True if the packet has an input time stamp.
+        //!
+        bool hasInputTimeStamp() const { return _input_time != INVALID_PCR; }
+
+        //!
+        //! Get the input time stamp of the packet.
+        //! @return The input time stamp in PCR units (27 MHz) or INVALID_PCR if there is none.
+        //! @see setInputTimeStamp()
+        //!
+        uint64_t getInputTimeStamp() const { return _input_time; }
+
+        //!
+        //! Set the RTP sequence number of the packet.
+        //! The RTP sequence number is set by input plugins which receive TS packets in RTP datagrams.
+        //! All TS packets from the same datagram have the same RTP sequence number.
+        //! @param [in] sequence RTP sequence number of the datagram which carried the packet.
+        //!
+        void setRTPSequence(uint16_t sequence) { _rtp_sequence = int32_t(sequence); }
+
+        //!
+        //! Clear the RTP sequence number of the packet.
+        //!
+        void clearRTPSequence() { _rtp_sequence = -1; }
+
+        //!
+        //! Check if the packet has an RTP sequence number.
+        //! @return True if the packet has an RTP sequence number.
+        //!
+        bool hasRTPSequence() const { return _rtp_sequence >= 0; }
+
+        //!
+        //! Get the RTP sequence number of the packet.
+        //! @return The RTP sequence number or zero if there is none.
+        //! @see setRTPSequence()
+        //!
+        uint16_t getRTPSequence() const { return _rtp_sequence < 0 ? 0 : uint16_t(_rtp_sequence); }
+
         //!
         //! Check if the TS packet has a specific label set.
         //! @param [in] label The label to check.
@@ -194,8 +257,16 @@ namespace ts {
         //!
         void clearAllLabels() { _labels.reset(); }
 
+        //!
+        //! Get all labels of the TS packet.
+        //! @return A constant reference to the set of labels of the TS packet.
+        //!
+        const LabelSet& getLabels() const { return _labels; }
+
     private:
         LabelSet _labels;           // Bit mask of labels.
+        uint64_t _input_time;       // Input time stamp in PCR units, INVALID_PCR if none.
+        int32_t  _rtp_sequence;     // RTP sequence number of the datagram, negative if none.
         bool     _flush;            // Flush the packet buffer asap.
         bool     _bitrate_changed;  // Call getBitrate() callback as soon as possible.
         bool     _input_stuffing;   // Packet was artificially inserted as input stuffing.
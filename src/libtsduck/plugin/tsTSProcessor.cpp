@@ -190,6 +190,12 @@ bool ts::TSProcessor::start(const TSProcessorArgs& args)
             }
         } while ((proc = proc->ringNext<ts::tsp::PluginExecutor>()) != _input);
 
+        // Build the parallel branches of packet processors, if any.
+        if (!buildBranches()) {
+            cleanupInternal();
+            return false;
+        }
+
         // Allocate a memory-resident buffer of TS packets
         _packet_buffer = new PacketBuffer(_args.ts_buffer_size / ts::PKT_SIZE);
         CheckNonNull(_packet_buffer);
@@ -252,6 +258,79 @@ bool ts::TSProcessor::start(const TSProcessorArgs& args)
 }
 
 
+//----------------------------------------------------------------------------
+// Build the parallel branches of packet processors.
+//----------------------------------------------------------------------------
+
+bool ts::TSProcessor::buildBranches()
+{
+    // A packet processor with --parallel starts a new branch which runs in parallel
+    // with the branch containing the previous plugin. A branch continues with all
+    // following packet processors with --in-branch. A group of parallel branches is
+    // a list of contiguous branches (first and last executors in each branch).
+    BranchGroup group;
+    tsp::PluginExecutor* first = nullptr;  // First executor in current branch.
+
+    for (tsp::PluginExecutor* proc = _input->ringNext<tsp::PluginExecutor>(); proc != _output; proc = proc->ringNext<tsp::PluginExecutor>()) {
+        ProcessorPlugin* const plugin = dynamic_cast<ProcessorPlugin*>(proc->plugin());
+        assert(plugin != nullptr);
+        if (plugin->getParallelOption()) {
+            if (first == nullptr) {
+                _report.error(u"tsp: --parallel is not allowed in the first packet processor (%s)", {proc->pluginName()});
+                return false;
+            }
+            if (group.empty()) {
+                // The branch containing the previous plugin is the first one in the group.
+                group.push_back(std::make_pair(first, proc->ringPrevious<tsp::PluginExecutor>()));
+            }
+            group.push_back(std::make_pair(proc, proc));
+            first = proc;
+        }
+        else if (first != nullptr && plugin->getInBranchOption()) {
+            // Continue the current branch.
+            if (!group.empty()) {
+                group.back().second = proc;
+            }
+        }
+        else {
+            // Start a new sequence of plugins, terminate the previous group.
+            joinGroup(group);
+            first = proc;
+        }
+    }
+    joinGroup(group);
+    return true;
+}
+
+void ts::TSProcessor::joinGroup(BranchGroup& group)
+{
+    if (!group.empty()) {
+        _report.debug(u"tsp: %d parallel branches starting at %s", {group.size(), group.front().first->pluginName()});
+
+        // The executor before the group feeds all branches, the one after the group joins them.
+        tsp::PluginExecutor* const source = group.front().first->ringPrevious<tsp::PluginExecutor>();
+        tsp::PluginExecutor* const target = group.back().second->ringNext<tsp::PluginExecutor>();
+        std::vector<tsp::PluginExecutor*> heads;
+        std::vector<tsp::PluginExecutor*> tails;
+        for (auto it = group.begin(); it != group.end(); ++it) {
+            heads.push_back(it->first);
+            tails.push_back(it->second);
+            tsp::PluginExecutor* proc = it->first;
+            for (;;) {
+                proc->setInBranch(true);
+                if (proc == it->second) {
+                    break;
+                }
+                proc = proc->ringNext<tsp::PluginExecutor>();
+            }
+        }
+        source->forkBranches(heads);
+        tsp::PluginExecutor::JoinBranches(tails, target);
+    }
+    group.clear();
+}
+
+
 //----------------------------------------------------------------------------
 // Check if the TS processing is started.
 //----------------------------------------------------------------------------
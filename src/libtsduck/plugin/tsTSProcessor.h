@@ -43,6 +43,7 @@ namespace ts {
     // Forward class declaration for private part.
     //! @cond nodoxygen
     namespace tsp {
+        class PluginExecutor;
         class InputExecutor;
         class OutputExecutor;
         class ControlServer;
@@ -99,9 +100,9 @@ namespace ts {
         void waitForTermination();
 
     private:
-        // There is one global mutex for protected operations.
-        // The resulting bottleneck of this single mutex is acceptable as long
-        // as all protected operations are fast (pointer update, simple arithmetic).
+        // There is one global mutex for infrequent protected operations.
+        // The packets are passed from one plugin executor to the next one
+        // using atomic counters, without this mutex.
 
         Report&               _report;           // Common log object.
         Mutex                 _mutex;            // Global mutex.
@@ -116,5 +117,10 @@ namespace ts {
 
         // Deallocate and cleanup internal resources.
         void cleanupInternal();
+
+        // Build the parallel branches of packet processors. Return false on error.
+        typedef std::vector<std::pair<tsp::PluginExecutor*, tsp::PluginExecutor*>> BranchGroup;
+        bool buildBranches();
+        void joinGroup(BranchGroup& group);
     };
 }
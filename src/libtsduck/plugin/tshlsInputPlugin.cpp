@@ -29,9 +29,17 @@
 
 #include "tshlsInputPlugin.h"
 #include "tsSysUtils.h"
+#include "tsGuardCondition.h"
 TSDUCK_SOURCE;
 
+// Maximum initial allocation for a prefetched segment, whatever size the server announces.
+// Larger segments are still accepted, the buffer simply grows while the data are received.
+namespace {
+    constexpr size_t MAX_SEGMENT_RESERVE = 32 * 1024 * 1024;
+}
+
 #define DEFAULT_MAX_QUEUED_PACKETS  1000    // Default size in packet of the inter-thread queue.
+#define MAX_PREFETCH_COUNT            32    // Maximum number of concurrently downloaded segments.
 
 
 //----------------------------------------------------------------------------
@@ -54,8 +62,15 @@ ts::hls::InputPlugin::InputPlugin(TSP* tsp_) :
     _lowestRes(false),
     _highestRes(false),
     _maxSegmentCount(0),
+    _prefetchCount(1),
     _webArgs(),
-    _playlist()
+    _playlist(),
+    _mutex(),
+    _todo(),
+    _done(),
+    _segments(),
+    _terminate(false),
+    _prefetchers()
 {
     _webArgs.defineArgs(*this);
 
@@ -123,6 +138,16 @@ ts::hls::InputPlugin::InputPlugin(TSP* tsp_) :
          u"Specify the maximum number of queued TS packets before their insertion into the stream. "
          u"The default is " + UString::Decimal(DEFAULT_MAX_QUEUED_PACKETS) + u".");
 
+    option(u"prefetch", 0, INTEGER, 0, 1, 1, MAX_PREFETCH_COUNT);
+    help(u"prefetch", u"count",
+         u"Number of media segments which are downloaded concurrently, in advance. "
+         u"The segments are downloaded in memory by separate threads and passed to the "
+         u"next plugin in playout order. This improves the throughput when the latency "
+         u"of the server is high compared to the duration of a segment. "
+         u"The default is 1, meaning that each segment is downloaded and passed to the "
+         u"next plugin while the download is in progress, without prefetch. "
+         u"The maximum value is " + UString::Decimal(MAX_PREFETCH_COUNT) + u".");
+
     option(u"save-files", 0, STRING);
     help(u"save-files", u"directory-name",
          u"Specify a directory where all downloaded files, media segments and playlists, are saved "
@@ -172,6 +197,7 @@ bool ts::hls::InputPlugin::getOptions()
     _url.setURL(value(u""));
     const UString saveDirectory(value(u"save-files"));
     getIntValue(_maxSegmentCount, u"segment-count");
+    getIntValue(_prefetchCount, u"prefetch", size_t(1));
     getIntValue(_minRate, u"min-bitrate");
     getIntValue(_maxRate, u"max-bitrate");
     getIntValue(_minWidth, u"min-width");
@@ -247,6 +273,7 @@ bool ts::hls::InputPlugin::setReceiveTimeout(MilliSecond timeout)
 bool ts::hls::InputPlugin::start()
 {
     // Load the HLS playlist, can be a master playlist or a media playlist.
+    _terminate = false;
     _playlist.clear();
     if (!_playlist.loadURL(_url.toString(), false, _webArgs, hls::UNKNOWN_PLAYLIST, *tsp)) {
         return false;
@@ -361,6 +388,9 @@ bool ts::hls::InputPlugin::start()
 
 bool ts::hls::InputPlugin::stop()
 {
+    // Interrupt the prefetch threads, if any, before waiting for the input thread.
+    interruptPrefetch();
+
     // Invoke superclass.
     bool ok = AbstractHTTPInputPlugin::stop();
 
@@ -377,12 +407,88 @@ bool ts::hls::InputPlugin::stop()
 }
 
 
+//----------------------------------------------------------------------------
+// Abort the input operation currently in progress.
+//----------------------------------------------------------------------------
+
+bool ts::hls::InputPlugin::abortInput()
+{
+    interruptPrefetch();
+    return AbstractHTTPInputPlugin::abortInput();
+}
+
+
 //----------------------------------------------------------------------------
 // Input method. Executed in a separate thread.
 //----------------------------------------------------------------------------
 
 void ts::hls::InputPlugin::processInput()
 {
+    if (_prefetchCount > 1) {
+        processPrefetch();
+    }
+    else {
+        processSequential();
+    }
+    tsp->verbose(u"HLS playlist completed");
+}
+
+
+//----------------------------------------------------------------------------
+// Initialize a Web request to download a media segment.
+//----------------------------------------------------------------------------
+
+void ts::hls::InputPlugin::setupRequest(WebRequest& request, const UString& url) const
+{
+    request.setURL(url);
+    request.setAutoRedirect(true);
+    request.setArgs(_webArgs);
+    request.enableCookies(_webArgs.cookiesFile);
+
+    // All segments are usually downloaded from the same server.
+    // Reuse the same connection instead of connecting again for each segment.
+    request.setKeepAlive(true);
+}
+
+
+//----------------------------------------------------------------------------
+// Reload the playlist when there is at most one remaining segment.
+//----------------------------------------------------------------------------
+
+void ts::hls::InputPlugin::reloadPlayList(bool wait)
+{
+    if (_playlist.segmentCount() < 2 && _playlist.updatable() && !tsp->aborting()) {
+
+        // Ignore errors, continue to play next segments.
+        _playlist.reload(false, _webArgs, *tsp);
+
+        // If the playout is still empty, this means that we have read all segments before the server
+        // could produce new segments. For live streams, this is possible because new segments
+        // can be produced as late as the estimated end time of the previous playlist. So, we retry
+        // at regular intervals until we get new segments.
+
+        while (wait && _playlist.segmentCount() == 0 && Time::CurrentUTC() <= _playlist.terminationUTC() && !tsp->aborting()) {
+            // The wait between two retries is half the target duration of a segment, with a minimum of 2 seconds.
+            SleepThread(std::max<MilliSecond>(2000, (MilliSecPerSec * _playlist.targetDuration()) / 2));
+            // This time, we stop on error.
+            if (!_playlist.reload(false, _webArgs, *tsp)) {
+                break;
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Sequential download: each segment is passed to the next plugin while
+// it is downloaded.
+//----------------------------------------------------------------------------
+
+void ts::hls::InputPlugin::processSequential()
+{
+    // The same Web request is used for all segments to keep the connection open.
+    WebRequest request(*tsp);
+
     // Loop on all segments in the media playlists.
     for (size_t count = 0; _playlist.segmentCount() > 0 && (_maxSegmentCount == 0 || count < _maxSegmentCount) && !tsp->aborting() && !isInterrupted(); ++count) {
 
@@ -390,13 +496,9 @@ void ts::hls::InputPlugin::processInput()
         hls::MediaSegment seg;
         _playlist.popFirstSegment(seg);
 
-        // Create a Web request to download the content.
-        WebRequest request(*tsp);
+        // Prepare the Web request to download the content.
         const UString url(_playlist.buildURL(seg.uri));
-        request.setURL(url);
-        request.setAutoRedirect(true);
-        request.setArgs(_webArgs);
-        request.enableCookies(_webArgs.cookiesFile);
+        setupRequest(request, url);
 
         // Perform the download of the current segment.
         // Ignore errors, continue to play next segments.
@@ -404,25 +506,228 @@ void ts::hls::InputPlugin::processInput()
         request.downloadToApplication(this);
 
         // If there is only one or zero remaining segment, try to reload the playlist.
-        if (_playlist.segmentCount() < 2 && _playlist.updatable() && !tsp->aborting()) {
+        reloadPlayList(true);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Concurrent download: several segments are downloaded in advance in
+// memory by the prefetch threads and passed in order to the next plugin.
+//----------------------------------------------------------------------------
+
+void ts::hls::InputPlugin::processPrefetch()
+{
+    if (!startPrefetchers()) {
+        stopPrefetchers();
+        return;
+    }
+
+    size_t count = 0;   // Number of segments which were queued for download.
+    size_t queued = 0;  // Number of segments in _segments, only modified by this thread.
+
+    while (!tsp->aborting() && !isInterrupted() && !_terminate) {
+
+        // Queue new segments for download, up to the prefetch count.
+        while (queued < _prefetchCount && _playlist.segmentCount() > 0 && (_maxSegmentCount == 0 || count < _maxSegmentCount)) {
+            hls::MediaSegment seg;
+            _playlist.popFirstSegment(seg);
+            const SegmentPtr segment(new Segment(_playlist.buildURL(seg.uri)));
+            tsp->debug(u"queueing segment %s", {segment->url});
+            GuardCondition lock(_mutex, _todo);
+            _segments.push_back(segment);
+            lock.signal();
+            count++;
+            queued++;
+        }
+
+        // If there is only one or zero remaining segment, try to reload the playlist.
+        // Wait for new segments in a live stream only when there is nothing else to play.
+        if (_maxSegmentCount == 0 || count < _maxSegmentCount) {
+            const size_t before = _playlist.segmentCount();
+            reloadPlayList(queued == 0);
+            if (_playlist.segmentCount() > before && queued < _prefetchCount) {
+                // New segments are available, queue them before waiting.
+                continue;
+            }
+        }
+
+        // Nothing more to play.
+        if (queued == 0) {
+            break;
+        }
+
+        // Wait for the completion of the download of the first segment.
+        SegmentPtr segment;
+        {
+            GuardCondition lock(_mutex, _done);
+            while (!_terminate && !_segments.front()->completed) {
+                lock.waitCondition();
+            }
+            if (_terminate) {
+                // Interrupted by abortInput() or stop().
+                break;
+            }
+            segment = _segments.front();
+            _segments.pop_front();
+            queued--;
+        }
+
+        // Pass the segment content to the next plugin. Errors on one segment are ignored,
+        // continue to play next segments. The push operation blocks when the packet queue
+        // is full, which also blocks the queueing of new segments to download.
+        if (segment->success) {
+            tsp->debug(u"playing segment %s, %'d bytes", {segment->url, segment->data.size()});
+            bool ok = startTransfer(segment->finalURL, segment->mimeType, segment->data.size());
+            ok = ok && transferData(segment->data.data(), segment->data.size());
+            stopTransfer();
+            if (!ok) {
+                // Error pushing packets, termination requested.
+                break;
+            }
+        }
+    }
+
+    stopPrefetchers();
+}
+
+
+//----------------------------------------------------------------------------
+// Start and stop the prefetch threads.
+//----------------------------------------------------------------------------
+
+bool ts::hls::InputPlugin::startPrefetchers()
+{
+    _segments.clear();
+    _prefetchers.clear();
+
+    for (size_t i = 0; i < _prefetchCount; ++i) {
+        const PrefetcherPtr pf(new Prefetcher(this));
+        _prefetchers.push_back(pf);
+        if (!pf->start()) {
+            tsp->error(u"error starting HLS prefetch thread");
+            return false;
+        }
+    }
+    return true;
+}
+
+void ts::hls::InputPlugin::interruptPrefetch()
+{
+    // Interrupt downloads in progress and the input thread waiting for them.
+    GuardCondition lock(_mutex, _done);
+    _terminate = true;
+    lock.signal();
+}
+
+void ts::hls::InputPlugin::stopPrefetchers()
+{
+    // Request termination of all threads. Downloads in progress are interrupted.
+    {
+        GuardCondition lock(_mutex, _todo);
+        _terminate = true;
+        for (size_t i = 0; i < _prefetchers.size(); ++i) {
+            lock.signal();
+        }
+    }
+
+    // Wait for actual termination and free resources.
+    for (size_t i = 0; i < _prefetchers.size(); ++i) {
+        _prefetchers[i]->waitForTermination();
+    }
+    _prefetchers.clear();
+    _segments.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Description of a media segment which is downloaded in advance.
+//----------------------------------------------------------------------------
+
+ts::hls::InputPlugin::Segment::Segment(const UString& segmentURL) :
+    url(segmentURL),
+    finalURL(),
+    mimeType(),
+    data(),
+    started(false),
+    completed(false),
+    success(false)
+{
+}
 
-            // Ignore errors, continue to play next segments.
-            _playlist.reload(false, _webArgs, *tsp);
 
-            // If the playout is still empty, this means that we have read all segments before the server
-            // could produce new segments. For live streams, this is possible because new segments
-            // can be produced as late as the estimated end time of the previous playlist. So, we retry
-            // at regular intervals until we get new segments.
+//----------------------------------------------------------------------------
+// Internal thread which downloads media segments in advance.
+//----------------------------------------------------------------------------
 
-            while (_playlist.segmentCount() == 0 && Time::CurrentUTC() <= _playlist.terminationUTC() && !tsp->aborting()) {
-                // The wait between two retries is half the target duration of a segment, with a minimum of 2 seconds.
-                SleepThread(std::max<MilliSecond>(2000, (MilliSecPerSec * _playlist.targetDuration()) / 2));
-                // This time, we stop on error.
-                if (!_playlist.reload(false, _webArgs, *tsp)) {
+ts::hls::InputPlugin::Prefetcher::Prefetcher(InputPlugin* plugin) :
+    Thread(ThreadAttributes().setStackSize(plugin->stackUsage())),
+    _plugin(plugin),
+    _request(*plugin->tsp),
+    _segment()
+{
+}
+
+ts::hls::InputPlugin::Prefetcher::~Prefetcher()
+{
+    waitForTermination();
+}
+
+void ts::hls::InputPlugin::Prefetcher::main()
+{
+    for (;;) {
+        // Wait for a segment to download.
+        {
+            GuardCondition lock(_plugin->_mutex, _plugin->_todo);
+            _segment.clear();
+            while (!_plugin->_terminate) {
+                for (SegmentQueue::const_iterator it = _plugin->_segments.begin(); _segment.isNull() && it != _plugin->_segments.end(); ++it) {
+                    if (!(*it)->started) {
+                        _segment = *it;
+                    }
+                }
+                if (!_segment.isNull()) {
                     break;
                 }
+                lock.waitCondition();
+            }
+            if (_plugin->_terminate) {
+                break;
             }
+            _segment->started = true;
         }
+
+        // Download the segment in memory.
+        _plugin->setupRequest(_request, _segment->url);
+        _plugin->tsp->debug(u"prefetching segment %s", {_segment->url});
+        const bool ok = _request.downloadToApplication(this);
+
+        // Notify the completion to the main input thread.
+        GuardCondition lock(_plugin->_mutex, _plugin->_done);
+        _segment->success = ok;
+        _segment->completed = true;
+        lock.signal();
     }
-    tsp->verbose(u"HLS playlist completed");
+    _segment.clear();
+}
+
+bool ts::hls::InputPlugin::Prefetcher::handleWebStart(const WebRequest& request, size_t size)
+{
+    _segment->finalURL = request.finalURL();
+    _segment->mimeType = request.mimeType();
+    _segment->data.clear();
+    // Do not trust the announced size from the server for the initial allocation.
+    _segment->data.reserve(std::min(size, MAX_SEGMENT_RESERVE));
+    return !_plugin->_terminate;
+}
+
+bool ts::hls::InputPlugin::Prefetcher::handleWebData(const WebRequest& request, const void* data, size_t size)
+{
+    _segment->data.append(data, size);
+    return !_plugin->_terminate;
+}
+
+bool ts::hls::InputPlugin::Prefetcher::handleWebStop(const WebRequest& request)
+{
+    return true;
 }
@@ -38,6 +38,10 @@
 #include "tsURL.h"
 #include "tsWebRequest.h"
 #include "tsWebRequestArgs.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsSafePtr.h"
 
 namespace ts {
     namespace hls {
@@ -65,8 +69,50 @@ namespace ts {
             virtual bool isRealTime() override;
             virtual void processInput() override;
             virtual bool setReceiveTimeout(MilliSecond timeout) override;
+            virtual bool abortInput() override;
 
         private:
+            // Description of a media segment which is downloaded in advance.
+            // The fields after 'url' are updated by a prefetch thread before 'completed' is set.
+            class Segment
+            {
+                TS_NOBUILD_NOCOPY(Segment);
+            public:
+                Segment(const UString& segmentURL);
+                const UString url;       // URL of the segment.
+                UString       finalURL;  // Final URL, after redirections.
+                UString       mimeType;  // MIME type of the content.
+                ByteBlock     data;      // Downloaded content.
+                bool          started;   // Download started by a prefetch thread.
+                bool          completed; // Download completed, successfully or not.
+                bool          success;   // Download successfully completed.
+            };
+            typedef SafePtr<Segment, Mutex> SegmentPtr;
+            typedef std::deque<SegmentPtr> SegmentQueue;
+
+            // Internal thread which downloads media segments in advance.
+            // Each thread keeps its own Web connection open between segments.
+            class Prefetcher : public Thread, private WebRequestHandlerInterface
+            {
+                TS_NOBUILD_NOCOPY(Prefetcher);
+            public:
+                // Constructor & destructor.
+                Prefetcher(InputPlugin* plugin);
+                virtual ~Prefetcher();
+                virtual void main() override;
+            private:
+                InputPlugin* _plugin;
+                WebRequest   _request;
+                SegmentPtr   _segment;  // Segment being downloaded.
+
+                // Implementation of WebRequestHandlerInterface
+                virtual bool handleWebStart(const WebRequest& request, size_t size) override;
+                virtual bool handleWebData(const WebRequest& request, const void* data, size_t size) override;
+                virtual bool handleWebStop(const WebRequest& request) override;
+            };
+            typedef SafePtr<Prefetcher, NullMutex> PrefetcherPtr;
+            typedef std::vector<PrefetcherPtr> PrefetcherVector;
+
             URL            _url;
             BitRate        _minRate;
             BitRate        _maxRate;
@@ -81,8 +127,34 @@ namespace ts {
             bool           _lowestRes;
             bool           _highestRes;
             size_t         _maxSegmentCount;
+            size_t         _prefetchCount;   // Number of concurrently downloaded segments.
             WebRequestArgs _webArgs;
             PlayList       _playlist;
+
+            // Shared data between processInput() and the prefetch threads, protected by _mutex.
+            Mutex            _mutex;
+            Condition        _todo;       // Signaled when a segment is queued or on termination.
+            Condition        _done;       // Signaled when a segment download is completed.
+            SegmentQueue     _segments;   // Prefetched segments, in playout order.
+            volatile bool    _terminate;  // Prefetch threads must terminate.
+            PrefetcherVector _prefetchers;
+
+            // Input loops, sequential download or concurrent prefetch.
+            void processSequential();
+            void processPrefetch();
+
+            // Initialize a Web request to download a media segment.
+            void setupRequest(WebRequest& request, const UString& url) const;
+
+            // Reload the playlist when there is at most one remaining segment.
+            // With wait = true, retry until new segments are available in a live stream.
+            void reloadPlayList(bool wait);
+
+            // Start and stop the prefetch threads.
+            // Interrupting them also interrupts the input thread waiting for a segment.
+            bool startPrefetchers();
+            void stopPrefetchers();
+            void interruptPrefetch();
         };
     }
 }
@@ -32,11 +32,14 @@
 #include "tsPAT.h"
 #include "tsPMT.h"
 #include "tsSysUtils.h"
+#include "tsGuardCondition.h"
 TSDUCK_SOURCE;
 
 #define DEFAULT_OUT_DURATION      10  // Default segment target duration for output streams.
 #define DEFAULT_OUT_LIVE_DURATION  5  // Default segment target duration for output live streams.
 #define DEFAULT_OUT_NUM_WIDTH      6  // Default size of number field in output segment files.
+#define MAX_QUEUED_JOBS           64  // Maximum number of pending file operations before blocking.
+#define TEMP_FILE_SUFFIX     u".tmp"  // Suffix of temporary files before atomic rename.
 
 
 //----------------------------------------------------------------------------
@@ -53,6 +56,7 @@ ts::hls::OutputPlugin::OutputPlugin(TSP* tsp_) :
     _playlistFile(),
     _fixedSegmentSize(0),
     _targetDuration(0),
+    _partDuration(0),
     _liveDepth(0),
     _initialMediaSeq(0),
     _demux(duck, this),
@@ -61,13 +65,30 @@ ts::hls::OutputPlugin::OutputPlugin(TSP* tsp_) :
     _videoPID(PID_NULL),
     _pmtPID(PID_NULL),
     _segClosePending(false),
-    _segmentFile(),
+    _segmentName(),
+    _segmentData(),
     _liveSegmentFiles(),
     _playlist(),
     _pcrAnalyzer(1, 4),  // Minimum required: 1 PID, 4 PCR
     _previousBitrate(0),
     _ccFixer(NoPID, tsp),
-    _close_labels()
+    _close_labels(),
+    _partStart(0),
+    _partIndex(0),
+    _partVideoSeen(false),
+    _partIndependent(false),
+    _packetCount(0),
+    _lastVideoStart(0),
+    _videoPESPackets(0),
+    _outputDuration(0),
+    _partFiles(),
+    _writer(this),
+    _mutex(),
+    _jobQueued(),
+    _jobDone(),
+    _jobs(),
+    _writerTerminate(false),
+    _writeError(false)
 {
     option(u"", 0, STRING, 1, 1);
     help(u"",
@@ -110,6 +131,15 @@ ts::hls::OutputPlugin::OutputPlugin(TSP* tsp_) :
          u"are automatically deleted. By default, the output stream is considered as VoD "
          u"and all created media segments are preserved.");
 
+    option(u"part-duration", 0, POSITIVE);
+    help(u"part-duration", u"milliseconds",
+         u"Generate a low-latency HLS stream with partial segments of the specified target duration in milliseconds. "
+         u"Each media segment is split into partial segment files which are published in the playlist "
+         u"(#EXT-X-PART) as soon as they are complete, with a hint for the next one (#EXT-X-PRELOAD-HINT). "
+         u"Like media segments, partial segments are cut at the start of a PES packet on the video PID. "
+         u"The partial segment target duration must be lower than the segment target duration. "
+         u"This option requires --playlist.");
+
     option(u"playlist", 'p', STRING);
     help(u"playlist", u"filename",
          u"Specify the name of the playlist file. "
@@ -147,12 +177,21 @@ bool ts::hls::OutputPlugin::getOptions()
     _targetDuration = intValue<Second>(u"duration", _liveDepth == 0 ? DEFAULT_OUT_DURATION : DEFAULT_OUT_LIVE_DURATION);
     _fixedSegmentSize = intValue<PacketCounter>(u"fixed-segment-size") / PKT_SIZE;
     _initialMediaSeq = intValue<size_t>(u"start-media-sequence", 0);
+    _partDuration = intValue<MilliSecond>(u"part-duration", 0);
     getIntValues(_close_labels, u"label-close");
 
     if (_fixedSegmentSize > 0 && _close_labels.any()) {
         tsp->error(u"options --fixed-segment-size and --label-close are incompatible");
         return false;
     }
+    if (_partDuration > 0 && _playlistFile.empty()) {
+        tsp->error(u"option --part-duration requires --playlist");
+        return false;
+    }
+    if (_partDuration >= _targetDuration * MilliSecPerSec) {
+        tsp->error(u"the partial segment duration must be lower than the segment duration");
+        return false;
+    }
 
     return true;
 }
@@ -205,16 +244,30 @@ bool ts::hls::OutputPlugin::start()
     // Initialize the segment and playlist files.
     _liveSegmentFiles.clear();
     _segClosePending = false;
-    if (_segmentFile.isOpen()) {
-        _segmentFile.close(*tsp);
-    }
+    _segmentName.clear();
+    _segmentData.clear();
+    _packetCount = 0;
+    _lastVideoStart = 0;
+    _videoPESPackets = 0;
+    _outputDuration = 0;
+    _partFiles.clear();
     if (!_playlistFile.empty()) {
         _playlist.reset(hls::MEDIA_PLAYLIST, _playlistFile);
         _playlist.setTargetDuration(_targetDuration, *tsp);
+        _playlist.setPartTargetDuration(_partDuration, *tsp);
         _playlist.setPlaylistType(_liveDepth == 0 ? u"VOD" : u"EVENT", *tsp);
         _playlist.setMediaSequence(_initialMediaSeq, *tsp);
     }
 
+    // Start the file writer thread.
+    _jobs.clear();
+    _writerTerminate = false;
+    _writeError = false;
+    if (!_writer.start()) {
+        tsp->error(u"error starting file writer thread");
+        return false;
+    }
+
     // Create the first segment file.
     return createNextSegment();
 }
@@ -226,8 +279,50 @@ bool ts::hls::OutputPlugin::start()
 
 bool ts::hls::OutputPlugin::stop()
 {
-    // Simply close the current segmetn (and generate the corresponding playlist).
-    return closeCurrentSegment(true);
+    // Close the current segment (and generate the corresponding playlist).
+    const bool ok = closeCurrentSegment(true);
+
+    // Wait for all files to be written.
+    {
+        GuardCondition lock(_mutex, _jobQueued);
+        _writerTerminate = true;
+        lock.signal();
+    }
+    _writer.waitForTermination();
+
+    return ok && !_writeError;
+}
+
+
+//----------------------------------------------------------------------------
+// Build segment and partial segment file names.
+//----------------------------------------------------------------------------
+
+ts::UString ts::hls::OutputPlugin::segmentFileName(size_t index) const
+{
+    return UString::Format(u"%s%0*d%s", {_segmentTemplateHead, _segmentNumWidth, index, _segmentTemplateTail});
+}
+
+ts::UString ts::hls::OutputPlugin::PartFileName(const UString& segmentName, size_t index)
+{
+    return UString::Format(u"%s.%d%s", {PathPrefix(segmentName), index, PathSuffix(segmentName)});
+}
+
+
+//----------------------------------------------------------------------------
+// Estimated duration of packets in the current segment.
+//----------------------------------------------------------------------------
+
+ts::MilliSecond ts::hls::OutputPlugin::packetsDuration(PacketCounter packets, MilliSecond defaultDuration)
+{
+    // We use PCR's from the segment to compute the average bitrate. If we cannot
+    // get the bitrate of a segment but got one from previous segment, assume that
+    // bitrate did not change and reuse previous one.
+    if (_pcrAnalyzer.bitrateIsValid()) {
+        // We have an estimation of the bitrate of the segment file.
+        _previousBitrate = _pcrAnalyzer.bitrate188();
+    }
+    return _previousBitrate > 0 ? PacketInterval(_previousBitrate, packets) : defaultDuration;
 }
 
 
@@ -242,18 +337,20 @@ bool ts::hls::OutputPlugin::createNextSegment()
         return false;
     }
 
-    // Generate a new segment file name.
-    const UString fileName(UString::Format(u"%s%0*d%s", {_segmentTemplateHead, _segmentNumWidth, _segmentNextFile, _segmentTemplateTail}));
-
-    // Create the segment file.
-    tsp->verbose(u"creating media segment %s", {fileName});
-    if (!_segmentFile.open(fileName, TSFile::WRITE | TSFile::SHARED, *tsp)) {
-        return false;
-    }
+    // Generate a new segment file name. The segment is built in memory.
+    _segmentName = segmentFileName(_segmentNextFile);
+    _segmentData.clear();
+    tsp->verbose(u"creating media segment %s", {_segmentName});
 
     // Increment index for next segment name.
     _segmentNextFile++;
 
+    // Reset the first partial segment.
+    _partStart = 0;
+    _partIndex = 0;
+    _partVideoSeen = false;
+    _partIndependent = false;
+
     // Reset the PCR analysis in each segment to get to bitrate of this segment.
     _pcrAnalyzer.reset();
 
@@ -273,16 +370,22 @@ bool ts::hls::OutputPlugin::createNextSegment()
 bool ts::hls::OutputPlugin::closeCurrentSegment(bool endOfStream)
 {
     // If no segment file is open, there is nothing to do.
-    if (!_segmentFile.isOpen()) {
+    if (_segmentName.empty()) {
         return true;
     }
 
+    // With low-latency HLS, close the last partial segment of this segment.
+    if (_partDuration > 0 && _segmentData.size() > _partStart && !closeCurrentPart(false)) {
+        return false;
+    }
+
     // Get the segment file name and size (to be inserted in the playlist).
-    const UString segName(_segmentFile.getFileName());
-    const PacketCounter segPackets = _segmentFile.getWriteCount();
+    const UString segName(_segmentName);
+    const PacketCounter segPackets = _segmentData.size() / PKT_SIZE;
+    _segmentName.clear();
 
-    // Close the TS file.
-    if (!_segmentFile.close(*tsp)) {
+    // Write the segment file.
+    if (!queueWrite(segName, _segmentData)) {
         return false;
     }
 
@@ -301,19 +404,11 @@ bool ts::hls::OutputPlugin::closeCurrentSegment(bool endOfStream)
         hls::MediaSegment seg;
         seg.uri = segName;
 
-        // Estimate duration and bitrate of the segment. We use PCR's from the
-        // segment to compute the average bitrate. Then we compute the duration
-        // from the bitrate and segment file size. If we cannot get the bitrate
-        // of a segment but got one from previous segment, assume that bitrate
-        // did not change and reuse previous one.
-        if (_pcrAnalyzer.bitrateIsValid()) {
-            // We have an estimation of the bitrate of the segment file.
-            _previousBitrate = _pcrAnalyzer.bitrate188();
-        }
+        // Estimate duration and bitrate of the segment. We compute the duration
+        // from the segment bitrate (or the previous one) and segment file size.
+        seg.duration = packetsDuration(segPackets, 0);
         if (_previousBitrate > 0) {
-            // Compute duration based on segment bitrate (or previous one).
             seg.bitrate = _previousBitrate;
-            seg.duration = PacketInterval(seg.bitrate, segPackets);
         }
         else {
             // Completely unknown bitrate, we build a fake one based on the target duration.
@@ -327,17 +422,16 @@ bool ts::hls::OutputPlugin::closeCurrentSegment(bool endOfStream)
             _playlist.popFirstSegment(seg);
         }
 
-        // Write the playlist file.
-        if (!_playlist.saveFile(UString(), *tsp)) {
-            return false;
+        // The next partial segment is the first one in the next segment.
+        if (_partDuration > 0) {
+            _playlist.setPreloadHint(endOfStream ? UString() : PartFileName(segmentFileName(_segmentNextFile), 0), *tsp);
         }
 
-        // WARNING: suggested improvement:
-        //   On Windows, if we overwrite the playlist file while a client is downloading it,
-        //   the file is locked by the HTTP server and the replacement will fail. We should
-        //   keep a list of failed deletions to retry these deletions later. On Unix systems,
-        //   we should not have the problem since the deletion succeeds even if the file
-        //   is already open (the file actually disappears when the file is closed).
+        // Write the playlist file. The file is atomically replaced, clients
+        // which are downloading the previous version are not affected.
+        if (!queuePlayList()) {
+            return false;
+        }
     }
 
     // On live streams, purge obsolete segment files.
@@ -349,8 +443,8 @@ bool ts::hls::OutputPlugin::closeCurrentSegment(bool endOfStream)
 
         // Delete the segment file.
         tsp->verbose(u"deleting obsolete segment file %s", {name});
-        if (DeleteFile(name) != SYS_SUCCESS) {
-            tsp->verbose(u"error deleting obsolete segment file %s", {name});
+        if (!queueDelete(name)) {
+            return false;
         }
 
         // WARNING: several improvements are possible here.
@@ -364,10 +458,173 @@ bool ts::hls::OutputPlugin::closeCurrentSegment(bool endOfStream)
         //   is already open (the file actually disappears when the file is closed).
     }
 
+    // Purge obsolete partial segment files. The playlist references partial segments during
+    // three target durations. Keep them one more target duration for slow clients.
+    while (!_partFiles.empty() && _partFiles.front().end + 4 * _targetDuration * MilliSecPerSec < _outputDuration) {
+        tsp->debug(u"deleting obsolete partial segment file %s", {_partFiles.front().name});
+        if (!queueDelete(_partFiles.front().name)) {
+            return false;
+        }
+        _partFiles.pop_front();
+    }
+
     return true;
 }
 
 
+//----------------------------------------------------------------------------
+// Close current partial segment (low-latency HLS).
+//----------------------------------------------------------------------------
+
+bool ts::hls::OutputPlugin::closeCurrentPart(bool updatePlaylist)
+{
+    assert(_partStart <= _segmentData.size());
+
+    // Describe the new partial segment.
+    hls::MediaPart part;
+    part.uri = PartFileName(_segmentName, _partIndex);
+    part.duration = packetsDuration((_segmentData.size() - _partStart) / PKT_SIZE, _partDuration);
+    part.independent = _partIndependent;
+    _outputDuration += part.duration;
+    tsp->debug(u"closing partial segment %s, %d ms", {part.uri, part.duration});
+
+    // Write the partial segment file, a copy of the end of the segment data.
+    ByteBlock data(_segmentData.data() + _partStart, _segmentData.size() - _partStart);
+    if (!queueWrite(part.uri, data)) {
+        return false;
+    }
+    _partFiles.push_back(PartFile(part.uri, _outputDuration));
+    _playlist.addPartialSegment(part, *tsp);
+
+    // Start the next partial segment.
+    _partStart = _segmentData.size();
+    _partIndex++;
+    _partVideoSeen = false;
+    _partIndependent = false;
+
+    // Publish the new partial segment in the playlist.
+    return !updatePlaylist || (_playlist.setPreloadHint(PartFileName(_segmentName, _partIndex), *tsp) && queuePlayList());
+}
+
+
+//----------------------------------------------------------------------------
+// Queue file operations for the writer thread.
+//----------------------------------------------------------------------------
+
+bool ts::hls::OutputPlugin::queueWrite(const UString& name, ByteBlock& data)
+{
+    FileJob job;
+    job.name = name;
+    job.data.swap(data);
+    return queueJob(job);
+}
+
+bool ts::hls::OutputPlugin::queueDelete(const UString& name)
+{
+    FileJob job;
+    job.name = name;
+    job.remove = true;
+    return queueJob(job);
+}
+
+bool ts::hls::OutputPlugin::queuePlayList()
+{
+    const UString text(_playlist.textContent(*tsp));
+    if (text.empty()) {
+        return false;
+    }
+    FileJob job;
+    job.name = _playlistFile;
+    job.data.appendUTF8(text);
+    return queueJob(job);
+}
+
+bool ts::hls::OutputPlugin::queueJob(FileJob& job)
+{
+    GuardCondition lock(_mutex, _jobDone);
+
+    // Wait for the writer thread when too many operations are pending.
+    while (_jobs.size() >= MAX_QUEUED_JOBS && !_writeError) {
+        lock.waitCondition();
+    }
+    if (_writeError) {
+        return false;
+    }
+
+    // Move the job in the queue, without copying the data.
+    _jobs.push_back(FileJob());
+    _jobs.back().name = job.name;
+    _jobs.back().data.swap(job.data);
+    _jobs.back().remove = job.remove;
+    _jobQueued.signal();
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Internal thread which writes segment and playlist files.
+//----------------------------------------------------------------------------
+
+ts::hls::OutputPlugin::Writer::Writer(OutputPlugin* plugin) :
+    Thread(ThreadAttributes().setStackSize(plugin->stackUsage())),
+    _plugin(plugin)
+{
+}
+
+ts::hls::OutputPlugin::Writer::~Writer()
+{
+    waitForTermination();
+}
+
+void ts::hls::OutputPlugin::Writer::main()
+{
+    _plugin->tsp->debug(u"HLS file writer thread started");
+
+    for (;;) {
+        // Wait for a job, take it out of the queue.
+        FileJobList next;
+        {
+            GuardCondition lock(_plugin->_mutex, _plugin->_jobQueued);
+            while (_plugin->_jobs.empty() && !_plugin->_writerTerminate) {
+                lock.waitCondition();
+            }
+            if (_plugin->_jobs.empty()) {
+                break; // terminated and nothing more to write
+            }
+            next.splice(next.end(), _plugin->_jobs, _plugin->_jobs.begin());
+        }
+        const FileJob& job(next.front());
+
+        // Perform the operation, outside the mutex.
+        bool ok = true;
+        if (job.remove) {
+            if (DeleteFile(job.name) != SYS_SUCCESS) {
+                _plugin->tsp->verbose(u"error deleting obsolete file %s", {job.name});
+            }
+        }
+        else {
+            // Write a temporary file and atomically replace the final one.
+            const UString tmpName(job.name + TEMP_FILE_SUFFIX);
+            ok = job.data.saveToFile(tmpName, _plugin->tsp);
+            if (ok && RenameFile(tmpName, job.name) != SYS_SUCCESS) {
+                _plugin->tsp->error(u"error renaming %s to %s", {tmpName, job.name});
+                DeleteFile(tmpName);
+                ok = false;
+            }
+        }
+
+        // Notify the completion of the job.
+        GuardCondition lock(_plugin->_mutex, _plugin->_jobDone);
+        if (!ok) {
+            _plugin->_writeError = true;
+        }
+        lock.signal();
+    }
+
+    _plugin->tsp->debug(u"HLS file writer thread completed");
+}
+
+
 //----------------------------------------------------------------------------
 // Implementation of TableHandlerInterface.
 //----------------------------------------------------------------------------
@@ -450,10 +707,8 @@ bool ts::hls::OutputPlugin::writePackets(const TSPacket* pkt, size_t packetCount
             p = &tmp;
         }
 
-        // Write the packet in the segment file.
-        if (!_segmentFile.write(p, 1, *tsp)) {
-            return false;
-        }
+        // Append the packet to the segment data.
+        _segmentData.append(p->b, PKT_SIZE);
     }
     return true;
 }
@@ -465,7 +720,7 @@ bool ts::hls::OutputPlugin::writePackets(const TSPacket* pkt, size_t packetCount
 
 bool ts::hls::OutputPlugin::send(const TSPacket* pkt, const TSPacketMetadata* pkt_data, size_t packetCount)
 {
-    bool ok = true;
+    bool ok = !_writeError;
 
     // Process packets one by one.
     for (size_t i = 0; ok && i < packetCount; ++i) {
@@ -477,10 +732,11 @@ bool ts::hls::OutputPlugin::send(const TSPacket* pkt, const TSPacketMetadata* pk
         _pcrAnalyzer.feedPacket(pkt[i]);
 
         // Check if we should close the current segment and create a new one.
+        const PacketCounter segPackets = _segmentData.size() / PKT_SIZE;
         bool renew = false;
         if (_fixedSegmentSize > 0) {
             // Each segment shall have a fixed size.
-            renew = _segmentFile.getWriteCount() >= _fixedSegmentSize;
+            renew = segPackets >= _fixedSegmentSize;
         }
         else if (!_segClosePending) {
             if (pkt_data[i].hasAnyLabel(_close_labels)) {
@@ -489,16 +745,44 @@ bool ts::hls::OutputPlugin::send(const TSPacket* pkt, const TSPacketMetadata* pk
             }
             else if (_pcrAnalyzer.bitrateIsValid()) {
                 // The segment file shall be closed when the estimated duration exceeds the target duration.
-                _segClosePending = PacketInterval(_pcrAnalyzer.bitrate188(), _segmentFile.getWriteCount()) >= _targetDuration * MilliSecPerSec;
+                _segClosePending = PacketInterval(_pcrAnalyzer.bitrate188(), segPackets) >= _targetDuration * MilliSecPerSec;
             }
         }
 
+        // Keep track of the size of PES packets on the video PID.
+        const bool videoStart = _videoPID != PID_NULL && pkt[i].getPID() == _videoPID && pkt[i].getPUSI();
+        if (videoStart) {
+            _videoPESPackets = _packetCount - _lastVideoStart;
+            _lastVideoStart = _packetCount;
+        }
+        _packetCount++;
+
         // We do close only when we start a new PES packet on the video PID.
-        renew = renew || (_segClosePending && (_videoPID == PID_NULL || (pkt[i].getPID() == _videoPID && pkt[i].getPUSI())));
+        renew = renew || (_segClosePending && (_videoPID == PID_NULL || videoStart));
 
         // Close current segment and recreate a new one when necessary.
+        if (renew) {
+            ok = createNextSegment();
+        }
+        else if (_partDuration > 0 && (_videoPID == PID_NULL || videoStart)) {
+            // With low-latency HLS, close the current partial segment when it would exceed
+            // the part target duration with the next video PES packet (assuming it has the
+            // same size as the previous one).
+            const PacketCounter partPackets = (_segmentData.size() - _partStart) / PKT_SIZE;
+            const PacketCounter nextPackets = videoStart ? _videoPESPackets : 1;
+            if (partPackets > 0 && packetsDuration(partPackets + nextPackets, 0) > _partDuration) {
+                ok = closeCurrentPart(true);
+            }
+        }
+
+        // A partial segment is independent when its first video PES packet is a random access point.
+        if (videoStart && !_partVideoSeen) {
+            _partVideoSeen = true;
+            _partIndependent = pkt[i].getRandomAccessIndicator();
+        }
+
         // Finally write the packet.
-        ok = (!renew || createNextSegment()) && writePackets(pkt + i, 1);
+        ok = ok && writePackets(pkt + i, 1);
     }
     return ok;
 }
@@ -35,7 +35,9 @@
 #pragma once
 #include "tsPlugin.h"
 #include "tsSectionDemux.h"
-#include "tsTSFile.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
 #include "tsPCRAnalyzer.h"
 #include "tsContinuityAnalyzer.h"
 #include "tshlsPlayList.h"
@@ -51,6 +53,13 @@ namespace ts {
         //! playlists. To setup a complete HLS server, it is necessary to setup an
         //! external HTTP server such as Apache which simply serves these files.
         //!
+        //! Media segments are built in memory. All files are written by a separate
+        //! thread. Each file is first written under a temporary name and then renamed
+        //! so that the HTTP server never serves a partially written file.
+        //!
+        //! With low-latency HLS, each media segment is also split into partial segments
+        //! which are published in the playlist as soon as they are complete.
+        //!
         class TSDUCKDLL OutputPlugin: public ts::OutputPlugin, private TableHandlerInterface
         {
             TS_NOBUILD_NOCOPY(OutputPlugin);
@@ -69,6 +78,40 @@ namespace ts {
             virtual bool send(const TSPacket*, const TSPacketMetadata* pkt_data, size_t) override;
 
         private:
+            // A file operation which is performed by the writer thread.
+            class FileJob
+            {
+            public:
+                FileJob() : name(), data(), remove(false) {}
+                UString   name;    // File name.
+                ByteBlock data;    // Content to write.
+                bool      remove;  // Delete the file instead of writing it.
+            };
+            typedef std::list<FileJob> FileJobList;
+
+            // A partial segment file, to be deleted when obsolete.
+            class PartFile
+            {
+            public:
+                PartFile(const UString& n, MilliSecond e) : name(n), end(e) {}
+                UString     name;  // File name.
+                MilliSecond end;   // Time of the end of the partial segment in the output stream.
+            };
+            typedef std::list<PartFile> PartFileList;
+
+            // Internal thread which writes segment and playlist files.
+            class Writer : public Thread
+            {
+                TS_NOBUILD_NOCOPY(Writer);
+            public:
+                // Constructor & destructor.
+                Writer(OutputPlugin* plugin);
+                virtual ~Writer();
+                virtual void main() override;
+            private:
+                OutputPlugin* _plugin;
+            };
+
             UString            _segmentTemplate;       // Command line segment file names template.
             UString            _segmentTemplateHead;   // Head of segment file names.
             UString            _segmentTemplateTail;   // Tail of segment file names.
@@ -77,6 +120,7 @@ namespace ts {
             UString            _playlistFile;          // Playlist file name.
             PacketCounter      _fixedSegmentSize;      // Optional fixed segment size in packets.
             Second             _targetDuration;        // Segment target duration in seconds.
+            MilliSecond        _partDuration;          // Partial segment target duration in milliseconds (low-latency HLS).
             size_t             _liveDepth;             // Number of simultaneous segments in live streams.
             size_t             _initialMediaSeq;       // Initial media sequence value.
             SectionDemux       _demux;                 // Demux to extract PAT and PMT.
@@ -85,7 +129,8 @@ namespace ts {
             PID                _videoPID;              // Video PID on which the segmentation is evaluated.
             PID                _pmtPID;                // PID of the PMT of the reference service.
             bool               _segClosePending;       // Close the current segment when possible.
-            TSFile             _segmentFile;           // Output segment file.
+            UString            _segmentName;           // Current segment file name, empty if none.
+            ByteBlock          _segmentData;           // Content of current segment.
             UStringList        _liveSegmentFiles;      // List of current segments in a live stream.
             hls::PlayList      _playlist;              // Generated playlist.
             PCRAnalyzer        _pcrAnalyzer;           // PCR analyzer to compute bitrates.
@@ -93,17 +138,53 @@ namespace ts {
             ContinuityAnalyzer _ccFixer;               // To fix continuity counters in PAT and PMT PID's.
             TSPacketMetadata::LabelSet _close_labels;  // Close segment on packets with any of these labels.
 
+            // Partial segments (low-latency HLS).
+            size_t             _partStart;             // Offset in _segmentData of current partial segment.
+            size_t             _partIndex;             // Index of current partial segment in segment.
+            bool               _partVideoSeen;         // A video PES packet was found in current partial segment.
+            bool               _partIndependent;       // Current partial segment starts with an independent frame.
+            PacketCounter      _packetCount;           // Number of output packets.
+            PacketCounter      _lastVideoStart;        // Index of last packet starting a video PES packet.
+            PacketCounter      _videoPESPackets;       // Number of packets in last video PES packet.
+            MilliSecond        _outputDuration;        // Cumulated duration of all partial segments.
+            PartFileList       _partFiles;             // Partial segment files on disk.
+
+            // File writer thread and its shared data, protected by _mutex.
+            Writer             _writer;
+            Mutex              _mutex;
+            Condition          _jobQueued;             // Signaled when a job is queued or on termination.
+            Condition          _jobDone;               // Signaled when a job is completed.
+            FileJobList        _jobs;                  // File operations to perform, in order.
+            bool               _writerTerminate;       // Writer thread shall terminate after completing all jobs.
+            volatile bool      _writeError;            // An error occured in the writer thread.
+
+            // Build segment and partial segment file names.
+            UString segmentFileName(size_t index) const;
+            static UString PartFileName(const UString& segmentName, size_t index);
+
+            // Estimated duration of packets in the current segment.
+            MilliSecond packetsDuration(PacketCounter packets, MilliSecond defaultDuration);
+
             // Create the next segment file (also close the previous one if necessary).
             bool createNextSegment();
 
             // Close current segment file (also purge obsolete segment files and regenerate playlist).
             bool closeCurrentSegment(bool endOfStream);
 
+            // Close current partial segment (optionally regenerate playlist).
+            bool closeCurrentPart(bool updatePlaylist);
+
             // Implementation of TableHandlerInterface.
             virtual void handleTable(SectionDemux&, const BinaryTable&) override;
 
             // Write packets into the current segment file, adjust CC in PAT and PMT PID.
             bool writePackets(const TSPacket*, size_t);
+
+            // Queue file operations for the writer thread. The data are swapped, not copied.
+            bool queueWrite(const UString& name, ByteBlock& data);
+            bool queueDelete(const UString& name);
+            bool queuePlayList();
+            bool queueJob(FileJob& job);
         };
     }
 }
@@ -243,8 +243,10 @@
 #include "tsHiDesDevice.h"
 #include "tsHiDesDeviceInfo.h"
 #include "tsHierarchyDescriptor.h"
+#include "tsHitlessMerger.h"
 #include "tshls.h"
 #include "tshlsInputPlugin.h"
+#include "tshlsMediaPart.h"
 #include "tshlsMediaPlayList.h"
 #include "tshlsMediaSegment.h"
 #include "tshlsOutputPlugin.h"
@@ -349,6 +351,7 @@
 #include "tsPESDemux.h"
 #include "tsPESHandlerInterface.h"
 #include "tsPESPacket.h"
+#include "tsPIDIndexedMap.h"
 #include "tsPIDOperator.h"
 #include "tsPlatform.h"
 #include "tsPlugin.h"
@@ -364,8 +367,10 @@
 #include "tsPrivateDataIndicatorDescriptor.h"
 #include "tsPrivateDataSpecifierDescriptor.h"
 #include "tsProtectionMessageDescriptor.h"
+#include "tsPSIEditors.h"
 #include "tsPSILogger.h"
 #include "tsPSIMerger.h"
+#include "tsPSIViews.h"
 #include "tsPushInputPlugin.h"
 #include "tsRandomGenerator.h"
 #include "tsRedistributionControlDescriptor.h"
@@ -394,6 +399,7 @@
 #include "tsSectionFile.h"
 #include "tsSectionHandlerInterface.h"
 #include "tsSectionProviderInterface.h"
+#include "tsSegmentedTimeShiftBuffer.h"
 #include "tsSelectionInformationTable.h"
 #include "tsService.h"
 #include "tsServiceAvailabilityDescriptor.h"
@@ -408,6 +414,7 @@
 #include "tsSHA256.h"
 #include "tsSHA512.h"
 #include "tsSharedLibrary.h"
+#include "tsSharedPacketRing.h"
 #include "tsSHDeliverySystemDescriptor.h"
 #include "tsShortEventDescriptor.h"
 #include "tsShortSmoothingBufferDescriptor.h"
@@ -0,0 +1,92 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Benchmarks for class ts::CRC32.
+//
+//----------------------------------------------------------------------------
+
+#include "tsbench.h"
+#include "tsCRC32.h"
+#include "tsByteBlock.h"
+TSDUCK_SOURCE;
+
+namespace {
+    class CRC32Bench: public tsbench::Benchmark
+    {
+        TS_NOBUILD_NOCOPY(CRC32Bench);
+    public:
+        CRC32Bench(const ts::UString& variant, ts::CRC32::Engine engine, size_t chunk) :
+            Benchmark(u"crc32." + variant, u"byte", ts::UString::Format(u"CRC32 on %d-byte chunks, %s implementation", {chunk, variant})),
+            _engine(engine),
+            _chunk(chunk),
+            _data()
+        {
+            _unit_size = 1;
+        }
+
+        virtual bool setup(uint32_t seed) override
+        {
+            if (!ts::CRC32::IsSupported(_engine)) {
+                return false;
+            }
+            _data.resize(4 * 1024 * 1024);
+            tsbench::Random(seed).fill(_data.data(), _data.size());
+            return true;
+        }
+
+        virtual uint64_t run() override
+        {
+            uint32_t sum = 0;
+            for (size_t i = 0; i + _chunk <= _data.size(); i += _chunk) {
+                ts::CRC32 crc;
+                crc.add(&_data[i], _chunk, _engine);
+                sum ^= crc.value();
+            }
+            _checksum = sum;
+            return (_data.size() / _chunk) * _chunk;
+        }
+
+        virtual void teardown() override
+        {
+            _data.clear();
+        }
+
+    private:
+        ts::CRC32::Engine _engine;
+        size_t            _chunk;
+        ts::ByteBlock     _data;
+    };
+
+    // Large chunks measure the raw throughput, small chunks are typical PSI/SI sections.
+    tsbench::Register _reg_def([]() -> tsbench::Benchmark* { return new CRC32Bench(u"default", ts::CRC32::DEFAULT, 65536); });
+    tsbench::Register _reg_byte([]() -> tsbench::Benchmark* { return new CRC32Bench(u"bytewise", ts::CRC32::BYTEWISE, 65536); });
+    tsbench::Register _reg_sl8([]() -> tsbench::Benchmark* { return new CRC32Bench(u"slice8", ts::CRC32::SLICE_BY_8, 65536); });
+    tsbench::Register _reg_clmul([]() -> tsbench::Benchmark* { return new CRC32Bench(u"clmul", ts::CRC32::CARRY_LESS, 65536); });
+    tsbench::Register _reg_sect([]() -> tsbench::Benchmark* { return new CRC32Bench(u"section", ts::CRC32::DEFAULT, 1024); });
+}
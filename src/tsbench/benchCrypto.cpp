@@ -0,0 +1,182 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Benchmarks for DVB scrambling algorithms.
+//
+//----------------------------------------------------------------------------
+
+#include "tsbench.h"
+#include "tsDVBCSA2.h"
+#include "tsDVBCISSA.h"
+#include "tsAES.h"
+#include "tsByteBlock.h"
+TSDUCK_SOURCE;
+
+#define CRYPTO_PACKETS  10000  // Number of TS packet payloads per iteration.
+#define PAYLOAD_SIZE    184    // Size of a TS packet payload.
+
+
+//----------------------------------------------------------------------------
+// Scramble or descramble TS packet payloads with DVB-CSA2 and DVB-CISSA.
+//----------------------------------------------------------------------------
+
+namespace {
+    class PayloadCipherBench: public tsbench::Benchmark
+    {
+        TS_NOBUILD_NOCOPY(PayloadCipherBench);
+    public:
+        enum Mode {SCRAMBLE, DESCRAMBLE, BATCH};
+
+        PayloadCipherBench(const ts::UString& name, ts::BlockCipher* cipher, Mode mode) :
+            Benchmark(name, u"packet", ts::UString::Format(u"%s %s of TS packet payloads", {cipher->name(), mode == DESCRAMBLE ? u"descrambling" : (mode == BATCH ? u"batch scrambling" : u"scrambling")})),
+            _cipher(cipher),
+            _mode(mode),
+            _size(PAYLOAD_SIZE),
+            _data()
+        {
+            _unit_size = PAYLOAD_SIZE;
+            const ts::CipherChaining* chain = dynamic_cast<const ts::CipherChaining*>(_cipher);
+            if (chain != nullptr && !chain->residueAllowed()) {
+                _size -= _size % chain->blockSize();
+            }
+        }
+
+        virtual ~PayloadCipherBench() override
+        {
+            delete _cipher;
+        }
+
+        virtual bool setup(uint32_t seed) override
+        {
+            tsbench::Random rnd(seed);
+            ts::ByteBlock key(_cipher->minKeySize());
+            rnd.fill(key.data(), key.size());
+            _data.resize(CRYPTO_PACKETS * PAYLOAD_SIZE);
+            rnd.fill(_data.data(), _data.size());
+            // Check once that the operation is supported on this payload size.
+            return _cipher->setKey(key.data(), key.size()) && _cipher->encryptInPlace(&_data[0], _size);
+        }
+
+        virtual uint64_t run() override
+        {
+            bool ok = true;
+            if (_mode == BATCH) {
+                ts::DVBCSA2* csa = dynamic_cast<ts::DVBCSA2*>(_cipher);
+                void* addr[ts::DVBCSA2::MAX_BATCH_SIZE];
+                size_t sizes[ts::DVBCSA2::MAX_BATCH_SIZE];
+                for (size_t i = 0; ok && i < CRYPTO_PACKETS; ) {
+                    size_t count = 0;
+                    for (; count < ts::DVBCSA2::MAX_BATCH_SIZE && i < CRYPTO_PACKETS; ++count, ++i) {
+                        addr[count] = &_data[i * PAYLOAD_SIZE];
+                        sizes[count] = _size;
+                    }
+                    ok = csa != nullptr && csa->encryptInPlaceBatch(addr, sizes, count);
+                }
+            }
+            else {
+                for (size_t i = 0; ok && i < CRYPTO_PACKETS; ++i) {
+                    ok = _mode == SCRAMBLE ?
+                        _cipher->encryptInPlace(&_data[i * PAYLOAD_SIZE], _size) :
+                        _cipher->decryptInPlace(&_data[i * PAYLOAD_SIZE], _size);
+                }
+            }
+            _checksum = ok ? _data[0] + _data[_data.size() - 1] : 0;
+            return CRYPTO_PACKETS;
+        }
+
+        virtual void teardown() override
+        {
+            _data.clear();
+        }
+
+    private:
+        ts::BlockCipher* _cipher;
+        Mode             _mode;
+        size_t           _size;  // Scrambled part of the payload, the residue is left clear when necessary.
+        ts::ByteBlock    _data;
+    };
+
+    tsbench::Register _reg_csa_enc([]() -> tsbench::Benchmark* { return new PayloadCipherBench(u"dvbcsa2.scramble", new ts::DVBCSA2, PayloadCipherBench::SCRAMBLE); });
+    tsbench::Register _reg_csa_dec([]() -> tsbench::Benchmark* { return new PayloadCipherBench(u"dvbcsa2.descramble", new ts::DVBCSA2, PayloadCipherBench::DESCRAMBLE); });
+    tsbench::Register _reg_csa_batch([]() -> tsbench::Benchmark* { return new PayloadCipherBench(u"dvbcsa2.batch", new ts::DVBCSA2, PayloadCipherBench::BATCH); });
+    tsbench::Register _reg_cissa_enc([]() -> tsbench::Benchmark* { return new PayloadCipherBench(u"dvbcissa.scramble", new ts::DVBCISSA, PayloadCipherBench::SCRAMBLE); });
+    tsbench::Register _reg_cissa_dec([]() -> tsbench::Benchmark* { return new PayloadCipherBench(u"dvbcissa.descramble", new ts::DVBCISSA, PayloadCipherBench::DESCRAMBLE); });
+}
+
+
+//----------------------------------------------------------------------------
+// Raw AES-128 block encryption.
+//----------------------------------------------------------------------------
+
+namespace {
+    class AESBench: public tsbench::Benchmark
+    {
+        TS_NOCOPY(AESBench);
+    public:
+        AESBench() :
+            Benchmark(u"aes128.blocks", u"byte", u"AES-128 encryption of 16-byte blocks"),
+            _aes(),
+            _plain(),
+            _cipher()
+        {
+            _unit_size = 1;
+        }
+
+        virtual bool setup(uint32_t seed) override
+        {
+            tsbench::Random rnd(seed);
+            uint8_t key[16];
+            rnd.fill(key, sizeof(key));
+            _plain.resize(1024 * 1024);
+            _cipher.resize(_plain.size());
+            rnd.fill(_plain.data(), _plain.size());
+            return _aes.setKey(key, sizeof(key));
+        }
+
+        virtual uint64_t run() override
+        {
+            const bool ok = _aes.encryptBlocks(_plain.data(), _cipher.data(), _plain.size() / ts::AES::BLOCK_SIZE);
+            _checksum = ok ? _cipher[0] + _cipher[_cipher.size() - 1] : 0;
+            return _plain.size();
+        }
+
+        virtual void teardown() override
+        {
+            _plain.clear();
+            _cipher.clear();
+        }
+
+    private:
+        ts::AES       _aes;
+        ts::ByteBlock _plain;
+        ts::ByteBlock _cipher;
+    };
+
+    tsbench::Register _reg_aes([]() -> tsbench::Benchmark* { return new AESBench; });
+}
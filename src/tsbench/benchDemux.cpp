@@ -0,0 +1,270 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Benchmarks for classes ts::SectionDemux and ts::PESDemux.
+//
+//----------------------------------------------------------------------------
+
+#include "tsbench.h"
+#include "tsSectionDemux.h"
+#include "tsPESDemux.h"
+#include "tsCyclingPacketizer.h"
+#include "tsBinaryTable.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+TSDUCK_SOURCE;
+
+#define PSI_SERVICES    100     // Number of services in the synthetic PSI/SI stream.
+#define STREAM_PACKETS  100000  // Number of TS packets per iteration.
+#define PES_MIN_SIZE    2000    // Minimum PES packet size in synthetic video stream.
+#define PES_MAX_SIZE    40000   // Maximum PES packet size in synthetic video stream.
+#define PES_PID         0x0100  // Video PID in synthetic video stream.
+#define PES_PMT_PID     0x0080  // PMT PID in synthetic video stream.
+
+
+//----------------------------------------------------------------------------
+// SectionDemux on a PSI/SI-heavy stream.
+//----------------------------------------------------------------------------
+
+namespace {
+    class SectionDemuxBench: public tsbench::Benchmark, private ts::TableHandlerInterface, private ts::SectionHandlerInterface
+    {
+        TS_NOBUILD_NOCOPY(SectionDemuxBench);
+    public:
+        SectionDemuxBench(bool sections) :
+            Benchmark(sections ? u"sectiondemux.sections" : u"sectiondemux.tables",
+                      u"packet",
+                      ts::UString::Format(u"SectionDemux, %d services PSI/SI stream, %s handler", {PSI_SERVICES, sections ? u"section" : u"table"})),
+            _duck(),
+            _demux(_duck, sections ? nullptr : this, sections ? this : nullptr, ts::AllPIDs),
+            _packets()
+        {
+            _unit_size = ts::PKT_SIZE;
+        }
+
+        virtual bool setup(uint32_t seed) override
+        {
+            tsbench::BuildPSIStream(_duck, _packets, PSI_SERVICES, STREAM_PACKETS, seed);
+            return true;
+        }
+
+        virtual uint64_t run() override
+        {
+            // Reset the demux to process all tables again, as in a new stream.
+            _checksum = 0;
+            _demux.reset();
+            _demux.setPIDFilter(ts::AllPIDs);
+            for (const auto& pkt : _packets) {
+                _demux.feedPacket(pkt);
+            }
+            return _packets.size();
+        }
+
+        virtual void teardown() override
+        {
+            _packets.clear();
+        }
+
+    private:
+        ts::DuckContext    _duck;
+        ts::SectionDemux   _demux;
+        ts::TSPacketVector _packets;
+
+        virtual void handleTable(ts::SectionDemux&, const ts::BinaryTable& table) override
+        {
+            _checksum += table.tableId() + table.sectionCount();
+        }
+
+        virtual void handleSection(ts::SectionDemux&, const ts::Section& section) override
+        {
+            _checksum += section.size();
+        }
+    };
+
+    tsbench::Register _reg_tables([]() -> tsbench::Benchmark* { return new SectionDemuxBench(false); });
+    tsbench::Register _reg_sections([]() -> tsbench::Benchmark* { return new SectionDemuxBench(true); });
+}
+
+
+//----------------------------------------------------------------------------
+// PESDemux on a synthetic video stream.
+//----------------------------------------------------------------------------
+
+namespace {
+    class PESDemuxBench: public tsbench::Benchmark, private ts::PESHandlerInterface
+    {
+        TS_NOBUILD_NOCOPY(PESDemuxBench);
+    public:
+        PESDemuxBench(bool avc) :
+            Benchmark(avc ? u"pesdemux.avc" : u"pesdemux.mpeg2",
+                      u"packet",
+                      ts::UString::Format(u"PESDemux, %s video stream, start code analysis", {avc ? u"AVC" : u"MPEG-2"})),
+            _avc(avc),
+            _duck(),
+            _demux(_duck, this),
+            _packets()
+        {
+            _unit_size = ts::PKT_SIZE;
+        }
+
+        virtual bool setup(uint32_t seed) override;
+
+        virtual uint64_t run() override
+        {
+            _checksum = 0;
+            _demux.reset();
+            for (const auto& pkt : _packets) {
+                _demux.feedPacket(pkt);
+            }
+            return _packets.size();
+        }
+
+        virtual void teardown() override
+        {
+            _packets.clear();
+        }
+
+    private:
+        bool               _avc;
+        ts::DuckContext    _duck;
+        ts::PESDemux       _demux;
+        ts::TSPacketVector _packets;
+
+        // Append a PES packet to the stream.
+        void addPES(const ts::ByteBlock& pes, uint8_t& cc);
+
+        virtual void handlePESPacket(ts::PESDemux&, const ts::PESPacket& packet) override
+        {
+            _checksum += packet.size();
+        }
+
+        virtual void handleVideoStartCode(ts::PESDemux&, const ts::PESPacket&, uint8_t start_code, size_t offset, size_t size) override
+        {
+            _checksum += start_code + offset + size;
+        }
+
+        virtual void handleAVCAccessUnit(ts::PESDemux&, const ts::PESPacket&, uint8_t nal_unit_type, size_t offset, size_t size) override
+        {
+            _checksum += nal_unit_type + offset + size;
+        }
+    };
+
+    tsbench::Register _reg_avc([]() -> tsbench::Benchmark* { return new PESDemuxBench(true); });
+    tsbench::Register _reg_mpeg2([]() -> tsbench::Benchmark* { return new PESDemuxBench(false); });
+}
+
+// Append a PES packet to the stream, stuffing the last TS packet with an adaptation field.
+void PESDemuxBench::addPES(const ts::ByteBlock& pes, uint8_t& cc)
+{
+    for (size_t offset = 0; offset < pes.size(); ) {
+        ts::TSPacket pkt;
+        pkt.init(PES_PID, cc, 0xFF);
+        cc = (cc + 1) & ts::CC_MASK;
+        pkt.setPUSI(offset == 0);
+        const size_t size = std::min(pes.size() - offset, ts::PKT_SIZE - 4);
+        const size_t stuffing = ts::PKT_SIZE - 4 - size;
+        if (stuffing > 0) {
+            // Adaptation field followed by payload.
+            pkt.b[3] |= 0x20;
+            pkt.b[4] = uint8_t(stuffing - 1);
+            if (stuffing > 1) {
+                pkt.b[5] = 0x00;
+            }
+        }
+        ::memcpy(pkt.b + ts::PKT_SIZE - size, &pes[offset], size);
+        offset += size;
+        _packets.push_back(pkt);
+    }
+}
+
+// Build a video stream with random content and start codes.
+bool PESDemuxBench::setup(uint32_t seed)
+{
+    tsbench::Random rnd(seed);
+    uint8_t cc_pat = 0;
+    uint8_t cc_pmt = 0;
+    uint8_t cc_pes = 0;
+
+    // PAT and PMT, sent regularly so that the demux knows the stream type after a reset.
+    ts::PAT pat(0, true, 1);
+    pat.pmts[1] = PES_PMT_PID;
+    ts::PMT pmt(0, true, 1, PES_PID);
+    pmt.streams[PES_PID].stream_type = _avc ? ts::ST_AVC_VIDEO : ts::ST_MPEG2_VIDEO;
+    ts::BinaryTable bin_pat, bin_pmt;
+    pat.serialize(_duck, bin_pat);
+    pmt.serialize(_duck, bin_pmt);
+
+    _packets.clear();
+    _packets.reserve(STREAM_PACKETS + 2 * ts::PKT_SIZE);
+    while (_packets.size() < STREAM_PACKETS) {
+
+        // One PAT and one PMT packet before each PES packet.
+        ts::CyclingPacketizer pz_pat(ts::PID_PAT);
+        ts::CyclingPacketizer pz_pmt(PES_PMT_PID);
+        pz_pat.addTable(bin_pat);
+        pz_pmt.addTable(bin_pmt);
+        ts::TSPacket pkt;
+        pz_pat.getNextPacket(pkt);
+        pkt.setCC(cc_pat++ & ts::CC_MASK);
+        _packets.push_back(pkt);
+        pz_pmt.getNextPacket(pkt);
+        pkt.setCC(cc_pmt++ & ts::CC_MASK);
+        _packets.push_back(pkt);
+
+        // PES header with PTS, unbounded size as usual in video streams.
+        ts::ByteBlock pes(14);
+        pes[0] = 0x00; pes[1] = 0x00; pes[2] = 0x01; pes[3] = 0xE0;
+        pes[4] = 0x00; pes[5] = 0x00;
+        pes[6] = 0x80; pes[7] = 0x80; pes[8] = 0x05;
+        pes[9] = 0x21; pes[10] = 0x00; pes[11] = 0x01; pes[12] = 0x00; pes[13] = 0x01;
+
+        // Payload: sequence of NAL units or video start codes with random content.
+        const size_t pes_size = PES_MIN_SIZE + rnd.next() % (PES_MAX_SIZE - PES_MIN_SIZE);
+        bool first = true;
+        while (pes.size() < pes_size) {
+            const size_t unit_size = 16 + rnd.next() % 4000;
+            const size_t start = pes.size();
+            pes.resize(start + unit_size);
+            rnd.fill(&pes[start], unit_size);
+            pes[start] = pes[start + 1] = 0x00;
+            pes[start + 2] = 0x01;
+            if (_avc) {
+                // Access unit delimiter first, then slices (non-IDR, type 1).
+                pes[start + 3] = first ? 0x09 : 0x01;
+            }
+            else {
+                // Picture start code first, then slices.
+                pes[start + 3] = first ? 0x00 : uint8_t(0x01 + rnd.next() % 0xAF);
+            }
+            first = false;
+        }
+        addPES(pes, cc_pes);
+    }
+    return true;
+}
@@ -0,0 +1,104 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Benchmarks for class ts::CyclingPacketizer.
+//
+//----------------------------------------------------------------------------
+
+#include "tsbench.h"
+#include "tsCyclingPacketizer.h"
+#include "tsAbstractTable.h"
+TSDUCK_SOURCE;
+
+#define PSI_SERVICES    100      // Number of services in the synthetic PSI/SI tables.
+#define OUTPUT_PACKETS  100000   // Number of TS packets per iteration.
+#define PID_BITRATE     2000000  // Bitrate of the PID when repetition rates are used.
+
+
+//----------------------------------------------------------------------------
+// Cycle all tables of a synthetic network in one PID.
+//----------------------------------------------------------------------------
+
+namespace {
+    class CyclingPacketizerBench: public tsbench::Benchmark
+    {
+        TS_NOBUILD_NOCOPY(CyclingPacketizerBench);
+    public:
+        CyclingPacketizerBench(bool scheduled) :
+            Benchmark(scheduled ? u"packetizer.scheduled" : u"packetizer.cycling",
+                      u"packet",
+                      ts::UString::Format(u"CyclingPacketizer, %d services PSI/SI, %s", {PSI_SERVICES, scheduled ? u"repetition rates" : u"plain cycle"})),
+            _scheduled(scheduled),
+            _duck(),
+            _pzer(ts::PID(0x0100), ts::CyclingPacketizer::AT_END, scheduled ? PID_BITRATE : 0)
+        {
+            _unit_size = ts::PKT_SIZE;
+        }
+
+        virtual bool setup(uint32_t seed) override
+        {
+            ts::AbstractTablePtrVector tables;
+            tsbench::BuildPSITables(_duck, tables, PSI_SERVICES, seed);
+            for (size_t i = 0; i < tables.size(); ++i) {
+                // Use DVB minimum repetition rates: PAT and PMT 100 ms, SDT 2 s, NIT 10 s.
+                ts::MilliSecond rate = 0;
+                if (_scheduled) {
+                    rate = tables[i]->tableId() == ts::TID_SDT_ACT ? 2000 : (tables[i]->tableId() == ts::TID_NIT_ACT ? 10000 : 100);
+                }
+                _pzer.addTable(_duck, *tables[i], rate);
+            }
+            return true;
+        }
+
+        virtual uint64_t run() override
+        {
+            ts::TSPacket pkt;
+            uint64_t sum = 0;
+            for (size_t i = 0; i < OUTPUT_PACKETS; ++i) {
+                _pzer.getNextPacket(pkt);
+                sum += pkt.b[4] + pkt.b[ts::PKT_SIZE - 1];
+            }
+            _checksum = sum;
+            return OUTPUT_PACKETS;
+        }
+
+        virtual void teardown() override
+        {
+            _pzer.removeAll();
+        }
+
+    private:
+        bool                  _scheduled;
+        ts::DuckContext       _duck;
+        ts::CyclingPacketizer _pzer;
+    };
+
+    tsbench::Register _reg_cycling([]() -> tsbench::Benchmark* { return new CyclingPacketizerBench(false); });
+    tsbench::Register _reg_scheduled([]() -> tsbench::Benchmark* { return new CyclingPacketizerBench(true); });
+}
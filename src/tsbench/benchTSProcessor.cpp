@@ -0,0 +1,160 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Macro-benchmark for class ts::TSProcessor (in-process tsp chain).
+//
+//----------------------------------------------------------------------------
+
+#include "tsbench.h"
+#include "tsTSProcessor.h"
+#include "tsPluginRepository.h"
+#include "tsNullReport.h"
+TSDUCK_SOURCE;
+
+#define TSP_PACKETS  1000000  // Number of TS packets per iteration.
+
+
+//----------------------------------------------------------------------------
+// Benchmark plugins, statically registered.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Input plugin: generate a given number of null packets with incrementing continuity counters.
+    class BenchInput: public ts::InputPlugin
+    {
+        TS_NOBUILD_NOCOPY(BenchInput);
+    public:
+        BenchInput(ts::TSP* t) : ts::InputPlugin(t, u"Generate benchmark packets", u"[options] count"), _max(0), _count(0)
+        {
+            option(u"", 0, UNSIGNED, 1, 1);
+        }
+        virtual bool getOptions() override
+        {
+            _max = intValue<ts::PacketCounter>(u"");
+            return true;
+        }
+        virtual bool start() override
+        {
+            _count = 0;
+            return true;
+        }
+        virtual size_t receive(ts::TSPacket* buffer, ts::TSPacketMetadata*, size_t max_packets) override
+        {
+            size_t n = 0;
+            for (; n < max_packets && _count < _max; ++n) {
+                buffer[n] = ts::NullPacket;
+                buffer[n].setCC(uint8_t(_count++ % ts::CC_MAX));
+            }
+            return n;
+        }
+    private:
+        ts::PacketCounter _max;
+        ts::PacketCounter _count;
+    };
+
+    // Packet processor plugin: do nothing, just let the packets pass.
+    class BenchNull: public ts::ProcessorPlugin
+    {
+        TS_NOBUILD_NOCOPY(BenchNull);
+    public:
+        BenchNull(ts::TSP* t) : ts::ProcessorPlugin(t, u"Pass benchmark packets", u"[options]") {}
+        virtual Status processPacket(ts::TSPacket&, ts::TSPacketMetadata&) override { return TSP_OK; }
+    };
+
+    // Output plugin: drop packets, count them.
+    std::atomic<ts::PacketCounter> _bench_output_count(0);
+
+    class BenchOutput: public ts::OutputPlugin
+    {
+        TS_NOBUILD_NOCOPY(BenchOutput);
+    public:
+        BenchOutput(ts::TSP* t) : ts::OutputPlugin(t, u"Drop benchmark packets", u"[options]") {}
+        virtual bool send(const ts::TSPacket*, const ts::TSPacketMetadata*, size_t packet_count) override
+        {
+            _bench_output_count += packet_count;
+            return true;
+        }
+    };
+
+    ts::InputPlugin* NewBenchInput(ts::TSP* t) { return new BenchInput(t); }
+    ts::ProcessorPlugin* NewBenchNull(ts::TSP* t) { return new BenchNull(t); }
+    ts::OutputPlugin* NewBenchOutput(ts::TSP* t) { return new BenchOutput(t); }
+
+    ts::PluginRepository::Register _reg_input("tsbench_input", NewBenchInput);
+    ts::PluginRepository::Register _reg_null("tsbench_null", NewBenchNull);
+    ts::PluginRepository::Register _reg_output("tsbench_output", NewBenchOutput);
+}
+
+
+//----------------------------------------------------------------------------
+// Packets per second through a chain of N null packet processors.
+//----------------------------------------------------------------------------
+
+namespace {
+    class TSProcessorBench: public tsbench::Benchmark
+    {
+        TS_NOBUILD_NOCOPY(TSProcessorBench);
+    public:
+        TSProcessorBench(size_t proc_count) :
+            Benchmark(ts::UString::Format(u"tsprocessor.null%d", {proc_count}),
+                      u"packet",
+                      ts::UString::Format(u"TSProcessor, synthetic input, %d null processors, default buffer", {proc_count})),
+            _args()
+        {
+            _unit_size = ts::PKT_SIZE;
+            _args.app_name = u"tsbench";
+            _args.input.set(u"tsbench_input", {ts::UString::Decimal(TSP_PACKETS, 0, true, ts::UString())});
+            _args.output.set(u"tsbench_output");
+            _args.plugins.resize(proc_count);
+            for (size_t i = 0; i < proc_count; ++i) {
+                _args.plugins[i].set(u"tsbench_null");
+            }
+        }
+
+        virtual uint64_t run() override
+        {
+            _bench_output_count = 0;
+            ts::TSProcessor tsproc(NULLREP);
+            if (tsproc.start(_args)) {
+                tsproc.waitForTermination();
+            }
+            _checksum = _bench_output_count;
+            return _bench_output_count;
+        }
+
+    private:
+        ts::TSProcessorArgs _args;
+    };
+
+    tsbench::Register _reg_0([]() -> tsbench::Benchmark* { return new TSProcessorBench(0); });
+    tsbench::Register _reg_1([]() -> tsbench::Benchmark* { return new TSProcessorBench(1); });
+    tsbench::Register _reg_5([]() -> tsbench::Benchmark* { return new TSProcessorBench(5); });
+    tsbench::Register _reg_10([]() -> tsbench::Benchmark* { return new TSProcessorBench(10); });
+}
@@ -0,0 +1,95 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Benchmarks for class ts::UString.
+//
+//----------------------------------------------------------------------------
+
+#include "tsbench.h"
+TSDUCK_SOURCE;
+
+#define FORMAT_CALLS  100000  // Number of formatting calls per iteration.
+
+
+//----------------------------------------------------------------------------
+// UString::Format with typical log message profiles.
+//----------------------------------------------------------------------------
+
+namespace {
+    class FormatBench: public tsbench::Benchmark
+    {
+        TS_NOBUILD_NOCOPY(FormatBench);
+    public:
+        FormatBench(bool mixed) :
+            Benchmark(mixed ? u"ustring.format.mixed" : u"ustring.format.int",
+                      u"call",
+                      mixed ? u"UString::Format with strings, hexadecimal and grouped integers" : u"UString::Format with decimal integers only"),
+            _mixed(mixed),
+            _values(),
+            _names()
+        {
+        }
+
+        virtual bool setup(uint32_t seed) override
+        {
+            tsbench::Random rnd(seed);
+            _values.resize(256);
+            _names.resize(16);
+            for (auto& v : _values) {
+                v = rnd.next();
+            }
+            for (auto& n : _names) {
+                n = ts::UString::Format(u"Service %d", {rnd.next() % 1000});
+            }
+            return true;
+        }
+
+        virtual uint64_t run() override
+        {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < FORMAT_CALLS; ++i) {
+                const uint32_t v = _values[i % _values.size()];
+                const ts::UString s(_mixed ?
+                    ts::UString::Format(u"PID 0x%X (%d), service \"%s\", %'d packets", {uint16_t(v & 0x1FFF), uint16_t(v & 0x1FFF), _names[i % _names.size()], v}) :
+                    ts::UString::Format(u"%d %d %d", {i, v, v >> 8}));
+                sum += s.size();
+            }
+            _checksum = sum;
+            return FORMAT_CALLS;
+        }
+
+    private:
+        bool                  _mixed;
+        std::vector<uint32_t> _values;
+        ts::UStringVector     _names;
+    };
+
+    tsbench::Register _reg_int([]() -> tsbench::Benchmark* { return new FormatBench(false); });
+    tsbench::Register _reg_mixed([]() -> tsbench::Benchmark* { return new FormatBench(true); });
+}
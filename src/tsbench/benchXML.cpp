@@ -0,0 +1,97 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Benchmarks for XML tables parsing and generation.
+//
+//----------------------------------------------------------------------------
+
+#include "tsbench.h"
+#include "tsSectionFile.h"
+#include "tsNullReport.h"
+TSDUCK_SOURCE;
+
+#define PSI_SERVICES  50  // Number of services in the synthetic PSI/SI tables.
+
+
+//----------------------------------------------------------------------------
+// Parse or generate the XML representation of PSI/SI tables.
+//----------------------------------------------------------------------------
+
+namespace {
+    class XMLTablesBench: public tsbench::Benchmark
+    {
+        TS_NOBUILD_NOCOPY(XMLTablesBench);
+    public:
+        XMLTablesBench(bool parse) :
+            Benchmark(parse ? u"xml.tables.parse" : u"xml.tables.generate",
+                      u"document",
+                      ts::UString::Format(u"SectionFile, %s XML with %d services PSI/SI tables", {parse ? u"parse" : u"generate", PSI_SERVICES})),
+            _parse(parse),
+            _duck(),
+            _file(_duck),
+            _xml()
+        {
+        }
+
+        virtual bool setup(uint32_t seed) override
+        {
+            _xml = tsbench::BuildPSIXML(_duck, PSI_SERVICES, seed);
+            _unit_size = _xml.toUTF8().size();
+            _file.clear();
+            return _parse || _file.parseXML(_xml, NULLREP);
+        }
+
+        virtual uint64_t run() override
+        {
+            if (_parse) {
+                _file.clear();
+                _checksum = _file.parseXML(_xml, NULLREP) ? _file.sections().size() : 0;
+            }
+            else {
+                _checksum = _file.toXML(NULLREP).size();
+            }
+            return 1;
+        }
+
+        virtual void teardown() override
+        {
+            _file.clear();
+            _xml.clear();
+        }
+
+    private:
+        bool            _parse;
+        ts::DuckContext _duck;
+        ts::SectionFile _file;
+        ts::UString     _xml;
+    };
+
+    tsbench::Register _reg_parse([]() -> tsbench::Benchmark* { return new XMLTablesBench(true); });
+    tsbench::Register _reg_generate([]() -> tsbench::Benchmark* { return new XMLTablesBench(false); });
+}
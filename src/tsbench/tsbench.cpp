@@ -0,0 +1,413 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Benchmark driver program.
+//
+//  Description:
+//    Run all registered benchmarks (or a subset of them) and report the
+//    results as text or JSON. A previous JSON report can be used as a
+//    baseline to detect performance regressions between two releases.
+//
+//  Maintenance note:
+//    There is no need to modify this code when a new benchmark is added
+//    (a new source file in the same directory). Each benchmark is
+//    automatically registered using the class tsbench::Register.
+//
+//----------------------------------------------------------------------------
+
+#include "tsbench.h"
+#include "tsMain.h"
+#include "tsArgs.h"
+#include "tsMonotonic.h"
+#include "tsSysInfo.h"
+#include "tsVersionInfo.h"
+#include "tsjsonObject.h"
+#include "tsjsonArray.h"
+#include "tsjsonNumber.h"
+#include "tsjsonString.h"
+TSDUCK_SOURCE;
+TS_MAIN(MainCode);
+
+#define DEFAULT_SEED      20200101  // Fixed default seed for reproducible data sets.
+#define DEFAULT_MIN_TIME  1000      // Default minimum measurement time per benchmark, in milliseconds.
+#define MIN_ITERATIONS    3         // Minimum number of timed iterations in automatic mode.
+
+
+//----------------------------------------------------------------------------
+// Benchmark base class and registration.
+//----------------------------------------------------------------------------
+
+tsbench::Benchmark::Benchmark(const ts::UString& name, const ts::UString& unit, const ts::UString& description) :
+    _unit_size(0),
+    _checksum(0),
+    _name(name),
+    _unit(unit),
+    _description(description)
+{
+}
+
+tsbench::Benchmark::~Benchmark()
+{
+}
+
+bool tsbench::Benchmark::setup(uint32_t)
+{
+    return true;
+}
+
+void tsbench::Benchmark::teardown()
+{
+}
+
+namespace {
+    // Registered factories. Use a function-local static to avoid initialization order issues.
+    std::list<tsbench::Factory>& Repository()
+    {
+        static std::list<tsbench::Factory> repo;
+        return repo;
+    }
+}
+
+tsbench::Register::Register(Factory factory)
+{
+    Repository().push_back(factory);
+}
+
+const std::list<tsbench::Factory>& tsbench::Factories()
+{
+    return Repository();
+}
+
+
+//----------------------------------------------------------------------------
+// Command line options
+//----------------------------------------------------------------------------
+
+namespace {
+    class Options: public ts::Args
+    {
+        TS_NOBUILD_NOCOPY(Options);
+    public:
+        Options(int argc, char *argv[]);
+        virtual ~Options() = default;
+
+        ts::UStringVector names;       // Benchmark name patterns.
+        bool              list;        // List benchmarks only.
+        bool              json;        // JSON output.
+        ts::UString       output;      // Output file name.
+        ts::UString       baseline;    // Baseline JSON file.
+        size_t            tolerance;   // Max regression in percent.
+        size_t            iterations;  // Fixed number of iterations, zero means automatic.
+        ts::MilliSecond   min_time;    // Minimum measurement time in automatic mode.
+        uint32_t          seed;        // Seed of synthetic data.
+    };
+}
+
+Options::Options(int argc, char *argv[]) :
+    Args(u"Run TSDuck performance benchmarks", u"[options] [name ...]"),
+    names(),
+    list(false),
+    json(false),
+    output(),
+    baseline(),
+    tolerance(0),
+    iterations(0),
+    min_time(0),
+    seed(0)
+{
+    option(u"", 0, STRING);
+    help(u"", u"pattern",
+         u"Names of the benchmarks to run. A benchmark is selected when its name "
+         u"starts with one of the specified names, case-insensitive. For instance, "
+         u"'crc32' selects all variants of the CRC32 benchmark. By default, all "
+         u"benchmarks are run.");
+
+    option(u"baseline", 'b', STRING);
+    help(u"baseline", u"filename",
+         u"A JSON file from a previous execution with --json. For each benchmark, "
+         u"the difference of throughput with the baseline is displayed. See also "
+         u"option --tolerance.");
+
+    option(u"iterations", 'i', POSITIVE);
+    help(u"iterations",
+         u"Run each benchmark exactly the specified number of timed iterations. "
+         u"By default, each benchmark is repeated until the minimum time is reached "
+         u"(see --min-time), with at least " TS_USTRINGIFY(MIN_ITERATIONS) u" iterations.");
+
+    option(u"json", 'j');
+    help(u"json", u"Report the results in JSON format.");
+
+    option(u"list", 'l');
+    help(u"list", u"List the available benchmarks and exit.");
+
+    option(u"min-time", 'm', POSITIVE);
+    help(u"min-time", u"milliseconds",
+         u"Minimum measurement time per benchmark in automatic mode. "
+         u"The default is " TS_USTRINGIFY(DEFAULT_MIN_TIME) u" milliseconds.");
+
+    option(u"output-file", 'o', STRING);
+    help(u"output-file", u"filename", u"Write the report in the specified file. By default, use the standard output.");
+
+    option(u"seed", 's', UINT32);
+    help(u"seed",
+         u"Seed of the pseudo-random generator which builds the synthetic input data. "
+         u"Use the same seed to compare results. The default is " TS_USTRINGIFY(DEFAULT_SEED) u".");
+
+    option(u"tolerance", 't', INTEGER, 0, 1, 0, 100);
+    help(u"tolerance", u"percent",
+         u"With --baseline, exit with an error status when the throughput of a "
+         u"benchmark is more than the specified percentage lower than in the baseline. "
+         u"By default, the differences are only reported.");
+
+    analyze(argc, argv);
+
+    getValues(names, u"");
+    list = present(u"list");
+    json = present(u"json");
+    getValue(output, u"output-file");
+    getValue(baseline, u"baseline");
+    tolerance = intValue<size_t>(u"tolerance", 0);
+    iterations = intValue<size_t>(u"iterations", 0);
+    min_time = intValue<ts::MilliSecond>(u"min-time", DEFAULT_MIN_TIME);
+    seed = intValue<uint32_t>(u"seed", DEFAULT_SEED);
+
+    exitOnError();
+}
+
+
+//----------------------------------------------------------------------------
+// Result of one benchmark.
+//----------------------------------------------------------------------------
+
+namespace {
+    struct Result
+    {
+        ts::UString name;
+        ts::UString unit;
+        size_t      unit_size;
+        size_t      iterations;
+        uint64_t    units;         // Units per iteration.
+        ts::NanoSecond min_ns;     // Fastest iteration.
+        ts::NanoSecond median_ns;  // Median iteration.
+        ts::NanoSecond mean_ns;    // Average iteration.
+        uint64_t    checksum;
+
+        Result() : name(), unit(), unit_size(0), iterations(0), units(0), min_ns(0), median_ns(0), mean_ns(0), checksum(0) {}
+
+        // Throughput in units per second, based on the median iteration (less sensitive to noise).
+        uint64_t unitsPerSecond() const
+        {
+            return median_ns <= 0 ? 0 : uint64_t((double(units) * double(ts::NanoSecPerSec)) / double(median_ns));
+        }
+    };
+
+    // Run one benchmark.
+    bool RunBenchmark(const Options& opt, tsbench::Benchmark& bench, Result& res)
+    {
+        res.name = bench.name();
+        res.unit = bench.unit();
+
+        if (!bench.setup(opt.seed)) {
+            return false;
+        }
+
+        // One warmup iteration, not timed, to populate caches and lazy initializations.
+        res.units = bench.run();
+
+        std::vector<ts::NanoSecond> times;
+        ts::NanoSecond total = 0;
+        while ((opt.iterations > 0 && times.size() < opt.iterations) ||
+               (opt.iterations == 0 && (times.size() < MIN_ITERATIONS || total < opt.min_time * ts::NanoSecPerMilliSec)))
+        {
+            const ts::Monotonic start(true);
+            res.units = bench.run();
+            const ts::NanoSecond duration = ts::Monotonic(true) - start;
+            times.push_back(duration);
+            total += duration;
+        }
+
+        bench.teardown();
+
+        std::sort(times.begin(), times.end());
+        res.unit_size = bench.unitSize();
+        res.iterations = times.size();
+        res.min_ns = times.front();
+        res.median_ns = times[times.size() / 2];
+        res.mean_ns = total / ts::NanoSecond(times.size());
+        res.checksum = bench.checksum();
+        return true;
+    }
+
+    // Load baseline throughputs, indexed by benchmark name.
+    bool LoadBaseline(const ts::UString& file_name, std::map<ts::UString, uint64_t>& base, ts::Report& report)
+    {
+        ts::UStringList lines;
+        ts::json::ValuePtr root;
+        if (!ts::UString::Load(lines, file_name)) {
+            report.error(u"error reading %s", {file_name});
+            return false;
+        }
+        if (!ts::json::Parse(root, lines, report) || !root->isObject()) {
+            report.error(u"invalid JSON baseline file %s", {file_name});
+            return false;
+        }
+        const ts::json::Value& list(root->value(u"benchmarks"));
+        for (size_t i = 0; i < list.size(); ++i) {
+            const ts::json::Value& item(list.at(i));
+            base[item.value(u"name").toString()] = uint64_t(item.value(u"units_per_second").toInteger());
+        }
+        return true;
+    }
+
+    // Percentage of difference with baseline, positive when faster.
+    int64_t Delta(uint64_t current, uint64_t baseline)
+    {
+        return baseline == 0 ? 0 : ((int64_t(current) - int64_t(baseline)) * 100) / int64_t(baseline);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Program entry point
+//----------------------------------------------------------------------------
+
+int MainCode(int argc, char *argv[])
+{
+    Options opt(argc, argv);
+
+    // Build the list of selected benchmarks.
+    std::list<tsbench::Benchmark*> benchs;
+    for (auto factory : tsbench::Factories()) {
+        tsbench::Benchmark* b = factory();
+        bool selected = opt.names.empty();
+        for (size_t i = 0; !selected && i < opt.names.size(); ++i) {
+            selected = b->name().startWith(opt.names[i], ts::CASE_INSENSITIVE);
+        }
+        if (selected) {
+            benchs.push_back(b);
+        }
+        else {
+            delete b;
+        }
+    }
+
+    // Open output file.
+    std::ofstream file;
+    if (!opt.output.empty()) {
+        file.open(opt.output.toUTF8().c_str());
+        if (!file) {
+            opt.error(u"cannot create %s", {opt.output});
+            return EXIT_FAILURE;
+        }
+    }
+    std::ostream& out(opt.output.empty() ? std::cout : file);
+
+    if (opt.list) {
+        for (auto b : benchs) {
+            out << ts::UString::Format(u"%-28s %s", {b->name(), b->description()}) << std::endl;
+            delete b;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    std::map<ts::UString, uint64_t> base;
+    if (!opt.baseline.empty() && !LoadBaseline(opt.baseline, base, opt)) {
+        return EXIT_FAILURE;
+    }
+
+    // Run all benchmarks.
+    std::list<Result> results;
+    bool regression = false;
+    for (auto b : benchs) {
+        Result res;
+        opt.verbose(u"running %s", {b->name()});
+        if (!RunBenchmark(opt, *b, res)) {
+            opt.warning(u"benchmark %s skipped, not supported on this system", {b->name()});
+        }
+        else {
+            const auto it = base.find(res.name);
+            const int64_t delta = it == base.end() ? 0 : Delta(res.unitsPerSecond(), it->second);
+            if (it != base.end() && opt.tolerance > 0 && delta < -int64_t(opt.tolerance)) {
+                regression = true;
+                opt.error(u"%s: throughput regression %d%% from baseline", {res.name, delta});
+            }
+            if (!opt.json) {
+                ts::UString line(ts::UString::Format(u"%-28s %16'd %s/s  %12'd ns/iter  %6'd iter", {res.name, res.unitsPerSecond(), res.unit, res.median_ns, res.iterations}));
+                if (res.unit_size > 0) {
+                    line += ts::UString::Format(u"  %8'd MB/s", {(res.unitsPerSecond() * res.unit_size) / 1000000});
+                }
+                if (it != base.end()) {
+                    line += ts::UString::Format(u"  %+d%%", {delta});
+                }
+                out << line << std::endl;
+            }
+            results.push_back(res);
+        }
+        delete b;
+    }
+
+    // JSON report.
+    if (opt.json) {
+        const ts::SysInfo& sys(*ts::SysInfo::Instance());
+        ts::json::Object root;
+        ts::json::Object* info = new ts::json::Object;
+        info->add(u"version", ts::json::ValuePtr(new ts::json::String(ts::GetVersion(ts::VERSION_SHORT))));
+        info->add(u"system", ts::json::ValuePtr(new ts::json::String(sys.systemName())));
+        info->add(u"host", ts::json::ValuePtr(new ts::json::String(sys.hostName())));
+        info->add(u"date", ts::json::ValuePtr(new ts::json::String(ts::Time::CurrentUTC().format(ts::Time::DATETIME))));
+        info->add(u"seed", ts::json::ValuePtr(new ts::json::Number(opt.seed)));
+        info->add(u"iterations", ts::json::ValuePtr(new ts::json::Number(int64_t(opt.iterations))));
+        info->add(u"min_time_ms", ts::json::ValuePtr(new ts::json::Number(opt.min_time)));
+        root.add(u"tsbench", ts::json::ValuePtr(info));
+
+        ts::json::Array* list = new ts::json::Array;
+        for (const auto& res : results) {
+            ts::json::Object* item = new ts::json::Object;
+            item->add(u"name", ts::json::ValuePtr(new ts::json::String(res.name)));
+            item->add(u"unit", ts::json::ValuePtr(new ts::json::String(res.unit)));
+            item->add(u"unit_size", ts::json::ValuePtr(new ts::json::Number(int64_t(res.unit_size))));
+            item->add(u"iterations", ts::json::ValuePtr(new ts::json::Number(int64_t(res.iterations))));
+            item->add(u"units_per_iteration", ts::json::ValuePtr(new ts::json::Number(int64_t(res.units))));
+            item->add(u"min_ns", ts::json::ValuePtr(new ts::json::Number(res.min_ns)));
+            item->add(u"median_ns", ts::json::ValuePtr(new ts::json::Number(res.median_ns)));
+            item->add(u"mean_ns", ts::json::ValuePtr(new ts::json::Number(res.mean_ns)));
+            item->add(u"units_per_second", ts::json::ValuePtr(new ts::json::Number(int64_t(res.unitsPerSecond()))));
+            item->add(u"checksum", ts::json::ValuePtr(new ts::json::String(ts::UString::Hexa(res.checksum))));
+            const auto it = base.find(res.name);
+            if (it != base.end()) {
+                item->add(u"baseline_delta_percent", ts::json::ValuePtr(new ts::json::Number(Delta(res.unitsPerSecond(), it->second))));
+            }
+            list->set(ts::json::ValuePtr(item));
+        }
+        root.add(u"benchmarks", ts::json::ValuePtr(list));
+        out << root.printed(2, opt) << std::endl;
+    }
+
+    return regression ? EXIT_FAILURE : EXIT_SUCCESS;
+}
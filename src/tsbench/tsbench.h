@@ -0,0 +1,224 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//! @file
+//! TSBench interface (a simple C++ benchmark framework).
+//!
+//! Each benchmark is a subclass of tsbench::Benchmark which is statically
+//! registered using tsbench::Register. All input data are synthetic and
+//! generated from a fixed seed so that results can be compared between
+//! builds and releases of TSDuck.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsUString.h"
+#include "tsTSPacket.h"
+#include "tsDuckContext.h"
+#include "tsTablesPtr.h"
+
+namespace tsbench {
+
+    //!
+    //! Base class of all benchmarks.
+    //!
+    //! A benchmark runs a fixed workload per iteration. The driver calls setup() once,
+    //! then run() repeatedly, measuring each call, and finally teardown(). Only the
+    //! calls to run() are timed.
+    //!
+    class Benchmark
+    {
+        TS_NOBUILD_NOCOPY(Benchmark);
+    public:
+        //!
+        //! Constructor.
+        //! @param [in] name Benchmark name, unique, in "family.variant" form.
+        //! @param [in] unit Name of the unit of work (e.g. "packet", "byte", "call").
+        //! @param [in] description One-line description.
+        //!
+        Benchmark(const ts::UString& name, const ts::UString& unit, const ts::UString& description);
+
+        //!
+        //! Virtual destructor.
+        //!
+        virtual ~Benchmark();
+
+        //!
+        //! Prepare the workload, not timed.
+        //! @param [in] seed Seed of the pseudo-random generator for synthetic data.
+        //! @return True on success, false if the benchmark cannot run on this system.
+        //!
+        virtual bool setup(uint32_t seed);
+
+        //!
+        //! Run one iteration of the workload, timed.
+        //! @return Number of units of work which were processed.
+        //!
+        virtual uint64_t run() = 0;
+
+        //!
+        //! Cleanup after the last iteration, not timed.
+        //!
+        virtual void teardown();
+
+        //!
+        //! Get the benchmark name.
+        //! @return The benchmark name.
+        //!
+        const ts::UString& name() const { return _name; }
+
+        //!
+        //! Get the unit of work.
+        //! @return The name of the unit of work.
+        //!
+        const ts::UString& unit() const { return _unit; }
+
+        //!
+        //! Get the description.
+        //! @return The description of the benchmark.
+        //!
+        const ts::UString& description() const { return _description; }
+
+        //!
+        //! Get the number of bytes per unit of work.
+        //! @return The number of bytes per unit or zero if not meaningful.
+        //!
+        size_t unitSize() const { return _unit_size; }
+
+        //!
+        //! Get a checksum of the last processed data.
+        //! Used to prevent the compiler from optimizing the work away and to check reproducibility.
+        //! @return A benchmark-specific checksum.
+        //!
+        uint64_t checksum() const { return _checksum; }
+
+    protected:
+        size_t   _unit_size;  //!< Size in bytes of one unit of work, zero if not meaningful.
+        uint64_t _checksum;   //!< Benchmark-specific checksum of the last iteration.
+
+    private:
+        ts::UString _name;
+        ts::UString _unit;
+        ts::UString _description;
+    };
+
+    //!
+    //! Function profile which creates a benchmark.
+    //!
+    typedef Benchmark* (*Factory)();
+
+    //!
+    //! Static registration of a benchmark.
+    //! Use a static instance of this class in each benchmark source file.
+    //!
+    class Register
+    {
+        TS_NOBUILD_NOCOPY(Register);
+    public:
+        //!
+        //! Constructor.
+        //! @param [in] factory Function which creates the benchmark.
+        //!
+        Register(Factory factory);
+    };
+
+    //!
+    //! Get all registered benchmarks factories, in registration order.
+    //! @return A constant reference to the list of factories.
+    //!
+    const std::list<Factory>& Factories();
+
+    //!
+    //! Simple and portable pseudo-random generator (xorshift32).
+    //! The standard random generators are not guaranteed to produce the
+    //! same sequence on all platforms. This one is.
+    //!
+    class Random
+    {
+    public:
+        //!
+        //! Constructor.
+        //! @param [in] seed Initial seed, zero is replaced by a non-zero constant.
+        //!
+        explicit Random(uint32_t seed) : _state(seed == 0 ? 0x12345678 : seed) {}
+
+        //!
+        //! Get next pseudo-random 32-bit value.
+        //! @return A pseudo-random value.
+        //!
+        uint32_t next()
+        {
+            _state ^= _state << 13;
+            _state ^= _state >> 17;
+            _state ^= _state << 5;
+            return _state;
+        }
+
+        //!
+        //! Fill a memory area with pseudo-random bytes.
+        //! @param [out] data Address of area to fill.
+        //! @param [in] size Size in bytes of the area.
+        //!
+        void fill(void* data, size_t size);
+
+    private:
+        uint32_t _state;
+    };
+
+    //!
+    //! Build the PSI/SI tables of a synthetic network.
+    //! The tables are a PAT, one PMT per service with four components, an SDT and a NIT.
+    //! @param [in,out] duck TSDuck execution context.
+    //! @param [out] tables Generated tables.
+    //! @param [in] service_count Number of services.
+    //! @param [in] seed Seed of the pseudo-random generator.
+    //!
+    void BuildPSITables(ts::DuckContext& duck, ts::AbstractTablePtrVector& tables, size_t service_count, uint32_t seed);
+
+    //!
+    //! Build a synthetic PSI/SI-heavy transport stream.
+    //! The stream contains the tables from BuildPSITables(), each on its own PID,
+    //! randomly interleaved with null packets. Two packets out of three are PSI/SI.
+    //! @param [in,out] duck TSDuck execution context.
+    //! @param [out] packets Generated packets.
+    //! @param [in] service_count Number of services.
+    //! @param [in] packet_count Number of packets to generate.
+    //! @param [in] seed Seed of the pseudo-random generator.
+    //!
+    void BuildPSIStream(ts::DuckContext& duck, ts::TSPacketVector& packets, size_t service_count, size_t packet_count, uint32_t seed);
+
+    //!
+    //! Build the XML representation of the PSI/SI tables of a synthetic stream.
+    //! @param [in,out] duck TSDuck execution context.
+    //! @param [in] service_count Number of services.
+    //! @param [in] seed Seed of the pseudo-random generator.
+    //! @return The XML text.
+    //!
+    ts::UString BuildPSIXML(ts::DuckContext& duck, size_t service_count, uint32_t seed);
+}
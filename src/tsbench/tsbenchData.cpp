@@ -0,0 +1,197 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Synthetic data sets for benchmarks.
+//
+//----------------------------------------------------------------------------
+
+#include "tsbench.h"
+#include "tsCyclingPacketizer.h"
+#include "tsSectionFile.h"
+#include "tsBinaryTable.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+#include "tsSDT.h"
+#include "tsNIT.h"
+#include "tsNetworkNameDescriptor.h"
+#include "tsServiceListDescriptor.h"
+#include "tsStreamIdentifierDescriptor.h"
+TSDUCK_SOURCE;
+
+// Identifiers of the synthetic network.
+#define BENCH_TS_ID       0x0001
+#define BENCH_NETWORK_ID  0x2000
+#define BENCH_PMT_PID     0x0100  // First PMT PID, one per service.
+#define BENCH_ES_PID      0x1000  // First elementary stream PID, four per service.
+
+
+//----------------------------------------------------------------------------
+// Fill a memory area with pseudo-random bytes.
+//----------------------------------------------------------------------------
+
+void tsbench::Random::fill(void* data, size_t size)
+{
+    uint8_t* p = reinterpret_cast<uint8_t*>(data);
+    for (; size >= 4; size -= 4, p += 4) {
+        const uint32_t r = next();
+        ::memcpy(p, &r, 4);
+    }
+    if (size > 0) {
+        const uint32_t r = next();
+        ::memcpy(p, &r, size);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Build the PSI/SI tables of a synthetic network.
+//----------------------------------------------------------------------------
+
+void tsbench::BuildPSITables(ts::DuckContext& duck, ts::AbstractTablePtrVector& tables, size_t service_count, uint32_t seed)
+{
+    tsbench::Random rnd(seed);
+
+    ts::PAT* pat = new ts::PAT(0, true, BENCH_TS_ID);
+    ts::SDT* sdt = new ts::SDT(true, 0, true, BENCH_TS_ID, BENCH_NETWORK_ID);
+    ts::NIT* nit = new ts::NIT(true, 0, true, BENCH_NETWORK_ID);
+    ts::ServiceListDescriptor sld;
+
+    tables.clear();
+    tables.push_back(ts::AbstractTablePtr(pat));
+
+    for (size_t i = 0; i < service_count; ++i) {
+        const uint16_t srv_id = uint16_t(0x0100 + i);
+        const ts::PID pmt_pid = ts::PID(BENCH_PMT_PID + i);
+        const ts::PID es_pid = ts::PID(BENCH_ES_PID + 4 * i);
+
+        pat->pmts[srv_id] = pmt_pid;
+
+        // PMT with one video, two audio and one subtitle stream.
+        ts::PMT* pmt = new ts::PMT(uint8_t(rnd.next() % 32), true, srv_id, es_pid);
+        pmt->streams[es_pid].stream_type = ts::ST_AVC_VIDEO;
+        pmt->streams[es_pid + 1].stream_type = ts::ST_MPEG2_AUDIO;
+        pmt->streams[es_pid + 2].stream_type = ts::ST_PES_PRIV;
+        pmt->streams[es_pid + 3].stream_type = ts::ST_PES_PRIV;
+        for (uint8_t tag = 0; tag < 4; ++tag) {
+            pmt->streams[ts::PID(es_pid + tag)].descs.add(duck, ts::StreamIdentifierDescriptor(tag));
+        }
+        tables.push_back(ts::AbstractTablePtr(pmt));
+
+        sdt->services[srv_id].setName(duck, ts::UString::Format(u"Benchmark Service %d", {i}));
+        sdt->services[srv_id].running_status = 4;
+        sdt->services[srv_id].EITpf_present = (rnd.next() & 1) != 0;
+
+        sld.entries.push_back(ts::ServiceListDescriptor::Entry(srv_id, 0x01));
+    }
+
+    // One NIT entry per transport stream, the synthetic one and a few fake neighbours.
+    nit->descs.add(duck, ts::NetworkNameDescriptor(u"TSDuck Benchmark Network"));
+    for (uint16_t ts_id = BENCH_TS_ID; ts_id < BENCH_TS_ID + 8; ++ts_id) {
+        ts::DescriptorList& dlist(nit->transports[ts::TransportStreamId(ts_id, BENCH_NETWORK_ID)].descs);
+        for (size_t first = 0; first < service_count; first += ts::ServiceListDescriptor::MAX_ENTRIES) {
+            ts::ServiceListDescriptor part;
+            auto it = sld.entries.begin();
+            std::advance(it, first);
+            for (size_t n = 0; n < ts::ServiceListDescriptor::MAX_ENTRIES && it != sld.entries.end(); ++n, ++it) {
+                part.entries.push_back(*it);
+            }
+            dlist.add(duck, part);
+        }
+    }
+
+    tables.push_back(ts::AbstractTablePtr(sdt));
+    tables.push_back(ts::AbstractTablePtr(nit));
+}
+
+
+//----------------------------------------------------------------------------
+// Build a synthetic PSI/SI-heavy transport stream.
+//----------------------------------------------------------------------------
+
+void tsbench::BuildPSIStream(ts::DuckContext& duck, ts::TSPacketVector& packets, size_t service_count, size_t packet_count, uint32_t seed)
+{
+    ts::AbstractTablePtrVector tables;
+    BuildPSITables(duck, tables, service_count, seed);
+
+    // One packetizer per PID. The PAT, SDT and NIT are on their standard PID's.
+    std::map<ts::PID, ts::CyclingPacketizer*> pzers;
+    for (size_t i = 0; i < tables.size(); ++i) {
+        ts::PID pid = ts::PID_NULL;
+        switch (tables[i]->tableId()) {
+            case ts::TID_PAT: pid = ts::PID_PAT; break;
+            case ts::TID_SDT_ACT: pid = ts::PID_SDT; break;
+            case ts::TID_NIT_ACT: pid = ts::PID_NIT; break;
+            default: pid = ts::PID(BENCH_PMT_PID + i - 1); break;
+        }
+        ts::CyclingPacketizer*& pz(pzers[pid]);
+        if (pz == nullptr) {
+            pz = new ts::CyclingPacketizer(pid, ts::CyclingPacketizer::NEVER);
+        }
+        pz->addTable(duck, *tables[i]);
+    }
+
+    std::vector<ts::CyclingPacketizer*> all;
+    for (const auto& it : pzers) {
+        all.push_back(it.second);
+    }
+
+    // Two packets out of three are PSI/SI, the others are null packets.
+    tsbench::Random rnd(seed);
+    packets.resize(packet_count);
+    for (size_t i = 0; i < packet_count; ++i) {
+        const uint32_t r = rnd.next();
+        if (r % 3 == 0) {
+            packets[i] = ts::NullPacket;
+        }
+        else {
+            all[(r / 3) % all.size()]->getNextPacket(packets[i]);
+        }
+    }
+
+    for (auto pz : all) {
+        delete pz;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Build the XML representation of the PSI/SI tables.
+//----------------------------------------------------------------------------
+
+ts::UString tsbench::BuildPSIXML(ts::DuckContext& duck, size_t service_count, uint32_t seed)
+{
+    ts::AbstractTablePtrVector tables;
+    BuildPSITables(duck, tables, service_count, seed);
+
+    ts::SectionFile file(duck);
+    for (const auto& t : tables) {
+        file.add(t);
+    }
+    return file.toXML();
+}
@@ -92,7 +92,7 @@ namespace ts {
         void computeBitrate();
 
         // Check time and compute bitrate when necessary.
-        void checkTime();
+        void checkTime(time_t now);
     };
 }
 
@@ -364,10 +364,8 @@ void ts::BitrateMonitorPlugin::computeBitrate()
 // Check time and compute bitrate when necessary.
 //----------------------------------------------------------------------------
 
-void ts::BitrateMonitorPlugin::checkTime()
+void ts::BitrateMonitorPlugin::checkTime(time_t now)
 {
-    const time_t now = ::time(nullptr);
-
     // NOTE : the computation method used here is meaningful only if at least
     // one packet is received per second (whatever its PID).
 
@@ -401,7 +399,7 @@ void ts::BitrateMonitorPlugin::checkTime()
 bool ts::BitrateMonitorPlugin::handlePacketTimeout()
 {
     // Check time and bitrates.
-    checkTime();
+    checkTime(::time(nullptr));
 
     // Always continue waiting, never abort.
     return true;
@@ -414,8 +412,9 @@ bool ts::BitrateMonitorPlugin::handlePacketTimeout()
 
 ts::ProcessorPlugin::Status ts::BitrateMonitorPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
 {
-    // Check time and bitrates.
-    checkTime();
+    // Check time and bitrates. Use the input time stamp of the packet when available,
+    // it is the reception time of the packet, not the time it reaches this plugin.
+    checkTime(pkt_data.hasInputTimeStamp() ? time_t(pkt_data.getInputTimeStamp() / SYSTEM_CLOCK_FREQ) : ::time(nullptr));
 
     // If packet's PID matches, increment the number of packets received during the current second.
     if (_full_ts || pkt.getPID() == _pid) {
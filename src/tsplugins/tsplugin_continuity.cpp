@@ -52,6 +52,7 @@ namespace ts {
         virtual bool getOptions() override;
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual size_t processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*) override;
 
     private:
         UString            _tag;          // Message tag
@@ -145,3 +146,12 @@ ts::ProcessorPlugin::Status ts::ContinuityPlugin::processPacket(TSPacket& pkt, T
     _cc_analyzer.feedPacket(pkt);
     return TSP_OK;
 }
+
+size_t ts::ContinuityPlugin::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    for (size_t i = 0; i < count; ++i) {
+        _cc_analyzer.feedPacket(pkt[i]);
+        status[i] = TSP_OK;
+    }
+    return count;
+}
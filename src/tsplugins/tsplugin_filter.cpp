@@ -53,6 +53,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual size_t processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*) override;
 
     private:
         // Packet intervals and list of them.
@@ -93,6 +94,9 @@ namespace ts {
         TSPacketMetadata::LabelSet _reset_labels;      // Labels to reset on filtered packets
         TSPacketMetadata::LabelSet _set_perm_labels;   // Labels to set on all packets after getting one packet
         TSPacketMetadata::LabelSet _reset_perm_labels; // Labels to reset on all packets after getting one packet
+
+        // Filter one packet with a given packet index in the plugin.
+        Status filterPacket(TSPacket& pkt, TSPacketMetadata& pkt_data, PacketCounter index);
     };
 }
 
@@ -421,9 +425,28 @@ bool ts::FilterPlugin::stop()
 //----------------------------------------------------------------------------
 
 ts::ProcessorPlugin::Status ts::FilterPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
+{
+    return filterPacket(pkt, pkt_data, tsp->pluginPackets());
+}
+
+size_t ts::FilterPlugin::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    const PacketCounter first = tsp->pluginPackets();
+    size_t i = 0;
+
+    // Pass initial packets without filtering.
+    for (; i < count && first + i < _after_packets; ++i) {
+        status[i] = TSP_OK;
+    }
+    for (; i < count; ++i) {
+        status[i] = filterPacket(pkt[i], pkt_data[i], first + i);
+    }
+    return count;
+}
+
+ts::ProcessorPlugin::Status ts::FilterPlugin::filterPacket(TSPacket& pkt, TSPacketMetadata& pkt_data, PacketCounter packetIndex)
 {
     // Pass initial packets without filtering.
-    const PacketCounter packetIndex = tsp->pluginPackets();
     if (packetIndex < _after_packets) {
         return TSP_OK;
     }
@@ -447,7 +470,7 @@ ts::ProcessorPlugin::Status ts::FilterPlugin::processPacket(TSPacket& pkt, TSPac
         (_min_af >= 0 && int(pkt.getAFSize()) >= _min_af) ||
         (int(pkt.getAFSize()) <= _max_af) ||
         pkt_data.hasAnyLabel(_labels) ||
-        (_every_packets > 0 && (tsp->pluginPackets() - _after_packets) % _every_packets == 0) ||
+        (_every_packets > 0 && (packetIndex - _after_packets) % _every_packets == 0) ||
         (_with_pes && pkt.startPES());
 
     // Search binary patterns in packets.
@@ -36,6 +36,7 @@
 #include "tsPluginRepository.h"
 #include "tsService.h"
 #include "tsPAT.h"
+#include "tsPSIEditors.h"
 TSDUCK_SOURCE;
 
 
@@ -63,6 +64,9 @@ namespace ts {
         // Implementation of AbstractTablePlugin.
         virtual void createNewTable(BinaryTable& table) override;
         virtual void modifyTable(BinaryTable& table, bool& is_target, bool& reinsert) override;
+
+        // Try to apply the modifications directly in the sections of the PAT.
+        bool modifyInPlace(BinaryTable& table);
     };
 }
 
@@ -171,6 +175,11 @@ void ts::PATPlugin::modifyTable(BinaryTable& table, bool& is_target, bool& reins
         return;
     }
 
+    // Most common modifications do not need a full deserialization of the PAT.
+    if (modifyInPlace(table)) {
+        return;
+    }
+
     // Process the PAT.
     PAT pat(duck, table);
     if (!pat.isValid()) {
@@ -201,3 +210,52 @@ void ts::PATPlugin::modifyTable(BinaryTable& table, bool& is_target, bool& reins
     // Reserialize modified PAT.
     pat.serialize(duck, table);
 }
+
+
+//----------------------------------------------------------------------------
+// Try to apply the modifications directly in the sections of the PAT.
+// Return false if the PAT must be deserialized (entries to add).
+//----------------------------------------------------------------------------
+
+bool ts::PATPlugin::modifyInPlace(BinaryTable& table)
+{
+    // Adding services requires a full PAT.
+    if (!_add_serv.empty()) {
+        return false;
+    }
+
+    // Check that all sections are valid and that the NIT entry exists if it must be modified.
+    bool nit_found = false;
+    for (size_t i = 0; i < table.sectionCount(); ++i) {
+        const SectionPtr& sect(table.sectionAt(i));
+        if (sect.isNull()) {
+            return false;
+        }
+        const PATView view(*sect);
+        if (!view.isValid()) {
+            return false;
+        }
+        nit_found = nit_found || view.nitPID() != PID_NULL;
+    }
+    if (_new_nit_pid != PID_NULL && !nit_found) {
+        return false;
+    }
+
+    // Patch all sections.
+    for (size_t i = 0; i < table.sectionCount(); ++i) {
+        PATEditor pat(*table.sectionAt(i));
+        if (_new_nit_pid != PID_NULL) {
+            pat.setPMTPID(0, _new_nit_pid);
+        }
+        else if (_remove_nit) {
+            pat.removeService(0);
+        }
+        for (std::vector<uint16_t>::const_iterator it = _remove_serv.begin(); it != _remove_serv.end(); ++it) {
+            pat.removeService(*it);
+        }
+    }
+    if (_set_tsid) {
+        table.setTableIdExtension(_new_tsid);
+    }
+    return true;
+}
@@ -52,15 +52,17 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual size_t processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*) override;
 
     private:
         // Description of one PID
         struct PIDContext
         {
-            PIDContext() : last_pcr_value(0), last_pcr_packet(0) {}
+            PIDContext() : last_pcr_value(0), last_pcr_packet(0), last_input_time(INVALID_PCR) {}
 
             uint64_t      last_pcr_value;   // Last PCR value in this PID
             PacketCounter last_pcr_packet;  // Packet index containing last PCR
+            uint64_t      last_input_time;  // Input time stamp of packet containing last PCR
         };
 
         // PCRVerifyPlugin private members
@@ -68,6 +70,7 @@ namespace ts {
         BitRate       _bitrate;          // Expected bitrate (0 if unknown)
         int64_t       _jitter_max;       // Max jitter in PCR units
         bool          _time_stamp;       // Display time stamps
+        bool          _input_synchronous; // Verify PCR's according to input time stamps
         PIDSet        _pid_list;         // Array of pid values to filter
         PacketCounter _packet_count;     // Global packets count
         PacketCounter _nb_pcr_ok;        // Number of PCR without jitter
@@ -75,6 +78,9 @@ namespace ts {
         PacketCounter _nb_pcr_unchecked; // Number of unchecked PCR (no previous ref)
         PIDContext    _stats[PID_MAX];   // Per-PID statistics
 
+        // Check the PCR of a packet at the current position, using the specified bitrate.
+        void checkPCR(const TSPacket& pkt, const TSPacketMetadata& pkt_data, PID pid, int64_t bitrate);
+
         // PCR units per micro-second
         static constexpr int64_t PCR_PER_MICRO_SEC = int64_t (SYSTEM_CLOCK_FREQ) / MicroSecPerSec;
         static constexpr int64_t DEFAULT_JITTER_MAX_US = 1000; // 1000 us = 1 ms
@@ -102,6 +108,7 @@ ts::PCRVerifyPlugin::PCRVerifyPlugin(TSP* tsp_) :
     _bitrate(0),
     _jitter_max(0),
     _time_stamp(false),
+    _input_synchronous(false),
     _pid_list(),
     _packet_count(0),
     _nb_pcr_ok(0),
@@ -119,6 +126,15 @@ ts::PCRVerifyPlugin::PCRVerifyPlugin(TSP* tsp_) :
          u"Verify the PCR's according to this transport bitrate. By default, "
          u"use the input bitrate as reported by the input device.");
 
+    option(u"input-synchronous", 'i');
+    help(u"input-synchronous",
+         u"Verify the PCR's according to the input time stamps of the packets, when available. "
+         u"Input time stamps are typically provided by the input plugin, for instance when "
+         u"receiving UDP packets with option --receive-timestamps in plugin ip. "
+         u"Each PCR is compared with the reception time of its packet instead of the "
+         u"position of the packet in the stream. When input time stamps are not available, "
+         u"the PCR's are verified according to the bitrate.");
+
     option(u"jitter-max", 'j', UNSIGNED);
     help(u"jitter-max",
          u"Maximum allowed jitter. PCR's with a higher jitter are reported, others "
@@ -148,6 +164,7 @@ bool ts::PCRVerifyPlugin::start()
     _jitter_max = intValue<int64_t>(u"jitter-max", _absolute ? DEFAULT_JITTER_MAX : DEFAULT_JITTER_MAX_US);
     _bitrate = intValue<BitRate>(u"bitrate", 0);
     _time_stamp = present(u"time-stamp");
+    _input_synchronous = present(u"input-synchronous");
     getIntValues(_pid_list, u"pid", true);
 
     if (!_absolute) {
@@ -164,6 +181,7 @@ bool ts::PCRVerifyPlugin::start()
     for (size_t i = 0; i < PID_MAX; ++i) {
         _stats[i].last_pcr_value = 0;
         _stats[i].last_pcr_packet = 0;
+        _stats[i].last_input_time = INVALID_PCR;
     }
 
     return true;
@@ -224,6 +242,20 @@ namespace {
 
         return (bitrate * (pcr2 - pcr1) - (pkt2 - pkt1) * ts::PKT_SIZE * 8 * ts::SYSTEM_CLOCK_FREQ) / bitrate;
     }
+
+    int64_t inputJitter(int64_t pcr1,    // first PCR value
+                        int64_t time1,   // input time stamp of PCR1 packet, in PCR units
+                        int64_t pcr2,    // seconde PCR value
+                        int64_t time2)   // input time stamp of PCR2 packet, in PCR units
+    {
+        // Adjust second PCR if PCR's have looped back after max value.
+        if (ts::WrapUpPCR(pcr1, pcr2)) {
+            pcr2 += ts::PCR_SCALE;
+        }
+
+        // The PCR difference shall be the same as the input time difference.
+        return (pcr2 - pcr1) - (time2 - time1);
+    }
 }
 
 
@@ -233,49 +265,80 @@ namespace {
 
 ts::ProcessorPlugin::Status ts::PCRVerifyPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
 {
-    const size_t pid = pkt.getPID();
+    const PID pid = pkt.getPID();
 
     // Check if this PID shall be filtered and packet has a PCR
     if (_pid_list[pid] && pkt.hasPCR()) {
+        checkPCR(pkt, pkt_data, pid, int64_t(_bitrate != 0 ? _bitrate : tsp->bitrate()));
+    }
 
-        const uint64_t pcr = pkt.getPCR();
-        PIDContext& pc(_stats[pid]);
+    // Count packets on TS
+    _packet_count++;
 
-        // Compare PCR with previous one (if there is one)
-        if (pc.last_pcr_value == 0) {
-            _nb_pcr_unchecked++;
+    return TSP_OK;
+}
+
+size_t ts::PCRVerifyPlugin::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    // The current bitrate is evaluated once per batch.
+    const int64_t bitrate = int64_t(_bitrate != 0 ? _bitrate : tsp->bitrate());
+
+    for (size_t i = 0; i < count; ++i) {
+        const PID pid = pkt[i].getPID();
+        if (_pid_list[pid] && pkt[i].hasPCR()) {
+            checkPCR(pkt[i], pkt_data[i], pid, bitrate);
+        }
+        _packet_count++;
+        status[i] = TSP_OK;
+    }
+    return count;
+}
+
+
+//----------------------------------------------------------------------------
+// Check the PCR of a packet at the current position.
+//----------------------------------------------------------------------------
+
+void ts::PCRVerifyPlugin::checkPCR(const TSPacket& pkt, const TSPacketMetadata& pkt_data, PID pid, int64_t bitrate)
+{
+    const uint64_t pcr = pkt.getPCR();
+    const uint64_t input_time = pkt_data.getInputTimeStamp();
+    PIDContext& pc(_stats[pid]);
+
+    // Compare PCR with previous one (if there is one)
+    if (pc.last_pcr_value == 0) {
+        _nb_pcr_unchecked++;
+    }
+    else {
+        // PCR jitter, using input time stamps when requested and available, bitrate otherwise.
+        int64_t jit = 0;
+        if (_input_synchronous && input_time != INVALID_PCR && pc.last_input_time != INVALID_PCR) {
+            jit = inputJitter(int64_t(pc.last_pcr_value), int64_t(pc.last_input_time), int64_t(pcr), int64_t(input_time));
         }
         else {
-            // Current bitrate:
-            int64_t bitrate = int64_t(_bitrate != 0 ? _bitrate : tsp->bitrate());
-            // PCR jitter:
-            int64_t jit = jitter(int64_t(pc.last_pcr_value),
-                                 int64_t(pc.last_pcr_packet),
-                                 int64_t(pcr),
-                                 int64_t(_packet_count),
-                                 bitrate);
-            // Absolute value of PCR jitter:
-            int64_t ajit = jit >= 0 ? jit : -jit;
-            if (ajit <= _jitter_max) {
-                _nb_pcr_ok++;
-            }
-            else {
-                _nb_pcr_nok++;
-                // Jitter in bits at current bitrate
-                int64_t bit_jit = (ajit * bitrate) / SYSTEM_CLOCK_FREQ;
-                tsp->info(u"%sPID %d (0x%X), PCR jitter: %'d = %'d micro-seconds = %'d packets + %'d bytes + %'d bits",
-                          {_time_stamp ? (Time::CurrentLocalTime().format(Time::DATE | Time::TIME) + u", ") : u"",
-                           pid, pid, jit, ajit / PCR_PER_MICRO_SEC, bit_jit / (PKT_SIZE * 8), (bit_jit / 8) % PKT_SIZE, bit_jit % 8});
-            }
+            jit = jitter(int64_t(pc.last_pcr_value),
+                         int64_t(pc.last_pcr_packet),
+                         int64_t(pcr),
+                         int64_t(_packet_count),
+                         bitrate);
+        }
+        // Absolute value of PCR jitter:
+        int64_t ajit = jit >= 0 ? jit : -jit;
+        if (ajit <= _jitter_max) {
+            _nb_pcr_ok++;
+        }
+        else {
+            _nb_pcr_nok++;
+            // Jitter in bits at current bitrate
+            int64_t bit_jit = (ajit * bitrate) / SYSTEM_CLOCK_FREQ;
+            tsp->info(u"%sPID %d (0x%X), PCR jitter: %'d = %'d micro-seconds = %'d packets + %'d bytes + %'d bits",
+                      {_time_stamp ? (Time::CurrentLocalTime().format(Time::DATE | Time::TIME) + u", ") : u"",
+                       pid, pid, jit, ajit / PCR_PER_MICRO_SEC, bit_jit / (PKT_SIZE * 8), (bit_jit / 8) % PKT_SIZE, bit_jit % 8});
         }
-
-        // Remember PCR position
-        pc.last_pcr_value = pcr;
-        pc.last_pcr_packet = _packet_count;
     }
 
-    // Count packets on TS
-    _packet_count++;
-
-    return TSP_OK;
+    // Remember PCR position
+    pc.last_pcr_value = pcr;
+    pc.last_pcr_packet = _packet_count;
+    pc.last_input_time = input_time;
 }
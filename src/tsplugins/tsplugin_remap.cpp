@@ -59,6 +59,7 @@ namespace ts {
         virtual bool getOptions() override;
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual size_t processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*) override;
 
     private:
         typedef SafePtr<CyclingPacketizer, NullMutex> CyclingPacketizerPtr;
@@ -68,6 +69,7 @@ namespace ts {
         bool          _pmt_ready;       // All PMT PID's are known
         SectionDemux  _demux;           // Section demux
         PacketizerMap _pzer;            // Packetizer for sections
+        PID           _newPID[PID_MAX]; // Flat remapping table, built from _pidMap in start()
 
         // Invoked by the demux when a complete table is available.
         virtual void handleTable(SectionDemux&, const BinaryTable&) override;
@@ -96,7 +98,8 @@ ts::RemapPlugin::RemapPlugin(TSP* tsp_) :
     _update_psi(false),
     _pmt_ready(false),
     _demux(duck, this),
-    _pzer()
+    _pzer(),
+    _newPID()
 {
     option(u"no-psi", 'n');
     help(u"no-psi",
@@ -141,6 +144,14 @@ bool ts::RemapPlugin::start()
     // Do not care about PMT if no need to update PSI
     _pmt_ready = !_update_psi;
 
+    // Build the flat remapping table, avoid map lookups on each packet.
+    for (PID pid = 0; pid < PID_MAX; ++pid) {
+        _newPID[pid] = pid;
+    }
+    for (auto it = _pidMap.begin(); it != _pidMap.end(); ++it) {
+        _newPID[it->first] = it->second;
+    }
+
     tsp->verbose(u"%d PID's remapped", {_pidMap.size()});
     return true;
 }
@@ -152,8 +163,7 @@ bool ts::RemapPlugin::start()
 
 ts::PID ts::RemapPlugin::remap(PID pid)
 {
-    const PIDMap::const_iterator it = _pidMap.find(pid);
-    return it == _pidMap.end() ? pid : it->second;
+    return _newPID[pid & 0x1FFF];
 }
 
 
@@ -299,3 +309,40 @@ ts::ProcessorPlugin::Status ts::RemapPlugin::processPacket(TSPacket& pkt, TSPack
 
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+size_t ts::RemapPlugin::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    // When PSI are updated, packets are processed one by one.
+    if (_update_psi) {
+        for (size_t i = 0; i < count; ++i) {
+            status[i] = processPacket(pkt[i], pkt_data[i]);
+            if (status[i] == TSP_END) {
+                return i + 1;
+            }
+        }
+        return count;
+    }
+
+    // Without PSI update, only remap PID's.
+    for (size_t i = 0; i < count; ++i) {
+        const PID pid = pkt[i].getPID();
+        const PID new_pid = _newPID[pid];
+        if (pid != new_pid) {
+            pkt[i].setPID(new_pid);
+            pkt_data[i].setLabels(_setLabels);
+            pkt_data[i].clearLabels(_resetLabels);
+        }
+        else if (!_unchecked && _newPIDs.test(pid)) {
+            tsp->error(u"PID conflict: PID %d (0x%X) present both in input and remap", {pid, pid});
+            status[i] = TSP_END;
+            return i + 1;
+        }
+        status[i] = TSP_OK;
+    }
+    return count;
+}
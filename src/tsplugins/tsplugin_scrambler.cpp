@@ -105,6 +105,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual size_t processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*) override;
 
     private:
         // Description of a crypto-period.
@@ -196,6 +197,9 @@ namespace ts {
         size_t            _current_ecm;         // Index to current ECM (ECM being broadcast)
         TSScrambling      _scrambling;          // Scrambler
         CyclingPacketizer _pzer_pmt;            // Packetizer for modified PMT
+        bool              _batch_mode;          // Packets to scramble are collected in _pending
+        std::vector<TSPacket*> _pending;        // Packets to scramble in current batch, same CW
+        TSPacket*         _pending_error;       // First packet of a pending list which failed to scramble
 
         // Return current/next CryptoPeriod for CW or ECM
         CryptoPeriod& currentCW()  { return _cp[_current_cw]; }
@@ -213,6 +217,15 @@ namespace ts {
         // Try to exit from degraded mode
         bool tryExitDegradedMode();
 
+        // Maintain the TS bitrate, keep previous one if unknown.
+        void updateBitrate();
+
+        // Process one packet, after bitrate update.
+        Status scramblePacket(TSPacket& pkt);
+
+        // In batch mode, scramble all pending packets.
+        bool flushPending();
+
         // Invoked when the PMT of the service is available.
         virtual void handlePMT(const PMT&, PID) override;
     };
@@ -266,7 +279,10 @@ ts::ScramblerPlugin::ScramblerPlugin(TSP* tsp_) :
     _current_cw(0),
     _current_ecm(0),
     _scrambling(*tsp),
-    _pzer_pmt()
+    _pzer_pmt(),
+    _batch_mode(false),
+    _pending(),
+    _pending_error(nullptr)
 {
     option(u"", 0, STRING, 0, 1);
     help(u"",
@@ -681,6 +697,11 @@ bool ts::ScramblerPlugin::tryExitDegradedMode()
 
 bool ts::ScramblerPlugin::changeCW()
 {
+    // Packets which are collected for scrambling must use the previous CW.
+    if (!flushPending()) {
+        return false;
+    }
+
     if (_scrambling.hasFixedCW()) {
         // A list of fixed CW was loaded from a file.
 
@@ -743,7 +764,67 @@ void ts::ScramblerPlugin::changeECM()
 // Packet processing method
 //----------------------------------------------------------------------------
 
+void ts::ScramblerPlugin::updateBitrate()
+{
+    const BitRate br = tsp->bitrate();
+    if (br != 0) {
+        _ts_bitrate = br;
+    }
+}
+
 ts::ProcessorPlugin::Status ts::ScramblerPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
+{
+    updateBitrate();
+    return scramblePacket(pkt);
+}
+
+size_t ts::ScramblerPlugin::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    // The bitrate is fetched once per batch.
+    updateBitrate();
+
+    // Packets to scramble are collected and scrambled all together, using
+    // the DVB-CSA2 batch implementation when possible. The list of pending
+    // packets is flushed when the CW changes and at end of batch.
+    _batch_mode = true;
+    _pending.clear();
+    _pending_error = nullptr;
+
+    size_t end = count;
+    for (size_t i = 0; i < count; ++i) {
+        status[i] = scramblePacket(pkt[i]);
+        if (status[i] == TSP_END) {
+            end = i + 1;
+            break;
+        }
+    }
+    flushPending();
+    _batch_mode = false;
+
+    // On scrambling error, the stream ends before the first unscrambled packet.
+    if (_pending_error != nullptr) {
+        const size_t index = _pending_error - pkt;
+        assert(index < end);
+        status[index] = TSP_END;
+        end = index + 1;
+    }
+    return end;
+}
+
+bool ts::ScramblerPlugin::flushPending()
+{
+    bool ok = true;
+    if (!_pending.empty()) {
+        ok = _scrambling.encrypt(_pending.data(), _pending.size());
+        if (!ok && _pending_error == nullptr) {
+            _pending_error = _pending.front();
+        }
+        _pending.clear();
+    }
+    return ok;
+}
+
+ts::ProcessorPlugin::Status ts::ScramblerPlugin::scramblePacket(TSPacket& pkt)
 {
     // Count packets
     _packet_count++;
@@ -752,12 +833,6 @@ ts::ProcessorPlugin::Status ts::ScramblerPlugin::processPacket(TSPacket& pkt, TS
     const PID pid = pkt.getPID();
     _input_pids.set(pid);
 
-    // Maintain bitrate, keep previous one if unknown
-    const BitRate br = tsp->bitrate();
-    if (br != 0) {
-        _ts_bitrate = br;
-    }
-
     // Filter interesting sections to discover the service.
     if (_use_service) {
         _service.feedPacket(pkt);
@@ -846,8 +921,11 @@ ts::ProcessorPlugin::Status ts::ScramblerPlugin::processPacket(TSPacket& pkt, TS
         _partial_clear = _partial_scrambling - 1;
     }
 
-    // Scramble the packet payload.
-    if (!_scrambling.encrypt(pkt)) {
+    // Scramble the packet payload, immediately or with the rest of the batch.
+    if (_batch_mode) {
+        _pending.push_back(&pkt);
+    }
+    else if (!_scrambling.encrypt(pkt)) {
         return TSP_END;
     }
     _scrambled_count++;
@@ -37,6 +37,7 @@
 #include "tsServiceDescriptor.h"
 #include "tsService.h"
 #include "tsSDT.h"
+#include "tsPSIEditors.h"
 TSDUCK_SOURCE;
 
 
@@ -63,6 +64,9 @@ namespace ts {
         // Implementation of AbstractTablePlugin.
         virtual void createNewTable(BinaryTable& table) override;
         virtual void modifyTable(BinaryTable& table, bool& is_target, bool& reinsert) override;
+
+        // Try to apply the modifications directly in the sections of the SDT.
+        bool modifyInPlace(BinaryTable& table);
     };
 }
 
@@ -225,6 +229,11 @@ void ts::SDTPlugin::modifyTable(BinaryTable& table, bool& is_target, bool& reins
         return;
     }
 
+    // Global modifications and service removals do not need a full deserialization of the SDT.
+    if (modifyInPlace(table)) {
+        return;
+    }
+
     // Process the SDT.
     SDT sdt(duck, table);
     if (!sdt.isValid()) {
@@ -297,3 +306,39 @@ void ts::SDTPlugin::modifyTable(BinaryTable& table, bool& is_target, bool& reins
     // Reserialize modified SDT.
     sdt.serialize(duck, table);
 }
+
+
+//----------------------------------------------------------------------------
+// Try to apply the modifications directly in the sections of the SDT.
+// Return false if the SDT must be deserialized (service to add or modify).
+//----------------------------------------------------------------------------
+
+bool ts::SDTPlugin::modifyInPlace(BinaryTable& table)
+{
+    if (_service.hasId() || _cleanup_priv_desc) {
+        return false;
+    }
+
+    // Check that all sections are valid before modifying any of them.
+    for (size_t i = 0; i < table.sectionCount(); ++i) {
+        const SectionPtr& sect(table.sectionAt(i));
+        if (sect.isNull() || !SDTView(*sect).isValid()) {
+            return false;
+        }
+    }
+
+    // Patch all sections.
+    for (size_t i = 0; i < table.sectionCount(); ++i) {
+        SDTEditor sdt(*table.sectionAt(i));
+        if (_service.hasONId()) {
+            sdt.setOriginalNetworkId(_service.getONId());
+        }
+        for (std::vector<uint16_t>::const_iterator it = _remove_serv.begin(); it != _remove_serv.end(); ++it) {
+            sdt.removeService(*it);
+        }
+    }
+    if (_service.hasTSId()) {
+        table.setTableIdExtension(_service.getTSId());
+    }
+    return true;
+}
@@ -0,0 +1,203 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Transport stream processor shared library:
+//  Exchange TS packets with another tsp process through a ring in shared memory.
+//
+//----------------------------------------------------------------------------
+
+#include "tsPlugin.h"
+#include "tsPluginRepository.h"
+#include "tsSharedPacketRing.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Plugin definition
+//----------------------------------------------------------------------------
+
+namespace ts {
+
+    // Input plugin
+    class SharedMemoryInput: public InputPlugin
+    {
+        TS_NOBUILD_NOCOPY(SharedMemoryInput);
+    public:
+        // Implementation of plugin API
+        SharedMemoryInput(TSP*);
+        virtual bool getOptions() override;
+        virtual bool start() override;
+        virtual bool stop() override;
+        virtual BitRate getBitrate() override;
+        virtual size_t receive(TSPacket*, TSPacketMetadata*, size_t) override;
+        virtual bool abortInput() override;
+
+    private:
+        UString          _name;     // Shared memory segment name.
+        MilliSecond      _timeout;  // Timeout for segment creation by the producer.
+        SharedPacketRing _ring;     // The shared ring.
+    };
+
+    // Output plugin
+    class SharedMemoryOutput: public OutputPlugin
+    {
+        TS_NOBUILD_NOCOPY(SharedMemoryOutput);
+    public:
+        // Implementation of plugin API
+        SharedMemoryOutput(TSP*);
+        virtual bool getOptions() override;
+        virtual bool start() override;
+        virtual bool stop() override;
+        virtual bool send(const TSPacket*, const TSPacketMetadata*, size_t) override;
+
+    private:
+        UString          _name;          // Shared memory segment name.
+        size_t           _packet_count;  // Number of packets in the ring.
+        SharedPacketRing _ring;          // The shared ring.
+    };
+}
+
+TSPLUGIN_DECLARE_VERSION
+TSPLUGIN_DECLARE_INPUT(shm, ts::SharedMemoryInput)
+TSPLUGIN_DECLARE_OUTPUT(shm, ts::SharedMemoryOutput)
+
+
+//----------------------------------------------------------------------------
+// Input constructor
+//----------------------------------------------------------------------------
+
+ts::SharedMemoryInput::SharedMemoryInput(TSP* tsp_) :
+    InputPlugin(tsp_, u"Receive TS packets from another tsp process through shared memory", u"[options] name"),
+    _name(),
+    _timeout(0),
+    _ring()
+{
+    option(u"", 0, STRING, 1, 1);
+    help(u"",
+         u"Name of the shared memory ring. "
+         u"The ring is created by the output plugin 'shm' of another tsp process with the same name. "
+         u"If the ring does not exist yet, wait for its creation.");
+
+    option(u"timeout", 't', UNSIGNED);
+    help(u"timeout",
+         u"Maximum time in milliseconds to wait for the creation of the shared memory ring. "
+         u"By default, wait indefinitely.");
+}
+
+
+//----------------------------------------------------------------------------
+// Output constructor
+//----------------------------------------------------------------------------
+
+ts::SharedMemoryOutput::SharedMemoryOutput(TSP* tsp_) :
+    OutputPlugin(tsp_, u"Send TS packets to another tsp process through shared memory", u"[options] name"),
+    _name(),
+    _packet_count(0),
+    _ring()
+{
+    option(u"", 0, STRING, 1, 1);
+    help(u"",
+         u"Name of the shared memory ring. "
+         u"The ring is read by the input plugin 'shm' of another tsp process with the same name. "
+         u"Any previous ring with the same name is replaced.");
+
+    option(u"buffered-packets", 'b', INTEGER, 0, 1, SharedPacketRing::MIN_PACKET_COUNT, UNLIMITED_VALUE);
+    help(u"buffered-packets",
+         u"Specifies the size of the shared memory ring in number of TS packets. "
+         u"When the ring is full, the output is blocked until the other process reads packets. "
+         u"The default is " + UString::Decimal(SharedPacketRing::DEFAULT_PACKET_COUNT) + u" packets.");
+}
+
+
+//----------------------------------------------------------------------------
+// Input methods
+//----------------------------------------------------------------------------
+
+bool ts::SharedMemoryInput::getOptions()
+{
+    _name = value(u"");
+    _timeout = intValue<MilliSecond>(u"timeout", Infinite);
+    return true;
+}
+
+bool ts::SharedMemoryInput::start()
+{
+    return _ring.open(_name, _timeout, *tsp);
+}
+
+bool ts::SharedMemoryInput::stop()
+{
+    return _ring.close(*tsp);
+}
+
+bool ts::SharedMemoryInput::abortInput()
+{
+    _ring.abort();
+    return true;
+}
+
+ts::BitRate ts::SharedMemoryInput::getBitrate()
+{
+    // Bitrate as known by the producer process.
+    return _ring.getBitrate();
+}
+
+size_t ts::SharedMemoryInput::receive(TSPacket* buffer, TSPacketMetadata* pkt_data, size_t max_packets)
+{
+    return _ring.read(buffer, pkt_data, max_packets, *tsp);
+}
+
+
+//----------------------------------------------------------------------------
+// Output methods
+//----------------------------------------------------------------------------
+
+bool ts::SharedMemoryOutput::getOptions()
+{
+    _name = value(u"");
+    _packet_count = intValue<size_t>(u"buffered-packets", SharedPacketRing::DEFAULT_PACKET_COUNT);
+    return true;
+}
+
+bool ts::SharedMemoryOutput::start()
+{
+    return _ring.create(_name, _packet_count, *tsp);
+}
+
+bool ts::SharedMemoryOutput::stop()
+{
+    return _ring.close(*tsp);
+}
+
+bool ts::SharedMemoryOutput::send(const TSPacket* buffer, const TSPacketMetadata* pkt_data, size_t packet_count)
+{
+    // Propagate the bitrate of our stream to the consumer.
+    _ring.setBitrate(tsp->bitrate());
+    return _ring.write(buffer, pkt_data, packet_count, tsp, *tsp);
+}
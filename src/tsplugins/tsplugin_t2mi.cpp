@@ -38,9 +38,13 @@
 #include "tsT2MIDescriptor.h"
 #include "tsT2MIPacket.h"
 #include "tsTSFile.h"
+#include "tsUDPSocket.h"
+#include "tsSysUtils.h"
 #include "tsNames.h"
 TSDUCK_SOURCE;
 
+#define UDP_PACKET_BURST 7  // 1316 B, fits (with headers) in Ethernet MTU
+
 
 //----------------------------------------------------------------------------
 // Plugin definition
@@ -65,6 +69,23 @@ namespace ts {
         // Set of identified T2-MI PID's with their PLP's (with --identify).
         typedef std::map<PID, PLPSet> IdentifiedSet;
 
+        // Extraction context and outputs for one PLP.
+        struct PLPContext
+        {
+            PLPContext();
+            TSFile        outfile;     // Output file for this PLP.
+            SocketAddress destination; // UDP destination for this PLP.
+            size_t        udp_count;   // Number of packets in udp_buffer.
+            TSPacket      udp_buffer[UDP_PACKET_BURST];  // Packets for next UDP datagram.
+            PacketCounter t2mi_count;  // Number of input T2-MI packets.
+            PacketCounter ts_count;    // Number of extracted TS packets.
+        };
+        typedef SafePtr<PLPContext, NullMutex> PLPContextPtr;
+        typedef std::map<uint8_t, PLPContextPtr> PLPContextMap;
+
+        // Extracted TS packet with its PLP, waiting to replace the main TS.
+        typedef std::pair<uint8_t, TSPacket> PLPPacket;
+
         // Plugin private fields.
         bool              _abort;           // Error, abort asap.
         bool              _extract;         // Extract encapsulated TS.
@@ -75,14 +96,31 @@ namespace ts {
         PID               _extract_pid;     // PID carrying the T2-MI encapsulation.
         uint8_t           _plp;             // The PLP to extract in _pid.
         bool              _plp_valid;       // False if PLP not yet known.
+        bool              _all_plps;        // Extract all PLP's.
+        bool              _multi_plp;       // Extract several PLP's in one pass.
+        PLPSet            _plps;            // PLP's to extract in multi-PLP mode.
+        size_t            _label_base;      // Base label for replaced TS packets.
         TSFile::OpenFlags _outfile_flags;   // Open flags for output file.
-        UString           _outfile_name;    // Output file name.
-        TSFile            _outfile;         // Output file for extracted stream.
+        UString           _outfile_name;    // Output file name (template name in multi-PLP mode).
+        SocketAddress     _udp_dest;        // UDP destination (base port in multi-PLP mode).
+        IPAddress         _udp_local;       // Outgoing local interface for UDP.
+        int               _udp_ttl;         // Time to live for UDP.
+        UDPSocket         _udp_sock;        // Output UDP socket.
         PacketCounter     _t2mi_count;      // Number of input T2-MI packets.
         PacketCounter     _ts_count;        // Number of extracted TS packets.
         T2MIDemux         _demux;           // T2-MI demux.
         IdentifiedSet     _identified;      // Map of identified PID's and PLP's.
-        std::deque<TSPacket> _ts_queue;     // Queue of demuxed TS packets.
+        PLPContextMap     _plp_contexts;    // Extraction contexts per PLP.
+        std::deque<PLPPacket> _ts_queue;    // Queue of demuxed TS packets.
+
+        // Check if a PLP is extracted.
+        bool isExtracted(uint8_t plp) const;
+
+        // Get or create the extraction context of a PLP, open its outputs.
+        PLPContext& getPLPContext(uint8_t plp);
+
+        // Send buffered packets of a PLP over UDP.
+        void flushUDP(PLPContext& ctx);
 
         // Inherited methods.
         virtual void handleT2MINewPID(T2MIDemux& demux, const PMT& pmt, PID pid, const T2MIDescriptor& desc) override;
@@ -111,15 +149,28 @@ ts::T2MIPlugin::T2MIPlugin(TSP* tsp_) :
     _extract_pid(PID_NULL),
     _plp(0),
     _plp_valid(false),
+    _all_plps(false),
+    _multi_plp(false),
+    _plps(),
+    _label_base(0),
     _outfile_flags(TSFile::NONE),
     _outfile_name(),
-    _outfile(),
+    _udp_dest(),
+    _udp_local(),
+    _udp_ttl(0),
+    _udp_sock(),
     _t2mi_count(0),
     _ts_count(0),
     _demux(duck, this),
     _identified(),
+    _plp_contexts(),
     _ts_queue()
 {
+    option(u"all-plps");
+    help(u"all-plps",
+         u"Extract encapsulated TS packets from all PLP's of the T2-MI stream in one single pass. "
+         u"Each PLP is sent to its own output, see options --output-file, --output-ip and --label-base.");
+
     option(u"append", 'a');
     help(u"append",
          u"With --output-file, if the file already exists, append to the end of the "
@@ -143,24 +194,52 @@ ts::T2MIPlugin::T2MIPlugin(TSP* tsp_) :
          u"With --output-file, keep existing file (abort if the specified file "
          u"already exists). By default, existing files are overwritten.");
 
+    option(u"label-base", 0, INTEGER, 0, 1, 0, TSPacketMetadata::LABEL_MAX);
+    help(u"label-base",
+         u"When the transport stream is replaced by the extracted stream, set a label on each extracted packet. "
+         u"Packets from PLP N are tagged with the specified base label plus N. "
+         u"This can be used to split the PLP's downstream. "
+         u"For a given PLP, if the computed label is above the maximum (" +
+         UString::Decimal(TSPacketMetadata::LABEL_MAX) + u"), its packets are not labelled.");
+
+    option(u"local-address", 0, STRING);
+    help(u"local-address", u"address",
+         u"With --output-ip, when the destination is a multicast address, specify "
+         u"the IP address of the outgoing local interface. It can be also a host "
+         u"name that translates to a local address.");
+
     option(u"log", 'l');
     help(u"log", u"Log all T2-MI packets using one single summary line per packet.");
 
     option(u"output-file", 'o', STRING);
     help(u"output-file", u"filename",
          u"Specify that the extracted stream is saved in this file. In that case, "
-         u"the main transport stream is passed unchanged to the next plugin.");
+         u"the main transport stream is passed unchanged to the next plugin. "
+         u"When several PLP's are extracted, each PLP is saved in its own file. "
+         u"The PLP number is inserted before the file extension, "
+         u"for instance 'out.ts' becomes 'out_plp3.ts' for PLP 3.");
+
+    option(u"output-ip", 0, STRING);
+    help(u"output-ip", u"address:port",
+         u"Specify that the extracted stream is sent over UDP to this destination. In that case, "
+         u"the main transport stream is passed unchanged to the next plugin. "
+         u"The address can be a unicast or multicast one. "
+         u"When several PLP's are extracted, PLP N is sent to the specified port plus N.");
 
     option(u"pid", 'p', PIDVAL);
     help(u"pid",
          u"Specify the PID carrying the T2-MI encapsulation. By default, use the "
          u"first component with a T2MI_descriptor in a service.");
 
-    option(u"plp", 0, UINT8);
+    option(u"plp", 0, UINT8, 0, UNLIMITED_COUNT);
     help(u"plp",
          u"Specify the PLP (Physical Layer Pipe) to extract from the T2-MI "
          u"encapsulation. By default, use the first PLP which is found. "
+         u"Several --plp options may be specified to extract several PLP's in one single pass. "
          u"Ignored if --extract is not used.");
+
+    option(u"ttl", 0, POSITIVE);
+    help(u"ttl", u"With --output-ip, specify the TTL (Time-To-Live) socket option. The default is system-specific.");
 }
 
 
@@ -177,8 +256,43 @@ bool ts::T2MIPlugin::getOptions()
     _extract_pid = _original_pid = intValue<PID>(u"pid", PID_NULL);
     _plp = intValue<uint8_t>(u"plp");
     _plp_valid = present(u"plp");
+    _all_plps = present(u"all-plps");
+    getIntValues(_plps, u"plp");
+    _multi_plp = _all_plps || _plps.count() > 1;
+    _label_base = intValue<size_t>(u"label-base", TSPacketMetadata::LABEL_MAX + 1);
+    _udp_ttl = intValue<int>(u"ttl", 0);
     getValue(_outfile_name, u"output-file");
 
+    // Resolve UDP addresses.
+    _udp_dest.clear();
+    _udp_local.clear();
+    const UString udp_dest(value(u"output-ip"));
+    const UString udp_local(value(u"local-address"));
+    if (!udp_dest.empty() && !_udp_dest.resolve(udp_dest, *tsp)) {
+        return false;
+    }
+    if (!udp_dest.empty() && (!_udp_dest.hasAddress() || !_udp_dest.hasPort())) {
+        tsp->error(u"missing IP address or port in --output-ip %s", {udp_dest});
+        return false;
+    }
+    if (!udp_local.empty() && !_udp_local.resolve(udp_local, *tsp)) {
+        return false;
+    }
+
+    // In multi-PLP mode, the UDP port of each PLP is the base port plus the PLP id.
+    if (_multi_plp && _udp_dest.hasPort()) {
+        size_t max_plp = _all_plps ? _plps.size() - 1 : 0;
+        for (size_t plp = 0; !_all_plps && plp < _plps.size(); ++plp) {
+            if (_plps.test(plp)) {
+                max_plp = plp;
+            }
+        }
+        if (_udp_dest.port() + max_plp > 0xFFFF) {
+            tsp->error(u"base UDP port %d too high for PLP %d, the maximum is %d", {_udp_dest.port(), max_plp, 0xFFFF - max_plp});
+            return false;
+        }
+    }
+
     // Output file open flags.
     _outfile_flags = TSFile::WRITE | TSFile::SHARED;
     if (present(u"append")) {
@@ -189,13 +303,13 @@ bool ts::T2MIPlugin::getOptions()
     }
 
     // Extract is the default operation.
-    // It is also implicit if an output file is specified.
-    if ((!_extract && !_log && !_identify) || !_outfile_name.empty()) {
+    // It is also implicit if an output file or UDP destination is specified.
+    if ((!_extract && !_log && !_identify) || !_outfile_name.empty() || _udp_dest.hasAddress() || _all_plps) {
         _extract = true;
     }
 
-    // Replace the TS if no output file is present.
-    _replace_ts = _extract && _outfile_name.empty();
+    // Replace the TS if no output file or UDP destination is present.
+    _replace_ts = _extract && _outfile_name.empty() && !_udp_dest.hasAddress();
     return true;
 }
 
@@ -214,13 +328,25 @@ bool ts::T2MIPlugin::start()
 
     // Reset the packet output.
     _identified.clear();
+    _plp_contexts.clear();
     _ts_queue.clear();
     _t2mi_count = 0;
     _ts_count = 0;
     _abort = false;
 
-    // Open output file if present.
-    return _outfile_name.empty() || _outfile.open(_outfile_name, _outfile_flags , *tsp);
+    // Open the UDP socket if present. Output files are open when their PLP is found.
+    if (_udp_dest.hasAddress()) {
+        if (!_udp_sock.open(*tsp)) {
+            return false;
+        }
+        if ((_udp_local.hasAddress() && !_udp_sock.setOutgoingMulticast(_udp_local, *tsp)) ||
+            (_udp_ttl > 0 && !_udp_sock.setTTL(_udp_ttl, _udp_dest.isMulticast(), *tsp)))
+        {
+            _udp_sock.close(*tsp);
+            return false;
+        }
+    }
+    return true;
 }
 
 
@@ -230,9 +356,19 @@ bool ts::T2MIPlugin::start()
 
 bool ts::T2MIPlugin::stop()
 {
-    // Close extracted TS file.
-    if (_outfile.isOpen()) {
-        _outfile.close(*tsp);
+    // Flush and close outputs of all PLP's.
+    for (auto it = _plp_contexts.begin(); it != _plp_contexts.end(); ++it) {
+        PLPContext& ctx(*it->second);
+        flushUDP(ctx);
+        if (ctx.outfile.isOpen()) {
+            ctx.outfile.close(*tsp);
+        }
+        if (_multi_plp) {
+            tsp->verbose(u"PLP %d: extracted %'d TS packets from %'d T2-MI packets", {it->first, ctx.ts_count, ctx.t2mi_count});
+        }
+    }
+    if (_udp_sock.isOpen()) {
+        _udp_sock.close(*tsp);
     }
 
     // With --extract, display a summary.
@@ -265,6 +401,68 @@ bool ts::T2MIPlugin::stop()
 }
 
 
+//----------------------------------------------------------------------------
+// Check if a PLP is extracted.
+//----------------------------------------------------------------------------
+
+bool ts::T2MIPlugin::isExtracted(uint8_t plp) const
+{
+    return _multi_plp ? (_all_plps || _plps.test(plp)) : (_plp_valid && plp == _plp);
+}
+
+
+//----------------------------------------------------------------------------
+// Get or create the extraction context of a PLP, open its outputs.
+//----------------------------------------------------------------------------
+
+ts::T2MIPlugin::PLPContext::PLPContext() :
+    outfile(),
+    destination(),
+    udp_count(0),
+    udp_buffer(),
+    t2mi_count(0),
+    ts_count(0)
+{
+}
+
+ts::T2MIPlugin::PLPContext& ts::T2MIPlugin::getPLPContext(uint8_t plp)
+{
+    PLPContextPtr& ctx(_plp_contexts[plp]);
+    if (ctx.isNull()) {
+        ctx = new PLPContext;
+        if (_multi_plp) {
+            tsp->verbose(u"extracting PLP 0x%X (%d)", {plp, plp});
+        }
+
+        // In multi-PLP mode, each PLP has its own file name and UDP port.
+        if (!_outfile_name.empty()) {
+            const UString name(_multi_plp ? UString::Format(u"%s_plp%d%s", {PathPrefix(_outfile_name), plp, PathSuffix(_outfile_name)}) : _outfile_name);
+            _abort = _abort || !ctx->outfile.open(name, _outfile_flags, *tsp);
+        }
+        if (_udp_dest.hasAddress()) {
+            ctx->destination = _udp_dest;
+            if (_multi_plp) {
+                ctx->destination.setPort(uint16_t(_udp_dest.port() + plp));
+            }
+        }
+    }
+    return *ctx;
+}
+
+
+//----------------------------------------------------------------------------
+// Send buffered packets of a PLP over UDP.
+//----------------------------------------------------------------------------
+
+void ts::T2MIPlugin::flushUDP(PLPContext& ctx)
+{
+    if (ctx.udp_count > 0 && _udp_sock.isOpen()) {
+        _abort = _abort || !_udp_sock.send(ctx.udp_buffer, ctx.udp_count * PKT_SIZE, ctx.destination, *tsp);
+    }
+    ctx.udp_count = 0;
+}
+
+
 //----------------------------------------------------------------------------
 // Process new T2-MI PID.
 //----------------------------------------------------------------------------
@@ -316,15 +514,16 @@ void ts::T2MIPlugin::handleT2MIPacket(T2MIDemux& demux, const T2MIPacket& pkt)
 
     // Select PLP when extraction is requested.
     if (_extract && pid == _extract_pid && hasPLP) {
-        if (!_plp_valid) {
+        if (!_multi_plp && !_plp_valid) {
             // The PLP was not yet specified, use this one by default.
             _plp = plp;
             _plp_valid = true;
             tsp->verbose(u"extracting PLP 0x%X (%d)", {_plp, _plp});
         }
-        if (plp == _plp) {
+        if (isExtracted(plp)) {
             // Count input T2-MI packets.
             _t2mi_count++;
+            getPLPContext(plp).t2mi_count++;
         }
     }
 
@@ -345,19 +544,30 @@ void ts::T2MIPlugin::handleT2MIPacket(T2MIDemux& demux, const T2MIPacket& pkt)
 
 void ts::T2MIPlugin::handleTSPacket(T2MIDemux& demux, const T2MIPacket& t2mi, const TSPacket& ts)
 {
-    // Keep packet from the filtered PLP only.
-    if (_extract && _plp_valid && t2mi.plp() == _plp) {
+    // Keep packet from the filtered PLP's only.
+    const uint8_t plp = t2mi.plp();
+    if (_extract && isExtracted(plp)) {
+        PLPContext& ctx(getPLPContext(plp));
+        ctx.ts_count++;
+        _ts_count++;
         if (_replace_ts) {
             // Enqueue the TS packet for replacement later.
             // We do not really care about queue size because an overflow is not possible.
             // This plugin deletes all input packets and replaces them with demux'ed packets.
             // And the number of input TS packets is always higher than the number of output
-            // packets because of T2-MI encapsulation and other PID's.
-            _ts_queue.push_back(ts);
+            // packets because of T2-MI encapsulation and other PID's, even with all PLP's.
+            _ts_queue.push_back(std::make_pair(plp, ts));
         }
-        else {
+        if (ctx.outfile.isOpen()) {
             // Write the packet to output file.
-            _abort = _abort || !_outfile.write(&ts, 1, *tsp);
+            _abort = _abort || !ctx.outfile.write(&ts, 1, *tsp);
+        }
+        if (_udp_sock.isOpen()) {
+            // Send a UDP datagram when the burst is complete.
+            ctx.udp_buffer[ctx.udp_count++] = ts;
+            if (ctx.udp_count >= UDP_PACKET_BURST) {
+                flushUDP(ctx);
+            }
         }
     }
 }
@@ -385,9 +595,12 @@ ts::ProcessorPlugin::Status ts::T2MIPlugin::processPacket(TSPacket& pkt, TSPacke
     }
     else {
         // Replace the current packet with the next demux'ed TS packet.
-        pkt = _ts_queue.front();
+        const size_t label = _label_base + _ts_queue.front().first;
+        pkt = _ts_queue.front().second;
         _ts_queue.pop_front();
-        _ts_count++;
+        if (label <= TSPacketMetadata::LABEL_MAX) {
+            pkt_data.setLabel(label);
+        }
         return TSP_OK;
     }
 }
@@ -35,6 +35,7 @@
 #include "tsPlugin.h"
 #include "tsPluginRepository.h"
 #include "tsTimeShiftBuffer.h"
+#include "tsSegmentedTimeShiftBuffer.h"
 TSDUCK_SOURCE;
 
 
@@ -57,11 +58,25 @@ namespace ts {
     private:
         bool            _drop_initial;   // Drop initial packets instead of null.
         MilliSecond     _time_shift_ms;  // Time-shift in milliseconds.
+        PacketCounter   _packets;        // Time-shift in packets.
+        bool            _segmented;      // Use a segmented buffer.
+        bool            _started;        // Playout started in segmented buffer.
+        BitRate         _bitrate;        // Bitrate at open time.
         TimeShiftBuffer _buffer;         // The timeshift buffer logic.
+        SegmentedTimeShiftBuffer _segbuffer;  // The segmented timeshift buffer.
+
+        // Check if the buffer is open.
+        bool isOpen() const { return _segmented ? _segbuffer.isOpen() : _buffer.isOpen(); }
 
         // Try to initialize the buffer using the time as size.
         // Return false on fatal error only.
         bool initBufferByTime();
+
+        // Time stamp of a packet for the segmented buffer time index.
+        uint64_t timeStamp(const TSPacketMetadata& pkt_data) const;
+
+        // Process a packet in the segmented buffer.
+        Status processSegmented(TSPacket& pkt, const TSPacketMetadata& pkt_data);
     };
 }
 
@@ -77,7 +92,12 @@ ts::TimeShiftPlugin::TimeShiftPlugin (TSP* tsp_) :
     ProcessorPlugin(tsp_, u"Delay transmission by a fixed amount of packets", u"[options]"),
     _drop_initial(false),
     _time_shift_ms(0),
-    _buffer()
+    _packets(0),
+    _segmented(false),
+    _started(false),
+    _bitrate(0),
+    _buffer(),
+    _segbuffer()
 {
     option(u"directory", 0, STRING);
     help(u"directory", u"path",
@@ -85,7 +105,8 @@ ts::TimeShiftPlugin::TimeShiftPlugin (TSP* tsp_) :
          u"By default, the system-specific area for temporary files is used. "
          u"The temporary file is hidden and automatically deleted on termination. "
          u"Specifying another location can be useful to redirect very large buffers to another disk. "
-         u"If the reserved memory area is large enough to hold the buffer, no file is created.");
+         u"If the reserved memory area is large enough to hold the buffer, no file is created. "
+         u"With --segments, all segment files are created in this directory.");
 
     option(u"drop-initial", 'd');
     help(u"drop-initial",
@@ -97,13 +118,28 @@ ts::TimeShiftPlugin::TimeShiftPlugin (TSP* tsp_) :
          u"Specify the number of packets which are cached in memory. "
          u"Having a larger memory cache improves the performances. "
          u"By default, the size of the memory cache is " +
-         UString::Decimal(TimeShiftBuffer::DEFAULT_MEMORY_PACKETS) + u" packets.");
+         UString::Decimal(TimeShiftBuffer::DEFAULT_MEMORY_PACKETS) + u" packets. "
+         u"With --segments, the memory is used by blocks of " +
+         UString::Decimal(SegmentedTimeShiftBuffer::BLOCK_PACKETS) + u" packets, half for read-ahead and half for write-behind, "
+         u"and the default is " +
+         UString::Decimal((SegmentedTimeShiftBuffer::DEFAULT_READ_AHEAD_BLOCKS + SegmentedTimeShiftBuffer::DEFAULT_WRITE_BEHIND_BLOCKS) * SegmentedTimeShiftBuffer::BLOCK_PACKETS) +
+         u" packets.");
 
     option(u"packets", 'p', UNSIGNED);
     help(u"packets",
          u"Specify the size of the time-shift buffer in packets. "
          u"There is no default, the size of the buffer shall be specified either using --packets or --time.");
 
+    option(u"segments", 's', INTEGER, 0, 1, SegmentedTimeShiftBuffer::MIN_SEGMENT_COUNT, UNLIMITED_VALUE);
+    help(u"segments", u"count",
+         u"Use a segmented time-shift buffer, made of the specified number of files. "
+         u"The files are preallocated on disk and used as a ring. "
+         u"All disk I/O are performed asynchronously by a separate thread, "
+         u"writing behind and reading ahead of the packet processing. "
+         u"This is recommended for very long time-shifts, several hours of a full multiplex for instance. "
+         u"With --time, the delay is driven by the input time stamps of the packets when they are available, "
+         u"the initial bitrate is only used to size the buffer.");
+
     option(u"time", 't', UNSIGNED);
     help(u"time", u"milliseconds",
          u"Specify the size of the time-shift buffer in milliseconds. "
@@ -122,17 +158,26 @@ bool ts::TimeShiftPlugin::getOptions()
 {
     _drop_initial = present(u"drop-initial");
     _time_shift_ms = intValue<MilliSecond>(u"time", 0);
-    const size_t packets = intValue<size_t>(u"packets", 0);
+    _packets = intValue<PacketCounter>(u"packets", 0);
+    _segmented = present(u"segments");
     _buffer.setBackupDirectory(value(u"directory"));
     _buffer.setMemoryPackets(intValue<size_t>(u"memory-packets", TimeShiftBuffer::DEFAULT_MEMORY_PACKETS));
+    _segbuffer.setBackupDirectory(value(u"directory"));
+    _segbuffer.setSegmentCount(intValue<size_t>(u"segments", SegmentedTimeShiftBuffer::DEFAULT_SEGMENT_COUNT));
+    if (present(u"memory-packets")) {
+        const size_t blocks = std::max<size_t>(2, (intValue<size_t>(u"memory-packets") + SegmentedTimeShiftBuffer::BLOCK_PACKETS - 1) / SegmentedTimeShiftBuffer::BLOCK_PACKETS);
+        _segbuffer.setCacheBlocks(blocks / 2, blocks - blocks / 2);
+    }
 
-    if ((packets > 0 && _time_shift_ms > 0) || (packets == 0 && _time_shift_ms == 0)) {
+    if ((_packets > 0 && _time_shift_ms > 0) || (_packets == 0 && _time_shift_ms == 0)) {
         tsp->error(u"specify exactly one of --packets and --time for time-shift buffer sizing");
         return false;
     }
 
-    if (packets > 0) {
-        _buffer.setTotalPackets(packets);
+    if (_packets > 0) {
+        _buffer.setTotalPackets(size_t(_packets));
+        // The buffer shall contain the delayed packets plus the current one.
+        _segbuffer.setTotalPackets(_packets + 1);
     }
 
     return true;
@@ -146,7 +191,7 @@ bool ts::TimeShiftPlugin::getOptions()
 bool ts::TimeShiftPlugin::initBufferByTime()
 {
     // Try to open only when the buffer is not yet open and --time was specified.
-    if (!_buffer.isOpen() && _time_shift_ms > 0) {
+    if (!isOpen() && _time_shift_ms > 0) {
         const BitRate bitrate = tsp->bitrate();
         if (bitrate > 0) {
             const PacketCounter packets = PacketDistance(bitrate, _time_shift_ms);
@@ -154,6 +199,13 @@ bool ts::TimeShiftPlugin::initBufferByTime()
                 tsp->error(u"bitrate %'d b/s is too small to perform time-shift", {bitrate});
                 return false;
             }
+            else if (_segmented) {
+                // The delay is driven by the time index, keep a 25% margin for bitrate variations.
+                _bitrate = bitrate;
+                _packets = packets;
+                _segbuffer.setTotalPackets(packets + packets / 4 + 1);
+                return _segbuffer.open(*tsp);
+            }
             else {
                 _buffer.setTotalPackets(size_t(packets));
                 return _buffer.open(*tsp);
@@ -170,8 +222,20 @@ bool ts::TimeShiftPlugin::initBufferByTime()
 
 bool ts::TimeShiftPlugin::start()
 {
+    _started = false;
+    _bitrate = 0;
+
     // Initialize the buffer only when its size is specified in packets or the bitrate is already known.
-    return _time_shift_ms == 0 ? _buffer.open(*tsp) : initBufferByTime();
+    if (_time_shift_ms > 0) {
+        return initBufferByTime();
+    }
+    else if (_segmented) {
+        _bitrate = tsp->bitrate();
+        return _segbuffer.open(*tsp);
+    }
+    else {
+        return _buffer.open(*tsp);
+    }
 }
 
 
@@ -181,7 +245,11 @@ bool ts::TimeShiftPlugin::start()
 
 bool ts::TimeShiftPlugin::stop()
 {
+    if (_segbuffer.isOpen() && _segbuffer.lostPackets() > 0) {
+        tsp->warning(u"%'d packets were lost, overwritten in the time-shift buffer before being played out", {_segbuffer.lostPackets()});
+    }
     _buffer.close(*tsp);
+    _segbuffer.close(*tsp);
     return true;
 }
 
@@ -193,24 +261,27 @@ bool ts::TimeShiftPlugin::stop()
 ts::ProcessorPlugin::Status ts::TimeShiftPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
 {
     // If buffer is not yet open, we are waiting for a valid bitrate to size it.
-    if (!_buffer.isOpen()) {
+    if (!isOpen()) {
         // Try to open it.
         if (!initBufferByTime()) {
             return TSP_END; // fatal error
         }
         // Issue a warning the first time only.
-        if (_buffer.isOpen()) {
-            tsp->verbose(u"time-shift buffer size is %'d packets", {_buffer.size()});
+        if (isOpen()) {
+            tsp->verbose(u"time-shift buffer size is %'d packets", {_segmented ? _segbuffer.size() : PacketCounter(_buffer.size())});
         }
         else if (tsp->pluginPackets() == 0) {
             tsp->warning(u"unknown initial bitrate, discarding packets until a valid bitrate can set the buffer size");
         }
     }
 
-    if (!_buffer.isOpen()) {
+    if (!isOpen()) {
         // Still waiting to set a buffer size, discarding packets.
         return _drop_initial ? TSP_DROP : TSP_NULL;
     }
+    else if (_segmented) {
+        return processSegmented(pkt, pkt_data);
+    }
     else {
         // Check if we are in the initial filling phase.
         const bool init_phase = !_buffer.full();
@@ -220,3 +291,61 @@ ts::ProcessorPlugin::Status ts::TimeShiftPlugin::processPacket(TSPacket& pkt, TS
         return init_phase && _drop_initial ? TSP_DROP : TSP_OK;
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Time stamp of a packet for the segmented buffer time index.
+//----------------------------------------------------------------------------
+
+uint64_t ts::TimeShiftPlugin::timeStamp(const TSPacketMetadata& pkt_data) const
+{
+    if (pkt_data.hasInputTimeStamp()) {
+        return pkt_data.getInputTimeStamp();
+    }
+    else if (_bitrate > 0) {
+        // Compute a time stamp from the packet index at initial bitrate, avoiding overflows.
+        const PacketCounter index = tsp->pluginPackets();
+        const uint64_t factor = PKT_SIZE * 8 * SYSTEM_CLOCK_FREQ;
+        return (index / _bitrate) * factor + ((index % _bitrate) * factor) / _bitrate;
+    }
+    else {
+        return INVALID_PCR;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Process a packet in the segmented buffer.
+//----------------------------------------------------------------------------
+
+ts::ProcessorPlugin::Status ts::TimeShiftPlugin::processSegmented(TSPacket& pkt, const TSPacketMetadata& pkt_data)
+{
+    if (!_segbuffer.write(pkt, timeStamp(pkt_data), *tsp)) {
+        return TSP_END; // fatal error
+    }
+
+    // Check if the initial filling phase is complete.
+    if (!_started) {
+        const uint64_t first = _segbuffer.firstTimeStamp();
+        const uint64_t last = _segbuffer.lastTimeStamp();
+        const uint64_t delay = uint64_t(_time_shift_ms) * (SYSTEM_CLOCK_FREQ / MilliSecPerSec);
+        if (_time_shift_ms > 0 && first != INVALID_PCR && last != INVALID_PCR) {
+            // Start playout at the specified time offset, using the time index.
+            _started = last >= first + delay;
+            if (_started && !_segbuffer.seekTimeStamp(last - delay, *tsp)) {
+                return TSP_END;
+            }
+        }
+        else {
+            // Only the delayed packets and the current one are in the buffer.
+            _started = _segbuffer.count() > _packets;
+        }
+        if (!_started) {
+            return _drop_initial ? TSP_DROP : TSP_NULL;
+        }
+        tsp->verbose(u"starting time-shift playout, %'d packets in buffer", {_segbuffer.count()});
+    }
+
+    // Then, output one packet for each input one.
+    return _segbuffer.read(pkt, *tsp) ? TSP_OK : TSP_END;
+}
@@ -34,8 +34,7 @@
 #include "tsMain.h"
 #include "tsAsyncReport.h"
 #include "tsFatal.h"
-#include "tsMutex.h"
-#include "tsThread.h"
+#include "tsNullMutex.h"
 #include "tsSysUtils.h"
 #include "tsECMGSCS.h"
 #include "tsTCPServer.h"
@@ -43,9 +42,16 @@
 #include "tsDuckProtocol.h"
 #include "tsVariable.h"
 #include "tsOneShotPacketizer.h"
+#include "tsMonotonic.h"
 TSDUCK_SOURCE;
 TS_MAIN(MainCode);
 
+#if defined(TS_LINUX)
+#include <sys/epoll.h>
+#elif defined(TS_UNIX)
+#include <poll.h>
+#endif
+
 namespace {
     // Command line default arguments.
     static const uint16_t DEFAULT_SERVER_PORT       = 2222;
@@ -54,13 +60,15 @@ namespace {
     static const int16_t  DEFAULT_DELAY_STOP        = 200;
     static const int16_t  DEFAULT_TRANS_DELAY_START = -500;
     static const int16_t  DEFAULT_TRANS_DELAY_STOP  = 0;
+    static const uint16_t DEFAULT_LOAD_CP_DURATION  = 10000;
+    static const size_t   DEFAULT_LOAD_DURATION     = 60;
 
-    // Stack size for execution of the client connection thread
-    static const size_t CLIENT_STACK_SIZE = 128 * 1024;
+    // Many SCS may connect simultaneously, avoid dropping connection requests.
+    static const int SERVER_BACKLOG = 128;
 
-    // Instantiation of a TCP connection in a multi-thread context for TLV messages.
-    typedef ts::tlv::Connection<ts::Mutex> ECMGConnection;
-    typedef ts::SafePtr<ECMGConnection, ts::Mutex> ECMGConnectionPtr;
+    // All connections are managed in one single thread, one event loop.
+    typedef ts::tlv::Connection<ts::NullMutex> ECMGConnection;
+    typedef ts::SafePtr<ECMGConnection, ts::NullMutex> ECMGConnectionPtr;
 }
 
 
@@ -83,6 +91,12 @@ public:
     ts::SocketAddress          serverAddress;  // TCP server local address.
     ts::ecmgscs::ChannelStatus channelStatus;  // Standard parameters required by this ECMG.
     ts::ecmgscs::StreamStatus  streamStatus;   // Standard parameters required by this ECMG.
+    ts::SocketAddress          loadAddress;    // ECMG to load in load generation mode.
+    size_t                     loadChannels;   // Number of channels in load generation mode.
+    size_t                     loadStreams;    // Number of streams per channel in load generation mode.
+    ts::MilliSecond            loadCPDuration; // Crypto-period duration in load generation mode.
+    ts::Second                 loadDuration;   // Test duration in load generation mode.
+    uint32_t                   superCASId;     // Super_CAS_id in load generation mode.
 };
 
 ECMGOptions::ECMGOptions(int argc, char *argv[]) :
@@ -94,7 +108,13 @@ ECMGOptions::ECMGOptions(int argc, char *argv[]) :
     ecmCompTime(0),
     serverAddress(),
     channelStatus(),
-    streamStatus()
+    streamStatus(),
+    loadAddress(),
+    loadChannels(0),
+    loadStreams(0),
+    loadCPDuration(0),
+    loadDuration(0),
+    superCASId(0)
 {
     option(u"ac-delay-start", 0, INT16);
     help(u"ac-delay-start",
@@ -106,12 +126,26 @@ ECMGOptions::ECMGOptions(int argc, char *argv[]) :
          u"This option sets the DVB SimulCrypt option 'AC_delay_stop', in "
          u"milliseconds. By default, use the same value as --delay-stop.");
 
+    option(u"channels", 0, INTEGER, 0, 1, 1, 0xFFFF);
+    help(u"channels",
+         u"With --load, specify the number of ECM channels to open on the ECMG. "
+         u"Each channel uses its own TCP connection. The default is 1.");
+
     option(u"comp-time", 0, UNSIGNED);
     help(u"comp-time",
          u"This option specifies the computation time of an ECM. The clear ECM's "
          u"which are generated by this ECMG take no time to generate. But, in "
          u"order to emulate the behaviour of a real ECMG, this parameter forces "
-         u"a delay of the specified duration before returning an ECM.");
+         u"a delay of the specified duration before returning an ECM. "
+         u"The delay is emulated using timers, the ECMG keeps processing other "
+         u"requests in the meantime.");
+
+    option(u"cp-duration", 0, INTEGER, 0, 1, 100, 0xFFFF);
+    help(u"cp-duration",
+         u"With --load, specify the crypto-period duration in milliseconds. Each stream "
+         u"sends one CW_provision per crypto-period. The provisions of all streams are "
+         u"evenly spread over the crypto-period. "
+         u"Default: " + ts::UString::Decimal(DEFAULT_LOAD_CP_DURATION) + u" ms.");
 
     option(u"cw-per-ecm", 'c', INTEGER, 0, 1, 1, 255);
     help(u"cw-per-ecm",
@@ -130,11 +164,25 @@ ECMGOptions::ECMGOptions(int argc, char *argv[]) :
          u"This option sets the DVB SimulCrypt option 'delay_stop', in milliseconds. "
          u"Default: " + ts::UString::Decimal(DEFAULT_DELAY_STOP, 0, true, u"") + u" ms.");
 
+    option(u"duration", 0, UNSIGNED);
+    help(u"duration",
+         u"With --load, specify the duration of the test in seconds. "
+         u"Default: " + ts::UString::Decimal(DEFAULT_LOAD_DURATION) + u" seconds.");
+
     option(u"ecmg-scs-version", 0, INTEGER, 0, 1, 2, 3);
     help(u"ecmg-scs-version",
          u"Specify the version of the ECMG <=> SCS DVB SimulCrypt protocol. "
          u"Valid values are 2 and 3. The default is 2.");
 
+    option(u"load", 'l', STRING);
+    help(u"load", u"address:port",
+         u"Load generation mode. Instead of running an ECMG, act as a SCS and connect "
+         u"to the ECMG at the specified address. Open the channels and streams as "
+         u"specified by --channels and --streams, send CW_provision messages at the "
+         u"pace of the crypto-periods and report statistics on the round-trip latency "
+         u"between CW_provision and ECM_response. The ECMG can be another instance of "
+         u"this command or any other DVB SimulCrypt ECMG.");
+
     option(u"log-data", 0, ts::Severity::Enums, 0, 1, true);
     help(u"log-data", u"level",
          u"Same as --log-protocol but applies to CW_provision and ECM_response "
@@ -167,6 +215,16 @@ ECMGOptions::ECMGOptions(int argc, char *argv[]) :
          u"This option sets the DVB SimulCrypt option 'ECM_rep_period', the requested "
          u"repetition period of ECM's, in milliseconds. Default: " + ts::UString::Decimal(DEFAULT_REPETITION) + u" ms.");
 
+    option(u"streams", 0, INTEGER, 0, 1, 1, 0xFFFF);
+    help(u"streams",
+         u"With --load, specify the number of ECM streams to open in each channel. "
+         u"The default is 1.");
+
+    option(u"super-cas-id", 0, UINT32);
+    help(u"super-cas-id",
+         u"With --load, specify the DVB SimulCrypt parameter 'Super_CAS_id' which is "
+         u"sent in channel_setup. The default is zero.");
+
     option(u"section-mode", 's');
     help(u"section-mode",
          u"Return ECM's in section format. This option sets the DVB SimulCrypt "
@@ -209,6 +267,17 @@ ECMGOptions::ECMGOptions(int argc, char *argv[]) :
     channelStatus.transition_delay_stop = intValue<int16_t>(u"transition-delay-stop", DEFAULT_TRANS_DELAY_STOP);
     channelStatus.max_comp_time = intValue<uint16_t>(u"max-comp-time", uint16_t(ecmCompTime + 100));
 
+    // Load generation mode.
+    const ts::UString load(value(u"load"));
+    if (!load.empty() && loadAddress.resolve(load, *this) && (!loadAddress.hasAddress() || !loadAddress.hasPort())) {
+        error(u"missing ECMG address or port, use --load address:port");
+    }
+    loadChannels = intValue<size_t>(u"channels", 1);
+    loadStreams = intValue<size_t>(u"streams", 1);
+    loadCPDuration = intValue<ts::MilliSecond>(u"cp-duration", DEFAULT_LOAD_CP_DURATION);
+    loadDuration = intValue<ts::Second>(u"duration", DEFAULT_LOAD_DURATION);
+    superCASId = intValue<uint32_t>(u"super-cas-id", 0);
+
     // Specify which ECMG <=> SCS version to use.
     ts::ecmgscs::Protocol::Instance()->setVersion(protocolVersion);
     channelStatus.forceProtocolVersion(protocolVersion);
@@ -224,7 +293,7 @@ ECMGOptions::ECMGOptions(int argc, char *argv[]) :
 
 
 //----------------------------------------------------------------------------
-// A class implementing the ECMG shared data, used from all threads.
+// A class implementing the ECMG shared data.
 //----------------------------------------------------------------------------
 
 class ECMGSharedData
@@ -247,9 +316,8 @@ public:
     ts::tlv::Logger& logger() { return _logger; }
 
 private:
-    ts::AsyncReport    _report;    // Asynchronous message report.
+    ts::AsyncReport    _report;    // Asynchronous message report, never blocks the event loop.
     ts::tlv::Logger    _logger;    // Protocol message logger.
-    ts::Mutex          _mutex;     // Protect shared data.
     std::set<uint16_t> _channels;  // Active channels.
 };
 
@@ -262,7 +330,6 @@ private:
 ECMGSharedData::ECMGSharedData(const ECMGOptions& opt) :
     _report(opt.maxSeverity()),
     _logger(opt.log_protocol, &_report),
-    _mutex(),
     _channels()
 {
     // The CW/ECM data messages have a distinct log level.
@@ -273,7 +340,6 @@ ECMGSharedData::ECMGSharedData(const ECMGOptions& opt) :
 // Declare a new ECM_channel_id. Return false if already active.
 bool ECMGSharedData::openChannel(uint16_t id)
 {
-    ts::Guard lock(_mutex);
     const bool ok = _channels.count(id) == 0;
     _channels.insert(id);
     return ok;
@@ -282,7 +348,6 @@ bool ECMGSharedData::openChannel(uint16_t id)
 // Release a ECM_channel_id. Return false if not active.
 bool ECMGSharedData::closeChannel(uint16_t id)
 {
-    ts::Guard lock(_mutex);
     const bool ok = _channels.count(id) != 0;
     _channels.erase(id);
     return ok;
@@ -290,26 +355,332 @@ bool ECMGSharedData::closeChannel(uint16_t id)
 
 
 //----------------------------------------------------------------------------
-// A class implementing a thread which manages a client connection.
+// A class which waits for incoming data on a set of sockets.
+// Each socket is associated with an application-defined identifier.
+// Use epoll() on Linux and poll() on other systems.
 //----------------------------------------------------------------------------
 
-class ECMGClientHandler: public ts::Thread
+class SocketPoller
 {
-    TS_NOBUILD_NOCOPY(ECMGClientHandler);
+    TS_NOCOPY(SocketPoller);
 public:
-    // Constructor.
-    // When deleteWhenTerminated is true, this object is automatically deleted
-    // when the thread terminates.
-    ECMGClientHandler(const ECMGOptions& opt, const ECMGConnectionPtr& conn, ECMGSharedData* shared, bool deleteWhenTerminated);
+    // Constructor and destructor.
+    SocketPoller();
+    ~SocketPoller();
+
+    // Add a socket to watch. Return false on error.
+    bool add(TS_SOCKET_T sock, uint64_t id, ts::Report& report);
 
-    // Main code of the thread.
-    virtual void main() override;
+    // Stop watching a socket. Must be called before closing the socket.
+    void remove(TS_SOCKET_T sock);
+
+    // Wait until some sockets are readable or the timeout expires (negative means infinite).
+    // The identifiers of the readable sockets are returned. Return false on error.
+    bool wait(ts::MilliSecond timeout, std::vector<uint64_t>& ready, ts::Report& report);
+
+private:
+#if defined(TS_LINUX)
+    int _epoll;
+    std::vector<::epoll_event> _events;
+#else
+#if defined(TS_WINDOWS)
+    typedef ::WSAPOLLFD PollFD;
+#else
+    typedef ::pollfd PollFD;
+#endif
+    std::vector<PollFD>   _fds;
+    std::vector<uint64_t> _ids;
+#endif
+};
+
+// Constructor.
+SocketPoller::SocketPoller() :
+#if defined(TS_LINUX)
+    _epoll(::epoll_create1(EPOLL_CLOEXEC)),
+    _events(256)
+#else
+    _fds(),
+    _ids()
+#endif
+{
+    // If epoll_create1() failed, the error is reported on the first call to add().
+}
+
+// Destructor.
+SocketPoller::~SocketPoller()
+{
+#if defined(TS_LINUX)
+    if (_epoll >= 0) {
+        ::close(_epoll);
+    }
+#endif
+}
+
+// Add a socket to watch.
+bool SocketPoller::add(TS_SOCKET_T sock, uint64_t id, ts::Report& report)
+{
+#if defined(TS_LINUX)
+    ::epoll_event ev;
+    TS_ZERO(ev);
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.u64 = id;
+    if (::epoll_ctl(_epoll, EPOLL_CTL_ADD, sock, &ev) < 0) {
+        report.error(u"epoll_ctl() error: %s", {ts::ErrorCodeMessage()});
+        return false;
+    }
+#else
+    PollFD pfd;
+    TS_ZERO(pfd);
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    _fds.push_back(pfd);
+    _ids.push_back(id);
+#endif
+    return true;
+}
+
+// Stop watching a socket.
+void SocketPoller::remove(TS_SOCKET_T sock)
+{
+#if defined(TS_LINUX)
+    ::epoll_event ev;
+    TS_ZERO(ev);
+    ::epoll_ctl(_epoll, EPOLL_CTL_DEL, sock, &ev);
+#else
+    for (size_t i = 0; i < _fds.size(); ++i) {
+        if (_fds[i].fd == sock) {
+            _fds.erase(_fds.begin() + i);
+            _ids.erase(_ids.begin() + i);
+            break;
+        }
+    }
+#endif
+}
+
+// Wait until some sockets are readable.
+bool SocketPoller::wait(ts::MilliSecond timeout, std::vector<uint64_t>& ready, ts::Report& report)
+{
+    ready.clear();
+    const int tmo = timeout < 0 ? -1 : int(std::min<ts::MilliSecond>(timeout, std::numeric_limits<int>::max()));
+#if defined(TS_LINUX)
+    const int count = ::epoll_wait(_epoll, _events.data(), int(_events.size()), tmo);
+    for (int i = 0; i < count; ++i) {
+        ready.push_back(_events[i].data.u64);
+    }
+#elif defined(TS_WINDOWS)
+    const int count = ::WSAPoll(_fds.data(), ULONG(_fds.size()), tmo);
+#else
+    const int count = ::poll(_fds.data(), ::nfds_t(_fds.size()), tmo);
+#endif
+#if !defined(TS_LINUX)
+    for (size_t i = 0; count > 0 && i < _fds.size(); ++i) {
+        if (_fds[i].revents != 0) {
+            ready.push_back(_ids[i]);
+        }
+    }
+#endif
+    if (count < 0 && ts::LastSocketErrorCode() != EINTR) {
+        report.error(u"error waiting for sockets: %s", {ts::SocketErrorCodeMessage(ts::LastSocketErrorCode())});
+        return false;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// A timer wheel: schedule a large number of events with a bounded resolution.
+// Scheduling and expiring a timer are constant-time operations.
+//----------------------------------------------------------------------------
+
+template <typename T>
+class TimerWheel
+{
+    TS_NOCOPY(TimerWheel);
+public:
+    // Constructor: duration of a tick and number of slots in the wheel.
+    TimerWheel(ts::MilliSecond resolution = 1, size_t slots = 1024);
+
+    // Check if there is no pending timer.
+    bool empty() const { return _count == 0; }
+
+    // Schedule a timer. A timer in the past expires at the next call to expire().
+    void schedule(const ts::Monotonic& due, const T& data);
+
+    // Number of milliseconds until the next timer expires, -1 if there is no timer.
+    ts::MilliSecond nextTimeout(const ts::Monotonic& now) const;
+
+    // Extract all expired timers.
+    void expire(const ts::Monotonic& now, std::list<T>& expired);
+
+private:
+    struct Timer
+    {
+        uint64_t tick;
+        T        data;
+        Timer(uint64_t t, const T& d) : tick(t), data(d) {}
+    };
+
+    const ts::NanoSecond          _resolution;  // Duration of a tick.
+    const ts::Monotonic           _origin;      // Time of tick zero.
+    uint64_t                      _current;     // First tick which was not yet processed.
+    size_t                        _count;       // Number of pending timers.
+    std::vector<std::list<Timer>> _slots;       // Slot i contains the timers for all ticks t where t % slots == i.
+
+    // Compute the tick of a time.
+    uint64_t tickOf(const ts::Monotonic& time, bool roundUp) const;
+};
+
+// Constructor.
+template <typename T>
+TimerWheel<T>::TimerWheel(ts::MilliSecond resolution, size_t slots) :
+    _resolution(std::max<ts::MilliSecond>(resolution, 1) * ts::NanoSecPerMilliSec),
+    _origin(true),
+    _current(0),
+    _count(0),
+    _slots(std::max<size_t>(slots, 1))
+{
+}
+
+// Compute the tick of a time.
+template <typename T>
+uint64_t TimerWheel<T>::tickOf(const ts::Monotonic& time, bool roundUp) const
+{
+    const ts::NanoSecond ns = time - _origin;
+    return ns <= 0 ? 0 : uint64_t((ns + (roundUp ? _resolution - 1 : 0)) / _resolution);
+}
+
+// Schedule a timer.
+template <typename T>
+void TimerWheel<T>::schedule(const ts::Monotonic& due, const T& data)
+{
+    const uint64_t tick = std::max(_current, tickOf(due, true));
+    _slots[tick % _slots.size()].push_back(Timer(tick, data));
+    _count++;
+}
+
+// Number of milliseconds until the next timer expires.
+template <typename T>
+ts::MilliSecond TimerWheel<T>::nextTimeout(const ts::Monotonic& now) const
+{
+    if (_count == 0) {
+        return -1;
+    }
+    // Locate the first non-empty slot. It may contain timers for the next turns only,
+    // in which case we wake up too early, which is harmless.
+    uint64_t tick = _current;
+    while (tick < _current + _slots.size() && _slots[tick % _slots.size()].empty()) {
+        ++tick;
+    }
+    const ts::NanoSecond delay = ts::NanoSecond(tick) * _resolution - (now - _origin);
+    return delay <= 0 ? 0 : (delay + ts::NanoSecPerMilliSec - 1) / ts::NanoSecPerMilliSec;
+}
+
+// Extract all expired timers.
+template <typename T>
+void TimerWheel<T>::expire(const ts::Monotonic& now, std::list<T>& expired)
+{
+    const uint64_t now_tick = tickOf(now, false);
+    if (_count > 0 && now_tick >= _current) {
+        // After a long idle period, one turn of the wheel is enough.
+        const uint64_t last = std::min<uint64_t>(now_tick, _current + _slots.size() - 1);
+        for (uint64_t tick = _current; _count > 0 && tick <= last; ++tick) {
+            std::list<Timer>& slot(_slots[tick % _slots.size()]);
+            for (auto it = slot.begin(); it != slot.end(); ) {
+                if (it->tick <= now_tick) {
+                    expired.push_back(it->data);
+                    it = slot.erase(it);
+                    _count--;
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+    }
+    _current = std::max(_current, now_tick + 1);
+}
+
+
+//----------------------------------------------------------------------------
+// The ECMG server: one event loop for all client connections.
+//----------------------------------------------------------------------------
+
+class ECMGSession;
+
+class ECMGServer
+{
+    TS_NOBUILD_NOCOPY(ECMGServer);
+public:
+    // Constructor and destructor.
+    ECMGServer(const ECMGOptions& opt, ECMGSharedData* shared);
+    ~ECMGServer();
+
+    // Run the event loop. Return false on error.
+    bool run();
+
+    // Schedule an ECM response to be sent later to a session.
+    void scheduleResponse(uint64_t session, const ts::tlv::MessagePtr& msg, ts::MilliSecond delay);
+
+private:
+    // An ECM response waiting for its emulated computation time.
+    struct PendingResponse
+    {
+        uint64_t            session;
+        ts::tlv::MessagePtr msg;
+        PendingResponse(uint64_t s, const ts::tlv::MessagePtr& m) : session(s), msg(m) {}
+    };
+
+    // Identifier of the listening socket in the poller. Sessions start at 1.
+    static constexpr uint64_t LISTENER_ID = 0;
+
+    const ECMGOptions&               _opt;
+    ECMGSharedData*                  _shared;
+    ts::TCPServer                    _server;
+    SocketPoller                     _poller;
+    TimerWheel<PendingResponse>      _timers;
+    std::map<uint64_t, ECMGSession*> _sessions;
+    uint64_t                         _next_id;
+    bool                             _terminate;
+
+    // Accept a new client connection.
+    bool acceptSession();
+
+    // Close and delete a session.
+    void closeSession(uint64_t id);
+};
+
+
+//----------------------------------------------------------------------------
+// A class which manages one client connection.
+//----------------------------------------------------------------------------
+
+class ECMGSession
+{
+    TS_NOBUILD_NOCOPY(ECMGSession);
+public:
+    // Constructor and destructor.
+    ECMGSession(const ECMGOptions& opt, ECMGServer& server, ECMGSharedData* shared, const ECMGConnectionPtr& conn, uint64_t id);
+    ~ECMGSession();
+
+    // Get the connection.
+    ECMGConnection& connection() { return *_conn; }
+
+    // Process all available incoming messages. Return false when the session must be closed.
+    bool receive();
+
+    // Send a response message.
+    bool send(const ts::tlv::Message* msg)
+    {
+        return _conn->send(*msg, _shared->logger());
+    }
 
 private:
     const ECMGOptions&          _opt;
+    ECMGServer&                 _server;
     ECMGSharedData*             _shared;
     ECMGConnectionPtr           _conn;
-    ts::UString                 _peer;
+    const uint64_t              _id;
+    const ts::UString           _peer;
     ts::Variable<uint16_t>      _channel;  // Current channel id.
     std::map<uint16_t,uint16_t> _streams;  // Map of current stream id => ECM id.
 
@@ -322,62 +693,196 @@ private:
     bool handleStreamCloseRequest(ts::ecmgscs::StreamCloseRequest* msg);
     bool handleCWProvision(ts::ecmgscs::CWProvision* msg);
 
-    // Send a response message.
-    bool send(const ts::tlv::Message* msg)
-    {
-        return _conn->send(*msg, _shared->logger());
-    }
-
     // Send an error related to the msg.
     bool sendErrorResponse(const ts::tlv::Message* msg, uint16_t errorStatus);
+};
 
-    // Format a timestamp.
-    static ts::UString TimeStamp()
+// Format a timestamp.
+namespace {
+    ts::UString TimeStamp()
     {
         return ts::Time::CurrentLocalTime().format(ts::Time::DATE | ts::Time::TIME);
     }
-};
+}
+
+
+//----------------------------------------------------------------------------
+// ECMG server implementation.
+//----------------------------------------------------------------------------
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr uint64_t ECMGServer::LISTENER_ID;
+#endif
+
+ECMGServer::ECMGServer(const ECMGOptions& opt, ECMGSharedData* shared) :
+    _opt(opt),
+    _shared(shared),
+    _server(),
+    _poller(),
+    _timers(),
+    _sessions(),
+    _next_id(LISTENER_ID + 1),
+    _terminate(false)
+{
+}
+
+ECMGServer::~ECMGServer()
+{
+    while (!_sessions.empty()) {
+        closeSession(_sessions.begin()->first);
+    }
+    _server.close(NULLREP);
+}
+
+// Schedule an ECM response to be sent later to a session.
+void ECMGServer::scheduleResponse(uint64_t session, const ts::tlv::MessagePtr& msg, ts::MilliSecond delay)
+{
+    ts::Monotonic due(true);
+    due += delay * ts::NanoSecPerMilliSec;
+    _timers.schedule(due, PendingResponse(session, msg));
+}
+
+// Event loop.
+bool ECMGServer::run()
+{
+    ts::Report& report(_shared->report());
+
+    // Initialize the TCP server.
+    if (!_server.open(report) ||
+        !_server.reusePort(_opt.reusePort, report) ||
+        !_server.bind(_opt.serverAddress, report) ||
+        !_server.listen(SERVER_BACKLOG, report) ||
+        !_poller.add(_server.getSocket(), LISTENER_ID, report))
+    {
+        return false;
+    }
+    report.verbose(u"TCP server listening on %s, using ECMG <=> SCS protocol version %d",
+                   {_opt.serverAddress, ts::ecmgscs::Protocol::Instance()->version()});
+
+    std::vector<uint64_t> ready;
+    std::list<PendingResponse> expired;
+
+    while (!_terminate) {
+
+        // Wait for incoming messages or the end of an ECM computation time.
+        if (!_poller.wait(_timers.nextTimeout(ts::Monotonic(true)), ready, report)) {
+            return false;
+        }
+
+        // Process incoming connections and messages.
+        for (auto id : ready) {
+            if (id == LISTENER_ID) {
+                if (!acceptSession()) {
+                    return false;
+                }
+            }
+            else {
+                const auto it = _sessions.find(id);
+                if (it != _sessions.end() && !it->second->receive()) {
+                    closeSession(id);
+                }
+            }
+        }
+
+        // Send the ECM's which are ready.
+        expired.clear();
+        _timers.expire(ts::Monotonic(true), expired);
+        for (const auto& resp : expired) {
+            // Ignore responses to sessions which were closed in the meantime.
+            const auto it = _sessions.find(resp.session);
+            if (it != _sessions.end() && !it->second->send(resp.msg.pointer())) {
+                closeSession(resp.session);
+            }
+        }
+    }
+    return true;
+}
+
+// Accept a new client connection.
+bool ECMGServer::acceptSession()
+{
+    ts::SocketAddress clientAddress;
+    ECMGConnectionPtr conn(new ECMGConnection(ts::ecmgscs::Protocol::Instance(), true, 3));
+    ts::CheckNonNull(conn.pointer());
+    if (!_server.accept(*conn, clientAddress, _shared->report())) {
+        return false;
+    }
+
+    // Small response messages must be sent immediately.
+    const uint64_t id = _next_id++;
+    if (!conn->setNoDelay(true, _shared->report()) || !_poller.add(conn->getSocket(), id, _shared->report())) {
+        conn->close(_shared->report());
+        return true;
+    }
+    _sessions[id] = new ECMGSession(_opt, *this, _shared, conn, id);
+
+    // With --once, do not accept any other client.
+    if (_opt.once) {
+        _poller.remove(_server.getSocket());
+    }
+    return true;
+}
+
+// Close and delete a session.
+void ECMGServer::closeSession(uint64_t id)
+{
+    const auto it = _sessions.find(id);
+    if (it != _sessions.end()) {
+        _poller.remove(it->second->connection().getSocket());
+        delete it->second;
+        _sessions.erase(it);
+        // With --once, exit at the end of the session.
+        _terminate = _opt.once;
+    }
+}
 
 
 //----------------------------------------------------------------------------
-// ECMG client constructor.
+// ECMG session constructor and destructor.
 //----------------------------------------------------------------------------
 
-ECMGClientHandler::ECMGClientHandler(const ECMGOptions& opt, const ECMGConnectionPtr& conn, ECMGSharedData* shared, bool deleteWhenTerminated) :
-    ts::Thread(),
+ECMGSession::ECMGSession(const ECMGOptions& opt, ECMGServer& server, ECMGSharedData* shared, const ECMGConnectionPtr& conn, uint64_t id) :
     _opt(opt),
+    _server(server),
     _shared(shared),
     _conn(conn),
-    _peer(),
+    _id(id),
+    _peer(conn->peerName()),
     _channel(),
     _streams()
 {
-    // Set thread attributes. Beware of deleteWhenTerminated...
-    ts::ThreadAttributes attr;
-    attr.setStackSize(CLIENT_STACK_SIZE);
-    attr.setDeleteWhenTerminated(deleteWhenTerminated);
-    setAttributes(attr);
+    _shared->report().verbose(u"%s: %s: session started", {_peer, TimeStamp()});
+}
+
+ECMGSession::~ECMGSession()
+{
+    // Error while receiving or sending messages, most likely a client disconnection.
+    _conn->disconnect(NULLREP);
+    _conn->close(_shared->report());
+
+    // Make sure to release the channel if not done by the clients.
+    if (_channel.set()) {
+        _shared->closeChannel(_channel.value());
+        _channel.reset();
+    }
+
+    _shared->report().verbose(u"%s: %s: session completed", {_peer, TimeStamp()});
 }
 
 
 //----------------------------------------------------------------------------
-// Main code of the client connection thread.
+// Process all available incoming messages.
 //----------------------------------------------------------------------------
 
-void ECMGClientHandler::main()
+bool ECMGSession::receive()
 {
-    _peer = _conn->peerName();
-    _shared->report().verbose(u"%s: %s: session started", {_peer, TimeStamp()});
+    // We never send any request to the client and the ECM generation is instantaneous
+    // or deferred by the event loop. So, we simply respond to all received requests.
+    std::list<ts::tlv::MessagePtr> msgs;
+    bool ok = _conn->receiveAvailable(msgs, _shared->logger());
 
-    // Normally, an ECMG should handle incoming and outgoing messages independently.
-    // However, here we have a minimal implementation. We never send any request to
-    // the client and the ECM generation is instantaneous. So, we simply wait for
-    // requests from the client and respond to them immediately.
-
-    // Loop on message reception
-    ts::tlv::MessagePtr msg;
-    bool ok = true;
-    while (ok && _conn->receive(msg, nullptr, _shared->logger())) {
+    for (auto it = msgs.begin(); ok && it != msgs.end(); ++it) {
+        ts::tlv::MessagePtr& msg(*it);
         switch (msg->tag()) {
             case ts::ecmgscs::Tags::channel_setup:
                 ok = handleChannelSetup(dynamic_cast<ts::ecmgscs::ChannelSetup*>(msg.pointer()));
@@ -412,18 +917,7 @@ void ECMGClientHandler::main()
                 break;
         }
     }
-
-    // Error while receiving or sending messages, most likely a client disconnection.
-    _conn->disconnect(NULLREP);
-    _conn->close(_shared->report());
-
-    // Make sure to release the channel if not done by the clients.
-    if (_channel.set()) {
-        _shared->closeChannel(_channel.value());
-        _channel.reset();
-    }
-
-    _shared->report().verbose(u"%s: %s: session completed", {_peer, TimeStamp()});
+    return ok;
 }
 
 
@@ -431,7 +925,7 @@ void ECMGClientHandler::main()
 // Send an error related to the msg.
 //----------------------------------------------------------------------------
 
-bool ECMGClientHandler::sendErrorResponse(const ts::tlv::Message* msg, uint16_t errorStatus)
+bool ECMGSession::sendErrorResponse(const ts::tlv::Message* msg, uint16_t errorStatus)
 {
     const ts::tlv::ChannelMessage* channelMsg = nullptr;
     const ts::tlv::StreamMessage* streamMsg = nullptr;
@@ -469,7 +963,7 @@ bool ECMGClientHandler::sendErrorResponse(const ts::tlv::Message* msg, uint16_t
 // Handle the various types of messages from the client.
 //----------------------------------------------------------------------------
 
-bool ECMGClientHandler::handleChannelSetup(ts::ecmgscs::ChannelSetup* msg)
+bool ECMGSession::handleChannelSetup(ts::ecmgscs::ChannelSetup* msg)
 {
     assert(msg != nullptr);
     if (_channel.set()) {
@@ -490,7 +984,7 @@ bool ECMGClientHandler::handleChannelSetup(ts::ecmgscs::ChannelSetup* msg)
 }
 
 
-bool ECMGClientHandler::handleChannelTest(ts::ecmgscs::ChannelTest* msg)
+bool ECMGSession::handleChannelTest(ts::ecmgscs::ChannelTest* msg)
 {
     assert(msg != nullptr);
     if (_channel != msg->channel_id) {
@@ -507,7 +1001,7 @@ bool ECMGClientHandler::handleChannelTest(ts::ecmgscs::ChannelTest* msg)
 }
 
 
-bool ECMGClientHandler::handleChannelClose(ts::ecmgscs::ChannelClose* msg)
+bool ECMGSession::handleChannelClose(ts::ecmgscs::ChannelClose* msg)
 {
     assert(msg != nullptr);
     if (_channel != msg->channel_id) {
@@ -524,7 +1018,7 @@ bool ECMGClientHandler::handleChannelClose(ts::ecmgscs::ChannelClose* msg)
 }
 
 
-bool ECMGClientHandler::handleStreamSetup(ts::ecmgscs::StreamSetup* msg)
+bool ECMGSession::handleStreamSetup(ts::ecmgscs::StreamSetup* msg)
 {
     assert(msg != nullptr);
     if (_channel != msg->channel_id) {
@@ -547,7 +1041,7 @@ bool ECMGClientHandler::handleStreamSetup(ts::ecmgscs::StreamSetup* msg)
 }
 
 
-bool ECMGClientHandler::handleStreamTest(ts::ecmgscs::StreamTest* msg)
+bool ECMGSession::handleStreamTest(ts::ecmgscs::StreamTest* msg)
 {
     assert(msg != nullptr);
     if (_channel != msg->channel_id) {
@@ -569,7 +1063,7 @@ bool ECMGClientHandler::handleStreamTest(ts::ecmgscs::StreamTest* msg)
 }
 
 
-bool ECMGClientHandler::handleStreamCloseRequest(ts::ecmgscs::StreamCloseRequest* msg)
+bool ECMGSession::handleStreamCloseRequest(ts::ecmgscs::StreamCloseRequest* msg)
 {
     assert(msg != nullptr);
     if (_channel != msg->channel_id) {
@@ -591,7 +1085,7 @@ bool ECMGClientHandler::handleStreamCloseRequest(ts::ecmgscs::StreamCloseRequest
 }
 
 
-bool ECMGClientHandler::handleCWProvision(ts::ecmgscs::CWProvision* msg)
+bool ECMGSession::handleCWProvision(ts::ecmgscs::CWProvision* msg)
 {
     assert(msg != nullptr);
     if (_channel != msg->channel_id) {
@@ -608,10 +1102,11 @@ bool ECMGClientHandler::handleCWProvision(ts::ecmgscs::CWProvision* msg)
     }
     else {
         // Start to build the response.
-        ts::ecmgscs::ECMResponse resp;
-        resp.channel_id = msg->channel_id;
-        resp.stream_id = msg->stream_id;
-        resp.CP_number = msg->CP_number;
+        ts::ecmgscs::ECMResponse* resp = new ts::ecmgscs::ECMResponse;
+        ts::tlv::MessagePtr respPtr(resp);
+        resp->channel_id = msg->channel_id;
+        resp->stream_id = msg->stream_id;
+        resp->CP_number = msg->CP_number;
 
         // Add all CW's in the ECM (in the clear, yeah, but that's a fake/test ECMG).
         ts::duck::ClearECM ecm;
@@ -658,73 +1153,488 @@ bool ECMGClientHandler::handleCWProvision(ts::ecmgscs::CWProvision* msg)
             zer.addSection(ecmSection);
             zer.getPackets(ecmPackets);
             if (!ecmPackets.empty()) {
-                resp.ECM_datagram.copy(ecmPackets[0].b, ecmPackets.size() * ts::PKT_SIZE);
+                resp->ECM_datagram.copy(ecmPackets[0].b, ecmPackets.size() * ts::PKT_SIZE);
             }
         }
         else {
             // Send ECM as a section.
-            resp.ECM_datagram.copy(ecmSection->content(), ecmSection->size());
+            resp->ECM_datagram.copy(ecmSection->content(), ecmSection->size());
         }
 
-        // Emulate the computation time of a real ECMG.
+        // Emulate the computation time of a real ECMG: the response is sent later by the event loop.
         if (_opt.ecmCompTime > 0) {
-            ts::SleepThread(_opt.ecmCompTime);
+            _server.scheduleResponse(_id, respPtr, _opt.ecmCompTime);
+            return true;
         }
-
-        return send(&resp);
+        return send(resp);
     }
 }
 
 
 //----------------------------------------------------------------------------
-//  Program entry point
+// Load generation mode: act as a SCS with many channels and streams.
 //----------------------------------------------------------------------------
 
-int MainCode(int argc, char *argv[])
+class ECMGLoad
 {
-    ECMGOptions opt(argc, argv);
+    TS_NOBUILD_NOCOPY(ECMGLoad);
+public:
+    // Constructor and destructor.
+    ECMGLoad(const ECMGOptions& opt, ECMGSharedData* shared);
+    ~ECMGLoad();
 
-    // Create ECMG shared data (including the asynchronous report).
-    ECMGSharedData shared(opt);
+    // Run the load test and display the statistics. Return false on error.
+    bool run();
 
-    // Initialize a TCP server.
-    ts::TCPServer server;
-    if (!server.open(shared.report()) ||
-        !server.reusePort(opt.reusePort, shared.report()) ||
-        !server.bind(opt.serverAddress, shared.report()) ||
-        !server.listen(5, shared.report()))
+private:
+    // Description of one ECM channel, one TCP connection per channel.
+    struct Channel
+    {
+        ECMGConnectionPtr conn;
+        uint16_t          channel_id;
+        uint8_t           cw_per_msg;
+        uint8_t           lead_cw;
+        Channel() : conn(), channel_id(0), cw_per_msg(0), lead_cw(0) {}
+    };
+
+    // Description of one ECM stream.
+    struct Stream
     {
-        return EXIT_FAILURE;
+        size_t        channel;      // Index in _channels.
+        uint16_t      stream_id;
+        uint16_t      ECM_id;
+        bool          active;       // Stream setup completed.
+        uint16_t      next_cp;      // Next CP number to request.
+        ts::Monotonic next_time;    // Time of next CW_provision.
+        std::map<uint16_t, ts::Monotonic> pending;  // CP number => time of CW_provision.
+        Stream() : channel(0), stream_id(0), ECM_id(0), active(false), next_cp(0), next_time(), pending() {}
+    };
+
+    // Grace period after the end of the test for the last responses.
+    static constexpr ts::MilliSecond GRACE_PERIOD = 1000;
+
+    const ECMGOptions&          _opt;
+    ECMGSharedData*             _shared;
+    SocketPoller                _poller;
+    TimerWheel<size_t>          _timers;     // Index of stream for the next CW_provision.
+    std::vector<Channel>        _channels;
+    std::vector<Stream>         _streams;    // Streams of channel i are [i * loadStreams, (i+1) * loadStreams).
+    std::vector<ts::NanoSecond> _latencies;  // ECM response times.
+    ts::Monotonic               _end_time;   // End of CW_provision generation.
+    uint64_t                    _requests;
+    uint64_t                    _errors;
+    uint64_t                    _unexpected;
+
+    // Process incoming messages on a channel. Return false if the channel is broken.
+    bool receive(size_t chan);
+
+    // Send a CW_provision on a stream and reschedule the next one.
+    bool provision(size_t strm);
+
+    // Find a stream from a received message, return _streams.size() if not found.
+    size_t findStream(size_t chan, const ts::tlv::Message* msg) const;
+
+    // Close all streams and channels.
+    void closeAll();
+
+    // Display the statistics.
+    void displayStatistics() const;
+};
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr ts::MilliSecond ECMGLoad::GRACE_PERIOD;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Load generation constructor and destructor.
+//----------------------------------------------------------------------------
+
+ECMGLoad::ECMGLoad(const ECMGOptions& opt, ECMGSharedData* shared) :
+    _opt(opt),
+    _shared(shared),
+    _poller(),
+    _timers(),
+    _channels(opt.loadChannels),
+    _streams(opt.loadChannels * opt.loadStreams),
+    _latencies(),
+    _end_time(),
+    _requests(0),
+    _errors(0),
+    _unexpected(0)
+{
+}
+
+ECMGLoad::~ECMGLoad()
+{
+    closeAll();
+}
+
+
+//----------------------------------------------------------------------------
+// Run the load test.
+//----------------------------------------------------------------------------
+
+bool ECMGLoad::run()
+{
+    ts::Report& report(_shared->report());
+    report.verbose(u"simulating %d channels, %d streams per channel on ECMG %s", {_channels.size(), _opt.loadStreams, _opt.loadAddress});
+
+    // Open all channels. All CW_provision will be generated after the channel and stream setup.
+    for (size_t chan = 0; chan < _channels.size(); ++chan) {
+        Channel& ch(_channels[chan]);
+        ch.channel_id = uint16_t(chan + 1);
+        ch.conn = new ECMGConnection(ts::ecmgscs::Protocol::Instance(), true, 3);
+        ts::CheckNonNull(ch.conn.pointer());
+
+        // Flawfinder: ignore: this is our open(), not ::open().
+        if (!ch.conn->open(report) ||
+            !ch.conn->setNoDelay(true, report) ||
+            !ch.conn->connect(_opt.loadAddress, report) ||
+            !_poller.add(ch.conn->getSocket(), chan, report))
+        {
+            return false;
+        }
+
+        ts::ecmgscs::ChannelSetup setup;
+        setup.channel_id = ch.channel_id;
+        setup.Super_CAS_id = _opt.superCASId;
+        if (!ch.conn->send(setup, _shared->logger())) {
+            return false;
+        }
+
+        for (size_t i = 0; i < _opt.loadStreams; ++i) {
+            Stream& st(_streams[chan * _opt.loadStreams + i]);
+            st.channel = chan;
+            st.stream_id = uint16_t(i + 1);
+            st.ECM_id = uint16_t(chan * _opt.loadStreams + i + 1);
+        }
     }
-    shared.report().verbose(u"TCP server listening on %s, using ECMG <=> SCS protocol version %d",
-                            {opt.serverAddress, ts::ecmgscs::Protocol::Instance()->version()});
 
-    // Manage incoming client connections.
+    _end_time.getSystemTime();
+    _end_time += _opt.loadDuration * ts::NanoSecPerSec;
+    ts::Monotonic grace_end(_end_time);
+    grace_end += GRACE_PERIOD * ts::NanoSecPerMilliSec;
+
+    std::vector<uint64_t> ready;
+    std::list<size_t> expired;
+
     for (;;) {
+        const ts::Monotonic now(true);
 
-        // Accept one incoming connection.
-        ts::SocketAddress clientAddress;
-        ECMGConnectionPtr conn(new ECMGConnection(ts::ecmgscs::Protocol::Instance(), true, 3));
-        ts::CheckNonNull(conn.pointer());
-        if (!server.accept(*conn, clientAddress, shared.report())) {
+        // Stop when all responses are received after the end of the test or after the grace period.
+        if (now >= grace_end) {
             break;
         }
+        else if (now >= _end_time) {
+            bool pending = false;
+            for (size_t i = 0; !pending && i < _streams.size(); ++i) {
+                pending = !_streams[i].pending.empty();
+            }
+            if (!pending) {
+                break;
+            }
+        }
+
+        // Wait for responses or next CW_provision, never after the end of the test.
+        ts::MilliSecond timeout = _timers.nextTimeout(now);
+        const ts::MilliSecond remain = ((now < _end_time ? _end_time : grace_end) - now + ts::NanoSecPerMilliSec - 1) / ts::NanoSecPerMilliSec;
+        if (timeout < 0 || timeout > remain) {
+            timeout = remain;
+        }
+        if (!_poller.wait(timeout, ready, report)) {
+            return false;
+        }
+
+        // Process incoming messages.
+        for (auto chan : ready) {
+            if (!receive(size_t(chan))) {
+                return false;
+            }
+        }
+
+        // Send the CW_provision which are due.
+        expired.clear();
+        _timers.expire(ts::Monotonic(true), expired);
+        for (auto strm : expired) {
+            if (!provision(strm)) {
+                return false;
+            }
+        }
+    }
+
+    closeAll();
+    displayStatistics();
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Find a stream from a received message.
+//----------------------------------------------------------------------------
+
+size_t ECMGLoad::findStream(size_t chan, const ts::tlv::Message* msg) const
+{
+    const ts::tlv::StreamMessage* smsg = dynamic_cast<const ts::tlv::StreamMessage*>(msg);
+    if (smsg != nullptr && smsg->channel_id == _channels[chan].channel_id && smsg->stream_id >= 1 && smsg->stream_id <= _opt.loadStreams) {
+        return chan * _opt.loadStreams + smsg->stream_id - 1;
+    }
+    else {
+        return _streams.size();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Process incoming messages on a channel.
+//----------------------------------------------------------------------------
+
+bool ECMGLoad::receive(size_t chan)
+{
+    Channel& ch(_channels[chan]);
+    std::list<ts::tlv::MessagePtr> msgs;
+    if (!ch.conn->receiveAvailable(msgs, _shared->logger())) {
+        _shared->report().error(u"channel %d: connection lost", {ch.channel_id});
+        return false;
+    }
+
+    for (const auto& msg : msgs) {
+        const size_t strm = findStream(chan, msg.pointer());
+        switch (msg->tag()) {
+            case ts::ecmgscs::Tags::channel_status: {
+                // Channel is set up, now set up all streams.
+                const ts::ecmgscs::ChannelStatus* status = dynamic_cast<const ts::ecmgscs::ChannelStatus*>(msg.pointer());
+                assert(status != nullptr);
+                if (ch.cw_per_msg == 0) {
+                    ch.cw_per_msg = std::max<uint8_t>(status->CW_per_msg, 1);
+                    ch.lead_cw = std::min<uint8_t>(status->lead_CW, ch.cw_per_msg - 1);
+                    for (size_t i = 0; i < _opt.loadStreams; ++i) {
+                        const Stream& st(_streams[chan * _opt.loadStreams + i]);
+                        ts::ecmgscs::StreamSetup setup;
+                        setup.channel_id = ch.channel_id;
+                        setup.stream_id = st.stream_id;
+                        setup.ECM_id = st.ECM_id;
+                        setup.nominal_CP_duration = uint16_t(_opt.loadCPDuration / 100);
+                        if (!ch.conn->send(setup, _shared->logger())) {
+                            return false;
+                        }
+                    }
+                }
+                break;
+            }
+            case ts::ecmgscs::Tags::stream_status: {
+                // Stream is set up, start the CW_provision sequence. Spread all streams over the crypto-period.
+                if (strm < _streams.size() && !_streams[strm].active) {
+                    Stream& st(_streams[strm]);
+                    st.active = true;
+                    st.next_time.getSystemTime();
+                    st.next_time += (_opt.loadCPDuration * ts::NanoSecPerMilliSec * ts::NanoSecond(strm)) / ts::NanoSecond(_streams.size());
+                    _timers.schedule(st.next_time, strm);
+                }
+                break;
+            }
+            case ts::ecmgscs::Tags::ECM_response: {
+                // Compute the response time for the corresponding CW_provision.
+                const ts::ecmgscs::ECMResponse* resp = dynamic_cast<const ts::ecmgscs::ECMResponse*>(msg.pointer());
+                assert(resp != nullptr);
+                if (strm < _streams.size()) {
+                    auto it = _streams[strm].pending.find(resp->CP_number);
+                    if (it != _streams[strm].pending.end()) {
+                        _latencies.push_back(ts::Monotonic(true) - it->second);
+                        _streams[strm].pending.erase(it);
+                        break;
+                    }
+                }
+                _unexpected++;
+                break;
+            }
+            case ts::ecmgscs::Tags::channel_error:
+            case ts::ecmgscs::Tags::stream_error: {
+                _errors++;
+                _shared->report().error(u"channel %d: received error from ECMG", {ch.channel_id});
+                break;
+            }
+            case ts::ecmgscs::Tags::channel_test: {
+                ts::ecmgscs::ChannelStatus status;
+                status.channel_id = ch.channel_id;
+                status.CW_per_msg = ch.cw_per_msg;
+                status.lead_CW = ch.lead_cw;
+                if (!ch.conn->send(status, _shared->logger())) {
+                    return false;
+                }
+                break;
+            }
+            case ts::ecmgscs::Tags::stream_close_response: {
+                if (strm < _streams.size()) {
+                    _streams[strm].active = false;
+                }
+                break;
+            }
+            default: {
+                // Ignore other messages.
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Send a CW_provision on a stream and reschedule the next one.
+//----------------------------------------------------------------------------
+
+bool ECMGLoad::provision(size_t strm)
+{
+    Stream& st(_streams[strm]);
+    Channel& ch(_channels[st.channel]);
+    if (st.next_time >= _end_time) {
+        return true;
+    }
+
+    // Build a CW_provision with the current and next CW's. The content of the CW's is irrelevant.
+    ts::ecmgscs::CWProvision msg;
+    msg.channel_id = ch.channel_id;
+    msg.stream_id = st.stream_id;
+    msg.CP_number = st.next_cp;
+    const uint16_t first_cp = uint16_t(st.next_cp - (ch.cw_per_msg - 1 - ch.lead_cw));
+    for (uint16_t i = 0; i < ch.cw_per_msg; ++i) {
+        uint8_t cw[8];
+        ts::PutUInt16(cw, st.ECM_id);
+        ts::PutUInt16(cw + 2, uint16_t(first_cp + i));
+        ts::PutUInt32(cw + 4, 0xDEADBEEF);
+        msg.CP_CW_combination.push_back(ts::ecmgscs::CPCWCombination(uint16_t(first_cp + i), cw, sizeof(cw)));
+    }
+
+    // A CW_provision without response is lost, its previous send time is overwritten.
+    st.pending[st.next_cp] = ts::Monotonic(true);
+    _requests++;
+    st.next_cp++;
+
+    // Schedule next CW_provision, without drift.
+    st.next_time += _opt.loadCPDuration * ts::NanoSecPerMilliSec;
+    _timers.schedule(st.next_time, strm);
+
+    return ch.conn->send(msg, _shared->logger());
+}
+
+
+//----------------------------------------------------------------------------
+// Close all streams and channels.
+//----------------------------------------------------------------------------
+
+void ECMGLoad::closeAll()
+{
+    // Close all active streams.
+    bool closing = false;
+    for (auto& st : _streams) {
+        Channel& ch(_channels[st.channel]);
+        if (st.active && !ch.conn.isNull() && ch.conn->isConnected()) {
+            ts::ecmgscs::StreamCloseRequest req;
+            req.channel_id = ch.channel_id;
+            req.stream_id = st.stream_id;
+            closing = ch.conn->send(req, _shared->logger()) || closing;
+        }
+        st.active = st.active && closing;
+    }
 
-        // Process the connection.
-        if (opt.once) {
-            // If --once is specified, run once in the context of the main thread and exit.
-            ECMGClientHandler client(opt, conn, &shared, false);
-            client.main();
+    // Wait for all stream_close_response, within the grace period.
+    ts::Monotonic deadline(true);
+    deadline += GRACE_PERIOD * ts::NanoSecPerMilliSec;
+    std::vector<uint64_t> ready;
+    for (;;) {
+        const ts::Monotonic now(true);
+        closing = false;
+        for (size_t i = 0; !closing && i < _streams.size(); ++i) {
+            closing = _streams[i].active;
+        }
+        if (!closing || now >= deadline || !_poller.wait((deadline - now) / ts::NanoSecPerMilliSec + 1, ready, NULLREP)) {
             break;
         }
-        else {
-            // Otherwise, create a thread and forget about it.
-            // The thread will deallocate itself automatically when it completes.
-            ECMGClientHandler* client = new ECMGClientHandler(opt, conn, &shared, true);
-            ts::CheckNonNull(client);
-            client->start();
+        for (auto chan : ready) {
+            if (!receive(size_t(chan))) {
+                // Broken channel, forget its streams.
+                for (size_t i = 0; i < _opt.loadStreams; ++i) {
+                    _streams[chan * _opt.loadStreams + i].active = false;
+                }
+                _poller.remove(_channels[chan].conn->getSocket());
+            }
         }
     }
 
-    return EXIT_SUCCESS;
+    // Close all channels.
+    for (auto& ch : _channels) {
+        if (!ch.conn.isNull() && ch.conn->isConnected()) {
+            ts::ecmgscs::ChannelClose close;
+            close.channel_id = ch.channel_id;
+            ch.conn->send(close, _shared->logger());
+            _poller.remove(ch.conn->getSocket());
+            ch.conn->disconnect(NULLREP);
+        }
+        if (!ch.conn.isNull() && ch.conn->isOpen()) {
+            ch.conn->close(NULLREP);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Display the statistics.
+//----------------------------------------------------------------------------
+
+void ECMGLoad::displayStatistics() const
+{
+    uint64_t lost = 0;
+    for (const auto& st : _streams) {
+        lost += st.pending.size();
+    }
+
+    std::vector<ts::NanoSecond> lat(_latencies);
+    std::sort(lat.begin(), lat.end());
+    ts::NanoSecond total = 0;
+    for (auto ns : lat) {
+        total += ns;
+    }
+
+    // Latency in microseconds of a given percentile.
+    const auto percentile = [&lat](double p) -> ts::NanoSecond {
+        return lat.empty() ? 0 : lat[std::min(lat.size() - 1, size_t(p * double(lat.size()) / 100.0))] / ts::NanoSecPerMicroSec;
+    };
+
+    std::cout << ts::UString::Format(u"Channels: %'d, streams: %'d, crypto-period: %'d ms, duration: %'d s", {_channels.size(), _streams.size(), _opt.loadCPDuration, _opt.loadDuration}) << std::endl
+              << ts::UString::Format(u"CW_provision: %'d, ECM_response: %'d, lost: %'d, unexpected: %'d, errors: %'d", {_requests, lat.size(), lost, _unexpected, _errors}) << std::endl;
+    if (!lat.empty()) {
+        std::cout << ts::UString::Format(u"Response time (us): min: %'d, avg: %'d, p50: %'d, p90: %'d, p99: %'d, p99.9: %'d, max: %'d",
+                                         {lat.front() / ts::NanoSecPerMicroSec,
+                                          total / ts::NanoSecond(lat.size()) / ts::NanoSecPerMicroSec,
+                                          percentile(50.0), percentile(90.0), percentile(99.0), percentile(99.9),
+                                          lat.back() / ts::NanoSecPerMicroSec})
+                  << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Program main code.
+//----------------------------------------------------------------------------
+
+int MainCode(int argc, char *argv[])
+{
+    ECMGOptions opt(argc, argv);
+
+    // Create ECMG shared data (including the asynchronous report).
+    ECMGSharedData shared(opt);
+
+    // A peer may disconnect at any time, we must not be killed when sending to a closed connection.
+    ts::IgnorePipeSignal();
+
+    // Either simulate a SCS to load an ECMG or act as an ECMG.
+    if (opt.loadAddress.hasAddress()) {
+        ECMGLoad load(opt, &shared);
+        return load.run() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    else {
+        ECMGServer server(opt, &shared);
+        return server.run() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 }
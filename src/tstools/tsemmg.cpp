@@ -84,6 +84,7 @@ public:
     uint16_t             channelId;           // Data_channel_id, see EMMG/PDG <=> MUX protocol.
     uint16_t             streamId;            // Data_stream_id, see EMMG/PDG <=> MUX protocol.
     uint16_t             dataId;              // Data_id, see EMMG/PDG <=> MUX protocol.
+    size_t               streamCount;         // Number of simultaneous data streams.
     uint8_t              dataType;            // Data_type, see EMMG/PDG <=> MUX protocol.
     bool                 sectionMode;         // If true, send data in section format.
     uint16_t             sendBandwidth;       // Bandwidth of sent data in kb/s.
@@ -115,6 +116,7 @@ EMMGOptions::EMMGOptions(int argc, char *argv[]) :
     channelId(0),
     streamId(0),
     dataId(0),
+    streamCount(0),
     dataType(0),
     sectionMode(false),
     sendBandwidth(0),
@@ -236,6 +238,15 @@ EMMGOptions::EMMGOptions(int argc, char *argv[]) :
          u"This option sets the DVB SimulCrypt parameter 'data_stream_id'. "
          u"Default: 1.");
 
+    option(u"streams", 0, INTEGER, 0, 1, 1, 0xFFFF);
+    help(u"streams",
+         u"Number of simultaneous data streams to open. Each stream uses its own TCP "
+         u"connection with the MUX. The data_channel_id, data_stream_id and data_id "
+         u"of the streams are consecutive, starting at the values of --channel-id, "
+         u"--stream-id and --data-id. The bandwidth and the maximum number of bytes "
+         u"apply to each stream. This option is typically used to test the load of "
+         u"a MUX. Default: 1.");
+
     option(u"type", 't', DataTypeEnum);
     help(u"type",
          u"This option sets the DVB SimulCrypt parameter 'data_type'. Default: 0 (EMM). "
@@ -259,6 +270,7 @@ EMMGOptions::EMMGOptions(int argc, char *argv[]) :
     dataId = intValue<uint16_t>(u"data-id", 0);
     channelId = intValue<uint16_t>(u"channel-id", 1);
     streamId = intValue<uint16_t>(u"stream-id", 1);
+    streamCount = intValue<size_t>(u"streams", 1);
     dataType = intValue<uint8_t>(u"type", 0);
     sectionMode = present(u"section-mode");
     sendBandwidth = intValue<uint16_t>(u"bandwidth", DEFAULT_BANDWIDTH);
@@ -449,6 +461,81 @@ void EMMGSectionProvider::provideSection(ts::SectionCounter counter, ts::Section
 }
 
 
+//----------------------------------------------------------------------------
+// A class which manages one data stream to the MUX.
+//----------------------------------------------------------------------------
+
+class EMMGStream
+{
+    TS_NOBUILD_NOCOPY(EMMGStream);
+public:
+    // Constructor.
+    EMMGStream(const EMMGOptions& opt) : client(), sectionProvider(opt), packetizer(ts::PID_NULL, &sectionProvider) {}
+
+    ts::EMMGClient      client;           // Manage the TCP connection with the MUX.
+    EMMGSectionProvider sectionProvider;  // Provide sections to send.
+    ts::Packetizer      packetizer;       // When working in packet mode, we need a packetizer.
+};
+
+typedef ts::SafePtr<EMMGStream> EMMGStreamPtr;
+
+
+//----------------------------------------------------------------------------
+// Send some data on a stream. Return false on error or end of input.
+//----------------------------------------------------------------------------
+
+bool SendData(const EMMGOptions& opt, EMMGStream& stream, uint64_t targetBytes)
+{
+    // Send the data we need to send now. Split in several send operations if needed.
+    bool ok = true;
+    while (ok && targetBytes > 0 && stream.client.totalBytes() < opt.maxBytes) {
+
+        // Size of this send operation.
+        const uint64_t targetSendSize = std::min<uint64_t>(opt.bytesPerSend, targetBytes);
+        uint64_t sendSize = 0;
+
+        // Build a set of data to send.
+        if (opt.sectionMode) {
+            // Get complete sections from the section provider.
+            ts::SectionPtrVector sections;
+            while (ok && sendSize < targetSendSize) {
+                // Get one section.
+                ts::SectionPtr sec;
+                stream.sectionProvider.provideSection(0, sec);
+                // Getting a null pointer means end of input.
+                ok = !sec.isNull();
+                if (ok) {
+                    sections.push_back(sec);
+                    sendSize += sec->size();
+                }
+            }
+
+            // Send the sections.
+            ok = stream.client.dataProvision(sections) && ok;
+        }
+        else {
+            // Get TS packets from the packetizer.
+            sendSize = ts::RoundUp<uint64_t>(targetSendSize, ts::PKT_SIZE);
+            ts::TSPacketVector packets(size_t(sendSize / ts::PKT_SIZE));
+            for (size_t i = 0; ok && i < packets.size(); ++i) {
+                ok = stream.packetizer.getNextPacket(packets[i]);
+                if (!ok) {
+                    // No more packet, shrink the packet buffer.
+                    packets.resize(i);
+                }
+            }
+
+            // Send the packets.
+            ok = stream.client.dataProvision(packets.data(), packets.size() * ts::PKT_SIZE) && ok;
+        }
+
+        // Any data left for another send operation?
+        targetBytes = sendSize > targetBytes ? 0 : targetBytes - sendSize;
+    }
+    return ok;
+}
+
+
 //----------------------------------------------------------------------------
 //  Program entry point
 //----------------------------------------------------------------------------
@@ -458,129 +545,87 @@ int MainCode(int argc, char *argv[])
     // Command line options.
     EMMGOptions opt(argc, argv);
 
-    // An object to manage the TCP connection with the MUX.
-    ts::EMMGClient client;
-    ts::emmgmux::ChannelStatus channelStatus;
-    ts::emmgmux::StreamStatus streamStatus;
-
     // UDP socket for the data_provision messages.
     ts::UDPSocket udpSocket;
     if (opt.useUDP && !udpSocket.open(opt)) {
         return EXIT_FAILURE;
     }
 
-    // Connect to the MUX.
+    // Connect all streams to the MUX.
+    std::vector<EMMGStreamPtr> streams;
+    uint16_t allocated = 0xFFFF;
+    bool ok = true;
     opt.verbose(u"Connecting to MUX at %s", {opt.tcpMuxAddress});
-    if (!client.connect(opt.tcpMuxAddress,
-                        opt.udpMuxAddress,
-                        opt.clientId,
-                        opt.channelId,
-                        opt.streamId,
-                        opt.dataId,
-                        opt.dataType,
-                        opt.sectionMode,
-                        channelStatus,
-                        streamStatus,
-                        nullptr,
-                        opt.logger))
-    {
-        return EXIT_FAILURE;
+    for (size_t i = 0; ok && i < opt.streamCount; ++i) {
+        EMMGStreamPtr stream(new EMMGStream(opt));
+        ts::CheckNonNull(stream.pointer());
+        ts::emmgmux::ChannelStatus channelStatus;
+        ts::emmgmux::StreamStatus streamStatus;
+
+        // Connect to the MUX and request the bandwidth.
+        ok = stream->client.connect(opt.tcpMuxAddress,
+                                    opt.udpMuxAddress,
+                                    opt.clientId,
+                                    uint16_t(opt.channelId + i),
+                                    uint16_t(opt.streamId + i),
+                                    uint16_t(opt.dataId + i),
+                                    opt.dataType,
+                                    opt.sectionMode,
+                                    channelStatus,
+                                    streamStatus,
+                                    nullptr,
+                                    opt.logger);
+        if (ok) {
+            streams.push_back(stream);
+            ok = stream->client.requestBandwidth(opt.requestedBandwidth, true);
+            allocated = std::min(allocated, stream->client.allocatedBandwidth());
+        }
     }
 
-    // Request the bandwidth, get allocated bandwidth as returned by the MUX and adjust our bitrates.
-    if (!client.requestBandwidth(opt.requestedBandwidth, true) ||
-        !opt.adjustBandwidth(client.allocatedBandwidth()))
-    {
-        client.disconnect();
+    // Adjust our bitrates according to the smallest allocated bandwidth.
+    if (!ok || !opt.adjustBandwidth(allocated)) {
+        for (const auto& stream : streams) {
+            stream->client.disconnect();
+        }
         return EXIT_FAILURE;
     }
 
-    // An object which provides sections to send.
-    EMMGSectionProvider sectionProvider(opt);
-
-    // When working in packet mode, we need a packetizer.
-    ts::Packetizer packetizer(ts::PID_NULL, &sectionProvider);
-
     // Start time.
     const ts::Monotonic startTime(true);
 
     // This clock will be our reference.
     ts::Monotonic currentTime(startTime);
 
-    // Send data as long as the maximum is not reached.
-    bool ok = true;
-    while (ok && client.totalBytes() < opt.maxBytes) {
-
-        // Compute the number of bytes we need to send now.
-        uint64_t targetBytes = 0;
-        ts::NanoSecond duration = currentTime - startTime;
-        if (duration <= 0) {
-            // First interval, send initial burst.
-            targetBytes = opt.bytesPerSend;
-        }
-        else {
-            // Compute the theoretical number of bytes we should have sent up to now.
-            const uint64_t allBytes = (opt.dataBitrate * duration) / (8 * ts::NanoSecPerSec);
-            // We need to send the difference.
-            if (allBytes > client.totalBytes()) {
-                targetBytes = allBytes - client.totalBytes();
-            }
-        }
-
-        // Send the data we need to send now. Split in several send operations if needed.
-        while (ok && targetBytes > 0 && client.totalBytes() < opt.maxBytes) {
-
-            // Size of this send operation.
-            const uint64_t targetSendSize = std::min<uint64_t>(opt.bytesPerSend, targetBytes);
-            uint64_t sendSize = 0;
-
-            // Build a set of data to send.
-            if (opt.sectionMode) {
-                // Get complete sections from the section provider.
-                ts::SectionPtrVector sections;
-                while (ok && sendSize < targetSendSize) {
-                    // Get one section.
-                    ts::SectionPtr sec;
-                    sectionProvider.provideSection(0, sec);
-                    // Getting a null pointer means end of input.
-                    ok = !sec.isNull();
-                    if (ok) {
-                        sections.push_back(sec);
-                        sendSize += sec->size();
-                    }
-                }
-
-                // Send the sections.
-                ok = client.dataProvision(sections) && ok;
-            }
-            else {
-                // Get TS packets from the packetizer.
-                sendSize = ts::RoundUp<uint64_t>(targetSendSize, ts::PKT_SIZE);
-                ts::TSPacketVector packets(size_t(sendSize / ts::PKT_SIZE));
-                for (size_t i = 0; ok && i < packets.size(); ++i) {
-                    ok = packetizer.getNextPacket(packets[i]);
-                    if (!ok) {
-                        // No more packet, shrink the packet buffer.
-                        packets.resize(i);
-                    }
-                }
-
-                // Send the packets.
-                ok = client.dataProvision(packets.data(), packets.size() * ts::PKT_SIZE) && ok;
+    // Send data as long as the maximum is not reached on some stream.
+    while (ok) {
+
+        // Compute the number of bytes we need to send now. All streams have the same bitrate.
+        const ts::NanoSecond duration = currentTime - startTime;
+        const uint64_t allBytes = duration <= 0 ? 0 : (opt.dataBitrate * duration) / (8 * ts::NanoSecPerSec);
+
+        bool active = false;
+        for (size_t i = 0; ok && i < streams.size(); ++i) {
+            EMMGStream& stream(*streams[i]);
+            const uint64_t totalBytes = stream.client.totalBytes();
+            if (totalBytes < opt.maxBytes) {
+                // First interval: send initial burst. Then send the difference with the theoretical number of bytes.
+                const uint64_t targetBytes = duration <= 0 ? opt.bytesPerSend : (allBytes > totalBytes ? allBytes - totalBytes : 0);
+                ok = SendData(opt, stream, targetBytes);
+                active = active || stream.client.totalBytes() < opt.maxBytes;
             }
-
-            // Any data left for another send operation?
-            targetBytes = sendSize > targetBytes ? 0 : targetBytes - sendSize;
         }
 
         // Wait for the next send operation.
-        if (ok && client.totalBytes() < opt.maxBytes) {
+        ok = ok && active;
+        if (ok) {
             currentTime += opt.sendInterval;
             currentTime.wait();
         }
     }
 
     // Disconnect from the MUX.
-    client.disconnect();
+    for (const auto& stream : streams) {
+        stream->client.disconnect();
+    }
     return EXIT_SUCCESS;
 }
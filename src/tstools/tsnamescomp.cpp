@@ -0,0 +1,101 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Names files compiler: build the binary index of tsduck*.names files.
+//
+//----------------------------------------------------------------------------
+
+#include "tsMain.h"
+#include "tsNames.h"
+TSDUCK_SOURCE;
+TS_MAIN(MainCode);
+
+
+//----------------------------------------------------------------------------
+//  Command line options
+//----------------------------------------------------------------------------
+
+class Options: public ts::Args
+{
+    TS_NOBUILD_NOCOPY(Options);
+public:
+    Options(int argc, char *argv[]);
+    virtual ~Options() = default;
+
+    ts::UStringVector infiles;   // Input text names files.
+    ts::UString       outfile;   // Output index file.
+};
+
+Options::Options(int argc, char *argv[]) :
+    Args(u"Compile TSDuck names files into binary indexes", u"[options] filename ..."),
+    infiles(),
+    outfile()
+{
+    option(u"", 0, STRING, 1, UNLIMITED_COUNT);
+    help(u"",
+         u"Names files to compile (tsduck.names, tsduck.oui.names, etc). "
+         u"By default, the binary index of each file is created in the same "
+         u"directory, with the same name and an additional suffix \"" TS_NAMES_INDEX_SUFFIX "\". "
+         u"The TSDuck library automatically uses the index when it is found "
+         u"in the search path of the names file and is not older than the text file.");
+
+    option(u"output", 'o', STRING);
+    help(u"output", u"filename",
+         u"Specify the output index file. Allowed with one input file only.");
+
+    analyze(argc, argv);
+
+    getValues(infiles, u"");
+    getValue(outfile, u"output");
+
+    if (!outfile.empty() && infiles.size() > 1) {
+        error(u"--output is allowed with one input file only");
+    }
+
+    exitOnError();
+}
+
+
+//----------------------------------------------------------------------------
+//  Program entry point
+//----------------------------------------------------------------------------
+
+int MainCode(int argc, char *argv[])
+{
+    Options opt(argc, argv);
+    bool success = true;
+
+    for (const auto& file : opt.infiles) {
+        const ts::UString index(opt.outfile.empty() ? file + TS_NAMES_INDEX_SUFFIX : opt.outfile);
+        opt.verbose(u"compiling %s into %s", {file, index});
+        success = ts::Names::CompileIndex(file, index, opt) && success;
+    }
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,198 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::CRC32.
+//
+//----------------------------------------------------------------------------
+
+#include "tsCRC32.h"
+#include "tsSystemRandomGenerator.h"
+#include "tsByteBlock.h"
+#include "tsMonotonic.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class CRC32Test: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testReference();
+    void testEngines();
+    void testIncremental();
+    void testThroughput();
+
+    TSUNIT_TEST_BEGIN(CRC32Test);
+    TSUNIT_TEST(testReference);
+    TSUNIT_TEST(testEngines);
+    TSUNIT_TEST(testIncremental);
+    TSUNIT_TEST(testThroughput);
+    TSUNIT_TEST_END();
+
+private:
+    static const ts::CRC32::Engine _engines[];
+    static ts::UString EngineName(ts::CRC32::Engine engine);
+};
+
+TSUNIT_REGISTER(CRC32Test);
+
+// All implementations, except DEFAULT.
+const ts::CRC32::Engine CRC32Test::_engines[] = {ts::CRC32::BYTEWISE, ts::CRC32::SLICE_BY_8, ts::CRC32::CARRY_LESS};
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void CRC32Test::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void CRC32Test::afterTest()
+{
+}
+
+ts::UString CRC32Test::EngineName(ts::CRC32::Engine engine)
+{
+    switch (engine) {
+        case ts::CRC32::DEFAULT: return u"default";
+        case ts::CRC32::BYTEWISE: return u"bytewise";
+        case ts::CRC32::SLICE_BY_8: return u"slice-by-8";
+        case ts::CRC32::CARRY_LESS: return u"carry-less";
+        default: return u"unknown";
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void CRC32Test::testReference()
+{
+    debug() << "CRC32Test::testReference: default engine: " << EngineName(ts::CRC32::DefaultEngine()) << std::endl;
+
+    TSUNIT_ASSERT(ts::CRC32::IsSupported(ts::CRC32::DEFAULT));
+    TSUNIT_ASSERT(ts::CRC32::IsSupported(ts::CRC32::BYTEWISE));
+    TSUNIT_ASSERT(ts::CRC32::IsSupported(ts::CRC32::SLICE_BY_8));
+    TSUNIT_ASSERT(ts::CRC32::DefaultEngine() != ts::CRC32::DEFAULT);
+
+    // Standard check value of CRC-32/MPEG-2.
+    const char check[] = "123456789";
+    TSUNIT_EQUAL(0x0376E6E7, ts::CRC32(check, 9).value());
+    TSUNIT_EQUAL(0xFFFFFFFF, ts::CRC32(check, 0).value());
+
+    // The CRC32 of a section, including its CRC32 field, is zero.
+    // Same as a PAT with TS id 1 and one service (id 1, PMT PID 0x0100).
+    const uint8_t pat[] = {0x00, 0xB0, 0x0D, 0x00, 0x01, 0xC1, 0x00, 0x00, 0x00, 0x01, 0xE1, 0x00};
+    const uint32_t crc = ts::CRC32(pat, sizeof(pat)).value();
+    ts::ByteBlock section(pat, sizeof(pat));
+    section.appendUInt32(crc);
+    for (size_t i = 0; i < sizeof(_engines) / sizeof(_engines[0]); ++i) {
+        if (ts::CRC32::IsSupported(_engines[i])) {
+            ts::CRC32 c;
+            c.add(section.data(), section.size(), _engines[i]);
+            TSUNIT_EQUAL(0, c.value());
+        }
+    }
+}
+
+void CRC32Test::testEngines()
+{
+    ts::SystemRandomGenerator prng;
+    ts::ByteBlock data(5000);
+    TSUNIT_ASSERT(prng.read(data.data(), data.size()));
+
+    // Compare all implementations with the reference one, on all sizes and alignments.
+    for (size_t size = 0; size <= 4096; size += size < 300 ? 1 : 61) {
+        for (size_t offset = 0; offset < 8; offset += 3) {
+            ts::CRC32 ref;
+            ref.add(data.data() + offset, size, ts::CRC32::BYTEWISE);
+            for (size_t i = 0; i < sizeof(_engines) / sizeof(_engines[0]); ++i) {
+                if (ts::CRC32::IsSupported(_engines[i])) {
+                    ts::CRC32 c;
+                    c.add(data.data() + offset, size, _engines[i]);
+                    TSUNIT_EQUAL(ref.value(), c.value());
+                }
+            }
+            TSUNIT_EQUAL(ref.value(), ts::CRC32(data.data() + offset, size).value());
+        }
+    }
+}
+
+void CRC32Test::testIncremental()
+{
+    ts::SystemRandomGenerator prng;
+    ts::ByteBlock data(1024);
+    TSUNIT_ASSERT(prng.read(data.data(), data.size()));
+
+    // Computing in several steps must give the same result.
+    const uint32_t ref = ts::CRC32(data.data(), data.size()).value();
+    for (size_t i = 0; i < sizeof(_engines) / sizeof(_engines[0]); ++i) {
+        if (ts::CRC32::IsSupported(_engines[i])) {
+            for (size_t split = 0; split <= data.size(); split += 37) {
+                ts::CRC32 c;
+                c.add(data.data(), split, _engines[i]);
+                c.add(data.data() + split, data.size() - split, _engines[i]);
+                TSUNIT_EQUAL(ref, c.value());
+            }
+        }
+    }
+}
+
+void CRC32Test::testThroughput()
+{
+    // Typical sizes: short PSI section, average EIT section, long section.
+    static const size_t sizes[] = {188, 1024, 4096};
+    static const size_t total = 16 * 1024 * 1024;
+
+    ts::ByteBlock data(4096, 0x5A);
+    for (size_t i = 0; i < sizeof(_engines) / sizeof(_engines[0]); ++i) {
+        if (ts::CRC32::IsSupported(_engines[i])) {
+            for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+                ts::CRC32 c;
+                const ts::Monotonic start(true);
+                for (size_t done = 0; done < total; done += sizes[s]) {
+                    c.add(data.data(), sizes[s], _engines[i]);
+                }
+                const ts::NanoSecond duration = ts::Monotonic(true) - start;
+                debug() << "CRC32Test::testThroughput: " << EngineName(_engines[i]) << ", " << sizes[s] << " bytes: "
+                        << (duration <= 0 ? 0 : (ts::NanoSecond(total) * 1000) / duration) << " MB/s" << std::endl;
+            }
+        }
+    }
+}
@@ -51,6 +51,7 @@
 #include "tsIDSA.h"
 #include "tsTSPacket.h"
 #include "tsSystemRandomGenerator.h"
+#include "tsMonotonic.h"
 #include "tsunit.h"
 TSDUCK_SOURCE;
 
@@ -83,6 +84,7 @@ public:
     void testAES_ECB();
     void testAES_CBC();
     void testAES_CTR();
+    void testAES_Blocks();
     void testAES_CTS1();
     void testAES_CTS2();
     void testAES_CTS3();
@@ -92,6 +94,7 @@ public:
     void testTDES();
     void testTDES_CBC();
     void testDVBCSA2();
+    void testDVBCSA2Batch();
     void testDVBCISSA();
     void testIDSA();
     void testSCTE52_2003();
@@ -106,6 +109,7 @@ public:
     TSUNIT_TEST(testAES_ECB);
     TSUNIT_TEST(testAES_CBC);
     TSUNIT_TEST(testAES_CTR);
+    TSUNIT_TEST(testAES_Blocks);
     TSUNIT_TEST(testAES_CTS1);
     TSUNIT_TEST(testAES_CTS2);
     TSUNIT_TEST(testAES_CTS3);
@@ -115,6 +119,7 @@ public:
     TSUNIT_TEST(testTDES);
     TSUNIT_TEST(testTDES_CBC);
     TSUNIT_TEST(testDVBCSA2);
+    TSUNIT_TEST(testDVBCSA2Batch);
     TSUNIT_TEST(testDVBCISSA);
     TSUNIT_TEST(testIDSA);
     TSUNIT_TEST(testSCTE52_2003);
@@ -383,6 +388,59 @@ void CryptoTest::testAES_CTR()
     }
 }
 
+void CryptoTest::testAES_Blocks()
+{
+    debug() << "CryptoTest::testAES_Blocks: hardware acceleration: " << ts::UString::YesNo(ts::AES::IsAccelerated()) << std::endl;
+
+    ts::SystemRandomGenerator prng;
+    ts::AES aes;
+    ts::ByteBlock key;
+    ts::ByteBlock plain(19 * ts::AES::BLOCK_SIZE);
+    TSUNIT_ASSERT(prng.read(plain.data(), plain.size()));
+
+    // Multi-block operations must give the same results as block by block, for all key sizes.
+    for (size_t key_size = ts::AES::MIN_KEY_SIZE; key_size <= ts::AES::MAX_KEY_SIZE; key_size += 8) {
+        key.resize(key_size);
+        TSUNIT_ASSERT(prng.read(key.data(), key.size()));
+        TSUNIT_ASSERT(aes.setKey(key.data(), key.size()));
+        for (size_t count = 1; count * ts::AES::BLOCK_SIZE <= plain.size(); ++count) {
+            ts::ByteBlock cipher(count * ts::AES::BLOCK_SIZE);
+            ts::ByteBlock ref(count * ts::AES::BLOCK_SIZE);
+            TSUNIT_ASSERT(aes.encryptBlocks(plain.data(), cipher.data(), count));
+            for (size_t i = 0; i < count; ++i) {
+                TSUNIT_ASSERT(aes.encrypt(&plain[i * ts::AES::BLOCK_SIZE], ts::AES::BLOCK_SIZE, &ref[i * ts::AES::BLOCK_SIZE], ts::AES::BLOCK_SIZE));
+            }
+            TSUNIT_ASSERT(cipher == ref);
+            TSUNIT_ASSERT(aes.decryptBlocks(cipher.data(), cipher.data(), count));
+            TSUNIT_ASSERT(cipher == ts::ByteBlock(plain.data(), count * ts::AES::BLOCK_SIZE));
+        }
+    }
+
+    // CTR mode over several groups of parallel blocks, compared with a block by block reference.
+    ts::CTR<ts::AES> ctr_aes;
+    ts::ByteBlock iv(ts::AES::BLOCK_SIZE, 0x00);
+    iv[15] = 0xF0; // counter wraps to the next byte inside the message
+    TSUNIT_ASSERT(ctr_aes.setKey(key.data(), key.size()));
+    TSUNIT_ASSERT(ctr_aes.setIV(iv.data(), iv.size()));
+    const size_t size = plain.size() - 5;
+    ts::ByteBlock cipher(size);
+    TSUNIT_ASSERT(ctr_aes.encrypt(plain.data(), size, cipher.data(), cipher.size()));
+    ts::ByteBlock counter(iv);
+    for (size_t i = 0; i < size; i += ts::AES::BLOCK_SIZE) {
+        uint8_t mask[ts::AES::BLOCK_SIZE];
+        TSUNIT_ASSERT(aes.encrypt(counter.data(), counter.size(), mask, sizeof(mask)));
+        for (size_t j = 0; j < ts::AES::BLOCK_SIZE && i + j < size; ++j) {
+            TSUNIT_EQUAL(uint8_t(plain[i + j] ^ mask[j]), cipher[i + j]);
+        }
+        for (size_t j = ts::AES::BLOCK_SIZE - 1; ++counter[j] == 0 && j > ts::AES::BLOCK_SIZE / 2; --j) {
+        }
+    }
+
+    // CBC decryption over several groups of parallel blocks.
+    ts::CBC<ts::AES> cbc_aes;
+    testChainingSizes(cbc_aes, 16, 64, 128, 144, 176, 12352, 0);
+}
+
 void CryptoTest::testAES_CTS1()
 {
     ts::CTS1<ts::AES> cts1_aes;
@@ -493,6 +551,97 @@ void CryptoTest::testDVBCSA2()
     }
 }
 
+void CryptoTest::testDVBCSA2Batch()
+{
+    ts::DVBCSA2 csa;
+    ts::SystemRandomGenerator prng;
+    ts::ByteBlock key(8);
+    TSUNIT_ASSERT(prng.read(key.data(), key.size()));
+    TSUNIT_ASSERT(csa.setKey(key.data(), key.size()));
+
+    // Batch processing must give the same result as one area at a time,
+    // on the two sides of the 64 and 128 areas boundaries, including areas
+    // shorter than one block and empty ones.
+    static const size_t counts[] = {1, 7, 64, 65, 128, 200};
+    for (size_t ci = 0; ci < sizeof(counts) / sizeof(counts[0]); ++ci) {
+        const size_t count = counts[ci];
+        std::vector<ts::ByteBlock> plain(count);
+        std::vector<ts::ByteBlock> batch(count);
+        std::vector<void*> data(count);
+        std::vector<size_t> sizes(count);
+        for (size_t i = 0; i < count; ++i) {
+            uint8_t rnd = 0;
+            TSUNIT_ASSERT(prng.read(&rnd, 1));
+            sizes[i] = i == 0 ? ts::PKT_SIZE - 4 : (i * 37 + rnd) % (ts::PKT_SIZE - 3);
+            plain[i].resize(sizes[i]);
+            TSUNIT_ASSERT(prng.read(plain[i].data(), plain[i].size()));
+            batch[i] = plain[i];
+            data[i] = batch[i].data();
+        }
+
+        TSUNIT_ASSERT(csa.encryptInPlaceBatch(data.data(), sizes.data(), count));
+        for (size_t i = 0; i < count; ++i) {
+            ts::ByteBlock cipher(plain[i]);
+            TSUNIT_ASSERT(cipher.empty() || csa.encryptInPlace(cipher.data(), cipher.size()));
+            TSUNIT_ASSERT(cipher == batch[i]);
+        }
+
+        TSUNIT_ASSERT(csa.decryptInPlaceBatch(data.data(), sizes.data(), count));
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_ASSERT(plain[i] == batch[i]);
+        }
+    }
+
+    // Test vectors, several times in the same batch.
+    const size_t tv_count = sizeof(tv_dvb_csa2) / sizeof(tv_dvb_csa2[0]);
+    for (size_t tvi = 0; tvi < tv_count; ++tvi) {
+        const TV_DVB_CSA2* tv = tv_dvb_csa2 + tvi;
+        TSUNIT_ASSERT(csa.setKey(tv->key, sizeof(tv->key)));
+        std::vector<ts::ByteBlock> batch(10, ts::ByteBlock(tv->plain, tv->size));
+        std::vector<void*> data(batch.size());
+        std::vector<size_t> sizes(batch.size(), tv->size);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            data[i] = batch[i].data();
+        }
+        TSUNIT_ASSERT(csa.encryptInPlaceBatch(data.data(), sizes.data(), data.size()));
+        for (size_t i = 0; i < batch.size(); ++i) {
+            TSUNIT_ASSERT(batch[i] == ts::ByteBlock(tv->cipher, tv->size));
+        }
+        TSUNIT_ASSERT(csa.decryptInPlaceBatch(data.data(), sizes.data(), data.size()));
+        for (size_t i = 0; i < batch.size(); ++i) {
+            TSUNIT_ASSERT(batch[i] == ts::ByteBlock(tv->plain, tv->size));
+        }
+    }
+
+    // Throughput on full packet payloads, one at a time and by batch.
+    const size_t count = ts::DVBCSA2::MAX_BATCH_SIZE;
+    const size_t iterations = 100;
+    std::vector<ts::ByteBlock> payloads(count, ts::ByteBlock(ts::PKT_SIZE - 4, 0x5A));
+    std::vector<void*> data(count);
+    std::vector<size_t> sizes(count, ts::PKT_SIZE - 4);
+    for (size_t i = 0; i < count; ++i) {
+        data[i] = payloads[i].data();
+    }
+
+    ts::Monotonic start(true);
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_ASSERT(csa.encryptInPlace(data[i], sizes[i]));
+        }
+    }
+    const ts::NanoSecond single = ts::Monotonic(true) - start;
+
+    start.getSystemTime();
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        TSUNIT_ASSERT(csa.encryptInPlaceBatch(data.data(), sizes.data(), count));
+    }
+    const ts::NanoSecond batch = ts::Monotonic(true) - start;
+
+    const ts::PacketCounter packets = count * iterations;
+    debug() << "CryptoTest::testDVBCSA2Batch: single: " << (single <= 0 ? 0 : (packets * ts::NanoSecPerSec) / single) << " packets/s"
+            << ", batch: " << (batch <= 0 ? 0 : (packets * ts::NanoSecPerSec) / batch) << " packets/s" << std::endl;
+}
+
 void CryptoTest::testDVBCISSA()
 {
     ts::DVBCISSA cissa;
@@ -91,6 +91,7 @@ public:
     void testTDT();
     void testTOT();
     void testHEVC();
+    void testRecycleSections();
 
     TSUNIT_TEST_BEGIN(DemuxTest);
     TSUNIT_TEST(testPAT);
@@ -104,6 +105,7 @@ public:
     TSUNIT_TEST(testTDT);
     TSUNIT_TEST(testTOT);
     TSUNIT_TEST(testHEVC);
+    TSUNIT_TEST(testRecycleSections);
     TSUNIT_TEST_END();
 
 private:
@@ -488,3 +490,63 @@ void DemuxTest::testHEVC()
 {
     TEST_TABLE("PMT with HEVC descriptor", pmt_hevc);
 }
+
+namespace {
+    // Collect section addresses and table counts from a section demux.
+    class RecycleHandler: public ts::TableHandlerInterface, public ts::SectionHandlerInterface
+    {
+    public:
+        size_t tables = 0;
+        size_t sections = 0;
+        std::set<const ts::Section*> addresses {};
+        virtual void handleTable(ts::SectionDemux&, const ts::BinaryTable&) override { tables++; }
+        virtual void handleSection(ts::SectionDemux&, const ts::Section& sect) override { sections++; addresses.insert(&sect); }
+    };
+
+    // Feed a demux with several repetitions of a list of packets, with contiguous continuity counters.
+    void FeedRepeat(ts::SectionDemux& demux, const uint8_t* packets, size_t packets_size, size_t count)
+    {
+        ts::TSPacket pkt;
+        uint8_t cc = 0;
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t pi = 0; pi < packets_size / ts::PKT_SIZE; ++pi) {
+                pkt.copyFrom(packets + pi * ts::PKT_SIZE);
+                pkt.setCC(cc);
+                cc = (cc + 1) & ts::CC_MASK;
+                demux.feedPacket(pkt);
+            }
+        }
+    }
+}
+
+void DemuxTest::testRecycleSections()
+{
+    ts::DuckContext duck;
+    RecycleHandler normal;
+    RecycleHandler recycle;
+    ts::SectionDemux demux1(duck, &normal, &normal, ts::AllPIDs);
+    ts::SectionDemux demux2(duck, &recycle, &recycle, ts::AllPIDs);
+    demux2.setRecycleSections(true);
+    TSUNIT_ASSERT(!demux1.recycleSections());
+    TSUNIT_ASSERT(demux2.recycleSections());
+
+    // Repeated long section: the unchanged section is reused.
+    FeedRepeat(demux1, psi_pat_r4_packets, sizeof(psi_pat_r4_packets), 20);
+    FeedRepeat(demux2, psi_pat_r4_packets, sizeof(psi_pat_r4_packets), 20);
+    TSUNIT_EQUAL(1, normal.tables);
+    TSUNIT_EQUAL(20, normal.sections);
+    TSUNIT_EQUAL(1, recycle.tables);
+    TSUNIT_EQUAL(20, recycle.sections);
+    TSUNIT_EQUAL(1, recycle.addresses.size());
+
+    // Repeated short sections: a new table each time, sections are recycled.
+    recycle.addresses.clear();
+    demux2.reset();
+    FeedRepeat(demux2, psi_tdt_tnt_packets, sizeof(psi_tdt_tnt_packets), 20);
+    TSUNIT_EQUAL(21, recycle.tables);
+    TSUNIT_EQUAL(40, recycle.sections);
+    TSUNIT_ASSERT(recycle.addresses.size() <= 2);
+
+    ts::SectionDemux::Status status(demux2);
+    TSUNIT_ASSERT(!status.hasErrors());
+}
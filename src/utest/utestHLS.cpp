@@ -32,7 +32,17 @@
 //----------------------------------------------------------------------------
 
 #include "tshlsPlayList.h"
+#include "tshlsInputPlugin.h"
+#include "tsTSProcessor.h"
+#include "tsPluginRepository.h"
+#include "tsTCPServer.h"
+#include "tsTCPConnection.h"
+#include "tsIPUtils.h"
+#include "tsMonotonic.h"
+#include "tsNullReport.h"
+#include "tsSysUtils.h"
 #include "tsunit.h"
+#include "utestTSUnitThread.h"
 TSDUCK_SOURCE;
 
 
@@ -52,12 +62,18 @@ public:
     void testMediaPlaylist();
     void testBuildMasterPlaylist();
     void testBuildMediaPlaylist();
+    void testBuildLowLatencyPlaylist();
+    void testPrefetch();
+    void testPrefetchAbort();
 
     TSUNIT_TEST_BEGIN(HLSTest);
     TSUNIT_TEST(testMasterPlaylist);
     TSUNIT_TEST(testMediaPlaylist);
     TSUNIT_TEST(testBuildMasterPlaylist);
     TSUNIT_TEST(testBuildMediaPlaylist);
+    TSUNIT_TEST(testBuildLowLatencyPlaylist);
+    TSUNIT_TEST(testPrefetch);
+    TSUNIT_TEST(testPrefetchAbort);
     TSUNIT_TEST_END();
 
 private:
@@ -327,3 +343,284 @@ void HLSTest::testBuildMediaPlaylist()
 
     TSUNIT_EQUAL(refContent2, pl.textContent());
 }
+
+void HLSTest::testBuildLowLatencyPlaylist()
+{
+    ts::hls::PlayList pl;
+    pl.reset(ts::hls::MEDIA_PLAYLIST, u"/c/test/path/master/test.m3u8", 6);
+
+    TSUNIT_ASSERT(pl.setTargetDuration(2));
+    TSUNIT_ASSERT(pl.setPartTargetDuration(1000));
+    TSUNIT_EQUAL(1000, pl.partTargetDuration());
+
+    // Four complete segments with two partial segments each.
+    for (int i = 1; i <= 4; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            ts::hls::MediaPart part;
+            part.uri = ts::UString::Format(u"/c/test/path/segments/seg-%04d.%d.ts", {i, j});
+            part.duration = 1000;
+            part.independent = j == 0;
+            TSUNIT_ASSERT(pl.addPartialSegment(part));
+        }
+        TSUNIT_EQUAL(2, pl.partialSegmentCount());
+        ts::hls::MediaSegment seg;
+        seg.uri = ts::UString::Format(u"/c/test/path/segments/seg-%04d.ts", {i});
+        seg.duration = 2000;
+        TSUNIT_ASSERT(pl.addSegment(seg));
+        TSUNIT_EQUAL(0, pl.partialSegmentCount());
+        TSUNIT_EQUAL(2, pl.segment(i - 1).parts.size());
+    }
+
+    // One partial segment of the next segment.
+    ts::hls::MediaPart part;
+    part.uri = u"/c/test/path/segments/seg-0005.0.ts";
+    part.duration = 960;
+    TSUNIT_ASSERT(pl.addPartialSegment(part));
+    TSUNIT_ASSERT(pl.setPreloadHint(u"/c/test/path/segments/seg-0005.1.ts"));
+
+    // Partial segments of the first segment are more than 3 target durations from the end.
+    static const ts::UChar* const refContent =
+        u"#EXTM3U\n"
+        u"#EXT-X-VERSION:6\n"
+        u"#EXT-X-TARGETDURATION:2\n"
+        u"#EXT-X-MEDIA-SEQUENCE:0\n"
+        u"#EXT-X-SERVER-CONTROL:PART-HOLD-BACK=3.000\n"
+        u"#EXT-X-PART-INF:PART-TARGET=1.000\n"
+        u"#EXTINF:2.000,\n"
+        u"../segments/seg-0001.ts\n"
+        u"#EXT-X-PART:DURATION=1.000,URI=\"../segments/seg-0002.0.ts\",INDEPENDENT=YES\n"
+        u"#EXT-X-PART:DURATION=1.000,URI=\"../segments/seg-0002.1.ts\"\n"
+        u"#EXTINF:2.000,\n"
+        u"../segments/seg-0002.ts\n"
+        u"#EXT-X-PART:DURATION=1.000,URI=\"../segments/seg-0003.0.ts\",INDEPENDENT=YES\n"
+        u"#EXT-X-PART:DURATION=1.000,URI=\"../segments/seg-0003.1.ts\"\n"
+        u"#EXTINF:2.000,\n"
+        u"../segments/seg-0003.ts\n"
+        u"#EXT-X-PART:DURATION=1.000,URI=\"../segments/seg-0004.0.ts\",INDEPENDENT=YES\n"
+        u"#EXT-X-PART:DURATION=1.000,URI=\"../segments/seg-0004.1.ts\"\n"
+        u"#EXTINF:2.000,\n"
+        u"../segments/seg-0004.ts\n"
+        u"#EXT-X-PART:DURATION=0.960,URI=\"../segments/seg-0005.0.ts\"\n"
+        u"#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"../segments/seg-0005.1.ts\"\n";
+
+    TSUNIT_EQUAL(refContent, pl.textContent());
+
+    // The loaded playlist is still a valid media playlist.
+    ts::hls::PlayList pl2;
+    TSUNIT_ASSERT(pl2.loadText(refContent, true, ts::hls::MEDIA_PLAYLIST, CERR));
+    TSUNIT_EQUAL(4, pl2.segmentCount());
+    TSUNIT_EQUAL(u"../segments/seg-0004.ts", pl2.segment(3).uri);
+}
+
+
+//----------------------------------------------------------------------------
+// HLS input with prefetch, using a local HTTP server.
+//----------------------------------------------------------------------------
+
+#if !defined(TS_NO_CURL)
+namespace {
+
+    // Local HTTP server port and number of TS packets per media segment.
+    constexpr uint16_t HTTP_PORT = 12347;
+    constexpr size_t SEGMENT_PACKETS = 100;
+
+    // Packets received by the test output plugin and order errors.
+    std::atomic<ts::PacketCounter> _hls_output_count(0);
+    std::atomic<ts::PacketCounter> _hls_output_errors(0);
+
+    // Output plugin: count packets and check their order using the index in their payload.
+    class HLSTestOutput: public ts::OutputPlugin
+    {
+        TS_NOBUILD_NOCOPY(HLSTestOutput);
+    public:
+        HLSTestOutput(ts::TSP* t) : ts::OutputPlugin(t, u"Count HLS test packets", u"[options]") {}
+        virtual bool send(const ts::TSPacket* buffer, const ts::TSPacketMetadata*, size_t packet_count) override
+        {
+            for (size_t i = 0; i < packet_count; ++i) {
+                if (ts::GetUInt32(buffer[i].getPayload()) != uint32_t(_hls_output_count++)) {
+                    _hls_output_errors++;
+                }
+            }
+            return true;
+        }
+    };
+
+    ts::InputPlugin* NewHLSTestInput(ts::TSP* t) { return new ts::hls::InputPlugin(t); }
+    ts::OutputPlugin* NewHLSTestOutput(ts::TSP* t) { return new HLSTestOutput(t); }
+
+    ts::PluginRepository::Register _reg_hls_input("utest_hls_input", NewHLSTestInput);
+    ts::PluginRepository::Register _reg_hls_output("utest_hls_output", NewHLSTestOutput);
+
+    // A minimal HTTP server which serves a media playlist and its segments.
+    // Each request uses its own connection, requests are served one at a time.
+    // In stall mode, the segments are sent very slowly, one packet at a time.
+    class HTTPServer: public utest::TSUnitThread
+    {
+        TS_NOBUILD_NOCOPY(HTTPServer);
+    public:
+        HTTPServer(size_t segment_count, size_t request_count, bool stall) :
+            utest::TSUnitThread(),
+            _server(),
+            _segment_count(segment_count),
+            _request_count(request_count),
+            _stall(stall)
+        {
+        }
+
+        ~HTTPServer()
+        {
+            waitForTermination();
+        }
+
+        // Open the listening socket, before starting the thread.
+        bool open()
+        {
+            return _server.open(CERR) &&
+                _server.reusePort(true, CERR) &&
+                _server.bind(ts::SocketAddress(ts::IPAddress::LocalHost, HTTP_PORT), CERR) &&
+                _server.listen(5, CERR);
+        }
+
+        virtual void test() override
+        {
+            for (size_t count = 0; count < _request_count; ++count) {
+                ts::TCPConnection client;
+                ts::SocketAddress addr;
+                if (!_server.accept(client, addr, CERR)) {
+                    break;
+                }
+                serve(client);
+                client.disconnect(NULLREP);
+                client.close(NULLREP);
+            }
+            // Pending connections, if any, are reset.
+            _server.close(NULLREP);
+        }
+
+    private:
+        ts::TCPServer _server;
+        size_t _segment_count;
+        size_t _request_count;
+        bool   _stall;
+
+        void serve(ts::TCPConnection& client)
+        {
+            // Read the request header.
+            std::string request;
+            char buffer[1024];
+            size_t size = 0;
+            while (request.find("\r\n\r\n") == std::string::npos && client.receive(buffer, sizeof(buffer), size, nullptr, NULLREP)) {
+                request.append(buffer, size);
+            }
+            const size_t start = request.find(' ') + 1;
+            const std::string path(request.substr(start, request.find(' ', start) - start));
+            CERR.debug(u"HTTPServer: request %s", {path});
+
+            if (path == "/media.m3u8") {
+                std::string playlist("#EXTM3U\n#EXT-X-VERSION:3\n#EXT-X-TARGETDURATION:1\n#EXT-X-MEDIA-SEQUENCE:0\n");
+                for (size_t seg = 0; seg < _segment_count; ++seg) {
+                    playlist += "#EXTINF:1.0,\nseg" + std::to_string(seg) + ".ts\n";
+                }
+                playlist += "#EXT-X-ENDLIST\n";
+                sendHeader(client, "application/vnd.apple.mpegurl", playlist.size());
+                client.send(playlist.data(), playlist.size(), NULLREP);
+            }
+            else if (path.find("/seg") == 0) {
+                const size_t seg = std::stoul(path.substr(4));
+                ts::TSPacketVector packets(SEGMENT_PACKETS);
+                for (size_t i = 0; i < packets.size(); ++i) {
+                    const size_t index = seg * SEGMENT_PACKETS + i;
+                    packets[i].init(100, uint8_t(index % ts::CC_MAX));
+                    ts::PutUInt32(packets[i].getPayload(), uint32_t(index));
+                }
+                if (_stall) {
+                    // Announce a much larger segment and send it slowly, for 10 seconds at most.
+                    sendHeader(client, "video/mp2t", 100 * ts::PKT_SIZE * packets.size());
+                    for (size_t i = 0; i < 200 && client.send(&packets[i % packets.size()], ts::PKT_SIZE, NULLREP); ++i) {
+                        ts::SleepThread(50);
+                    }
+                }
+                else {
+                    sendHeader(client, "video/mp2t", ts::PKT_SIZE * packets.size());
+                    client.send(packets.data(), ts::PKT_SIZE * packets.size(), NULLREP);
+                }
+            }
+            else {
+                const std::string header("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+                client.send(header.data(), header.size(), NULLREP);
+            }
+        }
+
+        static void sendHeader(ts::TCPConnection& client, const std::string& type, size_t size)
+        {
+            const std::string header("HTTP/1.1 200 OK\r\nContent-Type: " + type + "\r\nContent-Length: " + std::to_string(size) + "\r\nConnection: close\r\n\r\n");
+            client.send(header.data(), header.size(), NULLREP);
+        }
+    };
+
+    // Build the tsp arguments to read the local playlist.
+    void HLSTestArgs(ts::TSProcessorArgs& args)
+    {
+        args.app_name = u"utest";
+        args.input.set(u"utest_hls_input", {ts::UString::Format(u"http://127.0.0.1:%d/media.m3u8", {HTTP_PORT}), u"--prefetch", u"3"});
+        args.output.set(u"utest_hls_output");
+        _hls_output_count = 0;
+        _hls_output_errors = 0;
+    }
+}
+#endif
+
+void HLSTest::testPrefetch()
+{
+#if defined(TS_NO_CURL)
+    debug() << "HLSTest::testPrefetch: no Web support, skipped" << std::endl;
+#else
+    ts::IgnorePipeSignal();
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    // Playlist + 5 segments.
+    HTTPServer server(5, 6, false);
+    TSUNIT_ASSERT(server.open());
+    TSUNIT_ASSERT(server.start());
+
+    ts::TSProcessorArgs args;
+    HLSTestArgs(args);
+    ts::TSProcessor tsproc(CERR);
+    TSUNIT_ASSERT(tsproc.start(args));
+    tsproc.waitForTermination();
+
+    // All segments are received, in order.
+    TSUNIT_EQUAL(5 * SEGMENT_PACKETS, _hls_output_count.load());
+    TSUNIT_EQUAL(0, _hls_output_errors.load());
+#endif
+}
+
+void HLSTest::testPrefetchAbort()
+{
+#if defined(TS_NO_CURL)
+    debug() << "HLSTest::testPrefetchAbort: no Web support, skipped" << std::endl;
+#else
+    ts::IgnorePipeSignal();
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    // Playlist + 1 stalled segment, the other prefetch connections are reset.
+    HTTPServer server(5, 2, true);
+    TSUNIT_ASSERT(server.open());
+    TSUNIT_ASSERT(server.start());
+
+    ts::TSProcessorArgs args;
+    HLSTestArgs(args);
+    ts::TSProcessor tsproc(CERR);
+    TSUNIT_ASSERT(tsproc.start(args));
+
+    // Let the download start, then abort. The server stalls for 10 seconds,
+    // the termination must not wait for the end of the segment download.
+    ts::SleepThread(1000);
+    const ts::Monotonic start(true);
+    tsproc.abort();
+    tsproc.waitForTermination();
+    const ts::NanoSecond duration = ts::Monotonic(true) - start;
+    debug() << "HLSTest::testPrefetchAbort: termination in " << (duration / ts::NanoSecPerMilliSec) << " ms" << std::endl;
+    TSUNIT_ASSERT(duration < 5 * ts::NanoSecPerSec);
+#endif
+}
@@ -0,0 +1,456 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::HitlessMerger
+//
+//----------------------------------------------------------------------------
+
+#include "tsHitlessMerger.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class HitlessMergerTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testFingerprint();
+    void testDuplicates();
+    void testLossRecovery();
+    void testInterleavedLoss();
+    void testDelay();
+    void testRepeatedPackets();
+
+    TSUNIT_TEST_BEGIN(HitlessMergerTest);
+    TSUNIT_TEST(testFingerprint);
+    TSUNIT_TEST(testDuplicates);
+    TSUNIT_TEST(testLossRecovery);
+    TSUNIT_TEST(testInterleavedLoss);
+    TSUNIT_TEST(testDelay);
+    TSUNIT_TEST(testRepeatedPackets);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(HitlessMergerTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void HitlessMergerTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void HitlessMergerTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// A synthetic input: a stream of fingerprints with reception times.
+// The output packets contain their fingerprint in the payload.
+//----------------------------------------------------------------------------
+
+namespace {
+    class TestInput: public ts::HitlessMerger::InputInterface
+    {
+    public:
+        TestInput() : _packets() {}
+
+        // Add fingerprints first to last, received every step milliseconds from arrival.
+        // Simulate losses: skip multiples of skipEvery and fingerprints skipFirst to skipLast.
+        void add(uint64_t first, uint64_t last, const ts::Time& arrival, ts::MilliSecond step = 0, uint64_t skipEvery = 0, uint64_t skipFirst = 1, uint64_t skipLast = 0)
+        {
+            for (uint64_t fp = first; fp <= last; ++fp) {
+                if ((fp < skipFirst || fp > skipLast) && (skipEvery == 0 || fp % skipEvery != 0)) {
+                    Entry entry(fp, arrival + ts::MilliSecond(fp - first) * step, ts::NullPacket);
+                    entry.packet.setPID(100);
+                    ts::PutUInt64(entry.packet.b + 4, fp);
+                    _packets.push_back(entry);
+                }
+            }
+        }
+
+        // Add real packets, except lost ones, with their fingerprints.
+        void add(const ts::TSPacketVector& packets, const std::set<size_t>& lost, const ts::Time& arrival)
+        {
+            ts::HitlessMerger::Fingerprinter fingerprinter(1000);
+            ts::TSPacketMetadata mdata;
+            for (size_t i = 0; i < packets.size(); ++i) {
+                if (lost.count(i) == 0) {
+                    _packets.push_back(Entry(fingerprinter.fingerprint(packets[i], mdata), arrival, packets[i]));
+                }
+            }
+        }
+
+        size_t size() const { return _packets.size(); }
+
+        virtual bool getFingerprint(size_t index, uint64_t& fingerprint, ts::Time& arrival) override
+        {
+            if (index >= _packets.size()) {
+                return false;
+            }
+            fingerprint = _packets[index].fingerprint;
+            arrival = _packets[index].arrival;
+            return true;
+        }
+
+        virtual size_t findFingerprint(uint64_t fingerprint) override
+        {
+            for (size_t index = 0; index < _packets.size(); ++index) {
+                if (_packets[index].fingerprint == fingerprint) {
+                    return index;
+                }
+            }
+            return ts::NPOS;
+        }
+
+        virtual bool extractPacket(uint64_t fingerprint, ts::TSPacket* packet, ts::TSPacketMetadata*) override
+        {
+            if (_packets.empty() || _packets.front().fingerprint != fingerprint) {
+                return false;
+            }
+            if (packet != nullptr) {
+                *packet = _packets.front().packet;
+            }
+            _packets.pop_front();
+            return true;
+        }
+
+    private:
+        struct Entry
+        {
+            Entry(uint64_t fp, const ts::Time& time, const ts::TSPacket& pkt) : fingerprint(fp), arrival(time), packet(pkt) {}
+            uint64_t     fingerprint;
+            ts::Time     arrival;
+            ts::TSPacket packet;
+        };
+        std::deque<Entry> _packets;
+    };
+
+    // Check that merged packets contain the fingerprints first to last.
+    void CheckOutput(const ts::TSPacketVector& packets, size_t count, uint64_t first, uint64_t last)
+    {
+        TSUNIT_EQUAL(last - first + 1, count);
+        for (size_t i = 0; i < count && i < packets.size(); ++i) {
+            TSUNIT_EQUAL(first + i, ts::GetUInt64(packets[i].b + 4));
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void HitlessMergerTest::testFingerprint()
+{
+    // Two identical streams with null packets.
+    ts::TSPacketVector packets(10, ts::NullPacket);
+    packets[2].setPID(100);
+    packets[6].setPID(100);
+    packets[6].setCC(2);
+    packets[7].setPID(100);
+    packets[7].setCC(1);
+
+    const ts::TSPacketMetadata mdata;
+    ts::HitlessMerger::Fingerprinter fp1(100);
+    ts::HitlessMerger::Fingerprinter fp2(100);
+    std::set<uint64_t> all;
+    for (size_t i = 0; i < packets.size(); ++i) {
+        const uint64_t f1 = fp1.fingerprint(packets[i], mdata);
+        TSUNIT_EQUAL(f1, fp2.fingerprint(packets[i], mdata));
+        all.insert(f1);
+    }
+    // All null packets are distinct, including between non-null packets.
+    TSUNIT_EQUAL(packets.size(), all.size());
+
+    // Same sequence after reset.
+    fp1.reset();
+    fp2.reset();
+    TSUNIT_EQUAL(fp1.fingerprint(packets[0], mdata), fp2.fingerprint(packets[0], mdata));
+    TSUNIT_EQUAL(1, all.count(fp1.fingerprint(packets[1], mdata)));
+
+    // Null packets are identified by their position after the last non-null packet.
+    ts::HitlessMerger::Fingerprinter fp3(100);
+    const uint64_t n1 = fp3.fingerprint(packets[1], mdata);
+    TSUNIT_ASSERT(n1 != fp3.fingerprint(packets[1], mdata));
+    const uint64_t p2 = fp3.fingerprint(packets[2], mdata);
+    const uint64_t n3 = fp3.fingerprint(packets[3], mdata);
+    TSUNIT_ASSERT(n3 != n1);
+
+    // A repeated packet in the window is identified by its position.
+    const uint64_t p2bis = fp3.fingerprint(packets[2], mdata);
+    TSUNIT_ASSERT(p2bis != p2);
+    TSUNIT_ASSERT(n3 != fp3.fingerprint(packets[3], mdata));
+    TSUNIT_ASSERT(p2bis != fp3.fingerprint(packets[2], mdata));
+
+    // The first occurrence in a window is identified by its content only, independently of previous losses.
+    ts::HitlessMerger::Fingerprinter fp4(100);
+    TSUNIT_EQUAL(p2, fp4.fingerprint(packets[2], mdata));
+
+    // With RTP, identical packets are identified by their sequence number and index in datagram.
+    ts::TSPacketMetadata rtp1;
+    ts::TSPacketMetadata rtp2;
+    rtp1.setRTPSequence(1000);
+    rtp2.setRTPSequence(1001);
+    ts::HitlessMerger::Fingerprinter fp5(100);
+    ts::HitlessMerger::Fingerprinter fp6(100);
+    const uint64_t r1 = fp5.fingerprint(packets[2], rtp1);
+    const uint64_t r2 = fp5.fingerprint(packets[2], rtp1);
+    const uint64_t r3 = fp5.fingerprint(packets[2], rtp2);
+    TSUNIT_ASSERT(r1 != r2);
+    TSUNIT_ASSERT(r1 != r3);
+    TSUNIT_ASSERT(r2 != r3);
+    TSUNIT_ASSERT(r1 != p2);
+    // Same RTP packets on another input, after the loss of the first datagram.
+    TSUNIT_EQUAL(r3, fp6.fingerprint(packets[2], rtp2));
+
+    // RTP sequence numbers are ignored on request.
+    ts::HitlessMerger::Fingerprinter fp7(100, false);
+    TSUNIT_EQUAL(p2, fp7.fingerprint(packets[2], rtp1));
+}
+
+void HitlessMergerTest::testDuplicates()
+{
+    const ts::Time start(ts::Time::CurrentUTC());
+    TestInput in0;
+    TestInput in1;
+    in0.add(1, 100, start);
+    in1.add(1, 100, start);
+
+    ts::HitlessMerger merger(100, 1000);
+    TSUNIT_EQUAL(0, merger.addInput(&in0));
+    TSUNIT_EQUAL(1, merger.addInput(&in1));
+    merger.setRunning(0, true);
+    merger.setRunning(1, true);
+
+    ts::TSPacketVector packets(1000);
+    ts::TSPacketMetadataVector mdata(packets.size());
+    ts::MilliSecond timeout = ts::Infinite;
+
+    // Received at the same time, preferred input is 1.
+    const size_t count = merger.merge(packets.data(), mdata.data(), packets.size(), 1, start, timeout);
+    CheckOutput(packets, count, 1, 100);
+    TSUNIT_EQUAL(ts::Infinite, timeout);
+    TSUNIT_EQUAL(0, merger.outputPackets(0));
+    TSUNIT_EQUAL(100, merger.outputPackets(1));
+    TSUNIT_EQUAL(0, merger.recoveredPackets(0));
+    TSUNIT_EQUAL(0, merger.recoveredPackets(1));
+    TSUNIT_EQUAL(0, in0.size());
+    TSUNIT_EQUAL(0, in1.size());
+
+    // Limited output size.
+    in0.add(101, 150, start + 20);
+    in1.add(101, 150, start + 20);
+    TSUNIT_EQUAL(20, merger.merge(packets.data(), mdata.data(), 20, 0, start + 20, timeout));
+    CheckOutput(packets, 20, 101, 120);
+    CheckOutput(packets, merger.merge(packets.data(), mdata.data(), packets.size(), 0, start + 20, timeout), 121, 150);
+    TSUNIT_EQUAL(50, merger.outputPackets(0));
+    TSUNIT_EQUAL(100, merger.outputPackets(1));
+}
+
+void HitlessMergerTest::testLossRecovery()
+{
+    const ts::Time start(ts::Time::CurrentUTC());
+    TestInput in0;
+    TestInput in1;
+    TestInput in2;
+    in0.add(1, 100, start, 0, 0, 10, 19);
+    in1.add(1, 100, start, 0, 0, 50, 59);
+    in2.add(1, 100, start);
+
+    ts::HitlessMerger merger(100, 1000);
+    merger.addInput(&in0);
+    merger.addInput(&in1);
+    merger.addInput(&in2);
+    merger.setRunning(0, true);
+    merger.setRunning(1, true);
+    merger.setRunning(2, false);
+
+    // Input 2 does not run, its packets are ignored.
+    ts::TSPacketVector packets(1000);
+    ts::TSPacketMetadataVector mdata(packets.size());
+    ts::MilliSecond timeout = ts::Infinite;
+    const size_t count = merger.merge(packets.data(), mdata.data(), packets.size(), 0, start, timeout);
+    CheckOutput(packets, count, 1, 100);
+    TSUNIT_EQUAL(90, merger.outputPackets(0));
+    TSUNIT_EQUAL(10, merger.outputPackets(1));
+    TSUNIT_EQUAL(0, merger.outputPackets(2));
+    TSUNIT_EQUAL(10, merger.recoveredPackets(0));
+    TSUNIT_EQUAL(10, merger.recoveredPackets(1));
+    TSUNIT_EQUAL(100, in2.size());
+}
+
+void HitlessMergerTest::testInterleavedLoss()
+{
+    // Frequent losses on both inputs, sometimes the same packet. One packet per millisecond,
+    // input 1 has 5 ms more latency. Input 0 must not be preferred when it lost the next packet.
+    const ts::Time start(ts::Time::CurrentUTC());
+    TestInput in0;
+    TestInput in1;
+    in0.add(1, 1000, start, 1, 7);
+    in1.add(1, 1000, start + 5, 1, 11);
+
+    ts::HitlessMerger merger(100, 10000);
+    merger.addInput(&in0);
+    merger.addInput(&in1);
+    merger.setRunning(0, true);
+    merger.setRunning(1, true);
+
+    ts::TSPacketVector packets(2000);
+    ts::TSPacketMetadataVector mdata(packets.size());
+    ts::MilliSecond timeout = ts::Infinite;
+    const size_t count = merger.merge(packets.data(), mdata.data(), packets.size(), 0, start + 2000, timeout);
+
+    // Packets which are lost on both inputs are missing.
+    size_t index = 0;
+    for (uint64_t fp = 1; fp <= 1000; ++fp) {
+        if (fp % 77 != 0) {
+            TSUNIT_ASSERT(index < count);
+            TSUNIT_EQUAL(fp, ts::GetUInt64(packets[index++].b + 4));
+        }
+    }
+    TSUNIT_EQUAL(index, count);
+    TSUNIT_EQUAL(1000 / 7 - 1000 / 77, merger.recoveredPackets(1));
+    TSUNIT_EQUAL(1000 / 11 - 1000 / 77, merger.recoveredPackets(0));
+}
+
+void HitlessMergerTest::testDelay()
+{
+    const ts::Time start(ts::Time::CurrentUTC());
+    TestInput in0;
+    TestInput in1;
+    in0.add(1, 10, start);
+
+    ts::HitlessMerger merger(100, 1000);
+    merger.addInput(&in0);
+    merger.addInput(&in1);
+    merger.setRunning(0, true);
+    merger.setRunning(1, true);
+
+    ts::TSPacketVector packets(1000);
+    ts::TSPacketMetadataVector mdata(packets.size());
+    ts::MilliSecond timeout = ts::Infinite;
+
+    // Input 1 is late, wait for it up to the maximum delay.
+    TSUNIT_EQUAL(0, merger.merge(packets.data(), mdata.data(), packets.size(), 0, start + 30, timeout));
+    TSUNIT_EQUAL(70, timeout);
+    timeout = ts::Infinite;
+    CheckOutput(packets, merger.merge(packets.data(), mdata.data(), packets.size(), 0, start + 100, timeout), 1, 10);
+    TSUNIT_EQUAL(ts::Infinite, timeout);
+
+    // Late packets from input 1 are dropped, input 0 is late for the next ones.
+    in1.add(1, 12, start + 150);
+    TSUNIT_EQUAL(0, merger.merge(packets.data(), mdata.data(), packets.size(), 0, start + 150, timeout));
+    TSUNIT_EQUAL(100, timeout);
+    TSUNIT_EQUAL(2, in1.size());
+
+    // Do not wait for an input which is no longer running.
+    merger.setRunning(0, false);
+    timeout = ts::Infinite;
+    CheckOutput(packets, merger.merge(packets.data(), mdata.data(), packets.size(), 0, start + 150, timeout), 11, 12);
+    TSUNIT_EQUAL(ts::Infinite, timeout);
+    TSUNIT_EQUAL(10, merger.outputPackets(0));
+    TSUNIT_EQUAL(2, merger.outputPackets(1));
+}
+
+void HitlessMergerTest::testRepeatedPackets()
+{
+    // A stream with identical packets: a table packet which is repeated with the same continuity
+    // counter, runs of stuffing packets in a PID and null packets. Other packets are unique.
+    ts::TSPacket table(ts::NullPacket);
+    table.setPID(0);
+    ts::TSPacket stuffing(ts::NullPacket);
+    stuffing.setPID(200);
+
+    ts::TSPacketVector packets(300);
+    for (size_t i = 0; i < packets.size(); ++i) {
+        switch (i % 10) {
+            case 0:
+                packets[i] = table;
+                break;
+            case 4: case 5: case 6:
+                packets[i] = stuffing;
+                break;
+            case 8:
+                packets[i] = ts::NullPacket;
+                break;
+            default:
+                packets[i] = ts::NullPacket;
+                packets[i].setPID(100);
+                packets[i].setCC(uint8_t(i));
+                ts::PutUInt64(packets[i].b + 4, i);
+                break;
+        }
+    }
+
+    // Losses on both inputs, sometimes on repeated packets. Packet 133 is lost on both.
+    const std::set<size_t> lost0({2, 10, 45, 133, 201, 242});
+    const std::set<size_t> lost1({22, 50, 64, 88, 133, 170, 255});
+
+    const ts::Time start(ts::Time::CurrentUTC());
+    TestInput in0;
+    TestInput in1;
+    in0.add(packets, lost0, start);
+    in1.add(packets, lost1, start);
+
+    ts::HitlessMerger merger(100, 1000);
+    merger.addInput(&in0);
+    merger.addInput(&in1);
+    merger.setRunning(0, true);
+    merger.setRunning(1, true);
+
+    ts::TSPacketVector output(1000);
+    ts::TSPacketMetadataVector mdata(output.size());
+    ts::MilliSecond timeout = ts::Infinite;
+    const size_t count = merger.merge(output.data(), mdata.data(), output.size(), 0, start, timeout);
+
+    // All packets are output once, in order, except the packet which is lost on both inputs.
+    TSUNIT_EQUAL(packets.size() - 1, count);
+    for (size_t i = 0, index = 0; i < packets.size() && index < count; ++i) {
+        if (i != 133) {
+            TSUNIT_ASSERT(output[index++] == packets[i]);
+        }
+    }
+    TSUNIT_EQUAL(0, in0.size());
+    TSUNIT_EQUAL(0, in1.size());
+    TSUNIT_EQUAL(lost0.size() - 1, merger.recoveredPackets(1));
+    TSUNIT_EQUAL(lost1.size() - 1, merger.recoveredPackets(0));
+}
@@ -34,6 +34,8 @@
 #include "tsNames.h"
 #include "tsMPEG.h"
 #include "tsSysUtils.h"
+#include "tsCerrReport.h"
+#include "tsTablesFactory.h"
 #include "tsunit.h"
 TSDUCK_SOURCE;
 
@@ -83,6 +85,7 @@ public:
     void testAudioType();
     void testT2MIPacketType();
     void testPlatformId();
+    void testIndex();
 
     TSUNIT_TEST_BEGIN(NamesTest);
     TSUNIT_TEST(testConfigFile);
@@ -120,6 +123,7 @@ public:
     TSUNIT_TEST(testAudioType);
     TSUNIT_TEST(testT2MIPacketType);
     TSUNIT_TEST(testPlatformId);
+    TSUNIT_TEST(testIndex);
     TSUNIT_TEST_END();
 };
 
@@ -375,3 +379,58 @@ void NamesTest::testPlatformId()
     TSUNIT_EQUAL(u"0x000004 (TV digitale mobile, Telecom Italia)", ts::names::PlatformId(4, ts::names::FIRST));
     TSUNIT_EQUAL(u"VTC Mobile TV (0x704001)", ts::names::PlatformId(0x704001, ts::names::VALUE));
 }
+
+void NamesTest::testIndex()
+{
+    // Compile a copy of the main names file.
+    const ts::UString textFile(ts::TempFile(u".names"));
+    const ts::UString indexFile(textFile + TS_NAMES_INDEX_SUFFIX);
+    ts::UStringList lines;
+    TSUNIT_ASSERT(ts::UString::Load(lines, ts::NamesMain::Instance()->configurationFile()));
+    TSUNIT_ASSERT(ts::UString::Save(lines, textFile));
+    TSUNIT_ASSERT(ts::Names::CompileIndex(textFile, indexFile, CERR));
+
+    const ts::Names* ref = ts::NamesMain::Instance();
+    {
+        const ts::Names names(textFile);
+        debug() << "NamesTest: index file: " << names.indexFile() << std::endl;
+        TSUNIT_EQUAL(indexFile, names.indexFile());
+        TSUNIT_EQUAL(0, names.errorCount());
+
+        for (ts::Names::Value v = 0; v < 0x10000; ++v) {
+            TSUNIT_EQUAL(ref->nameFromSection(u"CASystemId", v, ts::names::VALUE, 16), names.nameFromSection(u"CASystemId", v, ts::names::VALUE, 16));
+            TSUNIT_EQUAL(ref->nameFromSection(u"ComponentType", v), names.nameFromSection(u"ComponentType", v));
+        }
+        for (ts::Names::Value v = 0; v < 0x100; ++v) {
+            TSUNIT_EQUAL(ref->nameExists(u"DescriptorId", v), names.nameExists(u"DescriptorId", v));
+            TSUNIT_EQUAL(ref->nameFromSectionWithFallback(u"TableId", 0x0400 | v, v, ts::names::FIRST), names.nameFromSectionWithFallback(u"TableId", 0x0400 | v, v, ts::names::FIRST));
+        }
+        TSUNIT_EQUAL(u"EACEM/EICTA", names.nameFromSection(u" privateDataSpecifier ", 0x28));
+        TSUNIT_EQUAL(u"unknown (0x12)", names.nameFromSection(u"NonExistentSection", 0x12, ts::names::NAME, 8));
+    }
+
+    // A name from an extension section without "Bits" line uses the size of the base section in the index.
+    const ts::UString extFile(ts::TempFile(u".names"));
+    TSUNIT_ASSERT(ts::UString::Save(ts::UStringList({u"[CASystemId]", u"0x0003 = Test extension CAS"}), extFile));
+    ts::TablesFactory::RegisterNames registerExtension(extFile);
+    {
+        const ts::Names names(textFile, true);
+        TSUNIT_EQUAL(indexFile, names.indexFile());
+        TSUNIT_EQUAL(0, names.errorCount());
+        TSUNIT_EQUAL(u"Test extension CAS (0x0003)", names.nameFromSection(u"CASystemId", 0x0003, ts::names::VALUE));
+        TSUNIT_EQUAL(u"18Crypt (0x0002)", names.nameFromSection(u"CASystemId", 0x0002, ts::names::VALUE));
+    }
+    ts::DeleteFile(extFile);
+
+    // The index is ignored when the text file is modified.
+    lines.push_back(u"# modified");
+    TSUNIT_ASSERT(ts::UString::Save(lines, textFile));
+    {
+        const ts::Names names(textFile);
+        TSUNIT_ASSERT(names.indexFile().empty());
+        TSUNIT_EQUAL(u"EACEM/EICTA", names.nameFromSection(u"PrivateDataSpecifier", 0x28));
+    }
+
+    ts::DeleteFile(textFile);
+    ts::DeleteFile(indexFile);
+}
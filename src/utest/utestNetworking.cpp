@@ -39,6 +39,8 @@
 #include "tsTCPConnection.h"
 #include "tsTCPServer.h"
 #include "tsUDPSocket.h"
+#include "tsByteBlock.h"
+#include "tsTime.h"
 #include "tsThread.h"
 #include "tsSysUtils.h"
 #include "tsIPUtils.h"
@@ -69,6 +71,7 @@ public:
     void testSocketAddress();
     void testTCPSocket();
     void testUDPSocket();
+    void testUDPBatch();
     void testIPHeader();
 
     TSUNIT_TEST_BEGIN(NetworkingTest);
@@ -81,6 +84,7 @@ public:
     TSUNIT_TEST(testSocketAddress);
     TSUNIT_TEST(testTCPSocket);
     TSUNIT_TEST(testUDPSocket);
+    TSUNIT_TEST(testUDPBatch);
     TSUNIT_TEST(testIPHeader);
     TSUNIT_TEST_END();
 
@@ -680,6 +684,72 @@ void NetworkingTest::testUDPSocket()
     CERR.debug(u"UDPSocketTest: main thread: reply sent");
 }
 
+// Test batch send and receive.
+void NetworkingTest::testUDPBatch()
+{
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    const uint16_t portNumber = 12346;
+    const size_t msg_size = 7 * 188;
+    const size_t msg_count = 20;
+    const size_t last_size = 188;
+    const size_t total_size = (msg_count - 1) * msg_size + last_size;
+
+    // Receiver socket.
+    ts::UDPSocket receiver(true);
+    TSUNIT_ASSERT(receiver.isOpen());
+    TSUNIT_ASSERT(receiver.setReceiveBufferSize(1024 * 1024, CERR));
+    TSUNIT_ASSERT(receiver.setReceiveTimeout(5000, CERR));
+    TSUNIT_ASSERT(receiver.reusePort(true, CERR));
+    TSUNIT_ASSERT(receiver.bind(ts::SocketAddress(ts::IPAddress::LocalHost, portNumber), CERR));
+#if !defined(TS_WINDOWS)
+    TSUNIT_ASSERT(receiver.setReceiveTimestamps(true, CERR));
+#endif
+
+    // Sender socket, send all messages at once.
+    ts::UDPSocket sender(true);
+    TSUNIT_ASSERT(sender.isOpen());
+    TSUNIT_ASSERT(sender.bind(ts::SocketAddress(ts::IPAddress::LocalHost, ts::SocketAddress::AnyPort), CERR));
+    TSUNIT_ASSERT(sender.setDefaultDestination(ts::SocketAddress(ts::IPAddress::LocalHost, portNumber), CERR));
+
+    ts::ByteBlock data(total_size);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = uint8_t(i / msg_size + i);
+    }
+    const ts::MicroSecond before = (ts::Time::CurrentUTC() - ts::Time::UnixEpoch) * 1000;
+    TSUNIT_ASSERT(sender.sendBatch(data.data(), data.size(), msg_size, CERR));
+    const ts::MicroSecond after = (ts::Time::CurrentUTC() - ts::Time::UnixEpoch) * 1000;
+
+    // Receive all messages, possibly in several batches.
+    const size_t max_count = 8;
+    ts::ByteBlock buffer(max_count * msg_size);
+    size_t sizes[max_count];
+    ts::SocketAddress senders[max_count];
+    ts::SocketAddress destinations[max_count];
+    ts::MicroSecond timestamps[max_count];
+    size_t received = 0;
+
+    while (received < msg_count) {
+        size_t count = 0;
+        TSUNIT_ASSERT(receiver.receiveBatch(buffer.data(), msg_size, max_count, count, sizes, senders, destinations, timestamps, nullptr, CERR));
+        TSUNIT_ASSERT(count > 0);
+        TSUNIT_ASSERT(count <= max_count);
+        debug() << "NetworkingTest::testUDPBatch: received " << count << " messages" << std::endl;
+        for (size_t i = 0; i < count && received < msg_count; ++i, ++received) {
+            const size_t expected = received == msg_count - 1 ? last_size : msg_size;
+            TSUNIT_EQUAL(expected, sizes[i]);
+            TSUNIT_ASSERT(ts::IPAddress(senders[i]) == ts::IPAddress::LocalHost);
+            TSUNIT_ASSERT(::memcmp(buffer.data() + i * msg_size, data.data() + received * msg_size, expected) == 0);
+#if !defined(TS_WINDOWS)
+            // Kernel time stamps, within the millisecond precision of the system time.
+            TSUNIT_ASSERT(timestamps[i] >= before - 1000);
+            TSUNIT_ASSERT(timestamps[i] <= after + 1000);
+#endif
+        }
+    }
+    TSUNIT_EQUAL(msg_count, received);
+}
+
 // Test IP header
 void NetworkingTest::testIPHeader()
 {
@@ -0,0 +1,215 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::PIDIndexedMap.
+//
+//----------------------------------------------------------------------------
+
+#include "tsPIDIndexedMap.h"
+#include "tsMonotonic.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class PIDIndexedMapTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testBasic();
+    void testOrder();
+    void testEraseWhileIterating();
+    void testPerformance();
+
+    TSUNIT_TEST_BEGIN(PIDIndexedMapTest);
+    TSUNIT_TEST(testBasic);
+    TSUNIT_TEST(testOrder);
+    TSUNIT_TEST(testEraseWhileIterating);
+    TSUNIT_TEST(testPerformance);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(PIDIndexedMapTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void PIDIndexedMapTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void PIDIndexedMapTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void PIDIndexedMapTest::testBasic()
+{
+    ts::PIDIndexedMap<ts::UString> map;
+    TSUNIT_ASSERT(map.empty());
+    TSUNIT_EQUAL(0, map.size());
+    TSUNIT_ASSERT(map.begin() == map.end());
+    TSUNIT_ASSERT(map.find(100) == map.end());
+    TSUNIT_ASSERT(map.find(ts::PID_MAX) == map.end());
+
+    map[100] = u"foo";
+    map[ts::PID_NULL] = u"null";
+    TSUNIT_EQUAL(2, map.size());
+    TSUNIT_EQUAL(1, map.count(100));
+    TSUNIT_EQUAL(0, map.count(101));
+    TSUNIT_EQUAL(u"foo", map[100]);
+    TSUNIT_EQUAL(2, map.size());
+
+    const ts::UString* const addr = &map[ts::PID_NULL];
+    auto it = map.find(100);
+    TSUNIT_ASSERT(it != map.end());
+    TSUNIT_EQUAL(100, it->first);
+    TSUNIT_EQUAL(u"foo", it->second);
+
+    // Erased elements are reset and recycled, other elements do not move.
+    TSUNIT_EQUAL(1, map.erase(100));
+    TSUNIT_EQUAL(0, map.erase(100));
+    TSUNIT_EQUAL(1, map.size());
+    TSUNIT_ASSERT(map.find(100) == map.end());
+    TSUNIT_ASSERT(map[200].empty());
+    TSUNIT_EQUAL(2, map.size());
+    TSUNIT_ASSERT(addr == &map[ts::PID_NULL]);
+    TSUNIT_EQUAL(u"null", *addr);
+
+    // Const access.
+    const ts::PIDIndexedMap<ts::UString>& cmap(map);
+    ts::PIDIndexedMap<ts::UString>::const_iterator cit = cmap.find(ts::PID_NULL);
+    TSUNIT_ASSERT(cit != cmap.end());
+    TSUNIT_EQUAL(u"null", cit->second);
+
+    map.clear();
+    TSUNIT_ASSERT(map.empty());
+    TSUNIT_ASSERT(map.begin() == map.end());
+    TSUNIT_EQUAL(0, map.count(ts::PID_NULL));
+}
+
+void PIDIndexedMapTest::testOrder()
+{
+    // Iteration order shall be the same as std::map.
+    static const ts::PID pids[] = {0x1FFF, 0x0100, 0x0000, 0x0012, 0x1000, 0x0011, 0x0101};
+    ts::PIDIndexedMap<int> map;
+    std::map<ts::PID, int> ref;
+    int value = 0;
+    for (auto pid : pids) {
+        map[pid] = value;
+        ref[pid] = value;
+        value++;
+    }
+    map.erase(0x0012);
+    ref.erase(0x0012);
+    map[0x0013] = ref[0x0013] = value;
+
+    TSUNIT_EQUAL(ref.size(), map.size());
+    auto it1 = ref.begin();
+    for (auto it2 = map.begin(); it2 != map.end(); ++it1, ++it2) {
+        TSUNIT_ASSERT(it1 != ref.end());
+        TSUNIT_EQUAL(it1->first, it2->first);
+        TSUNIT_EQUAL(it1->second, it2->second);
+    }
+    TSUNIT_ASSERT(it1 == ref.end());
+
+    // Range-based loop.
+    size_t count = 0;
+    ts::PID previous = 0;
+    for (const auto& it : map) {
+        TSUNIT_ASSERT(count == 0 || it.first > previous);
+        previous = it.first;
+        count++;
+    }
+    TSUNIT_EQUAL(ref.size(), count);
+}
+
+void PIDIndexedMapTest::testEraseWhileIterating()
+{
+    ts::PIDIndexedMap<int> map;
+    for (ts::PID pid = 0; pid < 100; pid += 10) {
+        map[pid] = int(pid);
+    }
+
+    // Erase the current element and the next one while iterating.
+    size_t count = 0;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        count++;
+        if (it->first == 30) {
+            map.erase(30);
+            map.erase(40);
+        }
+    }
+    TSUNIT_EQUAL(9, count);
+    TSUNIT_EQUAL(8, map.size());
+    TSUNIT_EQUAL(0, map.count(30));
+    TSUNIT_EQUAL(0, map.count(40));
+    TSUNIT_EQUAL(1, map.count(50));
+}
+
+void PIDIndexedMapTest::testPerformance()
+{
+    // Compare lookup time with std::map on a typical multiplex with 40 PID's.
+    ts::PIDIndexedMap<int> map;
+    std::map<ts::PID, int> ref;
+    for (ts::PID pid = 0; pid < 40; ++pid) {
+        map[pid * 97] = ref[pid * 97] = int(pid);
+    }
+
+    const size_t iterations = 4000000;
+    int sum1 = 0, sum2 = 0;
+
+    ts::Monotonic start(true);
+    for (size_t i = 0; i < iterations; ++i) {
+        sum1 += ref[ts::PID((i % 40) * 97)];
+    }
+    const ts::NanoSecond t1 = ts::Monotonic(true) - start;
+
+    start.getSystemTime();
+    for (size_t i = 0; i < iterations; ++i) {
+        sum2 += map[ts::PID((i % 40) * 97)];
+    }
+    const ts::NanoSecond t2 = ts::Monotonic(true) - start;
+
+    TSUNIT_EQUAL(sum1, sum2);
+    debug() << "PIDIndexedMapTest::testPerformance: std::map: " << (t1 / 1000000) << " ms, PIDIndexedMap: " << (t2 / 1000000) << " ms" << std::endl;
+}
@@ -0,0 +1,375 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for PSI/SI views and in-place editors.
+//
+//----------------------------------------------------------------------------
+
+#include "tsPSIViews.h"
+#include "tsPSIEditors.h"
+#include "tsBinaryTable.h"
+#include "tsDuckContext.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+#include "tsSDT.h"
+#include "tsNIT.h"
+#include "tsEIT.h"
+#include "tsCADescriptor.h"
+#include "tsServiceDescriptor.h"
+#include "tsNetworkNameDescriptor.h"
+#include "tsStreamIdentifierDescriptor.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class PSIViewsTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testPAT();
+    void testPMT();
+    void testSDT();
+    void testNIT();
+    void testEIT();
+    void testInvalid();
+
+    TSUNIT_TEST_BEGIN(PSIViewsTest);
+    TSUNIT_TEST(testPAT);
+    TSUNIT_TEST(testPMT);
+    TSUNIT_TEST(testSDT);
+    TSUNIT_TEST(testNIT);
+    TSUNIT_TEST(testEIT);
+    TSUNIT_TEST(testInvalid);
+    TSUNIT_TEST_END();
+
+private:
+    // Check that the CRC32 of a modified section is correct.
+    static bool validCRC(const ts::Section& section);
+};
+
+TSUNIT_REGISTER(PSIViewsTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void PSIViewsTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void PSIViewsTest::afterTest()
+{
+}
+
+// Check that the CRC32 of a modified section is correct.
+bool PSIViewsTest::validCRC(const ts::Section& section)
+{
+    return ts::Section(section.content(), section.size(), section.sourcePID(), ts::CRC32::CHECK).isValid();
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void PSIViewsTest::testPAT()
+{
+    ts::DuckContext duck;
+    ts::PAT pat(3, true, 0x1234, 0x0010);
+    pat.pmts[100] = 0x0200;
+    pat.pmts[200] = 0x0300;
+    pat.pmts[300] = 0x0400;
+
+    ts::BinaryTable table;
+    pat.serialize(duck, table);
+    TSUNIT_EQUAL(1, table.sectionCount());
+    ts::Section& sect(*table.sectionAt(0));
+
+    const ts::PATView view(sect);
+    TSUNIT_ASSERT(view.isValid());
+    TSUNIT_EQUAL(0x1234, view.transportStreamId());
+    TSUNIT_EQUAL(4, view.services().count());
+    TSUNIT_EQUAL(0x0010, view.nitPID());
+    TSUNIT_EQUAL(0x0300, view.pmtPID(200));
+    TSUNIT_EQUAL(ts::PID_NULL, view.pmtPID(400));
+
+    {
+        ts::PATEditor editor(sect);
+        TSUNIT_ASSERT(editor.isValid());
+        TSUNIT_ASSERT(editor.removeService(200));
+        TSUNIT_ASSERT(!editor.removeService(400));
+        TSUNIT_ASSERT(editor.setPMTPID(300, 0x0500));
+        TSUNIT_ASSERT(editor.setServiceId(100, 101));
+        TSUNIT_ASSERT(editor.removeService(0));
+        TSUNIT_ASSERT(editor.isModified());
+    }
+    TSUNIT_ASSERT(validCRC(sect));
+
+    ts::PAT pat2(duck, table);
+    TSUNIT_ASSERT(pat2.isValid());
+    TSUNIT_EQUAL(0x1234, pat2.ts_id);
+    TSUNIT_EQUAL(ts::PID_NULL, pat2.nit_pid);
+    TSUNIT_EQUAL(2, pat2.pmts.size());
+    TSUNIT_EQUAL(0x0200, pat2.pmts[101]);
+    TSUNIT_EQUAL(0x0500, pat2.pmts[300]);
+}
+
+void PSIViewsTest::testPMT()
+{
+    ts::DuckContext duck;
+    ts::PMT pmt(1, true, 0x0123, 0x0101);
+    pmt.descs.add(duck, ts::CADescriptor(0x0500, 0x0111));
+    pmt.streams[0x0101].stream_type = ts::ST_MPEG2_VIDEO;
+    pmt.streams[0x0101].descs.add(duck, ts::StreamIdentifierDescriptor(1));
+    pmt.streams[0x0102].stream_type = ts::ST_MPEG1_AUDIO;
+    pmt.streams[0x0102].descs.add(duck, ts::CADescriptor(0x0500, 0x0112));
+    pmt.streams[0x0102].descs.add(duck, ts::StreamIdentifierDescriptor(2));
+    pmt.streams[0x0103].stream_type = ts::ST_PES_PRIV;
+
+    ts::BinaryTable table;
+    pmt.serialize(duck, table);
+    ts::Section& sect(*table.sectionAt(0));
+
+    const ts::PMTView view(sect);
+    TSUNIT_ASSERT(view.isValid());
+    TSUNIT_EQUAL(0x0123, view.serviceId());
+    TSUNIT_EQUAL(0x0101, view.pcrPID());
+    TSUNIT_EQUAL(1, view.descriptors().count());
+    TSUNIT_ASSERT(view.descriptors().contains(ts::DID_CA));
+    TSUNIT_EQUAL(3, view.streams().count());
+
+    auto it = view.streams().begin();
+    TSUNIT_EQUAL(0x0101, it->pid());
+    TSUNIT_ASSERT(it->isVideo());
+    TSUNIT_ASSERT(!it->isAudio());
+    TSUNIT_EQUAL(1, it->descriptors().count());
+    ++it;
+    TSUNIT_EQUAL(0x0102, it->pid());
+    TSUNIT_ASSERT(it->isAudio());
+    TSUNIT_EQUAL(2, it->descriptors().count());
+    TSUNIT_EQUAL(ts::DID_STREAM_ID, it->descriptors().search(ts::DID_STREAM_ID)->tag());
+    ++it;
+    TSUNIT_EQUAL(0x0103, it->pid());
+    TSUNIT_ASSERT(it->descriptors().empty());
+    ++it;
+    TSUNIT_ASSERT(it == view.streams().end());
+
+    {
+        ts::PMTEditor editor(sect);
+        TSUNIT_ASSERT(editor.isValid());
+        TSUNIT_EQUAL(2, editor.removeDescriptors(ts::DID_CA));
+        TSUNIT_ASSERT(editor.removeStream(0x0103));
+        TSUNIT_ASSERT(editor.setStreamPID(0x0102, 0x0202));
+        editor.setPCRPID(0x0202);
+    }
+    TSUNIT_ASSERT(validCRC(sect));
+
+    ts::PMT pmt2(duck, table);
+    TSUNIT_ASSERT(pmt2.isValid());
+    TSUNIT_EQUAL(0x0123, pmt2.service_id);
+    TSUNIT_EQUAL(0x0202, pmt2.pcr_pid);
+    TSUNIT_ASSERT(pmt2.descs.empty());
+    TSUNIT_EQUAL(2, pmt2.streams.size());
+    TSUNIT_EQUAL(1, pmt2.streams[0x0101].descs.count());
+    TSUNIT_EQUAL(ts::ST_MPEG1_AUDIO, pmt2.streams[0x0202].stream_type);
+    TSUNIT_EQUAL(1, pmt2.streams[0x0202].descs.count());
+    TSUNIT_EQUAL(ts::DID_STREAM_ID, pmt2.streams[0x0202].descs[0]->tag());
+}
+
+void PSIViewsTest::testSDT()
+{
+    ts::DuckContext duck;
+    ts::SDT sdt(true, 2, true, 0x0010, 0x20FA);
+    sdt.services[1].running_status = 4;
+    sdt.services[1].EITpf_present = true;
+    sdt.services[1].descs.add(duck, ts::ServiceDescriptor(0x01, u"provider", u"service 1"));
+    sdt.services[2].running_status = 1;
+    sdt.services[2].CA_controlled = true;
+    sdt.services[2].descs.add(duck, ts::ServiceDescriptor(0x02, u"provider", u"service 2"));
+
+    ts::BinaryTable table;
+    sdt.serialize(duck, table);
+    ts::Section& sect(*table.sectionAt(0));
+
+    const ts::SDTView view(sect);
+    TSUNIT_ASSERT(view.isValid());
+    TSUNIT_EQUAL(0x0010, view.transportStreamId());
+    TSUNIT_EQUAL(0x20FA, view.originalNetworkId());
+    TSUNIT_EQUAL(2, view.services().count());
+
+    auto it = view.services().begin();
+    TSUNIT_EQUAL(1, it->serviceId());
+    TSUNIT_EQUAL(4, it->runningStatus());
+    TSUNIT_ASSERT(it->eitPresentFollowing());
+    TSUNIT_ASSERT(!it->eitSchedule());
+    TSUNIT_ASSERT(!it->CAControlled());
+    TSUNIT_EQUAL(0x01, it->serviceType());
+    ++it;
+    TSUNIT_EQUAL(2, it->serviceId());
+    TSUNIT_ASSERT(it->CAControlled());
+    TSUNIT_EQUAL(0x02, it->serviceType());
+
+    {
+        ts::SDTEditor editor(sect);
+        TSUNIT_ASSERT(editor.isValid());
+        editor.setOriginalNetworkId(0x1234);
+        TSUNIT_ASSERT(editor.removeService(1));
+        TSUNIT_ASSERT(editor.setRunningStatus(2, 4));
+        TSUNIT_ASSERT(editor.setCAControlled(2, false));
+        TSUNIT_ASSERT(!editor.setCAControlled(1, false));
+    }
+    TSUNIT_ASSERT(validCRC(sect));
+
+    ts::SDT sdt2(duck, table);
+    TSUNIT_ASSERT(sdt2.isValid());
+    TSUNIT_EQUAL(0x1234, sdt2.onetw_id);
+    TSUNIT_EQUAL(1, sdt2.services.size());
+    TSUNIT_EQUAL(4, sdt2.services[2].running_status);
+    TSUNIT_ASSERT(!sdt2.services[2].CA_controlled);
+    TSUNIT_EQUAL(u"service 2", sdt2.services[2].serviceName(duck));
+}
+
+void PSIViewsTest::testNIT()
+{
+    ts::DuckContext duck;
+    ts::NIT nit(true, 5, true, 0x3001);
+    nit.descs.add(duck, ts::NetworkNameDescriptor(u"network"));
+    nit.transports[ts::TransportStreamId(1, 0x20FA)].descs.add(duck, ts::CADescriptor(0x0100, 0x0100));
+    nit.transports[ts::TransportStreamId(2, 0x20FA)];
+    nit.transports[ts::TransportStreamId(3, 0x20FA)].descs.add(duck, ts::CADescriptor(0x0100, 0x0101));
+
+    ts::BinaryTable table;
+    nit.serialize(duck, table);
+    ts::Section& sect(*table.sectionAt(0));
+
+    const ts::NITView view(sect);
+    TSUNIT_ASSERT(view.isValid());
+    TSUNIT_EQUAL(0x3001, view.networkId());
+    TSUNIT_EQUAL(1, view.descriptors().count());
+    TSUNIT_EQUAL(3, view.transportStreams().count());
+    TSUNIT_EQUAL(4, view.transportStreams().begin()->descriptors().begin()->payloadSize());
+
+    {
+        ts::NITEditor editor(sect);
+        TSUNIT_ASSERT(editor.isValid());
+        TSUNIT_ASSERT(editor.removeTransportStream(2, 0x20FA));
+        TSUNIT_ASSERT(!editor.removeTransportStream(2, 0x20FA));
+        TSUNIT_EQUAL(2, editor.removeDescriptors(ts::DID_CA));
+    }
+    TSUNIT_ASSERT(validCRC(sect));
+
+    ts::NIT nit2(duck, table);
+    TSUNIT_ASSERT(nit2.isValid());
+    TSUNIT_EQUAL(0x3001, nit2.network_id);
+    TSUNIT_EQUAL(1, nit2.descs.count());
+    TSUNIT_EQUAL(2, nit2.transports.size());
+    TSUNIT_ASSERT(nit2.transports[ts::TransportStreamId(1, 0x20FA)].descs.empty());
+    TSUNIT_ASSERT(nit2.transports[ts::TransportStreamId(3, 0x20FA)].descs.empty());
+}
+
+void PSIViewsTest::testEIT()
+{
+    ts::DuckContext duck;
+    ts::EIT eit(true, true, 0, 7, true, 0x0101, 0x0010, 0x20FA);
+    ts::EIT::Event& ev(eit.events.newEntry());
+    ev.event_id = 0x1234;
+    ev.start_time = ts::Time(2020, 3, 14, 23, 30, 0);
+    ev.duration = 5400;
+    ev.running_status = 4;
+
+    ts::BinaryTable table;
+    eit.serialize(duck, table);
+    ts::Section& sect(*table.sectionAt(0));
+
+    const ts::EITView view(sect);
+    TSUNIT_ASSERT(view.isValid());
+    TSUNIT_EQUAL(0x0101, view.serviceId());
+    TSUNIT_EQUAL(0x0010, view.transportStreamId());
+    TSUNIT_EQUAL(0x20FA, view.originalNetworkId());
+    TSUNIT_EQUAL(1, view.events().count());
+    TSUNIT_EQUAL(0x1234, view.events().begin()->eventId());
+    TSUNIT_EQUAL(5400, view.events().begin()->duration());
+    TSUNIT_EQUAL(4, view.events().begin()->runningStatus());
+    ts::Time start;
+    TSUNIT_ASSERT(view.events().begin()->getStartTime(start));
+    TSUNIT_ASSERT(start == ts::Time(2020, 3, 14, 23, 30, 0));
+
+    {
+        ts::EITEditor editor(sect);
+        TSUNIT_ASSERT(editor.isValid());
+        editor.setTransportStreamId(0x0020);
+        TSUNIT_ASSERT(editor.addStartTimeOffset(2 * ts::MilliSecPerHour));
+    }
+    TSUNIT_ASSERT(validCRC(sect));
+
+    ts::EIT eit2(duck, table);
+    TSUNIT_ASSERT(eit2.isValid());
+    TSUNIT_EQUAL(0x0020, eit2.ts_id);
+    TSUNIT_EQUAL(1, eit2.events.size());
+    TSUNIT_ASSERT(eit2.events.begin()->second.start_time == ts::Time(2020, 3, 15, 1, 30, 0));
+
+    {
+        ts::EITEditor editor(sect);
+        TSUNIT_ASSERT(editor.addStartTimeOffset(2 * ts::MilliSecPerDay, true));
+    }
+    TSUNIT_ASSERT(validCRC(sect));
+    TSUNIT_ASSERT(view.events().begin()->getStartTime(start));
+    TSUNIT_ASSERT(start == ts::Time(2020, 3, 17, 1, 30, 0));
+}
+
+void PSIViewsTest::testInvalid()
+{
+    ts::DuckContext duck;
+    ts::PAT pat;
+    ts::BinaryTable table;
+    pat.serialize(duck, table);
+    ts::Section& sect(*table.sectionAt(0));
+
+    // A PAT is not a PMT, SDT, NIT or EIT.
+    TSUNIT_ASSERT(ts::PATView(sect).isValid());
+    TSUNIT_ASSERT(!ts::PMTView(sect).isValid());
+    TSUNIT_ASSERT(!ts::SDTView(sect).isValid());
+    TSUNIT_ASSERT(!ts::NITView(sect).isValid());
+    TSUNIT_ASSERT(!ts::EITView(sect).isValid());
+    TSUNIT_ASSERT(ts::PMTView(sect).streams().empty());
+
+    ts::SDTEditor editor(sect);
+    TSUNIT_ASSERT(!editor.isValid());
+    TSUNIT_ASSERT(!editor.removeService(1));
+    TSUNIT_ASSERT(!editor.isModified());
+}
@@ -111,6 +111,7 @@ public:
     void testPutInt32LE();
     void testPutInt64BE();
     void testPutInt64LE();
+    void testLocateStartCodes();
 
     TSUNIT_TEST_BEGIN(PlatformTest);
     TSUNIT_TEST(testIntegerTypes);
@@ -175,6 +176,7 @@ public:
     TSUNIT_TEST(testPutInt32LE);
     TSUNIT_TEST(testPutInt64BE);
     TSUNIT_TEST(testPutInt64LE);
+    TSUNIT_TEST(testLocateStartCodes);
     TSUNIT_TEST_END();
 };
 
@@ -767,3 +769,43 @@ void PlatformTest::testPutInt64LE()
     ts::PutInt64LE(out, TS_CONST64(-3183251291827679796)); // 0xD3D2D1D0CFCECDCC
     TSUNIT_EQUAL(0, ::memcmp(out, _bytes + 0xCC, 8));
 }
+
+void PlatformTest::testLocateStartCodes()
+{
+    // Pseudo-random data with many zeroes and ones.
+    uint8_t data[1000];
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        seed = seed * 1103515245 + 12345;
+        const uint8_t values[] = {0x00, 0x00, 0x00, 0x01, 0x02, 0x47};
+        data[i] = values[(seed >> 16) % sizeof(values)];
+    }
+
+    // Compare with a naive search, using all start offsets and sizes around the SIMD block sizes.
+    std::vector<size_t> offsets;
+    std::vector<size_t> expected;
+    for (size_t start = 0; start < 40; ++start) {
+        for (size_t size = 0; start + size <= sizeof(data); size += (size < 80 ? 1 : 97)) {
+            for (int zeroes = 0; zeroes < 2; ++zeroes) {
+                expected.clear();
+                for (size_t i = 0; i + 2 < size; ++i) {
+                    const uint8_t* p = data + start + i;
+                    if (p[0] == 0 && p[1] == 0 && (p[2] == 1 || (zeroes != 0 && p[2] == 0))) {
+                        expected.push_back(i);
+                    }
+                }
+                ts::LocateStartCodes(offsets, data + start, size, zeroes != 0);
+                TSUNIT_ASSERT(offsets == expected);
+            }
+        }
+    }
+
+    const uint8_t es[] = {0x00, 0x00, 0x01, 0xB3, 0x00, 0x00, 0x00, 0x01, 0x09, 0x00, 0x00};
+    ts::LocateStartCodes(offsets, es, sizeof(es));
+    TSUNIT_EQUAL(2, offsets.size());
+    TSUNIT_EQUAL(0, offsets[0]);
+    TSUNIT_EQUAL(5, offsets[1]);
+    ts::LocateStartCodes(offsets, es, sizeof(es), true);
+    TSUNIT_EQUAL(3, offsets.size());
+    TSUNIT_EQUAL(4, offsets[1]);
+}
@@ -32,6 +32,8 @@
 //----------------------------------------------------------------------------
 
 #include "tsDVBCSA2.h"
+#include "tsTSScrambling.h"
+#include "tsNullReport.h"
 #include "tsTSPacket.h"
 #include "tsNames.h"
 #include "tsunit.h"
@@ -49,9 +51,11 @@ public:
     virtual void afterTest() override;
 
     void testScrambling();
+    void testBatch();
 
     TSUNIT_TEST_BEGIN(ScramblingTest);
     TSUNIT_TEST(testScrambling);
+    TSUNIT_TEST(testBatch);
     TSUNIT_TEST_END();
 };
 
@@ -211,3 +215,39 @@ void ScramblingTest::testScrambling()
         TSUNIT_ASSERT(::memcmp(pkt.b + header_size, vec->cipher.b + header_size, payload_size) == 0);
     }
 }
+
+void ScramblingTest::testBatch()
+{
+    const size_t vec_count = sizeof(scrambling_test_vectors) / sizeof(ScramblingTestVector);
+    const ScramblingTestVector& vec0(scrambling_test_vectors[0]);
+
+    ts::TSScrambling scrambling(NULLREP, ts::SCRAMBLING_DVB_CSA2);
+    TSUNIT_ASSERT(scrambling.setCW(ts::ByteBlock(vec0.cw_even, sizeof(vec0.cw_even)), ts::SC_EVEN_KEY));
+    TSUNIT_ASSERT(scrambling.setCW(ts::ByteBlock(vec0.cw_odd, sizeof(vec0.cw_odd)), ts::SC_ODD_KEY));
+    TSUNIT_ASSERT(scrambling.setEncryptParity(ts::SC_EVEN_KEY));
+
+    // More packets than one DVB-CSA2 batch, cycling through test vectors, with some null packets.
+    std::vector<ts::TSPacket> packets(300);
+    std::vector<ts::TSPacket*> addresses(packets.size());
+    for (size_t i = 0; i < packets.size(); ++i) {
+        packets[i] = i % 7 == 3 ? ts::NullPacket : scrambling_test_vectors[i % vec_count].plain;
+        addresses[i] = &packets[i];
+    }
+
+    TSUNIT_ASSERT(scrambling.encrypt(addresses.data(), addresses.size()));
+    for (size_t i = 0; i < packets.size(); ++i) {
+        if (i % 7 != 3) {
+            TSUNIT_ASSERT(packets[i] == scrambling_test_vectors[i % vec_count].cipher);
+        }
+    }
+
+    // Already scrambled packets cannot be scrambled again.
+    TSUNIT_ASSERT(!scrambling.encrypt(addresses.data(), addresses.size()));
+
+    TSUNIT_ASSERT(scrambling.decrypt(addresses.data(), addresses.size()));
+    for (size_t i = 0; i < packets.size(); ++i) {
+        if (i % 7 != 3) {
+            TSUNIT_ASSERT(packets[i] == scrambling_test_vectors[i % vec_count].plain);
+        }
+    }
+}
@@ -0,0 +1,257 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::SharedPacketRing
+//
+//----------------------------------------------------------------------------
+
+#include "tsSharedPacketRing.h"
+#include "tsSysUtils.h"
+#include "tsReportBuffer.h"
+#include "tsCerrReport.h"
+#include "tsTime.h"
+#include "tsunit.h"
+#include "utestTSUnitThread.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class SharedPacketRingTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testTransfer();
+    void testTimeout();
+    void testWriteAbort();
+
+    TSUNIT_TEST_BEGIN(SharedPacketRingTest);
+    TSUNIT_TEST(testTransfer);
+    TSUNIT_TEST(testTimeout);
+    TSUNIT_TEST(testWriteAbort);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(SharedPacketRingTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void SharedPacketRingTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void SharedPacketRingTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+#if !defined(TS_WINDOWS)
+
+namespace {
+    constexpr size_t TEST_PACKETS = 1000;
+
+    // Name of the shared memory segment, unique per process.
+    ts::UString RingName()
+    {
+        return ts::UString::Format(u"tsduck-utest-%d", {ts::CurrentProcessId()});
+    }
+
+    // Producer thread: write packets in small chunks in a ring which is much smaller.
+    class ProducerThread: public utest::TSUnitThread
+    {
+    private:
+        ts::SharedPacketRing& _ring;
+    public:
+        explicit ProducerThread(ts::SharedPacketRing& ring) :
+            utest::TSUnitThread(),
+            _ring(ring)
+        {
+        }
+
+        ~ProducerThread()
+        {
+            waitForTermination();
+        }
+
+        virtual void test() override
+        {
+            ts::TSPacket pkt[7];
+            ts::TSPacketMetadata mdata[7];
+            for (size_t count = 0; count < TEST_PACKETS; ) {
+                const size_t n = std::min<size_t>(7, TEST_PACKETS - count);
+                for (size_t i = 0; i < n; ++i, ++count) {
+                    pkt[i].init(ts::PID(count & 0x1FFF), uint8_t(count & 0x0F), uint8_t(count));
+                    mdata[i].reset();
+                    mdata[i].setLabel(count % ts::TSPacketMetadata::LABEL_COUNT);
+                    mdata[i].setInputTimeStamp(count * 1000);
+                    if (count % 2 == 0) {
+                        mdata[i].setRTPSequence(uint16_t(count));
+                    }
+                }
+                TSUNIT_ASSERT(_ring.write(pkt, mdata, n, nullptr, CERR));
+            }
+            TSUNIT_ASSERT(_ring.close(CERR));
+        }
+    };
+}
+
+void SharedPacketRingTest::testTransfer()
+{
+    ts::SharedPacketRing producer;
+    ts::SharedPacketRing consumer;
+
+    TSUNIT_ASSERT(producer.create(RingName(), 20, CERR));
+    TSUNIT_ASSERT(producer.isOpen());
+    TSUNIT_EQUAL(20, producer.packetCount());
+    producer.setBitrate(1234567);
+
+    TSUNIT_ASSERT(consumer.open(RingName(), 1000, CERR));
+    TSUNIT_ASSERT(consumer.isOpen());
+    TSUNIT_EQUAL(20, consumer.packetCount());
+    TSUNIT_EQUAL(1234567, consumer.getBitrate());
+
+    ProducerThread thread(producer);
+    TSUNIT_ASSERT(thread.start());
+
+    ts::TSPacket pkt[13];
+    ts::TSPacketMetadata mdata[13];
+    size_t total = 0;
+    size_t n = 0;
+    while ((n = consumer.read(pkt, mdata, 13, CERR)) > 0) {
+        TSUNIT_ASSERT(n <= 13);
+        for (size_t i = 0; i < n; ++i, ++total) {
+            TSUNIT_EQUAL(ts::PID(total & 0x1FFF), pkt[i].getPID());
+            TSUNIT_EQUAL(uint8_t(total), *pkt[i].getPayload());
+            TSUNIT_ASSERT(mdata[i].hasLabel(total % ts::TSPacketMetadata::LABEL_COUNT));
+            TSUNIT_EQUAL(1, mdata[i].getLabels().count());
+            TSUNIT_EQUAL(total * 1000, mdata[i].getInputTimeStamp());
+            TSUNIT_EQUAL(total % 2 == 0, mdata[i].hasRTPSequence());
+            if (total % 2 == 0) {
+                TSUNIT_EQUAL(uint16_t(total), mdata[i].getRTPSequence());
+            }
+        }
+    }
+    TSUNIT_EQUAL(TEST_PACKETS, total);
+    TSUNIT_ASSERT(consumer.close(CERR));
+    TSUNIT_ASSERT(!consumer.isOpen());
+}
+
+void SharedPacketRingTest::testTimeout()
+{
+    // The name is unlinked when the producer is closed.
+    ts::SharedPacketRing consumer;
+    ts::ReportBuffer<> rep;
+    TSUNIT_ASSERT(!consumer.open(RingName(), 100, rep));
+    TSUNIT_ASSERT(!consumer.isOpen());
+    debug() << "SharedPacketRingTest::testTimeout: " << rep.getMessages() << std::endl;
+}
+
+namespace {
+    // An abort interface which is triggered by a thread after some delay.
+    class DelayedAbort: public ts::AbortInterface, public utest::TSUnitThread
+    {
+    private:
+        volatile bool _aborting;
+    public:
+        DelayedAbort() :
+            ts::AbortInterface(),
+            utest::TSUnitThread(),
+            _aborting(false)
+        {
+        }
+
+        ~DelayedAbort()
+        {
+            waitForTermination();
+        }
+
+        virtual bool aborting() const override
+        {
+            return _aborting;
+        }
+
+        virtual void test() override
+        {
+            ts::SleepThread(200);
+            _aborting = true;
+        }
+    };
+}
+
+void SharedPacketRingTest::testWriteAbort()
+{
+    // The consumer is alive but never reads: the producer must not wait forever.
+    ts::SharedPacketRing producer;
+    ts::SharedPacketRing consumer;
+    TSUNIT_ASSERT(producer.create(RingName(), ts::SharedPacketRing::MIN_PACKET_COUNT, CERR));
+    TSUNIT_ASSERT(consumer.open(RingName(), 1000, CERR));
+
+    // Fill the ring.
+    ts::TSPacketVector pkt(producer.packetCount(), ts::NullPacket);
+    TSUNIT_ASSERT(producer.write(pkt.data(), nullptr, pkt.size(), nullptr, CERR));
+
+    DelayedAbort abort;
+    TSUNIT_ASSERT(abort.start());
+    const ts::Time start(ts::Time::CurrentUTC());
+    TSUNIT_ASSERT(!producer.write(pkt.data(), nullptr, 1, &abort, CERR));
+    TSUNIT_ASSERT(abort.aborting());
+    TSUNIT_ASSERT(ts::Time::CurrentUTC() - start < 5000);
+
+    TSUNIT_ASSERT(consumer.close(CERR));
+    TSUNIT_ASSERT(producer.close(CERR));
+}
+
+#else
+
+void SharedPacketRingTest::testTransfer()
+{
+}
+
+void SharedPacketRingTest::testWriteAbort()
+{
+}
+
+void SharedPacketRingTest::testTimeout()
+{
+}
+
+#endif
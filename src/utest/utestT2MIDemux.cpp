@@ -0,0 +1,251 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::T2MIDemux
+//
+//----------------------------------------------------------------------------
+
+#include "tsT2MIDemux.h"
+#include "tsT2MIPacket.h"
+#include "tsDuckContext.h"
+#include "tsCRC32.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class T2MIDemuxTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testSpanningPackets();
+
+    TSUNIT_TEST_BEGIN(T2MIDemuxTest);
+    TSUNIT_TEST(testSpanningPackets);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(T2MIDemuxTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void T2MIDemuxTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void T2MIDemuxTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Test helpers.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Collect the extracted TS packets per PLP.
+    class TSCollector: public ts::T2MIHandlerInterface
+    {
+    public:
+        std::map<uint8_t, ts::TSPacketVector> plps;
+
+        TSCollector() : plps() {}
+
+        virtual void handleT2MINewPID(ts::T2MIDemux&, const ts::PMT&, ts::PID, const ts::T2MIDescriptor&) override {}
+        virtual void handleT2MIPacket(ts::T2MIDemux&, const ts::T2MIPacket&) override {}
+        virtual void handleTSPacket(ts::T2MIDemux&, const ts::T2MIPacket& t2mi, const ts::TSPacket& ts) override
+        {
+            plps[t2mi.plp()].push_back(ts);
+        }
+    };
+
+    // Build a list of distinct TS packets.
+    ts::TSPacketVector BuildPackets(ts::PID pid, size_t count)
+    {
+        ts::TSPacketVector packets(count);
+        for (size_t i = 0; i < count; ++i) {
+            packets[i].init(pid, uint8_t(i), uint8_t(i + pid));
+            ts::PutUInt32(packets[i].b + 4, uint32_t(i));
+        }
+        return packets;
+    }
+
+    // Build a T2-MI baseband frame packet with a data field of the user packets
+    // (without sync byte) starting at byte offset 'start' in the packet list.
+    ts::ByteBlock BuildT2MI(uint8_t counter, uint8_t plp, const ts::TSPacketVector& packets, size_t start, size_t dfl)
+    {
+        const size_t up_size = ts::PKT_SIZE - 1;
+        const size_t distance = (up_size - start % up_size) % up_size;
+        const size_t syncd = distance < dfl ? 8 * distance : 0xFFFF;
+
+        ts::ByteBlock t2mi(ts::T2MI_HEADER_SIZE);
+        t2mi[0] = ts::T2MI_BASEBAND_FRAME;
+        t2mi[1] = counter;
+        ts::PutUInt16(t2mi.data() + 4, uint16_t(8 * (3 + ts::T2_BBHEADER_SIZE + dfl)));
+
+        // Baseband frame header: frame_idx, plp_id, intl_frame_start.
+        t2mi.appendUInt8(0);
+        t2mi.appendUInt8(plp);
+        t2mi.appendUInt8(0x80);
+
+        // BBHEADER, TS mode, no null packet deletion.
+        t2mi.appendUInt8(0xF0);                 // MATYPE-1
+        t2mi.appendUInt8(0x00);                 // MATYPE-2
+        t2mi.appendUInt16(8 * up_size);         // UPL
+        t2mi.appendUInt16(uint16_t(8 * dfl));   // DFL
+        t2mi.appendUInt8(ts::SYNC_BYTE);        // SYNC
+        t2mi.appendUInt16(uint16_t(syncd));     // SYNCD
+        t2mi.appendUInt8(0);                    // CRC-8 (not checked)
+
+        // Data field.
+        for (size_t i = start; i < start + dfl; ++i) {
+            t2mi.appendUInt8(packets[i / up_size].b[1 + i % up_size]);
+        }
+
+        t2mi.appendUInt32(ts::CRC32(t2mi.data(), t2mi.size()));
+        return t2mi;
+    }
+
+    // Encapsulate a list of T2-MI packets in TS packets, using pointer fields.
+    ts::TSPacketVector Encapsulate(ts::PID pid, const std::vector<ts::ByteBlock>& t2mi)
+    {
+        ts::ByteBlock data;
+        std::set<size_t> starts;
+        for (size_t i = 0; i < t2mi.size(); ++i) {
+            starts.insert(data.size());
+            data.append(t2mi[i]);
+        }
+
+        ts::TSPacketVector packets;
+        size_t index = 0;
+        while (index < data.size()) {
+            ts::TSPacket pkt;
+            pkt.init(pid, uint8_t(packets.size()));
+            uint8_t* payload = pkt.b + 4;
+            size_t size = ts::PKT_SIZE - 4;
+            const std::set<size_t>::const_iterator next = starts.lower_bound(index);
+            if (next != starts.end() && *next - index < size - 1) {
+                pkt.setPUSI();
+                *payload++ = uint8_t(*next - index);
+                size--;
+            }
+            size = std::min(size, data.size() - index);
+            ::memcpy(payload, data.data() + index, size);
+            index += size;
+            packets.push_back(pkt);
+        }
+        return packets;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void T2MIDemuxTest::testSpanningPackets()
+{
+    const ts::PID pid = 0x0123;
+    const size_t up_size = ts::PKT_SIZE - 1;
+    const size_t count = 20;
+
+    // PLP 0: TS packets span two T2-MI packets, one T2-MI packet is lost.
+    // PLP 1: TS packets span up to three T2-MI packets, some of them without
+    // packet start, the first T2-MI packet starts in the middle of a TS packet.
+    const ts::TSPacketVector plp0(BuildPackets(100, count));
+    const ts::TSPacketVector plp1(BuildPackets(200, count));
+    const size_t dfl0 = 300;
+    const size_t dfl1 = 150;
+    const size_t lost = 3;
+    const size_t first1 = 50;
+
+    std::vector<ts::ByteBlock> t2mi;
+    uint8_t counter = 0;
+    size_t start0 = 0;
+    size_t start1 = first1;
+    for (size_t frame = 0; start0 < count * up_size || start1 < count * up_size; ++frame) {
+        if (start0 < count * up_size) {
+            const size_t dfl = std::min(dfl0, count * up_size - start0);
+            const ts::ByteBlock pkt(BuildT2MI(counter++, 0, plp0, start0, dfl));
+            if (frame != lost) {
+                t2mi.push_back(pkt);
+            }
+            start0 += dfl;
+        }
+        if (start1 < count * up_size) {
+            const size_t dfl = std::min(dfl1, count * up_size - start1);
+            t2mi.push_back(BuildT2MI(counter++, 1, plp1, start1, dfl));
+            start1 += dfl;
+        }
+    }
+
+    ts::DuckContext duck;
+    TSCollector collector;
+    ts::T2MIDemux demux(duck, &collector, ts::PIDSet().set(pid));
+
+    const ts::TSPacketVector packets(Encapsulate(pid, t2mi));
+    for (size_t i = 0; i < packets.size(); ++i) {
+        demux.feedPacket(packets[i]);
+    }
+
+    // In PLP 0, the lost T2-MI packet covers TS packets 4 (partial), 5 (full) and 6 (partial).
+    // The partial packets are dropped, the demux resynchronizes on packet 7.
+    ts::TSPacketVector expected0;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t end = (i + 1) * up_size;
+        if (end <= lost * dfl0 || i * up_size >= (lost + 1) * dfl0) {
+            expected0.push_back(plp0[i]);
+        }
+    }
+    TSUNIT_EQUAL(count - 3, expected0.size());
+
+    // In PLP 1, the first TS packet is incomplete.
+    const ts::TSPacketVector expected1(plp1.begin() + 1, plp1.end());
+
+    TSUNIT_EQUAL(2, collector.plps.size());
+    TSUNIT_EQUAL(expected0.size(), collector.plps[0].size());
+    TSUNIT_EQUAL(expected1.size(), collector.plps[1].size());
+    for (size_t i = 0; i < expected0.size(); ++i) {
+        TSUNIT_ASSERT(expected0[i] == collector.plps[0][i]);
+    }
+    for (size_t i = 0; i < expected1.size(); ++i) {
+        TSUNIT_ASSERT(expected1[i] == collector.plps[1][i]);
+    }
+}
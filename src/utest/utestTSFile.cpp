@@ -0,0 +1,282 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::TSFile.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSFile.h"
+#include "tsSysUtils.h"
+#include "tsCerrReport.h"
+#include "tsNullReport.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSFileTest: public tsunit::Test
+{
+public:
+    TSFileTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testReadWrite();
+    void testReadAhead();
+    void testReadAheadPipe();
+    void testDirectWrite();
+
+    TSUNIT_TEST_BEGIN(TSFileTest);
+    TSUNIT_TEST(testReadWrite);
+    TSUNIT_TEST(testReadAhead);
+    TSUNIT_TEST(testReadAheadPipe);
+    TSUNIT_TEST(testDirectWrite);
+    TSUNIT_TEST_END();
+
+private:
+    ts::UString _tempFileName;
+    ts::Report& report();
+
+    // Build a test packet with a recognizable index.
+    static void MakePacket(ts::TSPacket& pkt, uint32_t index);
+    static uint32_t PacketIndex(const ts::TSPacket& pkt);
+
+    // Create the test file.
+    void createFile(uint32_t count);
+
+    // Read a file and check the indexes of the packets.
+    void checkRead(ts::TSFile& file, uint32_t first, uint32_t count, size_t chunk);
+};
+
+TSUNIT_REGISTER(TSFileTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+TSFileTest::TSFileTest() :
+    _tempFileName()
+{
+}
+
+// Test suite initialization method.
+void TSFileTest::beforeTest()
+{
+    if (_tempFileName.empty()) {
+        _tempFileName = ts::TempFile(u".ts");
+    }
+    ts::DeleteFile(_tempFileName);
+}
+
+// Test suite cleanup method.
+void TSFileTest::afterTest()
+{
+    ts::DeleteFile(_tempFileName);
+}
+
+ts::Report& TSFileTest::report()
+{
+    if (tsunit::Test::debugMode()) {
+        return CERR;
+    }
+    else {
+        return NULLREP;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test utilities.
+//----------------------------------------------------------------------------
+
+void TSFileTest::MakePacket(ts::TSPacket& pkt, uint32_t index)
+{
+    pkt = ts::NullPacket;
+    ts::PutUInt32(pkt.b + 4, index);
+}
+
+uint32_t TSFileTest::PacketIndex(const ts::TSPacket& pkt)
+{
+    return ts::GetUInt32(pkt.b + 4);
+}
+
+void TSFileTest::createFile(uint32_t count)
+{
+    ts::TSFile file;
+    TSUNIT_ASSERT(file.open(_tempFileName, ts::TSFile::WRITE, report()));
+    ts::TSPacketVector packets(1000);
+    for (uint32_t index = 0; index < count; ) {
+        const size_t n = std::min<size_t>(packets.size(), count - index);
+        for (size_t i = 0; i < n; ++i) {
+            MakePacket(packets[i], index++);
+        }
+        TSUNIT_ASSERT(file.write(packets.data(), n, report()));
+    }
+    TSUNIT_EQUAL(count, file.getWriteCount());
+    TSUNIT_ASSERT(file.close(report()));
+}
+
+void TSFileTest::checkRead(ts::TSFile& file, uint32_t first, uint32_t count, size_t chunk)
+{
+    ts::TSPacketVector packets(chunk);
+    uint32_t expected = first;
+    while (expected < first + count) {
+        const size_t n = file.read(packets.data(), std::min<size_t>(chunk, first + count - expected), report());
+        TSUNIT_ASSERT(n > 0);
+        for (size_t i = 0; i < n; ++i) {
+            TSUNIT_ASSERT(packets[i].hasValidSync());
+            TSUNIT_EQUAL(expected, PacketIndex(packets[i]));
+            expected++;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void TSFileTest::testReadWrite()
+{
+    createFile(5000);
+
+    ts::TSFile file;
+    TSUNIT_ASSERT(file.openRead(_tempFileName, 2, 10 * ts::PKT_SIZE, report()));
+    checkRead(file, 10, 4990, 333);
+    checkRead(file, 10, 4990, 1000);
+    ts::TSPacket pkt;
+    TSUNIT_EQUAL(0, file.read(&pkt, 1, report()));
+    TSUNIT_EQUAL(9980, file.getReadCount());
+    TSUNIT_ASSERT(file.close(report()));
+}
+
+void TSFileTest::testReadAhead()
+{
+    // Larger than the minimum window size to test the sliding of the window.
+    const uint32_t count = uint32_t(3 * ts::TSFile::MIN_READ_AHEAD_SIZE / ts::PKT_SIZE);
+    createFile(count);
+
+    // Repeated file with start offset, window is not packet-aligned.
+    ts::TSFile file;
+    file.setReadAhead(true, ts::TSFile::MIN_READ_AHEAD_SIZE);
+    TSUNIT_ASSERT(file.openRead(_tempFileName, 2, 7 * ts::PKT_SIZE, report()));
+    checkRead(file, 7, count - 7, 1000);
+    checkRead(file, 7, count - 7, 517);
+    ts::TSPacket pkt;
+    TSUNIT_EQUAL(0, file.read(&pkt, 1, report()));
+    TSUNIT_EQUAL(2 * (count - 7), file.getReadCount());
+    TSUNIT_ASSERT(file.close(report()));
+
+    // Rewindable file with seek back and forth.
+    TSUNIT_ASSERT(file.openRead(_tempFileName, 0, report()));
+    checkRead(file, 0, 10000, 4000);
+    TSUNIT_ASSERT(file.seek(count - 100, report()));
+    checkRead(file, count - 100, 100, 64);
+    TSUNIT_EQUAL(0, file.read(&pkt, 1, report()));
+    TSUNIT_ASSERT(file.seek(20, report()));
+    checkRead(file, 20, 100, 50);
+    TSUNIT_ASSERT(file.close(report()));
+}
+
+void TSFileTest::testReadAheadPipe()
+{
+#if defined(TS_LINUX)
+    // Less than the default pipe capacity, so that we can write everything before reading.
+    const uint32_t count = 300;
+    int fds[2];
+    TSUNIT_ASSERT(::pipe(fds) == 0);
+    ts::TSPacket pkt;
+    for (uint32_t i = 0; i < count; ++i) {
+        MakePacket(pkt, i);
+        TSUNIT_EQUAL(ssize_t(ts::PKT_SIZE), ::write(fds[1], pkt.b, ts::PKT_SIZE));
+    }
+    ::close(fds[1]);
+
+    // Read the pipe through its /dev/fd alias to use a non-mappable file.
+    ts::TSFile file;
+    file.setReadAhead(true);
+    TSUNIT_ASSERT(file.openRead(ts::UString::Format(u"/dev/fd/%d", {fds[0]}), 1, 0, report()));
+    checkRead(file, 0, count, 77);
+    TSUNIT_EQUAL(0, file.read(&pkt, 1, report()));
+    TSUNIT_ASSERT(file.close(report()));
+    ::close(fds[0]);
+#endif
+}
+
+void TSFileTest::testDirectWrite()
+{
+    // Mix of aligned and unaligned writes, from aligned and unaligned addresses.
+    // 1024 packets is the smallest multiple of the direct I/O alignment.
+    static const size_t sizes[] = {1024, 1, 7, 2048, 1000, 24, 1024, 333, 1, 4096, 5};
+    ts::TSPacketVector packets(4200);
+    uint32_t index = 0;
+
+    ts::TSFile file;
+    TSUNIT_ASSERT(file.open(_tempFileName, ts::TSFile::WRITE | ts::TSFile::DIRECT, report()));
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        const size_t first = i % 2;
+        for (size_t n = 0; n < sizes[i]; ++n) {
+            MakePacket(packets[first + n], index++);
+        }
+        TSUNIT_ASSERT(file.write(packets.data() + first, sizes[i], report()));
+        // All packets, including an unaligned tail, must be in the file after each write.
+        TSUNIT_EQUAL(int64_t(index) * ts::PKT_SIZE, ts::GetFileSize(_tempFileName));
+    }
+    TSUNIT_EQUAL(index, file.getWriteCount());
+    TSUNIT_ASSERT(file.close(report()));
+
+    ts::TSFile in;
+    TSUNIT_ASSERT(in.openRead(_tempFileName, 0, report()));
+    checkRead(in, 0, index, 500);
+    ts::TSPacket pkt;
+    TSUNIT_EQUAL(0, in.read(&pkt, 1, report()));
+    TSUNIT_ASSERT(in.close(report()));
+
+    // Append at an unaligned file offset: direct I/O is refused and normal I/O is used.
+    const uint32_t previous = index;
+    TSUNIT_ASSERT(file.open(_tempFileName, ts::TSFile::WRITE | ts::TSFile::APPEND | ts::TSFile::DIRECT, report()));
+    for (size_t n = 0; n < 1024; ++n) {
+        MakePacket(packets[n], index++);
+    }
+    TSUNIT_ASSERT(file.write(packets.data(), 1024, report()));
+    TSUNIT_ASSERT(file.close(report()));
+    TSUNIT_EQUAL(int64_t(index) * ts::PKT_SIZE, ts::GetFileSize(_tempFileName));
+
+    TSUNIT_ASSERT(in.openRead(_tempFileName, 0, report()));
+    checkRead(in, 0, previous, 1000);
+    checkRead(in, previous, index - previous, 1000);
+    TSUNIT_EQUAL(0, in.read(&pkt, 1, report()));
+    TSUNIT_ASSERT(in.close(report()));
+}
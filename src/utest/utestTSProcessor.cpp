@@ -0,0 +1,395 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::TSProcessor (in-process tsp chain).
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSProcessor.h"
+#include "tsPluginRepository.h"
+#include "tsNullReport.h"
+#include "tsCerrReport.h"
+#include "tsMonotonic.h"
+#include "tsTelnetConnection.h"
+#include "tsSysUtils.h"
+#include "tsjsonValue.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Test plugins, statically registered.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Number of packets received by the test output plugin.
+    std::atomic<ts::PacketCounter> _utest_output_count(0);
+
+    // Number of continuity errors in the test output plugin, to check packet order.
+    std::atomic<ts::PacketCounter> _utest_output_errors(0);
+
+    // Number of packets which the test input plugin is allowed to generate.
+    std::atomic<ts::PacketCounter> _utest_input_limit(0);
+
+    // Input plugin: generate a given number of packets with incrementing continuity counters.
+    class UTestInput: public ts::InputPlugin
+    {
+        TS_NOBUILD_NOCOPY(UTestInput);
+    public:
+        UTestInput(ts::TSP* t) : ts::InputPlugin(t, u"Generate test packets", u"[options] count"), _max(0), _count(0)
+        {
+            option(u"", 0, UNSIGNED, 1, 1);
+        }
+        virtual bool getOptions() override
+        {
+            _max = intValue<ts::PacketCounter>(u"");
+            return true;
+        }
+        virtual bool start() override
+        {
+            _count = 0;
+            return true;
+        }
+        virtual size_t receive(ts::TSPacket* buffer, ts::TSPacketMetadata*, size_t max_packets) override
+        {
+            // Wait until more packets are allowed.
+            while (_count < _max && _count >= _utest_input_limit && !tsp->aborting()) {
+                ts::SleepThread(1);
+            }
+            size_t n = 0;
+            for (; n < max_packets && _count < _max && _count < _utest_input_limit; ++n) {
+                buffer[n] = ts::NullPacket;
+                buffer[n].setCC(uint8_t(_count++ % ts::CC_MAX));
+            }
+            return n;
+        }
+    private:
+        ts::PacketCounter _max;
+        ts::PacketCounter _count;
+    };
+
+    // Packet processor plugin: do nothing, just let the packets pass.
+    class UTestPass: public ts::ProcessorPlugin
+    {
+        TS_NOBUILD_NOCOPY(UTestPass);
+    public:
+        UTestPass(ts::TSP* t) : ts::ProcessorPlugin(t, u"Pass test packets", u"[options]") {}
+        virtual Status processPacket(ts::TSPacket&, ts::TSPacketMetadata&) override { return TSP_OK; }
+    };
+
+    // Packet processor plugin: process packets by batch, check the packet index in the plugin.
+    class UTestBatch: public ts::ProcessorPlugin
+    {
+        TS_NOBUILD_NOCOPY(UTestBatch);
+    public:
+        UTestBatch(ts::TSP* t) : ts::ProcessorPlugin(t, u"Pass test packets by batch", u"[options]") {}
+        virtual Status processPacket(ts::TSPacket&, ts::TSPacketMetadata&) override { return TSP_OK; }
+        virtual size_t processPacketBatch(ts::TSPacket* pkt, ts::TSPacketMetadata*, size_t count, Status* status) override
+        {
+            const ts::PacketCounter first = tsp->pluginPackets();
+            for (size_t i = 0; i < count; ++i) {
+                if (pkt[i].getCC() != uint8_t((first + i) % ts::CC_MAX)) {
+                    _utest_output_errors++;
+                }
+                status[i] = TSP_OK;
+            }
+            return count;
+        }
+    };
+
+    // Packet processor plugin: rewrite the PID and continuity counter of all packets.
+    class UTestModify: public ts::ProcessorPlugin
+    {
+        TS_NOBUILD_NOCOPY(UTestModify);
+    public:
+        UTestModify(ts::TSP* t) : ts::ProcessorPlugin(t, u"Modify test packets", u"[options]") {}
+        virtual Status processPacket(ts::TSPacket& pkt, ts::TSPacketMetadata&) override
+        {
+            pkt.setPID(100);
+            pkt.setCC(uint8_t((pkt.getCC() + 1) % ts::CC_MAX));
+            return TSP_OK;
+        }
+    };
+
+    // Output plugin: count packets and check continuity.
+    class UTestOutput: public ts::OutputPlugin
+    {
+        TS_NOBUILD_NOCOPY(UTestOutput);
+    public:
+        UTestOutput(ts::TSP* t) : ts::OutputPlugin(t, u"Count test packets", u"[options]") {}
+        virtual bool send(const ts::TSPacket* buffer, const ts::TSPacketMetadata*, size_t packet_count) override
+        {
+            for (size_t i = 0; i < packet_count; ++i) {
+                if (buffer[i].getCC() != uint8_t(_utest_output_count++ % ts::CC_MAX)) {
+                    _utest_output_errors++;
+                }
+            }
+            return true;
+        }
+    };
+
+    ts::InputPlugin* NewUTestInput(ts::TSP* t) { return new UTestInput(t); }
+    ts::ProcessorPlugin* NewUTestPass(ts::TSP* t) { return new UTestPass(t); }
+    ts::ProcessorPlugin* NewUTestBatch(ts::TSP* t) { return new UTestBatch(t); }
+    ts::ProcessorPlugin* NewUTestModify(ts::TSP* t) { return new UTestModify(t); }
+    ts::OutputPlugin* NewUTestOutput(ts::TSP* t) { return new UTestOutput(t); }
+
+    ts::PluginRepository::Register _reg_input("utest_input", NewUTestInput);
+    ts::PluginRepository::Register _reg_pass("utest_pass", NewUTestPass);
+    ts::PluginRepository::Register _reg_batch("utest_batch", NewUTestBatch);
+    ts::PluginRepository::Register _reg_modify("utest_modify", NewUTestModify);
+    ts::PluginRepository::Register _reg_output("utest_output", NewUTestOutput);
+}
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSProcessorTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testNullChain();
+    void testBatchChain();
+    void testParallelBranches();
+    void testBranchModify();
+    void testStats();
+
+    TSUNIT_TEST_BEGIN(TSProcessorTest);
+    TSUNIT_TEST(testNullChain);
+    TSUNIT_TEST(testBatchChain);
+    TSUNIT_TEST(testParallelBranches);
+    TSUNIT_TEST(testBranchModify);
+    TSUNIT_TEST(testStats);
+    TSUNIT_TEST_END();
+
+private:
+    // Run a chain of packet processors, return the number of packets per second.
+    static ts::PacketCounter runChain(size_t proc_count, ts::PacketCounter pkt_count, size_t buffer_size, const ts::UString& proc_name = u"utest_pass");
+    static ts::PacketCounter runArgs(ts::TSProcessorArgs& args, ts::PacketCounter pkt_count);
+
+    // Send a control command to a running TSProcessor, return the JSON response.
+    static ts::json::ValuePtr sendCommand(uint16_t port, const ts::UString& command);
+
+    // Wait until the test output plugin has received a given number of packets.
+    static void waitOutput(ts::PacketCounter pkt_count);
+};
+
+TSUNIT_REGISTER(TSProcessorTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void TSProcessorTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void TSProcessorTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+ts::PacketCounter TSProcessorTest::runChain(size_t proc_count, ts::PacketCounter pkt_count, size_t buffer_size, const ts::UString& proc_name)
+{
+    ts::TSProcessorArgs args;
+    args.ts_buffer_size = buffer_size;
+    args.plugins.resize(proc_count);
+    for (size_t i = 0; i < proc_count; ++i) {
+        args.plugins[i].set(proc_name);
+    }
+    return runArgs(args, pkt_count);
+}
+
+ts::PacketCounter TSProcessorTest::runArgs(ts::TSProcessorArgs& args, ts::PacketCounter pkt_count)
+{
+    args.app_name = u"utest";
+    args.input.set(u"utest_input", {ts::UString::Decimal(pkt_count, 0, true, ts::UString())});
+    args.output.set(u"utest_output");
+
+    _utest_output_count = 0;
+    _utest_output_errors = 0;
+    _utest_input_limit = pkt_count;
+
+    ts::TSProcessor tsproc(NULLREP);
+    const ts::Monotonic start(true);
+    TSUNIT_ASSERT(tsproc.start(args));
+    tsproc.waitForTermination();
+    const ts::NanoSecond duration = ts::Monotonic(true) - start;
+
+    TSUNIT_EQUAL(pkt_count, _utest_output_count.load());
+    TSUNIT_EQUAL(0, _utest_output_errors.load());
+
+    return duration <= 0 ? 0 : ts::PacketCounter((pkt_count * ts::NanoSecPerSec) / duration);
+}
+
+void TSProcessorTest::testNullChain()
+{
+    // Small buffer to force many handoffs between executors.
+    for (size_t proc_count = 0; proc_count <= 10; proc_count += 5) {
+        const ts::PacketCounter rate = runChain(proc_count, 100000, ts::TSProcessorArgs::MIN_BUFFER_SIZE);
+        debug() << "TSProcessorTest::testNullChain: " << proc_count << " processors, small buffer: " << rate << " packets/s" << std::endl;
+    }
+
+    // Default buffer.
+    for (size_t proc_count = 0; proc_count <= 10; proc_count += 5) {
+        const ts::PacketCounter rate = runChain(proc_count, 1000000, ts::TSProcessorArgs::DEFAULT_BUFFER_SIZE);
+        debug() << "TSProcessorTest::testNullChain: " << proc_count << " processors, default buffer: " << rate << " packets/s" << std::endl;
+    }
+}
+
+void TSProcessorTest::testBatchChain()
+{
+    for (size_t proc_count = 1; proc_count <= 10; proc_count += 9) {
+        const ts::PacketCounter rate = runChain(proc_count, 1000000, ts::TSProcessorArgs::DEFAULT_BUFFER_SIZE, u"utest_batch");
+        debug() << "TSProcessorTest::testBatchChain: " << proc_count << " processors: " << rate << " packets/s" << std::endl;
+    }
+}
+
+void TSProcessorTest::testParallelBranches()
+{
+    // Three parallel branches between two plugins. The packets must reach the
+    // plugins in each branch and the output in the same order.
+    ts::TSProcessorArgs args;
+    args.ts_buffer_size = ts::TSProcessorArgs::MIN_BUFFER_SIZE;
+    args.plugins.resize(6);
+    args.plugins[0].set(u"utest_batch");
+    args.plugins[1].set(u"utest_batch", {u"--parallel"});
+    args.plugins[2].set(u"utest_pass", {u"--in-branch"});
+    args.plugins[3].set(u"utest_batch", {u"--in-branch"});
+    args.plugins[4].set(u"utest_batch", {u"--parallel"});
+    args.plugins[5].set(u"utest_batch");
+
+    const ts::PacketCounter rate = runArgs(args, 500000);
+    debug() << "TSProcessorTest::testParallelBranches: " << rate << " packets/s" << std::endl;
+}
+
+void TSProcessorTest::testBranchModify()
+{
+    // Plugins which modify packets in parallel branches. The modifications must
+    // be visible neither in the other plugins of the branches nor after the join.
+    ts::TSProcessorArgs args;
+    args.ts_buffer_size = ts::TSProcessorArgs::MIN_BUFFER_SIZE;
+    args.plugins.resize(6);
+    args.plugins[0].set(u"utest_pass");
+    args.plugins[1].set(u"utest_modify");
+    args.plugins[2].set(u"utest_batch", {u"--in-branch"});
+    args.plugins[3].set(u"utest_modify", {u"--parallel"});
+    args.plugins[4].set(u"utest_batch", {u"--parallel"});
+    args.plugins[5].set(u"utest_batch");
+
+    runArgs(args, 200000);
+}
+
+ts::json::ValuePtr TSProcessorTest::sendCommand(uint16_t port, const ts::UString& command)
+{
+    ts::TelnetConnection conn;
+    ts::UString line;
+    ts::UStringList lines;
+    TSUNIT_ASSERT(conn.open(CERR));
+    TSUNIT_ASSERT(conn.bind(ts::SocketAddress(), CERR));
+    TSUNIT_ASSERT(conn.connect(ts::SocketAddress(ts::IPAddress::LocalHost, port), CERR));
+    TSUNIT_ASSERT(conn.sendLine(command, CERR));
+    TSUNIT_ASSERT(conn.closeWriter(CERR));
+    while (conn.receiveLine(line, nullptr, NULLREP)) {
+        lines.push_back(line);
+    }
+    conn.close(NULLREP);
+    ts::json::ValuePtr value;
+    TSUNIT_ASSERT(ts::json::Parse(value, lines, CERR));
+    return value;
+}
+
+void TSProcessorTest::waitOutput(ts::PacketCounter pkt_count)
+{
+    for (int i = 0; i < 10000 && _utest_output_count < pkt_count; ++i) {
+        ts::SleepThread(1);
+    }
+    TSUNIT_EQUAL(pkt_count, _utest_output_count.load());
+}
+
+void TSProcessorTest::testStats()
+{
+    // The input plugin is gated to get stable packet counters while the chain is running.
+    ts::TSProcessorArgs args;
+    args.app_name = u"utest";
+    args.control_port = 34567;
+    args.control_sources.push_back(ts::IPAddress::LocalHost);
+    args.input.set(u"utest_input", {u"15000"});
+    args.plugins.resize(1);
+    args.plugins[0].set(u"utest_pass");
+    args.output.set(u"utest_output");
+
+    _utest_output_count = 0;
+    _utest_output_errors = 0;
+    _utest_input_limit = 10000;
+
+    ts::TSProcessor tsproc(NULLREP);
+    TSUNIT_ASSERT(tsproc.start(args));
+    waitOutput(10000);
+
+    // The counters of the processor plugin (index 1) since the start.
+    ts::json::ValuePtr stats(sendCommand(args.control_port, u"stats --json 1"));
+    TSUNIT_ASSERT(!stats.isNull());
+    TSUNIT_EQUAL(1, stats->size());
+    TSUNIT_EQUAL(10000, stats->at(0).value(u"plugin_packets").toInteger());
+    TSUNIT_EQUAL(10000, stats->at(0).value(u"total_packets").toInteger());
+
+    // The reset returns the counters before the reset.
+    stats = sendCommand(args.control_port, u"stats --json --reset 1");
+    TSUNIT_ASSERT(!stats.isNull());
+    TSUNIT_EQUAL(10000, stats->at(0).value(u"plugin_packets").toInteger());
+
+    // After the reset, the packet counters are consistent with the time counters.
+    stats = sendCommand(args.control_port, u"stats --json 1");
+    TSUNIT_ASSERT(!stats.isNull());
+    TSUNIT_EQUAL(0, stats->at(0).value(u"plugin_packets").toInteger());
+    TSUNIT_EQUAL(0, stats->at(0).value(u"total_packets").toInteger());
+
+    _utest_input_limit = 15000;
+    waitOutput(15000);
+    stats = sendCommand(args.control_port, u"stats --json 1");
+    TSUNIT_ASSERT(!stats.isNull());
+    TSUNIT_EQUAL(5000, stats->at(0).value(u"plugin_packets").toInteger());
+    TSUNIT_EQUAL(5000, stats->at(0).value(u"total_packets").toInteger());
+
+    tsproc.waitForTermination();
+    TSUNIT_EQUAL(0, _utest_output_errors.load());
+}
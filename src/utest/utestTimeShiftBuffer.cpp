@@ -27,12 +27,14 @@
 //
 //----------------------------------------------------------------------------
 //
-//  TSUnit test suite for class ts::TimeShiftBuffer
+//  TSUnit test suite for classes ts::TimeShiftBuffer and ts::SegmentedTimeShiftBuffer
 //
 //----------------------------------------------------------------------------
 
 #include "tsTimeShiftBuffer.h"
+#include "tsSegmentedTimeShiftBuffer.h"
 #include "tsCerrReport.h"
+#include "tsSysUtils.h"
 #include "tsunit.h"
 TSDUCK_SOURCE;
 
@@ -50,15 +52,23 @@ public:
     void testMinimum();
     void testMemory();
     void testFile();
+    void testSegmented();
+    void testSegmentedSeek();
+    void testSegmentedBoundary();
 
     TSUNIT_TEST_BEGIN(TimeShiftBufferTest);
     TSUNIT_TEST(testMinimum);
     TSUNIT_TEST(testMemory);
     TSUNIT_TEST(testFile);
+    TSUNIT_TEST(testSegmented);
+    TSUNIT_TEST(testSegmentedSeek);
+    TSUNIT_TEST(testSegmentedBoundary);
     TSUNIT_TEST_END();
 
 private:
     void testCommon(uint8_t total, uint8_t memory);
+    static void setPacket(ts::TSPacket& pkt, uint32_t index);
+    static uint32_t getPacket(const ts::TSPacket& pkt);
 };
 
 TSUNIT_REGISTER(TimeShiftBufferTest);
@@ -143,3 +153,150 @@ void TimeShiftBufferTest::testFile()
 {
     testCommon(20, 4);
 }
+
+// Store a packet index in the payload.
+void TimeShiftBufferTest::setPacket(ts::TSPacket& pkt, uint32_t index)
+{
+    pkt.init(ts::PID(index % ts::PID_NULL), uint8_t(index), 0xFF);
+    ts::PutUInt32(pkt.getPayload(), index);
+}
+
+uint32_t TimeShiftBufferTest::getPacket(const ts::TSPacket& pkt)
+{
+    return ts::GetUInt32(pkt.getPayload());
+}
+
+void TimeShiftBufferTest::testSegmented()
+{
+    // Small cache, to force actual disk I/O.
+    ts::SegmentedTimeShiftBuffer buf;
+    TSUNIT_ASSERT(buf.setSegmentCount(3));
+    TSUNIT_ASSERT(buf.setCacheBlocks(1, 2));
+    TSUNIT_ASSERT(buf.setTotalPackets(3 * ts::SegmentedTimeShiftBuffer::BLOCK_PACKETS));
+    TSUNIT_ASSERT(!buf.isOpen());
+    TSUNIT_ASSERT(buf.open(CERR));
+    TSUNIT_ASSERT(buf.isOpen());
+    TSUNIT_ASSERT(!buf.setSegmentCount(4));
+    TSUNIT_EQUAL(5 * ts::SegmentedTimeShiftBuffer::BLOCK_PACKETS, buf.size());
+    TSUNIT_ASSERT(buf.empty());
+    TSUNIT_EQUAL(ts::INVALID_PCR, buf.firstTimeStamp());
+
+    // Delay by 10000 packets, several times the size of the ring.
+    const uint32_t delay = 10000;
+    ts::TSPacket pkt;
+    for (uint32_t i = 0; i < 60000; i++) {
+        setPacket(pkt, i);
+        TSUNIT_ASSERT(buf.write(pkt, i * 1000, CERR));
+        if (i >= delay) {
+            TSUNIT_ASSERT(buf.read(pkt, CERR));
+            TSUNIT_EQUAL(i - delay, getPacket(pkt));
+            TSUNIT_EQUAL(delay, buf.count());
+        }
+    }
+    TSUNIT_EQUAL(0, buf.lostPackets());
+    TSUNIT_EQUAL(59999000, buf.lastTimeStamp());
+
+    TSUNIT_ASSERT(buf.close(CERR));
+    TSUNIT_ASSERT(!buf.isOpen());
+}
+
+void TimeShiftBufferTest::testSegmentedSeek()
+{
+    const size_t block = ts::SegmentedTimeShiftBuffer::BLOCK_PACKETS;
+    ts::SegmentedTimeShiftBuffer buf;
+    TSUNIT_ASSERT(buf.setSegmentCount(3));
+    TSUNIT_ASSERT(buf.setCacheBlocks(1, 2));
+    TSUNIT_ASSERT(buf.open(CERR));
+    TSUNIT_EQUAL(5 * block, buf.size());
+
+    // Overflow the ring without reading: the two oldest blocks are overwritten.
+    ts::TSPacket pkt;
+    for (uint32_t i = 0; i < 30000; i++) {
+        setPacket(pkt, i);
+        TSUNIT_ASSERT(buf.write(pkt, i * 1000, CERR));
+    }
+    TSUNIT_EQUAL(2 * block, buf.lostPackets());
+    TSUNIT_EQUAL(30000 - 2 * block, buf.count());
+    TSUNIT_EQUAL(2 * block * 1000, buf.firstTimeStamp());
+    TSUNIT_EQUAL(29999000, buf.lastTimeStamp());
+
+    // Read the oldest packet.
+    TSUNIT_ASSERT(buf.read(pkt, CERR));
+    TSUNIT_EQUAL(2 * block, getPacket(pkt));
+
+    // Seek inside a block, by interpolation.
+    TSUNIT_ASSERT(buf.seekTimeStamp(20000500, CERR));
+    TSUNIT_EQUAL(10000, buf.count());
+    TSUNIT_ASSERT(buf.read(pkt, CERR));
+    TSUNIT_EQUAL(20000, getPacket(pkt));
+
+    // Seek inside the current write block.
+    TSUNIT_ASSERT(buf.seekTimeStamp(29000000, CERR));
+    TSUNIT_ASSERT(buf.read(pkt, CERR));
+    TSUNIT_EQUAL(29000, getPacket(pkt));
+
+    // Seek before the oldest packet, then read everything.
+    TSUNIT_ASSERT(buf.seekTimeStamp(0, CERR));
+    for (uint32_t i = 2 * block; i < 30000; i++) {
+        TSUNIT_ASSERT(buf.read(pkt, CERR));
+        TSUNIT_EQUAL(i, getPacket(pkt));
+    }
+    TSUNIT_ASSERT(buf.empty());
+    TSUNIT_ASSERT(!buf.read(pkt, CERR));
+    TSUNIT_EQUAL(2 * block, buf.lostPackets());
+
+    TSUNIT_ASSERT(buf.close(CERR));
+}
+
+void TimeShiftBufferTest::testSegmentedBoundary()
+{
+    const size_t block = ts::SegmentedTimeShiftBuffer::BLOCK_PACKETS;
+    ts::SegmentedTimeShiftBuffer buf;
+    TSUNIT_ASSERT(buf.setSegmentCount(3));
+    TSUNIT_ASSERT(buf.setCacheBlocks(1, 2));
+    TSUNIT_ASSERT(buf.open(CERR));
+
+    // Write an exact number of blocks: the last complete block is written on disk
+    // while no new block is started. Let the I/O thread write it before reading.
+    const uint32_t total = uint32_t(4 * block);
+    ts::TSPacket pkt;
+    for (uint32_t i = 0; i < total; i++) {
+        setPacket(pkt, i);
+        TSUNIT_ASSERT(buf.write(pkt, i * 1000, CERR));
+    }
+    ts::SleepThread(200);
+    TSUNIT_EQUAL(total, buf.count());
+    TSUNIT_EQUAL((total - 1) * 1000, buf.lastTimeStamp());
+
+    // Seek to the last time stamp, in the last complete block.
+    TSUNIT_ASSERT(buf.seekTimeStamp(buf.lastTimeStamp(), CERR));
+    TSUNIT_EQUAL(1, buf.count());
+    TSUNIT_ASSERT(buf.read(pkt, CERR));
+    TSUNIT_EQUAL(total - 1, getPacket(pkt));
+    TSUNIT_ASSERT(buf.empty());
+
+    // Seek past the last time stamp.
+    TSUNIT_ASSERT(buf.seekTimeStamp(buf.lastTimeStamp() + 1000000, CERR));
+    TSUNIT_ASSERT(buf.read(pkt, CERR));
+    TSUNIT_EQUAL(total - 1, getPacket(pkt));
+
+    // Read everything, up to the end of the last complete block.
+    TSUNIT_ASSERT(buf.seekTimeStamp(0, CERR));
+    for (uint32_t i = 0; i < total; i++) {
+        TSUNIT_ASSERT(buf.read(pkt, CERR));
+        TSUNIT_EQUAL(i, getPacket(pkt));
+    }
+    TSUNIT_ASSERT(buf.empty());
+    TSUNIT_ASSERT(!buf.read(pkt, CERR));
+    TSUNIT_EQUAL(0, buf.lostPackets());
+
+    // Continue writing and reading after the boundary.
+    for (uint32_t i = total; i < total + 10; i++) {
+        setPacket(pkt, i);
+        TSUNIT_ASSERT(buf.write(pkt, i * 1000, CERR));
+        TSUNIT_ASSERT(buf.read(pkt, CERR));
+        TSUNIT_EQUAL(i, getPacket(pkt));
+    }
+
+    TSUNIT_ASSERT(buf.close(CERR));
+}